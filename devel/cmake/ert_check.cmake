@@ -33,6 +33,11 @@ if (HAVE_READLINKAT)
    add_definitions( -DHAVE_READLINKAT )
 endif()
 
+check_function_exists( openat HAVE_OPENAT )
+if (HAVE_OPENAT)
+   add_definitions( -DHAVE_OPENAT )
+endif()
+
 check_function_exists( symlink HAVE_SYMLINK )
 if (HAVE_SYMLINK)
   add_definitions( -DHAVE_SYMLINK )
@@ -0,0 +1,66 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ies_enkf.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __IES_ENKF_H__
+#define __IES_ENKF_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/matrix.h>
+#include <ert/util/rng.h>
+
+#define  IES_STEPLENGTH_KEY        "IES_STEPLENGTH"
+#define  DEFAULT_IES_STEPLENGTH    0.50
+#define  IES_MINISTEP_KEY          "MINISTEP"
+
+  typedef struct ies_enkf_data_struct ies_enkf_data_type;
+
+  void   * ies_enkf_data_alloc( rng_type * rng );
+  void     ies_enkf_data_free( void * arg );
+
+  void     ies_enkf_initX(void * module_data ,
+                          matrix_type * X ,
+                          matrix_type * A ,
+                          matrix_type * S ,
+                          matrix_type * R ,
+                          matrix_type * dObs ,
+                          matrix_type * E ,
+                          matrix_type * D );
+
+  bool     ies_enkf_set_double( void * arg , const char * var_name , double value);
+  bool     ies_enkf_set_int( void * arg , const char * var_name , int value);
+  bool     ies_enkf_set_string( void * arg , const char * var_name , const char * value);
+
+  void     ies_enkf_set_truncation( ies_enkf_data_type * data , double truncation );
+  void     ies_enkf_set_subspace_dimension( ies_enkf_data_type * data , int subspace_dimension);
+  bool     ies_enkf_set_steplength( ies_enkf_data_type * data , double steplength );
+  void     ies_enkf_set_iteration_number( ies_enkf_data_type * data , int iteration_nr );
+  int      ies_enkf_get_iteration_number( const ies_enkf_data_type * data );
+  void     ies_enkf_set_ministep( ies_enkf_data_type * data , const char * ministep );
+  const char * ies_enkf_get_ministep( const ies_enkf_data_type * data );
+  const matrix_type * ies_enkf_get_W( const ies_enkf_data_type * data );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
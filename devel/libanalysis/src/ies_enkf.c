@@ -0,0 +1,515 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ies_enkf.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <ert/util/util.h>
+#include <ert/util/hash.h>
+#include <ert/util/matrix.h>
+#include <ert/util/matrix_blas.h>
+#include <ert/util/matrix_lapack.h>
+#include <ert/util/rng.h>
+
+#include <ert/analysis/analysis_module.h>
+#include <ert/analysis/analysis_table.h>
+#include <ert/analysis/enkf_linalg.h>
+#include <ert/analysis/std_enkf.h>
+#include <ert/analysis/ies_enkf.h>
+
+/*
+  Iterative ensemble smoother (LM-EnRML in ensemble subspace form).
+
+  The updated ensemble after iteration i is written as a linear
+  combination of the prior ensemble:
+
+       A_i = A_0 * T_i       with    T_i = I + W_i / sqrt(N - 1)
+
+  where W_i is a N x N coefficient matrix (N = ensemble size). All
+  the iteration state is contained in W, which is held by the module
+  between calls to initX(); the prior ensemble A_0 is never stored.
+  Since the ensemble is updated in place as A_{i+1} = A_i * X the
+  module returns:
+
+       X = T_i^{-1} * T_{i+1}
+
+  and the normal A * X machinery in enkf_main is used to apply the
+  update. Each iteration does:
+
+    1. Omega = I + W_i * Pi / sqrt(N - 1), Pi being the projection
+       which removes the ensemble mean.
+
+    2. The average sensitivity S_hat is found by solving
+       Omega^T * S_hat^T = (S * Pi)^T; this is the linearisation of
+       the forward model around the current iterate.
+
+    3. The innovation H = S_hat * W_i / sqrt(N - 1) + (D_0 - S_i),
+       where D_0 are the perturbed observations from the first
+       iteration; the same perturbations must be used throughout the
+       iterations.
+
+    4. W_{i+1} = W_i - gamma * (W_i - sqrt(N - 1) * S_hat^T * C^{-1} * H),
+       with C = S_hat * S_hat^T + (N - 1) * R inverted in the low rank
+       form used by std_enkf, and gamma the step length.
+
+  With gamma = 1 the first iteration reproduces the std_enkf update
+  exactly. The module is ITERABLE; the iteration number is passed in
+  through the "NUM_ITER" integer variable, and the first update with
+  "NUM_ITER" equal to zero will discard the W state and start a new
+  iteration sequence.
+
+  With localisation every ministep has its own observations and must
+  have its own W and D0; the name of the ministep is passed in through
+  the "MINISTEP" string variable before each update, and the state is
+  held per ministep. Updating the same ministep twice in one iteration
+  would advance its W twice, and is a fatal error.
+*/
+
+#define IES_ENKF_TYPE_ID 6418173
+
+#define INVALID_SUBSPACE_DIMENSION  -1
+#define INVALID_TRUNCATION          -1
+#define DEFAULT_SUBSPACE_DIMENSION  INVALID_SUBSPACE_DIMENSION
+#define DEFAULT_MINISTEP            "ALL_ACTIVE"
+
+
+typedef struct {
+  matrix_type * W;                 // The ens_size x ens_size coefficient matrix; NULL before first iteration.
+  matrix_type * D0;                // The perturbed observations from the first iteration.
+  int           update_iteration;  // The iteration number of the last update of W; -1 before the first update.
+} ies_enkf_state_type;
+
+
+struct ies_enkf_data_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  double    truncation;            // Controlled by config key: ENKF_TRUNCATION_KEY
+  int       subspace_dimension;    // Controlled by config key: ENKF_NCOMP_KEY (-1: use Truncation instead)
+  double    steplength;            // Controlled by config key: IES_STEPLENGTH_KEY
+  int       iteration_nr;          // Controlled by the "NUM_ITER" variable set from enkf_main.
+  char    * ministep;              // Controlled by the "MINISTEP" variable set from enkf_main.
+  long      option_flags;
+  hash_type * states;              // ies_enkf_state_type instances indexed by ministep name.
+};
+
+
+static UTIL_SAFE_CAST_FUNCTION( ies_enkf_data , IES_ENKF_TYPE_ID )
+static UTIL_SAFE_CAST_FUNCTION_CONST( ies_enkf_data , IES_ENKF_TYPE_ID )
+
+
+void ies_enkf_set_truncation( ies_enkf_data_type * data , double truncation ) {
+  data->truncation = truncation;
+  if (truncation > 0.0)
+    data->subspace_dimension = INVALID_SUBSPACE_DIMENSION;
+}
+
+void ies_enkf_set_subspace_dimension( ies_enkf_data_type * data , int subspace_dimension) {
+  data->subspace_dimension = subspace_dimension;
+  if (subspace_dimension > 0)
+    data->truncation = INVALID_TRUNCATION;
+}
+
+/*
+  The steplength must be in (0,1]; an invalid value is not set and
+  false is returned.
+*/
+
+bool ies_enkf_set_steplength( ies_enkf_data_type * data , double steplength ) {
+  if ((steplength <= 0) || (steplength > 1)) {
+    fprintf(stderr,"** Warning: invalid %s:%g - must be in (0,1] \n", IES_STEPLENGTH_KEY , steplength);
+    return false;
+  }
+  data->steplength = steplength;
+  return true;
+}
+
+/*****************************************************************/
+
+static ies_enkf_state_type * ies_enkf_state_alloc( ) {
+  ies_enkf_state_type * state = util_malloc( sizeof * state );
+  state->W = NULL;
+  state->D0 = NULL;
+  state->update_iteration = -1;
+  return state;
+}
+
+
+static void ies_enkf_state_reset( ies_enkf_state_type * state ) {
+  if (state->W != NULL) {
+    matrix_free( state->W );
+    state->W = NULL;
+  }
+
+  if (state->D0 != NULL) {
+    matrix_free( state->D0 );
+    state->D0 = NULL;
+  }
+  state->update_iteration = -1;
+}
+
+
+static void ies_enkf_state_free( ies_enkf_state_type * state ) {
+  ies_enkf_state_reset( state );
+  free( state );
+}
+
+
+static void ies_enkf_state_free__( void * arg ) {
+  ies_enkf_state_free( (ies_enkf_state_type *) arg );
+}
+
+
+static ies_enkf_state_type * ies_enkf_get_state( ies_enkf_data_type * data ) {
+  if (!hash_has_key( data->states , data->ministep ))
+    hash_insert_hash_owned_ref( data->states , data->ministep , ies_enkf_state_alloc( ) , ies_enkf_state_free__ );
+  return hash_get( data->states , data->ministep );
+}
+
+/*****************************************************************/
+
+/*
+  Setting the iteration number to zero will start a new sequence of
+  iterations; the state of a ministep is discarded when it is updated
+  with iteration number zero.
+*/
+
+void ies_enkf_set_iteration_number( ies_enkf_data_type * data , int iteration_nr ) {
+  data->iteration_nr = iteration_nr;
+}
+
+int ies_enkf_get_iteration_number( const ies_enkf_data_type * data ) {
+  return data->iteration_nr;
+}
+
+void ies_enkf_set_ministep( ies_enkf_data_type * data , const char * ministep ) {
+  data->ministep = util_realloc_string_copy( data->ministep , ministep );
+}
+
+const char * ies_enkf_get_ministep( const ies_enkf_data_type * data ) {
+  return data->ministep;
+}
+
+const matrix_type * ies_enkf_get_W( const ies_enkf_data_type * data ) {
+  if (hash_has_key( data->states , data->ministep )) {
+    const ies_enkf_state_type * state = hash_get( data->states , data->ministep );
+    return state->W;
+  } else
+    return NULL;
+}
+
+
+void * ies_enkf_data_alloc( rng_type * rng ) {
+  ies_enkf_data_type * data = util_malloc( sizeof * data );
+  UTIL_TYPE_ID_INIT( data , IES_ENKF_TYPE_ID );
+
+  data->states = hash_alloc( );
+  data->ministep = util_alloc_string_copy( DEFAULT_MINISTEP );
+  data->iteration_nr = 0;
+  ies_enkf_set_truncation( data , DEFAULT_ENKF_TRUNCATION_ );
+  ies_enkf_set_subspace_dimension( data , DEFAULT_SUBSPACE_DIMENSION );
+  ies_enkf_set_steplength( data , DEFAULT_IES_STEPLENGTH );
+  data->option_flags = ANALYSIS_NEED_ED + ANALYSIS_SCALE_DATA + ANALYSIS_ITERABLE;
+  return data;
+}
+
+
+void ies_enkf_data_free( void * arg ) {
+  ies_enkf_data_type * data = ies_enkf_data_safe_cast( arg );
+  hash_free( data->states );
+  free( data->ministep );
+  free( data );
+}
+
+
+/*
+  Will return T = I + W / sqrt(N - 1).
+*/
+
+static matrix_type * ies_enkf_alloc_T( const matrix_type * W ) {
+  const int ens_size = matrix_get_rows( W );
+  matrix_type * T = matrix_alloc_copy( W );
+
+  matrix_scale( T , 1.0 / sqrt( ens_size - 1 ));
+  for (int i=0; i < ens_size; i++)
+    matrix_iadd( T , i , i , 1.0 );
+
+  return T;
+}
+
+
+/*
+  Solves Omega^T * S_hat^T = (S * Pi)^T for the average sensitivity
+  S_hat; S is centered in place. In the first iteration Omega is the
+  identity and S_hat is just the centered S.
+*/
+
+static matrix_type * ies_enkf_alloc_Shat( matrix_type * S , const matrix_type * W ) {
+  const int ens_size = matrix_get_columns( S );
+  matrix_type * Omega = matrix_alloc_copy( W );
+  matrix_type * OmegaT;
+  matrix_type * ShatT;
+  matrix_type * Shat;
+
+  matrix_subtract_row_mean( S );
+  matrix_subtract_row_mean( Omega );          /* W * Pi */
+  matrix_scale( Omega , 1.0 / sqrt( ens_size - 1 ));
+  for (int i=0; i < ens_size; i++)
+    matrix_iadd( Omega , i , i , 1.0 );
+
+  OmegaT = matrix_alloc_transpose( Omega );
+  ShatT  = matrix_alloc_transpose( S );
+  matrix_dgesv( OmegaT , ShatT );
+  Shat = matrix_alloc_transpose( ShatT );
+
+  matrix_free( Omega );
+  matrix_free( OmegaT );
+  matrix_free( ShatT );
+  return Shat;
+}
+
+
+void ies_enkf_initX(void * module_data ,
+                    matrix_type * X ,
+                    matrix_type * A ,
+                    matrix_type * S ,
+                    matrix_type * R ,
+                    matrix_type * dObs ,
+                    matrix_type * E ,
+                    matrix_type * D) {
+
+  ies_enkf_data_type * data = ies_enkf_data_safe_cast( module_data );
+  ies_enkf_state_type * state = ies_enkf_get_state( data );
+  const int nrobs    = matrix_get_rows( S );
+  const int ens_size = matrix_get_columns( S );
+  const int nrmin    = util_int_min( ens_size , nrobs );
+  const double sqrtN1 = sqrt( ens_size - 1 );
+
+  if (data->iteration_nr == 0)
+    ies_enkf_state_reset( state );
+  else if (state->update_iteration == data->iteration_nr)
+    util_abort("%s: ministep:%s has already been updated in iteration %d - every ministep must have a unique name \n",
+               __func__ , data->ministep , data->iteration_nr);
+
+  if (state->W == NULL) {
+    state->W = matrix_alloc( ens_size , ens_size );
+    matrix_set( state->W , 0 );
+  } else if (matrix_get_rows( state->W ) != ens_size)
+    util_abort("%s: ensemble size has changed from %d to %d between iterations \n",__func__ , matrix_get_rows( state->W ) , ens_size);
+
+  /* D = dObs + E - S, i.e. D0 = D + S is the perturbed observations. */
+  if ((state->D0 != NULL) && (matrix_get_rows( state->D0 ) != nrobs)) {
+    fprintf(stderr,"** Warning: the number of active observations has changed from %d to %d - using new observation perturbations.\n",
+            matrix_get_rows( state->D0 ) , nrobs);
+    matrix_free( state->D0 );
+    state->D0 = NULL;
+  }
+  if (state->D0 == NULL) {
+    state->D0 = matrix_alloc_copy( D );
+    matrix_inplace_add( state->D0 , S );
+  }
+
+  {
+    matrix_type * W_new;
+    matrix_type * H   = matrix_alloc_copy( state->D0 );
+    matrix_type * Wc  = matrix_alloc( nrobs , nrmin );
+    matrix_type * X3  = matrix_alloc( nrobs , ens_size );
+    double      * eig = util_calloc( nrmin , sizeof * eig );
+    matrix_type * Shat;
+
+    matrix_inplace_sub( H , S );                    /* H = D0 - S_i */
+    Shat = ies_enkf_alloc_Shat( S , state->W );
+    matrix_dgemm( H , Shat , state->W , false , false , 1.0 / sqrtN1 , 1.0 );  /* H += S_hat * W / sqrt(N-1) */
+
+    enkf_linalg_lowrankCinv( Shat , R , Wc , eig , data->truncation , data->subspace_dimension );
+    enkf_linalg_genX3( X3 , Wc , H , eig );        /* X3 = C^{-1} * H */
+
+    W_new = matrix_alloc_copy( state->W );
+    matrix_dgemm( W_new , Shat , X3 , true , false , data->steplength * sqrtN1 , 1 - data->steplength );
+
+    {
+      matrix_type * T_old = ies_enkf_alloc_T( state->W );
+      matrix_type * T_new = ies_enkf_alloc_T( W_new );
+
+      matrix_assign( X , T_new );
+      matrix_dgesv( T_old , X );                     /* X = T_old^{-1} * T_new */
+
+      matrix_free( T_old );
+      matrix_free( T_new );
+    }
+
+    matrix_free( state->W );
+    state->W = W_new;
+    state->update_iteration = data->iteration_nr;
+
+    matrix_free( Shat );
+    matrix_free( X3 );
+    matrix_free( Wc );
+    matrix_free( H );
+    free( eig );
+  }
+  enkf_linalg_checkX( X , false );
+  data->iteration_nr++;
+}
+
+
+
+bool ies_enkf_set_double( void * arg , const char * var_name , double value) {
+  ies_enkf_data_type * module_data = ies_enkf_data_safe_cast( arg );
+  {
+    bool name_recognized = true;
+
+    if (strcmp( var_name , ENKF_TRUNCATION_KEY_) == 0)
+      ies_enkf_set_truncation( module_data , value );
+    else if (strcmp( var_name , IES_STEPLENGTH_KEY) == 0)
+      name_recognized = ies_enkf_set_steplength( module_data , value );
+    else
+      name_recognized = false;
+
+    return name_recognized;
+  }
+}
+
+
+bool ies_enkf_set_int( void * arg , const char * var_name , int value) {
+  ies_enkf_data_type * module_data = ies_enkf_data_safe_cast( arg );
+  {
+    bool name_recognized = true;
+
+    if (strcmp( var_name , ENKF_NCOMP_KEY_) == 0)
+      ies_enkf_set_subspace_dimension( module_data , value );
+    else if (strcmp( var_name , "NUM_ITER") == 0)
+      ies_enkf_set_iteration_number( module_data , value );
+    else if (strcmp( var_name , IES_MINISTEP_KEY) == 0) {
+      /* A ministep name which looks like an integer. */
+      char * ministep = util_alloc_sprintf( "%d" , value );
+      ies_enkf_set_ministep( module_data , ministep );
+      free( ministep );
+    } else
+      name_recognized = false;
+
+    return name_recognized;
+  }
+}
+
+
+bool ies_enkf_set_string( void * arg , const char * var_name , const char * value) {
+  ies_enkf_data_type * module_data = ies_enkf_data_safe_cast( arg );
+  {
+    bool name_recognized = true;
+
+    if (strcmp( var_name , IES_MINISTEP_KEY) == 0)
+      ies_enkf_set_ministep( module_data , value );
+    else
+      name_recognized = false;
+
+    return name_recognized;
+  }
+}
+
+
+long ies_enkf_get_options( void * arg , long flag ) {
+  ies_enkf_data_type * module_data = ies_enkf_data_safe_cast( arg );
+  {
+    return module_data->option_flags;
+  }
+}
+
+
+bool ies_enkf_has_var( const void * arg, const char * var_name) {
+  if (strcmp(var_name , "ITER") == 0)
+    return true;
+  else if (strcmp(var_name , "NUM_ITER") == 0)
+    return true;
+  else if (strcmp(var_name , IES_STEPLENGTH_KEY) == 0)
+    return true;
+  else if (strcmp(var_name , ENKF_TRUNCATION_KEY_) == 0)
+    return true;
+  else if (strcmp(var_name , ENKF_NCOMP_KEY_) == 0)
+    return true;
+  else if (strcmp(var_name , IES_MINISTEP_KEY) == 0)
+    return true;
+  else
+    return false;
+}
+
+
+int ies_enkf_get_int( const void * arg, const char * var_name) {
+  const ies_enkf_data_type * module_data = ies_enkf_data_safe_cast_const( arg );
+  {
+    if (strcmp(var_name , "ITER") == 0)
+      return module_data->iteration_nr;
+    else if (strcmp(var_name , "NUM_ITER") == 0)
+      return module_data->iteration_nr;
+    else if (strcmp(var_name , ENKF_NCOMP_KEY_) == 0)
+      return module_data->subspace_dimension;
+    else
+      return -1;
+  }
+}
+
+
+double ies_enkf_get_double( const void * arg, const char * var_name) {
+  const ies_enkf_data_type * module_data = ies_enkf_data_safe_cast_const( arg );
+  {
+    if (strcmp(var_name , IES_STEPLENGTH_KEY) == 0)
+      return module_data->steplength;
+    else if (strcmp(var_name , ENKF_TRUNCATION_KEY_) == 0)
+      return module_data->truncation;
+    else
+      return -1;
+  }
+}
+
+
+void * ies_enkf_get_ptr( const void * arg , const char * var_name ) {
+  const ies_enkf_data_type * module_data = ies_enkf_data_safe_cast_const( arg );
+  {
+    if (strcmp(var_name , IES_MINISTEP_KEY) == 0)
+      return module_data->ministep;
+    else
+      return NULL;
+  }
+}
+
+
+
+#ifdef INTERNAL_LINK
+#define SYMBOL_TABLE ies_enkf_symbol_table
+#else
+#define SYMBOL_TABLE EXTERNAL_MODULE_SYMBOL
+#endif
+
+
+analysis_table_type SYMBOL_TABLE = {
+    .alloc           = ies_enkf_data_alloc,
+    .freef           = ies_enkf_data_free,
+    .set_int         = ies_enkf_set_int ,
+    .set_double      = ies_enkf_set_double ,
+    .set_bool        = NULL ,
+    .set_string      = ies_enkf_set_string ,
+    .get_options     = ies_enkf_get_options ,
+    .initX           = ies_enkf_initX ,
+    .updateA         = NULL,
+    .init_update     = NULL,
+    .complete_update = NULL,
+    .has_var         = ies_enkf_has_var,
+    .get_int         = ies_enkf_get_int,
+    .get_double      = ies_enkf_get_double,
+    .get_ptr         = ies_enkf_get_ptr,
+};
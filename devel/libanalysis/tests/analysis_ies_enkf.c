@@ -0,0 +1,302 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'analysis_ies_enkf.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/util/matrix.h>
+#include <ert/util/matrix_blas.h>
+
+#include <ert/analysis/analysis_module.h>
+#include <ert/analysis/std_enkf.h>
+#include <ert/analysis/ies_enkf.h>
+
+/*
+  Linear Gaussian test problem: y = G * x, observed with noise. For a
+  linear forward model the iterative smoother should converge to the
+  same solution as the standard EnKF update, and with steplength 1.0
+  it should reach that solution in one iteration.
+*/
+
+#define NX        4
+#define NOBS      6
+#define ENS_SIZE 25
+#define OBS_STD   0.25
+
+
+typedef struct {
+  matrix_type * G;
+  matrix_type * A0;
+  matrix_type * R;
+  matrix_type * dObs;
+  matrix_type * E;
+  matrix_type * D0;     /* dObs + E */
+} test_problem_type;
+
+
+
+static void test_problem_init( test_problem_type * problem , rng_type * rng ) {
+  problem->G    = matrix_alloc( NOBS , NX );
+  problem->A0   = matrix_alloc( NX , ENS_SIZE );
+  problem->R    = matrix_alloc( NOBS , NOBS );
+  problem->dObs = matrix_alloc( NOBS , 2 );
+  problem->E    = matrix_alloc( NOBS , ENS_SIZE );
+  problem->D0   = matrix_alloc( NOBS , ENS_SIZE );
+
+  for (int i=0; i < NOBS; i++)
+    for (int j=0; j < NX; j++)
+      matrix_iset( problem->G , i , j , rng_std_normal( rng ));
+
+  for (int i=0; i < NX; i++)
+    for (int j=0; j < ENS_SIZE; j++)
+      matrix_iset( problem->A0 , i , j , 1.0 + rng_std_normal( rng ));
+
+  matrix_set( problem->R , 0 );
+  for (int i=0; i < NOBS; i++) {
+    double obs_value = 0;
+    for (int j=0; j < NX; j++)
+      obs_value += matrix_iget( problem->G , i , j ) * 2.0;
+
+    obs_value += OBS_STD * rng_std_normal( rng );
+    matrix_iset( problem->dObs , i , 0 , obs_value );
+    matrix_iset( problem->dObs , i , 1 , OBS_STD );
+    matrix_iset( problem->R , i , i , OBS_STD * OBS_STD );
+
+    for (int j=0; j < ENS_SIZE; j++) {
+      matrix_iset( problem->E , i , j , OBS_STD * rng_std_normal( rng ));
+      matrix_iset( problem->D0 , i , j , obs_value + matrix_iget( problem->E , i , j ));
+    }
+  }
+}
+
+
+static void test_problem_free( test_problem_type * problem ) {
+  matrix_free( problem->G );
+  matrix_free( problem->A0 );
+  matrix_free( problem->R );
+  matrix_free( problem->dObs );
+  matrix_free( problem->E );
+  matrix_free( problem->D0 );
+}
+
+
+/* S = G * A and D = D0 - S */
+static void test_problem_forward( const test_problem_type * problem , const matrix_type * A , matrix_type * S , matrix_type * D) {
+  matrix_matmul( S , problem->G , A );
+  matrix_assign( D , problem->D0 );
+  matrix_inplace_sub( D , S );
+}
+
+
+static double max_diff( const matrix_type * m1 , const matrix_type * m2 ) {
+  double diff = 0;
+  test_assert_int_equal( matrix_get_rows( m1 ) , matrix_get_rows( m2 ));
+  test_assert_int_equal( matrix_get_columns( m1 ) , matrix_get_columns( m2 ));
+  for (int i=0; i < matrix_get_rows( m1 ); i++)
+    for (int j=0; j < matrix_get_columns( m1 ); j++)
+      diff = util_double_max( diff , fabs( matrix_iget( m1 , i , j ) - matrix_iget( m2 , i , j )));
+  return diff;
+}
+
+
+
+static matrix_type * alloc_std_update( const test_problem_type * problem ) {
+  matrix_type * A = matrix_alloc_copy( problem->A0 );
+  matrix_type * S = matrix_alloc( NOBS , ENS_SIZE );
+  matrix_type * D = matrix_alloc( NOBS , ENS_SIZE );
+  matrix_type * R = matrix_alloc_copy( problem->R );
+  matrix_type * X = matrix_alloc( ENS_SIZE , ENS_SIZE );
+
+  test_problem_forward( problem , A , S , D );
+  std_enkf_initX__( X , S , R , problem->E , D , DEFAULT_ENKF_TRUNCATION_ , -1 , false );
+  matrix_inplace_matmul( A , X );
+
+  matrix_free( S );
+  matrix_free( D );
+  matrix_free( R );
+  matrix_free( X );
+  return A;
+}
+
+
+static matrix_type * alloc_ies_update( analysis_module_type * module , const test_problem_type * problem , int num_iter) {
+  matrix_type * A = matrix_alloc_copy( problem->A0 );
+  matrix_type * S = matrix_alloc( NOBS , ENS_SIZE );
+  matrix_type * D = matrix_alloc( NOBS , ENS_SIZE );
+  matrix_type * R = matrix_alloc_copy( problem->R );
+  matrix_type * X = matrix_alloc( ENS_SIZE , ENS_SIZE );
+
+  test_assert_true( analysis_module_set_var( module , "NUM_ITER" , "0" ));
+  for (int iter = 0; iter < num_iter; iter++) {
+    test_problem_forward( problem , A , S , D );
+    analysis_module_initX( module , X , NULL , S , R , problem->dObs , problem->E , D );
+    matrix_inplace_matmul( A , X );
+  }
+  test_assert_int_equal( num_iter , analysis_module_get_int( module , "ITER" ));
+
+  matrix_free( S );
+  matrix_free( D );
+  matrix_free( R );
+  matrix_free( X );
+  return A;
+}
+
+
+
+void test_options( analysis_module_type * module ) {
+  test_assert_true( analysis_module_get_option( module , ANALYSIS_ITERABLE ));
+  test_assert_true( analysis_module_get_option( module , ANALYSIS_NEED_ED ));
+  test_assert_false( analysis_module_get_option( module , ANALYSIS_UPDATE_A ));
+
+  test_assert_true( analysis_module_set_var( module , IES_STEPLENGTH_KEY , "0.25" ));
+  test_assert_double_equal( 0.25 , analysis_module_get_double( module , IES_STEPLENGTH_KEY ));
+}
+
+
+void test_vars( analysis_module_type * module ) {
+  test_assert_true( analysis_module_has_var( module , ENKF_TRUNCATION_KEY_ ));
+  test_assert_true( analysis_module_has_var( module , ENKF_NCOMP_KEY_ ));
+  test_assert_true( analysis_module_has_var( module , "NUM_ITER" ));
+  test_assert_true( analysis_module_has_var( module , IES_MINISTEP_KEY ));
+
+  test_assert_true( analysis_module_set_var( module , ENKF_TRUNCATION_KEY_ , "0.95" ));
+  test_assert_double_equal( 0.95 , analysis_module_get_double( module , ENKF_TRUNCATION_KEY_ ));
+  test_assert_true( analysis_module_set_var( module , ENKF_NCOMP_KEY_ , "3" ));
+  test_assert_int_equal( 3 , analysis_module_get_int( module , ENKF_NCOMP_KEY_ ));
+  test_assert_true( analysis_module_set_var( module , ENKF_TRUNCATION_KEY_ , "0.98" ));
+  test_assert_int_equal( -1 , analysis_module_get_int( module , ENKF_NCOMP_KEY_ ));
+
+  test_assert_true( analysis_module_set_var( module , "NUM_ITER" , "2" ));
+  test_assert_int_equal( 2 , analysis_module_get_int( module , "NUM_ITER" ));
+
+  test_assert_true( analysis_module_set_var( module , IES_MINISTEP_KEY , "LOCAL" ));
+  test_assert_string_equal( "LOCAL" , analysis_module_get_ptr( module , IES_MINISTEP_KEY ));
+  test_assert_true( analysis_module_set_var( module , IES_MINISTEP_KEY , "7" ));
+  test_assert_string_equal( "7" , analysis_module_get_ptr( module , IES_MINISTEP_KEY ));
+  test_assert_true( analysis_module_set_var( module , IES_MINISTEP_KEY , "ALL_ACTIVE" ));
+
+  /* An invalid steplength is rejected and the old value is kept. */
+  test_assert_true( analysis_module_set_var( module , IES_STEPLENGTH_KEY , "0.25" ));
+  test_assert_false( analysis_module_set_var( module , IES_STEPLENGTH_KEY , "1.5" ));
+  test_assert_false( analysis_module_set_var( module , IES_STEPLENGTH_KEY , "0" ));
+  test_assert_double_equal( 0.25 , analysis_module_get_double( module , IES_STEPLENGTH_KEY ));
+}
+
+
+void test_one_step( analysis_module_type * module , const test_problem_type * problem , const matrix_type * A_std) {
+  test_assert_true( analysis_module_set_var( module , IES_STEPLENGTH_KEY , "1.0" ));
+  {
+    matrix_type * A = alloc_ies_update( module , problem , 1 );
+    test_assert_true( max_diff( A , A_std ) < 1e-10 );
+    matrix_free( A );
+  }
+}
+
+
+void test_converge( analysis_module_type * module , const test_problem_type * problem , const matrix_type * A_std) {
+  test_assert_true( analysis_module_set_var( module , IES_STEPLENGTH_KEY , "0.5" ));
+  {
+    matrix_type * A1  = alloc_ies_update( module , problem , 1 );
+    matrix_type * A40 = alloc_ies_update( module , problem , 40 );
+
+    test_assert_true( max_diff( A1 , A_std ) > 1e-3 );
+    test_assert_true( max_diff( A40 , A_std ) < 1e-8 );
+
+    matrix_free( A1 );
+    matrix_free( A40 );
+  }
+}
+
+
+
+/*
+  Two ministeps updated in turn, as enkf_main does with localisation,
+  with the iteration number set before every update; each ministep has
+  its own W and must end up as the ensemble from one sequence of
+  iterations.
+*/
+
+void test_ministeps( analysis_module_type * module , const test_problem_type * problem ) {
+  const int num_iter = 5;
+  const char * ministeps[2] = { "MINISTEP_A" , "MINISTEP_B" };
+  matrix_type * A_ref;
+  matrix_type * A[2];
+  matrix_type * S = matrix_alloc( NOBS , ENS_SIZE );
+  matrix_type * D = matrix_alloc( NOBS , ENS_SIZE );
+  matrix_type * R = matrix_alloc_copy( problem->R );
+  matrix_type * X = matrix_alloc( ENS_SIZE , ENS_SIZE );
+
+  test_assert_true( analysis_module_set_var( module , IES_STEPLENGTH_KEY , "0.5" ));
+  A_ref = alloc_ies_update( module , problem , num_iter );
+  for (int m = 0; m < 2; m++)
+    A[m] = matrix_alloc_copy( problem->A0 );
+
+  for (int iter = 0; iter < num_iter; iter++) {
+    char * iter_str = util_alloc_sprintf( "%d" , iter );
+    for (int m = 0; m < 2; m++) {
+      test_assert_true( analysis_module_set_var( module , "NUM_ITER" , iter_str ));
+      test_assert_true( analysis_module_set_var( module , IES_MINISTEP_KEY , ministeps[m] ));
+      test_problem_forward( problem , A[m] , S , D );
+      analysis_module_initX( module , X , NULL , S , R , problem->dObs , problem->E , D );
+      matrix_inplace_matmul( A[m] , X );
+    }
+    free( iter_str );
+  }
+
+  for (int m = 0; m < 2; m++) {
+    test_assert_true( max_diff( A[m] , A_ref ) < 1e-10 );
+    matrix_free( A[m] );
+  }
+  test_assert_true( analysis_module_set_var( module , IES_MINISTEP_KEY , "ALL_ACTIVE" ));
+
+  matrix_free( A_ref );
+  matrix_free( S );
+  matrix_free( D );
+  matrix_free( R );
+  matrix_free( X );
+}
+
+
+
+int main(int argc , char ** argv) {
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+  analysis_module_type * module = analysis_module_alloc_internal( rng , "IES_ENKF" , "ies_enkf_symbol_table" );
+  test_problem_type problem;
+
+  test_assert_not_NULL( module );
+  test_problem_init( &problem , rng );
+  {
+    matrix_type * A_std = alloc_std_update( &problem );
+
+    test_options( module );
+    test_vars( module );
+    test_one_step( module , &problem , A_std );
+    test_converge( module , &problem , A_std );
+    test_ministeps( module , &problem );
+
+    matrix_free( A_std );
+  }
+  test_problem_free( &problem );
+  analysis_module_free( module );
+  rng_free( rng );
+  exit(0);
+}
@@ -49,6 +49,7 @@ typedef struct config_struct              config_type;
   config_type *     config_alloc( );
   char       **     config_alloc_active_list(const config_type * , int * );
   bool              config_parse(config_type * , const char * , const char * , const char * , const char * , config_schema_unrecognized_enum unrecognized_behaviour , bool );
+  void              config_set_store_parse_cache( config_type * config , bool store_parse_cache );
   bool              config_has_schema_item(const config_type * config , const char * kw);
   void              config_clear(config_type * config);
 
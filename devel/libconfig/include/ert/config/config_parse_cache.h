@@ -0,0 +1,56 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'config_parse_cache.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __CONFIG_PARSE_CACHE_H__
+#define __CONFIG_PARSE_CACHE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <ert/util/stringlist.h>
+#include <ert/util/subst_list.h>
+#include <ert/util/type_macros.h>
+
+  typedef struct config_parse_cache_struct config_parse_cache_type;
+  typedef struct config_cache_file_struct  config_cache_file_type;
+
+  config_parse_cache_type * config_parse_cache_alloc( );
+  void                      config_parse_cache_free( config_parse_cache_type * cache );
+  config_cache_file_type  * config_parse_cache_get_file( config_parse_cache_type * cache , const char * filename );
+  bool                      config_parse_cache_has_file( const config_parse_cache_type * cache , const char * filename );
+  bool                      config_parse_cache_is_modified( const config_parse_cache_type * cache );
+  void                      config_parse_cache_fwrite( config_parse_cache_type * cache , const char * cache_file );
+  bool                      config_parse_cache_fread( config_parse_cache_type * cache , const char * cache_file );
+  int                       config_parse_cache_get_num_tokenized( const config_parse_cache_type * cache );
+  uint64_t                  config_parse_cache_hash_string( uint64_t hash , const char * s );
+
+  int                       config_cache_file_get_size( const config_cache_file_type * cache_file );
+  const stringlist_type   * config_cache_file_iget_tokens( const config_cache_file_type * cache_file , int line_nr );
+  const stringlist_type   * config_cache_file_iget_filtered_tokens( config_cache_file_type * cache_file , int line_nr ,
+                                                                    const subst_list_type * define_list , uint64_t define_hash );
+
+  UTIL_IS_INSTANCE_HEADER( config_parse_cache );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
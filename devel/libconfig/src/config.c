@@ -20,11 +20,11 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <unistd.h>
 
 #include <ert/util/type_macros.h>
 #include <ert/util/util.h>
-#include <ert/util/parser.h>
 #include <ert/util/hash.h>
 #include <ert/util/stringlist.h>
 #include <ert/util/set.h>
@@ -39,6 +39,7 @@
 #include <ert/config/config_content_item.h>
 #include <ert/config/config_path_elm.h>
 #include <ert/config/config_root_path.h>
+#include <ert/config/config_parse_cache.h>
 
 #define  CLEAR_STRING "__RESET__"
 
@@ -139,6 +140,9 @@ struct config_struct {
   set_type             * parsed_files;              /* A set of config files whcih have been parsed - to protect against circular includes. */
   hash_type            * messages;                  /* Can print a (warning) message when a keyword is encountered. */
   subst_list_type      * define_list;
+  uint64_t               define_hash;               /* Hash of the DEFINE statements added to the define_list. */
+  config_parse_cache_type * parse_cache;            /* The tokenized config files; survives config_clear(). */
+  bool                   store_parse_cache;         /* Should the parse_cache be stored next to the main config file? */
   char                 * config_file;               /* The last parsed file - NULL if no file is parsed-. */
   char                 * abs_path;
   config_root_path_type * invoke_path;
@@ -176,9 +180,8 @@ static config_content_node_type * config_get_new_content_node(config_type * conf
   informative error messages, and can be NULL. The config_cwd is
   essential if we are looking up a filename, otherwise it can be NULL.
 
-  Returns a string with an error description, or NULL if the supplied
-  arguments were OK. The string is allocated here, but is assumed that
-  calling scope will free it.
+  The DEFINE substitutions have already been applied to the arguments
+  in token_list when this function is called, see config_parse__().
 */
 
 static void config_content_item_set_arg__(config_type * config , config_content_item_type * item , stringlist_type * token_list , 
@@ -186,22 +189,9 @@ static void config_content_item_set_arg__(config_type * config , config_content_
                                           const char * config_file ) {
 
   int argc = stringlist_get_size( token_list ) - 1;
-
-  if (argc == 1 && (strcmp(stringlist_iget(token_list , 1) , CLEAR_STRING) == 0)) {
-    config_content_item_clear(item);
-  } else {
+  {
     const config_schema_item_type * schema_item = config_content_item_get_schema( item );
     
-    /* Filtering based on DEFINE statements */
-    if (subst_list_get_size( config->define_list ) > 0) {
-      int iarg;
-      for (iarg = 0; iarg < argc; iarg++) {
-        char * filtered_copy = subst_list_alloc_filtered_string( config->define_list , stringlist_iget(token_list , iarg + 1));
-        stringlist_iset_owned_ref( token_list , iarg + 1 , filtered_copy);
-      }
-    }
-
-    
     /* Filtering based on environment variables */
     if (config_schema_item_expand_envvar( schema_item )) {
       int iarg;
@@ -253,6 +243,9 @@ config_type * config_alloc() {
   config->parsed_files    = set_alloc_empty();
   config->messages        = hash_alloc();
   config->define_list     = subst_list_alloc( NULL );
+  config->define_hash     = 0;
+  config->parse_cache     = config_parse_cache_alloc( );
+  config->store_parse_cache = false;
   config->config_file     = NULL;
   config->abs_path        = NULL;
   config->invoke_path     = NULL;
@@ -274,6 +267,7 @@ void config_clear(config_type * config) {
 
   set_clear(config->parsed_files);
   subst_list_clear( config->define_list );
+  config->define_hash = 0;
   config_clear_content_items( config );
   vector_clear( config->path_elm_storage );
   vector_clear( config->path_elm_stack );
@@ -294,6 +288,7 @@ void config_free(config_type * config) {
   config_error_free( config->parse_errors );
   set_free(config->parsed_files);
   subst_list_free( config->define_list );
+  config_parse_cache_free( config->parse_cache );
   
   vector_free( config->path_elm_storage );
   vector_free( config->path_elm_stack );
@@ -421,6 +416,8 @@ bool config_item_set(const config_type * config , const char * kw) {
 
 void config_add_define( config_type * config , const char * key , const char * value ) {
   subst_list_append_copy( config->define_list , key , value , NULL );
+  config->define_hash = config_parse_cache_hash_string( config->define_hash , key );
+  config->define_hash = config_parse_cache_hash_string( config->define_hash , value );
 }
 
 
@@ -625,12 +622,10 @@ static void config_parse__(config_type * config ,
                            bool validate) {
 
   /* Guard against circular includes. */
-  {
-    char * abs_filename = util_alloc_realpath(config_input);
-    if (!set_add_key(config->parsed_files , abs_filename)) 
-      util_exit("%s: file:%s already parsed - circular include ? \n",__func__ , abs_filename);
-    free( abs_filename );
-  }
+  char * abs_filename = util_alloc_realpath(config_input);
+  if (!set_add_key(config->parsed_files , abs_filename)) 
+    util_exit("%s: file:%s already parsed - circular include ? \n",__func__ , abs_filename);
+  
   config_path_elm_type * current_path_elm;
 
   char * config_file;
@@ -655,104 +650,84 @@ static void config_parse__(config_type * config ,
   
 
   {
-    parser_type * parser = parser_alloc(" \t" , "\"", NULL , NULL , "--" , "\n");
-    FILE * stream = util_fopen(config_file , "r");
-    bool   at_eof = false;
+    config_cache_file_type * cache_file = config_parse_cache_get_file( config->parse_cache , abs_filename );
+    int line_nr;
     
-    while (!at_eof) {
-      int    active_tokens;
-      stringlist_type * token_list;
-      char  *line_buffer;
-      
-      
-      line_buffer  = util_fscanf_alloc_line(stream , &at_eof);
-      if (line_buffer != NULL) {
-        token_list = parser_tokenize_buffer(parser , line_buffer , true);
-        active_tokens = stringlist_get_size( token_list );
-        
-        /*
-          util_split_string(line_buffer , " \t" , &tokens , &token_list);
-          active_tokens = tokens;
-          for (i = 0; i < tokens; i++) {
-          char * comment_ptr = NULL;
-          if(comment_string != NULL)
-          comment_ptr = strstr(token_list[i] , comment_string);
+    for (line_nr = 0; line_nr < config_cache_file_get_size( cache_file ); line_nr++) {
+      const stringlist_type * token_list = config_cache_file_iget_tokens( cache_file , line_nr );
+      int active_tokens = stringlist_get_size( token_list );
+      const char * kw = stringlist_iget( token_list , 0 );
           
-          if (comment_ptr != NULL) {
-          if (comment_ptr == token_list[i])
-          active_tokens = i;
-          else
-          active_tokens = i + 1;
-          break;
-          }
+      /*Treating the include keyword. */
+      if (include_kw != NULL && (strcmp(include_kw , kw) == 0)) {
+        if (active_tokens != 2) 
+          util_abort("%s: keyword:%s must have exactly one argument. \n",__func__ ,include_kw);
+        {
+          const char *include_file  = stringlist_iget( token_list , 1);
+          if (util_file_exists( include_file ))
+            config_parse__(config , path_stack , include_file , comment_string , include_kw , define_kw , unrecognized, false); /* Recursive call */
+          else 
+            config_error_add(config->parse_errors , util_alloc_sprintf("%s file:%s not found" , include_kw , include_file));
+        }
+      } else if ((define_kw != NULL) && (strcmp(define_kw , kw) == 0)) {
+        /* Treating the define keyword. */
+        if (active_tokens < 3) 
+          util_abort("%s: keyword:%s must have exactly one (or more) arguments. \n",__func__ , define_kw);
+        {
+          char * key   = util_alloc_string_copy( stringlist_iget(token_list ,1) );
+          char * value = stringlist_alloc_joined_substring( token_list , 2 , active_tokens , " ");
+          
+          {
+            char * filtered_value = subst_list_alloc_filtered_string( config->define_list , value);
+            config_add_define( config , key , filtered_value );
+            free( filtered_value );
           }
-        */
+          free(key);
+          free(value);
+        }
+      } else {
+        if (hash_has_key(config->messages , kw))
+          printf("%s \n", (const char *) hash_get(config->messages , kw));
         
-        if (active_tokens > 0) {
-          const char * kw = stringlist_iget( token_list , 0 );
+        if (!config_has_schema_item(config , kw)) {
+          if (unrecognized == CONFIG_UNRECOGNIZED_WARN)
+            fprintf(stderr,"** Warning keyword:%s not recognized when parsing:%s --- \n" , kw , config_input);
+          else if (unrecognized == CONFIG_UNRECOGNIZED_ERROR) 
+            config_error_add(config->parse_errors , util_alloc_sprintf("Keyword:%s is not recognized" , kw));
           
-          /*Treating the include keyword. */
-          if (include_kw != NULL && (strcmp(include_kw , kw) == 0)) {
-            if (active_tokens != 2) 
-              util_abort("%s: keyword:%s must have exactly one argument. \n",__func__ ,include_kw);
-            {
-              const char *include_file  = stringlist_iget( token_list , 1);
-              if (util_file_exists( include_file ))
-                config_parse__(config , path_stack , include_file , comment_string , include_kw , define_kw , unrecognized, false); /* Recursive call */
-              else 
-                config_error_add(config->parse_errors , util_alloc_sprintf("%s file:%s not found" , include_kw , include_file));
-            }
-          } else if ((define_kw != NULL) && (strcmp(define_kw , kw) == 0)) {
-            /* Treating the define keyword. */
-            if (active_tokens < 3) 
-              util_abort("%s: keyword:%s must have exactly one (or more) arguments. \n",__func__ , define_kw);
-            {
-              char * key   = util_alloc_string_copy( stringlist_iget(token_list ,1) );
-              char * value = stringlist_alloc_joined_substring( token_list , 2 , active_tokens , " ");
-                
-              {
-                char * filtered_value = subst_list_alloc_filtered_string( config->define_list , value);
-                config_add_define( config , key , filtered_value );
-                free( filtered_value );
-              }
-              free(key);
-              free(value);
-            }
-          } else {
-            if (hash_has_key(config->messages , kw))
-              printf("%s \n", (const char *) hash_get(config->messages , kw));
-              
-            if (!config_has_schema_item(config , kw)) {
-              if (unrecognized == CONFIG_UNRECOGNIZED_WARN)
-                fprintf(stderr,"** Warning keyword:%s not recognized when parsing:%s --- \n" , kw , config_input);
-              else if (unrecognized == CONFIG_UNRECOGNIZED_ERROR) 
-                config_error_add(config->parse_errors , util_alloc_sprintf("Keyword:%s is not recognized" , kw));
-                
-            }
-
-            if (config_has_schema_item(config , kw)) {
-              char * config_cwd;
-              util_alloc_file_components( config_file , &config_cwd , NULL , NULL );
-                
-              if (!config_has_content_item( config , kw ))
-                config_add_content_item( config , kw , current_path_elm );
-
-              {
-                config_content_item_type * content_item = config_get_content_item( config , kw );
-                config_content_item_set_arg__(config , content_item , token_list , current_path_elm , config_file );
-              }
-            } 
-          }
         }
-        stringlist_free(token_list);
-        free(line_buffer);
+        
+        if (config_has_schema_item(config , kw)) {
+          config_content_item_type * content_item;
+          
+          if (!config_has_content_item( config , kw ))
+            config_add_content_item( config , kw , current_path_elm );
+          
+          content_item = config_get_content_item( config , kw );
+          if (active_tokens == 2 && (strcmp(stringlist_iget(token_list , 1) , CLEAR_STRING) == 0)) 
+            config_content_item_clear( content_item );
+          else {
+            /* 
+               The DEFINE substitutions are taken from the cache if the
+               same DEFINE statements were active when the line was
+               parsed the last time.
+            */
+            stringlist_type * arg_list;
+            if (subst_list_get_size( config->define_list ) > 0) 
+              arg_list = stringlist_alloc_deep_copy( config_cache_file_iget_filtered_tokens( cache_file , line_nr , config->define_list , config->define_hash ));
+            else
+              arg_list = stringlist_alloc_deep_copy( token_list );
+            
+            config_content_item_set_arg__(config , content_item , arg_list , current_path_elm , config_file );
+            stringlist_free( arg_list );
+          }
+        } 
       }
     }
     if (validate) 
       config_validate(config , config_file);
-    fclose(stream);
-    parser_free( parser );
   }
+  free(abs_filename);
   free(config_file);
   path_stack_pop( path_stack );
   vector_pop_back( config->path_elm_stack );
@@ -788,6 +763,36 @@ void config_fprintf_errors( const config_type * config , bool add_count , FILE *
 
 
 
+/*
+  If store_parse_cache is set the tokenized config files are stored in
+  a hidden cache file next to the main config file, i.e.
+  /path/to/config is cached in /path/to/.config.cache, and the cache
+  is loaded again by the next process parsing the same file. The cache
+  covers the main file and all the included files; if the directory is
+  not writable the cache is not stored.
+*/
+
+void config_set_store_parse_cache( config_type * config , bool store_parse_cache ) {
+  config->store_parse_cache = store_parse_cache;
+}
+
+
+static char * config_alloc_parse_cache_file( const char * abs_filename ) {
+  char * path;
+  char * name;
+  char * cache_file;
+
+  util_alloc_file_components( abs_filename , &path , NULL , NULL );
+  name = util_alloc_sprintf( ".%s" , abs_filename + strlen( path ) + 1 );
+  cache_file = util_alloc_filename( path , name , "cache" );
+
+  free( name );
+  free( path );
+  return cache_file;
+}
+
+
+
 bool config_parse(config_type * config , 
                   const char * filename, 
                   const char * comment_string , 
@@ -798,11 +803,28 @@ bool config_parse(config_type * config ,
   
   if (util_file_readable( filename )) {
     path_stack_type * path_stack = path_stack_alloc();
+    char * cache_file = NULL;
+
+    if (config->store_parse_cache) {
+      char * abs_filename = util_alloc_realpath( filename );
+      cache_file = config_alloc_parse_cache_file( abs_filename );
+      if (!config_parse_cache_has_file( config->parse_cache , abs_filename ))
+        config_parse_cache_fread( config->parse_cache , cache_file );
+      free( abs_filename );
+    }
     {
       config_set_config_file( config , filename );
       config_set_invoke_path( config );
       config_parse__(config , path_stack , filename , comment_string , include_kw , define_kw , unrecognized_behaviour , validate);
     }
+    if ((cache_file != NULL) && config_parse_cache_is_modified( config->parse_cache )) {
+      char * cache_path = util_split_alloc_dirname( cache_file );
+      if (util_entry_writable( cache_path ))
+        config_parse_cache_fwrite( config->parse_cache , cache_file );
+      free( cache_path );
+    }
+
+    util_safe_free( cache_file );
     path_stack_free( path_stack );
   } else 
     config_error_add( config->parse_errors , util_alloc_sprintf("Could not open file:%s for parsing" , filename));
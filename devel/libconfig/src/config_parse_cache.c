@@ -0,0 +1,569 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'config_parse_cache.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <ert/util/type_macros.h>
+#include <ert/util/util.h>
+#include <ert/util/hash.h>
+#include <ert/util/buffer.h>
+#include <ert/util/vector.h>
+#include <ert/util/parser.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/subst_list.h>
+
+#include <ert/config/config_parse_cache.h>
+
+/*
+  The config_parse_cache holds the tokenized lines of the config files
+  which have been parsed, indexed by the real path of the file. When a
+  file is parsed again it is read, and the size and a hash of the
+  content are compared with the cached values; only if the content has
+  changed is the file tokenized again.
+
+  For every line the cache can also hold the arguments after the
+  DEFINE substitutions, together with a hash of the DEFINE statements
+  which were used. The DEFINE statements which are active when a line
+  is parsed depend on what has been parsed before, so the substituted
+  arguments are only reused when the hash is the same.
+
+  The cache can be stored on disk with config_parse_cache_fwrite() and
+  loaded again with config_parse_cache_fread(), so that a later process
+  parsing the same files does not have to tokenize them again. The
+  layout of the cache file is:
+
+     CONFIG_PARSE_CACHE_ID
+     CONFIG_PARSE_CACHE_VERSION
+     num_files      ( filename , content_size , content_hash , num_lines , line* )*
+     CONFIG_PARSE_CACHE_ID
+
+  where every line is stored as:
+
+     tokens  has_filtered  [ define_hash  filtered_tokens ]
+
+  The cache file is written by other processes and might be corrupt;
+  it is therefore read with bounds checks on every item, and a file
+  which can not be read completely is rejected as a whole.
+*/
+
+#define CONFIG_PARSE_CACHE_TYPE_ID  6617022
+#define CONFIG_CACHE_FILE_TYPE_ID   6617023
+
+#define CONFIG_PARSE_CACHE_ID       6617024     /* Written at the start and the end of the cache file. */
+#define CONFIG_PARSE_CACHE_VERSION  1           /* Must be bumped when the layout of the cache file changes. */
+
+#define FNV_OFFSET  14695981039346656037ULL
+#define FNV_PRIME   1099511628211ULL
+
+
+typedef struct {
+  stringlist_type * tokens;
+  stringlist_type * filtered_tokens;    // NULL until the DEFINE substitutions have been applied.
+  uint64_t          define_hash;        // The hash of the DEFINE statements used for filtered_tokens.
+} config_cache_line_type;
+
+
+struct config_cache_file_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  bool          valid;                  // false until the file has been tokenized or loaded.
+  bool          modified;               // Changed since the cache was loaded or stored.
+  int           content_size;
+  uint64_t      content_hash;
+  vector_type * lines;
+};
+
+
+struct config_parse_cache_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  hash_type   * files;
+  parser_type * parser;
+  int           num_tokenized;
+};
+
+
+static uint64_t config_parse_cache_hash_buffer( uint64_t hash , const char * buffer , int size) {
+  int i;
+  for (i=0; i < size; i++) {
+    hash ^= (unsigned char) buffer[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+
+/*
+  Hashes the string including the terminating \0, so that hashing
+  "AB" and "C" in turn is different from hashing "A" and "BC".
+*/
+
+uint64_t config_parse_cache_hash_string( uint64_t hash , const char * s ) {
+  if (hash == 0)
+    hash = FNV_OFFSET;
+  return config_parse_cache_hash_buffer( hash , s , strlen( s ) + 1);
+}
+
+/*****************************************************************/
+
+static config_cache_line_type * config_cache_line_alloc( stringlist_type * tokens ) {
+  config_cache_line_type * line = util_malloc( sizeof * line );
+  line->tokens = tokens;
+  line->filtered_tokens = NULL;
+  line->define_hash = 0;
+  return line;
+}
+
+
+static void config_cache_line_free( config_cache_line_type * line ) {
+  stringlist_free( line->tokens );
+  if (line->filtered_tokens != NULL)
+    stringlist_free( line->filtered_tokens );
+  free( line );
+}
+
+
+static void config_cache_line_free__( void * arg ) {
+  config_cache_line_free( (config_cache_line_type *) arg );
+}
+
+
+static void config_cache_line_buffer_fwrite( const config_cache_line_type * line , buffer_type * buffer ) {
+  stringlist_buffer_fwrite( line->tokens , buffer );
+  buffer_fwrite_bool( buffer , line->filtered_tokens != NULL );
+  if (line->filtered_tokens != NULL) {
+    buffer_fwrite( buffer , &line->define_hash , sizeof line->define_hash , 1 );
+    stringlist_buffer_fwrite( line->filtered_tokens , buffer );
+  }
+}
+
+
+/*
+  The safe readers return false if the item can not be read from the
+  buffer, instead of calling util_abort() as the plain buffer_fread()
+  functions do.
+*/
+
+static bool config_parse_cache_safe_fread( buffer_type * buffer , void * target , size_t size ) {
+  return (buffer_safe_fread( buffer , target , size , 1 ) == 1);
+}
+
+
+/*
+  Reads a count, which must be non-negative and can not be larger than
+  the number of items of at least @item_size bytes remaining in the
+  buffer.
+*/
+
+static bool config_parse_cache_safe_fread_count( buffer_type * buffer , int * count , size_t item_size ) {
+  if (config_parse_cache_safe_fread( buffer , count , sizeof * count ))
+    return ((*count >= 0) && ((size_t) *count <= buffer_get_remaining_size( buffer ) / item_size));
+  else
+    return false;
+}
+
+
+/* The layout of buffer_fwrite_string(): length, the characters and a terminating \0. */
+static char * config_parse_cache_safe_fread_alloc_string( buffer_type * buffer ) {
+  int length;
+  if (config_parse_cache_safe_fread_count( buffer , &length , 1 ) && ((size_t) length < buffer_get_remaining_size( buffer ))) {
+    const char * data = (const char *) buffer_get_data( buffer ) + buffer_get_offset( buffer );
+    if ((data[length] == '\0') && (memchr( data , '\0' , length ) == NULL)) {
+      buffer_fskip( buffer , length + 1 );
+      return util_alloc_string_copy( data );
+    }
+  }
+  return NULL;
+}
+
+
+static bool config_parse_cache_safe_fread_stringlist( buffer_type * buffer , stringlist_type * s ) {
+  int size , i;
+  if (!config_parse_cache_safe_fread_count( buffer , &size , sizeof(int) + 1 ))
+    return false;
+
+  for (i=0; i < size; i++) {
+    char * string = config_parse_cache_safe_fread_alloc_string( buffer );
+    if (string == NULL)
+      return false;
+    stringlist_append_owned_ref( s , string );
+  }
+  return true;
+}
+
+
+static config_cache_line_type * config_cache_line_buffer_fread_alloc( buffer_type * buffer ) {
+  config_cache_line_type * line = config_cache_line_alloc( stringlist_alloc_new( ) );
+  bool has_filtered;
+  bool OK = config_parse_cache_safe_fread_stringlist( buffer , line->tokens ) &&
+            (stringlist_get_size( line->tokens ) > 0) &&
+            config_parse_cache_safe_fread( buffer , &has_filtered , sizeof has_filtered );
+
+  if (OK && has_filtered) {
+    line->filtered_tokens = stringlist_alloc_new( );
+    OK = config_parse_cache_safe_fread( buffer , &line->define_hash , sizeof line->define_hash ) &&
+         config_parse_cache_safe_fread_stringlist( buffer , line->filtered_tokens ) &&
+         (stringlist_get_size( line->filtered_tokens ) == stringlist_get_size( line->tokens ));
+  }
+
+  if (!OK) {
+    config_cache_line_free( line );
+    line = NULL;
+  }
+  return line;
+}
+
+/*****************************************************************/
+
+static UTIL_SAFE_CAST_FUNCTION( config_cache_file , CONFIG_CACHE_FILE_TYPE_ID )
+
+static config_cache_file_type * config_cache_file_alloc( ) {
+  config_cache_file_type * cache_file = util_malloc( sizeof * cache_file );
+  UTIL_TYPE_ID_INIT( cache_file , CONFIG_CACHE_FILE_TYPE_ID );
+  cache_file->valid = false;
+  cache_file->modified = false;
+  cache_file->content_size = 0;
+  cache_file->content_hash = 0;
+  cache_file->lines = vector_alloc_new();
+  return cache_file;
+}
+
+
+static void config_cache_file_free( config_cache_file_type * cache_file ) {
+  vector_free( cache_file->lines );
+  free( cache_file );
+}
+
+
+static void config_cache_file_free__( void * arg ) {
+  config_cache_file_type * cache_file = config_cache_file_safe_cast( arg );
+  config_cache_file_free( cache_file );
+}
+
+
+/*
+  The content of the file is tokenized line by line exactly as
+  config_parse__() used to do with util_fscanf_alloc_line(); lines
+  without any tokens, i.e. blank lines and comments, are not stored.
+*/
+
+static void config_cache_file_tokenize( config_cache_file_type * cache_file , const parser_type * parser , const char * content , int content_size) {
+  int offset = 0;
+
+  vector_clear( cache_file->lines );
+  while (offset < content_size) {
+    int line_length = 0;
+    while ((offset + line_length < content_size) && (content[offset + line_length] != '\n') && (content[offset + line_length] != '\r'))
+      line_length++;
+
+    {
+      char * line_buffer = util_alloc_substring_copy( content , offset , line_length );
+      stringlist_type * tokens = parser_tokenize_buffer( parser , line_buffer , true );
+      if (stringlist_get_size( tokens ) > 0)
+        vector_append_owned_ref( cache_file->lines , config_cache_line_alloc( tokens ) , config_cache_line_free__ );
+      else
+        stringlist_free( tokens );
+      free( line_buffer );
+    }
+
+    offset += line_length;
+    if ((offset < content_size) && (content[offset] == '\r'))    /* DOS line ending. */
+      offset++;
+    offset++;
+  }
+}
+
+
+static void config_cache_file_buffer_fwrite( const config_cache_file_type * cache_file , buffer_type * buffer ) {
+  int line_nr;
+  buffer_fwrite_int( buffer , cache_file->content_size );
+  buffer_fwrite( buffer , &cache_file->content_hash , sizeof cache_file->content_hash , 1 );
+  buffer_fwrite_int( buffer , vector_get_size( cache_file->lines ));
+  for (line_nr = 0; line_nr < vector_get_size( cache_file->lines ); line_nr++)
+    config_cache_line_buffer_fwrite( vector_iget_const( cache_file->lines , line_nr ) , buffer );
+}
+
+
+/*
+  Returns NULL if the file can not be read completely from the buffer.
+*/
+
+static config_cache_file_type * config_cache_file_buffer_fread_alloc( buffer_type * buffer ) {
+  config_cache_file_type * cache_file = config_cache_file_alloc( );
+  int num_lines , line_nr;
+  bool OK = config_parse_cache_safe_fread( buffer , &cache_file->content_size , sizeof cache_file->content_size ) &&
+            (cache_file->content_size >= 0) &&
+            config_parse_cache_safe_fread( buffer , &cache_file->content_hash , sizeof cache_file->content_hash ) &&
+            config_parse_cache_safe_fread_count( buffer , &num_lines , sizeof(int) + sizeof(bool) );
+
+  for (line_nr = 0; OK && (line_nr < num_lines); line_nr++) {
+    config_cache_line_type * line = config_cache_line_buffer_fread_alloc( buffer );
+    if (line != NULL)
+      vector_append_owned_ref( cache_file->lines , line , config_cache_line_free__ );
+    else
+      OK = false;
+  }
+
+  if (OK)
+    cache_file->valid = true;
+  else {
+    config_cache_file_free( cache_file );
+    cache_file = NULL;
+  }
+  return cache_file;
+}
+
+
+int config_cache_file_get_size( const config_cache_file_type * cache_file ) {
+  return vector_get_size( cache_file->lines );
+}
+
+
+const stringlist_type * config_cache_file_iget_tokens( const config_cache_file_type * cache_file , int line_nr ) {
+  const config_cache_line_type * line = vector_iget_const( cache_file->lines , line_nr );
+  return line->tokens;
+}
+
+
+/*
+  Returns the tokens of the line where all the arguments, i.e. all
+  tokens except the keyword, have been filtered through the
+  define_list. The define_hash should identify the content of the
+  define_list; it is the responsibility of the calling scope to update
+  it when the define_list is updated.
+*/
+
+const stringlist_type * config_cache_file_iget_filtered_tokens( config_cache_file_type * cache_file , int line_nr ,
+                                                                const subst_list_type * define_list , uint64_t define_hash ) {
+  config_cache_line_type * line = vector_iget( cache_file->lines , line_nr );
+
+  if ((line->filtered_tokens == NULL) || (line->define_hash != define_hash)) {
+    int iarg;
+
+    if (line->filtered_tokens == NULL)
+      line->filtered_tokens = stringlist_alloc_new( );
+    else
+      stringlist_clear( line->filtered_tokens );
+
+    stringlist_append_copy( line->filtered_tokens , stringlist_iget( line->tokens , 0 ));
+    for (iarg = 1; iarg < stringlist_get_size( line->tokens ); iarg++) {
+      char * filtered_copy = subst_list_alloc_filtered_string( define_list , stringlist_iget( line->tokens , iarg ));
+      stringlist_append_owned_ref( line->filtered_tokens , filtered_copy );
+    }
+    line->define_hash = define_hash;
+    cache_file->modified = true;
+  }
+  return line->filtered_tokens;
+}
+
+/*****************************************************************/
+
+UTIL_IS_INSTANCE_FUNCTION( config_parse_cache , CONFIG_PARSE_CACHE_TYPE_ID )
+
+
+config_parse_cache_type * config_parse_cache_alloc( ) {
+  config_parse_cache_type * cache = util_malloc( sizeof * cache );
+  UTIL_TYPE_ID_INIT( cache , CONFIG_PARSE_CACHE_TYPE_ID );
+  cache->files = hash_alloc();
+  cache->parser = parser_alloc(" \t" , "\"", NULL , NULL , "--" , "\n");
+  cache->num_tokenized = 0;
+  return cache;
+}
+
+
+void config_parse_cache_free( config_parse_cache_type * cache ) {
+  hash_free( cache->files );
+  parser_free( cache->parser );
+  free( cache );
+}
+
+
+/*
+  Returns the cached version of the file, which is tokenized if it is
+  not in the cache or the content has changed since it was cached. The
+  filename should be the real path of the file; the same file should
+  not be referenced by different names.
+*/
+
+config_cache_file_type * config_parse_cache_get_file( config_parse_cache_type * cache , const char * filename ) {
+  config_cache_file_type * cache_file;
+  int content_size;
+  char * content = util_fread_alloc_file_content( filename , &content_size );
+  uint64_t content_hash = config_parse_cache_hash_buffer( FNV_OFFSET , content , content_size );
+
+  if (hash_has_key( cache->files , filename ))
+    cache_file = hash_get( cache->files , filename );
+  else {
+    cache_file = config_cache_file_alloc( );
+    hash_insert_hash_owned_ref( cache->files , filename , cache_file , config_cache_file_free__ );
+  }
+
+  if (!cache_file->valid ||
+      (cache_file->content_hash != content_hash) ||
+      (cache_file->content_size != content_size)) {
+
+    cache_file->valid = true;
+    cache_file->modified = true;
+    cache_file->content_size = content_size;
+    cache_file->content_hash = content_hash;
+    config_cache_file_tokenize( cache_file , cache->parser , content , content_size );
+    cache->num_tokenized++;
+  }
+  free( content );
+
+  return cache_file;
+}
+
+
+bool config_parse_cache_has_file( const config_parse_cache_type * cache , const char * filename ) {
+  return hash_has_key( cache->files , filename );
+}
+
+
+/*
+  Returns true if files have been tokenized, or DEFINE substitutions
+  have been updated, since the cache was loaded or stored.
+*/
+
+bool config_parse_cache_is_modified( const config_parse_cache_type * cache ) {
+  bool modified = false;
+  hash_iter_type * iter = hash_iter_alloc( cache->files );
+  while (!hash_iter_is_complete( iter )) {
+    const config_cache_file_type * cache_file = hash_iter_get_next_value( iter );
+    if (cache_file->modified)
+      modified = true;
+  }
+  hash_iter_free( iter );
+  return modified;
+}
+
+
+/**
+   Writes all the files in the cache to @cache_file. The cache is
+   first written to a temporary file which is then renamed, so
+   concurrent readers will never see a partly written cache.
+*/
+
+void config_parse_cache_fwrite( config_parse_cache_type * cache , const char * cache_file ) {
+  buffer_type * buffer = buffer_alloc( 1024 * 1024 );
+  stringlist_type * files = hash_alloc_stringlist( cache->files );
+  int i;
+
+  stringlist_sort( files , NULL );
+  buffer_fwrite_int( buffer , CONFIG_PARSE_CACHE_ID );
+  buffer_fwrite_int( buffer , CONFIG_PARSE_CACHE_VERSION );
+  buffer_fwrite_int( buffer , stringlist_get_size( files ));
+  for (i = 0; i < stringlist_get_size( files ); i++) {
+    const char * filename = stringlist_iget( files , i );
+    config_cache_file_type * file = hash_get( cache->files , filename );
+
+    buffer_fwrite_string( buffer , filename );
+    config_cache_file_buffer_fwrite( file , buffer );
+    file->modified = false;
+  }
+  buffer_fwrite_int( buffer , CONFIG_PARSE_CACHE_ID );
+
+  {
+    char * tmp_file = util_alloc_sprintf( "%s.%d.tmp" , cache_file , getpid() );
+    buffer_store( buffer , tmp_file );
+    if (rename( tmp_file , cache_file ) != 0)
+      util_unlink_existing( tmp_file );
+    free( tmp_file );
+  }
+
+  stringlist_free( files );
+  buffer_free( buffer );
+}
+
+
+/**
+   Loads the files stored in @cache_file with
+   config_parse_cache_fwrite(). Files which are already in the cache
+   are not replaced. The loaded files are only used if the size and
+   hash of the content still agree when config_parse_cache_get_file()
+   is called. Returns false, and loads nothing, if the cache file does
+   not exist or can not be read completely.
+*/
+
+bool config_parse_cache_fread( config_parse_cache_type * cache , const char * cache_file ) {
+  bool cache_valid = false;
+
+  if (util_file_exists( cache_file )) {
+    buffer_type * buffer = buffer_fread_alloc( cache_file );
+    hash_type * files = hash_alloc( );          /* Only moved to the cache when the whole file has been read. */
+    int id , version , num_files , i;
+
+    cache_valid = config_parse_cache_safe_fread( buffer , &id , sizeof id ) && (id == CONFIG_PARSE_CACHE_ID) &&
+                  config_parse_cache_safe_fread( buffer , &version , sizeof version ) && (version == CONFIG_PARSE_CACHE_VERSION) &&
+                  config_parse_cache_safe_fread_count( buffer , &num_files , 2 * sizeof(int) );
+
+    for (i = 0; cache_valid && (i < num_files); i++) {
+      char * filename = config_parse_cache_safe_fread_alloc_string( buffer );
+      config_cache_file_type * file = NULL;
+
+      if (filename != NULL)
+        file = config_cache_file_buffer_fread_alloc( buffer );
+
+      if ((file != NULL) && !hash_has_key( files , filename ))
+        hash_insert_ref( files , filename , file );
+      else {
+        if (file != NULL)
+          config_cache_file_free( file );
+        cache_valid = false;
+      }
+      util_safe_free( filename );
+    }
+
+    /* The end marker must follow immediately, and end the file. */
+    if (cache_valid)
+      cache_valid = config_parse_cache_safe_fread( buffer , &id , sizeof id ) && (id == CONFIG_PARSE_CACHE_ID) &&
+                    (buffer_get_remaining_size( buffer ) == 0);
+
+    {
+      hash_iter_type * iter = hash_iter_alloc( files );
+      while (!hash_iter_is_complete( iter )) {
+        const char * filename = hash_iter_get_next_key( iter );
+        config_cache_file_type * file = hash_get( files , filename );
+
+        if (cache_valid && !hash_has_key( cache->files , filename ))
+          hash_insert_hash_owned_ref( cache->files , filename , file , config_cache_file_free__ );
+        else
+          config_cache_file_free( file );
+      }
+      hash_iter_free( iter );
+    }
+
+    hash_free( files );
+    buffer_free( buffer );
+  }
+
+  return cache_valid;
+}
+
+
+/*
+  The number of times a file has been tokenized, i.e. the number of
+  cache misses.
+*/
+
+int config_parse_cache_get_num_tokenized( const config_parse_cache_type * cache ) {
+  return cache->num_tokenized;
+}
@@ -0,0 +1,294 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'config_parse_cache.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/subst_list.h>
+
+#include <ert/config/config.h>
+#include <ert/config/config_schema_item.h>
+#include <ert/config/config_parse_cache.h>
+
+
+static void write_file( const char * filename , const char * content ) {
+  FILE * stream = util_fopen( filename , "w" );
+  fprintf( stream , "%s" , content );
+  fclose( stream );
+}
+
+
+void test_cache( ) {
+  config_parse_cache_type * cache = config_parse_cache_alloc( );
+  char * filename = util_alloc_abs_path( "cache_file" );
+  config_cache_file_type * cache_file;
+
+  test_assert_true( config_parse_cache_is_instance( cache ));
+  write_file( filename , "KEY1 A B\n\n-- Comment\nKEY2 \"C D\" -- Comment\n" );
+
+  cache_file = config_parse_cache_get_file( cache , filename );
+  test_assert_int_equal( 1 , config_parse_cache_get_num_tokenized( cache ));
+  test_assert_int_equal( 2 , config_cache_file_get_size( cache_file ));
+  test_assert_int_equal( 3 , stringlist_get_size( config_cache_file_iget_tokens( cache_file , 0 )));
+  test_assert_int_equal( 2 , stringlist_get_size( config_cache_file_iget_tokens( cache_file , 1 )));
+  test_assert_string_equal( "C D" , stringlist_iget( config_cache_file_iget_tokens( cache_file , 1 ) , 1));
+
+  test_assert_ptr_equal( cache_file , config_parse_cache_get_file( cache , filename ));
+  test_assert_int_equal( 1 , config_parse_cache_get_num_tokenized( cache ));
+
+  {
+    subst_list_type * define_list = subst_list_alloc( NULL );
+    uint64_t hash1 , hash2;
+
+    subst_list_append_copy( define_list , "A" , "X" , NULL );
+    hash1 = config_parse_cache_hash_string( 0 , "A" );
+    hash1 = config_parse_cache_hash_string( hash1 , "X" );
+    test_assert_string_equal( "X" , stringlist_iget( config_cache_file_iget_filtered_tokens( cache_file , 0 , define_list , hash1 ) , 1 ));
+
+    subst_list_append_copy( define_list , "A" , "Y" , NULL );
+    hash2 = config_parse_cache_hash_string( 0 , "A" );
+    hash2 = config_parse_cache_hash_string( hash2 , "Y" );
+    test_assert_true( hash1 != hash2 );
+    test_assert_string_equal( "Y" , stringlist_iget( config_cache_file_iget_filtered_tokens( cache_file , 0 , define_list , hash2 ) , 1 ));
+    test_assert_string_equal( "KEY1" , stringlist_iget( config_cache_file_iget_filtered_tokens( cache_file , 0 , define_list , hash2 ) , 0 ));
+    test_assert_string_equal( "A" , stringlist_iget( config_cache_file_iget_tokens( cache_file , 0 ) , 1 ));
+
+    subst_list_free( define_list );
+  }
+
+  /* Stored and loaded in a new cache. */
+  test_assert_true( config_parse_cache_is_modified( cache ));
+  config_parse_cache_fwrite( cache , "cache" );
+  test_assert_false( config_parse_cache_is_modified( cache ));
+  {
+    config_parse_cache_type * loaded = config_parse_cache_alloc( );
+    config_cache_file_type * loaded_file;
+    uint64_t hash = config_parse_cache_hash_string( config_parse_cache_hash_string( 0 , "A" ) , "Y" );
+
+    test_assert_true( config_parse_cache_fread( loaded , "cache" ));
+    test_assert_true( config_parse_cache_has_file( loaded , filename ));
+    loaded_file = config_parse_cache_get_file( loaded , filename );
+    test_assert_int_equal( 0 , config_parse_cache_get_num_tokenized( loaded ));
+    test_assert_false( config_parse_cache_is_modified( loaded ));
+    test_assert_int_equal( 2 , config_cache_file_get_size( loaded_file ));
+    test_assert_true( stringlist_equal( config_cache_file_iget_tokens( cache_file , 1 ) , config_cache_file_iget_tokens( loaded_file , 1 )));
+
+    /* The filtered tokens are loaded as well, and reused for the same hash. */
+    {
+      subst_list_type * define_list = subst_list_alloc( NULL );
+      test_assert_string_equal( "Y" , stringlist_iget( config_cache_file_iget_filtered_tokens( loaded_file , 0 , define_list , hash ) , 1 ));
+      test_assert_false( config_parse_cache_is_modified( loaded ));
+      subst_list_free( define_list );
+    }
+    config_parse_cache_free( loaded );
+  }
+
+  /* Missing, truncated and foreign cache files are not loaded. */
+  {
+    config_parse_cache_type * loaded = config_parse_cache_alloc( );
+    int size;
+    char * content = util_fread_alloc_file_content( "cache" , &size );
+    FILE * stream = util_fopen( "truncated_cache" , "w" );
+
+    util_fwrite( content , 1 , size - 1 , stream , __func__ );
+    fclose( stream );
+    write_file( "foreign_cache" , "KEY1 A B\n" );
+
+    test_assert_false( config_parse_cache_fread( loaded , "missing_cache" ));
+    test_assert_false( config_parse_cache_fread( loaded , "truncated_cache" ));
+    test_assert_false( config_parse_cache_fread( loaded , "foreign_cache" ));
+    test_assert_false( config_parse_cache_has_file( loaded , filename ));
+
+    /*
+      A corrupt body with intact start and end markers: every byte
+      between the markers is overwritten in turn, and the cache must
+      be rejected or loaded - never abort. A byte removed from the
+      middle is always rejected.
+    */
+    {
+      int offset;
+      for (offset = 2 * sizeof(int); offset < size - (int) sizeof(int); offset++) {
+        config_parse_cache_type * corrupt = config_parse_cache_alloc( );
+        char saved = content[offset];
+
+        content[offset] = (char) 0xFF;
+        stream = util_fopen( "corrupt_cache" , "w" );
+        util_fwrite( content , 1 , size , stream , __func__ );
+        fclose( stream );
+        content[offset] = saved;
+
+        config_parse_cache_fread( corrupt , "corrupt_cache" );
+        config_parse_cache_free( corrupt );
+      }
+
+      stream = util_fopen( "corrupt_cache" , "w" );
+      util_fwrite( content , 1 , size / 2 , stream , __func__ );
+      util_fwrite( &content[size / 2 + 1] , 1 , size - size / 2 - 1 , stream , __func__ );
+      fclose( stream );
+      test_assert_false( config_parse_cache_fread( loaded , "corrupt_cache" ));
+      test_assert_false( config_parse_cache_has_file( loaded , filename ));
+    }
+
+    free( content );
+    config_parse_cache_free( loaded );
+  }
+
+  /* Same size - different content. */
+  write_file( filename , "KEY1 A C\n\n-- Comment\nKEY2 \"C D\" -- Comment\n" );
+  cache_file = config_parse_cache_get_file( cache , filename );
+  test_assert_int_equal( 2 , config_parse_cache_get_num_tokenized( cache ));
+  test_assert_string_equal( "C" , stringlist_iget( config_cache_file_iget_tokens( cache_file , 0 ) , 2));
+
+  /* A stale entry loaded from disk is tokenized again. */
+  {
+    config_parse_cache_type * loaded = config_parse_cache_alloc( );
+    test_assert_true( config_parse_cache_fread( loaded , "cache" ));
+    cache_file = config_parse_cache_get_file( loaded , filename );
+    test_assert_int_equal( 1 , config_parse_cache_get_num_tokenized( loaded ));
+    test_assert_string_equal( "C" , stringlist_iget( config_cache_file_iget_tokens( cache_file , 0 ) , 2));
+    config_parse_cache_free( loaded );
+  }
+
+  /* DOS line endings and a last line without newline. */
+  write_file( filename , "KEY1 A\r\n\r\nKEY2 B" );
+  cache_file = config_parse_cache_get_file( cache , filename );
+  test_assert_int_equal( 2 , config_cache_file_get_size( cache_file ));
+  test_assert_string_equal( "A" , stringlist_iget( config_cache_file_iget_tokens( cache_file , 0 ) , 1));
+  test_assert_string_equal( "B" , stringlist_iget( config_cache_file_iget_tokens( cache_file , 1 ) , 1));
+
+  free( filename );
+  config_parse_cache_free( cache );
+}
+
+
+static config_type * alloc_config( ) {
+  config_type * config = config_alloc( );
+  config_schema_item_type * item;
+
+  config_set_store_parse_cache( config , true );
+  item = config_add_schema_item( config , "KEY1" , true );
+  config_schema_item_set_argc_minmax( item , 1 , 1 );
+  item = config_add_schema_item( config , "KEY2" , true );
+  config_schema_item_set_argc_minmax( item , 1 , 1 );
+  config_schema_item_iset_type( item , 0 , CONFIG_INT );
+  item = config_add_schema_item( config , "KEY3" , false );
+  return config;
+}
+
+
+static bool parse( config_type * config , const char * filename ) {
+  config_clear( config );
+  return config_parse( config , filename , "--" , "INCLUDE" , "DEFINE" , CONFIG_UNRECOGNIZED_ERROR , true );
+}
+
+
+void test_reparse( ) {
+  config_type * config = alloc_config( );
+
+  util_make_path( "include" );
+  write_file( "main" , "DEFINE <VALUE> 10\nKEY1 <VALUE>\nINCLUDE include/file\n" );
+  write_file( "include/file" , "KEY2 <VALUE>\nKEY3 a\nKEY3 __RESET__\n" );
+
+  test_assert_true( parse( config , "main" ));
+  test_assert_string_equal( "10" , config_get_value( config , "KEY1" ));
+  test_assert_int_equal( 10 , config_get_value_as_int( config , "KEY2" ));
+  test_assert_int_equal( 0 , config_get_occurences( config , "KEY3" ));
+
+  test_assert_true( parse( config , "main" ));
+  test_assert_string_equal( "10" , config_get_value( config , "KEY1" ));
+  test_assert_int_equal( 10 , config_get_value_as_int( config , "KEY2" ));
+
+  /* Only the main file is changed; the include is filtered with the new DEFINE. */
+  write_file( "main" , "DEFINE <VALUE> 20\nKEY1 <VALUE>\nINCLUDE include/file\n" );
+  test_assert_true( parse( config , "main" ));
+  test_assert_string_equal( "20" , config_get_value( config , "KEY1" ));
+  test_assert_int_equal( 20 , config_get_value_as_int( config , "KEY2" ));
+
+  /* A DEFINE from the calling scope is also taken into account. */
+  config_clear( config );
+  config_add_define( config , "<OTHER>" , "30" );
+  write_file( "include/file" , "KEY2 <OTHER>\n" );
+  test_assert_true( config_parse( config , "main" , "--" , "INCLUDE" , "DEFINE" , CONFIG_UNRECOGNIZED_ERROR , true ));
+  test_assert_int_equal( 30 , config_get_value_as_int( config , "KEY2" ));
+
+  /* The include file is changed and now fails validation. */
+  write_file( "include/file" , "KEY2 not_an_int\n" );
+  test_assert_false( parse( config , "main" ));
+  test_assert_int_equal( 1 , config_error_count( config_get_errors( config )));
+
+  write_file( "include/file" , "KEY2 40\n" );
+  test_assert_true( parse( config , "main" ));
+  test_assert_int_equal( 40 , config_get_value_as_int( config , "KEY2" ));
+  config_free( config );
+
+  /* The cache is stored next to the main file and covers the include. */
+  test_assert_true( util_file_exists( ".main.cache" ));
+  {
+    config_parse_cache_type * cache = config_parse_cache_alloc( );
+    char * main_file = util_alloc_realpath( "main" );
+    char * include_file = util_alloc_realpath( "include/file" );
+
+    test_assert_true( config_parse_cache_fread( cache , ".main.cache" ));
+    config_parse_cache_get_file( cache , main_file );
+    config_parse_cache_get_file( cache , include_file );
+    test_assert_int_equal( 0 , config_parse_cache_get_num_tokenized( cache ));
+
+    free( include_file );
+    free( main_file );
+    config_parse_cache_free( cache );
+  }
+
+  /* A new config instance gives the same result from the stored cache. */
+  config = alloc_config( );
+  test_assert_true( parse( config , "main" ));
+  test_assert_string_equal( "20" , config_get_value( config , "KEY1" ));
+  test_assert_int_equal( 40 , config_get_value_as_int( config , "KEY2" ));
+  config_free( config );
+
+  /* A corrupt cache is ignored and replaced. */
+  write_file( ".main.cache" , "garbage" );
+  config = alloc_config( );
+  test_assert_true( parse( config , "main" ));
+  test_assert_int_equal( 40 , config_get_value_as_int( config , "KEY2" ));
+  config_free( config );
+  {
+    config_parse_cache_type * cache = config_parse_cache_alloc( );
+    test_assert_true( config_parse_cache_fread( cache , ".main.cache" ));
+    config_parse_cache_free( cache );
+  }
+
+  /* The cache is only stored when asked for. */
+  config = alloc_config( );
+  config_set_store_parse_cache( config , false );
+  write_file( "other" , "KEY1 10\nKEY2 10\n" );
+  test_assert_true( parse( config , "other" ));
+  test_assert_false( util_file_exists( ".other.cache" ));
+  config_free( config );
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "config_parse_cache" , false );
+  test_cache( );
+  test_reparse( );
+  test_work_area_free( work_area );
+  exit(0);
+}
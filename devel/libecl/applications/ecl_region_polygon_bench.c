@@ -0,0 +1,111 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_region_polygon_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <ert/util/util.h>
+#include <ert/util/timer.h>
+#include <ert/util/double_vector.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/geometry/geo_util.h>
+#include <ert/geometry/geo_polygon.h>
+
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_region.h>
+
+/*
+  Times selecting the cells inside a polygon:
+
+     ecl_region_polygon_bench  [nx]  [num_vertices]
+
+  The grid is nx x nx x 1, and the polygon is a star shaped polygon
+  with num_vertices vertices covering most of the grid. The
+  ecl_region_select_inside_polygon() function is compared with
+  testing every grid column against all the polygon edges, as
+  ecl_region_select_inside_polygon() did before. The defaults are
+  nx = 300 and 5000 vertices.
+*/
+
+
+int main( int argc , char ** argv ) {
+  int nx = 300;
+  int num_vertices = 5000;
+  if (argc > 1) util_sscanf_int( argv[1] , &nx );
+  if (argc > 2) util_sscanf_int( argv[2] , &num_vertices );
+
+  {
+    ecl_grid_type * grid = ecl_grid_alloc_rectangular( nx , nx , 1 , 1 , 1 , 1 , NULL );
+    geo_polygon_type * polygon = geo_polygon_alloc( );
+    double_vector_type * xcoord = double_vector_alloc( 0 , 0 );
+    double_vector_type * ycoord = double_vector_alloc( 0 , 0 );
+    timer_type * timer = timer_alloc( false );
+    double per_edge_time , region_time;
+    int per_edge_count = 0;
+    int region_count;
+
+    srand( 1 );
+    for (int i = 0; i < num_vertices; i++) {
+      double phi = 2 * M_PI * i / num_vertices;
+      double r = 0.5 * nx * (0.5 + 0.5 * rand() / RAND_MAX);
+      double x = 0.5 * nx + r * cos( phi );
+      double y = 0.5 * nx + r * sin( phi );
+
+      geo_polygon_add_point( polygon , x , y );
+      double_vector_append( xcoord , x );
+      double_vector_append( ycoord , y );
+    }
+
+    timer_start( timer );
+    for (int i = 0; i < nx; i++) {
+      for (int j = 0; j < nx; j++) {
+        double x , y , z;
+        ecl_grid_get_xyz3( grid , i , j , 0 , &x , &y , &z );
+        if (geo_util_inside_polygon( double_vector_get_const_ptr( xcoord ) ,
+                                     double_vector_get_const_ptr( ycoord ) ,
+                                     num_vertices , x , y ))
+          per_edge_count++;
+      }
+    }
+    per_edge_time = timer_stop( timer );
+
+    timer_reset( timer );
+    timer_start( timer );
+    {
+      ecl_region_type * region = ecl_region_alloc( grid , false );
+      ecl_region_select_inside_polygon( region , polygon );
+      region_count = int_vector_size( ecl_region_get_global_list( region ));
+      region_time = timer_stop( timer );
+      ecl_region_free( region );
+    }
+
+    printf("Grid: %d x %d   Polygon vertices: %d   Cells inside: %d / %d\n" , nx , nx , num_vertices , per_edge_count , region_count );
+    printf("All edges per column               : %8.3f s\n" , per_edge_time );
+    printf("ecl_region_select_inside_polygon() : %8.3f s\n" , region_time );
+
+    timer_free( timer );
+    double_vector_free( xcoord );
+    double_vector_free( ycoord );
+    geo_polygon_free( polygon );
+    ecl_grid_free( grid );
+  }
+  exit(0);
+}
@@ -58,6 +58,7 @@ extern "C" {
   bool           ecl_kw_fread_realloc(ecl_kw_type *, fortio_type *);
   void           ecl_kw_fread(ecl_kw_type * , fortio_type * );
   ecl_kw_type *  ecl_kw_fread_alloc(fortio_type *);
+  bool           ecl_kw_fcheck_complete( fortio_type * fortio );
   void           ecl_kw_free_data(ecl_kw_type *);
   void           ecl_kw_free(ecl_kw_type *);
   void           ecl_kw_free__(void *);
@@ -30,6 +30,7 @@ extern "C" {
 #include <ert/util/stringlist.h>
 #include <ert/util/time_t_vector.h>
 #include <ert/util/double_vector.h>
+#include <ert/util/bool_vector.h>
 #include <ert/util/time_interval.h>
 
 #include <ert/ecl/ecl_smspec.h>
@@ -91,6 +92,8 @@ typedef struct ecl_sum_struct       ecl_sum_type;
   void             ecl_sum_free__(void * );
   void             ecl_sum_free(ecl_sum_type * );
   ecl_sum_type   * ecl_sum_fread_alloc(const char * , const stringlist_type * data_files, const char * key_join_string);
+  ecl_sum_type   * ecl_sum_fread_alloc_tail( const char * header_file , const char * key_join_string );
+  int              ecl_sum_fread_tail( ecl_sum_type * ecl_sum );
   ecl_sum_type   * ecl_sum_fread_alloc_case(const char *  , const char * key_join_string);
   ecl_sum_type   * ecl_sum_fread_alloc_case__(const char *  , const char * key_join_string , bool include_restart);
   
@@ -156,6 +159,7 @@ typedef struct ecl_sum_struct       ecl_sum_type;
   
   void                 ecl_sum_init_data_vector( const ecl_sum_type * ecl_sum , double_vector_type * data_vector , int data_index , bool report_only );
   double_vector_type * ecl_sum_alloc_data_vector( const ecl_sum_type * ecl_sum  , int data_index , bool report_only);
+  void                 ecl_sum_init_report_vector( const ecl_sum_type * ecl_sum , int params_index , int last_report , double_vector_type * value , bool_vector_type * valid);
   time_t_vector_type * ecl_sum_alloc_time_vector( const ecl_sum_type * ecl_sum  , bool report_only);
   time_t       ecl_sum_get_data_start( const ecl_sum_type * ecl_sum );
   time_t       ecl_sum_get_end_time( const ecl_sum_type * ecl_sum);
@@ -26,8 +26,10 @@ extern "C" {
 #include <stdlib.h>
 #include <time.h>
 
+#include <ert/util/util.h>
 #include <ert/util/time_t_vector.h>
 #include <ert/util/double_vector.h>
+#include <ert/util/bool_vector.h>
 #include <ert/util/stringlist.h>
 #include <ert/util/time_interval.h>
 
@@ -39,6 +41,7 @@ typedef struct ecl_sum_data_struct ecl_sum_data_type ;
   void                     ecl_sum_data_fwrite( const ecl_sum_data_type * data , const char * ecl_case , bool fmt_case , bool unified);
   void                     ecl_sum_data_fread( ecl_sum_data_type * data , const stringlist_type * filelist);
   void                     ecl_sum_data_fread_restart( ecl_sum_data_type * data , const stringlist_type * filelist);
+  int                      ecl_sum_data_fread_append( ecl_sum_data_type * data , const char * data_file , offset_type * offset , int * report_step );
   ecl_sum_data_type      * ecl_sum_data_alloc_writer( ecl_smspec_type * smspec );
   ecl_sum_data_type      * ecl_sum_data_alloc( ecl_smspec_type * smspec);
   double                   ecl_sum_data_time2days( const ecl_sum_data_type * data , time_t sim_time);
@@ -49,6 +52,7 @@ typedef struct ecl_sum_data_struct ecl_sum_data_type ;
   int                      ecl_sum_data_get_num_ministep( const ecl_sum_data_type * data );
   double_vector_type     * ecl_sum_data_alloc_data_vector( const ecl_sum_data_type * data , int data_index , bool report_only);
   void                     ecl_sum_data_init_data_vector( const ecl_sum_data_type * data , double_vector_type * data_vector , int data_index , bool report_only);
+  void                     ecl_sum_data_init_report_vector( const ecl_sum_data_type * data , int params_index , int last_report , double_vector_type * value , bool_vector_type * valid);
   void                     ecl_sum_data_init_time_vector( const ecl_sum_data_type * data , time_t_vector_type * time_vector , bool report_only);
   time_t_vector_type     * ecl_sum_data_alloc_time_vector( const ecl_sum_data_type * data , bool report_only);
   time_t                   ecl_sum_data_get_data_start( const ecl_sum_data_type * data );  
@@ -42,6 +42,7 @@ typedef struct fortio_struct fortio_type;
 
   fortio_status_type fortio_check_buffer( FILE * stream , bool endian_flip , size_t buffer_size );
   fortio_status_type fortio_check_file( const char * filename , bool endian_flip);
+  bool               fortio_records_complete( fortio_type * fortio , int num_records );
   bool               fortio_guess_endian_flip(const char * , bool *);
   bool               fortio_is_fortran_file(const char *  , bool * );
   void               fortio_copy_record(fortio_type * , fortio_type * , int , void * , bool *);
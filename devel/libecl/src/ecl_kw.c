@@ -24,6 +24,7 @@
 
 #include <ert/util/util.h>
 #include <ert/util/buffer.h>
+#include <ert/util/elementwise.h>
 
 #include <ert/ecl/ecl_kw.h>
 #include <ert/ecl/ecl_util.h>
@@ -1199,6 +1200,37 @@ void ecl_kw_fskip_header( fortio_type * fortio) {
 }
 
 
+/**
+   Checks whether a complete keyword, i.e. the header and all the
+   data blocks, can be read from the current position of the fortio
+   instance. The data is not read, and the position is restored before
+   returning. Only binary files are supported; for formatted files the
+   function returns false.
+*/
+
+bool ecl_kw_fcheck_complete( fortio_type * fortio ) {
+  bool complete = false;
+
+  if (!fortio_fmt_file( fortio )) {
+    offset_type init_pos = fortio_ftell( fortio );
+
+    if (fortio_records_complete( fortio , 1 )) {
+      ecl_kw_type * tmp_kw = ecl_kw_alloc_empty( );
+      if (ecl_kw_fread_header( tmp_kw , fortio )) {
+        const int blocksize = get_blocksize( tmp_kw->ecl_type );
+        const int blocks    = tmp_kw->size / blocksize + (tmp_kw->size % blocksize == 0 ? 0 : 1);
+
+        complete = fortio_records_complete( fortio , blocks );
+      }
+      ecl_kw_free( tmp_kw );
+    }
+    fortio_fseek( fortio , init_pos , SEEK_SET );
+  }
+
+  return complete;
+}
+
+
 bool ecl_kw_fread_header(ecl_kw_type *ecl_kw , fortio_type * fortio) {
   const char null_char = '\0';
   FILE *stream  = fortio_get_FILE( fortio );
@@ -1878,10 +1910,7 @@ void ecl_kw_scale_ ## ctype (ecl_kw_type * ecl_kw , ctype scale_factor) {
     util_abort("%s: Keyword: %s is wrong type - aborting \n",__func__ , ecl_kw_get_header8(ecl_kw));  \
   {                                                                                                   \
      ctype * data = ecl_kw_get_data_ref(ecl_kw);                                                      \
-     int    size  = ecl_kw_get_size(ecl_kw);                                                          \
-     int i;                                                                                           \
-     for (i=0; i < size; i++)                                                                         \
-        data[i] *= scale_factor;                                                                      \
+     elementwise_scale_ ## ctype( data , scale_factor , ecl_kw_get_size(ecl_kw) );                   \
   }                                                                                                   \
 }
 
@@ -1907,10 +1936,7 @@ void ecl_kw_shift_ ## ctype (ecl_kw_type * ecl_kw , ctype shift_value) {
     util_abort("%s: Keyword: %s is wrong type - aborting \n",__func__ , ecl_kw_get_header8(ecl_kw));  \
   {                                                                                                   \
      ctype * data = ecl_kw_get_data_ref(ecl_kw);                                                      \
-     int    size  = ecl_kw_get_size(ecl_kw);                                                          \
-     int i;                                                                                           \
-     for (i=0; i < size; i++)                                                                         \
-        data[i] += shift_value;                                                                       \
+     elementwise_shift_ ## ctype( data , shift_value , ecl_kw_get_size(ecl_kw) );                    \
   }                                                                                                   \
 }
 
@@ -2043,9 +2069,7 @@ static void ecl_kw_inplace_add_ ## ctype( ecl_kw_type * target_kw , const ecl_kw
  {                                                                                         \
     ctype * target_data = ecl_kw_get_data_ref( target_kw );                                \
     const ctype * add_data = ecl_kw_get_data_ref( add_kw );                                \
-    int i;                                                                                 \
-    for (i=0; i < target_kw->size; i++)                                                    \
-      target_data[i] += add_data[i];                                                       \
+    elementwise_add_ ## ctype( target_data , add_data , target_kw->size );                  \
  }                                                                                         \
 }
 ECL_KW_TYPED_INPLACE_ADD( int )
@@ -2083,9 +2107,7 @@ void ecl_kw_inplace_sub_ ## ctype( ecl_kw_type * target_kw , const ecl_kw_type *
  {                                                                                         \
     ctype * target_data = ecl_kw_get_data_ref( target_kw );                                \
     const ctype * sub_data = ecl_kw_get_data_ref( sub_kw );                                \
-    int i;                                                                                 \
-    for (i=0; i < target_kw->size; i++)                                                    \
-      target_data[i] -= sub_data[i];                                                       \
+    elementwise_sub_ ## ctype( target_data , sub_data , target_kw->size );                  \
  }                                                                                         \
 }
 ECL_KW_TYPED_INPLACE_SUB( int )
@@ -2160,9 +2182,7 @@ void ecl_kw_inplace_mul_ ## ctype( ecl_kw_type * target_kw , const ecl_kw_type *
  {                                                                                         \
     ctype * target_data = ecl_kw_get_data_ref( target_kw );                                \
     const ctype * mul_data = ecl_kw_get_data_ref( mul_kw );                                \
-    int i;                                                                                 \
-    for (i=0; i < target_kw->size; i++)                                                    \
-      target_data[i] *= mul_data[i];                                                       \
+    elementwise_mul_ ## ctype( target_data , mul_data , target_kw->size );                  \
  }                                                                                         \
 }
 ECL_KW_TYPED_INPLACE_MUL( int )
@@ -2238,9 +2258,7 @@ void ecl_kw_inplace_div_ ## ctype( ecl_kw_type * target_kw , const ecl_kw_type *
  {                                                                                         \
     ctype * target_data = ecl_kw_get_data_ref( target_kw );                                \
     const ctype * div_data = ecl_kw_get_data_ref( div_kw );                                \
-    int i;                                                                                 \
-    for (i=0; i < target_kw->size; i++)                                                    \
-      target_data[i] /= div_data[i];                                                       \
+    elementwise_div_ ## ctype( target_data , div_data , target_kw->size );                  \
  }                                                                                         \
 }
 ECL_KW_TYPED_INPLACE_DIV( int )
@@ -1086,25 +1086,38 @@ static void ecl_region_polygon_select__( ecl_region_type * region ,
   const int k2       = region->grid_nz;    
 
   {
+    int num_columns = region->grid_nx * region->grid_ny;
+    double * xlist = util_calloc( num_columns , sizeof * xlist );
+    double * ylist = util_calloc( num_columns , sizeof * ylist );
+    bool * inside  = util_calloc( num_columns , sizeof * inside );
     int i,j;
+
     for (i=0; i < region->grid_nx; i++) {
       for (j=0; j < region->grid_ny; j++) {
-        double x,y,z;
-        bool inside;
+        int column = i * region->grid_ny + j;
         int global_index = ecl_grid_get_global_index3( region->parent_grid , i , j , define_k);
+        double z;
         
-        ecl_grid_get_xyz1( region->parent_grid , global_index , &x , &y , &z);
-        inside = geo_polygon_contains_point( polygon , x , y );
-        
-        if (select_inside == inside) {
+        ecl_grid_get_xyz1( region->parent_grid , global_index , &xlist[column] , &ylist[column] , &z);
+      }
+    }
+    geo_polygon_contains_points( polygon , num_columns , xlist , ylist , inside );
+
+    for (i=0; i < region->grid_nx; i++) {
+      for (j=0; j < region->grid_ny; j++) {
+        int column = i * region->grid_ny + j;
+        if (select_inside == inside[column]) {
           int k;
           for (k=k1; k < k2; k++) {
-            global_index = ecl_grid_get_global_index3( region->parent_grid , i , j , k);
+            int global_index = ecl_grid_get_global_index3( region->parent_grid , i , j , k);
             region->active_mask[ global_index ] = select;
           }
         }
       }
     }
+    free( xlist );
+    free( ylist );
+    free( inside );
   }
 }
 
@@ -105,6 +105,10 @@ struct ecl_sum_struct {
   char              * base;       /* Only the basename. */
   char              * ecl_case;   /* This is the current case, with optional path component. == path + base*/
   char              * ext;        /* Only to support selective loading of formatted|unformatted and unified|multiple. (can be NULL) */ 
+
+  offset_type         tail_offset;     /* The watermark in the current data file - see ecl_sum_fread_tail(). */
+  int                 tail_report;     /* The report step of the last SEQHDR which has been read. */
+  int                 tail_file_step;  /* The report step of the current non-unified data file. */
 };
 
 
@@ -163,6 +167,10 @@ static ecl_sum_type * ecl_sum_alloc__( const char * input_arg , const char * key
   ecl_sum->smspec = NULL;
   ecl_sum->data   = NULL;
 
+  ecl_sum->tail_offset    = 0;
+  ecl_sum->tail_report    = 0;
+  ecl_sum->tail_file_step = -1;
+
   return ecl_sum;
 }
 
@@ -248,6 +256,97 @@ ecl_sum_type * ecl_sum_fread_alloc(const char *header_file , const stringlist_ty
   return ecl_sum;
 }
 
+/**
+   The ecl_sum_fread_alloc_tail() and ecl_sum_fread_tail() functions
+   are used to load the summary results of a simulation while it is
+   running. ecl_sum_fread_alloc_tail() loads the SMSPEC header, and
+   returns an instance without any data; each call to
+   ecl_sum_fread_tail() will then append the ministeps which have been
+   written to the data file(s) since the previous call, see
+   ecl_sum_data_fread_append(). The data files are located from the
+   path and basename of @header_file; both unified and non-unified
+   files are supported, but only binary files.
+
+   Observe that the last report step loaded can still be incomplete,
+   i.e. the simulator may add further ministeps to it.
+*/
+
+ecl_sum_type * ecl_sum_fread_alloc_tail( const char * header_file , const char * key_join_string ) {
+  bool fmt_file;
+  ecl_util_get_file_type( header_file , &fmt_file , NULL );
+  if (fmt_file)
+    return NULL;
+  {
+    ecl_sum_type * ecl_sum = ecl_sum_alloc__( header_file , key_join_string );
+    ecl_sum->smspec = ecl_smspec_fread_alloc( header_file , key_join_string , false );
+    ecl_sum->data   = ecl_sum_data_alloc( ecl_sum->smspec );
+    ecl_sum_set_fmt_case( ecl_sum , false );
+    ecl_sum_set_unified( ecl_sum , true );
+    return ecl_sum;
+  }
+}
+
+
+/**
+   Returns the number of new ministeps, or -1 if a data file has been
+   rewritten since the previous call; the ecl_sum instance should then
+   be discarded.
+*/
+
+int ecl_sum_fread_tail( ecl_sum_type * ecl_sum ) {
+  int num_added = 0;
+  char * unified_file = ecl_util_alloc_filename( ecl_sum->path , ecl_sum->base , ECL_UNIFIED_SUMMARY_FILE , false , 0 );
+
+  if (util_file_exists( unified_file ))
+    num_added = ecl_sum_data_fread_append( ecl_sum->data , unified_file , &ecl_sum->tail_offset , &ecl_sum->tail_report );
+  else {
+    ecl_sum_set_unified( ecl_sum , false );
+
+    if (ecl_sum->tail_file_step < 0) {
+      /* Locate the first non-unified file. */
+      stringlist_type * data_files = stringlist_alloc_new( );
+      ecl_util_alloc_summary_data_files( ecl_sum->path , ecl_sum->base , false , data_files );
+      if (stringlist_get_size( data_files ) > 0) {
+        ecl_util_get_file_type( stringlist_iget( data_files , 0 ) , NULL , &ecl_sum->tail_file_step );
+        ecl_sum->tail_report = ecl_sum->tail_file_step - 1;
+        ecl_sum->tail_offset = 0;
+      }
+      stringlist_free( data_files );
+    }
+
+    /*
+      The file for the next report step is only created when the
+      current file is complete; the current file is therefor read to
+      the end before moving on.
+    */
+    while (ecl_sum->tail_file_step >= 0) {
+      char * data_file = ecl_util_alloc_filename( ecl_sum->path , ecl_sum->base , ECL_SUMMARY_FILE , false , ecl_sum->tail_file_step );
+      char * next_file = ecl_util_alloc_filename( ecl_sum->path , ecl_sum->base , ECL_SUMMARY_FILE , false , ecl_sum->tail_file_step + 1);
+      bool   has_next  = util_file_exists( next_file );
+
+      if (util_file_exists( data_file )) {
+        int file_added = ecl_sum_data_fread_append( ecl_sum->data , data_file , &ecl_sum->tail_offset , &ecl_sum->tail_report );
+        if (file_added < 0)
+          num_added = -1;
+        else if (num_added >= 0)
+          num_added += file_added;
+      }
+      free( data_file );
+      free( next_file );
+
+      if (has_next && (num_added >= 0)) {
+        ecl_sum->tail_file_step++;
+        ecl_sum->tail_report = ecl_sum->tail_file_step - 1;
+        ecl_sum->tail_offset = 0;
+      } else
+        break;
+    }
+  }
+
+  free( unified_file );
+  return num_added;
+}
+
 /*****************************************************************/
 
 void ecl_sum_set_unified( ecl_sum_type * ecl_sum , bool unified ) {
@@ -750,6 +849,17 @@ double_vector_type * ecl_sum_alloc_data_vector( const ecl_sum_type * ecl_sum  ,
 }
 
 
+/**
+   Bulk variant of ecl_sum_get_general_var() at the end of every
+   report step; the key should be resolved once with
+   ecl_sum_get_general_var_params_index().
+*/
+
+void ecl_sum_init_report_vector( const ecl_sum_type * ecl_sum , int params_index , int last_report , double_vector_type * value , bool_vector_type * valid) {
+  ecl_sum_data_init_report_vector( ecl_sum->data , params_index , last_report , value , valid );
+}
+
+
 
 void ecl_sum_summarize( const ecl_sum_type * ecl_sum , FILE * stream ) {
   ecl_sum_data_summarize( ecl_sum->data , stream );
@@ -32,6 +32,7 @@
 #include <ert/ecl/smspec_node.h>
 #include <ert/ecl/ecl_kw.h>
 #include <ert/ecl/ecl_file.h>
+#include <ert/ecl/fortio.h>
 #include <ert/ecl/ecl_endian_flip.h>
 #include <ert/ecl/ecl_kw_magic.h>
 
@@ -975,6 +976,85 @@ void ecl_sum_data_fread( ecl_sum_data_type * data , const stringlist_type * file
 
 
 
+/**
+   Loads the ministeps which have been appended to the binary summary
+   file @data_file since the previous call, i.e. the file is read
+   while it is still being written by the simulator:
+
+     *offset      : The watermark; the file offset following the last
+                    complete keyword which has been read. Updated on
+                    return; start with 0.
+
+     *report_step : Incremented for every SEQHDR keyword, i.e. this is
+                    the report step of the ministeps which are read.
+                    For a unified file start with 0, for the
+                    non-unified file BASE.Snnnn start with nnnn - 1.
+
+   A ministep is only loaded when both the MINISTEP and the PARAMS
+   keyword have been completely written; a partly written keyword is
+   left for the next call. The return value is the number of
+   ministeps which were added, or -1 if the file has become shorter
+   than the watermark, i.e. it has been rewritten; the data already
+   loaded is then invalid.
+*/
+
+int ecl_sum_data_fread_append( ecl_sum_data_type * data , const char * data_file , offset_type * offset , int * report_step ) {
+  int num_added = 0;
+
+  if ((offset_type) util_file_size( data_file ) < *offset)
+    return -1;
+  {
+    fortio_type * fortio  = fortio_open_reader( data_file , false , ECL_ENDIAN_FLIP );
+    ecl_kw_type * kw      = ecl_kw_alloc_empty( );
+
+    fortio_fseek( fortio , *offset , SEEK_SET );
+    while (ecl_kw_fcheck_complete( fortio )) {
+      offset_type kw_pos = fortio_ftell( fortio );
+      ecl_kw_fread_header( kw , fortio );
+
+      if (util_string_equal( ecl_kw_get_header( kw ) , MINISTEP_KW )) {
+        fortio_fseek( fortio , kw_pos , SEEK_SET );
+        {
+          ecl_kw_type * ministep_kw = ecl_kw_fread_alloc( fortio );
+          bool params_complete      = ecl_kw_fcheck_complete( fortio );
+
+          if (params_complete) {
+            ecl_kw_type * params_kw = ecl_kw_fread_alloc( fortio );
+            if (util_string_equal( ecl_kw_get_header( params_kw ) , PARAMS_KW )) {
+              int ministep_nr = ecl_kw_iget_int( ministep_kw , 0 );
+              ecl_sum_tstep_type * tstep = ecl_sum_tstep_alloc_from_file( *report_step , ministep_nr , params_kw , data_file , data->smspec );
+              if (tstep != NULL) {
+                ecl_sum_data_append_tstep__( data , ministep_nr , tstep );
+                num_added++;
+              }
+            }
+            ecl_kw_free( params_kw );
+          }
+          ecl_kw_free( ministep_kw );
+
+          if (!params_complete)
+            break;
+        }
+      } else {
+        if (util_string_equal( ecl_kw_get_header( kw ) , SEQHDR_KW ))
+          (*report_step)++;
+        ecl_kw_fskip_data( kw , fortio );
+      }
+      *offset = fortio_ftell( fortio );
+    }
+
+    ecl_kw_free( kw );
+    fortio_fclose( fortio );
+  }
+
+  if (num_added > 0)
+    ecl_sum_data_build_index( data );
+
+  return num_added;
+}
+
+
+
 static time_t ecl_sum_data_get_load_end( const ecl_sum_data_type * data ) {
   return data->__min_time;
 }
@@ -1331,6 +1411,32 @@ void ecl_sum_data_init_data_vector( const ecl_sum_data_type * data , double_vect
 }
 
 
+/**
+   Fills @value and @valid with the variable @params_index at the end
+   of the report steps [0,last_report]; report steps not present in
+   the data are marked as invalid in @valid. This is equivalent to
+   calling ecl_sum_data_iget() with ecl_sum_data_iget_report_end() for
+   every report step, but the data is traversed in one pass.
+*/
+
+void ecl_sum_data_init_report_vector( const ecl_sum_data_type * data , int params_index , int last_report , double_vector_type * value , bool_vector_type * valid) {
+  const int   num_report  = int_vector_size( data->report_last_index );
+  const int * last_index  = int_vector_get_const_ptr( data->report_last_index );
+
+  double_vector_reset( value );
+  bool_vector_reset( valid );
+  for (int report_step = 0; report_step <= last_report; report_step++) {
+    int time_index = (report_step < num_report) ? last_index[report_step] : INVALID_MINISTEP_NR;
+    if (time_index >= 0) {
+      const ecl_sum_tstep_type * ministep = ecl_sum_data_iget_ministep( data , time_index );
+      double_vector_iset( value , report_step , ecl_sum_tstep_iget( ministep , params_index ));
+      bool_vector_iset( valid , report_step , true );
+    } else
+      bool_vector_iset( valid , report_step , false );
+  }
+}
+
+
 double_vector_type * ecl_sum_data_alloc_data_vector( const ecl_sum_data_type * data , int data_index , bool report_only) {
   double_vector_type * data_vector = double_vector_alloc(0,0);
   ecl_sum_data_init_data_vector( data , data_vector , data_index , report_only);
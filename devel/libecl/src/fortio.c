@@ -696,6 +696,32 @@ fortio_status_type fortio_check_file( const char * filename , bool endian_flip)
 }
 
 
+/**
+   Checks - without reading the data - that the next @num_records
+   records from the current position are complete, i.e. that both the
+   leading and the trailing record markers are in place. This is used
+   when reading a file which is still being written by the simulator.
+   The file position is restored before the function returns.
+*/
+
+bool fortio_records_complete( fortio_type * fortio , int num_records ) {
+  offset_type init_pos = fortio_ftell( fortio );
+  bool complete = true;
+  int irec;
+
+  for (irec = 0; irec < num_records; irec++) {
+    int record_size;
+    if (fortio_check_record( fortio->stream , fortio->endian_flip_header , &record_size ) != FORTIO_OK) {
+      complete = false;
+      break;
+    }
+  }
+
+  fortio_fseek( fortio , init_pos , SEEK_SET );
+  return complete;
+}
+
+
 offset_type fortio_ftell( const fortio_type * fortio ) {
   return util_ftell( fortio->stream );
 }
@@ -0,0 +1,78 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_sum_report_vector.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/double_vector.h>
+#include <ert/util/bool_vector.h>
+
+#include <ert/ecl/ecl_sum.h>
+
+
+void write_case( const char * ecl_case ) {
+  ecl_sum_type * ecl_sum = ecl_sum_alloc_writer( ecl_case , false , true , ":" , util_make_date( 1 , 1 , 2010 ) , 10 , 10 , 10 );
+  int ministep = 0;
+
+  ecl_sum_add_var( ecl_sum , "FOPT" , NULL , 0 , "Barrels" , 0 );
+  ecl_sum_add_var( ecl_sum , "WOPR" , "OP-1" , 0 , "Barrels" , 0 );
+  for (int report_step = 1; report_step <= 6; report_step++) {
+    for (int i = 0; i < 2; i++) {
+      ecl_sum_tstep_type * tstep = ecl_sum_add_tstep( ecl_sum , report_step , 10.0 * ministep + 1 );
+      ecl_sum_tstep_set_from_key( tstep , "FOPT" , 100.0 * ministep );
+      ecl_sum_tstep_set_from_key( tstep , "WOPR:OP-1" , report_step + i );
+      ministep++;
+    }
+  }
+  ecl_sum_fwrite( ecl_sum );
+  ecl_sum_free( ecl_sum );
+}
+
+
+void test_key( const ecl_sum_type * ecl_sum , const char * key , int last_report ) {
+  double_vector_type * value = double_vector_alloc( 0 , 0 );
+  bool_vector_type * valid   = bool_vector_alloc( 0 , false );
+
+  ecl_sum_init_report_vector( ecl_sum , ecl_sum_get_general_var_params_index( ecl_sum , key ) , last_report , value , valid );
+  test_assert_int_equal( last_report + 1 , bool_vector_size( valid ));
+  for (int report_step = 0; report_step <= last_report; report_step++) {
+    int time_index = ecl_sum_iget_report_end( ecl_sum , report_step );
+    test_assert_bool_equal( time_index >= 0 , bool_vector_iget( valid , report_step ));
+    if (time_index >= 0)
+      test_assert_double_equal( ecl_sum_get_general_var( ecl_sum , time_index , key ) , double_vector_iget( value , report_step ));
+  }
+
+  bool_vector_free( valid );
+  double_vector_free( value );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "ecl_sum_report_vector" , false );
+  write_case( "CASE" );
+  {
+    ecl_sum_type * ecl_sum = ecl_sum_fread_alloc_case( "CASE" , ":" );
+    test_key( ecl_sum , "FOPT" , ecl_sum_get_last_report_step( ecl_sum ));
+    test_key( ecl_sum , "WOPR:OP-1" , ecl_sum_get_last_report_step( ecl_sum ) + 2 );
+    ecl_sum_free( ecl_sum );
+  }
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,149 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_sum_tail.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_sum.h>
+#include <ert/ecl/ecl_util.h>
+
+#define NUM_REPORT    5
+#define NUM_MINISTEP  3
+
+
+void write_case( const char * ecl_case , bool unified ) {
+  ecl_sum_type * ecl_sum = ecl_sum_alloc_writer( ecl_case , false , unified , ":" , util_make_date( 1 , 1 , 2010 ) , 10 , 10 , 10 );
+  int ministep = 0;
+
+  ecl_sum_add_var( ecl_sum , "FOPT" , NULL , 0 , "Barrels" , 0 );
+  ecl_sum_add_var( ecl_sum , "WOPR" , "OP-1" , 0 , "Barrels" , 0 );
+  for (int report_step = 1; report_step <= NUM_REPORT; report_step++) {
+    for (int i = 0; i < NUM_MINISTEP; i++) {
+      ecl_sum_tstep_type * tstep = ecl_sum_add_tstep( ecl_sum , report_step , 10.0 * ministep + 1 );
+      ecl_sum_tstep_set_from_key( tstep , "FOPT" , 100.0 * ministep );
+      ecl_sum_tstep_set_from_key( tstep , "WOPR:OP-1" , report_step );
+      ministep++;
+    }
+  }
+  ecl_sum_fwrite( ecl_sum );
+  ecl_sum_free( ecl_sum );
+}
+
+
+/* Copies the first @size bytes of @src_file to @target_file. */
+void copy_prefix( const char * src_file , const char * target_file , int size ) {
+  int file_size;
+  char * content = util_fread_alloc_file_content( src_file , &file_size );
+  FILE * stream = util_fopen( target_file , "w" );
+  util_fwrite( content , 1 , util_int_min( size , file_size ) , stream , __func__ );
+  fclose( stream );
+  free( content );
+}
+
+
+void test_equal( const ecl_sum_type * expected , const ecl_sum_type * tail ) {
+  test_assert_int_equal( ecl_sum_get_data_length( expected ) , ecl_sum_get_data_length( tail ));
+  test_assert_int_equal( ecl_sum_get_last_report_step( expected ) , ecl_sum_get_last_report_step( tail ));
+  for (int index = 0; index < ecl_sum_get_data_length( expected ); index++) {
+    test_assert_double_equal( ecl_sum_get_general_var( expected , index , "FOPT" ) , ecl_sum_get_general_var( tail , index , "FOPT" ));
+    test_assert_double_equal( ecl_sum_get_general_var( expected , index , "WOPR:OP-1" ) , ecl_sum_get_general_var( tail , index , "WOPR:OP-1" ));
+  }
+}
+
+
+void test_unified( ) {
+  write_case( "UNIFIED" , true );
+  util_make_path( "run" );
+  util_copy_file( "UNIFIED.SMSPEC" , "run/UNIFIED.SMSPEC" );
+  {
+    ecl_sum_type * expected = ecl_sum_fread_alloc_case( "UNIFIED" , ":" );
+    ecl_sum_type * tail     = ecl_sum_fread_alloc_tail( "run/UNIFIED.SMSPEC" , ":" );
+    const int size          = util_file_size( "UNIFIED.UNSMRY" );
+    int length = 0;
+
+    test_assert_true( ecl_sum_is_instance( tail ));
+    test_assert_int_equal( 0 , ecl_sum_fread_tail( tail ));   /* No data file yet. */
+
+    for (int prefix = 0; prefix <= size; prefix += 37) {
+      int num_added;
+      copy_prefix( "UNIFIED.UNSMRY" , "run/UNIFIED.UNSMRY" , prefix );
+      num_added = ecl_sum_fread_tail( tail );
+      test_assert_true( num_added >= 0 );
+      if (num_added > 0)
+        test_assert_int_equal( length + num_added , ecl_sum_get_data_length( tail ));
+      length += num_added;
+    }
+    test_assert_true( length < NUM_REPORT * NUM_MINISTEP );
+
+    copy_prefix( "UNIFIED.UNSMRY" , "run/UNIFIED.UNSMRY" , size );
+    ecl_sum_fread_tail( tail );
+    test_equal( expected , tail );
+    test_assert_int_equal( 0 , ecl_sum_fread_tail( tail ));
+
+    /* The file has been rewritten, e.g. by a new simulation. */
+    copy_prefix( "UNIFIED.UNSMRY" , "run/UNIFIED.UNSMRY" , size / 2 );
+    test_assert_int_equal( -1 , ecl_sum_fread_tail( tail ));
+
+    ecl_sum_free( tail );
+    ecl_sum_free( expected );
+  }
+}
+
+
+void test_multiple( ) {
+  write_case( "MULTIPLE" , false );
+  util_make_path( "run" );
+  util_copy_file( "MULTIPLE.SMSPEC" , "run/MULTIPLE.SMSPEC" );
+  {
+    ecl_sum_type * expected = ecl_sum_fread_alloc_case( "MULTIPLE" , ":" );
+    ecl_sum_type * tail     = ecl_sum_fread_alloc_tail( "run/MULTIPLE.SMSPEC" , ":" );
+
+    for (int report_step = 1; report_step <= NUM_REPORT; report_step++) {
+      char * src_file    = ecl_util_alloc_filename( NULL  , "MULTIPLE" , ECL_SUMMARY_FILE , false , report_step );
+      char * target_file = ecl_util_alloc_filename( "run" , "MULTIPLE" , ECL_SUMMARY_FILE , false , report_step );
+      int size = util_file_size( src_file );
+
+      /* The new file is first seen half written. */
+      copy_prefix( src_file , target_file , size / 2 );
+      test_assert_true( ecl_sum_fread_tail( tail ) >= 0 );
+      copy_prefix( src_file , target_file , size );
+      test_assert_true( ecl_sum_fread_tail( tail ) > 0 );
+      test_assert_int_equal( report_step , ecl_sum_get_last_report_step( tail ));
+
+      free( src_file );
+      free( target_file );
+    }
+    test_equal( expected , tail );
+
+    ecl_sum_free( tail );
+    ecl_sum_free( expected );
+  }
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "ecl_sum_tail" , false );
+  test_unified( );
+  test_multiple( );
+  test_work_area_free( work_area );
+  exit(0);
+}
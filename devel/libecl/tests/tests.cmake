@@ -93,6 +93,14 @@ add_executable( ecl_sum_test ecl_sum_test.c )
 target_link_libraries( ecl_sum_test ecl test_util )
 add_test( ecl_sum_test ${EXECUTABLE_OUTPUT_PATH}/ecl_sum_test ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/Gurbat/ECLIPSE )
 
+add_executable( ecl_sum_tail ecl_sum_tail.c )
+target_link_libraries( ecl_sum_tail ecl test_util )
+add_test( ecl_sum_tail ${EXECUTABLE_OUTPUT_PATH}/ecl_sum_tail )
+
+add_executable( ecl_sum_report_vector ecl_sum_report_vector.c )
+target_link_libraries( ecl_sum_report_vector ecl test_util )
+add_test( ecl_sum_report_vector ${EXECUTABLE_OUTPUT_PATH}/ecl_sum_report_vector )
+
 add_executable( ecl_sum_report_step_equal ecl_sum_report_step_equal.c )
 target_link_libraries( ecl_sum_report_step_equal ecl test_util )
 add_test( ecl_sum_report_step_equal1 ${EXECUTABLE_OUTPUT_PATH}/ecl_sum_report_step_equal ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/Gurbat/ECLIPSE ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/Snorre/SNORRE FALSE)
@@ -0,0 +1,144 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'well_info_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <ert/util/util.h>
+#include <ert/util/timer.h>
+
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_rsthead.h>
+#include <ert/ecl/ecl_endian_flip.h>
+#include <ert/ecl/fortio.h>
+
+#include <ert/ecl_well/well_const.h>
+#include <ert/ecl_well/well_state.h>
+#include <ert/ecl_well/well_info.h>
+
+#include "well_UNRST_writer.h"
+
+/*
+  Times loading the wells from a generated unified restart file:
+
+     well_info_bench  [num_wells]  [num_steps]
+
+  Loading with well_info_load_rstfile() is compared with calling
+  well_state_alloc_from_file() for every well in every report step,
+  which parses the restart header and looks up the well keywords for
+  every well, as well_info_add_UNRST_wells() did before. The defaults
+  are 1000 wells and 200 report steps.
+*/
+
+#define NIWELZ  155
+#define NZWELZ    3
+#define NICONZ   25
+#define NCWMAX   10
+
+
+static void write_UNRST( const char * filename , int num_wells , int num_steps ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  well_UNRST_block_type * block = well_UNRST_block_alloc( 100 , 100 , NCWMAX , num_wells , NIWELZ , NZWELZ , NICONZ , NCWMAX );
+
+  for (int well_nr = 0; well_nr < num_wells; well_nr++) {
+    char * name = util_alloc_sprintf( "W%d" , well_nr );
+    well_UNRST_block_set_well( block , well_nr , name , IWEL_PRODUCER , true , 1 + well_nr % 100 , 1 + well_nr / 100 , 1 , NCWMAX );
+    free( name );
+
+    for (int conn_nr = 0; conn_nr < NCWMAX; conn_nr++)
+      well_UNRST_block_set_conn( block , well_nr , conn_nr , conn_nr + 1 , 1 + well_nr % 100 , 1 + well_nr / 100 , 1 + conn_nr , true , ICON_DIRZ );
+  }
+
+  for (int report_nr = 0; report_nr < num_steps; report_nr++) {
+    well_UNRST_block_set_date( block , report_nr , 1 + report_nr % 28 , 1 , 2000 + report_nr , 0 );
+    well_UNRST_block_fwrite( block , fortio );
+  }
+
+  well_UNRST_block_free( block );
+  fortio_fclose( fortio );
+}
+
+
+static int load_per_well( const char * filename , const ecl_grid_type * grid ) {
+  ecl_file_type * rst_file = ecl_file_open( filename , 0 );
+  int num_blocks = ecl_file_get_num_named_kw( rst_file , SEQNUM_KW );
+  int num_states = 0;
+
+  for (int block_nr = 0; block_nr < num_blocks; block_nr++) {
+    ecl_file_push_block( rst_file );
+    ecl_file_subselect_block( rst_file , SEQNUM_KW , block_nr );
+    {
+      ecl_rsthead_type * header = ecl_rsthead_alloc( rst_file );
+      for (int well_nr = 0; well_nr < header->nwells; well_nr++) {
+        well_state_type * well_state = well_state_alloc_from_file( rst_file , grid , block_nr , well_nr );
+        well_state_free( well_state );
+        num_states++;
+      }
+      ecl_rsthead_free( header );
+    }
+    ecl_file_pop_block( rst_file );
+  }
+  ecl_file_close( rst_file );
+  return num_states;
+}
+
+
+int main( int argc , char ** argv ) {
+  int num_wells = 1000;
+  int num_steps = 200;
+  if (argc > 1) util_sscanf_int( argv[1] , &num_wells );
+  if (argc > 2) util_sscanf_int( argv[2] , &num_steps );
+
+  {
+    char * path = util_alloc_tmp_file( "/tmp" , "well_info_bench" , false );
+    char * filename = util_alloc_sprintf( "%s.UNRST" , path );
+    ecl_grid_type * grid = ecl_grid_alloc_rectangular( 100 , 100 , NCWMAX , 1 , 1 , 1 , NULL );
+    timer_type * timer = timer_alloc( false );
+    double per_well_time , well_info_time;
+    int num_states;
+
+    write_UNRST( filename , num_wells , num_steps );
+
+    timer_start( timer );
+    num_states = load_per_well( filename , grid );
+    per_well_time = timer_stop( timer );
+
+    timer_reset( timer );
+    timer_start( timer );
+    {
+      well_info_type * well_info = well_info_alloc( grid );
+      well_info_load_rstfile( well_info , filename );
+      well_info_time = timer_stop( timer );
+      printf("Wells: %d   Report steps: %d   Well states: %d / %d\n" , well_info_get_num_wells( well_info ) , num_steps , num_states , well_info_get_num_wells( well_info ) * num_steps);
+      well_info_free( well_info );
+    }
+
+    printf("well_state_alloc_from_file() per well : %8.3f s\n" , per_well_time );
+    printf("well_info_load_rstfile()              : %8.3f s\n" , well_info_time );
+
+    timer_free( timer );
+    ecl_grid_free( grid );
+    util_unlink_existing( filename );
+    free( filename );
+    free( path );
+  }
+  exit(0);
+}
@@ -54,6 +54,7 @@ extern "C" {
   bool             well_conn_MSW(const well_conn_type * conn);
 
   well_conn_type * well_conn_alloc_from_kw( const ecl_kw_type * icon_kw , const ecl_rsthead_type * header , int well_nr , int conn_nr);
+  bool             well_conn_load_from_kw( well_conn_type * conn , const ecl_kw_type * icon_kw , const ecl_rsthead_type * header , int well_nr , int conn_nr);
   well_conn_type * well_conn_alloc_wellhead( const ecl_kw_type * iwel_kw , const ecl_rsthead_type * header , int well_nr);
 
   int                well_conn_get_i(const well_conn_type * conn);
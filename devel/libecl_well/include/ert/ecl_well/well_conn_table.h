@@ -0,0 +1,79 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'well_conn_table.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+
+#ifndef __WELL_CONN_TABLE_H__
+#define __WELL_CONN_TABLE_H__
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/type_macros.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_rsthead.h>
+
+#include <ert/ecl_well/well_conn.h>
+
+  typedef struct well_conn_table_struct well_conn_table_type;
+
+  well_conn_table_type * well_conn_table_alloc( const ecl_grid_type * grid );
+  void                   well_conn_table_free( well_conn_table_type * table );
+  int                    well_conn_table_load_from_kw( well_conn_table_type * table , int report_nr , const char * well_name , int grid_nr ,
+                                                       const ecl_kw_type * iwel_kw , const ecl_kw_type * icon_kw , int iwell , const ecl_rsthead_type * rst_head);
+  void                   well_conn_table_add_wells( well_conn_table_type * table , ecl_file_type * rst_file , int report_nr );
+  void                   well_conn_table_add_UNRST_wells( well_conn_table_type * table , ecl_file_type * rst_file );
+  void                   well_conn_table_load_rstfile( well_conn_table_type * table , const char * filename );
+
+  int                    well_conn_table_get_size( const well_conn_table_type * table );
+  int                    well_conn_table_iget_report( const well_conn_table_type * table , int row );
+  int                    well_conn_table_iget_well_index( const well_conn_table_type * table , int row );
+  int                    well_conn_table_iget_grid_nr( const well_conn_table_type * table , int row );
+  int                    well_conn_table_iget_i( const well_conn_table_type * table , int row );
+  int                    well_conn_table_iget_j( const well_conn_table_type * table , int row );
+  int                    well_conn_table_iget_k( const well_conn_table_type * table , int row );
+  int                    well_conn_table_iget_global_index( const well_conn_table_type * table , int row );
+  well_conn_dir_enum     well_conn_table_iget_dir( const well_conn_table_type * table , int row );
+  int                    well_conn_table_iget_segment( const well_conn_table_type * table , int row );
+  bool                   well_conn_table_iget_open( const well_conn_table_type * table , int row );
+  bool                   well_conn_table_iget_matrix_connection( const well_conn_table_type * table , int row );
+
+  int                    well_conn_table_get_num_wells( const well_conn_table_type * table );
+  bool                   well_conn_table_has_well( const well_conn_table_type * table , const char * well_name );
+  int                    well_conn_table_get_well_index( const well_conn_table_type * table , const char * well_name );
+  const char           * well_conn_table_iget_well_name( const well_conn_table_type * table , int well_index );
+  int                    well_conn_table_get_num_well_ranges( const well_conn_table_type * table , const char * well_name );
+  int                    well_conn_table_iget_well_range_begin( const well_conn_table_type * table , const char * well_name , int range_nr );
+  int                    well_conn_table_iget_well_range_end( const well_conn_table_type * table , const char * well_name , int range_nr );
+
+  int                    well_conn_table_get_cell_rows( well_conn_table_type * table , int grid_nr , int i , int j , int k , int_vector_type * rows );
+  int                    well_conn_table_get_cells( well_conn_table_type * table , int grid_nr , int_vector_type * global_index );
+
+  UTIL_IS_INSTANCE_HEADER( well_conn_table );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -32,6 +32,8 @@ extern "C" {
   typedef struct well_info_struct well_info_type;
   
   well_info_type *  well_info_alloc(const ecl_grid_type * grid);
+  void              well_info_set_num_threads( well_info_type * well_info , int num_threads);
+  int               well_info_get_num_threads( const well_info_type * well_info );
   void              well_info_add_UNRST_wells( well_info_type * well_info , ecl_file_type * rst_file);
   void              well_info_add_wells( well_info_type * well_info , ecl_file_type * rst_file , int report_nr );
   void              well_info_load_rstfile( well_info_type * well_info , const char * filename);
@@ -39,9 +39,15 @@ extern "C" {
 #define GLOBAL_GRID_NAME   "GLOBAL" // The name assigned to the global grid for name based lookup.
 
   typedef struct well_state_struct well_state_type;
+  typedef struct well_state_block_struct well_state_block_type;
   
   well_state_type      * well_state_alloc(const char * well_name , int global_well_nr , bool open, well_type_enum type , int report_nr, time_t valid_from);
   well_state_type      * well_state_alloc_from_file( ecl_file_type * ecl_file , const ecl_grid_type * grid , int report_step , int well_nr);
+  well_state_type      * well_state_alloc_from_block( const well_state_block_type * block , int report_step , int well_nr);
+
+  well_state_block_type * well_state_block_alloc( ecl_file_type * rst_file , const ecl_grid_type * grid );
+  void                    well_state_block_free( well_state_block_type * block );
+  int                     well_state_block_get_num_wells( const well_state_block_type * block );
 
   void well_state_add_connections( well_state_type * well_state , 
                                    const ecl_grid_type * grid , 
@@ -79,6 +85,7 @@ extern "C" {
   bool                              well_state_has_global_connections( const well_state_type * well_state );
 
   UTIL_IS_INSTANCE_HEADER( well_state );
+  UTIL_IS_INSTANCE_HEADER( well_state_block );
   
 #ifdef __cplusplus
 }
@@ -80,10 +80,8 @@ UTIL_IS_INSTANCE_FUNCTION( well_conn , WELL_CONN_TYPE_ID)
 UTIL_SAFE_CAST_FUNCTION( well_conn , WELL_CONN_TYPE_ID)
 
 
-static well_conn_type * well_conn_alloc__( int i , int j , int k , well_conn_dir_enum dir , bool open, int segment_id, bool matrix_connection) {
+static bool well_conn_init__( well_conn_type * conn , int i , int j , int k , well_conn_dir_enum dir , bool open, int segment_id, bool matrix_connection) {
   if (well_conn_assert_direction( dir , matrix_connection)) {
-    well_conn_type * conn = util_malloc( sizeof * conn );
-    UTIL_TYPE_ID_INIT( conn , WELL_CONN_TYPE_ID );
     conn->i = i;
     conn->j = j;
     conn->k = k;
@@ -96,9 +94,27 @@ static well_conn_type * well_conn_alloc__( int i , int j , int k , well_conn_dir
     else
       conn->segment = segment_id;
 
-    return conn;
+    return true;
   } else {
     printf("assert-direction failed.  dir:%d  matrix_connection:%d \n",dir , matrix_connection);
+    return false;
+  }
+}
+
+
+static well_conn_type * well_conn_alloc_empty( ) {
+  well_conn_type * conn = util_malloc( sizeof * conn );
+  UTIL_TYPE_ID_INIT( conn , WELL_CONN_TYPE_ID );
+  return conn;
+}
+
+
+static well_conn_type * well_conn_alloc__( int i , int j , int k , well_conn_dir_enum dir , bool open, int segment_id, bool matrix_connection) {
+  well_conn_type * conn = well_conn_alloc_empty( );
+  if (well_conn_init__( conn , i , j , k , dir , open , segment_id , matrix_connection ))
+    return conn;
+  else {
+    free( conn );
     return NULL;
   }
 }
@@ -132,16 +148,23 @@ well_conn_type * well_conn_alloc_fracture_MSW( int i , int j , int k , well_conn
 /*
   Observe that the (ijk) and branch values are shifted to zero offset to be
   aligned with the rest of the ert libraries.  
+
+  The well_conn_load_from_kw() function will overwrite an existing
+  well_conn instance with connection @conn_nr of well @well_nr, and
+  return false if the connection is not in this grid. This can be
+  used to decode the ICON keyword without allocating a new well_conn
+  instance for every connection.
 */
-well_conn_type * well_conn_alloc_from_kw( const ecl_kw_type * icon_kw , 
-                                          const ecl_rsthead_type * header , 
-                                          int well_nr , 
-                                          int conn_nr ) {
+
+bool well_conn_load_from_kw( well_conn_type * conn ,
+                             const ecl_kw_type * icon_kw , 
+                             const ecl_rsthead_type * header , 
+                             int well_nr , 
+                             int conn_nr ) {
   
   const int icon_offset = header->niconz * ( header->ncwmax * well_nr + conn_nr );
   int IC = ecl_kw_iget_int( icon_kw , icon_offset + ICON_IC_ITEM );
   if (IC > 0) {
-    well_conn_type * conn;
     int i       = ecl_kw_iget_int( icon_kw , icon_offset + ICON_I_ITEM ) - 1;
     int j       = ecl_kw_iget_int( icon_kw , icon_offset + ICON_J_ITEM ) - 1;
     int k       = ecl_kw_iget_int( icon_kw , icon_offset + ICON_K_ITEM ) - 1;
@@ -199,8 +222,6 @@ well_conn_type * well_conn_alloc_from_kw( const ecl_kw_type * icon_kw ,
       }
     }
     
-    conn = well_conn_alloc__(i,j,k,dir,open,segment,matrix_connection);
-    
     /**
        For multisegmented wells ONLY the global part of the restart
        file has segment information, i.e. the ?SEG
@@ -224,9 +245,23 @@ well_conn_type * well_conn_alloc_from_kw( const ecl_kw_type * icon_kw ,
     }
     */
     
-    return conn;
+    return well_conn_init__( conn , i , j , k , dir , open , segment , matrix_connection );
   } else
-    return NULL;  /* IC < 0: Connection not in current LGR. */
+    return false;  /* IC < 0: Connection not in current LGR. */
+}
+
+
+well_conn_type * well_conn_alloc_from_kw( const ecl_kw_type * icon_kw , 
+                                          const ecl_rsthead_type * header , 
+                                          int well_nr , 
+                                          int conn_nr ) {
+  well_conn_type * conn = well_conn_alloc_empty( );
+  if (well_conn_load_from_kw( conn , icon_kw , header , well_nr , conn_nr ))
+    return conn;
+  else {
+    free( conn );
+    return NULL;
+  }
 }
 
 
@@ -0,0 +1,522 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'well_conn_table.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/vector.h>
+#include <ert/util/hash.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/bool_vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_rsthead.h>
+#include <ert/ecl/ecl_util.h>
+
+#include <ert/ecl_well/well_const.h>
+#include <ert/ecl_well/well_conn.h>
+#include <ert/ecl_well/well_conn_table.h>
+
+
+/*
+  The well_conn_table holds the connections of all the wells, for
+  all the report steps, in one table with one row per (report, well,
+  connection). The table is stored column wise, with one int_vector
+  or bool_vector for each of the connection properties, and it is
+  loaded directly from the ICON keyword without allocating a
+  well_conn instance for every connection.
+
+  The rows are appended in the order they are loaded; the rows of one
+  well in one report step and grid form a contiguous range, and the
+  table keeps a list of these ranges for every well.
+
+  To answer questions like 'which wells have been connected to cell
+  (i,j,k)' the table has an index sorted on cell, which is built on
+  demand when the first such query after adding rows is made.
+
+  The grid_nr of a connection is 0 for the global grid and
+  lgr_index + 1 for the LGRs, as for the wellhead in the well_state
+  implementation; the (i,j,k) values are zero offset and relative to
+  the grid the connection is in.
+*/
+
+#define WELL_CONN_TABLE_TYPE_ID 118730554
+
+typedef struct {
+  int key;                              // cell_offset[grid_nr] + global_index
+  int row;
+} cell_node_type;
+
+
+struct well_conn_table_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  vector_type      * grids;             // ecl_grid instances indexed by grid_nr; not owned.
+  int_vector_type  * cell_offset;       // The first cell key for each grid_nr.
+  well_conn_type   * conn;              // Scratch instance used when decoding the ICON keyword.
+
+  int_vector_type  * report;
+  int_vector_type  * well;              // Index into the well_names list.
+  int_vector_type  * grid_nr;
+  int_vector_type  * i;
+  int_vector_type  * j;
+  int_vector_type  * k;
+  int_vector_type  * global_index;
+  int_vector_type  * dir;
+  int_vector_type  * segment;
+  bool_vector_type * open;
+  bool_vector_type * matrix_connection;
+
+  stringlist_type  * well_names;
+  hash_type        * well_index;        // Well name -> index in the well_names list.
+  vector_type      * well_ranges;       // One int_vector of [begin,end) pairs for each well.
+
+  int                index_size;        // The number of rows in the cell index.
+  cell_node_type   * cell_index;        // Sorted on (key,row).
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( well_conn_table , WELL_CONN_TABLE_TYPE_ID )
+
+
+well_conn_table_type * well_conn_table_alloc( const ecl_grid_type * grid ) {
+  well_conn_table_type * table = util_malloc( sizeof * table );
+  UTIL_TYPE_ID_INIT( table , WELL_CONN_TABLE_TYPE_ID );
+
+  table->grids       = vector_alloc_new();
+  table->cell_offset = int_vector_alloc( 0 , 0 );
+  table->conn        = well_conn_alloc( 0 , 0 , 0 , well_conn_dirZ , true );
+  {
+    int lgr_index;
+    int offset = ecl_grid_get_global_size( grid );
+
+    vector_append_ref( table->grids , grid );
+    int_vector_append( table->cell_offset , 0 );
+    for (lgr_index = 0; lgr_index < ecl_grid_get_num_lgr( grid ); lgr_index++) {
+      const ecl_grid_type * lgr = ecl_grid_iget_lgr( grid , lgr_index );
+      vector_append_ref( table->grids , lgr );
+      int_vector_append( table->cell_offset , offset );
+      offset += ecl_grid_get_global_size( lgr );
+    }
+    int_vector_append( table->cell_offset , offset );
+  }
+
+  table->report            = int_vector_alloc( 0 , 0 );
+  table->well              = int_vector_alloc( 0 , 0 );
+  table->grid_nr           = int_vector_alloc( 0 , 0 );
+  table->i                 = int_vector_alloc( 0 , 0 );
+  table->j                 = int_vector_alloc( 0 , 0 );
+  table->k                 = int_vector_alloc( 0 , 0 );
+  table->global_index      = int_vector_alloc( 0 , 0 );
+  table->dir               = int_vector_alloc( 0 , 0 );
+  table->segment           = int_vector_alloc( 0 , 0 );
+  table->open              = bool_vector_alloc( 0 , false );
+  table->matrix_connection = bool_vector_alloc( 0 , false );
+
+  table->well_names  = stringlist_alloc_new();
+  table->well_index  = hash_alloc();
+  table->well_ranges = vector_alloc_new();
+
+  table->index_size  = 0;
+  table->cell_index  = NULL;
+  return table;
+}
+
+
+void well_conn_table_free( well_conn_table_type * table ) {
+  int_vector_free( table->report );
+  int_vector_free( table->well );
+  int_vector_free( table->grid_nr );
+  int_vector_free( table->i );
+  int_vector_free( table->j );
+  int_vector_free( table->k );
+  int_vector_free( table->global_index );
+  int_vector_free( table->dir );
+  int_vector_free( table->segment );
+  bool_vector_free( table->open );
+  bool_vector_free( table->matrix_connection );
+
+  stringlist_free( table->well_names );
+  hash_free( table->well_index );
+  vector_free( table->well_ranges );
+
+  util_safe_free( table->cell_index );
+  well_conn_free( table->conn );
+  int_vector_free( table->cell_offset );
+  vector_free( table->grids );
+  free( table );
+}
+
+
+static int well_conn_table_add_well( well_conn_table_type * table , const char * well_name ) {
+  if (!hash_has_key( table->well_index , well_name )) {
+    hash_insert_int( table->well_index , well_name , stringlist_get_size( table->well_names ));
+    stringlist_append_copy( table->well_names , well_name );
+    vector_append_owned_ref( table->well_ranges , int_vector_alloc( 0 , 0 ) , int_vector_free__ );
+  }
+  return hash_get_int( table->well_index , well_name );
+}
+
+
+static int well_conn_table_get_cell_key( const well_conn_table_type * table , int grid_nr , int i , int j , int k , int * global_index) {
+  if ((grid_nr < 0) || (grid_nr >= vector_get_size( table->grids )))
+    util_abort("%s: invalid grid_nr:%d - the grid has %d LGRs \n",__func__ , grid_nr , vector_get_size( table->grids ) - 1);
+
+  {
+    const ecl_grid_type * grid = vector_iget_const( table->grids , grid_nr );
+    int nx , ny , nz , nactive;
+
+    ecl_grid_get_dims( grid , &nx , &ny , &nz , &nactive );
+    if ((i < 0) || (i >= nx) || (j < 0) || (j >= ny) || (k < 0) || (k >= nz))
+      util_abort("%s: cell (%d,%d,%d) is outside grid:%d with dimensions (%d,%d,%d) \n",__func__ , i , j , k , grid_nr , nx , ny , nz);
+
+    *global_index = ecl_grid_get_global_index3( grid , i , j , k );
+    return int_vector_iget( table->cell_offset , grid_nr ) + *global_index;
+  }
+}
+
+
+/*
+  Appends the connections of well @iwell in the IWEL and ICON
+  keywords to the table, and returns the number of rows added. The
+  keywords and @rst_head should be from the part of the restart file
+  corresponding to grid @grid_nr. Connections which are not in this
+  grid, i.e. with ICON_IC_ITEM <= 0, are skipped.
+*/
+
+int well_conn_table_load_from_kw( well_conn_table_type * table , int report_nr , const char * well_name , int grid_nr ,
+                                  const ecl_kw_type * iwel_kw , const ecl_kw_type * icon_kw , int iwell , const ecl_rsthead_type * rst_head) {
+  const int iwel_offset = rst_head->niwelz * iwell;
+  int num_connections   = ecl_kw_iget_int( iwel_kw , iwel_offset + IWEL_CONNECTIONS_ITEM );
+  int row_begin         = well_conn_table_get_size( table );
+  int well_index        = well_conn_table_add_well( table , well_name );
+  int iconn;
+
+  for (iconn = 0; iconn < num_connections; iconn++) {
+    well_conn_type * conn = table->conn;
+    if (well_conn_load_from_kw( conn , icon_kw , rst_head , iwell , iconn )) {
+      int global_index;
+
+      well_conn_table_get_cell_key( table , grid_nr , well_conn_get_i( conn ) , well_conn_get_j( conn ) , well_conn_get_k( conn ) , &global_index );
+      int_vector_append( table->report , report_nr );
+      int_vector_append( table->well , well_index );
+      int_vector_append( table->grid_nr , grid_nr );
+      int_vector_append( table->i , well_conn_get_i( conn ));
+      int_vector_append( table->j , well_conn_get_j( conn ));
+      int_vector_append( table->k , well_conn_get_k( conn ));
+      int_vector_append( table->global_index , global_index );
+      int_vector_append( table->dir , well_conn_get_dir( conn ));
+      int_vector_append( table->segment , well_conn_get_segment( conn ));
+      bool_vector_append( table->open , well_conn_open( conn ));
+      bool_vector_append( table->matrix_connection , well_conn_matrix_connection( conn ));
+    }
+  }
+
+  {
+    int row_end = well_conn_table_get_size( table );
+    if (row_end > row_begin) {
+      int_vector_type * ranges = vector_iget( table->well_ranges , well_index );
+      int_vector_append( ranges , row_begin );
+      int_vector_append( ranges , row_end );
+    }
+    return row_end - row_begin;
+  }
+}
+
+
+static void well_conn_table_add_grid_wells( well_conn_table_type * table , const ecl_file_type * rst_file , int report_nr , int grid_nr) {
+  if (ecl_file_has_kw( rst_file , IWEL_KW ) && ecl_file_has_kw( rst_file , ZWEL_KW ) && ecl_file_has_kw( rst_file , ICON_KW )) {
+    ecl_rsthead_type  * header  = ecl_rsthead_alloc( rst_file );
+    const ecl_kw_type * iwel_kw = ecl_file_iget_named_kw( rst_file , IWEL_KW , 0 );
+    const ecl_kw_type * zwel_kw = ecl_file_iget_named_kw( rst_file , ZWEL_KW , 0 );
+    const ecl_kw_type * icon_kw = ecl_file_iget_named_kw( rst_file , ICON_KW , 0 );
+    int well_nr;
+
+    for (well_nr = 0; well_nr < header->nwells; well_nr++) {
+      char * well_name = util_alloc_strip_copy( ecl_kw_iget_ptr( zwel_kw , well_nr * header->nzwelz ));
+      well_conn_table_load_from_kw( table , report_nr , well_name , grid_nr , iwel_kw , icon_kw , well_nr , header );
+      free( well_name );
+    }
+    ecl_rsthead_free( header );
+  }
+}
+
+
+/**
+   Adds the connections of all the wells in the report step of
+   @rst_file; i.e. an open .Xnnnn file or an UNRST file restricted to
+   one report step. Connections in the LGRs are read from the LGR
+   blocks of the file.
+*/
+
+void well_conn_table_add_wells( well_conn_table_type * table , ecl_file_type * rst_file , int report_nr ) {
+  int lgr_index;
+
+  well_conn_table_add_grid_wells( table , rst_file , report_nr , 0 );
+  for (lgr_index = 0; lgr_index < vector_get_size( table->grids ) - 1; lgr_index++) {
+    ecl_file_push_block( rst_file );
+    {
+      if (ecl_file_subselect_block( rst_file , LGR_KW , lgr_index ))
+        well_conn_table_add_grid_wells( table , rst_file , report_nr , lgr_index + 1 );
+    }
+    ecl_file_pop_block( rst_file );
+  }
+}
+
+
+void well_conn_table_add_UNRST_wells( well_conn_table_type * table , ecl_file_type * rst_file ) {
+  int num_blocks = ecl_file_get_num_named_kw( rst_file , SEQNUM_KW );
+  int block_nr;
+  for (block_nr = 0; block_nr < num_blocks; block_nr++) {
+    ecl_file_push_block( rst_file );
+    {
+      ecl_file_subselect_block( rst_file , SEQNUM_KW , block_nr );
+      {
+        const ecl_kw_type * seqnum_kw = ecl_file_iget_named_kw( rst_file , SEQNUM_KW , 0);
+        int report_nr = ecl_kw_iget_int( seqnum_kw , 0 );
+        well_conn_table_add_wells( table , rst_file , report_nr );
+      }
+    }
+    ecl_file_pop_block( rst_file );
+  }
+}
+
+
+void well_conn_table_load_rstfile( well_conn_table_type * table , const char * filename ) {
+  int report_nr;
+  ecl_file_enum file_type = ecl_util_get_file_type( filename , NULL , &report_nr);
+  if ((file_type == ECL_RESTART_FILE) || (file_type == ECL_UNIFIED_RESTART_FILE)) {
+    ecl_file_type * ecl_file = ecl_file_open( filename , 0);
+
+    if (file_type == ECL_RESTART_FILE)
+      well_conn_table_add_wells( table , ecl_file , report_nr );
+    else
+      well_conn_table_add_UNRST_wells( table , ecl_file );
+
+    ecl_file_close( ecl_file );
+  } else
+    util_abort("%s: invalid file type:%s - must be a restart file\n",__func__ , filename);
+}
+
+/*****************************************************************/
+
+int well_conn_table_get_size( const well_conn_table_type * table ) {
+  return int_vector_size( table->report );
+}
+
+int well_conn_table_iget_report( const well_conn_table_type * table , int row ) {
+  return int_vector_iget( table->report , row );
+}
+
+int well_conn_table_iget_well_index( const well_conn_table_type * table , int row ) {
+  return int_vector_iget( table->well , row );
+}
+
+int well_conn_table_iget_grid_nr( const well_conn_table_type * table , int row ) {
+  return int_vector_iget( table->grid_nr , row );
+}
+
+int well_conn_table_iget_i( const well_conn_table_type * table , int row ) {
+  return int_vector_iget( table->i , row );
+}
+
+int well_conn_table_iget_j( const well_conn_table_type * table , int row ) {
+  return int_vector_iget( table->j , row );
+}
+
+int well_conn_table_iget_k( const well_conn_table_type * table , int row ) {
+  return int_vector_iget( table->k , row );
+}
+
+int well_conn_table_iget_global_index( const well_conn_table_type * table , int row ) {
+  return int_vector_iget( table->global_index , row );
+}
+
+well_conn_dir_enum well_conn_table_iget_dir( const well_conn_table_type * table , int row ) {
+  return int_vector_iget( table->dir , row );
+}
+
+int well_conn_table_iget_segment( const well_conn_table_type * table , int row ) {
+  return int_vector_iget( table->segment , row );
+}
+
+bool well_conn_table_iget_open( const well_conn_table_type * table , int row ) {
+  return bool_vector_iget( table->open , row );
+}
+
+bool well_conn_table_iget_matrix_connection( const well_conn_table_type * table , int row ) {
+  return bool_vector_iget( table->matrix_connection , row );
+}
+
+/*****************************************************************/
+
+int well_conn_table_get_num_wells( const well_conn_table_type * table ) {
+  return stringlist_get_size( table->well_names );
+}
+
+bool well_conn_table_has_well( const well_conn_table_type * table , const char * well_name ) {
+  return hash_has_key( table->well_index , well_name );
+}
+
+int well_conn_table_get_well_index( const well_conn_table_type * table , const char * well_name ) {
+  return hash_get_int( table->well_index , well_name );
+}
+
+const char * well_conn_table_iget_well_name( const well_conn_table_type * table , int well_index ) {
+  return stringlist_iget( table->well_names , well_index );
+}
+
+
+/*
+  The rows of one well are found as a list of [begin,end) ranges; one
+  range for every report step and grid the well has connections in,
+  in the order they were loaded.
+*/
+
+int well_conn_table_get_num_well_ranges( const well_conn_table_type * table , const char * well_name ) {
+  if (well_conn_table_has_well( table , well_name )) {
+    const int_vector_type * ranges = vector_iget_const( table->well_ranges , well_conn_table_get_well_index( table , well_name ));
+    return int_vector_size( ranges ) / 2;
+  } else
+    return 0;
+}
+
+int well_conn_table_iget_well_range_begin( const well_conn_table_type * table , const char * well_name , int range_nr ) {
+  const int_vector_type * ranges = vector_iget_const( table->well_ranges , well_conn_table_get_well_index( table , well_name ));
+  return int_vector_iget( ranges , 2 * range_nr );
+}
+
+int well_conn_table_iget_well_range_end( const well_conn_table_type * table , const char * well_name , int range_nr ) {
+  const int_vector_type * ranges = vector_iget_const( table->well_ranges , well_conn_table_get_well_index( table , well_name ));
+  return int_vector_iget( ranges , 2 * range_nr + 1 );
+}
+
+/*****************************************************************/
+
+static int cell_node_cmp( const void * arg1 , const void * arg2 ) {
+  const cell_node_type * node1 = (const cell_node_type *) arg1;
+  const cell_node_type * node2 = (const cell_node_type *) arg2;
+
+  if (node1->key != node2->key)
+    return (node1->key < node2->key) ? -1 : 1;
+  else if (node1->row != node2->row)
+    return (node1->row < node2->row) ? -1 : 1;
+  else
+    return 0;
+}
+
+
+static void well_conn_table_update_cell_index( well_conn_table_type * table ) {
+  int size = well_conn_table_get_size( table );
+  if (size != table->index_size) {
+    const int * grid_nr      = int_vector_get_const_ptr( table->grid_nr );
+    const int * global_index = int_vector_get_const_ptr( table->global_index );
+    const int * cell_offset  = int_vector_get_const_ptr( table->cell_offset );
+    int row;
+
+    table->cell_index = util_realloc( table->cell_index , size * sizeof * table->cell_index );
+    for (row = 0; row < size; row++) {
+      table->cell_index[row].key = cell_offset[ grid_nr[row] ] + global_index[row];
+      table->cell_index[row].row = row;
+    }
+    qsort( table->cell_index , size , sizeof * table->cell_index , cell_node_cmp );
+    table->index_size = size;
+  }
+}
+
+
+/*
+  Returns the position of the first node in the cell index with key
+  >= @key.
+*/
+
+static int well_conn_table_cell_lower_bound( const well_conn_table_type * table , int key ) {
+  int lower = 0;
+  int upper = table->index_size;
+
+  while (lower < upper) {
+    int mid = (lower + upper) / 2;
+    if (table->cell_index[mid].key < key)
+      lower = mid + 1;
+    else
+      upper = mid;
+  }
+  return lower;
+}
+
+
+/*
+  Will fill the @rows vector with all the rows, i.e. all the
+  connections for all wells and report steps, in cell (i,j,k) of grid
+  @grid_nr. The rows are in ascending order, and the number of rows is
+  returned.
+*/
+
+int well_conn_table_get_cell_rows( well_conn_table_type * table , int grid_nr , int i , int j , int k , int_vector_type * rows ) {
+  int global_index;
+  int key = well_conn_table_get_cell_key( table , grid_nr , i , j , k , &global_index );
+  int pos;
+
+  well_conn_table_update_cell_index( table );
+  int_vector_reset( rows );
+  for (pos = well_conn_table_cell_lower_bound( table , key ); pos < table->index_size; pos++) {
+    if (table->cell_index[pos].key != key)
+      break;
+    int_vector_append( rows , table->cell_index[pos].row );
+  }
+  return int_vector_size( rows );
+}
+
+
+/*
+  Will fill the @global_index vector with the global index of all the
+  cells in grid @grid_nr which have been connected to a well, at any
+  report step; the global indices are sorted and unique, and the
+  number of cells is returned.
+*/
+
+int well_conn_table_get_cells( well_conn_table_type * table , int grid_nr , int_vector_type * global_index ) {
+  if ((grid_nr < 0) || (grid_nr >= vector_get_size( table->grids )))
+    util_abort("%s: invalid grid_nr:%d - the grid has %d LGRs \n",__func__ , grid_nr , vector_get_size( table->grids ) - 1);
+
+  well_conn_table_update_cell_index( table );
+  int_vector_reset( global_index );
+  {
+    int first_key = int_vector_iget( table->cell_offset , grid_nr );
+    int last_key  = int_vector_iget( table->cell_offset , grid_nr + 1 );
+    int prev_key  = -1;
+    int pos;
+
+    for (pos = well_conn_table_cell_lower_bound( table , first_key ); pos < table->index_size; pos++) {
+      int key = table->cell_index[pos].key;
+      if (key >= last_key)
+        break;
+
+      if (key != prev_key) {
+        int_vector_append( global_index , key - first_key );
+        prev_key = key;
+      }
+    }
+  }
+  return int_vector_size( global_index );
+}
@@ -18,11 +18,15 @@
 
 #include <time.h>
 #include <stdbool.h>
+#include <unistd.h>
 
 #include <ert/util/util.h>
 #include <ert/util/hash.h>
 #include <ert/util/int_vector.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/vector.h>
+#include <ert/util/arg_pack.h>
+#include <ert/util/thread_pool.h>
 
 #include <ert/ecl/ecl_rsthead.h>
 #include <ert/ecl/ecl_file.h>
@@ -182,6 +186,7 @@ struct well_info_struct {
   hash_type           * wells;                /* Hash table of well_ts_type instances; indexed by well name. */
   stringlist_type     * well_names;           /* A list of all the well names. */
   const ecl_grid_type * grid;
+  int                   num_threads;          /* The max number of threads used to load a unified restart file. */
 };
 
 
@@ -195,10 +200,24 @@ well_info_type * well_info_alloc( const ecl_grid_type * grid) {
   well_info->wells      = hash_alloc();
   well_info->well_names = stringlist_alloc_new();
   well_info->grid       = grid;
+  well_info->num_threads = util_int_max( 1 , sysconf( _SC_NPROCESSORS_ONLN ));
   return well_info;
 }
 
 
+void well_info_set_num_threads( well_info_type * well_info , int num_threads) {
+  if (num_threads > 0)
+    well_info->num_threads = num_threads;
+  else
+    util_abort("%s: invalid number of threads:%d \n",__func__ , num_threads);
+}
+
+
+int well_info_get_num_threads( const well_info_type * well_info ) {
+  return well_info->num_threads;
+}
+
+
 bool well_info_has_well( well_info_type * well_info , const char * well_name ) {
   return hash_has_key( well_info->wells , well_name );
 }
@@ -265,9 +284,11 @@ static void well_info_add_state( well_info_type * well_info , well_state_type *
    easier to use the well_info_add_UNRST_wells() function; which works
    by calling this function repeatedly.
 
-   This function will go through all the wells by number and call the
-   well_state_alloc_from_file() function to create a well state object for each
-   well. The well_state_alloc_from_file() function will iterate through all the
+   This function will load the restart headers and well keywords of
+   all the grids into a well_state_block instance, and then go through
+   all the wells by number and call the well_state_alloc_from_block()
+   function to create a well state object for each well. The
+   well_state_alloc_from_block() function will iterate through all the
    grids and assign well properties corresponding to each of the
    grids, the global grid special-cased to determine is consulted to
    determine the number of wells.
@@ -275,15 +296,177 @@ static void well_info_add_state( well_info_type * well_info , well_state_type *
 
 void well_info_add_wells( well_info_type * well_info , ecl_file_type * rst_file , int report_nr) {
   int well_nr;
-  ecl_rsthead_type * global_header = ecl_rsthead_alloc( rst_file );
-  for (well_nr = 0; well_nr < global_header->nwells; well_nr++) {
-    well_state_type * well_state = well_state_alloc_from_file( rst_file , well_info->grid , report_nr , well_nr );
+  well_state_block_type * block = well_state_block_alloc( rst_file , well_info->grid );
+  for (well_nr = 0; well_nr < well_state_block_get_num_wells( block ); well_nr++) {
+    well_state_type * well_state = well_state_alloc_from_block( block , report_nr , well_nr );
     if (well_state != NULL)
       well_info_add_state( well_info , well_state );
   }
-  ecl_rsthead_free( global_header );
+  well_state_block_free( block );
+}
+
+
+/*
+  Creates the well_state instances for the report blocks [first_block,
+  last_block) of a unified restart file and appends them to the
+  @well_states vector, in the order they are found in the file.
+*/
+
+static void well_info_load_UNRST_blocks( ecl_file_type * rst_file , const ecl_grid_type * grid , int first_block , int last_block , vector_type * well_states) {
+  int block_nr;
+  for (block_nr = first_block; block_nr < last_block; block_nr++) {
+    ecl_file_push_block( rst_file );      // <-------------------------------------------------------
+    {                                                                                               //
+      ecl_file_subselect_block( rst_file , SEQNUM_KW , block_nr );                                  //  Ensure that the status
+      {                                                                                             //  is not changed as a side
+        const ecl_kw_type * seqnum_kw = ecl_file_iget_named_kw( rst_file , SEQNUM_KW , 0);          //  effect.
+        int report_nr = ecl_kw_iget_int( seqnum_kw , 0 );                                           //
+        well_state_block_type * block = well_state_block_alloc( rst_file , grid );                  //
+        int well_nr;                                                                                //
+                                                                                                    //
+        for (well_nr = 0; well_nr < well_state_block_get_num_wells( block ); well_nr++) {           //
+          well_state_type * well_state = well_state_alloc_from_block( block , report_nr , well_nr );//
+          if (well_state != NULL)                                                                   //
+            vector_append_ref( well_states , well_state );                                          //
+        }                                                                                           //
+        well_state_block_free( block );                                                             //
+      }                                                                                             //
+    }                                                                                               //
+    ecl_file_pop_block( rst_file );       // <-------------------------------------------------------
+  }
+}
+
+
+static void well_info_add_states( well_info_type * well_info , const vector_type * well_states) {
+  int i;
+  for (i = 0; i < vector_get_size( well_states ); i++)
+    well_info_add_state( well_info , vector_iget( well_states , i ));
+}
+
+
+/*
+  If the current build has a thread_pool implementation the report
+  blocks are loaded in parallel, with at most num_threads threads;
+  every thread opens the restart file as a separate ecl_file
+  instance, because ecl_file is not thread safe, and loads a
+  contiguous range of report blocks. If the report numbers of the
+  reopened file do not match the report numbers of the @rst_file
+  view the blocks are loaded serially instead. The well_state instances are
+  added to the well_info structure in report block order when all the
+  threads have completed, so the result is identical to loading the
+  blocks serially.
+*/
+
+#ifdef WITH_THREAD_POOL
+
+#define WELL_INFO_BLOCKS_PER_THREAD  4
+
+static void * well_info_load_UNRST_blocks_mt( void * arg ) {
+  arg_pack_type * arg_pack   = arg_pack_safe_cast( arg );
+  const char * filename      = arg_pack_iget_const_ptr( arg_pack , 0 );
+  const ecl_grid_type * grid = arg_pack_iget_const_ptr( arg_pack , 1 );
+  const int_vector_type * report_list = arg_pack_iget_const_ptr( arg_pack , 2 );
+  int first_block            = arg_pack_iget_int( arg_pack , 3 );
+  int last_block             = arg_pack_iget_int( arg_pack , 4 );
+  vector_type * well_states  = arg_pack_iget_ptr( arg_pack , 5 );
+  bool * ok                  = arg_pack_iget_ptr( arg_pack , 6 );
+  ecl_file_type * rst_file   = ecl_file_open( filename , 0 );
+
+  /*
+    The file must have the same report blocks as the view of the
+    ecl_file instance passed to well_info_add_UNRST_wells().
+  */
+  *ok = (ecl_file_get_num_named_kw( rst_file , SEQNUM_KW ) == int_vector_size( report_list ));
+  if (*ok) {
+    int block_nr;
+    for (block_nr = first_block; block_nr < last_block; block_nr++) {
+      const ecl_kw_type * seqnum_kw = ecl_file_iget_named_kw( rst_file , SEQNUM_KW , block_nr );
+      if (ecl_kw_iget_int( seqnum_kw , 0 ) != int_vector_iget( report_list , block_nr ))
+        *ok = false;
+    }
+  }
+
+  if (*ok)
+    well_info_load_UNRST_blocks( rst_file , grid , first_block , last_block , well_states );
+
+  ecl_file_close( rst_file );
+  return NULL;
+}
+
+
+static bool well_info_add_UNRST_wells_mt( well_info_type * well_info , const ecl_file_type * rst_file , int num_blocks) {
+  int num_threads = util_int_min( well_info->num_threads , num_blocks / WELL_INFO_BLOCKS_PER_THREAD );
+  bool loaded = false;
+
+  if ((num_threads > 1) && !ecl_file_writable( rst_file )) {
+    thread_pool_type * thread_pool = thread_pool_alloc( num_threads , false );
+    arg_pack_type   ** arglist     = util_calloc( num_threads , sizeof * arglist );
+    vector_type     ** well_states = util_calloc( num_threads , sizeof * well_states );
+    bool             * ok          = util_calloc( num_threads , sizeof * ok );
+    int_vector_type  * report_list = int_vector_alloc( 0 , 0 );
+    int it;
+
+    for (it = 0; it < num_blocks; it++) {
+      const ecl_kw_type * seqnum_kw = ecl_file_iget_named_kw( rst_file , SEQNUM_KW , it );
+      int_vector_append( report_list , ecl_kw_iget_int( seqnum_kw , 0 ));
+    }
+
+    thread_pool_restart( thread_pool );
+    {
+      int blocks      = num_blocks / num_threads;
+      int blocks_mod  = num_blocks % num_threads;
+      int first_block = 0;
+
+      for (it = 0; it < num_threads; it++) {
+        int block_size = blocks;
+        if (it < blocks_mod)
+          block_size += 1;
+
+        well_states[it] = vector_alloc_new();
+        arglist[it] = arg_pack_alloc();
+        arg_pack_append_const_ptr( arglist[it] , ecl_file_get_src_file( rst_file ));
+        arg_pack_append_const_ptr( arglist[it] , well_info->grid );
+        arg_pack_append_const_ptr( arglist[it] , report_list );
+        arg_pack_append_int( arglist[it] , first_block );
+        arg_pack_append_int( arglist[it] , first_block + block_size );
+        arg_pack_append_ptr( arglist[it] , well_states[it] );
+        arg_pack_append_ptr( arglist[it] , &ok[it] );
+
+        thread_pool_add_job( thread_pool , well_info_load_UNRST_blocks_mt , arglist[it] );
+        first_block += block_size;
+      }
+    }
+    thread_pool_join( thread_pool );
+
+    loaded = true;
+    for (it = 0; it < num_threads; it++)
+      loaded = loaded && ok[it];
+
+    for (it = 0; it < num_threads; it++) {
+      if (loaded)
+        well_info_add_states( well_info , well_states[it] );
+      else {
+        int i;
+        for (i = 0; i < vector_get_size( well_states[it] ); i++)
+          well_state_free( vector_iget( well_states[it] , i ));
+      }
+      vector_free( well_states[it] );
+      arg_pack_free( arglist[it] );
+    }
+
+    int_vector_free( report_list );
+    free( ok );
+    free( well_states );
+    free( arglist );
+    thread_pool_free( thread_pool );
+  }
+
+  return loaded;
 }
 
+#endif
+
+
 /**
    Observe that this function will fail if the rst_file instance
    corresponds to a non-unified restart file, because these files do
@@ -291,21 +474,18 @@ void well_info_add_wells( well_info_type * well_info , ecl_file_type * rst_file
 */
 
 void well_info_add_UNRST_wells( well_info_type * well_info , ecl_file_type * rst_file) {
-  {
-    int num_blocks = ecl_file_get_num_named_kw( rst_file , SEQNUM_KW );
-    int block_nr;
-    for (block_nr = 0; block_nr < num_blocks; block_nr++) {
-      ecl_file_push_block( rst_file );      // <-------------------------------------------------------
-      {                                                                                               //
-        ecl_file_subselect_block( rst_file , SEQNUM_KW , block_nr );                                  //  Ensure that the status
-        {                                                                                             //  is not changed as a side
-          const ecl_kw_type * seqnum_kw = ecl_file_iget_named_kw( rst_file , SEQNUM_KW , 0);          //  effect.
-          int report_nr = ecl_kw_iget_int( seqnum_kw , 0 );                                           //
-          well_info_add_wells( well_info , rst_file , report_nr );                                    //
-        }                                                                                             //
-      }                                                                                               //
-      ecl_file_pop_block( rst_file );       // <-------------------------------------------------------
-    }
+  int num_blocks = ecl_file_get_num_named_kw( rst_file , SEQNUM_KW );
+  bool loaded = false;
+
+#ifdef WITH_THREAD_POOL
+  loaded = well_info_add_UNRST_wells_mt( well_info , rst_file , num_blocks );
+#endif
+
+  if (!loaded) {
+    vector_type * well_states = vector_alloc_new();
+    well_info_load_UNRST_blocks( rst_file , well_info->grid , 0 , num_blocks , well_states );
+    well_info_add_states( well_info , well_states );
+    vector_free( well_states );
   }
 }
 
@@ -223,46 +223,168 @@ void well_state_add_wellhead( well_state_type * well_state , const ecl_rsthead_t
 
 
 /*
-  This function assumes that the ecl_file state has been restricted
-  to one LGR block with the ecl_file_subselect_block() function.
+  The restart header and the well related keywords of one grid, the
+  global grid or one LGR, in one report step. The keywords are owned
+  by the ecl_file instance they were loaded from.
+*/
+
+typedef struct {
+  char              * grid_name;
+  int                 grid_nr;
+  ecl_rsthead_type  * header;
+  const ecl_kw_type * iwel_kw;
+  const ecl_kw_type * zwel_kw;
+  const ecl_kw_type * icon_kw;
+  const ecl_kw_type * iseg_kw;
+  const ecl_kw_type * rseg_kw;
+  hash_type         * well_index;   // Well name -> well_nr in this LGR; NULL for the global grid.
+} well_grid_kw_type;
+
+
+/*
+  The well_state_block_type instance collects the well_grid_kw
+  instances of all the grids for one report step. All the wells of the
+  report step are created from the same block, so the restart headers
+  are parsed and the keywords looked up once per report step, instead
+  of once for every well and grid.
+*/
+
+#define WELL_STATE_BLOCK_TYPE_ID 661098524
+
+struct well_state_block_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  int             num_wells;
+  vector_type   * grids;           // well_grid_kw_type instances indexed by grid_nr; NULL for LGRs without wells.
+};
+
+
+static const ecl_kw_type * well_grid_kw_get_kw( const ecl_file_type * rst_file , const char * kw ) {
+  if (ecl_file_has_kw( rst_file , kw ))
+    return ecl_file_iget_named_kw( rst_file , kw , 0 );
+  else
+    return NULL;
+}
+
+
+static well_grid_kw_type * well_grid_kw_alloc( const ecl_file_type * rst_file , const char * grid_name , int grid_nr) {
+  well_grid_kw_type * grid_kw = util_malloc( sizeof * grid_kw );
+
+  grid_kw->grid_name  = util_alloc_string_copy( grid_name );
+  grid_kw->grid_nr    = grid_nr;
+  grid_kw->header     = ecl_rsthead_alloc( rst_file );
+  grid_kw->iwel_kw    = well_grid_kw_get_kw( rst_file , IWEL_KW );
+  grid_kw->zwel_kw    = well_grid_kw_get_kw( rst_file , ZWEL_KW );
+  grid_kw->icon_kw    = well_grid_kw_get_kw( rst_file , ICON_KW );
+  grid_kw->iseg_kw    = well_grid_kw_get_kw( rst_file , ISEG_KW );
+  /*
+     The rseg_kw pointer will later be used in
+     well_segment_collection_load_from_kw() where we test if this is a
+     MSW well. If this indeed is a MSW well the rseg_kw pointer will be
+     used unchecked, if it is then NULL => Crash and burn.
+  */
+  grid_kw->rseg_kw    = well_grid_kw_get_kw( rst_file , RSEG_KW );
+  grid_kw->well_index = NULL;
+
+  if ((grid_nr > 0) && (grid_kw->zwel_kw != NULL)) {
+    int well_nr;
+    grid_kw->well_index = hash_alloc();
+    for (well_nr = 0; well_nr < grid_kw->header->nwells; well_nr++) {
+      char * lgr_well_name = util_alloc_strip_copy( ecl_kw_iget_ptr( grid_kw->zwel_kw , well_nr * grid_kw->header->nzwelz) );
+      if (!hash_has_key( grid_kw->well_index , lgr_well_name ))
+        hash_insert_int( grid_kw->well_index , lgr_well_name , well_nr );
+      free( lgr_well_name );
+    }
+  }
 
+  return grid_kw;
+}
+
+
+static void well_grid_kw_free( well_grid_kw_type * grid_kw ) {
+  if (grid_kw->well_index != NULL)
+    hash_free( grid_kw->well_index );
+  ecl_rsthead_free( grid_kw->header );
+  free( grid_kw->grid_name );
+  free( grid_kw );
+}
+
+
+static void well_grid_kw_free__( void * arg ) {
+  well_grid_kw_free( (well_grid_kw_type *) arg );
+}
+
+
+/*
   Return value: -1 means that the well is not found in this LGR at
   all.
 */
 
-static int well_state_get_lgr_well_nr( const well_state_type * well_state , const ecl_file_type * ecl_file) {
-  int well_nr = -1;
+static int well_grid_kw_get_well_nr( const well_grid_kw_type * grid_kw , const char * well_name , int global_well_nr) {
+  if (grid_kw->grid_nr == 0)
+    return global_well_nr;
+  else if (hash_has_key( grid_kw->well_index , well_name ))
+    return hash_get_int( grid_kw->well_index , well_name );
+  else
+    return -1;
+}
 
-  if (ecl_file_has_kw( ecl_file , ZWEL_KW)) {
-    ecl_rsthead_type  * header  = ecl_rsthead_alloc( ecl_file );
-    const ecl_kw_type * zwel_kw = ecl_file_iget_named_kw( ecl_file , ZWEL_KW  , 0 );
-    int num_wells               = header->nwells;
-    well_nr = 0;
-    while (true) {
-      bool found = false;
-      {
-        char * lgr_well_name = util_alloc_strip_copy( ecl_kw_iget_ptr( zwel_kw , well_nr * header->nzwelz) );
 
-        if ( strcmp( well_state->name , lgr_well_name) == 0)
-          found = true;
-        else
-          well_nr++;
+UTIL_IS_INSTANCE_FUNCTION( well_state_block , WELL_STATE_BLOCK_TYPE_ID )
 
-        free( lgr_well_name );
-      }
 
-      if (found)
-        break;
-      else if (well_nr == num_wells) {
-        // The well is not in this LGR at all.
-        well_nr = -1;
-        break;
-      }
+/*
+  The @rst_file must be an open .Xnnnn file, or an UNRST file
+  restricted to one report step; the ecl_file view is restored
+  before returning. The keywords are not copied, so the @rst_file
+  must be kept open as long as the block is in use.
+*/
 
+well_state_block_type * well_state_block_alloc( ecl_file_type * rst_file , const ecl_grid_type * grid ) {
+  well_state_block_type * block = util_malloc( sizeof * block );
+  UTIL_TYPE_ID_INIT( block , WELL_STATE_BLOCK_TYPE_ID );
+  block->grids     = vector_alloc_new();
+  block->num_wells = 0;
+
+  if (ecl_file_has_kw( rst_file , IWEL_KW)) {
+    well_grid_kw_type * global_kw = well_grid_kw_alloc( rst_file , ECL_GRID_GLOBAL_GRID , 0 );
+    vector_safe_iset_owned_ref( block->grids , 0 , global_kw , well_grid_kw_free__ );
+    block->num_wells = global_kw->header->nwells;
+
+    if (block->num_wells > 0) {
+      int num_lgr = ecl_grid_get_num_lgr( grid );
+      int lgr_index;
+      for (lgr_index = 0; lgr_index < num_lgr; lgr_index++) {
+        ecl_file_push_block( rst_file );                          // <-------------------------//
+        {                                                                                      //
+          ecl_file_subselect_block( rst_file , LGR_KW , lgr_index );                           //  Restrict the file view
+          if (ecl_file_has_kw( rst_file , ZWEL_KW )) {                                         //  to one LGR block.
+            const char * grid_name = ecl_grid_iget_lgr_name( grid , lgr_index );               //
+            well_grid_kw_type * lgr_kw = well_grid_kw_alloc( rst_file , grid_name , lgr_index + 1 );
+            vector_safe_iset_owned_ref( block->grids , lgr_index + 1 , lgr_kw , well_grid_kw_free__ );
+          }                                                                                    //
+        }                                                                                      //
+        ecl_file_pop_block( rst_file );                           // <-------------------------//
+      }
     }
-    ecl_rsthead_free( header );
   }
-  return well_nr;
+
+  return block;
+}
+
+
+void well_state_block_free( well_state_block_type * block ) {
+  vector_free( block->grids );
+  free( block );
+}
+
+
+/*
+  The number of wells in the global grid; this is zero for restart
+  files without the IWEL keyword.
+*/
+
+int well_state_block_get_num_wells( const well_state_block_type * block ) {
+  return block->num_wells;
 }
 
 
@@ -295,60 +417,41 @@ well_type_enum well_state_translate_ecl_type_int(int int_type) {
 
 
 
-/*
-  This function assumes that the ecl_file state has been restricted
-  to one LGR block with the ecl_file_subselect_block() function.
-*/
-
 static void well_state_add_connections__( well_state_type * well_state ,
-                                          const ecl_file_type * rst_file ,
-                                          const char * grid_name ,
-                                          int grid_nr,
+                                          const well_grid_kw_type * grid_kw ,
                                           int well_nr ) {
 
-  ecl_rsthead_type  * header   = ecl_rsthead_alloc( rst_file );
-  const ecl_kw_type * icon_kw  = ecl_file_iget_named_kw( rst_file , ICON_KW   , 0);
-  const ecl_kw_type * iwel_kw  = ecl_file_iget_named_kw( rst_file , IWEL_KW   , 0);
+  const char * grid_name = grid_kw->grid_name;
 
-  //const int iwel_offset        = header->niwelz * well_nr;
-  //int seg_well_nr              = ecl_kw_iget_int( iwel_kw , iwel_offset + IWEL_SEGMENTED_WELL_NR_ITEM) - 1; // -1: Ordinary well.
+  if (grid_kw->icon_kw == NULL)
+    util_abort("%s: the restart block for grid:%s has no %s keyword\n",__func__ , grid_name , ICON_KW);
 
-  well_state_add_wellhead( well_state , header , iwel_kw , well_nr , grid_name , grid_nr );
+  well_state_add_wellhead( well_state , grid_kw->header , grid_kw->iwel_kw , well_nr , grid_name , grid_kw->grid_nr );
 
   if (!well_state_has_grid_connections( well_state , grid_name ))
     hash_insert_hash_owned_ref( well_state->connections , grid_name, well_conn_collection_alloc( ) , well_conn_collection_free__ );
 
   {
     well_conn_collection_type * wellcc = hash_get( well_state->connections , grid_name );
-    well_conn_collection_load_from_kw( wellcc , iwel_kw , icon_kw , well_nr , header );
+    well_conn_collection_load_from_kw( wellcc , grid_kw->iwel_kw , grid_kw->icon_kw , well_nr , grid_kw->header );
   }
-  ecl_rsthead_free( header );
-}
-
-
-static void well_state_add_global_connections( well_state_type * well_state ,
-                                               const ecl_file_type * rst_file ,
-                                               int well_nr ) {
-  well_state_add_connections__( well_state , rst_file , ECL_GRID_GLOBAL_GRID , 0 , well_nr );
-}
-
-static void well_state_add_LGR_connections( well_state_type * well_state , const ecl_grid_type * grid , ecl_file_type * ecl_file, int global_well_nr ) {
-  // Go through all the LGRs and add connections; both in the bulk
-  // grid and as wellhead.
-  int num_lgr = ecl_grid_get_num_lgr( grid );
-  int lgr_index;
-  for (lgr_index = 0; lgr_index < num_lgr; lgr_index++) {
-    ecl_file_push_block( ecl_file );                                  // <-------------------------//
-    {                                                                                              //
-      ecl_file_subselect_block( ecl_file , LGR_KW , lgr_index );                                      //
-      {                                                                                            //  Restrict the file view
-        const char * grid_name = ecl_grid_iget_lgr_name( grid , lgr_index );                          //
-        int well_nr = well_state_get_lgr_well_nr( well_state , ecl_file );                         //  to one LGR block.
-        if (well_nr >= 0)                                                                          //
-          well_state_add_connections__( well_state , ecl_file , grid_name , lgr_index + 1, well_nr ); //
-      }                                                                                            //
-    }                                                                                              //
-    ecl_file_pop_block( ecl_file );                                   // <-------------------------//
+}
+
+
+/*
+  Go through all the grids in the block and add connections; both in
+  the bulk grid and as wellhead.
+*/
+
+static void well_state_add_block_connections( well_state_type * well_state , const well_state_block_type * block , int global_well_nr) {
+  int grid_nr;
+  for (grid_nr = 0; grid_nr < vector_get_size( block->grids ); grid_nr++) {
+    const well_grid_kw_type * grid_kw = vector_iget_const( block->grids , grid_nr );
+    if (grid_kw != NULL) {
+      int well_nr = well_grid_kw_get_well_nr( grid_kw , well_state->name , global_well_nr );
+      if (well_nr >= 0)
+        well_state_add_connections__( well_state , grid_kw , well_nr );
+    }
   }
 }
 
@@ -359,9 +462,34 @@ void well_state_add_connections( well_state_type * well_state ,
                                  ecl_file_type * rst_file ,  // Either an open .Xnnnn file or UNRST file restricted to one report step
                                  int well_nr) {
 
-  well_state_add_global_connections( well_state , rst_file , well_nr );
-  well_state_add_LGR_connections( well_state , grid , rst_file , well_nr );
+  well_state_block_type * block = well_state_block_alloc( rst_file , grid );
+  well_state_add_block_connections( well_state , block , well_nr );
+  well_state_block_free( block );
+}
+
+
+static void well_state_add_MSW__( well_state_type * well_state ,
+                                  const well_grid_kw_type * global_kw ,
+                                  int well_nr) {
 
+  int segments = well_segment_collection_load_from_kw( well_state->segments ,
+                                                       well_nr ,
+                                                       global_kw->iwel_kw ,
+                                                       global_kw->iseg_kw ,
+                                                       global_kw->rseg_kw ,
+                                                       global_kw->header);
+
+  if (segments) {
+    hash_iter_type * grid_iter = hash_iter_alloc( well_state->connections );
+    while (!hash_iter_is_complete( grid_iter )) {
+      const char * grid_name = hash_iter_get_next_key( grid_iter );
+      const well_conn_collection_type * connections = hash_get( well_state->connections , grid_name );
+      well_segment_collection_add_connections( well_state->segments , grid_name , connections );
+    }
+    hash_iter_free( grid_iter );
+    well_segment_collection_link( well_state->segments );
+    well_segment_collection_add_branches( well_state->segments , well_state->branches );
+  }
 }
 
 
@@ -370,43 +498,9 @@ bool well_state_add_MSW( well_state_type * well_state ,
                          int well_nr) {
 
   if (ecl_file_has_kw( rst_file , ISEG_KW)) {
-    ecl_rsthead_type  * rst_head  = ecl_rsthead_alloc( rst_file );
-    const ecl_kw_type * iwel_kw = ecl_file_iget_named_kw( rst_file , IWEL_KW , 0);
-    const ecl_kw_type * iseg_kw = ecl_file_iget_named_kw( rst_file , ISEG_KW , 0);
-    ecl_kw_type * rseg_kw = NULL;
-    
-    int segments;
-
-    if (ecl_file_has_kw( rst_file , RSEG_KW )) 
-      /* 
-         Here we check that the file has the RSEG_KW keyword, and pass
-         NULL if not. The rseg_kw pointer will later be used in
-         well_segment_collection_load_from_kw() where we test if this
-         is a MSW well. If this indeed is a MSW well the rseg_kw
-         pointer will be used unchecked, if it is then NULL => Crash
-         and burn.
-      */
-      rseg_kw = ecl_file_iget_named_kw( rst_file , RSEG_KW , 0);
-
-    segments = well_segment_collection_load_from_kw( well_state->segments ,
-                                                     well_nr ,
-                                                     iwel_kw ,
-                                                     iseg_kw ,
-                                                     rseg_kw ,
-                                                     rst_head);
-
-    if (segments) {
-      hash_iter_type * grid_iter = hash_iter_alloc( well_state->connections );
-      while (!hash_iter_is_complete( grid_iter )) {
-        const char * grid_name = hash_iter_get_next_key( grid_iter );
-        const well_conn_collection_type * connections = hash_get( well_state->connections , grid_name );
-        well_segment_collection_add_connections( well_state->segments , grid_name , connections );
-      }
-      hash_iter_free( grid_iter );
-      well_segment_collection_link( well_state->segments );
-      well_segment_collection_add_branches( well_state->segments , well_state->branches );
-    }
-    ecl_rsthead_free( rst_head );
+    well_grid_kw_type * global_kw = well_grid_kw_alloc( rst_file , ECL_GRID_GLOBAL_GRID , 0 );
+    well_state_add_MSW__( well_state , global_kw , well_nr );
+    well_grid_kw_free( global_kw );
     return true;
   } else
     return false;
@@ -421,12 +515,13 @@ bool well_state_is_MSW( const well_state_type * well_state) {
 }
 
 
-well_state_type * well_state_alloc_from_file( ecl_file_type * ecl_file , const ecl_grid_type * grid , int report_nr ,  int global_well_nr) {
-  if (ecl_file_has_kw( ecl_file , IWEL_KW)) {
+well_state_type * well_state_alloc_from_block( const well_state_block_type * block , int report_nr , int global_well_nr) {
+  const well_grid_kw_type * global_kw = vector_safe_iget_const( block->grids , 0 );
+  if (global_kw != NULL) {
     well_state_type   * well_state = NULL;
-    ecl_rsthead_type  * global_header  = ecl_rsthead_alloc( ecl_file );
-    const ecl_kw_type * global_iwel_kw = ecl_file_iget_named_kw( ecl_file , IWEL_KW   , 0);
-    const ecl_kw_type * global_zwel_kw = ecl_file_iget_named_kw( ecl_file , ZWEL_KW   , 0);
+    const ecl_rsthead_type * global_header = global_kw->header;
+    const ecl_kw_type * global_iwel_kw = global_kw->iwel_kw;
+    const ecl_kw_type * global_zwel_kw = global_kw->zwel_kw;
 
     const int iwel_offset = global_header->niwelz * global_well_nr;
     {
@@ -454,11 +549,10 @@ well_state_type * well_state_alloc_from_file( ecl_file_type * ecl_file , const e
       well_state = well_state_alloc(name , global_well_nr , open , type , report_nr , global_header->sim_time);
       free( name );
 
-      well_state_add_connections( well_state , grid , ecl_file , global_well_nr);
-      if (ecl_file_has_kw( ecl_file , ISEG_KW))
-        well_state_add_MSW( well_state , ecl_file , global_well_nr );
+      well_state_add_block_connections( well_state , block , global_well_nr);
+      if (global_kw->iseg_kw != NULL)
+        well_state_add_MSW__( well_state , global_kw , global_well_nr );
     }
-    ecl_rsthead_free( global_header );
     return well_state;
   } else
     /* This seems a bit weird - have come over E300 restart files without the IWEL keyword. */
@@ -466,6 +560,18 @@ well_state_type * well_state_alloc_from_file( ecl_file_type * ecl_file , const e
 }
 
 
+/*
+  When several wells are loaded from the same report step it is much
+  faster to create one well_state_block instance and use
+  well_state_alloc_from_block() for all the wells.
+*/
+
+well_state_type * well_state_alloc_from_file( ecl_file_type * ecl_file , const ecl_grid_type * grid , int report_nr ,  int global_well_nr) {
+  well_state_block_type * block = well_state_block_alloc( ecl_file , grid );
+  well_state_type * well_state = well_state_alloc_from_block( block , report_nr , global_well_nr );
+  well_state_block_free( block );
+  return well_state;
+}
 
 
 
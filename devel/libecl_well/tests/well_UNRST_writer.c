@@ -0,0 +1,157 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'well_UNRST_writer.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/fortio.h>
+
+#include <ert/ecl_well/well_const.h>
+
+#include "well_UNRST_writer.h"
+
+/*
+  Small writer for the well tests and the well_info_bench program:
+  holds the keywords of one report step in a unified restart file,
+  i.e. the restart header and the IWEL, ZWEL and ICON keywords needed
+  by the well code. All the wells and connections are initialized to
+  zero; the calling scope sets them with the set functions and writes
+  the block with well_UNRST_block_fwrite(). The same block can be
+  written several times with a new date.
+*/
+
+struct well_UNRST_block_struct {
+  int           niwelz;
+  int           nzwelz;
+  int           niconz;
+  int           ncwmax;
+  ecl_kw_type * seqnum_kw;
+  ecl_kw_type * intehead_kw;
+  ecl_kw_type * logihead_kw;
+  ecl_kw_type * doubhead_kw;
+  ecl_kw_type * iwel_kw;
+  ecl_kw_type * zwel_kw;
+  ecl_kw_type * icon_kw;
+};
+
+
+well_UNRST_block_type * well_UNRST_block_alloc( int nx , int ny , int nz , int nwells , int niwelz , int nzwelz , int niconz , int ncwmax ) {
+  well_UNRST_block_type * block = util_malloc( sizeof * block );
+  block->niwelz = niwelz;
+  block->nzwelz = nzwelz;
+  block->niconz = niconz;
+  block->ncwmax = ncwmax;
+
+  block->seqnum_kw   = ecl_kw_alloc( SEQNUM_KW   , 1 , ECL_INT_TYPE );
+  block->intehead_kw = ecl_kw_alloc( INTEHEAD_KW , 411 , ECL_INT_TYPE );
+  block->logihead_kw = ecl_kw_alloc( LOGIHEAD_KW , 121 , ECL_BOOL_TYPE );
+  block->doubhead_kw = ecl_kw_alloc( DOUBHEAD_KW , 229 , ECL_DOUBLE_TYPE );
+  block->iwel_kw     = ecl_kw_alloc( IWEL_KW , nwells * niwelz , ECL_INT_TYPE );
+  block->zwel_kw     = ecl_kw_alloc( ZWEL_KW , nwells * nzwelz , ECL_CHAR_TYPE );
+  block->icon_kw     = ecl_kw_alloc( ICON_KW , nwells * ncwmax * niconz , ECL_INT_TYPE );
+
+  ecl_kw_scalar_set_int( block->seqnum_kw , 0 );
+  ecl_kw_scalar_set_int( block->intehead_kw , 0 );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_NX_INDEX , nx );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_NY_INDEX , ny );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_NZ_INDEX , nz );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_NACTIVE_INDEX , nx * ny * nz );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_NWELLS_INDEX , nwells );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_NIWELZ_INDEX , niwelz );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_NZWELZ_INDEX , nzwelz );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_NICONZ_INDEX , niconz );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_NCWMAX_INDEX , ncwmax );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_IPROG_INDEX , 100 );
+  ecl_kw_scalar_set_bool( block->logihead_kw , false );
+  ecl_kw_scalar_set_double( block->doubhead_kw , 0 );
+  ecl_kw_scalar_set_int( block->iwel_kw , 0 );
+  ecl_kw_scalar_set_int( block->icon_kw , 0 );
+  {
+    int index;
+    for (index = 0; index < nwells * nzwelz; index++)
+      ecl_kw_iset_string8( block->zwel_kw , index , "" );
+  }
+  well_UNRST_block_set_date( block , 0 , 1 , 1 , 2000 , 0 );
+  return block;
+}
+
+
+void well_UNRST_block_free( well_UNRST_block_type * block ) {
+  ecl_kw_free( block->seqnum_kw );
+  ecl_kw_free( block->intehead_kw );
+  ecl_kw_free( block->logihead_kw );
+  ecl_kw_free( block->doubhead_kw );
+  ecl_kw_free( block->iwel_kw );
+  ecl_kw_free( block->zwel_kw );
+  ecl_kw_free( block->icon_kw );
+  free( block );
+}
+
+
+void well_UNRST_block_set_date( well_UNRST_block_type * block , int report_nr , int day , int month , int year , double sim_days ) {
+  ecl_kw_iset_int( block->seqnum_kw , 0 , report_nr );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_DAY_INDEX , day );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_MONTH_INDEX , month );
+  ecl_kw_iset_int( block->intehead_kw , INTEHEAD_YEAR_INDEX , year );
+  ecl_kw_iset_double( block->doubhead_kw , DOUBHEAD_DAYS_INDEX , sim_days );
+}
+
+
+/*
+  The head and connection coordinates are one-based, as in the file.
+*/
+
+void well_UNRST_block_set_well( well_UNRST_block_type * block , int well_nr , const char * name , int well_type , bool open ,
+                                int head_i , int head_j , int head_k , int num_conn ) {
+  int iwel_offset = well_nr * block->niwelz;
+
+  ecl_kw_iset_string8( block->zwel_kw , well_nr * block->nzwelz , name );
+  ecl_kw_iset_int( block->iwel_kw , iwel_offset + IWEL_HEADI_ITEM , head_i );
+  ecl_kw_iset_int( block->iwel_kw , iwel_offset + IWEL_HEADJ_ITEM , head_j );
+  ecl_kw_iset_int( block->iwel_kw , iwel_offset + IWEL_HEADK_ITEM , head_k );
+  ecl_kw_iset_int( block->iwel_kw , iwel_offset + IWEL_CONNECTIONS_ITEM , num_conn );
+  ecl_kw_iset_int( block->iwel_kw , iwel_offset + IWEL_TYPE_ITEM , well_type );
+  ecl_kw_iset_int( block->iwel_kw , iwel_offset + IWEL_STATUS_ITEM , open ? 1 : 0 );
+}
+
+
+void well_UNRST_block_set_conn( well_UNRST_block_type * block , int well_nr , int conn_nr , int ic ,
+                                int i , int j , int k , bool open , int dir ) {
+  int icon_offset = block->niconz * ( block->ncwmax * well_nr + conn_nr );
+
+  ecl_kw_iset_int( block->icon_kw , icon_offset + ICON_IC_ITEM , ic );
+  ecl_kw_iset_int( block->icon_kw , icon_offset + ICON_I_ITEM , i );
+  ecl_kw_iset_int( block->icon_kw , icon_offset + ICON_J_ITEM , j );
+  ecl_kw_iset_int( block->icon_kw , icon_offset + ICON_K_ITEM , k );
+  ecl_kw_iset_int( block->icon_kw , icon_offset + ICON_STATUS_ITEM , open ? 1 : 0 );
+  ecl_kw_iset_int( block->icon_kw , icon_offset + ICON_DIRECTION_ITEM , dir );
+}
+
+
+void well_UNRST_block_fwrite( const well_UNRST_block_type * block , fortio_type * fortio ) {
+  ecl_kw_fwrite( block->seqnum_kw , fortio );
+  ecl_kw_fwrite( block->intehead_kw , fortio );
+  ecl_kw_fwrite( block->logihead_kw , fortio );
+  ecl_kw_fwrite( block->doubhead_kw , fortio );
+  ecl_kw_fwrite( block->iwel_kw , fortio );
+  ecl_kw_fwrite( block->zwel_kw , fortio );
+  ecl_kw_fwrite( block->icon_kw , fortio );
+}
@@ -0,0 +1,44 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'well_UNRST_writer.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __WELL_UNRST_WRITER_H__
+#define __WELL_UNRST_WRITER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/ecl/fortio.h>
+
+  typedef struct well_UNRST_block_struct well_UNRST_block_type;
+
+  well_UNRST_block_type * well_UNRST_block_alloc( int nx , int ny , int nz , int nwells , int niwelz , int nzwelz , int niconz , int ncwmax );
+  void                    well_UNRST_block_free( well_UNRST_block_type * block );
+  void                    well_UNRST_block_set_date( well_UNRST_block_type * block , int report_nr , int day , int month , int year , double sim_days );
+  void                    well_UNRST_block_set_well( well_UNRST_block_type * block , int well_nr , const char * name , int well_type , bool open ,
+                                                     int head_i , int head_j , int head_k , int num_conn );
+  void                    well_UNRST_block_set_conn( well_UNRST_block_type * block , int well_nr , int conn_nr , int ic ,
+                                                     int i , int j , int k , bool open , int dir );
+  void                    well_UNRST_block_fwrite( const well_UNRST_block_type * block , fortio_type * fortio );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
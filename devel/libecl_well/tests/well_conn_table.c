@@ -0,0 +1,223 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'well_conn_table.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_endian_flip.h>
+#include <ert/ecl/fortio.h>
+
+#include <ert/ecl_well/well_const.h>
+#include <ert/ecl_well/well_conn.h>
+#include <ert/ecl_well/well_conn_collection.h>
+#include <ert/ecl_well/well_conn_table.h>
+#include <ert/ecl_well/well_state.h>
+#include <ert/ecl_well/well_info.h>
+#include <ert/ecl_well/well_ts.h>
+
+#include "well_UNRST_writer.h"
+
+#define NX          6
+#define NY          6
+#define NZ          4
+#define NIWELZ     50
+#define NZWELZ      3
+#define NICONZ     20
+#define NCWMAX      4
+#define NUM_BLOCKS 12
+
+
+/*
+  Writes a unified restart file where the wells are connected in
+  random cells; some of the connections are in the same cells, and
+  some are not in the grid at all (ICON_IC_ITEM == 0).
+*/
+
+static void write_UNRST( const char * filename ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  srand( 7 );
+  for (int report_nr = 0; report_nr < NUM_BLOCKS; report_nr++) {
+    int nwells = 2 + report_nr % 3;
+    well_UNRST_block_type * block = well_UNRST_block_alloc( NX , NY , NZ , nwells , NIWELZ , NZWELZ , NICONZ , NCWMAX );
+
+    well_UNRST_block_set_date( block , report_nr , 1 , 1 , 2000 + report_nr , 0 );
+    for (int well_nr = 0; well_nr < nwells; well_nr++) {
+      int num_conn = 1 + rand() % NCWMAX;
+      char * name = util_alloc_sprintf( "W%d" , well_nr );
+
+      well_UNRST_block_set_well( block , well_nr , name , IWEL_PRODUCER , true , 1 , 1 , 1 , num_conn );
+      free( name );
+
+      for (int conn_nr = 0; conn_nr < num_conn; conn_nr++) {
+        int ic   = ((rand() % 5) == 0) ? 0 : conn_nr + 1;
+        int i    = 1 + rand() % 3;
+        int j    = 1 + rand() % 3;
+        int k    = 1 + rand() % NZ;
+        bool open = rand() % 2;
+        int dir  = 1 + rand() % 3;
+
+        well_UNRST_block_set_conn( block , well_nr , conn_nr , ic , i , j , k , open , dir );
+      }
+    }
+
+    well_UNRST_block_fwrite( block , fortio );
+    well_UNRST_block_free( block );
+  }
+  fortio_fclose( fortio );
+}
+
+
+static bool row_equal( const well_conn_table_type * table , int row , const well_conn_type * conn ) {
+  return (well_conn_table_iget_i( table , row ) == well_conn_get_i( conn )) &&
+         (well_conn_table_iget_j( table , row ) == well_conn_get_j( conn )) &&
+         (well_conn_table_iget_k( table , row ) == well_conn_get_k( conn )) &&
+         (well_conn_table_iget_dir( table , row ) == well_conn_get_dir( conn )) &&
+         (well_conn_table_iget_segment( table , row ) == well_conn_get_segment( conn )) &&
+         (well_conn_table_iget_open( table , row ) == well_conn_open( conn )) &&
+         (well_conn_table_iget_matrix_connection( table , row ) == well_conn_matrix_connection( conn ));
+}
+
+
+/*
+  The well ranges of the table must correspond to the connections of
+  the well_state instances in the well_info structure.
+*/
+
+void test_well_ranges( const well_conn_table_type * table , const well_info_type * well_info ) {
+  int total = 0;
+
+  test_assert_int_equal( well_info_get_num_wells( well_info ) , well_conn_table_get_num_wells( table ));
+  for (int iw = 0; iw < well_info_get_num_wells( well_info ); iw++) {
+    const char * well_name = well_info_iget_well_name( well_info , iw );
+    well_ts_type * well_ts = well_info_get_ts( well_info , well_name );
+    int range_nr = 0;
+
+    test_assert_true( well_conn_table_has_well( table , well_name ));
+    for (int ts = 0; ts < well_ts_get_size( well_ts ); ts++) {
+      const well_state_type * well_state = well_ts_iget_state( well_ts , ts );
+      const well_conn_collection_type * connections = well_state_get_global_connections( well_state );
+      int num_conn = well_conn_collection_get_size( connections );
+
+      if (num_conn > 0) {
+        int begin = well_conn_table_iget_well_range_begin( table , well_name , range_nr );
+        int end   = well_conn_table_iget_well_range_end( table , well_name , range_nr );
+
+        test_assert_int_equal( num_conn , end - begin );
+        for (int ic = 0; ic < num_conn; ic++) {
+          int row = begin + ic;
+          test_assert_int_equal( well_state_get_report_nr( well_state ) , well_conn_table_iget_report( table , row ));
+          test_assert_string_equal( well_name , well_conn_table_iget_well_name( table , well_conn_table_iget_well_index( table , row )));
+          test_assert_int_equal( 0 , well_conn_table_iget_grid_nr( table , row ));
+          test_assert_true( row_equal( table , row , well_conn_collection_iget_const( connections , ic )));
+        }
+        total += num_conn;
+        range_nr++;
+      }
+    }
+    test_assert_int_equal( range_nr , well_conn_table_get_num_well_ranges( table , well_name ));
+  }
+  test_assert_int_equal( total , well_conn_table_get_size( table ));
+  test_assert_int_equal( 0 , well_conn_table_get_num_well_ranges( table , "NO_SUCH_WELL" ));
+}
+
+
+void test_cells( well_conn_table_type * table , const ecl_grid_type * grid ) {
+  int_vector_type * rows  = int_vector_alloc( 0 , 0 );
+  int_vector_type * cells = int_vector_alloc( 0 , 0 );
+  int num_cells = 0;
+  int num_rows  = 0;
+
+  well_conn_table_get_cells( table , 0 , cells );
+  for (int k = 0; k < NZ; k++) {
+    for (int j = 0; j < NY; j++) {
+      for (int i = 0; i < NX; i++) {
+        int global_index = ecl_grid_get_global_index3( grid , i , j , k );
+        int_vector_type * expected = int_vector_alloc( 0 , 0 );
+
+        for (int row = 0; row < well_conn_table_get_size( table ); row++) {
+          if ((well_conn_table_iget_i( table , row ) == i) &&
+              (well_conn_table_iget_j( table , row ) == j) &&
+              (well_conn_table_iget_k( table , row ) == k)) {
+            test_assert_int_equal( global_index , well_conn_table_iget_global_index( table , row ));
+            int_vector_append( expected , row );
+          }
+        }
+
+        test_assert_int_equal( int_vector_size( expected ) , well_conn_table_get_cell_rows( table , 0 , i , j , k , rows ));
+        test_assert_true( int_vector_equal( expected , rows ));
+        if (int_vector_size( expected ) > 0) {
+          test_assert_int_equal( global_index , int_vector_iget( cells , num_cells ));
+          num_cells++;
+        }
+        num_rows += int_vector_size( expected );
+        int_vector_free( expected );
+      }
+    }
+  }
+  test_assert_int_equal( num_cells , int_vector_size( cells ));
+  test_assert_int_equal( num_rows , well_conn_table_get_size( table ));
+
+  int_vector_free( cells );
+  int_vector_free( rows );
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "well_conn_table" , false );
+  ecl_grid_type * grid = ecl_grid_alloc_rectangular( NX , NY , NZ , 1 , 1 , 1 , NULL );
+
+  write_UNRST( "CASE.UNRST" );
+  {
+    well_conn_table_type * table = well_conn_table_alloc( grid );
+    well_info_type * well_info = well_info_alloc( grid );
+
+    test_assert_true( well_conn_table_is_instance( table ));
+    test_assert_int_equal( 0 , well_conn_table_get_size( table ));
+    {
+      int_vector_type * rows = int_vector_alloc( 0 , 0 );
+      test_assert_int_equal( 0 , well_conn_table_get_cell_rows( table , 0 , 1 , 1 , 1 , rows ));
+      int_vector_free( rows );
+    }
+
+    well_conn_table_load_rstfile( table , "CASE.UNRST" );
+    well_info_load_rstfile( well_info , "CASE.UNRST" );
+    test_assert_true( well_conn_table_get_size( table ) > 0 );
+    test_well_ranges( table , well_info );
+    test_cells( table , grid );
+
+    /* The cell index is updated when more rows are added. */
+    {
+      int size = well_conn_table_get_size( table );
+      well_conn_table_load_rstfile( table , "CASE.UNRST" );
+      test_assert_int_equal( 2 * size , well_conn_table_get_size( table ));
+      test_cells( table , grid );
+    }
+
+    well_info_free( well_info );
+    well_conn_table_free( table );
+  }
+
+  ecl_grid_free( grid );
+  test_work_area_free( work_area );
+  exit(0);
+}
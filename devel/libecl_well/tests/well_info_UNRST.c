@@ -0,0 +1,222 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'well_info_UNRST.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_endian_flip.h>
+#include <ert/ecl/fortio.h>
+
+#include <ert/ecl_well/well_const.h>
+#include <ert/ecl_well/well_conn.h>
+#include <ert/ecl_well/well_conn_collection.h>
+#include <ert/ecl_well/well_state.h>
+#include <ert/ecl_well/well_info.h>
+#include <ert/ecl_well/well_ts.h>
+
+#include "well_UNRST_writer.h"
+
+#define NX      10
+#define NY      10
+#define NZ       5
+#define NIWELZ  50
+#define NZWELZ   3
+#define NICONZ  20
+#define NCWMAX   5
+
+
+/*
+  Writes a unified restart file with the keywords needed by the well
+  code; the number of wells and the connections vary between the
+  report steps.
+*/
+
+static void write_block( fortio_type * fortio , int report_nr ) {
+  int nwells = 3 + report_nr % 4;
+  well_UNRST_block_type * block = well_UNRST_block_alloc( NX , NY , NZ , nwells , NIWELZ , NZWELZ , NICONZ , NCWMAX );
+
+  well_UNRST_block_set_date( block , report_nr , 1 + report_nr % 28 , 1 , 2000 + report_nr , 365.0 * report_nr );
+  for (int well_nr = 0; well_nr < nwells; well_nr++) {
+    int num_conn = 1 + (well_nr + report_nr) % NCWMAX;
+    {
+      char * name = util_alloc_sprintf( "W%d" , well_nr );
+      well_UNRST_block_set_well( block , well_nr , name ,
+                                 (well_nr % 2) ? IWEL_WATER_INJECTOR : IWEL_PRODUCER ,
+                                 ((well_nr + report_nr) % 3) != 0 ,
+                                 1 + well_nr , 1 + report_nr % NY , 1 , num_conn );
+      free( name );
+    }
+
+    for (int conn_nr = 0; conn_nr < num_conn; conn_nr++)
+      well_UNRST_block_set_conn( block , well_nr , conn_nr , conn_nr + 1 ,
+                                 1 + well_nr , 1 + report_nr % NY , 1 + conn_nr ,
+                                 (conn_nr % 2) == 0 , ICON_DIRZ );
+  }
+
+  well_UNRST_block_fwrite( block , fortio );
+  well_UNRST_block_free( block );
+}
+
+
+static void write_UNRST( const char * filename , int first_report , int num_blocks ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  for (int report_nr = first_report; report_nr < first_report + num_blocks; report_nr++)
+    write_block( fortio , report_nr );
+  fortio_fclose( fortio );
+}
+
+
+static void test_equal_state( const well_state_type * state1 , const well_state_type * state2 ) {
+  test_assert_string_equal( well_state_get_name( state1 ) , well_state_get_name( state2 ));
+  test_assert_int_equal( well_state_get_report_nr( state1 ) , well_state_get_report_nr( state2 ));
+  test_assert_time_t_equal( well_state_get_sim_time( state1 ) , well_state_get_sim_time( state2 ));
+  test_assert_int_equal( well_state_get_well_nr( state1 ) , well_state_get_well_nr( state2 ));
+  test_assert_bool_equal( well_state_is_open( state1 ) , well_state_is_open( state2 ));
+  test_assert_int_equal( well_state_get_type( state1 ) , well_state_get_type( state2 ));
+  test_assert_bool_equal( well_state_is_MSW( state1 ) , well_state_is_MSW( state2 ));
+  {
+    const well_conn_type * head1 = well_state_iget_wellhead( state1 , 0 );
+    const well_conn_type * head2 = well_state_iget_wellhead( state2 , 0 );
+    test_assert_true( well_conn_equal( head1 , head2 ));
+  }
+  {
+    const well_conn_collection_type * conn1 = well_state_get_global_connections( state1 );
+    const well_conn_collection_type * conn2 = well_state_get_global_connections( state2 );
+    test_assert_int_equal( well_conn_collection_get_size( conn1 ) , well_conn_collection_get_size( conn2 ));
+    for (int i = 0; i < well_conn_collection_get_size( conn1 ); i++)
+      test_assert_true( well_conn_equal( well_conn_collection_iget_const( conn1 , i ) , well_conn_collection_iget_const( conn2 , i )));
+  }
+}
+
+
+/*
+  Compares the well_info instance with well_state instances created
+  one by one from the restart file with well_state_alloc_from_file().
+*/
+
+static void test_well_info( const char * filename , const ecl_grid_type * grid , const well_info_type * well_info , int num_blocks ) {
+  ecl_file_type * rst_file = ecl_file_open( filename , 0 );
+  int * ts_index = util_calloc( well_info_get_num_wells( well_info ) , sizeof * ts_index );
+  int num_states = 0;
+
+  test_assert_int_equal( 3 + util_int_min( num_blocks - 1 , 3 ) , well_info_get_num_wells( well_info ));
+  for (int iw = 0; iw < well_info_get_num_wells( well_info ); iw++) {
+    ts_index[iw] = 0;
+    num_states += well_ts_get_size( well_info_get_ts( well_info , well_info_iget_well_name( well_info , iw )));
+  }
+
+  for (int block_nr = 0; block_nr < num_blocks; block_nr++) {
+    ecl_file_push_block( rst_file );
+    ecl_file_subselect_block( rst_file , SEQNUM_KW , block_nr );
+    {
+      int nwells = 3 + block_nr % 4;
+      for (int well_nr = 0; well_nr < nwells; well_nr++) {
+        well_state_type * state = well_state_alloc_from_file( rst_file , grid , block_nr , well_nr );
+        const well_state_type * loaded = well_info_iiget_state( well_info , well_nr , ts_index[well_nr] );
+
+        test_equal_state( state , loaded );
+        ts_index[well_nr]++;
+        num_states--;
+        well_state_free( state );
+      }
+    }
+    ecl_file_pop_block( rst_file );
+  }
+  test_assert_int_equal( 0 , num_states );
+
+  free( ts_index );
+  ecl_file_close( rst_file );
+}
+
+
+void test_load( const ecl_grid_type * grid , int num_blocks ) {
+  write_UNRST( "CASE.UNRST" , 0 , num_blocks );
+  for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
+    well_info_type * well_info = well_info_alloc( grid );
+    well_info_set_num_threads( well_info , num_threads );
+    test_assert_int_equal( num_threads , well_info_get_num_threads( well_info ));
+    well_info_load_rstfile( well_info , "CASE.UNRST" );
+    test_well_info( "CASE.UNRST" , grid , well_info , num_blocks );
+    well_info_free( well_info );
+  }
+
+  /* An existing ecl_file instance restricted to one report step. */
+  {
+    well_info_type * well_info = well_info_alloc( grid );
+    ecl_file_type * rst_file = ecl_file_open( "CASE.UNRST" , 0 );
+
+    ecl_file_select_block( rst_file , SEQNUM_KW , num_blocks - 1 );
+    well_info_add_UNRST_wells( well_info , rst_file );
+    test_assert_int_equal( 3 + (num_blocks - 1) % 4 , well_info_get_num_wells( well_info ));
+    test_assert_int_equal( 1 , well_ts_get_size( well_info_get_ts( well_info , "W0" )));
+    test_assert_int_equal( num_blocks - 1 , well_state_get_report_nr( well_info_iiget_state( well_info , 0 , 0 )));
+
+    ecl_file_close( rst_file );
+    well_info_free( well_info );
+  }
+}
+
+
+/*
+  The file is rewritten with other report numbers, but the same
+  layout, after the SEQNUM keywords have been loaded by the ecl_file
+  instance; the loader threads reopening the file must detect that
+  the report numbers do not match, and fall back to loading the
+  blocks from the ecl_file instance.
+*/
+
+void test_rewritten( const ecl_grid_type * grid , int num_blocks ) {
+  write_UNRST( "CASE.UNRST" , 0 , num_blocks );
+  {
+    well_info_type * well_info = well_info_alloc( grid );
+    ecl_file_type * rst_file = ecl_file_open( "CASE.UNRST" , 0 );
+
+    for (int block_nr = 0; block_nr < num_blocks; block_nr++)
+      ecl_file_iget_named_kw( rst_file , SEQNUM_KW , block_nr );
+    write_UNRST( "CASE.UNRST" , 20 , num_blocks );
+
+    well_info_set_num_threads( well_info , 4 );
+    well_info_add_UNRST_wells( well_info , rst_file );
+    for (int index = 0; index < well_ts_get_size( well_info_get_ts( well_info , "W0" )); index++)
+      test_assert_int_equal( index , well_state_get_report_nr( well_info_iiget_state( well_info , 0 , index )));
+    test_assert_int_equal( num_blocks , well_ts_get_size( well_info_get_ts( well_info , "W0" )));
+
+    ecl_file_close( rst_file );
+    well_info_free( well_info );
+  }
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "well_info_UNRST" , false );
+  ecl_grid_type * grid = ecl_grid_alloc_rectangular( NX , NY , NZ , 1 , 1 , 1 , NULL );
+
+  test_load( grid , 3 );
+  test_load( grid , 50 );
+  test_rewritten( grid , 50 );
+
+  ecl_grid_free( grid );
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -45,6 +45,7 @@ static void enkf_tui_ranking_make_misfit_ensemble( void * arg) {
     
   misfit_ensemble_type * misfit_ensemble = enkf_fs_get_misfit_ensemble( fs );
   misfit_ensemble_update( misfit_ensemble , ensemble_config , enkf_obs , fs , ens_size , history_length );
+  enkf_fs_fwrite_misfit( fs );
   {
     menu_item_type * obs_item                    = arg_pack_iget_ptr( arg_pack , 1 ); 
     menu_item_enable( obs_item );
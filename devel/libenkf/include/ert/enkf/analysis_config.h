@@ -89,6 +89,8 @@ void                   analysis_config_set_update_results(analysis_config_type *
 bool                   analysis_config_get_update_results(const analysis_config_type * config);
 void                   analysis_config_set_single_node_update(analysis_config_type * config , bool single_node_update);
 bool                   analysis_config_get_single_node_update(const analysis_config_type * config);
+void                   analysis_config_set_packed_parameters(analysis_config_type * config , bool packed_parameters);
+bool                   analysis_config_get_packed_parameters(const analysis_config_type * config);
 
 void                   analysis_config_set_store_PC( analysis_config_type * config , bool store_PC);
 bool                   analysis_config_get_store_PC( const analysis_config_type * config );
@@ -100,6 +100,7 @@ extern "C" {
 #define  LICENSE_PATH_KEY                  "LICENSE_PATH"
 #define  LOAD_SEED_KEY                     "LOAD_SEED"  
 #define  LOCAL_CONFIG_KEY                  "LOCAL_CONFIG"
+#define  LINK_RUNPATH_FILES_KEY            "LINK_RUNPATH_FILES"
 #define  LOG_FILE_KEY                      "LOG_FILE"
 #define  LOG_LEVEL_KEY                     "LOG_LEVEL"
 #define  LSF_QUEUE_KEY                     "LSF_QUEUE"
@@ -111,6 +112,7 @@ extern "C" {
 #define  MAX_RUNNING_LSF_KEY               "MAX_RUNNING_LSF"
 #define  MAX_RUNNING_RSH_KEY               "MAX_RUNNING_RSH"
 #define  MAX_SUBMIT_KEY                    "MAX_SUBMIT" 
+#define  COLLECT_JOB_RESOURCES_KEY         "COLLECT_JOB_RESOURCES"
 #define  NUM_REALIZATIONS_KEY              "NUM_REALIZATIONS"      
 #define  MIN_REALIZATIONS_KEY              "MIN_REALIZATIONS" 
 #define  OBS_CONFIG_KEY                    "OBS_CONFIG"
@@ -142,6 +144,8 @@ extern "C" {
 #define  RSH_COMMAND_KEY                   "RSH_COMMAND"
 #define  RSH_HOST_KEY                      "RSH_HOST"
 #define  RUNPATH_FILE_KEY                  "RUNPATH_FILE"  
+#define  RUNPATH_MAX_WAITING_KEY           "RUNPATH_MAX_WAITING"
+#define  RUNPATH_THREADS_KEY               "RUNPATH_THREADS"
 #define  RUNPATH_KEY                       "RUNPATH"
 #define  ITER_RUNPATH_KEY                  "ITER_RUNPATH"
 #define  RERUN_PATH_KEY                    "RERUN_PATH"
@@ -158,11 +162,13 @@ extern "C" {
 #define  STATIC_KW_KEY                     "ADD_STATIC_KW"
 #define  STD_CUTOFF_KEY                    "STD_CUTOFF"
 #define  SUMMARY_KEY                       "SUMMARY"  
+#define  SUMMARY_LOAD_INTERVAL_KEY         "SUMMARY_LOAD_INTERVAL"
 #define  SURFACE_KEY                       "SURFACE"
 #define  UPDATE_LOG_PATH_KEY               "UPDATE_LOG_PATH"
 #define  UPDATE_PATH_KEY                   "UPDATE_PATH"
 #define  UPDATE_RESULTS_KEY                "UPDATE_RESULTS"
 #define  SINGLE_NODE_UPDATE_KEY            "SINGLE_NODE_UPDATE"
+#define  PACKED_PARAMETERS_KEY             "PACKED_PARAMETERS"
 #define  STORE_SEED_KEY                    "STORE_SEED"
 #define  UMASK_KEY                         "UMASK"   
 #define  WORKFLOW_JOB_DIRECTORY_KEY        "WORKFLOW_JOB_DIRECTORY"
@@ -76,6 +76,7 @@ extern "C" {
   const char          * ecl_config_get_eclbase( const ecl_config_type * ecl_config );
   const char          * ecl_config_get_schedule_file( const ecl_config_type * ecl_config );
   void                  ecl_config_set_schedule_file( ecl_config_type * ecl_config , const char * schedule_file );
+  void                  ecl_config_set_schedule_cache_path( ecl_config_type * ecl_config , const char * cache_path );
   bool                  ecl_config_load_refcase( ecl_config_type * ecl_config , const char * refcase);
   const char          * ecl_config_get_refcase_name( const ecl_config_type * ecl_config);
   void                  ecl_config_clear_static_kw( ecl_config_type * ecl_config );
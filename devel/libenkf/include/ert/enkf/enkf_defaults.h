@@ -83,6 +83,7 @@
 
 
 #define DEFAULT_MAX_SUBMIT           2        /* The number of times to resubmit - default value for config item: MAX_SUBMIT */
+#define DEFAULT_COLLECT_JOB_RESOURCES false   /* Collect the resources used by the forward model jobs - default value for config item: COLLECT_JOB_RESOURCES */
 #define DEFAULT_MAX_INTERNAL_SUBMIT  1        /** Attached to keyword : MAX_RETRY */
 
 
@@ -115,6 +116,7 @@
 #define DEFAULT_ENKF_FORCE_NCOMP        false
 #define DEFAULT_UPDATE_RESULTS          false
 #define DEFAULT_SINGLE_NODE_UPDATE      true
+#define DEFAULT_PACKED_PARAMETERS       false
 #define DEFAULT_ANALYSIS_MODULE         "STD_ENKF"
 #define DEFAULT_ANALYSIS_NUM_ITERATIONS 4
 #define DEFAULT_ANALYSIS_ITER_CASE      "ITERATED_ENSEMBLE_SMOOTHER%d"
@@ -133,6 +135,10 @@
 #define DEFAULT_REPORT_TIMEOUT   120
 
 #define DEFAULT_PRE_CLEAR_RUNPATH   false
+#define DEFAULT_LINK_RUNPATH_FILES  false   /* Hardlink identical files in the runpath directories instead of copying them. */
+#define DEFAULT_RUNPATH_THREADS     4       /* Number of threads creating runpath directories and submitting the realisations. */
+#define DEFAULT_RUNPATH_MAX_WAITING 0       /* Max number of prepared realisations waiting in the queue; 0: no limit. */
+#define DEFAULT_SUMMARY_LOAD_INTERVAL 0     /* Seconds between loading the summary results of running simulations; 0: load when complete. */
 
 #define DEFAULT_PLOT_WIDTH           1024
 #define DEFAULT_PLOT_HEIGHT           768
@@ -28,6 +28,11 @@ extern "C" {
 #include <ert/util/type_macros.h>
 #include <ert/util/buffer.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/matrix.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/vector.h>
+
+#include <ert/job_queue/job_resource.h>
 
 #include <ert/enkf/fs_driver.h>
 #include <ert/enkf/enkf_types.h>
@@ -37,6 +42,7 @@ extern "C" {
 #include <ert/enkf/cases_config.h>
 #include <ert/enkf/state_map.h>
 #include <ert/enkf/misfit_ensemble_typedef.h>
+#include <ert/enkf/active_list.h>
   
   const      char * enkf_fs_get_mount_point( const enkf_fs_type * fs );
   const      char * enkf_fs_get_root_path( const enkf_fs_type * fs );
@@ -95,10 +101,27 @@ extern "C" {
   FILE             * enkf_fs_open_excase_tstep_file( const enkf_fs_type * fs , const char * input_name , int tstep );
   FILE             * enkf_fs_open_excase_member_file( const enkf_fs_type * fs , const char * input_name , int iens );
 
+  char             * enkf_fs_alloc_packed_parameter_filename( const enkf_fs_type * fs , const char * node_key , int report_step);
+  bool               enkf_fs_has_packed_parameters( const enkf_fs_type * fs );
+  void               enkf_fs_fwrite_packed_parameter( enkf_fs_type * fs , const char * node_key , int report_step , 
+                                                      const matrix_type * A , int row_offset , int data_size , 
+                                                      const int_vector_type * iens_active_index , bool float_data);
+  bool               enkf_fs_fread_packed_parameter( enkf_fs_type * fs , const char * node_key , int report_step , state_enum state ,
+                                                     const active_list_type * active_list , int data_size , 
+                                                     matrix_type * A , int row_offset , const int_vector_type * iens_active_index);
+  bool               enkf_fs_fread_packed_member( enkf_fs_type * fs , const char * node_key , int report_step , state_enum state ,
+                                                  int iens , int data_size , double * data);
+
+  void               enkf_fs_fwrite_job_resources( const enkf_fs_type * fs , int step , const vector_type * resource_list );
+  bool               enkf_fs_fread_job_resource( const enkf_fs_type * fs , int step , int iens , job_resource_type * resource );
+  job_resource_type * enkf_fs_alloc_job_resource_summary( const enkf_fs_type * fs , int step );
+
   state_map_type       * enkf_fs_get_state_map( const enkf_fs_type * fs );
   time_map_type        * enkf_fs_get_time_map( const enkf_fs_type * fs );
   cases_config_type    * enkf_fs_get_cases_config( const enkf_fs_type * fs);
   misfit_ensemble_type * enkf_fs_get_misfit_ensemble( const enkf_fs_type * fs );
+  void                   enkf_fs_fwrite_misfit( enkf_fs_type * fs );
+  long                   enkf_fs_get_member_data_stamp( enkf_fs_type * fs , int iens );
 
   UTIL_SAFE_CAST_HEADER( enkf_fs );
   UTIL_IS_INSTANCE_HEADER( enkf_fs );
@@ -79,6 +79,12 @@ extern "C" {
   const char                  * enkf_main_get_rft_config_file( const enkf_main_type * enkf_main );
   bool                          enkf_main_get_pre_clear_runpath( const enkf_main_type * enkf_main );
   void                          enkf_main_set_pre_clear_runpath( enkf_main_type * enkf_main , bool pre_clear_runpath);
+  void                          enkf_main_set_runpath_threads( enkf_main_type * enkf_main , int runpath_threads );
+  int                           enkf_main_get_runpath_threads( const enkf_main_type * enkf_main );
+  void                          enkf_main_set_runpath_max_waiting( enkf_main_type * enkf_main , int max_waiting );
+  int                           enkf_main_get_runpath_max_waiting( const enkf_main_type * enkf_main );
+  void                          enkf_main_set_summary_load_interval( enkf_main_type * enkf_main , int interval );
+  int                           enkf_main_get_summary_load_interval( const enkf_main_type * enkf_main );
   bool                          enkf_main_set_refcase( enkf_main_type * enkf_main , const char * refcase_path);
   
   ert_report_list_type        * enkf_main_get_report_list( const enkf_main_type * enkf_main );
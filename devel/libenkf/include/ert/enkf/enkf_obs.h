@@ -46,6 +46,8 @@ extern "C" {
   enkf_obs_type * enkf_obs_alloc(  );
   
   void            enkf_obs_free(  enkf_obs_type * enkf_obs);
+  void            enkf_obs_set_num_threads( enkf_obs_type * enkf_obs , int num_threads);
+  int             enkf_obs_get_num_threads( const enkf_obs_type * enkf_obs );
   
   obs_vector_type * enkf_obs_get_vector(const enkf_obs_type * , const char * );
   void enkf_obs_add_obs_vector(enkf_obs_type * enkf_obs, const char * key, const obs_vector_type * vector);
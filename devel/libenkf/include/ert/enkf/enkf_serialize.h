@@ -26,6 +26,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include <ert/util/matrix.h>
+#include <ert/util/fmatrix.h>
 
 #include <ert/ecl/ecl_util.h>
 
@@ -52,6 +53,22 @@ void enkf_matrix_deserialize(void * __node_data                 ,
                              int column);
 
 
+void enkf_fmatrix_serialize(const float * node_data                 ,
+                            int node_size                           ,
+                            const active_list_type * __active_list  ,
+                            fmatrix_type * A                        ,
+                            int row_offset                          ,
+                            int column);
+
+
+void enkf_fmatrix_deserialize(float * node_data                     ,
+                              int node_size                         ,
+                              const active_list_type * __active_list ,
+                              const fmatrix_type * A                ,
+                              int row_offset                        ,
+                              int column);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,8 @@ extern "C" {
 #include <ert/util/hash.h>
 #include <ert/util/subst_list.h>
 #include <ert/util/rng.h>
+#include <ert/util/render_cache.h>
+#include <ert/util/path_service.h>
 #include <ert/util/stringlist.h>
 #include <ert/util/matrix.h>
 #include <ert/util/log.h>
@@ -62,6 +64,7 @@ typedef struct enkf_state_struct    enkf_state_type;
   keep_runpath_type  member_config_get_keep_runpath(const member_config_type * member_config);
   //void             * enkf_state_complete_forward_model__(void * arg );
   job_status_type    enkf_state_get_run_status( const enkf_state_type * enkf_state );
+  void               enkf_state_internalize_running( enkf_state_type * enkf_state , enkf_fs_type * fs );
   time_t             enkf_state_get_start_time( const enkf_state_type * enkf_state );
   time_t             enkf_state_get_submit_time( const enkf_state_type * enkf_state );
   bool               enkf_state_resubmit_simulation( enkf_state_type * enkf_state , enkf_fs_type * fs , bool resample);
@@ -102,6 +105,8 @@ typedef struct enkf_state_struct    enkf_state_type;
                                       const ecl_config_type * ,
                                       log_type * logh,
                                       ert_templates_type * templates,
+                                      render_cache_type  * render_cache,
+                                      path_service_type  * path_service,
                                       subst_list_type    * parent_subst);
   void               enkf_state_update_node( enkf_state_type * enkf_state , const char * node_key );
   void               enkf_state_update_jobname( enkf_state_type * enkf_state );
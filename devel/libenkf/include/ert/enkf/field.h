@@ -71,6 +71,8 @@ extern "C" {
   ecl_kw_type * field_alloc_ecl_kw_wrapper(const field_type * );
   void          field_update_sum(field_type * sum , field_type * field , double lower_limit , double upper_limit);
   void          field_upgrade_103(const char * filename);
+  void          field_fmatrix_serialize(const field_type * field , const active_list_type * active_list , fmatrix_type * A , int row_offset , int column);
+  void          field_fmatrix_deserialize(field_type * field , const active_list_type * active_list , const fmatrix_type * A , int row_offset , int column);
   
   UTIL_IS_INSTANCE_HEADER(field);
   UTIL_SAFE_CAST_HEADER_CONST(field);
@@ -35,6 +35,7 @@ void                     field_trans_table_add(field_trans_table_type * , const
 field_trans_table_type * field_trans_table_alloc();
 bool                     field_trans_table_has_key(field_trans_table_type *  , const char * );
 field_func_type        * field_trans_table_lookup(field_trans_table_type *  , const char * );
+void                     field_trans_apply_float(field_func_type * func , float * data , int size);
 
 
 
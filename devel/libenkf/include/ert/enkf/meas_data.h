@@ -33,9 +33,15 @@ extern "C" {
 typedef struct meas_data_struct   meas_data_type;
 typedef struct meas_block_struct  meas_block_type;  
 
+typedef enum { MEAS_BLOCK_INLIER       = 0,
+               MEAS_BLOCK_NO_VARIATION = 1,     /* The ensemble std is below the cutoff. */
+               MEAS_BLOCK_NO_OVERLAP   = 2}     /* The ensemble and the observation are too far apart. */
+  meas_outlier_type;
+
   UTIL_IS_INSTANCE_HEADER( meas_data );
 
 void               meas_block_iset( meas_block_type * meas_block , int iens , int iobs , double value);
+double             meas_block_iget( const meas_block_type * meas_block , int iens , int iobs);
 double             meas_block_iget_ens_mean( const meas_block_type * meas_block , int iobs );
 double             meas_block_iget_ens_std( const meas_block_type * meas_block , int iobs);
 void               meas_block_deactivate( meas_block_type * meas_block , int iobs );                               
@@ -57,6 +63,7 @@ meas_block_type  * meas_data_add_block( meas_data_type * matrix , const char * o
 meas_block_type  * meas_data_iget_block( meas_data_type * matrix , int block_mnr);
 const meas_block_type  * meas_data_iget_block_const( const meas_data_type * matrix , int block_nr );
 void               meas_block_calculate_ens_stats( meas_block_type * meas_block );
+int                meas_block_outlier_mask( meas_block_type * meas_block , const double * obs_value , const double * obs_std , double std_cutoff , double alpha , meas_outlier_type * outlier_mask);
 int                meas_block_get_total_size( const meas_block_type * meas_block );
 bool               meas_block_iget_active( const meas_block_type * meas_block , int iobs);
 void               meas_data_assign_vector(meas_data_type * target_matrix, const meas_data_type * src_matrix , int target_index , int src_index);
@@ -44,6 +44,8 @@ extern "C" {
   bool                misfit_ensemble_initialized( const misfit_ensemble_type * misfit_ensemble );
   void                misfit_ensemble_update( misfit_ensemble_type * misfit_ensemble , const ensemble_config_type * ensemble_config , const enkf_obs_type * enkf_obs , enkf_fs_type * fs , int ens_size , int history_length);
   void                misfit_ensemble_set_ens_size( misfit_ensemble_type * misfit_ensemble , int ens_size);
+  void                misfit_ensemble_set_num_threads( misfit_ensemble_type * misfit_ensemble , int num_threads);
+  int                 misfit_ensemble_get_num_threads( const misfit_ensemble_type * misfit_ensemble );
   int                 misfit_ensemble_get_ens_size( const misfit_ensemble_type * misfit_ensemble );
 
   misfit_member_type * misfit_ensemble_iget_member( const misfit_ensemble_type * table , int iens);
@@ -46,6 +46,8 @@ void         obs_block_iset_missing( obs_block_type * obs_block , int iobs );
 
 double obs_block_iget_std( const obs_block_type * obs_block , int iobs);
 double obs_block_iget_value( const obs_block_type * obs_block , int iobs);
+const double * obs_block_get_value_ptr( const obs_block_type * obs_block );
+const double * obs_block_get_std_ptr( const obs_block_type * obs_block );
 bool   obs_block_iget_active( const obs_block_type * obs_block , int iobs);
 
 
@@ -0,0 +1,55 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'packed_param.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __PACKED_PARAM_H__
+#define __PACKED_PARAM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/matrix.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/bool_vector.h>
+
+#include <ert/enkf/active_list.h>
+
+  bool packed_param_fwrite( const char * filename ,
+                            const matrix_type * A ,
+                            int row_offset ,
+                            int data_size ,
+                            const int_vector_type * iens_active_index ,
+                            bool float_data);
+
+  bool packed_param_fread_rows( const char * filename ,
+                                matrix_type * A ,
+                                int row_offset ,
+                                int data_size ,
+                                const active_list_type * active_list ,
+                                const int_vector_type * iens_active_index);
+
+  bool packed_param_fread_member( const char * filename , int iens , int data_size , double * data);
+  void packed_param_invalidate_members( const char * filename , const bool_vector_type * invalid );
+  bool packed_param_has_member( const char * filename , int iens );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -56,6 +56,7 @@ struct analysis_config_struct {
   bool                            store_PC;
   bool                            update_results;              /* Should result values like e.g. WWCT be updated? */
   bool                            single_node_update;          /* When creating the default ALL_ACTIVE local configuration. */ 
+  bool                            packed_parameters;           /* Should updated parameters also be stored as packed ensemble matrices? */
   rng_type                      * rng;  
   analysis_iter_config_type * iter_config;
   int                         min_realisations; 
@@ -235,6 +236,14 @@ bool analysis_config_get_single_node_update(const analysis_config_type * config)
   return config->single_node_update;
 }
 
+void analysis_config_set_packed_parameters(analysis_config_type * config , bool packed_parameters) {
+  config->packed_parameters = packed_parameters;
+}
+
+bool analysis_config_get_packed_parameters(const analysis_config_type * config) {
+  return config->packed_parameters;
+}
+
 
 int analysis_config_get_rerun_start(const analysis_config_type * config) {
   return config->rerun_start;
@@ -377,6 +386,7 @@ void analysis_config_load_internal_modules( analysis_config_type * config ) {
   analysis_config_load_internal_module( config , "CV_ENKF"        , "cv_enkf_symbol_table");
   analysis_config_load_internal_module( config , "BOOTSTRAP_ENKF" , "bootstrap_enkf_symbol_table");
   analysis_config_load_internal_module( config , "FWD_STEP_ENKF"  , "fwd_step_enkf_symbol_table");
+  analysis_config_load_internal_module( config , "IES_ENKF"       , "ies_enkf_symbol_table");
   analysis_config_select_module( config , DEFAULT_ANALYSIS_MODULE);
 }
 
@@ -406,6 +416,9 @@ void analysis_config_init( analysis_config_type * analysis , const config_type *
 
   if (config_item_set( config , SINGLE_NODE_UPDATE_KEY ))
     analysis_config_set_single_node_update( analysis , config_get_value_as_bool( config , SINGLE_NODE_UPDATE_KEY ));
+
+  if (config_item_set( config , PACKED_PARAMETERS_KEY ))
+    analysis_config_set_packed_parameters( analysis , config_get_value_as_bool( config , PACKED_PARAMETERS_KEY ));
   
   if (config_item_set( config , RERUN_START_KEY ))
     analysis_config_set_rerun_start( analysis , config_get_value_as_int( config , RERUN_START_KEY ));
@@ -514,6 +527,7 @@ analysis_config_type * analysis_config_alloc( rng_type * rng ) {
   analysis_config_set_rerun_start( config              , DEFAULT_RERUN_START );
   analysis_config_set_update_results( config           , DEFAULT_UPDATE_RESULTS);
   analysis_config_set_single_node_update( config       , DEFAULT_SINGLE_NODE_UPDATE );
+  analysis_config_set_packed_parameters( config        , DEFAULT_PACKED_PARAMETERS );
   analysis_config_set_log_path( config                 , DEFAULT_UPDATE_LOG_PATH);
 
   analysis_config_set_store_PC( config                 , DEFAULT_STORE_PC );
@@ -544,6 +558,7 @@ void analysis_config_add_config_items( config_type * config ) {
   config_add_key_value( config , ENKF_MERGE_OBSERVATIONS_KEY , false , CONFIG_BOOL);
   config_add_key_value( config , UPDATE_RESULTS_KEY          , false , CONFIG_BOOL);
   config_add_key_value( config , SINGLE_NODE_UPDATE_KEY      , false , CONFIG_BOOL);
+  config_add_key_value( config , PACKED_PARAMETERS_KEY       , false , CONFIG_BOOL);
   config_add_key_value( config , ENKF_CROSS_VALIDATION_KEY   , false , CONFIG_BOOL);
   config_add_key_value( config , ENKF_LOCAL_CV_KEY           , false , CONFIG_BOOL);
   config_add_key_value( config , ENKF_PEN_PRESS_KEY          , false , CONFIG_BOOL);
@@ -606,6 +621,11 @@ void analysis_config_fprintf_config( analysis_config_type * config , FILE * stre
     fprintf( stream , CONFIG_KEY_FORMAT        , SINGLE_NODE_UPDATE_KEY);
     fprintf( stream , CONFIG_ENDVALUE_FORMAT   , CONFIG_BOOL_STRING( config->single_node_update ));
   }
+
+  if (config->packed_parameters != DEFAULT_PACKED_PARAMETERS) {
+    fprintf( stream , CONFIG_KEY_FORMAT        , PACKED_PARAMETERS_KEY);
+    fprintf( stream , CONFIG_ENDVALUE_FORMAT   , CONFIG_BOOL_STRING( config->packed_parameters ));
+  }
   
   if (config->rerun) {
     fprintf( stream , CONFIG_KEY_FORMAT        , ENKF_RERUN_KEY);
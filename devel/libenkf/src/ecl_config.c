@@ -70,6 +70,7 @@ struct ecl_config_struct {
   ecl_grid_type      * grid;                       /* The grid which is active for this model. */
   char               * schedule_prediction_file;   /* Name of schedule prediction file - observe that this is internally handled as a gen_kw node. */
   char               * schedule_target_file;       /* File name to write schedule info to */
+  char               * schedule_cache_path;        /* Directory for the binary schedule cache, i.e. ENSPATH - can be NULL. */
   char               * input_init_section;         /* File name for ECLIPSE (EQUIL) initialisation - can be NULL if the user has not supplied INIT_SECTION. */
   char               * init_section;               /* Equal to the full path of input_init_section IFF input_init_section points to an existing file - otherwise equal to input_init_section. */
   int                  last_history_restart;
@@ -220,8 +221,14 @@ void ecl_config_set_schedule_file( ecl_config_type * ecl_config , const char * s
   }
   ecl_config->sched_file = sched_file_alloc( ecl_config->start_date );
   
-  
-  sched_file_parse(ecl_config->sched_file , schedule_file );
+  {
+    char * cache_file = NULL;
+    if (ecl_config->schedule_cache_path != NULL)
+      cache_file = util_alloc_filename( ecl_config->schedule_cache_path , ecl_config->schedule_target_file , "cache" );
+    
+    sched_file_parse_cached( ecl_config->sched_file , schedule_file , cache_file );
+    util_safe_free( cache_file );
+  }
   ecl_config->last_history_restart = sched_file_get_num_restart_files( ecl_config->sched_file ) - 1;   /* We keep track of this - so we can stop assimilation at the end of history */
   {
     hash_iter_type * iter = hash_iter_alloc( ecl_config->fixed_length_kw );
@@ -237,6 +244,19 @@ void ecl_config_set_schedule_file( ecl_config_type * ecl_config , const char * s
 
 
 
+/**
+   The parsed schedule file is cached in binary form in this
+   directory; the cache is used on the next startup if the schedule
+   file has not changed. Must be called before
+   ecl_config_set_schedule_file().
+*/
+
+void ecl_config_set_schedule_cache_path( ecl_config_type * ecl_config , const char * cache_path ) {
+  ecl_config->schedule_cache_path = util_realloc_string_copy( ecl_config->schedule_cache_path , cache_path );
+}
+
+
+
 void ecl_config_add_fixed_length_schedule_kw( ecl_config_type * ecl_config , const char * kw , int length ) {
   hash_insert_int( ecl_config->fixed_length_kw , kw , length );
   if (ecl_config->sched_file != NULL) 
@@ -413,6 +433,7 @@ ecl_config_type * ecl_config_alloc_empty( ) {
   ecl_config->sched_file               = NULL;
   ecl_config->schedule_prediction_file = NULL;
   ecl_config->schedule_target_file     = NULL;
+  ecl_config->schedule_cache_path      = NULL;
   ecl_config->refcase_list             = ecl_refcase_list_alloc();
   
   ecl_config_init_static_kw( ecl_config );
@@ -428,8 +449,14 @@ void ecl_config_init( ecl_config_type * ecl_config , const config_type * config
   if (config_item_set( config , DATA_FILE_KEY ))
     ecl_config_set_data_file( ecl_config , config_iget( config , DATA_FILE_KEY ,0,0));
   
-  if (config_item_set( config , SCHEDULE_FILE_KEY ))
+  if (config_item_set( config , SCHEDULE_FILE_KEY )) {
+    if (config_item_set( config , ENSPATH_KEY ))
+      ecl_config_set_schedule_cache_path( ecl_config , config_get_value( config , ENSPATH_KEY ));
+    else
+      ecl_config_set_schedule_cache_path( ecl_config , DEFAULT_ENSPATH );
+    
     ecl_config_set_schedule_file( ecl_config , config_iget( config , SCHEDULE_FILE_KEY ,0,0));
+  }
 
   
   if (config_item_set(config , GRID_KEY))
@@ -534,6 +561,7 @@ void ecl_config_free(ecl_config_type * ecl_config) {
 
 
   util_safe_free(ecl_config->schedule_target_file);
+  util_safe_free(ecl_config->schedule_cache_path);
   hash_free( ecl_config->fixed_length_kw );
 
   util_safe_free(ecl_config->input_init_section);
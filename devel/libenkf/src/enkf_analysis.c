@@ -110,40 +110,34 @@ void enkf_analysis_deactivate_outliers(obs_data_type * obs_data , meas_data_type
   for (int block_nr =0; block_nr < obs_data_get_num_blocks( obs_data ); block_nr++) {
     obs_block_type  * obs_block  = obs_data_iget_block( obs_data , block_nr);
     meas_block_type * meas_block = meas_data_iget_block( meas_data , block_nr );
+    int obs_size = meas_block_get_total_size( meas_block );
+    meas_outlier_type * outlier_mask = util_calloc( obs_size , sizeof * outlier_mask );
     
-    meas_block_calculate_ens_stats( meas_block );
-    {
+    if (meas_block_outlier_mask( meas_block , 
+                                 obs_block_get_value_ptr( obs_block ) , 
+                                 obs_block_get_std_ptr( obs_block ) , 
+                                 std_cutoff , alpha , outlier_mask) > 0) {
       int iobs;
-      for (iobs =0; iobs < meas_block_get_total_size( meas_block ); iobs++) {
-        if (meas_block_iget_active( meas_block , iobs )) {
-          double ens_std  = meas_block_iget_ens_std( meas_block , iobs );
-          if (ens_std < std_cutoff) {
-            /*
-              De activated because the ensemble has to small
-              variation for this particular measurement.
-            */
-            obs_block_deactivate( obs_block , iobs , "No ensemble variation");
-            meas_block_deactivate( meas_block , iobs );
-          } else {
-            double ens_mean  = meas_block_iget_ens_mean( meas_block , iobs );
-            double obs_std   = obs_block_iget_std( obs_block , iobs );
-            double obs_value = obs_block_iget_value( obs_block , iobs );
-            double innov     = obs_value - ens_mean;
-            
-            /* 
-               Deactivated because the distance between the observed data
-               and the ensemble prediction is to large. Keeping these
-               outliers will lead to numerical problems.
-            */
-
-            if (fabs( innov ) > alpha * (ens_std + obs_std)) {
-              obs_block_deactivate(obs_block , iobs , "No overlap");
-              meas_block_deactivate(meas_block , iobs);
-            }
-          }
+      for (iobs =0; iobs < obs_size; iobs++) {
+        if (outlier_mask[iobs] == MEAS_BLOCK_NO_VARIATION) {
+          /*
+            De activated because the ensemble has to small
+            variation for this particular measurement.
+          */
+          obs_block_deactivate( obs_block , iobs , "No ensemble variation");
+          meas_block_deactivate( meas_block , iobs );
+        } else if (outlier_mask[iobs] == MEAS_BLOCK_NO_OVERLAP) {
+          /* 
+             Deactivated because the distance between the observed data
+             and the ensemble prediction is to large. Keeping these
+             outliers will lead to numerical problems.
+          */
+          obs_block_deactivate(obs_block , iobs , "No overlap");
+          meas_block_deactivate(meas_block , iobs);
         }
       }
     }
+    free( outlier_mask );
   }
 }
 
@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <dirent.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <ert/util/util.h>
 #include <ert/util/type_macros.h>
@@ -32,6 +34,8 @@
 #include <ert/util/arg_pack.h>
 #include <ert/util/stringlist.h>
 #include <ert/util/arg_pack.h>
+#include <ert/util/hash.h>
+#include <ert/util/bool_vector.h>
 
 #include <ert/enkf/block_fs_driver.h>
 #include <ert/enkf/enkf_fs.h>
@@ -45,6 +49,7 @@
 #include <ert/enkf/state_map.h>
 #include <ert/enkf/misfit_ensemble.h>
 #include <ert/enkf/cases_config.h>
+#include <ert/enkf/packed_param.h>
 
 /**
 
@@ -208,6 +213,9 @@
 #define STATE_MAP_FILE        "state-map"
 #define MISFIT_ENSEMBLE_FILE  "misfit-ensemble"
 #define CASE_CONFIG_FILE      "case_config"
+#define PACKED_PARAMETER_FILE "packed-parameters"
+#define DATA_STAMP_FILE       "data-stamp"
+#define JOB_RESOURCE_FILE     "job-resources"
 
 struct enkf_fs_struct {
   UTIL_TYPE_ID_DECLARATION;
@@ -227,6 +235,12 @@ struct enkf_fs_struct {
   cases_config_type      * cases_config;
   state_map_type         * state_map;
   misfit_ensemble_type   * misfit_ensemble;
+  bool                     packed_parameters;     /* Whether packed parameter files have been written to this filesystem. */
+  hash_type              * packed_invalid;        /* Pending invalidations: packed filename -> bool_vector of realisations. */
+  pthread_mutex_t          packed_lock;
+  bool_vector_type       * stamp_fresh;           /* Whether the data stamp of a realisation is unused since it was written. */
+  long                     stamp_counter;
+  pthread_mutex_t          stamp_lock;
   /* 
      The variables below here are for storing arbitrary files within 
      the enkf_fs storage directory, but not as serialized enkf_nodes.
@@ -256,6 +270,12 @@ static enkf_fs_type * enkf_fs_alloc_empty( const char * mount_point , bool read_
   fs->dynamic_forecast       = NULL;
   fs->dynamic_analyzed       = NULL;
   fs->read_only              = read_only;
+  fs->packed_parameters      = false;
+  fs->packed_invalid         = hash_alloc();
+  pthread_mutex_init( &fs->packed_lock , NULL );
+  fs->stamp_fresh            = bool_vector_alloc( 0 , false );
+  fs->stamp_counter          = 0;
+  pthread_mutex_init( &fs->stamp_lock , NULL );
   fs->mount_point            = util_alloc_string_copy( mount_point );
   if (mount_point == NULL)
     util_abort("%s: fatal internal error: mount_point == NULL \n",__func__);
@@ -483,7 +503,7 @@ static void enkf_fs_fread_misfit( enkf_fs_type * fs ) {
 }
 
 
-static void enkf_fs_fwrite_misfit( enkf_fs_type * fs ) {
+void enkf_fs_fwrite_misfit( enkf_fs_type * fs ) {
   if (misfit_ensemble_initialized( fs->misfit_ensemble )) {
     FILE * stream = enkf_fs_open_case_file( fs , MISFIT_ENSEMBLE_FILE , "w");
     misfit_ensemble_fwrite( fs->misfit_ensemble , stream );
@@ -492,6 +512,13 @@ static void enkf_fs_fwrite_misfit( enkf_fs_type * fs ) {
 }
 
 
+static void enkf_fs_fread_packed_parameters( enkf_fs_type * fs ) {
+  char * filename = enkf_fs_alloc_case_filename( fs , PACKED_PARAMETER_FILE );
+  fs->packed_parameters = util_file_exists( filename );
+  free( filename );
+}
+
+
 enkf_fs_type * enkf_fs_open( const char * mount_point , bool read_only) {
   enkf_fs_type * fs = NULL;
   FILE * stream = fs_driver_open_fstab( mount_point , false );
@@ -519,6 +546,7 @@ enkf_fs_type * enkf_fs_open( const char * mount_point , bool read_only) {
     enkf_fs_fread_cases_config( fs );
     enkf_fs_fread_state_map( fs );
     enkf_fs_fread_misfit( fs );
+    enkf_fs_fread_packed_parameters( fs );
   }
   return fs;
 }
@@ -569,6 +597,8 @@ void enkf_fs_close( enkf_fs_type * fs ) {
   state_map_free( fs->state_map );
   time_map_free( fs->time_map );
   cases_config_free( fs->cases_config );
+  hash_free( fs->packed_invalid );
+  bool_vector_free( fs->stamp_fresh );
   free( fs );
 }
 
@@ -615,6 +645,34 @@ static void * enkf_fs_select_driver(enkf_fs_type * fs , enkf_var_type var_type,
 /* Exported functions for enkf_node instances . */
 
 
+static void enkf_fs_invalidate_packed_member( enkf_fs_type * fs , const char * node_key , int report_step , int iens) {
+  char * filename = enkf_fs_alloc_packed_parameter_filename( fs , node_key , report_step );
+  pthread_mutex_lock( &fs->packed_lock );
+  {
+    if (!hash_has_key( fs->packed_invalid , filename ))
+      hash_insert_hash_owned_ref( fs->packed_invalid , filename , bool_vector_alloc( 0 , false ) , bool_vector_free__ );
+    bool_vector_iset( hash_get( fs->packed_invalid , filename ) , iens , true );
+  }
+  pthread_mutex_unlock( &fs->packed_lock );
+  free( filename );
+}
+
+
+static void enkf_fs_flush_packed_invalidations( enkf_fs_type * fs ) {
+  pthread_mutex_lock( &fs->packed_lock );
+  {
+    hash_iter_type * iter = hash_iter_alloc( fs->packed_invalid );
+    while (!hash_iter_is_complete( iter )) {
+      const char * filename = hash_iter_get_next_key( iter );
+      packed_param_invalidate_members( filename , hash_get( fs->packed_invalid , filename ));
+    }
+    hash_iter_free( iter );
+    hash_clear( fs->packed_invalid );
+  }
+  pthread_mutex_unlock( &fs->packed_lock );
+}
+
+
 static void enkf_fs_fsync_driver( fs_driver_type * driver ) {
   if (driver->fsync_driver != NULL)
     driver->fsync_driver( driver );
@@ -623,6 +681,7 @@ static void enkf_fs_fsync_driver( fs_driver_type * driver ) {
 
 
 void enkf_fs_fsync( enkf_fs_type * fs ) {
+  enkf_fs_flush_packed_invalidations( fs );
   enkf_fs_fsync_driver( fs->parameter );
   enkf_fs_fsync_driver( fs->eclipse_static );
   enkf_fs_fsync_driver( fs->dynamic_forecast );
@@ -711,10 +770,77 @@ bool enkf_fs_has_vector(enkf_fs_type * enkf_fs , const char * node_key , enkf_va
   return driver->has_vector(driver , node_key , iens ); 
 }
 
+/*****************************************************************/
+/* Data stamps. */
+
+/*
+  Each realisation has a data stamp, stored in a small file in the
+  member directory, which changes whenever new dynamic data, i.e.
+  simulated results which observations can be compared with, is
+  stored for the realisation. Consumers which cache values derived
+  from the simulated data, like the misfit table, record the stamp
+  and recalculate when it has changed; since the stamp is read from
+  disk this also catches data written by another process.
+
+  A new stamp is only written when the current stamp has been handed
+  out by enkf_fs_get_member_data_stamp(), so loading a realisation
+  only writes the stamp file once. The stamp is checked both before
+  the node is saved, so a crash between the two can not leave an old
+  stamp next to new data, and after, so a stamp which was handed out
+  while the node was being saved is replaced.
+*/
+
+static void enkf_fs_stamp_member_data( enkf_fs_type * fs , int iens ) {
+  pthread_mutex_lock( &fs->stamp_lock );
+  if (!bool_vector_safe_iget( fs->stamp_fresh , iens )) {
+    long stamp = ((long) time( NULL ) << 32) + ((long) (getpid( ) & 0xFFFF) << 16) + (fs->stamp_counter & 0xFFFF);
+    FILE * stream = enkf_fs_open_case_member_file( fs , DATA_STAMP_FILE , iens , "w");
+    util_fwrite_long( stamp , stream );
+    fclose( stream );
+
+    fs->stamp_counter++;
+    bool_vector_iset( fs->stamp_fresh , iens , true );
+  }
+  pthread_mutex_unlock( &fs->stamp_lock );
+}
+
+
+/*
+  Returns the current data stamp of the realisation, or 0 if the
+  realisation does not have a stamp.
+*/
+
+long enkf_fs_get_member_data_stamp( enkf_fs_type * fs , int iens ) {
+  long stamp = 0;
+  pthread_mutex_lock( &fs->stamp_lock );
+  {
+    char * filename = enkf_fs_alloc_case_member_filename( fs , iens , DATA_STAMP_FILE );
+    FILE * stream = fopen( filename , "r");
+    if (stream != NULL) {
+      if (fread( &stamp , sizeof stamp , 1 , stream ) != 1)
+        stamp = 0;
+      fclose( stream );
+    }
+    free( filename );
+    bool_vector_iset( fs->stamp_fresh , iens , false );
+  }
+  pthread_mutex_unlock( &fs->stamp_lock );
+  return stamp;
+}
+
+
+static bool enkf_fs_dynamic_var_type( enkf_var_type var_type ) {
+  return ((var_type == DYNAMIC_RESULT) || (var_type == DYNAMIC_STATE));
+}
+
+
 void enkf_fs_fwrite_node(enkf_fs_type * enkf_fs , buffer_type * buffer , const char * node_key, enkf_var_type var_type,  
                          int report_step , int iens , state_enum state) {
   if (enkf_fs->read_only)
     util_abort("%s: attempt to write to read_only filesystem mounted at:%s - aborting. \n",__func__ , enkf_fs->mount_point);
+
+  if (enkf_fs_dynamic_var_type( var_type ))
+    enkf_fs_stamp_member_data( enkf_fs , iens );
   {
     void * _driver = enkf_fs_select_driver(enkf_fs , var_type , state , node_key);
     {
@@ -722,6 +848,12 @@ void enkf_fs_fwrite_node(enkf_fs_type * enkf_fs , buffer_type * buffer , const c
       driver->save_node(driver , node_key , report_step , iens , buffer);
     }
   }
+
+  if ((var_type == PARAMETER) && enkf_fs->packed_parameters) 
+    enkf_fs_invalidate_packed_member( enkf_fs , node_key , report_step , iens );
+
+  if (enkf_fs_dynamic_var_type( var_type ))
+    enkf_fs_stamp_member_data( enkf_fs , iens );
 }
 
 
@@ -729,6 +861,9 @@ void enkf_fs_fwrite_vector(enkf_fs_type * enkf_fs , buffer_type * buffer , const
                            int iens , state_enum state) {
   if (enkf_fs->read_only)
     util_abort("%s: attempt to write to read_only filesystem mounted at:%s - aborting. \n",__func__ , enkf_fs->mount_point);
+
+  if (enkf_fs_dynamic_var_type( var_type ))
+    enkf_fs_stamp_member_data( enkf_fs , iens );
   {
     void * _driver = enkf_fs_select_driver(enkf_fs , var_type , state , node_key);
     {
@@ -736,6 +871,8 @@ void enkf_fs_fwrite_vector(enkf_fs_type * enkf_fs , buffer_type * buffer , const
       driver->save_vector(driver , node_key  , iens , buffer);
     }
   }
+  if (enkf_fs_dynamic_var_type( var_type ))
+    enkf_fs_stamp_member_data( enkf_fs , iens );
 }
 
 
@@ -774,10 +911,255 @@ void enkf_fs_debug_fprintf( const enkf_fs_type * fs) {
 }
 
 
+/*****************************************************************/
+/* Packed parameter storage. */
+
+/*
+  In addition to the per-realisation nodes stored by the parameter
+  driver a parameter can be stored as one packed ensemble matrix per
+  report step, see packed_param.c for the file layout. The packed
+  files are written by the analysis and let the next update read A
+  directly instead of loading and decompressing every node. The
+  per-realisation nodes are still written and are the authoritative
+  version; when a node is written by any other route the
+  corresponding realisation in the packed file is invalidated.
+
+  The invalidations are not written to the packed files immediately,
+  that would cost one open of the packed file for every node
+  written. Instead they are collected per packed file and flushed in
+  one go by enkf_fs_fsync(), and before a packed file is read. When
+  the analysis writes a new packed file the pending invalidations of
+  the nodes it has just stored are simply dropped.
+
+  As for the parameter driver the forecast at step N is the analyzed
+  parameter at step N - 1, and earlier steps are searched if nothing
+  is stored at that step. If no usable packed file is found the
+  caller must fall back to the nodes.
+*/
+
+static int enkf_fs_get_packed_report_step( int report_step , state_enum state ) {
+  if ((state == FORECAST) && (report_step > 0))
+    return report_step - 1;
+  else
+    return report_step;
+}
+
+
+/*
+  Mirrors the backward search in __get_parameter_report_step(): the
+  packed file at a report step can only be used if none of the
+  realisations have a node stored at a later step; returns -1 if
+  there is no usable packed file. The realisations considered are
+  those which are active in iens_active_index, or only iens if
+  iens_active_index is NULL.
+*/
+
+static int enkf_fs_find_packed_report_step( const enkf_fs_type * fs , const char * node_key , int report_step , state_enum state , 
+                                            const int_vector_type * iens_active_index , int iens) {
+  fs_driver_type * driver = fs->parameter;
+  int step = enkf_fs_get_packed_report_step( report_step , state );
+
+  while (step >= 0) {
+    char * filename = enkf_fs_alloc_packed_parameter_filename( fs , node_key , step );
+    bool has_packed = util_file_exists( filename );
+    free( filename );
+
+    if (has_packed)
+      return step;
+
+    if (iens_active_index != NULL) {
+      for (int i = 0; i < int_vector_size( iens_active_index ); i++) {
+        if (int_vector_iget( iens_active_index , i ) >= 0)
+          if (driver->has_node( driver , node_key , step , i ))
+            return -1;
+      }
+    } else if (driver->has_node( driver , node_key , step , iens ))
+      return -1;
+    step--;
+  }
+  return -1;
+}
+
+
+char * enkf_fs_alloc_packed_parameter_filename( const enkf_fs_type * fs , const char * node_key , int report_step) {
+  char * input_name = util_alloc_sprintf( "%s.packed" , node_key );
+  char * filename = enkf_fs_alloc_case_tstep_filename( fs , report_step , input_name );
+  free( input_name );
+  return filename;
+}
+
+
+bool enkf_fs_has_packed_parameters( const enkf_fs_type * fs ) {
+  return fs->packed_parameters;
+}
+
+
+void enkf_fs_fwrite_packed_parameter( enkf_fs_type * fs ,
+                                      const char * node_key ,
+                                      int report_step ,
+                                      const matrix_type * A ,
+                                      int row_offset ,
+                                      int data_size ,
+                                      const int_vector_type * iens_active_index ,
+                                      bool float_data) {
+  if (fs->read_only)
+    util_abort("%s: attempt to write to read_only filesystem mounted at:%s - aborting. \n",__func__ , fs->mount_point);
+
+  if (!fs->packed_parameters) {
+    FILE * stream = enkf_fs_open_case_file( fs , PACKED_PARAMETER_FILE , "w");
+    fclose( stream );
+    fs->packed_parameters = true;
+  }
+
+  {
+    char * filename = enkf_fs_alloc_packed_parameter_filename( fs , node_key , report_step );
+
+    pthread_mutex_lock( &fs->packed_lock );
+    if (hash_has_key( fs->packed_invalid , filename ))
+      hash_del( fs->packed_invalid , filename );
+    pthread_mutex_unlock( &fs->packed_lock );
+
+    packed_param_fwrite( filename , A , row_offset , data_size , iens_active_index , float_data );
+    free( filename );
+  }
+}
+
+
+/*
+  Will fill rows [row_offset , row_offset + active_size) of A with the
+  elements of the parameter given by the active_list; data_size is
+  the full size of the parameter. Returns false if there is no usable
+  packed file.
+*/
+
+bool enkf_fs_fread_packed_parameter( enkf_fs_type * fs ,
+                                     const char * node_key ,
+                                     int report_step ,
+                                     state_enum state ,
+                                     const active_list_type * active_list ,
+                                     int data_size ,
+                                     matrix_type * A ,
+                                     int row_offset ,
+                                     const int_vector_type * iens_active_index) {
+  bool loaded = false;
+  if (fs->packed_parameters) {
+    enkf_fs_flush_packed_invalidations( fs );
+    int packed_step = enkf_fs_find_packed_report_step( fs , node_key , report_step , state , iens_active_index , -1 );
+    if (packed_step >= 0) {
+      char * filename = enkf_fs_alloc_packed_parameter_filename( fs , node_key , packed_step );
+      loaded = packed_param_fread_rows( filename , A , row_offset , data_size , active_list , iens_active_index );
+      free( filename );
+    }
+  }
+  return loaded;
+}
+
+
+/*
+  Extracts the data vector of one realisation from the packed file;
+  this is the per-realisation view of the packed storage.
+*/
+
+bool enkf_fs_fread_packed_member( enkf_fs_type * fs ,
+                                  const char * node_key ,
+                                  int report_step ,
+                                  state_enum state ,
+                                  int iens ,
+                                  int data_size ,
+                                  double * data) {
+  bool loaded = false;
+  if (fs->packed_parameters) {
+    enkf_fs_flush_packed_invalidations( fs );
+    int packed_step = enkf_fs_find_packed_report_step( fs , node_key , report_step , state , NULL , iens );
+    if (packed_step >= 0) {
+      char * filename = enkf_fs_alloc_packed_parameter_filename( fs , node_key , packed_step );
+      loaded = packed_param_fread_member( filename , iens , data_size , data );
+      free( filename );
+    }
+  }
+  return loaded;
+}
+
+
 /*****************************************************************/
 /* Index related functions  . */
 
 
+/*****************************************************************/
+/*
+   The resources used by the forward model of each realisation, as
+   reported by the queue driver, are stored in one text file per run,
+   i.e. per step1 of the forward model. Each line holds the
+   realisation number followed by the job_resource fields.
+*/
+
+void enkf_fs_fwrite_job_resources( const enkf_fs_type * fs , int step , const vector_type * resource_list ) {
+  FILE * stream = enkf_fs_open_case_tstep_file( fs , JOB_RESOURCE_FILE , step , "w");
+  for (int iens = 0; iens < vector_get_size( resource_list ); iens++) {
+    const job_resource_type * resource = vector_iget_const( resource_list , iens );
+    if (resource != NULL) {
+      fprintf(stream , "%d " , iens );
+      job_resource_fprintf( resource , stream );
+    }
+  }
+  fclose( stream );
+}
+
+
+/*
+  Reads the job-resources file for one run; if total != NULL all the
+  records are added to total, otherwise the record of realisation
+  iens is assigned to resource.
+*/
+
+static bool enkf_fs_fread_job_resources__( const enkf_fs_type * fs , int step , int iens , job_resource_type * resource , job_resource_type * total) {
+  FILE * stream = enkf_fs_open_excase_tstep_file( fs , JOB_RESOURCE_FILE , step );
+  bool found = false;
+  if (stream != NULL) {
+    job_resource_type * line_resource = job_resource_alloc( );
+    int line_iens;
+    while (fscanf( stream , "%d" , &line_iens ) == 1) {
+      if (!job_resource_fscanf( line_resource , stream ))
+        break;
+
+      if (total != NULL) {
+        job_resource_add( total , line_resource );
+        found = true;
+      } else if (line_iens == iens) {
+        job_resource_assign( resource , line_resource );
+        found = true;
+        break;
+      }
+    }
+    job_resource_free( line_resource );
+    fclose( stream );
+  }
+  return found;
+}
+
+
+bool enkf_fs_fread_job_resource( const enkf_fs_type * fs , int step , int iens , job_resource_type * resource ) {
+  return enkf_fs_fread_job_resources__( fs , step , iens , resource , NULL );
+}
+
+
+/*
+  Returns the resources used by all the realisations of the run
+  starting at step, aggregated with job_resource_add(); returns NULL
+  if no resources have been stored for that run.
+*/
+
+job_resource_type * enkf_fs_alloc_job_resource_summary( const enkf_fs_type * fs , int step ) {
+  job_resource_type * total = job_resource_alloc( );
+  if (!enkf_fs_fread_job_resources__( fs , step , -1 , NULL , total )) {
+    job_resource_free( total );
+    total = NULL;
+  }
+  return total;
+}
+
+/*****************************************************************/
+
 void enkf_fs_fwrite_restart_kw_list(enkf_fs_type * enkf_fs , int report_step , int iens, const stringlist_type * kw_list) {
   buffer_type * buffer = buffer_alloc(1024);
   stringlist_buffer_fwrite( kw_list , buffer );
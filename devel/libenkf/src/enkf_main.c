@@ -24,6 +24,7 @@
 #include <signal.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <time.h>
 #include <dirent.h>
 #include <pwd.h>
 #include <unistd.h>
@@ -31,6 +32,7 @@
 
 #define HAVE_THREAD_POOL 1
 #include <ert/util/matrix.h>
+#include <ert/util/fmatrix.h>
 #include <ert/util/subst_list.h>
 #include <ert/util/rng.h>
 #include <ert/util/subst_func.h>
@@ -48,6 +50,8 @@
 #include <ert/util/node_ctype.h>
 #include <ert/util/string_util.h>
 #include <ert/util/type_vector_functions.h>
+#include <ert/util/render_cache.h>
+#include <ert/util/path_service.h>
 
 #include <ert/config/config.h>
 #include <ert/config/config_schema_item.h>
@@ -72,6 +76,7 @@
 
 #include <ert/enkf/enkf_types.h>
 #include <ert/enkf/enkf_config_node.h>
+#include <ert/enkf/field_config.h>
 #include <ert/enkf/ecl_config.h>
 #include <ert/enkf/enkf_sched.h>
 #include <ert/enkf/obs_data.h>
@@ -150,6 +155,8 @@ struct enkf_main_struct {
   analysis_config_type * analysis_config;
   local_config_type    * local_config;       /* Holding all the information about local analysis. */
   ert_templates_type   * templates;          /* Run time templates */
+  render_cache_type    * render_cache;       /* Cache of the files rendered into the runpath directories. */
+  path_service_type    * path_service;       /* Deletes cleared runpath directories in the background. */
   log_type             * logh;               /* Handle to an open log file. */
   plot_config_type     * plot_config;        /* Information about plotting. */
   rng_config_type      * rng_config;
@@ -165,6 +172,14 @@ struct enkf_main_struct {
   
   int_vector_type      * keep_runpath;       /* HACK: This is only used in the initialization period - afterwards the data is held by the enkf_state object. */
   bool                   pre_clear_runpath;  /* HACK: This is only used in the initialization period - afterwards the data is held by the enkf_state object. */
+  int                    runpath_threads;     /* The number of threads preparing runpath directories in enkf_main_run_step(). */
+  int                    runpath_max_waiting; /* Max number of prepared realisations waiting in the queue; <= 0 means no limit. */
+  int                    num_preparing;       /* The number of realisations currently being prepared. */
+  int                    summary_load_interval; /* Seconds between loading the summary results of the running simulations; <= 0: load when complete. */
+  bool                   load_running;        /* Set to false to stop the enkf_main_load_running__() thread; protected by load_mutex. */
+  pthread_mutex_t        load_mutex;
+  pthread_cond_t         load_cond;           /* Signalled when load_running is set to false. */
+  pthread_mutex_t        prepare_mutex;
 
   char                 * site_config_file;
   char                 * user_config_file;   
@@ -206,6 +221,34 @@ void enkf_main_set_pre_clear_runpath( enkf_main_type * enkf_main , bool pre_clea
 }
 
 
+void enkf_main_set_runpath_threads( enkf_main_type * enkf_main , int runpath_threads ) {
+  if (runpath_threads > 0)
+    enkf_main->runpath_threads = runpath_threads;
+  else
+    util_abort("%s: invalid number of runpath threads:%d \n",__func__ , runpath_threads);
+}
+
+int enkf_main_get_runpath_threads( const enkf_main_type * enkf_main ) {
+  return enkf_main->runpath_threads;
+}
+
+void enkf_main_set_runpath_max_waiting( enkf_main_type * enkf_main , int max_waiting ) {
+  enkf_main->runpath_max_waiting = max_waiting;
+}
+
+int enkf_main_get_runpath_max_waiting( const enkf_main_type * enkf_main ) {
+  return enkf_main->runpath_max_waiting;
+}
+
+void enkf_main_set_summary_load_interval( enkf_main_type * enkf_main , int interval ) {
+  enkf_main->summary_load_interval = interval;
+}
+
+int enkf_main_get_summary_load_interval( const enkf_main_type * enkf_main ) {
+  return enkf_main->summary_load_interval;
+}
+
+
 void enkf_main_set_eclbase( enkf_main_type * enkf_main , const char * eclbase_fmt) {
   ecl_config_set_eclbase( enkf_main->ecl_config , eclbase_fmt);
   for (int iens = 0; iens < enkf_main->ens_size; iens++) 
@@ -434,6 +477,11 @@ void enkf_main_free(enkf_main_type * enkf_main){
   int_vector_free( enkf_main->keep_runpath );
   plot_config_free( enkf_main->plot_config );
   ert_templates_free( enkf_main->templates );
+  render_cache_free( enkf_main->render_cache );
+  path_service_free( enkf_main->path_service );   /* Waits for the pending deletions. */
+  pthread_mutex_destroy( &enkf_main->prepare_mutex );
+  pthread_mutex_destroy( &enkf_main->load_mutex );
+  pthread_cond_destroy( &enkf_main->load_cond );
   
   subst_func_pool_free( enkf_main->subst_func_pool );
   subst_list_free( enkf_main->subst_list );
@@ -742,6 +790,7 @@ typedef struct {
   int                       row_offset;
   const active_list_type  * active_list;
   matrix_type             * A;
+  fmatrix_type            * fA;        /* Single precision ensemble matrix; when non NULL it is used instead of A. */
   const int_vector_type   * iens_active_index;
 } serialize_info_type;
 
@@ -756,11 +805,15 @@ static void serialize_node( enkf_fs_type * fs ,
                             int row_offset , 
                             int column,
                             const active_list_type * active_list,
-                            matrix_type * A) {
+                            matrix_type * A,
+                            fmatrix_type * fA) {
 
   enkf_node_type * node = enkf_state_get_node( ensemble[iens] , key);
   node_id_type node_id = {.report_step = report_step, .iens = iens , .state = load_state };
-  enkf_node_serialize( node , fs , node_id , active_list , A , row_offset , column);
+  if (fA != NULL)
+    enkf_node_fmatrix_serialize( node , fs , node_id , active_list , fA , row_offset , column);
+  else
+    enkf_node_serialize( node , fs , node_id , active_list , A , row_offset , column);
 }
 
 
@@ -779,7 +832,8 @@ static void * serialize_nodes_mt( void * arg ) {
                       info->row_offset , 
                       column,
                       info->active_list , 
-                      info->A );
+                      info->A ,
+                      info->fA );
   }
   return NULL;
 }
@@ -810,6 +864,68 @@ static void enkf_main_serialize_node( const char * node_key ,
 
 
 
+/**
+   Parameters can be read from the packed ensemble matrix storage in
+   enkf_fs, also when only some of the elements are active in the
+   ministep. The packed files are only written when the parameter is
+   fully active, the node types are limited to those where
+   deserializing all the elements replaces the complete state of the
+   node. When the parameter is read from the packed storage the
+   individual nodes are not loaded.
+*/
+
+static bool enkf_main_use_packed_storage( const enkf_config_node_type * config_node ) {
+  if (enkf_config_node_get_var_type( config_node ) == PARAMETER) {
+    ert_impl_type impl_type = enkf_config_node_get_impl_type( config_node );
+    return ((impl_type == FIELD) || (impl_type == GEN_KW) || (impl_type == SURFACE));
+  }
+  return false;
+}
+
+
+static bool enkf_main_fwrite_packed_storage( const enkf_config_node_type * config_node , int active_size , int report_step) {
+  if (enkf_main_use_packed_storage( config_node ))
+    return (active_size == enkf_config_node_get_data_size( config_node , report_step ));
+  else
+    return false;
+}
+
+
+/*
+  FIELD parameters are internalized as float or double; the packed
+  file is stored with the same precision so the values read back from
+  it are identical to those read from the nodes.
+*/
+
+static bool enkf_main_packed_float_data( const enkf_config_node_type * config_node ) {
+  if (enkf_config_node_get_impl_type( config_node ) == FIELD) {
+    const field_config_type * field_config = enkf_config_node_get_ref( config_node );
+    return (field_config_get_ecl_type( field_config ) == ECL_FLOAT_TYPE);
+  } else
+    return false;
+}
+
+
+static bool enkf_main_serialize_packed( const enkf_config_node_type * config_node , 
+                                        state_enum load_state , 
+                                        const active_list_type * active_list , 
+                                        int row_offset , 
+                                        const serialize_info_type * serialize_info) {
+  if (enkf_main_use_packed_storage( config_node ))
+    return enkf_fs_fread_packed_parameter( serialize_info->src_fs , 
+                                           enkf_config_node_get_key( config_node ) , 
+                                           serialize_info->report_step , 
+                                           load_state , 
+                                           active_list , 
+                                           enkf_config_node_get_data_size( config_node , serialize_info->report_step ) , 
+                                           serialize_info->A , 
+                                           row_offset , 
+                                           serialize_info->iens_active_index );
+  else
+    return false;
+}
+
+
 /**
    The return value is the number of rows in the serialized
    A matrix. 
@@ -858,7 +974,8 @@ static int enkf_main_serialize_dataset( enkf_main_type * enkf_main,
         else
           load_state = ANALYZED;
         
-        enkf_main_serialize_node( key , load_state , active_list , row_offset[ikw] , work_pool , serialize_info );
+        if (!enkf_main_serialize_packed( config_node , load_state , active_list , row_offset[ikw] , serialize_info ))
+          enkf_main_serialize_node( key , load_state , active_list , row_offset[ikw] , work_pool , serialize_info );
         current_row += active_size[ikw];
       }
     }
@@ -869,6 +986,95 @@ static int enkf_main_serialize_dataset( enkf_main_type * enkf_main,
 }
 
 
+static void serialize_info_set_fmatrix( serialize_info_type * serialize_info , int num_cpu_threads , fmatrix_type * fA) {
+  int icpu;
+  for (icpu = 0; icpu < num_cpu_threads; icpu++)
+    serialize_info[icpu].fA = fA;
+}
+
+
+/**
+   Datasets where all the nodes are fields with float storage can be
+   updated with a single precision ensemble matrix. The serialized
+   values are exact in float, the A*X product is accumulated in double
+   and the result is rounded to float when it is deserialized - just
+   as with the double matrix - but the ensemble matrix only needs half
+   the memory.
+*/
+
+static bool enkf_main_dataset_is_float( const enkf_main_type * enkf_main , const local_dataset_type * dataset ) {
+  stringlist_type * update_keys = local_dataset_alloc_keys( dataset );
+  bool is_float = true;
+  
+  for (int ikw=0; ikw < stringlist_get_size( update_keys ); ikw++) {
+    const enkf_config_node_type * config_node = ensemble_config_get_node( enkf_main->ensemble_config , stringlist_iget( update_keys , ikw ));
+    if ((enkf_config_node_get_impl_type( config_node ) != FIELD) ||
+        (field_config_get_ecl_type( enkf_config_node_get_ref( config_node )) != ECL_FLOAT_TYPE)) {
+      is_float = false;
+      break;
+    }
+  }
+  stringlist_free( update_keys );
+  return is_float;
+}
+
+
+/**
+   As enkf_main_serialize_dataset(), but the dataset is serialized to
+   a fmatrix which is allocated here with the exact size; the fmatrix
+   is installed in the serialize_info and returned.
+*/
+
+static fmatrix_type * enkf_main_serialize_float_dataset( enkf_main_type * enkf_main, 
+                                                         const local_dataset_type * dataset ,
+                                                         int report_step,
+                                                         hash_type * use_count ,  
+                                                         int * active_size , 
+                                                         int * row_offset,
+                                                         thread_pool_type * work_pool,
+                                                         serialize_info_type * serialize_info ) {
+
+  stringlist_type * update_keys = local_dataset_alloc_keys( dataset );
+  const int num_kw  = stringlist_get_size( update_keys );
+  int ens_size      = matrix_get_columns( serialize_info->A );
+  int current_row   = 0;
+  fmatrix_type * A;
+  
+  for (int ikw=0; ikw < num_kw; ikw++) {
+    const char             * key         = stringlist_iget(update_keys , ikw);
+    enkf_config_node_type * config_node  = ensemble_config_get_node( enkf_main->ensemble_config , key );
+    if ((serialize_info[0].run_mode == SMOOTHER_UPDATE) && (enkf_config_node_get_var_type( config_node ) != PARAMETER))
+      active_size[ikw] = 0;
+    else {
+      const active_list_type * active_list = local_dataset_get_node_active_list( dataset , key );
+      active_size[ikw] = __get_active_size( enkf_main , key , report_step , active_list );
+      row_offset[ikw]  = current_row;
+      current_row     += active_size[ikw];
+    }
+  }
+  
+  A = fmatrix_alloc( current_row , ens_size );
+  serialize_info_set_fmatrix( serialize_info , thread_pool_get_max_running( work_pool ) , A );
+  
+  for (int ikw=0; ikw < num_kw; ikw++) {
+    if (active_size[ikw] > 0) {
+      const char * key = stringlist_iget(update_keys , ikw);
+      const active_list_type * active_list = local_dataset_get_node_active_list( dataset , key );
+      state_enum load_state;
+      
+      if (hash_inc_counter( use_count , key) == 0)
+        load_state = FORECAST;
+      else
+        load_state = ANALYZED;
+      
+      enkf_main_serialize_node( key , load_state , active_list , row_offset[ikw] , work_pool , serialize_info );
+    }
+  }
+  stringlist_free( update_keys ); 
+  return A;
+}
+
+
 
 
 static void deserialize_node( enkf_fs_type            * fs, 
@@ -879,11 +1085,15 @@ static void deserialize_node( enkf_fs_type            * fs,
                               int row_offset , 
                               int column,
                               const active_list_type * active_list,
-                              matrix_type * A) {
+                              matrix_type * A,
+                              fmatrix_type * fA) {
   
   enkf_node_type * node = enkf_state_get_node( ensemble[iens] , key);
   node_id_type node_id = { .report_step = target_step , .iens = iens , .state = ANALYZED };
-  enkf_node_deserialize(node , fs , node_id , active_list , A , row_offset , column);
+  if (fA != NULL)
+    enkf_node_fmatrix_deserialize(node , fs , node_id , active_list , fA , row_offset , column);
+  else
+    enkf_node_deserialize(node , fs , node_id , active_list , A , row_offset , column);
   state_map_update_undefined(enkf_fs_get_state_map(fs) , iens , STATE_INITIALIZED);
 }
 
@@ -895,7 +1105,7 @@ static void * deserialize_nodes_mt( void * arg ) {
   for (iens = info->iens1; iens < info->iens2; iens++) {
     int column = int_vector_iget( info->iens_active_index , iens );
     if (column >= 0)
-      deserialize_node( info->target_fs , info->ensemble , info->key , iens , info->target_step , info->row_offset , column, info->active_list , info->A );
+      deserialize_node( info->target_fs , info->ensemble , info->key , iens , info->target_step , info->row_offset , column, info->active_list , info->A , info->fA );
   }
   return NULL;
 }
@@ -905,6 +1115,7 @@ static void enkf_main_deserialize_dataset( ensemble_config_type * ensemble_confi
                                            const local_dataset_type * dataset , 
                                            const int * active_size , 
                                            const int * row_offset , 
+                                           bool packed_parameters , 
                                            serialize_info_type * serialize_info , 
                                            thread_pool_type * work_pool ) {
   
@@ -937,6 +1148,16 @@ static void enkf_main_deserialize_dataset( ensemble_config_type * ensemble_confi
           }
           thread_pool_join( work_pool );
         }
+
+        if (packed_parameters && enkf_main_fwrite_packed_storage( config_node , active_size[i] , serialize_info->target_step ))
+          enkf_fs_fwrite_packed_parameter( serialize_info->target_fs , 
+                                           key , 
+                                           serialize_info->target_step , 
+                                           serialize_info->A , 
+                                           row_offset[i] , 
+                                           active_size[i] , 
+                                           serialize_info->iens_active_index , 
+                                           enkf_main_packed_float_data( config_node ));
       }
     }
   }
@@ -971,6 +1192,7 @@ static serialize_info_type * serialize_info_alloc( enkf_fs_type * src_fs,
     serialize_info[icpu].ensemble    = ensemble;
     serialize_info[icpu].report_step = report_step;
     serialize_info[icpu].A           = A;
+    serialize_info[icpu].fA          = NULL;
     serialize_info[icpu].iens1       = iens_offset;
     serialize_info[icpu].iens2       = iens_offset + (ens_size - iens_offset) / (num_cpu_threads - icpu);
     iens_offset = serialize_info[icpu].iens2;
@@ -1099,6 +1321,24 @@ pca_plot_data_type * enkf_main_alloc_pca_plot_data( const enkf_main_type * enkf_
 
 
 
+/*
+  Iterable modules get the iteration number of the current case; for
+  iterative smoothers which keep state between updates (e.g. IES_ENKF)
+  iteration number zero will reset that state. Modules which keep
+  their state per ministep also get the name of the ministep.
+*/
+
+static void enkf_main_set_module_iteration( analysis_module_type * module , enkf_fs_type * fs , const local_ministep_type * ministep) {
+  int iteration = cases_config_get_iteration_number( enkf_fs_get_cases_config( fs ));
+  char iteration_str[15];
+  sprintf(iteration_str,"%d",iteration);
+  analysis_module_set_var( module , "NUM_ITER", iteration_str);
+
+  if (analysis_module_has_var( module , "MINISTEP" ))
+    analysis_module_set_var( module , "MINISTEP" , local_ministep_get_name( ministep ));
+}
+
+
 static void enkf_main_analysis_update( enkf_main_type * enkf_main , 
                                        enkf_fs_type * target_fs ,
                                        const bool_vector_type * ens_mask , 
@@ -1126,6 +1366,8 @@ static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
   matrix_type * D       = NULL;
   matrix_type * localA  = NULL;
   int_vector_type * iens_active_index = bool_vector_alloc_active_index_list(ens_mask , -1);
+  bool float_update     = !analysis_module_get_option( module , ANALYSIS_USE_A | ANALYSIS_UPDATE_A) && 
+                          !analysis_config_get_packed_parameters( enkf_main->analysis_config );
 
   if (analysis_module_get_option( module , ANALYSIS_NEED_ED)) {
     E = obs_data_allocE( obs_data , enkf_main->rng , ens_size , active_size );
@@ -1180,6 +1422,8 @@ static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
     }
     
     if (localA == NULL){
+      if (analysis_module_get_option( module , ANALYSIS_ITERABLE))
+        enkf_main_set_module_iteration( module , src_fs , ministep );
       analysis_module_initX( module , X , NULL , S , R , dObs , E , D );
     }
 
@@ -1190,31 +1434,44 @@ static void enkf_main_analysis_update( enkf_main_type * enkf_main ,
       if (local_dataset_get_size( dataset )) {
         int * active_size = util_calloc( local_dataset_get_size( dataset ) , sizeof * active_size );
         int * row_offset  = util_calloc( local_dataset_get_size( dataset ) , sizeof * row_offset  );
+        fmatrix_type * fA = NULL;
         
-        enkf_main_serialize_dataset( enkf_main , dataset , step2 ,  use_count , active_size , row_offset , tp , serialize_info);
-
-        if (analysis_module_get_option( module , ANALYSIS_UPDATE_A)){
-          if (analysis_module_get_option( module , ANALYSIS_ITERABLE)){
-            int iteration = cases_config_get_iteration_number(enkf_fs_get_cases_config(src_fs));
-            char iteration_str[15];
-            sprintf(iteration_str,"%d",iteration);
-            analysis_module_set_var( module , "NUM_ITER", iteration_str);
-            analysis_module_updateA( module , localA , S , R , dObs , E , D );
+        if (float_update && enkf_main_dataset_is_float( enkf_main , dataset )) {
+          fA = enkf_main_serialize_float_dataset( enkf_main , dataset , step2 ,  use_count , active_size , row_offset , tp , serialize_info);
+          fmatrix_inplace_matmul_mt2( fA , X , tp );
+        } else {
+          enkf_main_serialize_dataset( enkf_main , dataset , step2 ,  use_count , active_size , row_offset , tp , serialize_info);
+          
+          if (analysis_module_get_option( module , ANALYSIS_UPDATE_A)){
+            if (analysis_module_get_option( module , ANALYSIS_ITERABLE)){
+              enkf_main_set_module_iteration( module , src_fs , ministep );
+              analysis_module_updateA( module , localA , S , R , dObs , E , D );
+            }
+            else
+              analysis_module_updateA( module , localA , S , R , dObs , E , D );
           }
-          else
-            analysis_module_updateA( module , localA , S , R , dObs , E , D );
-        }
-        else {
-          if (analysis_module_get_option( module , ANALYSIS_USE_A)){
-            analysis_module_initX( module , X , localA , S , R , dObs , E , D );
+          else {
+            if (analysis_module_get_option( module , ANALYSIS_USE_A)){
+              analysis_module_initX( module , X , localA , S , R , dObs , E , D );
+            }
+            
+            matrix_inplace_matmul_mt2( A , X , tp );
           }
-
-          matrix_inplace_matmul_mt2( A , X , tp );
         }
        
         // The deserialize also calls enkf_node_store() functions.
-        enkf_main_deserialize_dataset( enkf_main_get_ensemble_config( enkf_main ) , dataset , active_size , row_offset , serialize_info , tp);
+        enkf_main_deserialize_dataset( enkf_main_get_ensemble_config( enkf_main ) , 
+                                       dataset , 
+                                       active_size , 
+                                       row_offset , 
+                                       analysis_config_get_packed_parameters( enkf_main->analysis_config ) , 
+                                       serialize_info , 
+                                       tp);
         
+        if (fA != NULL) {
+          serialize_info_set_fmatrix( serialize_info , cpu_threads , NULL );
+          fmatrix_free( fA );
+        }
         free( active_size );
         free( row_offset );
       }
@@ -1407,6 +1664,150 @@ static void enkf_main_report_load_failure( const enkf_main_type * enkf_main , in
 
 
 
+/*
+  Stores the resources used by the forward model of all the active
+  realisations in the current case, and logs the ensemble totals.
+*/
+
+static void enkf_main_fwrite_job_resources( enkf_main_type * enkf_main , const bool_vector_type * iactive , int step1) {
+  job_queue_type * job_queue = site_config_get_job_queue(enkf_main->site_config);
+  vector_type * resource_list = vector_alloc_new();
+  {
+    const int ens_size = enkf_main_get_ensemble_size( enkf_main );
+    for (int iens = 0; iens < ens_size; iens++) {
+      if (bool_vector_iget( iactive , iens )) {
+        int queue_index = enkf_state_get_queue_index( enkf_main->ensemble[iens] );
+        if (queue_index >= 0)
+          vector_iset_ref( resource_list , iens , job_queue_iget_job_resource( job_queue , queue_index ));
+      }
+    }
+  }
+  enkf_fs_fwrite_job_resources( enkf_main_get_fs( enkf_main ) , step1 , resource_list );
+
+  {
+    job_resource_type * total = job_queue_alloc_resource_summary( job_queue );
+    log_add_fmt_message( enkf_main->logh , 1 , NULL , "Forward model resources: %d jobs  cpu: %.0f s  wall: %.0f s  max rss: %ld kB" ,
+                         job_resource_get_num_jobs( total ) ,
+                         job_resource_get_cpu_seconds( total ) ,
+                         job_resource_get_wall_seconds( total ) ,
+                         job_resource_get_max_rss( total ));
+    job_resource_free( total );
+  }
+  vector_free( resource_list );
+}
+
+
+/**
+  Waits until there is room for one more realisation in the job
+  queue. The realisations which are currently being prepared are
+  counted as waiting, so that at most runpath_max_waiting prepared
+  realisations are waiting for a slot in the queue.
+*/
+
+static void enkf_main_wait_prepare( enkf_main_type * enkf_main , const job_queue_type * job_queue ) {
+  while (true) {
+    bool ready;
+    pthread_mutex_lock( &enkf_main->prepare_mutex );
+    {
+      ready = ((job_queue_get_num_waiting( job_queue ) + enkf_main->num_preparing) < enkf_main->runpath_max_waiting);
+      if (ready)
+        enkf_main->num_preparing++;
+    }
+    pthread_mutex_unlock( &enkf_main->prepare_mutex );
+
+    if (ready)
+      break;
+    else
+      usleep( 100000 );
+  }
+}
+
+
+/**
+  Prepares the runpath of one realisation and adds it to the job
+  queue; the realisations are handed to the queue as soon as they are
+  ready, so the first simulations start while the remaining runpath
+  directories are still being populated. The job_queue argument is
+  NULL in INIT_ONLY mode; there is then no back-pressure.
+*/
+
+static void * enkf_main_start_forward_model__( void * arg ) {
+  arg_pack_type * arg_pack     = arg_pack_safe_cast( arg );
+  enkf_main_type * enkf_main   = enkf_main_safe_cast( arg_pack_iget_ptr( arg_pack , 0 ));
+  enkf_state_type * enkf_state = arg_pack_iget_ptr( arg_pack , 1 );
+  enkf_fs_type * fs            = arg_pack_iget_ptr( arg_pack , 2 );
+  job_queue_type * job_queue   = arg_pack_iget_ptr( arg_pack , 3 );
+  bool back_pressure           = ((job_queue != NULL) && (enkf_main->runpath_max_waiting > 0));
+
+  if (back_pressure)
+    enkf_main_wait_prepare( enkf_main , job_queue );
+
+  {
+    arg_pack_type * state_arg = arg_pack_alloc( );   /* Discarded by enkf_state_start_forward_model__(). */
+    arg_pack_append_ptr( state_arg , enkf_state );
+    arg_pack_append_ptr( state_arg , fs );
+    enkf_state_start_forward_model__( state_arg );
+  }
+
+  if (back_pressure) {
+    pthread_mutex_lock( &enkf_main->prepare_mutex );
+    enkf_main->num_preparing--;
+    pthread_mutex_unlock( &enkf_main->prepare_mutex );
+  }
+
+  arg_pack_free( arg_pack );
+  return NULL;
+}
+
+
+/**
+  Loads the summary results of the running simulations every
+  summary_load_interval seconds, until the job_queue has completed and
+  enkf_main_set_load_running( false ) has been called;
+  the realisations are visited in turn by this one thread, so the
+  loading does not compete with the simulations for file system
+  bandwidth in bursts.
+*/
+
+static bool enkf_main_wait_load_running( enkf_main_type * enkf_main ) {
+  bool load_running;
+  pthread_mutex_lock( &enkf_main->load_mutex );
+  {
+    struct timespec deadline;
+    clock_gettime( CLOCK_REALTIME , &deadline );
+    deadline.tv_sec += enkf_main->summary_load_interval;
+    
+    while (enkf_main->load_running) {
+      if (pthread_cond_timedwait( &enkf_main->load_cond , &enkf_main->load_mutex , &deadline ) == ETIMEDOUT)
+        break;
+    }
+    load_running = enkf_main->load_running;
+  }
+  pthread_mutex_unlock( &enkf_main->load_mutex );
+  return load_running;
+}
+
+
+static void enkf_main_set_load_running( enkf_main_type * enkf_main , bool load_running ) {
+  pthread_mutex_lock( &enkf_main->load_mutex );
+  enkf_main->load_running = load_running;
+  pthread_cond_broadcast( &enkf_main->load_cond );
+  pthread_mutex_unlock( &enkf_main->load_mutex );
+}
+
+
+static void * enkf_main_load_running__( void * arg ) {
+  enkf_main_type * enkf_main = enkf_main_safe_cast( arg );
+  enkf_fs_type * fs          = enkf_main_get_fs( enkf_main );
+  
+  do {
+    for (int iens = 0; iens < enkf_main->ens_size; iens++)
+      enkf_state_internalize_running( enkf_main->ensemble[iens] , fs );
+  } while (enkf_main_wait_load_running( enkf_main ));
+  return NULL;
+}
+
+
 /**
   If all simulations have completed successfully the function will
   return true, otherwise it will return false.  
@@ -1463,15 +1864,18 @@ static void enkf_main_run_step(enkf_main_type * enkf_main       ,
         arg_pack_append_int(queue_args  , job_size);
         arg_pack_append_bool(queue_args , verbose_queue);
         job_queue_reset(job_queue);
+        job_queue_reserve(job_queue , job_size);    /* The queue should not have to grow while the jobs are being added. */
         pthread_create( &queue_thread , NULL , job_queue_run_jobs__ , queue_args);
       }
 
       
       {
-        thread_pool_type * submit_threads = thread_pool_alloc( 4 , true );
+        thread_pool_type * submit_threads = thread_pool_alloc( enkf_main->runpath_threads , true );
         enkf_fs_type * fs = enkf_main_get_fs( enkf_main );
         runpath_list_type * runpath_list = qc_module_get_runpath_list( enkf_main->qc_module );
         runpath_list_clear( runpath_list );
+        render_cache_clear( enkf_main->render_cache );   /* The templates and the datafile might have been edited since the previous step. */
+        enkf_main->num_preparing = 0;
         
         for (iens = 0; iens < ens_size; iens++) {
           enkf_state_type * enkf_state = enkf_main->ensemble[iens];
@@ -1496,12 +1900,14 @@ static void enkf_main_run_step(enkf_main_type * enkf_main       ,
                               enkf_state_get_run_path( enkf_state ) , 
                               enkf_state_get_eclbase( enkf_state ));
             {
-              arg_pack_type * arg_pack = arg_pack_alloc( );   // This is discarded by the enkf_state_start_forward_model__() function. */
+              arg_pack_type * arg_pack = arg_pack_alloc( );   // This is discarded by the enkf_main_start_forward_model__() function. */
               
+              arg_pack_append_ptr( arg_pack , enkf_main );
               arg_pack_append_ptr( arg_pack , enkf_state );
               arg_pack_append_ptr( arg_pack , fs );
+              arg_pack_append_ptr( arg_pack , (run_mode == INIT_ONLY) ? NULL : job_queue );
               
-              thread_pool_add_job(submit_threads , enkf_state_start_forward_model__ , arg_pack);
+              thread_pool_add_job(submit_threads , enkf_main_start_forward_model__ , arg_pack);
             }
           } else
             enkf_state_set_inactive( enkf_state );
@@ -1514,11 +1920,26 @@ static void enkf_main_run_step(enkf_main_type * enkf_main       ,
         qc_module_export_runpath_list( enkf_main->qc_module );
         thread_pool_join(submit_threads);        
         thread_pool_free(submit_threads);        
+        log_add_fmt_message(enkf_main->logh , 1 , NULL , "Runpath files: %d rendered, %d reused" , 
+                            render_cache_get_misses( enkf_main->render_cache ) , 
+                            render_cache_get_hits( enkf_main->render_cache ));
       }
       if (run_mode != INIT_ONLY) {
+        bool load_running = (enkf_main->summary_load_interval > 0);
+        pthread_t load_thread;
+        
         job_queue_submit_complete( job_queue );
         log_add_message(enkf_main->logh , 1 , NULL , "All jobs submitted to internal queue - waiting for completion" ,  false);
+        if (load_running) {
+          enkf_main_set_load_running( enkf_main , true );
+          pthread_create( &load_thread , NULL , enkf_main_load_running__ , enkf_main );
+        }
+        
         pthread_join( queue_thread , NULL );   /* Wait for the job_queue_run_jobs() function to complete. */
+        if (load_running) {
+          enkf_main_set_load_running( enkf_main , false );
+          pthread_join( load_thread , NULL );
+        }
       }
     }
 
@@ -1547,6 +1968,8 @@ static void enkf_main_run_step(enkf_main_type * enkf_main       ,
 
         }
       }
+      if (site_config_get_collect_job_resources( enkf_main->site_config ))
+        enkf_main_fwrite_job_resources( enkf_main , iactive , step1 );
       enkf_fs_fsync( enkf_main->dbase );
       if (totalOK) {
         log_add_fmt_message(enkf_main->logh , 1 , NULL , "All jobs complete and data loaded.");
@@ -2216,6 +2639,10 @@ static void enkf_main_init_user_config( const enkf_main_type * enkf_main , confi
   config_schema_item_set_argc_minmax(item , 1 , CONFIG_DEFAULT_ARG_MAX);
 
   config_add_key_value(config , PRE_CLEAR_RUNPATH_KEY , false , CONFIG_BOOL);
+  config_add_key_value(config , LINK_RUNPATH_FILES_KEY , false , CONFIG_BOOL);
+  config_add_key_value(config , RUNPATH_THREADS_KEY , false , CONFIG_INT);
+  config_add_key_value(config , RUNPATH_MAX_WAITING_KEY , false , CONFIG_INT);
+  config_add_key_value(config , SUMMARY_LOAD_INTERVAL_KEY , false , CONFIG_INT);
 
   item = config_add_schema_item(config , DELETE_RUNPATH_KEY , false  );
   config_schema_item_set_argc_minmax(item , 1 , CONFIG_DEFAULT_ARG_MAX);
@@ -2417,6 +2844,16 @@ enkf_main_type * enkf_main_alloc_empty( ) {
   enkf_main->subst_func_pool    = subst_func_pool_alloc(  );
   enkf_main->subst_list         = subst_list_alloc( enkf_main->subst_func_pool );
   enkf_main->templates          = ert_templates_alloc( enkf_main->subst_list );
+  enkf_main->render_cache       = render_cache_alloc( );
+  enkf_main->path_service       = path_service_alloc( DEFAULT_RUNPATH_THREADS );
+  enkf_main->runpath_threads    = DEFAULT_RUNPATH_THREADS;
+  enkf_main->runpath_max_waiting = DEFAULT_RUNPATH_MAX_WAITING;
+  enkf_main->summary_load_interval = DEFAULT_SUMMARY_LOAD_INTERVAL;
+  enkf_main->load_running       = false;
+  enkf_main->num_preparing      = 0;
+  pthread_mutex_init( &enkf_main->prepare_mutex , NULL );
+  pthread_mutex_init( &enkf_main->load_mutex , NULL );
+  pthread_cond_init( &enkf_main->load_cond , NULL );
   enkf_main->workflow_list      = ert_workflow_list_alloc( enkf_main->subst_list );
   enkf_main->qc_module          = qc_module_alloc( enkf_main->workflow_list , DEFAULT_QC_PATH );
   enkf_main->analysis_config    = analysis_config_alloc( enkf_main->rng );   
@@ -2522,6 +2959,8 @@ void enkf_main_resize_ensemble( enkf_main_type * enkf_main , int new_ens_size )
                                                    enkf_main->ecl_config                                        ,
                                                    enkf_main->logh                                              ,
                                                    enkf_main->templates                                         ,
+                                                   enkf_main->render_cache                                      ,
+                                                   enkf_main->path_service                                      ,
                                                    enkf_main->subst_list);
     enkf_main->ens_size = new_ens_size;
     return;
@@ -3006,6 +3445,30 @@ static void enkf_main_bootstrap_site(enkf_main_type * enkf_main , const char * s
 }
 
 
+/*
+  The tokenized user config files are cached in the hidden file
+  .<config>.cache next to the config file, see config_parse(). The
+  cache can be switched off by setting the environment variable
+  ERT_PARSE_CACHE to FALSE, e.g. when the config directory is shared
+  and should not be written to.
+*/
+
+static bool enkf_main_store_parse_cache( ) {
+  const char * env_value = getenv("ERT_PARSE_CACHE");
+  bool store_parse_cache = true;
+
+  if (env_value != NULL) {
+    bool env_bool;
+    if (util_sscanf_bool( env_value , &env_bool ))
+      store_parse_cache = env_bool;
+    else
+      fprintf(stderr , "** Warning: ERT_PARSE_CACHE=%s is not a boolean value - ignored.\n" , env_value);
+  }
+
+  return store_parse_cache;
+}
+
+
 /**
    This function boots everything needed for running a EnKF
    application. Very briefly it can be summarized as follows:
@@ -3098,6 +3561,7 @@ enkf_main_type * enkf_main_bootstrap(const char * _site_config, const char * _mo
     enkf_main_init_user_config( enkf_main , config );
     site_config_add_config_items( config , false );
     site_config_init_user_mode( enkf_main->site_config );
+    config_set_store_parse_cache( config , enkf_main_store_parse_cache( ));
     
     if (!config_parse(config , model_config , "--" , INCLUDE_KEY , DEFINE_KEY , CONFIG_UNRECOGNIZED_WARN , true)) {
       config_fprintf_errors( config , true , stderr );
@@ -3201,6 +3665,19 @@ enkf_main_type * enkf_main_bootstrap(const char * _site_config, const char * _mo
         enkf_main->pre_clear_runpath = DEFAULT_PRE_CLEAR_RUNPATH;
         if (config_item_set(config , PRE_CLEAR_RUNPATH_KEY))
           enkf_main->pre_clear_runpath = config_get_value_as_bool( config , PRE_CLEAR_RUNPATH_KEY);
+
+        render_cache_set_hardlink( enkf_main->render_cache , DEFAULT_LINK_RUNPATH_FILES );
+        if (config_item_set(config , LINK_RUNPATH_FILES_KEY))
+          render_cache_set_hardlink( enkf_main->render_cache , config_get_value_as_bool( config , LINK_RUNPATH_FILES_KEY));
+
+        if (config_item_set(config , RUNPATH_THREADS_KEY))
+          enkf_main_set_runpath_threads( enkf_main , config_get_value_as_int( config , RUNPATH_THREADS_KEY));
+
+        if (config_item_set(config , RUNPATH_MAX_WAITING_KEY))
+          enkf_main_set_runpath_max_waiting( enkf_main , config_get_value_as_int( config , RUNPATH_MAX_WAITING_KEY));
+
+        if (config_item_set(config , SUMMARY_LOAD_INTERVAL_KEY))
+          enkf_main_set_summary_load_interval( enkf_main , config_get_value_as_int( config , SUMMARY_LOAD_INTERVAL_KEY));
       }
 
 
@@ -3628,6 +4105,29 @@ ert_report_list_type * enkf_main_get_report_list( const enkf_main_type * enkf_ma
 void enkf_main_fprintf_runpath_config( const enkf_main_type * enkf_main , FILE * stream ) {
   fprintf(stream , CONFIG_KEY_FORMAT      , PRE_CLEAR_RUNPATH_KEY );
   fprintf(stream , CONFIG_ENDVALUE_FORMAT , CONFIG_BOOL_STRING( enkf_state_get_pre_clear_runpath( enkf_main->ensemble[0] )));
+
+  if (render_cache_get_hardlink( enkf_main->render_cache ) != DEFAULT_LINK_RUNPATH_FILES) {
+    fprintf(stream , CONFIG_KEY_FORMAT      , LINK_RUNPATH_FILES_KEY );
+    fprintf(stream , CONFIG_ENDVALUE_FORMAT , CONFIG_BOOL_STRING( render_cache_get_hardlink( enkf_main->render_cache )));
+  }
+
+  if (enkf_main->runpath_threads != DEFAULT_RUNPATH_THREADS) {
+    fprintf(stream , CONFIG_KEY_FORMAT      , RUNPATH_THREADS_KEY );
+    fprintf(stream , CONFIG_INT_FORMAT      , enkf_main->runpath_threads );
+    fprintf(stream , "\n");
+  }
+
+  if (enkf_main->runpath_max_waiting != DEFAULT_RUNPATH_MAX_WAITING) {
+    fprintf(stream , CONFIG_KEY_FORMAT      , RUNPATH_MAX_WAITING_KEY );
+    fprintf(stream , CONFIG_INT_FORMAT      , enkf_main->runpath_max_waiting );
+    fprintf(stream , "\n");
+  }
+
+  if (enkf_main->summary_load_interval != DEFAULT_SUMMARY_LOAD_INTERVAL) {
+    fprintf(stream , CONFIG_KEY_FORMAT      , SUMMARY_LOAD_INTERVAL_KEY );
+    fprintf(stream , CONFIG_INT_FORMAT      , enkf_main->summary_load_interval );
+    fprintf(stream , "\n");
+  }
   
   {
     bool keep_comma = false;
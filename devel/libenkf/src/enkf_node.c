@@ -810,6 +810,34 @@ void enkf_node_deserialize(enkf_node_type *enkf_node , enkf_fs_type * fs , node_
 }
 
 
+/*
+  The single precision ensemble matrix is only used for FIELD nodes
+  with float storage; see enkf_main_analysis_update().
+*/
+
+void enkf_node_fmatrix_serialize(enkf_node_type *enkf_node , enkf_fs_type * fs, node_id_type node_id ,
+                                 const active_list_type * active_list , fmatrix_type * A , int row_offset , int column) {
+
+  if (enkf_node_get_impl_type( enkf_node ) != FIELD)
+    util_abort("%s: only FIELD nodes can be serialized to a fmatrix \n",__func__);
+
+  enkf_node_load( enkf_node , fs , node_id);
+  field_fmatrix_serialize( enkf_node->data , active_list , A , row_offset , column);
+}
+
+
+void enkf_node_fmatrix_deserialize(enkf_node_type *enkf_node , enkf_fs_type * fs , node_id_type node_id,
+                                   const active_list_type * active_list , const fmatrix_type * A , int row_offset , int column) {
+
+  if (enkf_node_get_impl_type( enkf_node ) != FIELD)
+    util_abort("%s: only FIELD nodes can be deserialized from a fmatrix \n",__func__);
+
+  field_fmatrix_deserialize( enkf_node->data , active_list , A , row_offset , column);
+  enkf_node->__modified = true;
+  enkf_node_store( enkf_node , fs , true , node_id );
+}
+
+
 
 void enkf_node_set_inflation( enkf_node_type * inflation , const enkf_node_type * std , const enkf_node_type * min_std) {
   {
@@ -19,10 +19,14 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <unistd.h>
 
 #include <ert/util/hash.h>
 #include <ert/util/util.h>
 #include <ert/util/msg.h>
+#include <ert/util/vector.h>
+#include <ert/util/arg_pack.h>
+#include <ert/util/thread_pool.h>
 
 #include <ert/config/conf.h>
 
@@ -190,6 +194,7 @@ struct enkf_obs_struct {
   time_t_vector_type  * obs_time;     /* For fast lookup of report_step -> obs_time */
   const history_type  * history;      /* A shared (not owned by enkf_obs) reference to the history object - used when
                                          adding HISTORY observations. */
+  int                   num_threads;  /* The max number of threads loading the HISTORY_OBSERVATION instances. */
 };
 
 
@@ -207,10 +212,24 @@ enkf_obs_type * enkf_obs_alloc(  )
 
   enkf_obs->history        = NULL;
   enkf_obs->config_file    = NULL; 
+  enkf_obs->num_threads    = util_int_max( 1 , sysconf( _SC_NPROCESSORS_ONLN ));
   return enkf_obs;
 }
 
 
+void enkf_obs_set_num_threads( enkf_obs_type * enkf_obs , int num_threads) {
+  if (num_threads > 0)
+    enkf_obs->num_threads = num_threads;
+  else
+    util_abort("%s: invalid number of threads:%d \n",__func__ , num_threads);
+}
+
+
+int enkf_obs_get_num_threads( const enkf_obs_type * enkf_obs ) {
+  return enkf_obs->num_threads;
+}
+
+
 
 bool enkf_obs_have_obs( const enkf_obs_type * enkf_obs ) {
   return enkf_obs->have_obs;
@@ -506,6 +525,80 @@ void enkf_obs_reload( enkf_obs_type * enkf_obs ,
 
 
 
+/**
+   Loading the HISTORY_OBSERVATION instances is dominated by
+   extracting the time series from the history object; the
+   observations are independent of each other and are loaded in
+   parallel with at most @max_threads threads. Each thread handles a
+   contiguous range of observations, and only writes to its own
+   obs_vector instances and elements of @loadOK.
+*/
+
+static void * enkf_obs_load_history_observations__( void * arg ) {
+  arg_pack_type * arg_pack                 = arg_pack_safe_cast( arg );
+  const conf_instance_type * enkf_conf     = arg_pack_iget_const_ptr( arg_pack , 0 );
+  const stringlist_type * hist_obs_keys    = arg_pack_iget_const_ptr( arg_pack , 1 );
+  vector_type * obs_vector_list            = arg_pack_iget_ptr( arg_pack , 2 );
+  const history_type * history             = arg_pack_iget_const_ptr( arg_pack , 3 );
+  ensemble_config_type * ensemble_config   = arg_pack_iget_ptr( arg_pack , 4 );
+  double std_cutoff                        = arg_pack_iget_double( arg_pack , 5 );
+  bool * loadOK                            = arg_pack_iget_ptr( arg_pack , 6 );
+  int obs_nr1                              = arg_pack_iget_int( arg_pack , 7 );
+  int obs_nr2                              = arg_pack_iget_int( arg_pack , 8 );
+
+  for (int hist_obs_nr = obs_nr1; hist_obs_nr < obs_nr2; hist_obs_nr++) {
+    obs_vector_type * obs_vector = vector_iget( obs_vector_list , hist_obs_nr );
+    if (obs_vector != NULL) {
+      const conf_instance_type * hist_obs_conf = conf_instance_get_sub_instance_ref(enkf_conf, stringlist_iget( hist_obs_keys , hist_obs_nr ));
+      loadOK[hist_obs_nr] = obs_vector_load_from_HISTORY_OBSERVATION(obs_vector , hist_obs_conf , history , ensemble_config , std_cutoff );
+    }
+  }
+  return NULL;
+}
+
+
+static void enkf_obs_load_history_observations( const conf_instance_type * enkf_conf , 
+                                                const stringlist_type * hist_obs_keys , 
+                                                vector_type * obs_vector_list , 
+                                                const history_type * history , 
+                                                ensemble_config_type * ensemble_config , 
+                                                double std_cutoff , 
+                                                int max_threads , 
+                                                bool * loadOK) {
+  const int num_hist_obs         = stringlist_get_size( hist_obs_keys );
+  const int num_threads          = util_int_min( max_threads , util_int_max( 1 , num_hist_obs ));
+  const int block_size           = num_hist_obs / num_threads;
+  thread_pool_type * tp          = thread_pool_alloc( num_threads , true );
+  arg_pack_type ** arg_pack_list = util_calloc( num_threads , sizeof * arg_pack_list );
+  
+  for (int ithread = 0; ithread < num_threads; ithread++) {
+    arg_pack_type * arg_pack = arg_pack_alloc();
+    int obs_nr1 = ithread * block_size;
+    int obs_nr2 = (ithread == (num_threads - 1)) ? num_hist_obs : obs_nr1 + block_size;
+
+    arg_pack_append_const_ptr( arg_pack , enkf_conf );
+    arg_pack_append_const_ptr( arg_pack , hist_obs_keys );
+    arg_pack_append_ptr( arg_pack , obs_vector_list );
+    arg_pack_append_const_ptr( arg_pack , history );
+    arg_pack_append_ptr( arg_pack , ensemble_config );
+    arg_pack_append_double( arg_pack , std_cutoff );
+    arg_pack_append_ptr( arg_pack , loadOK );
+    arg_pack_append_int( arg_pack , obs_nr1 );
+    arg_pack_append_int( arg_pack , obs_nr2 );
+
+    arg_pack_list[ithread] = arg_pack;
+    thread_pool_add_job( tp , enkf_obs_load_history_observations__ , arg_pack );
+  }
+  thread_pool_join( tp );
+  thread_pool_free( tp );
+
+  for (int ithread = 0; ithread < num_threads; ithread++)
+    arg_pack_free( arg_pack_list[ithread] );
+  free( arg_pack_list );
+}
+
+
+
 /**
    This function will load an observation configuration from the
    observation file @config_file. 
@@ -547,34 +640,39 @@ void enkf_obs_load(enkf_obs_type * enkf_obs ,
       
       /** Handle HISTORY_OBSERVATION instances. */
       {
-        stringlist_type * hist_obs_keys = conf_instance_alloc_list_of_sub_instances_of_class_by_name(enkf_conf, "HISTORY_OBSERVATION");
-        int               num_hist_obs  = stringlist_get_size(hist_obs_keys);
+        stringlist_type * hist_obs_keys   = conf_instance_alloc_list_of_sub_instances_of_class_by_name(enkf_conf, "HISTORY_OBSERVATION");
+        int               num_hist_obs    = stringlist_get_size(hist_obs_keys);
+        vector_type     * obs_vector_list = vector_alloc_NULL_initialized( num_hist_obs );
+        bool            * loadOK          = util_calloc( num_hist_obs , sizeof * loadOK );
         
+        /* Adding the summary nodes modifies the ensemble_config - this is done serially. */
         for(int hist_obs_nr = 0; hist_obs_nr < num_hist_obs; hist_obs_nr++) {
-          const char               * obs_key       = stringlist_iget(hist_obs_keys, hist_obs_nr);
-          const conf_instance_type * hist_obs_conf = conf_instance_get_sub_instance_ref(enkf_conf, obs_key);
-          obs_vector_type * obs_vector;
-          enkf_config_node_type * config_node;
-          
-          config_node = ensemble_config_add_summary( ensemble_config , obs_key , LOAD_FAIL_WARN );
+          const char * obs_key = stringlist_iget(hist_obs_keys, hist_obs_nr);
+          enkf_config_node_type * config_node = ensemble_config_add_summary( ensemble_config , obs_key , LOAD_FAIL_WARN );
           if (config_node != NULL) {
-            obs_vector = obs_vector_alloc( SUMMARY_OBS , obs_key , ensemble_config_get_node( ensemble_config , obs_key ), last_report);
-            if (obs_vector != NULL) {
-              if (obs_vector_load_from_HISTORY_OBSERVATION(obs_vector , 
-                                                           hist_obs_conf , 
-                                                           enkf_obs->history ,
-                                                           ensemble_config,
-                                                           std_cutoff ))
-                enkf_obs_add_obs_vector(enkf_obs, obs_key, obs_vector);
-              else {
-                fprintf(stderr,"** Could not load historical data for observation:%s - ignored\n",obs_key);
-                obs_vector_free( obs_vector );
-              }
-            }
+            obs_vector_type * obs_vector = obs_vector_alloc( SUMMARY_OBS , obs_key , ensemble_config_get_node( ensemble_config , obs_key ), last_report);
+            vector_iset_ref( obs_vector_list , hist_obs_nr , obs_vector );
           } else 
             fprintf(stderr,"** Warning: summary:%s does not exist - observation:%s not added. \n", obs_key , obs_key);
         }
+
+        enkf_obs_load_history_observations( enkf_conf , hist_obs_keys , obs_vector_list , enkf_obs->history , ensemble_config , std_cutoff , enkf_obs->num_threads , loadOK );
+        
+        for(int hist_obs_nr = 0; hist_obs_nr < num_hist_obs; hist_obs_nr++) {
+          const char * obs_key = stringlist_iget(hist_obs_keys, hist_obs_nr);
+          obs_vector_type * obs_vector = vector_iget( obs_vector_list , hist_obs_nr );
+          if (obs_vector != NULL) {
+            if (loadOK[hist_obs_nr])
+              enkf_obs_add_obs_vector(enkf_obs, obs_key, obs_vector);
+            else {
+              fprintf(stderr,"** Could not load historical data for observation:%s - ignored\n",obs_key);
+              obs_vector_free( obs_vector );
+            }
+          }
+        }
         
+        free( loadOK );
+        vector_free( obs_vector_list );
         stringlist_free(hist_obs_keys);
       }
       
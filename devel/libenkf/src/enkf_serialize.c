@@ -18,6 +18,7 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <ert/util/util.h>
 
@@ -274,3 +275,51 @@ void enkf_matrix_deserialize(void * __node_data                 ,
     util_abort("%s: internal error: trying to serialize unserializable type:%s \n",__func__ , ecl_util_get_type_name( node_type ));
 }
                            
+
+
+/*
+  Single precision variants used when the ensemble matrix is stored as
+  a fmatrix; the node data must already be float, so the values are
+  copied without any conversion.
+*/
+
+void enkf_fmatrix_serialize(const float * node_data                 ,
+                            int node_size                           ,
+                            const active_list_type * __active_list  ,
+                            fmatrix_type * A                        ,
+                            int row_offset                          ,
+                            int column) {
+
+  const int * active_list = active_list_get_active( __active_list );
+  int active_size         = active_list_get_active_size( __active_list , node_size );
+  float * column_data     = &fmatrix_get_data( A )[ row_offset + (size_t) column * fmatrix_get_column_stride( A )];
+
+  if (active_size == node_size) /** All elements active */
+    memcpy( column_data , node_data , node_size * sizeof * node_data );
+  else {
+    int row_index;
+    for (row_index = 0; row_index < active_size; row_index++)
+      column_data[ row_index ] = node_data[ active_list[ row_index ]];
+  }
+}
+
+
+void enkf_fmatrix_deserialize(float * node_data                     ,
+                              int node_size                         ,
+                              const active_list_type * __active_list ,
+                              const fmatrix_type * A                ,
+                              int row_offset                        ,
+                              int column) {
+
+  const int * active_list   = active_list_get_active( __active_list );
+  int active_size           = active_list_get_active_size( __active_list , node_size );
+  const float * column_data = &fmatrix_get_data( A )[ row_offset + (size_t) column * fmatrix_get_column_stride( A )];
+
+  if (active_size == node_size) /** All elements active */
+    memcpy( node_data , column_data , node_size * sizeof * node_data );
+  else {
+    int row_index;
+    for (row_index = 0; row_index < active_size; row_index++)
+      node_data[ active_list[ row_index ]] = column_data[ row_index ];
+  }
+}
@@ -38,6 +38,8 @@
 #include <ert/util/timer.h>
 #include <ert/util/time_t_vector.h>
 #include <ert/util/rng.h>
+#include <ert/util/render_cache.h>
+#include <ert/util/path_service.h>
 
 #include <ert/ecl/fortio.h>
 #include <ert/ecl/ecl_kw.h>
@@ -99,6 +101,10 @@ typedef struct run_info_struct {
   char                  * run_path;             /* The currently used  runpath - is realloced / freed for every step. */
   run_mode_type           run_mode;             /* What type of run this is */
   int                     queue_index;          /* The job will in general have a different index in the queue than the iens number. */
+  ecl_sum_type          * tail_summary;         /* Summary results loaded incrementally while the simulation is running - can be NULL. */
+  time_t                  tail_sim_start;       /* The sim_start of the job when the tail_summary was allocated. */
+  int                     tail_load_step;       /* The last report step which has been internalized from the tail_summary. */
+  bool                    tail_closed;          /* No more incremental loading for this run. */
   /******************************************************************/
   /* Return value - set by the called routine!!  */
   run_status_type         run_status;
@@ -126,6 +132,8 @@ typedef struct shared_info_struct {
   const site_config_type      * site_config;
   log_type                    * logh;              /* The log handle. */
   ert_templates_type          * templates; 
+  render_cache_type           * render_cache;      /* Cache of rendered runpath files - shared by all the realisations. */
+  path_service_type           * path_service;      /* Background deletion of old runpath directories. */
   const ecl_config_type       * ecl_config;
 } shared_info_type;
 
@@ -149,6 +157,7 @@ struct enkf_state_struct {
   shared_info_type      * shared_info;             /* Pointers to shared objects which is needed by the enkf_state object (read only). */
   member_config_type    * my_config;               /* Private config information for this member; not updated during a simulation. */
   rng_type              * rng;
+  pthread_mutex_t         load_mutex;              /* Serializes the incremental loading with the final load. */
 };
 
 /*****************************************************************/
@@ -229,12 +238,24 @@ static void run_info_set(run_info_type * run_info        ,
 
 static run_info_type * run_info_alloc() {
   run_info_type * run_info = util_malloc(sizeof * run_info );
-  run_info->run_path = NULL;
+  run_info->run_path       = NULL;
+  run_info->tail_summary   = NULL;
+  run_info->tail_load_step = -1;
+  run_info->tail_closed    = true;
   return run_info;
 }
 
 
+static void run_info_free_tail_summary(run_info_type * run_info) {
+  if (run_info->tail_summary != NULL) {
+    ecl_sum_free( run_info->tail_summary );
+    run_info->tail_summary = NULL;
+  }
+}
+
+
 static void run_info_free(run_info_type * run_info) {
+  run_info_free_tail_summary( run_info );
   util_safe_free(run_info->run_path);
   free(run_info);
 }
@@ -250,7 +271,7 @@ static void run_info_complete_run(run_info_type * run_info) {
 
 /*****************************************************************/
 
-static shared_info_type * shared_info_alloc(const site_config_type * site_config , model_config_type * model_config, const ecl_config_type * ecl_config , log_type * logh , ert_templates_type * templates) {
+static shared_info_type * shared_info_alloc(const site_config_type * site_config , model_config_type * model_config, const ecl_config_type * ecl_config , log_type * logh , ert_templates_type * templates , render_cache_type * render_cache , path_service_type * path_service) {
   shared_info_type * shared_info = util_malloc(sizeof * shared_info );
 
   shared_info->joblist      = site_config_get_installed_jobs( site_config );
@@ -259,6 +280,8 @@ static shared_info_type * shared_info_alloc(const site_config_type * site_config
   shared_info->model_config = model_config;
   shared_info->logh         = logh;
   shared_info->templates    = templates;
+  shared_info->render_cache = render_cache;
+  shared_info->path_service = path_service;
   shared_info->ecl_config   = ecl_config;
   return shared_info;
 }
@@ -467,14 +490,17 @@ enkf_state_type * enkf_state_alloc(int iens,
                                    const ecl_config_type     * ecl_config,
                                    log_type                  * logh,
                                    ert_templates_type        * templates,
+                                   render_cache_type         * render_cache,
+                                   path_service_type         * path_service,
                                    subst_list_type           * subst_parent) { 
   
   enkf_state_type * enkf_state  = util_malloc(sizeof *enkf_state );
   UTIL_TYPE_ID_INIT( enkf_state , ENKF_STATE_TYPE_ID );
 
   enkf_state->ensemble_config   = ensemble_config;
-  enkf_state->shared_info       = shared_info_alloc(site_config , model_config , ecl_config , logh, templates);
+  enkf_state->shared_info       = shared_info_alloc(site_config , model_config , ecl_config , logh, templates , render_cache , path_service);
   enkf_state->run_info          = run_info_alloc();
+  pthread_mutex_init( &enkf_state->load_mutex , NULL );
   
   enkf_state->node_hash         = hash_alloc();
   enkf_state->restart_kw_list   = stringlist_alloc_new();
@@ -602,6 +628,31 @@ const char * enkf_state_get_eclbase( const enkf_state_type * enkf_state ) {
 }
 
 
+/*
+  Checks that the summary reaches the END_DATE configured in the
+  ecl_config; if the summary vector is shorter than expected we
+  interpret this as a simulation failure.
+*/
+
+static bool enkf_state_check_end_date(const enkf_state_type * enkf_state , const ecl_sum_type * summary , stringlist_type * messages) {
+  const ecl_config_type * ecl_config = enkf_state->shared_info->ecl_config;
+  time_t end_time = ecl_config_get_end_date( ecl_config );
+  if ((end_time > 0) && (ecl_sum_get_end_time( summary ) < end_time)) {
+    int end_day,end_month,end_year;
+    int sum_day,sum_month,sum_year;
+    
+    util_set_date_values( end_time , &end_day , &end_month , &end_year );
+    util_set_date_values( ecl_sum_get_end_time( summary ) , &sum_day , &sum_month , &sum_year );
+    stringlist_append_owned_ref( messages , 
+                                 util_alloc_sprintf("Summary ended at %02d/%02d/%4d - expected at least END_DATE: %02d/%02d/%4d" , 
+                                                    sum_day , sum_month , sum_year , 
+                                                    end_day , end_month , end_year ));
+    return false;
+  } else
+    return true;
+}
+
+
 static ecl_sum_type * enkf_state_load_ecl_sum(const enkf_state_type * enkf_state , stringlist_type * messages , int * result) {
   const run_info_type * run_info         = enkf_state->run_info;
   const ecl_config_type * ecl_config     = enkf_state->shared_info->ecl_config;
@@ -645,28 +696,10 @@ static ecl_sum_type * enkf_state_load_ecl_sum(const enkf_state_type * enkf_state
   
   if ((header_file != NULL) && (stringlist_get_size(data_files) > 0)) {
     summary = ecl_sum_fread_alloc(header_file , data_files , SUMMARY_KEY_JOIN_STRING );
-    {
-      time_t end_time = ecl_config_get_end_date( ecl_config );
-      if (end_time > 0) {
-        if (ecl_sum_get_end_time( summary ) < end_time) {
-          /* The summary vector was shorter than expected; we interpret this as
-             a simulation failure and discard the current summary instance. */
-          {
-            int end_day,end_month,end_year;
-            int sum_day,sum_month,sum_year;
-            
-            util_set_date_values( end_time , &end_day , &end_month , &end_year );
-            util_set_date_values( ecl_sum_get_end_time( summary ) , &sum_day , &sum_month , &sum_year );
-            stringlist_append_owned_ref( messages , 
-                                         util_alloc_sprintf("Summary ended at %02d/%02d/%4d - expected at least END_DATE: %02d/%02d/%4d" , 
-                                                            sum_day , sum_month , sum_year , 
-                                                            end_day , end_month , end_year ));
-          }
-          ecl_sum_free( summary );
-          summary = NULL;
-          *result |= LOAD_FAILURE; 
-        }
-      }
+    if (!enkf_state_check_end_date( enkf_state , summary , messages )) {
+      ecl_sum_free( summary );
+      summary = NULL;
+      *result |= LOAD_FAILURE; 
     }
   }
   stringlist_free( data_files );
@@ -702,16 +735,207 @@ static bool enkf_state_report_step_compatible(const enkf_state_type * enkf_state
 
 
 
+/*****************************************************************/
+
+/**
+   Incremental loading of the summary results while the simulation is
+   running. The simulator appends to the unified summary file as it
+   goes, and enkf_state_internalize_running() is called regularly from
+   the enkf_main layer to read the new part of the file and store the
+   completed report steps of the SUMMARY nodes. When the job has
+   completed the final load only has to read the tail of the file and
+   internalize the report steps which have not been stored already.
+
+   The incremental loading is only used for the first attempt of a
+   run, and only for unformatted unified summary files; retried runs
+   and other file layouts are loaded in one go when the job is
+   complete. Files older than the submit time of the job are left
+   alone - they are from a previous run in the same runpath.
+*/
+
+static void enkf_state_reset_tail_summary(enkf_state_type * enkf_state , bool closed) {
+  run_info_type * run_info = enkf_state->run_info;
+  pthread_mutex_lock( &enkf_state->load_mutex );
+  {
+    run_info_free_tail_summary( run_info );
+    run_info->tail_load_step = -1;
+    run_info->tail_closed    = closed;
+  }
+  pthread_mutex_unlock( &enkf_state->load_mutex );
+}
+
+
+static bool enkf_state_fresh_file(const char * filename , time_t submit_time) {
+  if ((filename != NULL) && util_file_exists( filename ))
+    return (util_file_mtime( filename ) >= submit_time);
+  else
+    return false;
+}
+
+
+static void enkf_state_alloc_tail_summary(enkf_state_type * enkf_state , time_t sim_start) {
+  run_info_type * run_info               = enkf_state->run_info;
+  const shared_info_type * shared_info   = enkf_state->shared_info;
+  const char * eclbase                   = enkf_state_get_eclbase( enkf_state );
+  char * header_file                     = ecl_util_alloc_filename(run_info->run_path , eclbase , ECL_SUMMARY_HEADER_FILE , false , -1);
+  char * unified_file                    = ecl_util_alloc_filename(run_info->run_path , eclbase , ECL_UNIFIED_SUMMARY_FILE , false , -1);
+  time_t submit_time                     = job_queue_iget_submit_time( shared_info->job_queue , run_info->queue_index );
+
+  if (enkf_state_fresh_file( header_file , submit_time ) && enkf_state_fresh_file( unified_file , submit_time )) {
+    if (fortio_check_file( header_file , ECL_ENDIAN_FLIP ) == FORTIO_OK) {
+      run_info->tail_summary   = ecl_sum_fread_alloc_tail( header_file , SUMMARY_KEY_JOIN_STRING );
+      run_info->tail_sim_start = sim_start;
+    }
+  }
+
+  free( header_file );
+  free( unified_file );
+}
+
+
+/*
+  Internalizes the SUMMARY nodes for the report steps which are
+  complete in the tail_summary; the last report step in the summary
+  might still be incomplete and is left for the next round. The
+  tail_load_step watermark is only advanced if all the nodes were
+  loaded successfully.
+*/
+
+static void enkf_state_internalize_tail_summary(enkf_state_type * enkf_state , enkf_fs_type * fs) {
+  run_info_type * run_info = enkf_state->run_info;
+  const ecl_sum_type * summary = run_info->tail_summary;
+  
+  if (ecl_sum_get_data_length( summary ) > 0) {
+    const int iens  = member_config_get_iens( enkf_state->my_config );
+    const int step1 = util_int_max( util_int_max( run_info->load_start , 1 ) , run_info->tail_load_step + 1);
+    const int step2 = ecl_sum_get_last_report_step( summary ) - 1;
+    
+    if (step2 >= step1) {
+      bool loadOK = true;
+      hash_iter_type * iter = hash_iter_alloc( enkf_state->node_hash );
+      while ( !hash_iter_is_complete(iter) ) {
+        enkf_node_type * node = hash_iter_get_next_value(iter);
+        if ((enkf_node_get_var_type(node) == DYNAMIC_RESULT) && (enkf_node_get_impl_type(node) == SUMMARY)) {
+          if (enkf_node_vector_storage( node )) {
+            enkf_node_try_load_vector( node , fs , iens , FORECAST );
+            if (enkf_node_forward_load_vector( node , run_info->run_path , summary , NULL , step1 , step2 , iens))
+              enkf_node_store_vector( node , fs , iens , FORECAST );
+            else
+              loadOK = false;
+          } else {
+            for (int report_step = step1; report_step <= step2; report_step++) {
+              if (enkf_node_forward_load(node , run_info->run_path , summary , NULL , report_step , iens)) {
+                node_id_type node_id = {.report_step = report_step, .iens = iens , .state = FORECAST };
+                enkf_node_store(node , fs , (report_step == step2) , node_id);
+              } else
+                loadOK = false;
+            }
+          }
+        }
+      }
+      hash_iter_free(iter);
+      
+      if (loadOK)
+        run_info->tail_load_step = step2;
+    }
+  }
+}
+
+
+/**
+   Loads the new summary results of a running simulation; does
+   nothing if the job is not running.
+*/
+
+void enkf_state_internalize_running(enkf_state_type * enkf_state , enkf_fs_type * fs) {
+  run_info_type * run_info             = enkf_state->run_info;
+  const shared_info_type * shared_info = enkf_state->shared_info;
+  const ecl_config_type * ecl_config   = shared_info->ecl_config;
+
+  if (!ecl_config_active( ecl_config ) || ecl_config_get_formatted( ecl_config ))
+    return;
+
+  if (enkf_state_get_run_status( enkf_state ) != JOB_QUEUE_RUNNING)
+    return;
+
+  pthread_mutex_lock( &enkf_state->load_mutex );
+  if (!run_info->tail_closed) {
+    time_t sim_start = job_queue_iget_sim_start( shared_info->job_queue , run_info->queue_index );
+    
+    if (run_info->tail_summary == NULL)
+      enkf_state_alloc_tail_summary( enkf_state , sim_start );
+    else if (sim_start != run_info->tail_sim_start) {
+      /* The queue has restarted the job; the rest is left for the final load. */
+      run_info_free_tail_summary( run_info );
+      run_info->tail_closed = true;
+    }
+    
+    if (run_info->tail_summary != NULL) {
+      if (ecl_sum_fread_tail( run_info->tail_summary ) >= 0)
+        enkf_state_internalize_tail_summary( enkf_state , fs );
+      else {
+        run_info_free_tail_summary( run_info );
+        run_info->tail_closed = true;
+      }
+    }
+  }
+  pthread_mutex_unlock( &enkf_state->load_mutex );
+}
+
+
+/*
+  Called when the job has completed: closes the incremental loading
+  and returns the tail_summary - with the remaining part of the
+  summary file loaded - or NULL if there is no usable tail_summary.
+  The first report step which has not been internalized is returned
+  in *summary_start.
+*/
+
+static ecl_sum_type * enkf_state_take_tail_summary(enkf_state_type * enkf_state , int * summary_start) {
+  run_info_type * run_info = enkf_state->run_info;
+  ecl_sum_type * summary   = NULL;
+
+  pthread_mutex_lock( &enkf_state->load_mutex );
+  {
+    if (run_info->tail_summary != NULL) {
+      if (ecl_sum_fread_tail( run_info->tail_summary ) >= 0) {
+        summary = run_info->tail_summary;
+        *summary_start = util_int_max( *summary_start , run_info->tail_load_step + 1 );
+      } else
+        ecl_sum_free( run_info->tail_summary );
+      run_info->tail_summary = NULL;
+    }
+    run_info->tail_closed = true;
+  }
+  pthread_mutex_unlock( &enkf_state->load_mutex );
+  
+  return summary;
+}
+
+/*****************************************************************/
+
+
 static bool enkf_state_internalize_dynamic_eclipse_results(enkf_state_type * enkf_state , enkf_fs_type * fs , const model_config_type * model_config , int * result, bool interactive , stringlist_type * msg_list) {
   const run_info_type   * run_info       = enkf_state->run_info;
   int        load_start                  = run_info->load_start;
+  int        summary_start;
   
   if (load_start == 0)  /* Do not attempt to load the "S0000" summary results. */
     load_start++;
+  summary_start = load_start;
   
   {
-    /* Looking for summary files on disk, and loading them. */
-    ecl_sum_type * summary = enkf_state_load_ecl_sum( enkf_state , msg_list , result );
+    /* Use the summary which has been loaded while the simulation was running, or look for summary files on disk and load them. */
+    ecl_sum_type * summary = enkf_state_take_tail_summary( enkf_state , &summary_start );
+    if (summary != NULL) {
+      if (!enkf_state_check_end_date( enkf_state , summary , msg_list )) {
+        ecl_sum_free( summary );
+        summary = NULL;
+        *result |= LOAD_FAILURE;
+      }
+    } else
+      summary = enkf_state_load_ecl_sum( enkf_state , msg_list , result );
+    
     /** OK - now we have actually loaded the ecl_sum instance, or ecl_sum == NULL. */
     if (summary != NULL) {
       
@@ -731,11 +955,11 @@ static bool enkf_state_internalize_dynamic_eclipse_results(enkf_state_type * enk
           enkf_node_type * node = hash_iter_get_next_value(iter);
           if (enkf_node_get_var_type(node) == DYNAMIC_RESULT) {
             /* We internalize all DYNAMIC_RESULT nodes without any further ado. */
-            
+            const int node_start = (enkf_node_get_impl_type( node ) == SUMMARY) ? summary_start : load_start;
             {
               if (enkf_node_vector_storage( node )) {
                 enkf_node_try_load_vector( node , fs , iens , FORECAST );  // Ensure that what is currently on file is loaded before we update.
-                if (enkf_node_forward_load_vector( node , run_info->run_path , summary , NULL , load_start, step2 , iens)) {
+                if (enkf_node_forward_load_vector( node , run_info->run_path , summary , NULL , node_start, step2 , iens)) {
                   enkf_node_store_vector( node , fs , iens , FORECAST );
                   if (interactive && enkf_node_get_impl_type(node) == GEN_DATA)
                     enkf_state_log_GEN_DATA_load( node , 0 , msg_list );
@@ -747,7 +971,7 @@ static bool enkf_state_internalize_dynamic_eclipse_results(enkf_state_type * enk
                 }
               } else {
                 int report_step;
-                for (report_step = load_start; report_step <= step2; report_step++) {
+                for (report_step = node_start; report_step <= step2; report_step++) {
                   bool store_vectors = (report_step == step2) ? true : false;
                   if (enkf_node_forward_load(node , run_info->run_path , summary , NULL , report_step , iens))  { /* Loading/internalizing */
                     node_id_type node_id = {.report_step = report_step, .iens = iens , .state = FORECAST };
@@ -1524,6 +1748,7 @@ void enkf_state_free(enkf_state_type *enkf_state) {
   member_config_free(enkf_state->my_config);
   run_info_free(enkf_state->run_info);
   shared_info_free(enkf_state->shared_info);
+  pthread_mutex_destroy( &enkf_state->load_mutex );
   free(enkf_state);
 }
 
@@ -1693,18 +1918,26 @@ static void enkf_state_init_eclipse(enkf_state_type *enkf_state, enkf_fs_type *
       util_abort("%s: must initialize run parameters with enkf_state_init_run() first \n",__func__);
     
     if (member_config_pre_clear_runpath( my_config )) 
-      util_clear_directory( run_info->run_path , true , false );
+      path_service_clear_directory( enkf_state->shared_info->path_service , run_info->run_path , true , false );
 
     util_make_path(run_info->run_path);
     {
       if (ecl_config_get_schedule_target( ecl_config ) != NULL) {
+        render_cache_type * render_cache = enkf_state->shared_info->render_cache;
         char * schedule_file = util_alloc_filename(run_info->run_path , ecl_config_get_schedule_target( ecl_config ) , NULL);
+        int    last_report   = (run_info->run_mode == ENKF_ASSIMILATION) ? run_info->step2 : -1;
+        char * schedule_key  = util_alloc_sprintf("SCHEDULE:%s:%d" , ecl_config_get_schedule_file( ecl_config ) , last_report);
 
-        if (run_info->run_mode == ENKF_ASSIMILATION)
-          sched_file_fprintf_i( ecl_config_get_sched_file( ecl_config ) , run_info->step2 , schedule_file);
-        else
-          sched_file_fprintf( ecl_config_get_sched_file( ecl_config ) , schedule_file);
+        /* The schedule file only depends on the last report step; it is rendered once and cloned for the other realisations. */
+        if (!render_cache_reuse( render_cache , schedule_key , schedule_file )) {
+          if (run_info->run_mode == ENKF_ASSIMILATION)
+            sched_file_fprintf_i( ecl_config_get_sched_file( ecl_config ) , run_info->step2 , schedule_file);
+          else
+            sched_file_fprintf( ecl_config_get_sched_file( ecl_config ) , schedule_file);
+          render_cache_add( render_cache , schedule_key , schedule_file );
+        }
         
+        free(schedule_key);
         free(schedule_file);
       }
     }
@@ -1726,7 +1959,7 @@ static void enkf_state_init_eclipse(enkf_state_type *enkf_state, enkf_fs_type *
       enkf_state_fread_state_nodes( enkf_state , fs , run_info->step1 , run_info->init_state_dynamic);
 
     enkf_state_set_dynamic_subst_kw(  enkf_state , run_info->run_path , run_info->step1 , run_info->step2);
-    ert_templates_instansiate( enkf_state->shared_info->templates , run_info->run_path , enkf_state->subst_list );
+    ert_templates_instansiate( enkf_state->shared_info->templates , run_info->run_path , enkf_state->subst_list , enkf_state->shared_info->render_cache );
     enkf_state_ecl_write( enkf_state , fs);
     
     if (member_config_get_eclbase( my_config ) != NULL) {
@@ -1734,7 +1967,7 @@ static void enkf_state_init_eclipse(enkf_state_type *enkf_state, enkf_fs_type *
       /* Writing the ECLIPSE data file. */
       if (ecl_config_get_data_file( ecl_config ) != NULL) {
         char * data_file = ecl_util_alloc_filename(run_info->run_path , member_config_get_eclbase( my_config ) , ECL_DATA_FILE , true , -1);
-        subst_list_filter_file(enkf_state->subst_list , ecl_config_get_data_file(ecl_config) , data_file);
+        render_cache_filter_file(enkf_state->shared_info->render_cache , enkf_state->subst_list , ecl_config_get_data_file(ecl_config) , data_file);
         free( data_file );
       }
       
@@ -1774,6 +2007,7 @@ static void enkf_state_start_forward_model(enkf_state_type * enkf_state , enkf_f
     const member_config_type  * my_config     = enkf_state->my_config;
     const site_config_type    * site_config   = shared_info->site_config;
     enkf_state_init_eclipse( enkf_state , fs );
+    enkf_state_reset_tail_summary( enkf_state , false );
 
     if (run_info->run_mode != INIT_ONLY) {
       // The job_queue_node will take ownership of this arg_pack; and destroy it when
@@ -1850,6 +2084,7 @@ static void enkf_state_internal_retry(enkf_state_type * enkf_state , enkf_fs_typ
     }
     
     enkf_state_init_eclipse( enkf_state , fs );                                          /* Possibly clear the directory and do a FULL rewrite of ALL the necessary files. */
+    enkf_state_reset_tail_summary( enkf_state , true );                                  /* The retried run is loaded when it has completed. */
     job_queue_iset_external_restart( shared_info->job_queue , run_info->queue_index );   /* Here we inform the queue system that it should pick up this job and try again. */
     run_info->num_internal_submit++;                                    
   } 
@@ -1972,7 +2207,7 @@ static void enkf_state_clear_runpath( const enkf_state_type * enkf_state ) {
   }
   
   if (unlink_runpath)
-    util_clear_directory(run_info->run_path , true , true);
+    path_service_clear_directory( enkf_state->shared_info->path_service , run_info->run_path , true , true );
 }
 
 
@@ -22,6 +22,7 @@
 #include <ert/util/hash.h>
 #include <ert/util/util.h>
 #include <ert/util/subst_list.h>
+#include <ert/util/render_cache.h>
 
 #include <ert/enkf/ert_template.h>
 #include <ert/enkf/config_keys.h>
@@ -93,9 +94,9 @@ void ert_template_free( ert_template_type * template ) {
 }
 
 
-void ert_template_instantiate( ert_template_type * template , const char * path , const subst_list_type * arg_list) {
+void ert_template_instantiate( ert_template_type * template , const char * path , const subst_list_type * arg_list , render_cache_type * cache) {
   char * target_file = util_alloc_filename( path , template->target_file , NULL );
-  template_instantiate( template->template , target_file , arg_list , true );
+  template_instantiate_cached( template->template , target_file , arg_list , true , cache );
   free( target_file );
 }
 
@@ -187,11 +188,11 @@ ert_template_type * ert_templates_add_template( ert_templates_type * ert_templat
 }
 
 
-void ert_templates_instansiate( ert_templates_type * ert_templates , const char * path , const subst_list_type * arg_list) {
+void ert_templates_instansiate( ert_templates_type * ert_templates , const char * path , const subst_list_type * arg_list , render_cache_type * cache) {
   hash_iter_type * iter = hash_iter_alloc( ert_templates->templates );
   while (!hash_iter_is_complete( iter )) {
     ert_template_type * ert_template = hash_iter_get_next_value( iter );
-    ert_template_instantiate( ert_template , path , arg_list);
+    ert_template_instantiate( ert_template , path , arg_list , cache);
   }
   hash_iter_free( iter );
 }
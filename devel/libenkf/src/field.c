@@ -23,6 +23,7 @@
 #include <ert/util/util.h>
 #include <ert/util/buffer.h>
 #include <ert/util/rng.h>
+#include <ert/util/elementwise.h>
 
 #include <ert/ecl/fortio.h>
 #include <ert/ecl/ecl_kw.h>
@@ -546,11 +547,9 @@ static void field_apply(field_type * field , field_func_type * func) {
     const int data_size          = field_config_get_data_size( field->config );   
     const ecl_type_enum ecl_type = field_config_get_ecl_type(field->config);
     
-    if (ecl_type == ECL_FLOAT_TYPE) {
-      float * data = (float *) field->data;
-      for (int i=0; i < data_size; i++)
-        data[i] = func(data[i]);
-    } else if (ecl_type == ECL_DOUBLE_TYPE) {
+    if (ecl_type == ECL_FLOAT_TYPE) 
+      field_trans_apply_float(func , (float *) field->data , data_size);
+    else if (ecl_type == ECL_DOUBLE_TYPE) {
       double * data = (double *) field->data;
       for (int i=0; i < data_size; i++)
         data[i] = func(data[i]);
@@ -779,6 +778,33 @@ void field_deserialize(field_type * field , node_id_type node_id , const active_
 }
 
 
+/*
+  Serializing to the single precision ensemble matrix is only
+  supported for fields with float storage.
+*/
+
+void field_fmatrix_serialize(const field_type * field , const active_list_type * active_list , fmatrix_type * A , int row_offset , int column) {
+  const field_config_type *config      = field->config;
+  const int                data_size   = field_config_get_data_size(config );
+
+  if (field_config_get_ecl_type(config) != ECL_FLOAT_TYPE)
+    util_abort("%s: field:%s does not have float storage \n",__func__ , field_config_get_key( config ));
+
+  enkf_fmatrix_serialize( (const float *) field->data , data_size , active_list , A , row_offset , column);
+}
+
+
+void field_fmatrix_deserialize(field_type * field , const active_list_type * active_list , const fmatrix_type * A , int row_offset , int column) {
+  const field_config_type *config      = field->config;
+  const int                data_size   = field_config_get_data_size(config );
+
+  if (field_config_get_ecl_type(config) != ECL_FLOAT_TYPE)
+    util_abort("%s: field:%s does not have float storage \n",__func__ , field_config_get_key( config ));
+
+  enkf_fmatrix_deserialize( (float *) field->data , data_size , active_list , A , row_offset , column);
+}
+
+
 
 
 void field_ijk_get(const field_type * field , int i , int j , int k , void * value) {
@@ -1012,13 +1038,19 @@ bool field_fload_rms(field_type * field , const char * filename) {
     fclose( stream );
   }
 
+  /*
+    Only the parameter asked for is read; the tag directory is built
+    with one pass through the file, and the data of the parameter is
+    then read straight into a scratch buffer in RMS ordering.
+  */
   {
     const char * key           = field_config_get_ecl_kw_name(field->config);
-    ecl_type_enum   ecl_type;
     rms_file_type * rms_file   = rms_file_alloc(filename , false);
-    rms_tagkey_type * data_tag;
+    const rms_tag_type * rms_tag;
+    const rms_tagkey_type * data_key;
+
     if (field_config_enkf_mode(field->config)) 
-      data_tag = rms_file_fread_alloc_data_tagkey(rms_file , "parameter" , "name" , key);
+      rms_tag = rms_file_get_index_tag(rms_file , "parameter" , "name" , key);
     else {
       /** 
           Setting the key - purely to support converting between
@@ -1026,19 +1058,24 @@ bool field_fload_rms(field_type * field , const char * filename) {
           feature - but not really well defined.
       */
       
-      rms_tag_type * rms_tag = rms_file_fread_alloc_tag(rms_file , "parameter" , NULL , NULL);
-      const char * parameter_name = rms_tag_get_namekey_name(rms_tag);
-      field_config_set_key( (field_config_type *) field->config , parameter_name );
-      data_tag = rms_tagkey_copyc( rms_tag_get_key(rms_tag , "data") );
-      rms_tag_free(rms_tag);
+      rms_tag = rms_file_get_index_tag(rms_file , "parameter" , NULL , NULL);
+      if (rms_tag != NULL)
+        field_config_set_key( (field_config_type *) field->config , rms_tag_get_namekey_name(rms_tag) );
     }
-    
-    ecl_type = rms_tagkey_get_ecl_type(data_tag);
-    if (rms_tagkey_get_size(data_tag) != field_config_get_volume(field->config)) 
+
+    if (rms_tag == NULL)
+      util_abort("%s: could not find parameter:%s in file:%s - aborting \n",__func__ , key , filename);
+
+    data_key = rms_tag_get_datakey(rms_tag);
+    if (rms_tagkey_get_size(data_key) != field_config_get_volume(field->config)) 
       util_abort("%s: trying to import rms_data_tag from:%s with wrong size - aborting \n",__func__ , filename);
     
-    field_import3D(field , rms_tagkey_get_data_ref(data_tag) , true , ecl_type);
-    rms_tagkey_free(data_tag);
+    {
+      void * data = util_malloc( (size_t) rms_tagkey_get_size(data_key) * rms_tagkey_get_sizeof_ctype(data_key) );
+      rms_file_fread_tagkey_data(rms_file , data_key , data);
+      field_import3D(field , data , true , rms_tagkey_get_ecl_type(data_key));
+      free(data);
+    }
     rms_file_free(rms_file);
   }
   return true;
@@ -1229,19 +1266,11 @@ void field_iadd(field_type * field1, const field_type * field2) {
   {
     const int data_size          = field_config_get_data_size( field1->config );   
     const ecl_type_enum ecl_type = field_config_get_ecl_type( field1->config );
-    int i;
 
-    if (ecl_type == ECL_FLOAT_TYPE) {
-      float * data1       = (float *) field1->data;
-      const float * data2 = (const float *) field2->data;
-      for (i = 0; i < data_size; i++)
-        data1[i] += data2[i];
-    } else if (ecl_type == ECL_DOUBLE_TYPE) {
-      double * data1       = (double *) field1->data;
-      const double * data2 = (const double *) field2->data;
-      for (i = 0; i < data_size; i++)
-        data1[i] += data2[i];
-    }
+    if (ecl_type == ECL_FLOAT_TYPE) 
+      elementwise_add_float( (float *) field1->data , (const float *) field2->data , data_size );
+    else if (ecl_type == ECL_DOUBLE_TYPE) 
+      elementwise_add_double( (double *) field1->data , (const double *) field2->data , data_size );
   }
 }
 
@@ -1249,21 +1278,13 @@ void field_iadd(field_type * field1, const field_type * field2) {
 void field_imul(field_type * field1, const field_type * field2) {
   field_config_assert_binary(field1->config , field2->config , __func__); 
   {
-    const int data_size          = field_config_get_data_size(field1->config );   
-    const ecl_type_enum ecl_type = field_config_get_ecl_type(field1->config);
-    int i;
+    const int data_size          = field_config_get_data_size( field1->config );   
+    const ecl_type_enum ecl_type = field_config_get_ecl_type( field1->config );
 
-    if (ecl_type == ECL_FLOAT_TYPE) {
-      float * data1       = (float *) field1->data;
-      const float * data2 = (const float *) field2->data;
-      for (i = 0; i < data_size; i++)
-        data1[i] *= data2[i];
-    } else if (ecl_type == ECL_DOUBLE_TYPE) {
-      double * data1       = (double *) field1->data;
-      const double * data2 = (const double *) field2->data;
-      for (i = 0; i < data_size; i++)
-        data1[i] *= data2[i];
-    }
+    if (ecl_type == ECL_FLOAT_TYPE) 
+      elementwise_mul_float( (float *) field1->data , (const float *) field2->data , data_size );
+    else if (ecl_type == ECL_DOUBLE_TYPE) 
+      elementwise_mul_double( (double *) field1->data , (const double *) field2->data , data_size );
   }
 }
 
@@ -1271,21 +1292,13 @@ void field_imul(field_type * field1, const field_type * field2) {
 void field_iaddsqr(field_type * field1, const field_type * field2) {
   field_config_assert_binary(field1->config , field2->config , __func__); 
   {
-    const int data_size          = field_config_get_data_size(field1->config );   
-    const ecl_type_enum ecl_type = field_config_get_ecl_type(field1->config);
-    int i;
+    const int data_size          = field_config_get_data_size( field1->config );   
+    const ecl_type_enum ecl_type = field_config_get_ecl_type( field1->config );
 
-    if (ecl_type == ECL_FLOAT_TYPE) {
-      float * data1       = (float *) field1->data;
-      const float * data2 = (const float *) field2->data;
-      for (i = 0; i < data_size; i++)
-        data1[i] += data2[i] * data2[i];
-    } else if (ecl_type == ECL_DOUBLE_TYPE) {
-      double * data1       = (double *) field1->data;
-      const double * data2 = (const double *) field2->data;
-      for (i = 0; i < data_size; i++)
-        data1[i] += data2[i] * data2[i];
-    }
+    if (ecl_type == ECL_FLOAT_TYPE) 
+      elementwise_addsqr_float( (float *) field1->data , (const float *) field2->data , data_size );
+    else if (ecl_type == ECL_DOUBLE_TYPE) 
+      elementwise_addsqr_double( (double *) field1->data , (const double *) field2->data , data_size );
   }
 }
 
@@ -1295,30 +1308,40 @@ void field_scale(field_type * field, double scale_factor) {
   {
     const int data_size          = field_config_get_data_size(field->config );   
     const ecl_type_enum ecl_type = field_config_get_ecl_type(field->config);
-    int i;
 
-    if (ecl_type == ECL_FLOAT_TYPE) {
-      float * data       = (float *) field->data;
-      for (i = 0; i < data_size; i++)
-        data[i] *= scale_factor;
-    } else if (ecl_type == ECL_DOUBLE_TYPE) {
-      double * data       = (double *) field->data;
-      for (i = 0; i < data_size; i++)
-        data[i] *= scale_factor;
-    }
+    if (ecl_type == ECL_FLOAT_TYPE) 
+      elementwise_scale_float( (float *) field->data , scale_factor , data_size );
+    else if (ecl_type == ECL_DOUBLE_TYPE) 
+      elementwise_scale_double( (double *) field->data , scale_factor , data_size );
   }
 }
 
 
-static inline float __sqr(float x) { return x*x; }
-
 void field_isqr(field_type * field) {
-  field_apply(field , __sqr);
+  field_config_assert_unary(field->config, __func__); 
+  {
+    const int data_size          = field_config_get_data_size(field->config );   
+    const ecl_type_enum ecl_type = field_config_get_ecl_type(field->config);
+
+    if (ecl_type == ECL_FLOAT_TYPE) 
+      elementwise_sqr_float( (float *) field->data , data_size );
+    else if (ecl_type == ECL_DOUBLE_TYPE) 
+      elementwise_sqr_double( (double *) field->data , data_size );
+  }
 }
 
 
 void field_isqrt(field_type * field) {
-  field_apply(field , sqrtf);
+  field_config_assert_unary(field->config, __func__); 
+  {
+    const int data_size          = field_config_get_data_size(field->config );   
+    const ecl_type_enum ecl_type = field_config_get_ecl_type(field->config);
+
+    if (ecl_type == ECL_FLOAT_TYPE) 
+      elementwise_sqrt_float( (float *) field->data , data_size );
+    else if (ecl_type == ECL_DOUBLE_TYPE) 
+      elementwise_sqrt_double( (double *) field->data , data_size );
+  }
 }
 
 void field_imul_add(field_type * field1 , double factor , const field_type * field2) {
@@ -1326,19 +1349,11 @@ void field_imul_add(field_type * field1 , double factor , const field_type * fie
   {
     const int data_size          = field_config_get_data_size(field1->config );   
     const ecl_type_enum ecl_type = field_config_get_ecl_type(field1->config);
-    int i;
 
-    if (ecl_type == ECL_FLOAT_TYPE) {
-      float * data1       = (float *) field1->data;
-      const float * data2 = (const float *) field2->data;
-      for (i = 0; i < data_size; i++)
-        data1[i] += factor * data2[i];
-    } else if (ecl_type == ECL_DOUBLE_TYPE) {
-      double * data1       = (double *) field1->data;
-      const double * data2 = (const double *) field2->data;
-      for (i = 0; i < data_size; i++)
-        data1[i] += factor * data2[i];
-    }
+    if (ecl_type == ECL_FLOAT_TYPE) 
+      elementwise_axpy_float( (float *) field1->data , factor , (const float *) field2->data , data_size );
+    else if (ecl_type == ECL_DOUBLE_TYPE) 
+      elementwise_axpy_double( (double *) field1->data , factor , (const double *) field2->data , data_size );
   }
 }
 
@@ -34,6 +34,7 @@
 
 #include <ert/util/hash.h>
 #include <ert/util/util.h>
+#include <ert/util/elementwise.h>
 
 #include <ert/enkf/field_trans.h>
 /*****************************************************************/
@@ -286,3 +287,30 @@ field_trans_table_type * field_trans_table_alloc() {
   return table;
 }
 
+
+
+/**
+   Applies the transformation function to all elements of the
+   data. The builtin transformations which map directly to one of the
+   typed elementwise kernels are applied with the kernel; all other
+   functions are called element by element.
+*/
+
+void field_trans_apply_float(field_func_type * func , float * data , int size) {
+  if (func == logf)
+    elementwise_log_float( data , size );
+  else if (func == log10f)
+    elementwise_log10_float( data , size );
+  else if (func == expf)
+    elementwise_exp_float( data , size );
+  else if (func == field_trans_pow10)
+    elementwise_pow10_float( data , size );
+  else if (func == trunc_pow10f) {
+    elementwise_pow10_float( data , size );
+    elementwise_clamp_float( data , 0.001 , INFINITY , size );
+  } else {
+    int i;
+    for (i=0; i < size; i++)
+      data[i] = func( data[i] );
+  }
+}
@@ -49,17 +49,34 @@ struct meas_data_struct {
 };
 
 
+/**
+   The measured data is stored in one contiguous block of size
+   ens_size * obs_size, with the same column major layout as the S
+   matrix which is eventually assembled in meas_data_allocS(); i.e.
+   all the observations for one realisation are consecutive in
+   memory. This means that:
+
+    o Each realisation, which is typically measured by a separate
+      thread, writes to it's own contiguous slice of the data.
+
+    o The ensemble statistics can be calculated in one pass with
+      the inner loop running over consecutive elements.
+
+    o The S matrix can be assembled with memcpy() of the active
+      observation segments.
+*/
+
 struct meas_block_struct {
   UTIL_TYPE_ID_DECLARATION;
   int          ens_size;
   int          obs_size;
-  int          ens_stride;
-  int          obs_stride;
-  int          data_size;
   int          report_step;  /* Not really necessary ?? */
   char       * obs_key;
-  double     * data;
+  double     * data;         /* ens_size * obs_size elements; data[ iens * obs_size + iobs ]. */
+  double     * ens_mean;
+  double     * ens_std;
   bool       * active;
+  bool         stat_calculated;
 };
 
 
@@ -83,12 +100,12 @@ static meas_block_type * meas_block_alloc( const char * obs_key , int report_ste
   meas_block->ens_size    = ens_size;
   meas_block->obs_size    = obs_size;
   meas_block->obs_key     = util_alloc_string_copy( obs_key );
-  meas_block->data        = util_calloc( (ens_size + 2)     * obs_size , sizeof * meas_block->data   );
-  meas_block->active      = util_calloc(                      obs_size , sizeof * meas_block->active );
-  meas_block->ens_stride  = 1;
-  meas_block->obs_stride  = ens_size + 2; 
-  meas_block->data_size   = (ens_size + 2) * obs_size;
+  meas_block->data        = util_calloc( ens_size * obs_size , sizeof * meas_block->data     );
+  meas_block->ens_mean    = util_calloc(            obs_size , sizeof * meas_block->ens_mean );
+  meas_block->ens_std     = util_calloc(            obs_size , sizeof * meas_block->ens_std  );
+  meas_block->active      = util_calloc(            obs_size , sizeof * meas_block->active   );
   meas_block->report_step = report_step;
+  meas_block->stat_calculated = false;
   {
     int i;
     for (i=0; i  <obs_size; i++)
@@ -97,13 +114,19 @@ static meas_block_type * meas_block_alloc( const char * obs_key , int report_ste
   return meas_block;
 }
 
+
+static double * meas_block_get_column( const meas_block_type * meas_block , int iens) {
+  return &meas_block->data[ iens * meas_block->obs_size ];
+}
+
+
 static void meas_block_fprintf( const meas_block_type * meas_block , FILE * stream) {
   int iens;
   int iobs;
   for (iobs = 0; iobs < meas_block->obs_size; iobs++) {
     for (iens = 0; iens < meas_block->ens_size; iens++) {
-      int index = iens * meas_block->ens_stride + iobs * meas_block->obs_stride;
-      fprintf(stream , " %10.2f ", meas_block->data[ index ]);
+      const double * column = meas_block_get_column( meas_block , iens );
+      fprintf(stream , " %10.2f ", column[ iobs ]);
     }
     fprintf(stream , "\n");
   }
@@ -113,6 +136,8 @@ static void meas_block_fprintf( const meas_block_type * meas_block , FILE * stre
 static void meas_block_free( meas_block_type * meas_block ) {
   free( meas_block->obs_key );
   free( meas_block->data );
+  free( meas_block->ens_mean );
+  free( meas_block->ens_std );
   free( meas_block->active );
   free( meas_block );
 }
@@ -124,77 +149,142 @@ static void meas_block_free__( void * arg ) {
 }
 
 
+/**
+   Copies the active observations into rows [obs_offset, obs_offset +
+   num_active) of S. The active observations are copied in contiguous
+   runs, i.e. a fully active block is one memcpy() per realisation.
+*/
 
 static void meas_block_initS( const meas_block_type * meas_block , matrix_type * S, int * __obs_offset) {
   int obs_offset = *__obs_offset;
-  for (int iobs =0; iobs < meas_block->obs_size; iobs++) {
+  int iobs = 0;
+  while (iobs < meas_block->obs_size) {
     if (meas_block->active[iobs]) {
+      int run_start = iobs;
+      while ((iobs < meas_block->obs_size) && meas_block->active[iobs])
+        iobs++;
+      
       for (int iens =0; iens < meas_block->ens_size; iens++) {
-        int obs_index = iens * meas_block->ens_stride + iobs* meas_block->obs_stride;
-        
-        matrix_iset( S , obs_offset, iens , meas_block->data[ obs_index ]);
+        const double * column = meas_block_get_column( meas_block , iens );
+        matrix_set_many_on_column( S , obs_offset , iobs - run_start , &column[ run_start ] , iens );
       }
-      obs_offset++;
-    }
+      obs_offset += iobs - run_start;
+    } else
+      iobs++;
   }
   *__obs_offset = obs_offset;
 }
 
 
 static void meas_data_assign_block( meas_block_type * target_block , const meas_block_type * src_block , int target_iens , int src_iens ) {
-  int iobs;
-  for (iobs =0; iobs < target_block->obs_size; iobs++) {  
-    int target_index = target_iens * target_block->ens_stride + iobs * target_block->obs_stride;
-    int src_index    = src_iens * src_block->ens_stride + iobs * src_block->obs_stride;
-    target_block->data[ target_index ] = src_block->data[ src_index ];
-  }
+  if (target_block->obs_size != src_block->obs_size)
+    util_abort("%s: size mismatch \n",__func__);
+
+  memcpy( meas_block_get_column( target_block , target_iens ) , 
+          meas_block_get_column( src_block , src_iens ) , 
+          target_block->obs_size * sizeof * target_block->data );
+  target_block->stat_calculated = false;
 }
 
 
+/**
+   Calculates the ensemble mean and standard deviation of all the
+   observations in the block (including the inactive ones) with the
+   one pass algorithm of Welford. The realisations are visited in the
+   outer loop, so the inner loop runs over consecutive memory.
+*/
+
 void meas_block_calculate_ens_stats( meas_block_type * meas_block ) {
-  bool include_inactive = true;
+  const int obs_size = meas_block->obs_size;
+  double * mean = meas_block->ens_mean;
+  double * M2   = meas_block->ens_std;   /* Used as scratch space for the sum of squared deviations. */
   int iobs , iens;
-  for (iobs =0; iobs < meas_block->obs_size; iobs++) {  
-    if (meas_block->active[iobs] || include_inactive) { 
-      double M1 = 0;
-      double M2 = 0;
-      for (iens =0; iens < meas_block->ens_size; iens++) {
-        int index = iens * meas_block->ens_stride + iobs * meas_block->obs_stride;
-        M1 += meas_block->data[ index ];
-        M2 += meas_block->data[ index ] * meas_block->data[ index ];
-      }
-      {
-        int mean_index = (meas_block->ens_size + 0) * meas_block->ens_stride + iobs * meas_block->obs_stride;
-        int std_index  = (meas_block->ens_size + 1) * meas_block->ens_stride + iobs * meas_block->obs_stride;
-        double mean    = M1 / meas_block->ens_size; 
-        double var     = M2 / meas_block->ens_size - mean * mean;
-        meas_block->data[ mean_index ] = mean;
-        meas_block->data[ std_index ]  = sqrt( util_double_max( 0.0 , var));
-      }
+  
+  for (iobs = 0; iobs < obs_size; iobs++) {
+    mean[iobs] = 0;
+    M2[iobs]   = 0;
+  }
+
+  for (iens = 0; iens < meas_block->ens_size; iens++) {
+    const double * column = meas_block_get_column( meas_block , iens );
+    const double inv_n    = 1.0 / (iens + 1);
+    for (iobs = 0; iobs < obs_size; iobs++) {
+      double delta = column[iobs] - mean[iobs];
+      mean[iobs] += delta * inv_n;
+      M2[iobs]   += delta * (column[iobs] - mean[iobs]);
     }
   }
+
+  for (iobs = 0; iobs < obs_size; iobs++) 
+    meas_block->ens_std[iobs] = sqrt( util_double_max( 0.0 , M2[iobs] / meas_block->ens_size ));
+
+  meas_block->stat_calculated = true;
+}
+
+
+/**
+   Bulk outlier screening of the block. For every active observation
+   the function will compare the ensemble statistics with the observed
+   values in @obs_value and @obs_std (both of length obs_size), and
+   store the result in @outlier_mask:
+
+     MEAS_BLOCK_INLIER       : Not an outlier - or not active.
+     MEAS_BLOCK_NO_VARIATION : The ensemble std is below @std_cutoff.
+     MEAS_BLOCK_NO_OVERLAP   : |obs - <ens>| > alpha * (ens_std + obs_std).
+   
+   The ensemble statistics are calculated if that has not already been
+   done. The function returns the number of outliers; the meas_block
+   itself is not modified, that is left to the calling scope.
+*/
+
+int meas_block_outlier_mask( meas_block_type * meas_block , const double * obs_value , const double * obs_std , double std_cutoff , double alpha , meas_outlier_type * outlier_mask) {
+  int num_outliers = 0;
+  if (!meas_block->stat_calculated)
+    meas_block_calculate_ens_stats( meas_block );
+  
+  for (int iobs = 0; iobs < meas_block->obs_size; iobs++) {
+    meas_outlier_type mask = MEAS_BLOCK_INLIER;
+    if (meas_block->active[iobs]) {
+      const double ens_std = meas_block->ens_std[iobs];
+      
+      if (ens_std < std_cutoff)
+        mask = MEAS_BLOCK_NO_VARIATION;
+      else if (fabs( obs_value[iobs] - meas_block->ens_mean[iobs] ) > alpha * (ens_std + obs_std[iobs]))
+        mask = MEAS_BLOCK_NO_OVERLAP;
+    }
+    
+    if (mask != MEAS_BLOCK_INLIER)
+      num_outliers++;
+    outlier_mask[iobs] = mask;
+  }
+  return num_outliers;
 }
 
 
 
 void meas_block_iset( meas_block_type * meas_block , int iens , int iobs , double value) {
-  int index = iens * meas_block->ens_stride + iobs * meas_block->obs_stride;
-  meas_block->data[ index ] = value;
+  double * column = meas_block_get_column( meas_block , iens );
+  column[ iobs ] = value;
   if (!meas_block->active[ iobs ]) 
     meas_block->active[ iobs ] = true;
+  
+  meas_block->stat_calculated = false;
+}
+
 
+double meas_block_iget( const meas_block_type * meas_block , int iens , int iobs) {
+  const double * column = meas_block_get_column( meas_block , iens );
+  return column[ iobs ];
 }
 
 
 double meas_block_iget_ens_std( const meas_block_type * meas_block , int iobs) {
-  int std_index  = (meas_block->ens_size + 1) * meas_block->ens_stride + iobs * meas_block->obs_stride;
-  return meas_block->data[ std_index ];
+  return meas_block->ens_std[ iobs ];
 }
 
 
 double meas_block_iget_ens_mean( const meas_block_type * meas_block , int iobs) {
-  int mean_index  = meas_block->ens_size * meas_block->ens_stride + iobs * meas_block->obs_stride;
-  return meas_block->data[ mean_index ];
+  return meas_block->ens_mean[ iobs ];
 }
 
 
@@ -18,8 +18,11 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include <ert/util/util.h>
 #include <ert/util/hash.h>
@@ -27,9 +30,17 @@
 #include <ert/util/double_vector.h>
 #include <ert/util/msg.h>
 #include <ert/util/buffer.h>
+#include <ert/util/bool_vector.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/long_vector.h>
+#include <ert/util/thread_pool.h>
 
 #include <ert/enkf/enkf_obs.h>
 #include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/enkf_node.h>
+#include <ert/enkf/obs_vector.h>
+#include <ert/enkf/obs_data.h>
+#include <ert/enkf/active_list.h>
 #include <ert/enkf/enkf_util.h>
 #include <ert/enkf/misfit_ensemble.h>
 #include <ert/enkf/misfit_member.h>
@@ -52,11 +63,14 @@
 
 
 #define MISFIT_ENSEMBLE_TYPE_ID   441066
+#define MISFIT_ENSEMBLE_VERSION   1
 
 struct misfit_ensemble_struct {
   UTIL_TYPE_ID_DECLARATION;
   bool                  initialized;
   int                   history_length;  
+  long                  obs_hash;           /* Hash of the observation keys, values and errors the table was calculated from. */
+  int                   num_threads;
   vector_type         * ensemble;           /* Vector of misfit_member_type instances - one for each ensemble member. */
 };
 
@@ -77,61 +91,352 @@ static void  __2d_free(double ** d , int rows) {
 }
 
 
+/*****************************************************************/
+
+/**
+   The misfit evaluation is organized around the enkf_node instances
+   the observations are measured on: all the observations with the
+   same state_kw are collected in one group, and for every realisation
+   the node is loaded once and then evaluated against all the
+   observations in the group. Nodes with vector storage, i.e. summary
+   data, are loaded as one vector per realisation; other nodes are
+   loaded once per report step where at least one observation in the
+   group is active.
+
+   The realisations are handed out one at a time to a pool of
+   threads, so a few realisations which are slow to load do not hold
+   up the others; each thread has its own enkf_node instances and only
+   touches the misfit_member instances of the realisations it has
+   picked.
+*/
+
+typedef struct {
+  enkf_config_node_type * config_node;
+  vector_type           * obs_vectors;    /* Vector of obs_vector_type instances (not owned) with this state_kw. */
+  bool_vector_type      * active_steps;   /* Report steps where at least one of the obs_vectors is active. */
+} misfit_group_type;
+
+
+typedef struct {
+  misfit_ensemble_type    * misfit_ensemble;
+  const vector_type       * groups;
+  const int_vector_type   * iens_list;      /* The realisations to evaluate. */
+  const long_vector_type  * data_stamp;     /* The enkf_fs data stamp of each realisation. */
+  enkf_fs_type            * fs;
+  int                       next_index;     /* The next element in iens_list to evaluate; protected by lock. */
+  pthread_mutex_t           lock;
+} misfit_update_info_type;
+
+
+static misfit_group_type * misfit_group_alloc( enkf_config_node_type * config_node ) {
+  misfit_group_type * group = util_malloc( sizeof * group );
+  group->config_node  = config_node;
+  group->obs_vectors  = vector_alloc_new();
+  group->active_steps = bool_vector_alloc( 0 , false );
+  return group;
+}
+
+
+static void misfit_group_free__( void * arg ) {
+  misfit_group_type * group = (misfit_group_type *) arg;
+  vector_free( group->obs_vectors );
+  bool_vector_free( group->active_steps );
+  free( group );
+}
+
+
+static void misfit_group_add_obs( misfit_group_type * group , const obs_vector_type * obs_vector , int history_length) {
+  vector_append_ref( group->obs_vectors , obs_vector );
+  for (int step = 0; step <= history_length; step++) {
+    if (obs_vector_iget_node( obs_vector , step ) != NULL)
+      bool_vector_iset( group->active_steps , step , true );
+  }
+}
+
+
+static vector_type * misfit_ensemble_alloc_groups( const enkf_obs_type * enkf_obs , int history_length) {
+  vector_type * groups      = vector_alloc_new();
+  hash_type * group_hash    = hash_alloc();
+  hash_iter_type * obs_iter = enkf_obs_alloc_iter( enkf_obs );
+
+  while (!hash_iter_is_complete( obs_iter )) {
+    const char * obs_key         = hash_iter_get_next_key( obs_iter );
+    obs_vector_type * obs_vector = enkf_obs_get_vector( enkf_obs , obs_key );
+    const char * state_kw        = obs_vector_get_state_kw( obs_vector );
+
+    if (!hash_has_key( group_hash , state_kw )) {
+      misfit_group_type * group = misfit_group_alloc( obs_vector_get_config_node( obs_vector ));
+      vector_append_owned_ref( groups , group , misfit_group_free__ );
+      hash_insert_ref( group_hash , state_kw , group );
+    }
+    misfit_group_add_obs( hash_get( group_hash , state_kw ) , obs_vector , history_length );
+  }
+
+  hash_iter_free( obs_iter );
+  hash_free( group_hash );
+  return groups;
+}
+
+
+/**
+   Evaluates all the observations in one group for one realisation,
+   the results are stored in the chi2 table (one row per observation)
+   and installed in the misfit_member if the data could be loaded for
+   all the active steps.
+*/
+
+static void misfit_group_update_member( const misfit_group_type * group ,
+                                        enkf_node_type * enkf_node ,
+                                        enkf_fs_type * fs ,
+                                        misfit_member_type * member ,
+                                        int iens ,
+                                        int history_length ,
+                                        double ** chi2) {
+  const int num_obs = vector_get_size( group->obs_vectors );
+  const bool vector_storage = enkf_node_vector_storage( enkf_node );
+  bool valid = true;
+  node_id_type node_id = {.report_step = 0 , .iens = iens , .state = FORECAST };
+
+  if (vector_storage)
+    valid = enkf_node_try_load_vector( enkf_node , fs , iens , FORECAST );
+
+  for (int step = 0; valid && (step <= history_length); step++) {
+    node_id.report_step = step;
+    if (bool_vector_safe_iget( group->active_steps , step )) {
+      if (vector_storage || enkf_node_try_load( enkf_node , fs , node_id )) {
+        for (int iobs = 0; iobs < num_obs; iobs++) {
+          const obs_vector_type * obs_vector = vector_iget_const( group->obs_vectors , iobs );
+          chi2[iobs][step] = obs_vector_chi2_node( obs_vector , enkf_node , node_id );
+        }
+      } else
+        valid = false;  /* Missing data - this member will not get misfit values for this group. */
+    } else {
+      for (int iobs = 0; iobs < num_obs; iobs++)
+        chi2[iobs][step] = 0;
+    }
+  }
+
+  if (valid) {
+    for (int iobs = 0; iobs < num_obs; iobs++) {
+      const obs_vector_type * obs_vector = vector_iget_const( group->obs_vectors , iobs );
+      misfit_member_update_ts( member , obs_vector_get_obs_key( obs_vector ) , history_length , chi2[iobs] );
+    }
+  }
+}
+
+
+static int misfit_update_info_next_iens( misfit_update_info_type * info ) {
+  int iens = -1;
+  pthread_mutex_lock( &info->lock );
+  if (info->next_index < int_vector_size( info->iens_list )) {
+    iens = int_vector_iget( info->iens_list , info->next_index );
+    info->next_index++;
+  }
+  pthread_mutex_unlock( &info->lock );
+  return iens;
+}
+
+
+static void * misfit_ensemble_update_mt( void * arg ) {
+  misfit_update_info_type * info = (misfit_update_info_type *) arg;
+  const int history_length       = info->misfit_ensemble->history_length;
+  const int num_groups           = vector_get_size( info->groups );
+  enkf_node_type ** enkf_nodes   = util_calloc( num_groups , sizeof * enkf_nodes );
+  double *** chi2                = util_calloc( num_groups , sizeof * chi2 );
+  int iens;
+
+  for (int igroup = 0; igroup < num_groups; igroup++) {
+    const misfit_group_type * group = vector_iget_const( info->groups , igroup );
+    enkf_nodes[igroup] = enkf_node_alloc( group->config_node );
+    chi2[igroup]       = __2d_malloc( vector_get_size( group->obs_vectors ) , history_length + 1 );
+  }
+
+  while ((iens = misfit_update_info_next_iens( info )) >= 0) {
+    misfit_member_type * member = misfit_ensemble_iget_member( info->misfit_ensemble , iens );
+    for (int igroup = 0; igroup < num_groups; igroup++) {
+      const misfit_group_type * group = vector_iget_const( info->groups , igroup );
+      misfit_group_update_member( group , enkf_nodes[igroup] , info->fs , member , iens , history_length , chi2[igroup] );
+    }
+    misfit_member_set_data_stamp( member , long_vector_iget( info->data_stamp , iens ));
+  }
+
+  for (int igroup = 0; igroup < num_groups; igroup++) {
+    const misfit_group_type * group = vector_iget_const( info->groups , igroup );
+    __2d_free( chi2[igroup] , vector_get_size( group->obs_vectors ));
+    enkf_node_free( enkf_nodes[igroup] );
+  }
+  free( chi2 );
+  free( enkf_nodes );
+  return NULL;
+}
+
+
+/*
+  FNV-1a hash, used to detect changes in the observations.
+*/
+
+static long misfit_ensemble_hash_bytes( long hash , const void * data , int size ) {
+  const unsigned char * bytes = data;
+  unsigned long h = (unsigned long) hash;
+  for (int i = 0; i < size; i++) {
+    h ^= bytes[i];
+    h *= 1099511628211UL;
+  }
+  return (long) h;
+}
+
+
+/**
+   Calculates a hash of all the observation keys, and the values and
+   errors of the observations at all report steps; the misfit table
+   is only reused as long as this hash is unchanged. The hash of each
+   observation key is summed, so the result does not depend on the
+   iteration order of enkf_obs.
+*/
+
+static long misfit_ensemble_alloc_obs_hash( const enkf_obs_type * enkf_obs , int history_length ) {
+  unsigned long obs_hash        = 0;
+  active_list_type * active_list = active_list_alloc( );
+  obs_data_type * obs_data       = obs_data_alloc( );
+  hash_iter_type * obs_iter      = enkf_obs_alloc_iter( enkf_obs );
+
+  while (!hash_iter_is_complete( obs_iter )) {
+    const char * obs_key         = hash_iter_get_next_key( obs_iter );
+    obs_vector_type * obs_vector = enkf_obs_get_vector( enkf_obs , obs_key );
+    long hash                    = (long) 14695981039346656037UL;
+
+    hash = misfit_ensemble_hash_bytes( hash , obs_key , strlen( obs_key ));
+    for (int step = 0; step <= history_length; step++) {
+      if (obs_vector_iget_node( obs_vector , step ) != NULL) {
+        obs_data_reset( obs_data );
+        obs_vector_iget_observations( obs_vector , step , obs_data , active_list );
+        hash = misfit_ensemble_hash_bytes( hash , &step , sizeof step );
+        for (int block_nr = 0; block_nr < obs_data_get_num_blocks( obs_data ); block_nr++) {
+          const obs_block_type * obs_block = obs_data_iget_block_const( obs_data , block_nr );
+          for (int iobs = 0; iobs < obs_block_get_size( obs_block ); iobs++) {
+            double value = obs_block_iget_value( obs_block , iobs );
+            double std   = obs_block_iget_std( obs_block , iobs );
+            hash = misfit_ensemble_hash_bytes( hash , &value , sizeof value );
+            hash = misfit_ensemble_hash_bytes( hash , &std , sizeof std );
+          }
+        }
+      }
+    }
+    obs_hash += (unsigned long) hash;
+  }
+
+  hash_iter_free( obs_iter );
+  obs_data_free( obs_data );
+  active_list_free( active_list );
+  return (long) obs_hash;
+}
+
+
+/**
+   A member is up to date if it has misfit values for all the
+   observations, and they were calculated from the simulated data
+   which is currently stored in enkf_fs, i.e. the data stamp of the
+   realisation is unchanged. A data stamp of zero means that enkf_fs
+   does not know the state of the data, and the member is always
+   recalculated.
+*/
+
+static bool misfit_ensemble_member_complete( const misfit_ensemble_type * misfit_ensemble , const enkf_obs_type * enkf_obs , int iens , long data_stamp) {
+  const misfit_member_type * member = misfit_ensemble_iget_member( misfit_ensemble , iens );
+  bool complete = (data_stamp != 0) && (misfit_member_get_data_stamp( member ) == data_stamp);
+  hash_iter_type * obs_iter = enkf_obs_alloc_iter( enkf_obs );
+
+  while (complete && !hash_iter_is_complete( obs_iter )) {
+    const char * obs_key = hash_iter_get_next_key( obs_iter );
+    complete = misfit_member_has_ts( member , obs_key );
+  }
+
+  hash_iter_free( obs_iter );
+  return complete;
+}
+
+
+/**
+   Will update the misfit table; only the realisations which are not
+   already up to date, see misfit_ensemble_member_complete(), are
+   evaluated. If the history length or the observations have changed
+   the whole table is recalculated.
+*/
+
 void misfit_ensemble_update( misfit_ensemble_type * misfit_ensemble , const ensemble_config_type * ensemble_config , const enkf_obs_type * enkf_obs , enkf_fs_type * fs , int ens_size , int history_length) {
-  misfit_ensemble_clear( misfit_ensemble );
+  long obs_hash = misfit_ensemble_alloc_obs_hash( enkf_obs , history_length );
+
+  if ((misfit_ensemble->history_length != history_length) || (misfit_ensemble->obs_hash != obs_hash))
+    misfit_ensemble_clear( misfit_ensemble );
+
+  misfit_ensemble->history_length = history_length;
+  misfit_ensemble->obs_hash       = obs_hash;
+  misfit_ensemble_set_ens_size( misfit_ensemble , ens_size );
   {
-    state_enum cmp_state           = FORECAST;
-    msg_type * msg                 = msg_alloc("Evaluating misfit for observation: " , false);
-    double ** chi2_work            = __2d_malloc( history_length + 1 , ens_size );
-    bool_vector_type * iens_valid  = bool_vector_alloc( ens_size , true );
-    
-    hash_iter_type * obs_iter = enkf_obs_alloc_iter( enkf_obs );
-    const char * obs_key      = hash_iter_get_next_key( obs_iter );
-    
-    misfit_ensemble->history_length = history_length;
-    misfit_ensemble_set_ens_size( misfit_ensemble , ens_size );
-    
-    msg_show( msg );
-    while (obs_key != NULL) {
-      obs_vector_type * obs_vector = enkf_obs_get_vector( enkf_obs , obs_key );
-      msg_update( msg , obs_key );
-      
-      bool_vector_reset( iens_valid );
-      bool_vector_iset( iens_valid , ens_size - 1 , true );
-      obs_vector_ensemble_chi2( obs_vector , 
-                                fs , 
-                                iens_valid , 
-                                0 , 
-                                misfit_ensemble->history_length, 
-                                0 , 
-                                ens_size , 
-                                cmp_state , 
-                                chi2_work);
-      
-      /** 
-          Internalizing the results from the chi2_work table into the misfit structure.
-      */
-      for (int iens = 0; iens < ens_size; iens++) {
-        misfit_member_type * node = misfit_ensemble_iget_member( misfit_ensemble , iens );
-        if (bool_vector_iget( iens_valid , iens))
-          misfit_member_update( node , obs_key , misfit_ensemble->history_length , iens , (const double **) chi2_work);
+    long_vector_type * data_stamp = long_vector_alloc( ens_size , 0 );
+    int_vector_type * iens_list   = int_vector_alloc( 0 , 0 );
+
+    for (int iens = 0; iens < ens_size; iens++) {
+      long_vector_iset( data_stamp , iens , enkf_fs_get_member_data_stamp( fs , iens ));
+      if (!misfit_ensemble_member_complete( misfit_ensemble , enkf_obs , iens , long_vector_iget( data_stamp , iens ))) {
+        misfit_member_clear( misfit_ensemble_iget_member( misfit_ensemble , iens ));
+        int_vector_append( iens_list , iens );
       }
-      obs_key = hash_iter_get_next_key( obs_iter );
     }
-    
-    bool_vector_free( iens_valid );
-    msg_free(msg , true );
-    hash_iter_free( obs_iter );
-    
-    __2d_free( chi2_work , misfit_ensemble->history_length + 1);
-    misfit_ensemble->initialized = true;
+
+    if (int_vector_size( iens_list ) > 0) {
+      const int num_threads = util_int_min( misfit_ensemble->num_threads , int_vector_size( iens_list ));
+      thread_pool_type * tp = thread_pool_alloc( num_threads , true );
+      misfit_update_info_type info;
+
+      info.misfit_ensemble = misfit_ensemble;
+      info.groups          = misfit_ensemble_alloc_groups( enkf_obs , history_length );
+      info.iens_list       = iens_list;
+      info.data_stamp      = data_stamp;
+      info.fs              = fs;
+      info.next_index      = 0;
+      pthread_mutex_init( &info.lock , NULL );
+
+      for (int ithread = 0; ithread < num_threads; ithread++)
+        thread_pool_add_job( tp , misfit_ensemble_update_mt , &info );
+      thread_pool_join( tp );
+
+      thread_pool_free( tp );
+      pthread_mutex_destroy( &info.lock );
+      vector_free( (vector_type *) info.groups );
+    }
+    int_vector_free( iens_list );
+    long_vector_free( data_stamp );
   }
+  misfit_ensemble->initialized = true;
 }
 
 
+void misfit_ensemble_set_num_threads( misfit_ensemble_type * misfit_ensemble , int num_threads) {
+  if (num_threads > 0)
+    misfit_ensemble->num_threads = num_threads;
+  else
+    util_abort("%s: invalid number of threads:%d \n",__func__ , num_threads);
+}
+
+
+int misfit_ensemble_get_num_threads( const misfit_ensemble_type * misfit_ensemble ) {
+  return misfit_ensemble->num_threads;
+}
+
+
+/**
+   The file starts with the type id and a version number; a file
+   written by an older version is ignored, and the table is then
+   recalculated on the next misfit_ensemble_update().
+*/
+
 void misfit_ensemble_fwrite( const misfit_ensemble_type * misfit_ensemble , FILE * stream ) {
   int ens_size = vector_get_size( misfit_ensemble->ensemble);
+  util_fwrite_int( MISFIT_ENSEMBLE_TYPE_ID , stream );
+  util_fwrite_int( MISFIT_ENSEMBLE_VERSION , stream );
   util_fwrite_int( misfit_ensemble->history_length , stream );
+  util_fwrite_long( misfit_ensemble->obs_hash , stream );
   util_fwrite_int( vector_get_size( misfit_ensemble->ensemble ) , stream);
 
   /* Writing the nodes - one for each ensemble member */
@@ -155,6 +460,9 @@ static misfit_ensemble_type * misfit_ensemble_alloc_empty() {
   misfit_ensemble_type * table    = util_malloc( sizeof * table );
 
   table->initialized     = false;
+  table->history_length  = -1;
+  table->obs_hash        = 0;
+  table->num_threads     = util_int_max( 1 , sysconf( _SC_NPROCESSORS_ONLN ));
   table->ensemble        = vector_alloc_new();
   
   return table;
@@ -162,22 +470,18 @@ static misfit_ensemble_type * misfit_ensemble_alloc_empty() {
 
 
 /**
-   This funcion is a feeble attempt at allowing the ensemble size to
-   change runtime. If the new ensemble size is larger than the current
-   ensemble size ALL the currently internalized misfit information is
-   dropped on the floor; if the the ensemble is shrinked only the the
-   last elements of the misfit table are discarded (NOT exactly battle-tested).
-
+   This funcion allows the ensemble size to change runtime. If the new
+   ensemble size is larger than the current ensemble size empty
+   misfit_member instances are added for the new realisations, which
+   will then be evaluated on the next call to misfit_ensemble_update();
+   if the the ensemble is shrinked only the the last elements of the
+   misfit table are discarded.
 */
 void misfit_ensemble_set_ens_size( misfit_ensemble_type * misfit_ensemble , int ens_size) {
   int iens;
   if (ens_size > vector_get_size( misfit_ensemble->ensemble )) {
-    /* The new ensemble is larger than what we have currently internalized, 
-       we drop everything and add empty misfit_member instances. */
-    vector_clear( misfit_ensemble->ensemble );
-    for (iens = 0; iens < ens_size; iens++)
+    for (iens = vector_get_size( misfit_ensemble->ensemble ); iens < ens_size; iens++)
       vector_append_owned_ref( misfit_ensemble->ensemble , misfit_member_alloc( iens ) , misfit_member_free__);
-    
   } else 
     /* We shrink the vector by removing the last elements. */
     vector_shrink( misfit_ensemble->ensemble , ens_size);
@@ -186,10 +490,16 @@ void misfit_ensemble_set_ens_size( misfit_ensemble_type * misfit_ensemble , int
 
 void misfit_ensemble_fread( misfit_ensemble_type * misfit_ensemble , FILE * stream ) {
   misfit_ensemble_clear( misfit_ensemble );
+  if (util_fread_int( stream ) != MISFIT_ENSEMBLE_TYPE_ID)
+    return;
+
+  if (util_fread_int( stream ) != MISFIT_ENSEMBLE_VERSION)
+    return;
   {
     int ens_size;
     
     misfit_ensemble->history_length = util_fread_int( stream );
+    misfit_ensemble->obs_hash       = util_fread_long( stream );
     ens_size                        = util_fread_int( stream );
     misfit_ensemble_set_ens_size( misfit_ensemble , ens_size );
     {
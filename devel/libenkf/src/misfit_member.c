@@ -31,6 +31,7 @@
 struct misfit_member_struct {
   UTIL_TYPE_ID_DECLARATION;
   int          my_iens;
+  long         data_stamp;    /* The enkf_fs data stamp of the simulated data the misfit values were calculated from. */
   hash_type   *obs;           /* hash table of misfit_ts_type instances - indexed by observation keys. The structure
                                  of this hash table is duplicated for each ensemble member.*/
 };
@@ -55,6 +56,7 @@ misfit_member_type * misfit_member_alloc(int iens) {
   misfit_member_type * node = util_malloc( sizeof * node );
   UTIL_TYPE_ID_INIT( node , MISFIT_MEMBER_TYPE_ID);
   node->my_iens    = iens;
+  node->data_stamp = 0;
   node->obs        = hash_alloc();
   return node;
 }
@@ -88,8 +90,42 @@ void misfit_member_update( misfit_member_type * node , const char * obs_key , in
 }
 
 
+/**
+   Stores the chi2 values chi2[0..history_length] for one observation
+   key, i.e. the same as misfit_member_update() for a plain vector.
+*/
+
+void misfit_member_update_ts( misfit_member_type * node , const char * obs_key , int history_length , const double * chi2) {
+  misfit_ts_type * vector = misfit_member_safe_get_vector( node , obs_key , history_length );
+  for (int step = 0; step <= history_length; step++) 
+    misfit_ts_iset( vector , step , chi2[step]);
+}
+
+
+void misfit_member_clear( misfit_member_type * node ) {
+  hash_clear( node->obs );
+  node->data_stamp = 0;
+}
+
+
+long misfit_member_get_data_stamp( const misfit_member_type * node ) {
+  return node->data_stamp;
+}
+
+
+void misfit_member_set_data_stamp( misfit_member_type * node , long data_stamp ) {
+  node->data_stamp = data_stamp;
+}
+
+
+int misfit_member_get_size( const misfit_member_type * node ) {
+  return hash_get_size( node->obs );
+}
+
+
 void misfit_member_fwrite( const misfit_member_type * node , FILE * stream) {
   util_fwrite_int( node->my_iens , stream);
+  util_fwrite_long( node->data_stamp , stream);
   util_fwrite_int( hash_get_size( node->obs ) , stream);
   {
     hash_iter_type * obs_iter = hash_iter_alloc( node->obs );
@@ -107,7 +143,10 @@ void misfit_member_fwrite( const misfit_member_type * node , FILE * stream) {
 misfit_member_type * misfit_member_fread_alloc( FILE * stream ) {
   int my_iens                = util_fread_int( stream );
   misfit_member_type * node = misfit_member_alloc( my_iens );
-  int hash_size = util_fread_int( stream );
+  int hash_size;
+
+  node->data_stamp = util_fread_long( stream );
+  hash_size        = util_fread_int( stream );
   {
     int iobs;
     for (iobs = 0; iobs < hash_size; iobs++) {
@@ -174,6 +174,22 @@ double obs_block_iget_value( const obs_block_type * obs_block , int iobs) {
 }
 
 
+/**
+   Direct access to the observed values and std of the block; both
+   vectors have obs_block->size elements, i.e. inactive observations
+   are included.
+*/
+
+const double * obs_block_get_value_ptr( const obs_block_type * obs_block ) {
+  return obs_block->value;
+}
+
+
+const double * obs_block_get_std_ptr( const obs_block_type * obs_block ) {
+  return obs_block->std;
+}
+
+
 active_type obs_block_iget_active_mode( const obs_block_type * obs_block , int iobs) {
   return obs_block->active_mode[ iobs ];
 }
@@ -215,12 +231,12 @@ static void obs_block_init_innov( const obs_block_type * obs_block , const meas_
 }
 */
 
-static void obs_block_initdObs( const obs_block_type * obs_block , matrix_type * dObs , int * __obs_offset) {
+static void obs_block_initdObs( const obs_block_type * obs_block , double * dObs , int * __obs_offset) {
   int obs_offset = *__obs_offset;
   int iobs;
   for (iobs =0; iobs < obs_block->size; iobs++) {
     if (obs_block->active_mode[iobs] == ACTIVE) {
-      matrix_iset( dObs , obs_offset , 0 , obs_block->value[ iobs ]);
+      dObs[ obs_offset ] = obs_block->value[ iobs ];
       obs_offset++;
     }
   }
@@ -267,34 +283,18 @@ static void obs_block_initR( const obs_block_type * obs_block , matrix_type * R,
 
 
 
-static void obs_block_initE( const obs_block_type * obs_block , matrix_type * E, const double * pert_var , int * __obs_offset) {
-  int ens_size   = matrix_get_columns( E );
-  int obs_offset = *__obs_offset;
-  int iobs;
-  for (iobs =0; iobs < obs_block->size; iobs++) {
-    if (obs_block->active_mode[iobs] == ACTIVE) {
-      double factor = obs_block->std[iobs] * sqrt( ens_size / pert_var[ obs_offset ]);
-      for (int iens = 0; iens < ens_size; iens++) 
-        matrix_imul(E , obs_offset , iens , factor );
-
-      obs_offset++;
-    }
-  }
-  
-  *__obs_offset = obs_offset;
-}
-
+/*
+  The initE functions calculate one scale factor for each active
+  observation; the factors are applied to the rows of E with
+  matrix_scale_rows().
+*/
 
-static void obs_block_initE_non_centred( const obs_block_type * obs_block , matrix_type * E, int * __obs_offset) {
-  int ens_size   = matrix_get_columns( E );
+static void obs_block_initE( const obs_block_type * obs_block , double * scale_factor , int ens_size , const double * pert_var , int * __obs_offset) {
   int obs_offset = *__obs_offset;
   int iobs;
   for (iobs =0; iobs < obs_block->size; iobs++) {
     if (obs_block->active_mode[iobs] == ACTIVE) {
-      double factor = obs_block->std[iobs];
-      for (int iens = 0; iens < ens_size; iens++) 
-        matrix_imul(E , obs_offset , iens , factor );
-
+      scale_factor[ obs_offset ] = obs_block->std[iobs] * sqrt( ens_size / pert_var[ obs_offset ]);
       obs_offset++;
     }
   }
@@ -303,16 +303,12 @@ static void obs_block_initE_non_centred( const obs_block_type * obs_block , matr
 }
 
 
-
-static void obs_block_initD( const obs_block_type * obs_block , matrix_type * D, int * __obs_offset) {
-  int ens_size   = matrix_get_columns( D );
+static void obs_block_initE_non_centred( const obs_block_type * obs_block , double * scale_factor , int * __obs_offset) {
   int obs_offset = *__obs_offset;
   int iobs;
   for (iobs =0; iobs < obs_block->size; iobs++) {
     if (obs_block->active_mode[iobs] == ACTIVE) {
-      for (int iens = 0; iens < ens_size; iens++) 
-        matrix_iadd(D , obs_offset , iens , obs_block->value[ iobs ]);
-      
+      scale_factor[ obs_offset ] = obs_block->std[iobs];
       obs_offset++;
     }
   }
@@ -362,51 +358,50 @@ void obs_data_free(obs_data_type * obs_data) {
 
 
 matrix_type * obs_data_allocE(const obs_data_type * obs_data , rng_type * rng , int ens_size, int active_size ) {
-  double *pert_mean , *pert_var;
+  double *pert_mean , *pert_var , *scale_factor;
+  double *tmp;
   matrix_type * E;
   int iens, iobs_active;
   
-  E         = matrix_alloc( active_size , ens_size);
+  E            = matrix_alloc( active_size , ens_size);
+  pert_mean    = util_calloc(active_size , sizeof * pert_mean );
+  pert_var     = util_calloc(active_size , sizeof * pert_var  );
+  scale_factor = util_calloc(active_size , sizeof * scale_factor );
 
-  pert_mean = util_calloc(active_size , sizeof * pert_mean );
-  pert_var  = util_calloc(active_size , sizeof * pert_var  );
-  {
-    double * tmp = util_calloc( active_size * ens_size , sizeof * tmp );
-    int i,j;
-    int k = 0;
-    
-    enkf_util_rand_stdnormal_vector(active_size * ens_size , tmp , rng);
-    for (j=0; j < ens_size; j++) {
-      for (i=0; i < active_size; i++) {
-        matrix_iset( E , i , j , tmp[k]);
-        k++;
-      }
-    }
-    free(tmp);
-  }
+  /*
+    The random numbers are drawn, centered and accumulated in the tmp
+    buffer which has the same column major layout as E; the columns
+    are then copied into E.
+  */
+  tmp = util_calloc( active_size * ens_size , sizeof * tmp );
+  enkf_util_rand_stdnormal_vector(active_size * ens_size , tmp , rng);
   
   for (iobs_active = 0; iobs_active < active_size; iobs_active++) {
     pert_mean[iobs_active] = 0;
     pert_var[iobs_active]  = 0;
   }
   
-  for (iens = 0; iens < ens_size; iens++) 
+  for (iens = 0; iens < ens_size; iens++) {
+    const double * column = &tmp[ iens * active_size ];
     for (iobs_active = 0; iobs_active < active_size; iobs_active++) 
-      pert_mean[iobs_active] += matrix_iget(E , iobs_active , iens);
-  
+      pert_mean[iobs_active] += column[iobs_active];
+  }
 
   for (iobs_active = 0; iobs_active < active_size; iobs_active++) 
     pert_mean[iobs_active] /= ens_size;
 
   for  (iens = 0; iens < ens_size; iens++) {
+    double * column = &tmp[ iens * active_size ];
     for (iobs_active = 0; iobs_active < active_size; iobs_active++) {
-      double tmp;
-      matrix_iadd(E , iobs_active , iens , -pert_mean[iobs_active]);
-      tmp = matrix_iget(E , iobs_active , iens);
-      pert_var[iobs_active] += tmp * tmp;
+      column[iobs_active] -= pert_mean[iobs_active];
+      pert_var[iobs_active] += column[iobs_active] * column[iobs_active];
     }
   }
 
+  for (iens = 0; iens < ens_size; iens++) 
+    matrix_set_column( E , &tmp[ iens * active_size ] , iens );
+  free( tmp );
+
   /*
     The actual observed data are not accessed before this last block. 
   */
@@ -414,12 +409,14 @@ matrix_type * obs_data_allocE(const obs_data_type * obs_data , rng_type * rng ,
     int obs_offset = 0;
     for (int block_nr = 0; block_nr < vector_get_size( obs_data->data ); block_nr++) {
       const obs_block_type * obs_block = vector_iget_const( obs_data->data , block_nr);
-      obs_block_initE( obs_block , E , pert_var , &obs_offset);
+      obs_block_initE( obs_block , scale_factor , ens_size , pert_var , &obs_offset);
     }
   }
+  matrix_scale_rows( E , scale_factor );
 
   free(pert_mean);
   free(pert_var);
+  free(scale_factor);
 
   matrix_set_name( E , "E");
   matrix_assert_finite( E );
@@ -440,16 +437,11 @@ matrix_type * obs_data_allocE_non_centred(const obs_data_type * obs_data , rng_t
 
   {
     double * tmp = util_calloc( active_size * ens_size , sizeof * tmp );
-    int i,j;
-    int k = 0;
     
     enkf_util_rand_stdnormal_vector(active_size * ens_size , tmp , rng); 
-    for (j=0; j < ens_size; j++) {
-      for (i=0; i < active_size; i++) {
-        matrix_iset( E , i , j , tmp[k]);
-        k++;
-      }
-    }
+    for (int iens = 0; iens < ens_size; iens++) 
+      matrix_set_column( E , &tmp[ iens * active_size ] , iens );
+    
     free(tmp);
   }
   
@@ -458,11 +450,14 @@ matrix_type * obs_data_allocE_non_centred(const obs_data_type * obs_data , rng_t
     The actual observed data are not accessed before this last block. 
   */
   {
+    double * scale_factor = util_calloc( active_size , sizeof * scale_factor );
     int obs_offset = 0;
     for (int block_nr = 0; block_nr < vector_get_size( obs_data->data ); block_nr++) {
       const obs_block_type * obs_block = vector_iget_const( obs_data->data , block_nr);
-      obs_block_initE_non_centred( obs_block , E , &obs_offset);
+      obs_block_initE_non_centred( obs_block , scale_factor , &obs_offset);
     }
+    matrix_scale_rows( E , scale_factor );
+    free( scale_factor );
   }
 
 
@@ -476,11 +471,14 @@ matrix_type * obs_data_allocD(const obs_data_type * obs_data , const matrix_type
   matrix_inplace_sub( D , S );
 
   {
+    double * dObs = util_calloc( matrix_get_rows( D ) , sizeof * dObs );
     int obs_offset = 0;
     for (int block_nr = 0; block_nr < vector_get_size( obs_data->data ); block_nr++) {
       const obs_block_type * obs_block = vector_iget_const( obs_data->data , block_nr);
-      obs_block_initD( obs_block , D , &obs_offset);
+      obs_block_initdObs( obs_block , dObs , &obs_offset);
     }
+    matrix_shift_rows( D , dObs );
+    free( dObs );
   }
   
   matrix_set_name( D , "D");
@@ -527,12 +525,15 @@ matrix_type * obs_data_alloc_innov(const obs_data_type * obs_data , const meas_d
 matrix_type * obs_data_allocdObs(const obs_data_type * obs_data , int active_size) {
   matrix_type * dObs = matrix_alloc( active_size , 1 );
   {
+    double * data = util_calloc( active_size , sizeof * data );
     int obs_offset = 0;
     for (int block_nr = 0; block_nr < vector_get_size( obs_data->data ); block_nr++) {
       const obs_block_type * obs_block   = vector_iget_const( obs_data->data , block_nr );
       
-      obs_block_initdObs( obs_block ,  dObs , &obs_offset);
+      obs_block_initdObs( obs_block ,  data , &obs_offset);
     }
+    matrix_set_column( dObs , data , 0 );
+    free( data );
   }
   return dObs;
 }
@@ -541,9 +542,7 @@ matrix_type * obs_data_allocdObs(const obs_data_type * obs_data , int active_siz
 
 void obs_data_scale(const obs_data_type * obs_data , matrix_type *S , matrix_type *E , matrix_type *D , matrix_type *R , matrix_type * dObs) {
   const int nrobs_active = matrix_get_rows( S );
-  const int ens_size     = matrix_get_columns( S );
   double * scale_factor  = util_calloc(nrobs_active , sizeof * scale_factor );
-  int iens, iobs_active;
   
   {
     int obs_offset = 0;
@@ -556,28 +555,22 @@ void obs_data_scale(const obs_data_type * obs_data , matrix_type *S , matrix_typ
   }
 
 
-  for  (iens = 0; iens < ens_size; iens++) {
-    for (iobs_active = 0; iobs_active < nrobs_active; iobs_active++) {
-
-      /* Scale the forecasted data so that they (in theory) have the same variance 
-         (if the prior distribution for the observation errors is correct) */
-      matrix_imul(S , iobs_active , iens , scale_factor[iobs_active]);
+  /* Scale the forecasted data so that they (in theory) have the same variance 
+     (if the prior distribution for the observation errors is correct) */
+  matrix_scale_rows( S , scale_factor );
 
-      if (D != NULL)
-        /* Scale the combined data matrix: D = DObs + E - S, where DObs is the iobs_active times ens_size matrix where 
-           each column contains a copy of the observed data
-         */
-        matrix_imul(D , iobs_active , iens , scale_factor[iobs_active]);
+  if (D != NULL)
+    /* Scale the combined data matrix: D = DObs + E - S, where DObs is the iobs_active times ens_size matrix where 
+       each column contains a copy of the observed data
+    */
+    matrix_scale_rows( D , scale_factor );
 
-      if (E != NULL)
-        /* Same with E (used for low rank representation of the error covariance matrix*/
-        matrix_imul(E , iobs_active , iens , scale_factor[iobs_active]);
-    }
-  }
+  if (E != NULL)
+    /* Same with E (used for low rank representation of the error covariance matrix*/
+    matrix_scale_rows( E , scale_factor );
   
   if (dObs != NULL)
-    for (iobs_active = 0; iobs_active < nrobs_active; iobs_active++) 
-      matrix_imul( dObs , iobs_active , 0 , scale_factor[iobs_active]);
+    matrix_scale_rows( dObs , scale_factor );
   
   if (R != NULL) {
     /* Scale the error covariance matrix*/
@@ -591,9 +584,8 @@ void obs_data_scale(const obs_data_type * obs_data , matrix_type *S , matrix_typ
 
 void obs_data_scale_kernel(const obs_data_type * obs_data , matrix_type *S , matrix_type *E , matrix_type *D , double *dObs) {
   const int nrobs_active = matrix_get_rows( S );
-  const int ens_size     = matrix_get_columns( S );
   double * scale_factor  = util_calloc(nrobs_active , sizeof * scale_factor );
-  int iens, iobs_active;
+  int iobs_active;
   
   {
     int obs_offset = 0;
@@ -606,24 +598,19 @@ void obs_data_scale_kernel(const obs_data_type * obs_data , matrix_type *S , mat
   }
 
 
-  for  (iens = 0; iens < ens_size; iens++) {
-    for (iobs_active = 0; iobs_active < nrobs_active; iobs_active++) {
+  /* Scale the forecasted data so that they (in theory) have the same variance 
+     (if the prior distribution for the observation errors is correct) */
+  matrix_scale_rows( S , scale_factor );
 
-      /* Scale the forecasted data so that they (in theory) have the same variance 
-         (if the prior distribution for the observation errors is correct) */
-      matrix_imul(S , iobs_active , iens , scale_factor[iobs_active]);
+  if (D != NULL)
+    /* Scale the combined data matrix: D = DObs + E - S, where DObs is the iobs_active times ens_size matrix where 
+       each column contains a copy of the observed data
+    */
+    matrix_scale_rows( D , scale_factor );
 
-      if (D != NULL)
-        /* Scale the combined data matrix: D = DObs + E - S, where DObs is the iobs_active times ens_size matrix where 
-           each column contains a copy of the observed data
-         */
-        matrix_imul(D , iobs_active , iens , scale_factor[iobs_active]);
-      
-      if (E != NULL)
-        /* Same with E (used for low rank representation of the error covariance matrix*/
-        matrix_imul(E , iobs_active , iens , scale_factor[iobs_active]);
-    }
-  }
+  if (E != NULL)
+    /* Same with E (used for low rank representation of the error covariance matrix*/
+    matrix_scale_rows( E , scale_factor );
   
   /* Scale the vector of observed data*/
   if (dObs != NULL) {
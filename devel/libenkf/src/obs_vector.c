@@ -814,6 +814,19 @@ static double obs_vector_chi2__(const obs_vector_type * obs_vector , int report_
 
 
 
+/**
+   Evaluates the chi2 for an enkf_node instance which has already been
+   loaded by the calling scope; this way several observations of the
+   same state_kw can share one load. For nodes with vector storage the
+   node should hold the full vector.
+*/
+
+double obs_vector_chi2_node(const obs_vector_type * obs_vector , const enkf_node_type * node , node_id_type node_id) {
+  return obs_vector_chi2__( obs_vector , node_id.report_step , node , node_id );
+}
+
+
+
 double obs_vector_chi2(const obs_vector_type * obs_vector , enkf_fs_type * fs , node_id_type node_id) {
   enkf_node_type * enkf_node = enkf_node_alloc( obs_vector->config_node );
   double chi2 = 0;
@@ -0,0 +1,344 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'packed_param.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <ert/util/util.h>
+#include <ert/util/matrix.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/bool_vector.h>
+
+#include <ert/enkf/active_list.h>
+#include <ert/enkf/packed_param.h>
+
+/*
+  A packed parameter file holds the full ensemble of one parameter at
+  one report step as one dense matrix, stored element-major and
+  realisation-minor, i.e. all the realisations of element 0 first,
+  then all the realisations of element 1 and so on. The layout on
+  disk is:
+
+     int     PACKED_PARAM_MAGIC
+     int     data_size
+     int     ens_size
+     int     element_size
+     char    valid[ens_size]
+     double / float  data[data_size * ens_size]
+
+  The elements are stored as float or double according to the
+  precision of the node, i.e. element_size is sizeof(float) for a
+  FIELD which is internalized as float. That way the values read back
+  from the packed file are identical to those read from the rounded
+  nodes.
+
+  The valid flags are cleared when the per-realisation node is written
+  by some other route, so a packed file is never used for a
+  realisation where it has become stale.
+
+  The data is read and written in blocks of rows, which are transposed
+  in memory to/from the column-major layout of the A matrix used in
+  the analysis. The files are written to a temporary file and renamed
+  in place, so readers never see a partially written file.
+*/
+
+#define PACKED_PARAM_MAGIC       1180430
+#define PACKED_PARAM_BLOCK_BYTES (1 << 20)
+
+
+static long packed_param_valid_offset( int iens ) {
+  return 4 * sizeof(int) + iens * sizeof(char);
+}
+
+
+static long packed_param_data_offset( int ens_size ) {
+  return packed_param_valid_offset( ens_size );
+}
+
+
+static int packed_param_block_rows( int ens_size ) {
+  return util_int_max( 1 , PACKED_PARAM_BLOCK_BYTES / (ens_size * sizeof(double)));
+}
+
+
+/*
+  Will open the file and read the header; returns NULL if the file
+  does not exist or is not a packed parameter file.
+*/
+
+static FILE * packed_param_fopen( const char * filename , const char * mode , int * data_size , int * ens_size , int * element_size) {
+  FILE * stream = NULL;
+  if (util_file_exists( filename )) {
+    stream = util_fopen( filename , mode );
+    if (util_fread_int( stream ) == PACKED_PARAM_MAGIC) {
+      *data_size    = util_fread_int( stream );
+      *ens_size     = util_fread_int( stream );
+      *element_size = util_fread_int( stream );
+      if ((*element_size != sizeof(float)) && (*element_size != sizeof(double))) {
+        fclose( stream );
+        stream = NULL;
+      }
+    } else {
+      fclose( stream );
+      stream = NULL;
+    }
+  }
+  return stream;
+}
+
+
+/*
+  The block buffers are always double; when the file is stored as
+  float the values are converted through the float buffer, which
+  must then have room for count elements.
+*/
+
+static void packed_param_fwrite_values( const double * buffer , float * float_buffer , int count , int element_size , FILE * stream) {
+  if (element_size == sizeof(double))
+    util_fwrite( buffer , sizeof * buffer , count , stream , __func__ );
+  else {
+    for (int i = 0; i < count; i++)
+      float_buffer[i] = buffer[i];
+    util_fwrite( float_buffer , sizeof * float_buffer , count , stream , __func__ );
+  }
+}
+
+
+static void packed_param_fread_values( double * buffer , float * float_buffer , int count , int element_size , FILE * stream) {
+  if (element_size == sizeof(double))
+    util_fread( buffer , sizeof * buffer , count , stream , __func__ );
+  else {
+    util_fread( float_buffer , sizeof * float_buffer , count , stream , __func__ );
+    for (int i = 0; i < count; i++)
+      buffer[i] = float_buffer[i];
+  }
+}
+
+
+static float * packed_param_alloc_float_buffer( int size , int element_size ) {
+  if (element_size == sizeof(float))
+    return util_calloc( size , sizeof(float) );
+  else
+    return NULL;
+}
+
+
+bool packed_param_fwrite( const char * filename ,
+                          const matrix_type * A ,
+                          int row_offset ,
+                          int data_size ,
+                          const int_vector_type * iens_active_index ,
+                          bool float_data) {
+
+  const int ens_size      = int_vector_size( iens_active_index );
+  const int element_size  = float_data ? sizeof(float) : sizeof(double);
+  const int block_rows    = packed_param_block_rows( ens_size );
+  const int row_stride    = matrix_get_row_stride( A );
+  const int column_stride = matrix_get_column_stride( A );
+  const double * A_data   = matrix_get_data( A );
+  char * tmp_file         = util_alloc_sprintf( "%s.tmp" , filename );
+  FILE * stream           = util_mkdir_fopen( tmp_file , "w" );
+  double * buffer         = util_calloc( block_rows * ens_size , sizeof * buffer );
+  float * float_buffer    = packed_param_alloc_float_buffer( block_rows * ens_size , element_size );
+
+  util_fwrite_int( PACKED_PARAM_MAGIC , stream );
+  util_fwrite_int( data_size , stream );
+  util_fwrite_int( ens_size , stream );
+  util_fwrite_int( element_size , stream );
+  for (int iens = 0; iens < ens_size; iens++)
+    fputc( (int_vector_iget( iens_active_index , iens ) >= 0) ? 1 : 0 , stream );
+
+  for (int row1 = 0; row1 < data_size; row1 += block_rows) {
+    int rows = util_int_min( block_rows , data_size - row1 );
+    for (int iens = 0; iens < ens_size; iens++) {
+      int column = int_vector_iget( iens_active_index , iens );
+      if (column >= 0) {
+        const double * column_data = &A_data[ column * column_stride + (row_offset + row1) * row_stride ];
+        for (int row = 0; row < rows; row++)
+          buffer[ row * ens_size + iens ] = column_data[ row * row_stride ];
+      } else {
+        for (int row = 0; row < rows; row++)
+          buffer[ row * ens_size + iens ] = 0;
+      }
+    }
+    packed_param_fwrite_values( buffer , float_buffer , rows * ens_size , element_size , stream );
+  }
+
+  fclose( stream );
+  if (rename( tmp_file , filename ) != 0)
+    util_abort("%s: failed to rename %s -> %s \n",__func__ , tmp_file , filename);
+
+  util_safe_free( float_buffer );
+  free( buffer );
+  free( tmp_file );
+  return true;
+}
+
+
+/*
+  Reads the rows given by the active list into the A matrix starting
+  at row_offset; column j of A is filled with realisation iens where
+  iens_active_index[iens] == j. Returns false without touching A if
+  the file is missing, has the wrong shape, or if any of the
+  realisations needed are not valid in the file.
+*/
+
+bool packed_param_fread_rows( const char * filename ,
+                              matrix_type * A ,
+                              int row_offset ,
+                              int data_size ,
+                              const active_list_type * active_list ,
+                              const int_vector_type * iens_active_index) {
+  int file_data_size , file_ens_size , element_size;
+  FILE * stream = packed_param_fopen( filename , "r" , &file_data_size , &file_ens_size , &element_size );
+  bool ok = false;
+
+  if (stream != NULL) {
+    const int ens_size = int_vector_size( iens_active_index );
+
+    if ((file_data_size == data_size) && (file_ens_size == ens_size)) {
+      char * valid = util_calloc( ens_size , sizeof * valid );
+      util_fread( valid , sizeof * valid , ens_size , stream , __func__ );
+
+      ok = true;
+      for (int iens = 0; iens < ens_size; iens++)
+        if ((int_vector_iget( iens_active_index , iens ) >= 0) && !valid[iens])
+          ok = false;
+
+      if (ok) {
+        const int block_rows    = packed_param_block_rows( ens_size );
+        const int row_stride    = matrix_get_row_stride( A );
+        const int column_stride = matrix_get_column_stride( A );
+        double * A_data         = matrix_get_data( A );
+        const int * active      = active_list_get_active( active_list );
+        int active_size         = active_list_get_active_size( active_list , data_size );
+        double * buffer         = util_calloc( block_rows * ens_size , sizeof * buffer );
+        float * float_buffer    = packed_param_alloc_float_buffer( block_rows * ens_size , element_size );
+        int block_start         = -1;
+        int block_size          = 0;
+
+        for (int arow = 0; arow < active_size; arow++) {
+          int row = (active == NULL) ? arow : active[arow];
+
+          if ((row < block_start) || (row >= block_start + block_size)) {
+            block_start = row;
+            block_size  = util_int_min( block_rows , data_size - row );
+            util_fseek( stream , packed_param_data_offset( ens_size ) + (long) row * ens_size * element_size , SEEK_SET );
+            packed_param_fread_values( buffer , float_buffer , block_size * ens_size , element_size , stream );
+          }
+
+          {
+            const double * row_data = &buffer[ (row - block_start) * ens_size ];
+            for (int iens = 0; iens < ens_size; iens++) {
+              int column = int_vector_iget( iens_active_index , iens );
+              if (column >= 0)
+                A_data[ column * column_stride + (row_offset + arow) * row_stride ] = row_data[iens];
+            }
+          }
+        }
+        util_safe_free( float_buffer );
+        free( buffer );
+      }
+      free( valid );
+    }
+    fclose( stream );
+  }
+  return ok;
+}
+
+
+/*
+  Extracts the full data vector of one realisation. Returns false if
+  the file does not exist, has the wrong size or the realisation is
+  not valid.
+*/
+
+bool packed_param_fread_member( const char * filename , int iens , int data_size , double * data) {
+  int file_data_size , file_ens_size , element_size;
+  FILE * stream = packed_param_fopen( filename , "r" , &file_data_size , &file_ens_size , &element_size );
+  bool ok = false;
+
+  if (stream != NULL) {
+    if ((file_data_size == data_size) && (iens >= 0) && (iens < file_ens_size)) {
+      util_fseek( stream , packed_param_valid_offset( iens ) , SEEK_SET );
+      if (fgetc( stream ) == 1) {
+        const int block_rows = packed_param_block_rows( file_ens_size );
+        double * buffer      = util_calloc( block_rows * file_ens_size , sizeof * buffer );
+        float * float_buffer = packed_param_alloc_float_buffer( block_rows * file_ens_size , element_size );
+
+        util_fseek( stream , packed_param_data_offset( file_ens_size ) , SEEK_SET );
+        for (int row1 = 0; row1 < data_size; row1 += block_rows) {
+          int rows = util_int_min( block_rows , data_size - row1 );
+          packed_param_fread_values( buffer , float_buffer , rows * file_ens_size , element_size , stream );
+          for (int row = 0; row < rows; row++)
+            data[ row1 + row ] = buffer[ row * file_ens_size + iens ];
+        }
+        util_safe_free( float_buffer );
+        free( buffer );
+        ok = true;
+      }
+    }
+    fclose( stream );
+  }
+  return ok;
+}
+
+
+bool packed_param_has_member( const char * filename , int iens ) {
+  int data_size , ens_size , element_size;
+  FILE * stream = packed_param_fopen( filename , "r" , &data_size , &ens_size , &element_size );
+  bool has_member = false;
+
+  if (stream != NULL) {
+    if ((iens >= 0) && (iens < ens_size)) {
+      util_fseek( stream , packed_param_valid_offset( iens ) , SEEK_SET );
+      has_member = (fgetc( stream ) == 1);
+    }
+    fclose( stream );
+  }
+  return has_member;
+}
+
+
+/*
+  Clears the valid flag of all the realisations which are true in the
+  invalid vector; the flags are read and written back in one go, so
+  the invalidations from a full update of the ensemble cost one open
+  of the file. A missing file is silently ignored.
+*/
+
+void packed_param_invalidate_members( const char * filename , const bool_vector_type * invalid ) {
+  int data_size , ens_size , element_size;
+  FILE * stream = packed_param_fopen( filename , "r+" , &data_size , &ens_size , &element_size );
+
+  if (stream != NULL) {
+    char * valid = util_calloc( ens_size , sizeof * valid );
+    int size = util_int_min( ens_size , bool_vector_size( invalid ));
+
+    util_fread( valid , sizeof * valid , ens_size , stream , __func__ );
+    for (int iens = 0; iens < size; iens++)
+      if (bool_vector_iget( invalid , iens ))
+        valid[iens] = 0;
+
+    util_fseek( stream , packed_param_valid_offset( 0 ) , SEEK_SET );
+    util_fwrite( valid , sizeof * valid , ens_size , stream , __func__ );
+    free( valid );
+    fclose( stream );
+  }
+}
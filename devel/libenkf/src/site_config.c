@@ -117,6 +117,8 @@ struct site_config_struct {
   job_driver_type driver_type_site;
   int max_submit;
   int max_submit_site;
+  bool collect_job_resources;
+  bool collect_job_resources_site;
   char * job_script;
   char * job_script_site;
 
@@ -207,6 +209,7 @@ site_config_type * site_config_alloc_empty() {
   site_config_set_manual_url(site_config, DEFAULT_MANUAL_URL);
   site_config_set_default_browser(site_config, DEFAULT_BROWSER);
   site_config_set_max_submit(site_config, DEFAULT_MAX_SUBMIT);
+  site_config_set_collect_job_resources(site_config, DEFAULT_COLLECT_JOB_RESOURCES);
   return site_config;
 }
 
@@ -622,6 +625,17 @@ int site_config_get_max_submit(const site_config_type * site_config) {
   return job_queue_get_max_submit(site_config->job_queue);
 }
 
+void site_config_set_collect_job_resources(site_config_type * site_config, bool collect_job_resources) {
+  site_config->collect_job_resources = collect_job_resources;
+  if (!site_config->user_mode)
+    site_config->collect_job_resources_site = collect_job_resources;
+  job_queue_set_collect_resources(site_config->job_queue, collect_job_resources);
+}
+
+bool site_config_get_collect_job_resources(const site_config_type * site_config) {
+  return job_queue_get_collect_resources(site_config->job_queue);
+}
+
 static void site_config_install_job_queue(site_config_type * site_config) {
   if (site_config->job_script == NULL)
     util_exit("Must set the path to the job script with the %s key in the site_config / config file\n", JOB_SCRIPT_KEY);
@@ -706,6 +720,9 @@ bool site_config_init(site_config_type * site_config, const config_type * config
   if (config_item_set(config, MAX_SUBMIT_KEY))
     site_config_set_max_submit(site_config, config_get_value_as_int(config, MAX_SUBMIT_KEY));
 
+  if (config_item_set(config, COLLECT_JOB_RESOURCES_KEY))
+    site_config_set_collect_job_resources(site_config, config_get_value_as_bool(config, COLLECT_JOB_RESOURCES_KEY));
+
 
   /* LSF options */
   {
@@ -898,6 +915,12 @@ void site_config_fprintf_config(const site_config_type * site_config, FILE * str
     fprintf(stream, "%d\n", site_config->max_submit);
   }
 
+  /* Storing COLLECT_JOB_RESOURCES setting */
+  if (site_config->collect_job_resources != site_config->collect_job_resources_site) {
+    fprintf(stream, CONFIG_KEY_FORMAT, COLLECT_JOB_RESOURCES_KEY);
+    fprintf(stream, CONFIG_ENDVALUE_FORMAT, site_config->collect_job_resources ? "True" : "False");
+  }
+
   /* Storing LICENSE_ROOT_PATH */
   if (!util_string_equal(site_config->license_root_path, site_config->license_root_path_site)) {
     fprintf(stream, CONFIG_KEY_FORMAT, LICENSE_PATH_KEY);
@@ -1005,6 +1028,10 @@ void site_config_add_queue_config_items(config_type * config, bool site_mode) {
   item = config_add_schema_item(config, MAX_SUBMIT_KEY, false);
   config_schema_item_set_argc_minmax(item, 1, 1);
   config_schema_item_iset_type(item, 0, CONFIG_INT);
+
+  item = config_add_schema_item(config, COLLECT_JOB_RESOURCES_KEY, false);
+  config_schema_item_set_argc_minmax(item, 1, 1);
+  config_schema_item_iset_type(item, 0, CONFIG_BOOL);
 }
 
 void site_config_add_config_items(config_type * config, bool site_mode) {
@@ -0,0 +1,172 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'enkf_load_running.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_sum.h>
+
+#include <ert/job_queue/job_queue.h>
+
+#include <ert/enkf/enkf_main.h>
+
+#define NUM_REPORT    6
+#define NUM_MINISTEP  3
+#define RUN_PATH      "simulations/run0"
+#define MAX_WAIT      60
+
+
+/* Writes the summary case ref<num_report>/CASE with the first num_report report steps. */
+void write_case( int num_report ) {
+  char * path = util_alloc_sprintf( "ref%d" , num_report );
+  char * ecl_case = util_alloc_filename( path , "CASE" , NULL );
+  ecl_sum_type * ecl_sum;
+  int ministep = 0;
+
+  util_make_path( path );
+  ecl_sum = ecl_sum_alloc_writer( ecl_case , false , true , ":" , util_make_date( 1 , 1 , 2010 ) , 10 , 10 , 10 );
+  ecl_sum_add_var( ecl_sum , "FOPT" , NULL , 0 , "Barrels" , 0 );
+  ecl_sum_add_var( ecl_sum , "WOPR" , "OP-1" , 0 , "Barrels" , 0 );
+  for (int report_step = 1; report_step <= num_report; report_step++) {
+    for (int i = 0; i < NUM_MINISTEP; i++) {
+      ecl_sum_tstep_type * tstep = ecl_sum_add_tstep( ecl_sum , report_step , 10.0 * ministep + 1 );
+      ecl_sum_tstep_set_from_key( tstep , "FOPT" , 100.0 * ministep );
+      ecl_sum_tstep_set_from_key( tstep , "WOPR:OP-1" , report_step );
+      ministep++;
+    }
+  }
+  ecl_sum_fwrite( ecl_sum );
+  ecl_sum_free( ecl_sum );
+  free( ecl_case );
+  free( path );
+}
+
+
+/* The simulation has written the first num_report report steps. */
+void simulate( int num_report ) {
+  char * header_file  = util_alloc_sprintf( "ref%d/CASE.SMSPEC" , NUM_REPORT );
+  char * unified_file = util_alloc_sprintf( "ref%d/CASE.UNSMRY" , num_report );
+  util_copy_file( header_file , RUN_PATH "/CASE.SMSPEC" );
+  util_copy_file( unified_file , RUN_PATH "/CASE.UNSMRY" );
+  free( unified_file );
+  free( header_file );
+}
+
+
+bool has_summary( enkf_main_type * enkf_main , const char * key , int report_step , double * value) {
+  enkf_config_node_type * config_node = ensemble_config_get_node( enkf_main_get_ensemble_config( enkf_main ) , key );
+  enkf_node_type * node = enkf_node_alloc( config_node );
+  bool has_value = enkf_node_user_get_no_id( node , enkf_main_get_fs( enkf_main ) , key , report_step , 0 , FORECAST , value );
+  enkf_node_free( node );
+  return has_value;
+}
+
+
+void wait_summary( enkf_main_type * enkf_main , int report_step ) {
+  double value;
+  int sec = 0;
+  while (!has_summary( enkf_main , "FOPT" , report_step , &value )) {
+    test_assert_true( sec < MAX_WAIT );
+    sleep( 1 );
+    sec++;
+  }
+}
+
+
+void test_summary( enkf_main_type * enkf_main , int step1 , int step2 ) {
+  for (int report_step = step1; report_step <= step2; report_step++) {
+    double value;
+    test_assert_true( has_summary( enkf_main , "FOPT" , report_step , &value ));
+    test_assert_double_equal( 100.0 * (NUM_MINISTEP * report_step - 1) , value );
+    test_assert_true( has_summary( enkf_main , "WOPR:OP-1" , report_step , &value ));
+    test_assert_double_equal( report_step , value );
+  }
+}
+
+
+void * run_exp( void * arg ) {
+  enkf_main_type * enkf_main = enkf_main_safe_cast( arg );
+  bool_vector_type * iactive = bool_vector_alloc( 1 , true );
+  enkf_main_run_exp( enkf_main , iactive , true , 0 , 0 , ANALYZED , true );
+  bool_vector_free( iactive );
+  return NULL;
+}
+
+
+
+int main(int argc , char ** argv) {
+  const char * root_path   = argv[1];
+  const char * config_file = argv[2];
+  test_work_area_type * work_area = test_work_area_alloc( "enkf_load_running" , false );
+  test_work_area_copy_directory_content( work_area , root_path );
+  chmod( "script.sh" , S_IRWXU );   /* The copy does not preserve the mode. */
+  {
+    enkf_main_type * enkf_main = enkf_main_bootstrap( "site-config" , config_file , true , true );
+    enkf_state_type * state    = enkf_main_iget_state( enkf_main , 0 );
+    pthread_t run_thread;
+    double value;
+    
+    test_assert_int_equal( 1 , enkf_main_get_summary_load_interval( enkf_main ));
+    write_case( 2 );
+    write_case( 4 );
+    write_case( NUM_REPORT );
+    
+    pthread_create( &run_thread , NULL , run_exp , enkf_main );
+    {
+      int sec = 0;
+      while (enkf_state_get_run_status( state ) != JOB_QUEUE_RUNNING) {
+        test_assert_true( sec < 10 * MAX_WAIT );
+        usleep( 100000 );
+        sec++;
+      }
+    }
+    
+    /* The last report step in the file might still be incomplete and is left for the next load. */
+    simulate( 2 );
+    wait_summary( enkf_main , 1 );
+    test_summary( enkf_main , 1 , 1 );
+    test_assert_false( has_summary( enkf_main , "FOPT" , 2 , &value ));
+    
+    /* The second load continues from where the first stopped. */
+    simulate( 4 );
+    wait_summary( enkf_main , 3 );
+    test_summary( enkf_main , 1 , 3 );
+    test_assert_false( has_summary( enkf_main , "FOPT" , 4 , &value ));
+    test_assert_int_equal( JOB_QUEUE_RUNNING , enkf_state_get_run_status( state ));
+    
+    /* The final load picks up the rest when the job has completed. */
+    simulate( NUM_REPORT );
+    {
+      FILE * stream = util_fopen( RUN_PATH "/FINISH" , "w" );
+      fclose( stream );
+    }
+    pthread_join( run_thread , NULL );
+    test_summary( enkf_main , 1 , NUM_REPORT );
+    
+    enkf_main_free( enkf_main );
+  }
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -19,9 +19,11 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <math.h>
 
 #include <ert/util/test_util.h>
 #include <ert/util/int_vector.h>
+#include <ert/util/matrix.h>
 
 #include <ert/enkf/meas_data.h>
 
@@ -45,8 +47,59 @@ void create_test() {
 
 
 
+void stats_test() {
+  int_vector_type * ens_active_list = int_vector_alloc(0 , false);
+  for (int iens = 0; iens < 4; iens++)
+    int_vector_append( ens_active_list , iens );
+
+  {
+    meas_data_type * meas_data = meas_data_alloc( ens_active_list );
+    meas_block_type * meas_block = meas_data_add_block( meas_data , "OBS" , 10 , 3 );
+    double obs_value[3] = { 2.5 , 7.0  , 100 };
+    double obs_std[3]   = { 1.0 , 1.0  , 1.0 };
+    meas_outlier_type mask[3];
+
+    for (int iens = 0; iens < 4; iens++) {
+      meas_block_iset( meas_block , iens , 0 , iens + 1 );   /* 1,2,3,4 : mean 2.5 std sqrt(1.25) */
+      meas_block_iset( meas_block , iens , 1 , 7.0 );        /* No variation. */
+      meas_block_iset( meas_block , iens , 2 , 2 * iens );   /* 0,2,4,6 : mean 3.0 std sqrt(5) */
+    }
+    test_assert_double_equal( 3.0 , meas_block_iget( meas_block , 2 , 0 ));
+
+    meas_block_calculate_ens_stats( meas_block );
+    test_assert_double_equal( 2.5 , meas_block_iget_ens_mean( meas_block , 0 ));
+    test_assert_double_equal( sqrt( 1.25 ) , meas_block_iget_ens_std( meas_block , 0 ));
+    test_assert_double_equal( 7.0 , meas_block_iget_ens_mean( meas_block , 1 ));
+    test_assert_double_equal( 0.0 , meas_block_iget_ens_std( meas_block , 1 ));
+    test_assert_double_equal( 3.0 , meas_block_iget_ens_mean( meas_block , 2 ));
+    test_assert_double_equal( sqrt( 5.0 ) , meas_block_iget_ens_std( meas_block , 2 ));
+
+    test_assert_int_equal( 2 , meas_block_outlier_mask( meas_block , obs_value , obs_std , 0.0001 , 3 , mask ));
+    test_assert_int_equal( MEAS_BLOCK_INLIER       , mask[0] );
+    test_assert_int_equal( MEAS_BLOCK_NO_VARIATION , mask[1] );
+    test_assert_int_equal( MEAS_BLOCK_NO_OVERLAP   , mask[2] );
+
+    meas_block_deactivate( meas_block , 1 );
+    {
+      matrix_type * S = meas_data_allocS( meas_data , 2 );
+      test_assert_int_equal( 2 , matrix_get_rows( S ));
+      test_assert_int_equal( 4 , matrix_get_columns( S ));
+      for (int iens = 0; iens < 4; iens++) {
+        test_assert_double_equal( iens + 1 , matrix_iget( S , 0 , iens ));
+        test_assert_double_equal( 2 * iens , matrix_iget( S , 1 , iens ));
+      }
+      matrix_free( S );
+    }
+    meas_data_free( meas_data );
+  }
+  int_vector_free( ens_active_list );
+}
+
+
+
 int main(int argc , char ** argv) {
   create_test();
+  stats_test();
   exit(0);
 }
 
@@ -0,0 +1,239 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'enkf_misfit_ensemble.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <ert/util/test_work_area.h>
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/matrix.h>
+
+#include <ert/enkf/misfit_ensemble.h>
+#include <ert/enkf/misfit_member.h>
+#include <ert/enkf/misfit_ts.h>
+#include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/enkf_obs.h>
+#include <ert/enkf/enkf_node.h>
+#include <ert/enkf/enkf_config_node.h>
+#include <ert/enkf/obs_vector.h>
+#include <ert/enkf/summary_obs.h>
+#include <ert/enkf/summary.h>
+#include <ert/enkf/active_list.h>
+
+#define HISTORY_LENGTH 10
+#define ENS_SIZE       13
+#define SENTINEL       -1
+
+
+static void fill_member( misfit_member_type * member , int iens ) {
+  double chi2[HISTORY_LENGTH + 1];
+  for (int step = 0; step <= HISTORY_LENGTH; step++)
+    chi2[step] = iens + 0.1 * step;
+
+  misfit_member_update_ts( member , "OBS1" , HISTORY_LENGTH , chi2 );
+  misfit_member_update_ts( member , "OBS2" , HISTORY_LENGTH , chi2 );
+}
+
+
+static void test_resize( misfit_ensemble_type * misfit_ensemble ) {
+  misfit_ensemble_set_ens_size( misfit_ensemble , 5 );
+  for (int iens = 0; iens < 5; iens++)
+    fill_member( misfit_ensemble_iget_member( misfit_ensemble , iens ) , iens );
+
+  /* Growing the ensemble keeps the existing members. */
+  misfit_ensemble_set_ens_size( misfit_ensemble , 8 );
+  test_assert_int_equal( 8 , misfit_ensemble_get_ens_size( misfit_ensemble ));
+  test_assert_int_equal( 2 , misfit_member_get_size( misfit_ensemble_iget_member( misfit_ensemble , 4 )));
+  test_assert_int_equal( 0 , misfit_member_get_size( misfit_ensemble_iget_member( misfit_ensemble , 5 )));
+  {
+    misfit_ts_type * ts = misfit_member_get_ts( misfit_ensemble_iget_member( misfit_ensemble , 3 ) , "OBS1");
+    test_assert_double_equal( 6.3 , misfit_ts_eval( ts , 1 , 2 ));
+  }
+
+  misfit_ensemble_set_ens_size( misfit_ensemble , 5 );
+  test_assert_int_equal( 5 , misfit_ensemble_get_ens_size( misfit_ensemble ));
+}
+
+
+static void test_clear_member( misfit_ensemble_type * misfit_ensemble ) {
+  misfit_member_type * member = misfit_ensemble_iget_member( misfit_ensemble , 2 );
+  misfit_member_set_data_stamp( member , 77 );
+  misfit_member_clear( member );
+  test_assert_false( misfit_member_has_ts( member , "OBS1"));
+  test_assert_true( 0 == misfit_member_get_data_stamp( member ));
+  test_assert_true( misfit_member_has_ts( misfit_ensemble_iget_member( misfit_ensemble , 1 ) , "OBS1"));
+}
+
+
+static void test_fwrite_fread( const misfit_ensemble_type * misfit_ensemble ) {
+  FILE * stream = util_fopen( "misfit" , "w");
+  misfit_ensemble_fwrite( misfit_ensemble , stream );
+  fclose( stream );
+
+  {
+    misfit_ensemble_type * copy = misfit_ensemble_alloc( );
+    stream = util_fopen( "misfit" , "r");
+    misfit_ensemble_fread( copy , stream );
+    fclose( stream );
+
+    test_assert_true( misfit_ensemble_initialized( copy ));
+    test_assert_int_equal( 5 , misfit_ensemble_get_ens_size( copy ));
+    test_assert_int_equal( 0 , misfit_member_get_size( misfit_ensemble_iget_member( copy , 2 )));
+    test_assert_int_equal( 2 , misfit_member_get_size( misfit_ensemble_iget_member( copy , 4 )));
+    misfit_ensemble_free( copy );
+  }
+}
+
+
+/*****************************************************************/
+/* misfit_ensemble_update() on a summary observation with data in an enkf_fs. */
+
+/* The simulated FOPR of realisation iens at report step; offset is used to rewrite the data. */
+static double sim_value( int iens , int step , int offset ) {
+  return iens + step + offset;
+}
+
+
+static void store_member( enkf_fs_type * fs , enkf_config_node_type * config_node , int iens , int offset ) {
+  enkf_node_type * enkf_node     = enkf_node_alloc( config_node );
+  active_list_type * active_list = active_list_alloc( );
+  matrix_type * A                = matrix_alloc( 1 , 1 );
+
+  for (int step = 0; step <= HISTORY_LENGTH; step++) {
+    node_id_type node_id = {.report_step = step , .iens = iens , .state = FORECAST };
+    matrix_iset( A , 0 , 0 , sim_value( iens , step , offset ));
+    summary_deserialize__( enkf_node_value_ptr( enkf_node ) , node_id , active_list , A , 0 , 0 );
+  }
+  enkf_node_store_vector( enkf_node , fs , iens , FORECAST );
+
+  matrix_free( A );
+  active_list_free( active_list );
+  enkf_node_free( enkf_node );
+}
+
+
+/* The observations are at step 2 (value 1, std 1) and step 5 (value 3, std 2); std_scale scales both errors. */
+static double expected_misfit( int iens , int offset , double std_scale ) {
+  double x2 = (sim_value( iens , 2 , offset ) - 1) / (1 * std_scale);
+  double x5 = (sim_value( iens , 5 , offset ) - 3) / (2 * std_scale);
+  return x2 * x2 + x5 * x5;
+}
+
+
+static double member_misfit( const misfit_ensemble_type * misfit_ensemble , int iens ) {
+  const misfit_member_type * member = misfit_ensemble_iget_member( misfit_ensemble , iens );
+  return misfit_ts_eval( misfit_member_get_ts( member , "FOPR_OBS" ) , 0 , HISTORY_LENGTH );
+}
+
+
+static void set_sentinel( misfit_ensemble_type * misfit_ensemble , int iens ) {
+  double chi2[HISTORY_LENGTH + 1];
+  for (int step = 0; step <= HISTORY_LENGTH; step++)
+    chi2[step] = (step == 0) ? SENTINEL : 0;
+  misfit_member_update_ts( misfit_ensemble_iget_member( misfit_ensemble , iens ) , "FOPR_OBS" , HISTORY_LENGTH , chi2 );
+}
+
+
+static void test_update( ) {
+  const char * mount_point       = "fs/case";
+  enkf_config_node_type * config_node = enkf_config_node_alloc_summary( "FOPR" , LOAD_FAIL_SILENT );
+  enkf_obs_type * enkf_obs       = enkf_obs_alloc( );
+  obs_vector_type * obs_vector   = obs_vector_alloc( SUMMARY_OBS , "FOPR_OBS" , config_node , HISTORY_LENGTH + 1 );
+  enkf_fs_type * fs;
+
+  obs_vector_install_node( obs_vector , 2 , summary_obs_alloc( "FOPR" , "FOPR_OBS" , 1 , 1 , AUTO_CORRF_EXP , 0 ));
+  obs_vector_install_node( obs_vector , 5 , summary_obs_alloc( "FOPR" , "FOPR_OBS" , 3 , 2 , AUTO_CORRF_EXP , 0 ));
+  enkf_obs_add_obs_vector( enkf_obs , "FOPR_OBS" , obs_vector );
+
+  enkf_fs_create_fs( mount_point , BLOCK_FS_DRIVER_ID , NULL );
+  fs = enkf_fs_open( mount_point , false );
+  for (int iens = 0; iens < ENS_SIZE; iens++)
+    store_member( fs , config_node , iens , 0 );
+
+  {
+    misfit_ensemble_type * misfit_ensemble = enkf_fs_get_misfit_ensemble( fs );
+
+    /* Several threads; more realisations than threads, and not a multiple of the thread count. */
+    misfit_ensemble_set_num_threads( misfit_ensemble , 4 );
+    misfit_ensemble_update( misfit_ensemble , NULL , enkf_obs , fs , ENS_SIZE , HISTORY_LENGTH );
+    for (int iens = 0; iens < ENS_SIZE; iens++) {
+      test_assert_double_equal( expected_misfit( iens , 0 , 1 ) , member_misfit( misfit_ensemble , iens ));
+      test_assert_true( enkf_fs_get_member_data_stamp( fs , iens ) == misfit_member_get_data_stamp( misfit_ensemble_iget_member( misfit_ensemble , iens )));
+    }
+
+    /* Unchanged data and observations: the cached values are reused. */
+    set_sentinel( misfit_ensemble , 4 );
+    misfit_ensemble_update( misfit_ensemble , NULL , enkf_obs , fs , ENS_SIZE , HISTORY_LENGTH );
+    test_assert_double_equal( SENTINEL , member_misfit( misfit_ensemble , 4 ));
+
+    /* New data for one realisation: only that realisation is recalculated. */
+    set_sentinel( misfit_ensemble , 5 );
+    store_member( fs , config_node , 4 , 10 );
+    misfit_ensemble_update( misfit_ensemble , NULL , enkf_obs , fs , ENS_SIZE , HISTORY_LENGTH );
+    test_assert_double_equal( expected_misfit( 4 , 10 , 1 ) , member_misfit( misfit_ensemble , 4 ));
+    test_assert_double_equal( SENTINEL , member_misfit( misfit_ensemble , 5 ));
+
+    /* Changed observation errors under the same key: everything is recalculated. */
+    obs_vector_scale_std( obs_vector , 2 );
+    misfit_ensemble_update( misfit_ensemble , NULL , enkf_obs , fs , ENS_SIZE , HISTORY_LENGTH );
+    test_assert_double_equal( expected_misfit( 5 , 0 , 2 ) , member_misfit( misfit_ensemble , 5 ));
+    test_assert_double_equal( expected_misfit( 4 , 10 , 2 ) , member_misfit( misfit_ensemble , 4 ));
+
+    set_sentinel( misfit_ensemble , 6 );
+    set_sentinel( misfit_ensemble , 7 );
+  }
+  enkf_fs_close( fs );
+
+  /*
+    Data written through another mount of the case, which does not
+    know about the table held by the first one; the table persisted
+    in the case must still be recalculated for that realisation.
+  */
+  fs = enkf_fs_open( mount_point , false );
+  store_member( fs , config_node , 6 , 20 );
+  enkf_fs_close( fs );
+
+  fs = enkf_fs_open( mount_point , false );
+  {
+    misfit_ensemble_type * misfit_ensemble = enkf_fs_get_misfit_ensemble( fs );
+    test_assert_true( misfit_ensemble_initialized( misfit_ensemble ));
+    misfit_ensemble_update( misfit_ensemble , NULL , enkf_obs , fs , ENS_SIZE , HISTORY_LENGTH );
+    test_assert_double_equal( expected_misfit( 6 , 20 , 2 ) , member_misfit( misfit_ensemble , 6 ));
+    test_assert_double_equal( SENTINEL , member_misfit( misfit_ensemble , 7 ));
+  }
+  enkf_fs_close( fs );
+
+  enkf_obs_free( enkf_obs );
+  enkf_config_node_free( config_node );
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_misfit_ensemble" , false);
+  misfit_ensemble_type * misfit_ensemble = misfit_ensemble_alloc( );
+
+  test_resize( misfit_ensemble );
+  test_clear_member( misfit_ensemble );
+  test_fwrite_fread( misfit_ensemble );
+  test_update( );
+
+  misfit_ensemble_free( misfit_ensemble );
+  test_work_area_free( work_area );
+  exit(0);
+}
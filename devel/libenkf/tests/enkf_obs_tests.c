@@ -23,6 +23,10 @@
 
 int main(int argc, char ** argv) {
   enkf_obs_type * enkf_obs = enkf_obs_alloc();
+  
+  test_assert_true( enkf_obs_get_num_threads( enkf_obs ) >= 1 );
+  enkf_obs_set_num_threads( enkf_obs , 2 );
+  test_assert_int_equal( 2 , enkf_obs_get_num_threads( enkf_obs ));
 
   obs_vector_type * obs_vector = obs_vector_alloc(SUMMARY_OBS, "WWCT", NULL, 2);
   summary_obs_type * summary_obs1 = summary_obs_alloc( "SummaryKey" , "ObservationKey" , 43.2, 2.0 , AUTO_CORRF_EXP, 42);
@@ -0,0 +1,262 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'enkf_packed_param.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <ert/util/test_work_area.h>
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/matrix.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/bool_vector.h>
+#include <ert/util/buffer.h>
+
+#include <ert/enkf/active_list.h>
+#include <ert/enkf/packed_param.h>
+#include <ert/enkf/enkf_fs.h>
+
+#define ENS_SIZE  5
+#define DATA_SIZE 60000      /* Large enough to span several row blocks. */
+
+
+static double element_value( int iens , int index ) {
+  return iens * 100000 + index;
+}
+
+
+/* Realisation 2 is inactive; the active realisations map to columns 0,1,2,3. */
+static int_vector_type * alloc_active_index( ) {
+  int_vector_type * iens_active_index = int_vector_alloc( ENS_SIZE , -1 );
+  int column = 0;
+  for (int iens = 0; iens < ENS_SIZE; iens++) {
+    if (iens != 2) {
+      int_vector_iset( iens_active_index , iens , column );
+      column++;
+    }
+  }
+  return iens_active_index;
+}
+
+
+static void test_fwrite_fread( const char * filename , const int_vector_type * iens_active_index) {
+  const int row_offset = 3;
+  matrix_type * A = matrix_alloc( DATA_SIZE + row_offset , ENS_SIZE - 1 );
+
+  for (int iens = 0; iens < ENS_SIZE; iens++) {
+    int column = int_vector_iget( iens_active_index , iens );
+    if (column >= 0)
+      for (int i = 0; i < DATA_SIZE; i++)
+        matrix_iset( A , i + row_offset , column , element_value( iens , i ));
+  }
+  test_assert_true( packed_param_fwrite( filename , A , row_offset , DATA_SIZE , iens_active_index , false ));
+  test_assert_true( packed_param_has_member( filename , 0 ));
+  test_assert_false( packed_param_has_member( filename , 2 ));
+
+  {
+    active_list_type * active_list = active_list_alloc( );
+    matrix_type * B = matrix_alloc( DATA_SIZE , ENS_SIZE - 1 );
+
+    test_assert_false( packed_param_fread_rows( filename , B , 0 , DATA_SIZE + 1 , active_list , iens_active_index ));
+    test_assert_true( packed_param_fread_rows( filename , B , 0 , DATA_SIZE , active_list , iens_active_index ));
+    for (int iens = 0; iens < ENS_SIZE; iens++) {
+      int column = int_vector_iget( iens_active_index , iens );
+      if (column >= 0)
+        for (int i = 0; i < DATA_SIZE; i += 7)
+          test_assert_double_equal( element_value( iens , i ) , matrix_iget( B , i , column ));
+    }
+
+    /* Partly active, not sorted. */
+    active_list_add_index( active_list , 10 );
+    active_list_add_index( active_list , 11 );
+    active_list_add_index( active_list , 59999 );
+    active_list_add_index( active_list , 5000 );
+    test_assert_true( packed_param_fread_rows( filename , B , 1 , DATA_SIZE , active_list , iens_active_index ));
+    test_assert_double_equal( element_value( 4 , 10 )    , matrix_iget( B , 1 , 3 ));
+    test_assert_double_equal( element_value( 4 , 11 )    , matrix_iget( B , 2 , 3 ));
+    test_assert_double_equal( element_value( 4 , 59999 ) , matrix_iget( B , 3 , 3 ));
+    test_assert_double_equal( element_value( 0 , 5000 )  , matrix_iget( B , 4 , 0 ));
+
+    matrix_free( B );
+    active_list_free( active_list );
+  }
+  matrix_free( A );
+}
+
+
+static void test_member( const char * filename ) {
+  double * data = util_calloc( DATA_SIZE , sizeof * data );
+
+  test_assert_true( packed_param_fread_member( filename , 3 , DATA_SIZE , data ));
+  for (int i = 0; i < DATA_SIZE; i++)
+    test_assert_double_equal( element_value( 3 , i ) , data[i] );
+
+  test_assert_false( packed_param_fread_member( filename , 2 , DATA_SIZE , data ));
+  test_assert_false( packed_param_fread_member( filename , ENS_SIZE , DATA_SIZE , data ));
+  test_assert_false( packed_param_fread_member( "does/not/exist" , 0 , DATA_SIZE , data ));
+  free( data );
+}
+
+
+static void test_invalidate( const char * filename , const int_vector_type * iens_active_index) {
+  active_list_type * active_list = active_list_alloc( );
+  matrix_type * B = matrix_alloc( DATA_SIZE , ENS_SIZE - 1 );
+  bool_vector_type * invalid = bool_vector_alloc( 0 , false );
+
+  bool_vector_iset( invalid , 1 , true );
+  bool_vector_iset( invalid , 4 , true );
+  packed_param_invalidate_members( filename , invalid );
+  test_assert_false( packed_param_has_member( filename , 1 ));
+  test_assert_false( packed_param_has_member( filename , 4 ));
+  test_assert_true( packed_param_has_member( filename , 0 ));
+  test_assert_true( packed_param_has_member( filename , 3 ));
+  test_assert_false( packed_param_fread_rows( filename , B , 0 , DATA_SIZE , active_list , iens_active_index ));
+
+  /* Invalidating a missing file is a no-op. */
+  packed_param_invalidate_members( "does/not/exist" , invalid );
+
+  bool_vector_free( invalid );
+  matrix_free( B );
+  active_list_free( active_list );
+}
+
+
+/*
+  A float FIELD is rounded to float when the node is stored; the
+  packed file must give back exactly the same rounded values.
+*/
+
+static void test_float_precision( const int_vector_type * iens_active_index) {
+  const char * filename = "packed/FLOAT.packed";
+  const int data_size = 1000;
+  matrix_type * A = matrix_alloc( data_size , ENS_SIZE - 1 );
+  matrix_type * B = matrix_alloc( data_size , ENS_SIZE - 1 );
+  active_list_type * active_list = active_list_alloc( );
+  double * data = util_calloc( data_size , sizeof * data );
+
+  for (int i = 0; i < data_size; i++)
+    for (int j = 0; j < ENS_SIZE - 1; j++)
+      matrix_iset( A , i , j , 0.1 * i + 1.0 / (3 + j));
+
+  test_assert_true( packed_param_fwrite( filename , A , 0 , data_size , iens_active_index , true ));
+  test_assert_int_equal( 4 * sizeof(int) + ENS_SIZE + data_size * ENS_SIZE * sizeof(float) , util_file_size( filename ));
+  test_assert_true( packed_param_fread_rows( filename , B , 0 , data_size , active_list , iens_active_index ));
+  for (int i = 0; i < data_size; i++)
+    for (int j = 0; j < ENS_SIZE - 1; j++) {
+      float rounded = matrix_iget( A , i , j );
+      test_assert_true( matrix_iget( B , i , j ) == rounded );
+    }
+
+  test_assert_true( packed_param_fread_member( filename , 4 , data_size , data ));
+  for (int i = 0; i < data_size; i++) {
+    float rounded = matrix_iget( A , i , 3 );
+    test_assert_true( data[i] == rounded );
+  }
+
+  free( data );
+  active_list_free( active_list );
+  matrix_free( B );
+  matrix_free( A );
+}
+
+
+/*
+  Writing a parameter node through enkf_fs invalidates the
+  realisation in the packed file; the invalidations are batched and
+  only reach the file when the fs is synced or the packed file is
+  read.
+*/
+
+static void test_fs_invalidate( const int_vector_type * iens_active_index) {
+  const char * mount_point = "fs/case";
+  const char * key = "PARAM";
+  const int data_size = 100;
+  matrix_type * A = matrix_alloc( data_size , ENS_SIZE - 1 );
+  double * data = util_calloc( data_size , sizeof * data );
+  buffer_type * buffer = buffer_alloc( 100 );
+  enkf_fs_type * fs;
+  char * packed_file;
+
+  enkf_fs_create_fs( mount_point , BLOCK_FS_DRIVER_ID , NULL );
+  fs = enkf_fs_open( mount_point , false );
+  packed_file = enkf_fs_alloc_packed_parameter_filename( fs , key , 0 );
+  buffer_fwrite_int( buffer , 0 );
+
+  for (int i = 0; i < data_size; i++)
+    for (int j = 0; j < ENS_SIZE - 1; j++)
+      matrix_iset( A , i , j , i + 1000 * j );
+  enkf_fs_fwrite_packed_parameter( fs , key , 0 , A , 0 , data_size , iens_active_index , false );
+  test_assert_true( enkf_fs_has_packed_parameters( fs ));
+
+  enkf_fs_fwrite_node( fs , buffer , key , PARAMETER , 0 , 1 , ANALYZED );
+  enkf_fs_fwrite_node( fs , buffer , key , PARAMETER , 0 , 3 , ANALYZED );
+  test_assert_true( packed_param_has_member( packed_file , 1 ));
+  test_assert_true( packed_param_has_member( packed_file , 3 ));
+
+  test_assert_true( enkf_fs_fread_packed_member( fs , key , 0 , ANALYZED , 0 , data_size , data ));
+  test_assert_double_equal( 99 , data[99] );
+  test_assert_false( enkf_fs_fread_packed_member( fs , key , 0 , ANALYZED , 1 , data_size , data ));
+  test_assert_false( packed_param_has_member( packed_file , 3 ));
+
+  /* A packed file written after the nodes supersedes the pending invalidations. */
+  enkf_fs_fwrite_node( fs , buffer , key , PARAMETER , 0 , 4 , ANALYZED );
+  enkf_fs_fwrite_packed_parameter( fs , key , 0 , A , 0 , data_size , iens_active_index , false );
+  enkf_fs_fsync( fs );
+  test_assert_true( packed_param_has_member( packed_file , 4 ));
+
+  /* Partly active read through enkf_fs. */
+  {
+    active_list_type * active_list = active_list_alloc( );
+    matrix_type * B = matrix_alloc( 2 , ENS_SIZE - 1 );
+
+    active_list_add_index( active_list , 17 );
+    active_list_add_index( active_list , 5 );
+    test_assert_true( enkf_fs_fread_packed_parameter( fs , key , 0 , ANALYZED , active_list , data_size , B , 0 , iens_active_index ));
+    test_assert_double_equal( 17 + 3000 , matrix_iget( B , 0 , 3 ));
+    test_assert_double_equal( 5 , matrix_iget( B , 1 , 0 ));
+
+    enkf_fs_fwrite_node( fs , buffer , key , PARAMETER , 0 , 0 , ANALYZED );
+    test_assert_false( enkf_fs_fread_packed_parameter( fs , key , 0 , ANALYZED , active_list , data_size , B , 0 , iens_active_index ));
+
+    matrix_free( B );
+    active_list_free( active_list );
+  }
+
+  enkf_fs_close( fs );
+  free( packed_file );
+  buffer_free( buffer );
+  free( data );
+  matrix_free( A );
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_packed_param" , false);
+  int_vector_type * iens_active_index = alloc_active_index( );
+  const char * filename = "packed/PARAM.packed";
+
+  test_fwrite_fread( filename , iens_active_index );
+  test_member( filename );
+  test_invalidate( filename , iens_active_index );
+  test_float_precision( iens_active_index );
+  test_fs_invalidate( iens_active_index );
+
+  int_vector_free( iens_active_index );
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,91 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'enkf_serialize.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/matrix.h>
+#include <ert/util/fmatrix.h>
+
+#include <ert/enkf/active_list.h>
+#include <ert/enkf/enkf_serialize.h>
+
+
+/*
+  Serializing float data to a fmatrix must give the same values as
+  serializing to the double matrix, and deserializing must give back
+  the original data.
+*/
+
+void test_serialize( const active_list_type * active_list , int node_size , int ens_size , int row_offset ) {
+  int active_size  = active_list_get_active_size( active_list , node_size );
+  matrix_type  * A = matrix_alloc( row_offset + active_size , ens_size );
+  fmatrix_type * fA = fmatrix_alloc( row_offset + active_size , ens_size );
+  float * data     = util_calloc( node_size , sizeof * data );
+  float * data2    = util_calloc( node_size , sizeof * data2 );
+  int i , iens;
+
+  for (iens = 0; iens < ens_size; iens++) {
+    for (i=0; i < node_size; i++)
+      data[i] = 1.0 / (1 + i + iens * node_size);
+    enkf_matrix_serialize( data , node_size , ECL_FLOAT_TYPE , active_list , A , row_offset , iens );
+    enkf_fmatrix_serialize( data , node_size , active_list , fA , row_offset , iens );
+  }
+
+  for (iens = 0; iens < ens_size; iens++)
+    for (i=0; i < active_size; i++)
+      test_assert_double_equal( matrix_iget( A , row_offset + i , iens ) , fmatrix_iget( fA , row_offset + i , iens ));
+
+  for (iens = 0; iens < ens_size; iens++) {
+    for (i=0; i < node_size; i++) {
+      data[i]  = -1;
+      data2[i] = -1;
+    }
+    enkf_matrix_deserialize( data , node_size , ECL_FLOAT_TYPE , active_list , A , row_offset , iens );
+    enkf_fmatrix_deserialize( data2 , node_size , active_list , fA , row_offset , iens );
+    for (i=0; i < node_size; i++)
+      test_assert_true( data[i] == data2[i] );
+  }
+
+  free( data );
+  free( data2 );
+  matrix_free( A );
+  fmatrix_free( fA );
+}
+
+
+int main(int argc , char ** argv) {
+  const int node_size = 100;
+  active_list_type * all_active = active_list_alloc( );
+  active_list_type * partly_active = active_list_alloc( );
+  int i;
+
+  for (i=0; i < node_size; i += 3)
+    active_list_add_index( partly_active , i );
+
+  test_serialize( all_active , node_size , 10 , 0 );
+  test_serialize( all_active , node_size , 10 , 17 );
+  test_serialize( partly_active , node_size , 10 , 0 );
+  test_serialize( partly_active , node_size , 10 , 17 );
+
+  active_list_free( all_active );
+  active_list_free( partly_active );
+  exit(0);
+}
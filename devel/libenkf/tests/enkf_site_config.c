@@ -29,8 +29,7 @@
 
 #include <ert/ecl/ecl_sum.h>
 
-#include <ert/enkf/site_config.h>
-
+#include <ert/job_queue/job_queue.h>
 
 #include <ert/enkf/site_config.h>
 
@@ -47,6 +46,18 @@ void test_empty() {
 }
 
 
+void test_collect_job_resources() {
+  site_config_type * site_config = site_config_alloc_empty();
+  test_assert_false( site_config_get_collect_job_resources( site_config ));
+  test_assert_false( job_queue_get_collect_resources( site_config_get_job_queue( site_config )));
+
+  site_config_set_collect_job_resources( site_config , true );
+  test_assert_true( site_config_get_collect_job_resources( site_config ));
+  test_assert_true( job_queue_get_collect_resources( site_config_get_job_queue( site_config )));
+  site_config_free( site_config );
+}
+
+
 void test_init(const char * config_file) {
   site_config_type * site_config = site_config_alloc_empty();
   config_type * config = config_alloc();
@@ -66,6 +77,7 @@ void test_init(const char * config_file) {
 int main(int argc , char ** argv) {
   const char * site_config_file = argv[1];
   test_empty();
+  test_collect_job_resources();
   test_init( site_config_file );
     
   exit(0);
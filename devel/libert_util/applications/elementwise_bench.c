@@ -0,0 +1,161 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'elementwise_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <ert/util/util.h>
+#include <ert/util/timer.h>
+#include <ert/util/elementwise.h>
+
+/*
+  Times the elementwise kernels against the loops they replaced:
+
+     elementwise_bench  [size]  [num_repeat]
+
+  The reference loops take a double scale factor on float data, call
+  the transformation through a function pointer and apply the
+  sqr / add_scaled sequence used for ensemble statistics, as
+  rms_tagkey and field did. The defaults are 10 million cells and 20
+  repetitions.
+*/
+
+typedef float (float_func_type) (float);
+
+
+static void ref_apply( float_func_type * func , float * data , int size ) {
+  int i;
+  for (i=0; i < size; i++)
+    data[i] = func( data[i] );
+}
+
+
+static float ref_sqr( float x ) {
+  return x*x;
+}
+
+
+static void reset( float * y , const float * x , int size ) {
+  int i;
+  for (i=0; i < size; i++)
+    y[i] = x[i];
+}
+
+
+static void ref_scale( float * data , double factor , int size ) {
+  int i;
+  for (i=0; i < size; i++)
+    data[i] *= factor;
+}
+
+
+static void ref_add_scaled( float * y , const float * x , double factor , int size ) {
+  int i;
+  for (i=0; i < size; i++)
+    y[i] += x[i] * factor;
+}
+
+
+static void report( const char * label , double ref_time , double kernel_time ) {
+  printf("%-22s: reference %8.3f s   kernel %8.3f s   speedup %5.2f\n" , label , ref_time , kernel_time , ref_time / kernel_time);
+}
+
+
+int main( int argc , char ** argv ) {
+  int size       = 10000000;
+  int num_repeat = 20;
+  if (argc > 1) util_sscanf_int( argv[1] , &size );
+  if (argc > 2) util_sscanf_int( argv[2] , &num_repeat );
+
+  {
+    float * x       = util_calloc( size , sizeof * x );
+    float * y       = util_calloc( size , sizeof * y );
+    float * sqr     = util_calloc( size , sizeof * sqr );
+    timer_type * timer = timer_alloc( false );
+    double ref_time , kernel_time;
+    int i , r;
+
+    for (i=0; i < size; i++)
+      x[i] = 1 + (i % 1000) * 0.001;
+
+    reset( y , x , size );
+    timer_start( timer );
+    for (r=0; r < num_repeat; r++) ref_scale( y , 0.999 , size );
+    ref_time = timer_stop( timer );
+    reset( y , x , size );
+    timer_reset( timer ); timer_start( timer );
+    for (r=0; r < num_repeat; r++) elementwise_scale_float( y , 0.999 , size );
+    kernel_time = timer_stop( timer );
+    report( "scale" , ref_time , kernel_time );
+
+    reset( y , x , size );
+    timer_reset( timer ); timer_start( timer );
+    for (r=0; r < num_repeat; r++) ref_add_scaled( y , x , 0.5 , size );
+    ref_time = timer_stop( timer );
+    reset( y , x , size );
+    timer_reset( timer ); timer_start( timer );
+    for (r=0; r < num_repeat; r++) elementwise_axpy_float( y , 0.5 , x , size );
+    kernel_time = timer_stop( timer );
+    report( "axpy" , ref_time , kernel_time );
+
+    reset( y , x , size );
+    timer_reset( timer ); timer_start( timer );
+    for (r=0; r < num_repeat; r++) ref_apply( sqrtf , y , size );
+    ref_time = timer_stop( timer );
+    reset( y , x , size );
+    timer_reset( timer ); timer_start( timer );
+    for (r=0; r < num_repeat; r++) elementwise_sqrt_float( y , size );
+    kernel_time = timer_stop( timer );
+    report( "sqrt" , ref_time , kernel_time );
+
+    reset( y , x , size );
+    timer_reset( timer ); timer_start( timer );
+    for (r=0; r < num_repeat; r++) ref_apply( log10f , y , size );
+    ref_time = timer_stop( timer );
+    reset( y , x , size );
+    timer_reset( timer ); timer_start( timer );
+    for (r=0; r < num_repeat; r++) elementwise_log10_float( y , size );
+    kernel_time = timer_stop( timer );
+    report( "log10" , ref_time , kernel_time );
+
+    /* Mean and mean of squares: two passes and a temporary square against one fused pass. */
+    reset( y , x , size );
+    timer_reset( timer ); timer_start( timer );
+    for (r=0; r < num_repeat; r++) {
+      for (i=0; i < size; i++) sqr[i] = x[i];
+      ref_add_scaled( y , x , 0.05 , size );
+      ref_apply( ref_sqr , sqr , size );
+      ref_add_scaled( y , sqr , 0.05 , size );
+    }
+    ref_time = timer_stop( timer );
+    reset( y , x , size );
+    timer_reset( timer ); timer_start( timer );
+    for (r=0; r < num_repeat; r++)
+      elementwise_moments_float( y , sqr , x , 0.05 , size );
+    kernel_time = timer_stop( timer );
+    report( "mean/variance" , ref_time , kernel_time );
+
+    printf("Checksum: %g\n" , y[size / 2] + sqr[size / 3]);
+    timer_free( timer );
+    free( sqr );
+    free( y );
+    free( x );
+  }
+  exit(0);
+}
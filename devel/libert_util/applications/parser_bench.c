@@ -0,0 +1,151 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'parser_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <ert/util/util.h>
+#include <ert/util/buffer.h>
+#include <ert/util/timer.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/parser.h>
+
+#include "parser_bench_baseline.h"
+
+/*
+  Compares tokenizing a generated schedule file with the previous
+  strchr() based parser_tokenize_buffer(), copied to
+  parser_bench_baseline.c, and with the current parser; both through
+  the parser_tokenize_buffer() adapter and the token_stream:
+
+     parser_bench  [size_mb]  [num_repeat]
+
+  The parsers are set up as in sched_file.c; the defaults are a 50 MB
+  file tokenized 3 times. The tokens from the baseline and the current
+  parser are compared one by one.
+*/
+
+static char * alloc_content( size_t size ) {
+  buffer_type * buffer = buffer_alloc( size + 256 );
+  int line = 0;
+  while (buffer_get_offset( buffer ) < size) {
+    char * text;
+    if ((line % 50) == 0)
+      text = util_alloc_sprintf( "DATES\n  %d 'JAN' 2010 /\n/\n\nWCONHIST\n" , 1 + line % 28 );
+    else if ((line % 7) == 0)
+      text = util_alloc_sprintf( "-- Comment for line %d\n" , line );
+    else
+      text = util_alloc_sprintf( "  'OP_%d'  'OPEN'  'RESV'  %d.25  %d.5  0.0  1*  1*  200.0 /\r\n" , line % 100 , line % 1000 , line % 77 );
+    buffer_fwrite( buffer , text , 1 , strlen( text ));
+    free( text );
+    line++;
+  }
+  buffer_fwrite_char( buffer , '\0' );
+  {
+    char * content = buffer_get_data( buffer );
+    buffer_free_container( buffer );
+    return content;
+  }
+}
+
+
+static void report( const char * label , double time , size_t length , int num_tokens , int num_repeat ) {
+  double mb = 1.0 * length * num_repeat / (1024 * 1024);
+  printf("%-28s: %8.3f s  %8.1f MB/s  %8.2f Mtokens/s\n" , label , time , mb / time , 1e-6 * num_tokens * num_repeat / time);
+}
+
+
+int main( int argc , char ** argv ) {
+  int size_mb    = 50;
+  int num_repeat = 3;
+  if (argc > 1) util_sscanf_int( argv[1] , &size_mb );
+  if (argc > 2) util_sscanf_int( argv[2] , &num_repeat );
+
+  {
+    char * content        = alloc_content( (size_t) size_mb * 1024 * 1024 );
+    size_t length         = strlen( content );
+    parser_type * parser  = parser_alloc( " \t" , "\'\"" , "\n" , "\r" , "--" , "\n" );
+    baseline_parser_type * baseline = baseline_parser_alloc( " \t" , "\'\"" , "\n" , "\r" , "--" , "\n" );
+    timer_type * timer    = timer_alloc( false );
+    int num_tokens        = 0;
+    bool equal            = true;
+
+    printf("Size: %zd bytes   Repeats: %d\n" , length , num_repeat );
+
+    timer_start( timer );
+    for (int iter = 0; iter < num_repeat; iter++) {
+      stringlist_type * tokens = baseline_parser_tokenize_buffer( baseline , content , false );
+      num_tokens = stringlist_get_size( tokens );
+      stringlist_free( tokens );
+    }
+    report( "baseline tokenize_buffer" , timer_stop( timer ) , length , num_tokens , num_repeat );
+
+    timer_reset( timer );
+    timer_start( timer );
+    for (int iter = 0; iter < num_repeat; iter++) {
+      stringlist_type * tokens = parser_tokenize_buffer( parser , content , false );
+      stringlist_free( tokens );
+    }
+    report( "parser_tokenize_buffer" , timer_stop( timer ) , length , num_tokens , num_repeat );
+
+    timer_reset( timer );
+    timer_start( timer );
+    for (int iter = 0; iter < num_repeat; iter++) {
+      token_stream_type * stream = parser_alloc_token_stream( parser , content , false );
+      token_stream_free( stream );
+    }
+    report( "parser_alloc_token_stream" , timer_stop( timer ) , length , num_tokens , num_repeat );
+
+    timer_reset( timer );
+    timer_start( timer );
+    for (int iter = 0; iter < num_repeat; iter++) {
+      token_stream_type * stream = parser_alloc_token_stream( parser , content , false );
+      stringlist_type * tokens   = token_stream_alloc_stringlist_ref( stream );
+      stringlist_free( tokens );
+      token_stream_free( stream );
+    }
+    report( "token_stream stringlist_ref" , timer_stop( timer ) , length , num_tokens , num_repeat );
+
+    {
+      stringlist_type * expected = baseline_parser_tokenize_buffer( baseline , content , false );
+      stringlist_type * tokens   = parser_tokenize_buffer( parser , content , false );
+      token_stream_type * stream = parser_alloc_token_stream( parser , content , false );
+      equal = stringlist_equal( expected , tokens );
+      if (equal && (stringlist_get_size( expected ) == token_stream_get_size( stream ))) {
+        for (int i = 0; i < stringlist_get_size( expected ); i++) {
+          if (!token_stream_iequal( stream , i , stringlist_iget( expected , i ))) {
+            equal = false;
+            break;
+          }
+        }
+      } else
+        equal = false;
+      token_stream_free( stream );
+      stringlist_free( tokens );
+      stringlist_free( expected );
+    }
+    printf("Tokens: %d - results are %s\n" , num_tokens , equal ? "identical" : "DIFFERENT");
+
+    timer_free( timer );
+    parser_free( parser );
+    baseline_parser_free( baseline );
+    free( content );
+  }
+  exit(0);
+}
@@ -0,0 +1,534 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'parser_bench_baseline.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  A verbatim copy of the strchr() based tokenizer which parser.c used
+  before the character class table and the token_stream were
+  introduced; the symbols have been renamed with a baseline_ prefix.
+  It is only used by parser_bench as the reference for timing and
+  for the token by token comparison.
+*/
+
+#include <assert.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <ert/util/util.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/buffer.h>
+
+#include "parser_bench_baseline.h"
+
+#define PARSER_ESCAPE_CHAR '\\'
+
+
+
+struct baseline_parser_struct
+{
+  char * splitters;         /* The string is split into tokens on the occurence of one of these characters - and they are removed. */
+  char * specials;          /* This exactly like the splitters - but these characters are retained as tokens. */
+  char * delete_set;        /* The chracters are just plain removed - but without any splitting on them. */
+  char * quoters;       
+  char * comment_start; 
+  char * comment_end;   
+};
+
+
+
+static void __verify_string_length( const char * s) {
+  if ((s != NULL) && (strlen(s) == 0))
+    util_abort("%s: invalid input to baseline_parser_set_xxx function - zero length string.\n",__func__);
+}
+
+
+static void baseline_parser_set_splitters( baseline_parser_type * parser , const char * splitters ) {
+  __verify_string_length( splitters );
+  parser->splitters = util_realloc_string_copy( parser->splitters , splitters );
+}
+
+
+static void baseline_parser_set_quoters( baseline_parser_type * parser , const char * quoters ) {
+  __verify_string_length( quoters );
+  parser->quoters = util_realloc_string_copy( parser->quoters , quoters );
+}
+
+static void baseline_parser_set_specials( baseline_parser_type * parser , const char * specials ) {
+  __verify_string_length( specials );
+  parser->specials = util_realloc_string_copy( parser->specials , specials );
+}
+
+
+static void baseline_parser_set_delete_set( baseline_parser_type * parser , const char * delete_set ) {
+  __verify_string_length( delete_set );
+  parser->delete_set = util_realloc_string_copy( parser->delete_set , delete_set );
+}
+
+static void baseline_parser_set_comment_start( baseline_parser_type * parser , const char * comment_start ) {
+  __verify_string_length( comment_start );
+  parser->comment_start = util_realloc_string_copy( parser->comment_start , comment_start );
+}
+
+
+static void baseline_parser_set_comment_end( baseline_parser_type * parser , const char * comment_end ) {
+  __verify_string_length( comment_end );
+  parser->comment_end = util_realloc_string_copy( parser->comment_end , comment_end );
+}
+
+
+baseline_parser_type * baseline_parser_alloc(
+  const char * splitters,        /** Set to NULL if not interessting.            */
+  const char * quoters,          /** Set to NULL if not interessting.            */
+  const char * specials,         /** Set to NULL if not interessting.            */
+  const char * delete_set,
+  const char * comment_start,    /** Set to NULL if not interessting.            */
+  const char * comment_end)      /** Set to NULL  if not interessting.           */
+{
+  baseline_parser_type * parser = util_malloc(sizeof * parser);
+  parser->splitters     = NULL;
+  parser->delete_set    = NULL;
+  parser->quoters       = NULL;
+  parser->specials      = NULL;
+  parser->comment_start = NULL;
+  parser->comment_end   = NULL;
+  
+  baseline_parser_set_splitters( parser , splitters );
+  baseline_parser_set_quoters( parser , quoters );
+  baseline_parser_set_specials( parser , specials );
+  baseline_parser_set_delete_set( parser , delete_set );
+  baseline_parser_set_comment_start( parser , comment_start );
+  baseline_parser_set_comment_end( parser , comment_end );
+    
+  if(comment_start == NULL && comment_end != NULL)
+    util_abort("%s: Need to have comment_start when comment_end is set.\n", __func__);
+  if(comment_start != NULL && comment_end == NULL)
+    util_abort("%s: Need to have comment_end when comment_start is set.\n", __func__);
+  
+  return parser;
+}
+
+
+
+void baseline_parser_free(
+  baseline_parser_type * parser)
+{
+
+  util_safe_free( parser->splitters    );
+  util_safe_free( parser->quoters       ); 
+  util_safe_free( parser->specials      ); 
+  util_safe_free( parser->comment_start );
+  util_safe_free( parser->comment_end   );
+  util_safe_free( parser->delete_set    );
+
+  free( parser     );
+}
+
+
+
+static
+bool is_escape(
+  const char c)
+{
+  if( c == PARSER_ESCAPE_CHAR )
+    return true;
+  else
+    return false;
+}
+
+
+
+
+static
+int length_of_initial_splitters(
+  const char           * buffer_position,
+  const baseline_parser_type * parser)
+{
+  assert( buffer_position != NULL );
+  assert( parser       != NULL );
+
+  if( parser->splitters == NULL)
+    return 0;
+  else
+    return strspn( buffer_position, parser->splitters );
+}
+
+static bool in_set(char c , const char * set) {
+  if (set == NULL)
+    return false;
+  else {
+    if (strchr( set , (int) c) != NULL)
+      return true;
+    else
+      return false;
+  }
+}
+
+
+static
+bool is_splitters(
+  const char             c,
+  const baseline_parser_type * parser)
+{
+  return in_set(c , parser->splitters);
+}
+
+static 
+bool is_special(
+  const char             c,
+  const baseline_parser_type * parser)
+{
+  return in_set(c , parser->specials);
+}
+
+
+static
+bool is_in_quoters(
+  const char       c,
+  const baseline_parser_type * parser)
+{
+  return in_set(c , parser->quoters);
+}
+
+
+
+static bool is_in_delete_set(const char c , const baseline_parser_type * parser) {
+  return in_set(c , parser->delete_set);
+}
+
+
+/**
+  This finds the number of characters up til
+  and including the next occurence of buffer[0].
+
+  E.g. using this funciton on
+
+  char * example = "1231abcd";
+
+  should return 4.
+
+  If the character can not be found, the function will fail with
+  util_abort() - all quotation should be terminated (Joakim - WITH
+  moustache ...). Observe that this function does not allow for mixed
+  quotations, i.e. both ' and " might be vald as quaotation
+  characters; but one quoted string must be wholly quoted with EITHER
+  ' or ".
+
+  Escaped occurences of the first character are
+  not counted. E.g. if PARSER_ESCAPE_CHAR
+  occurs in front of a new occurence of the first
+  character, this is *NOT* regarded as the end.
+*/
+
+static
+int length_of_quotation(
+  const char * buffer)
+{
+  assert( buffer != NULL );
+  {
+  int  length  = 1;
+  char target  = buffer[0];
+  char current = buffer[1]; 
+
+  bool escaped = false;
+  while(current != '\0' &&  !(current == target && !escaped ))
+  {
+    escaped = is_escape(current);
+    length += 1;
+    current = buffer[length];
+  }
+  length += 1;
+
+  if ( current == '\0') /* We ran through the whole string without finding the end of the quotation - abort HARD. */
+    util_abort("%s: could not find quotation closing on %s \n",__func__ , buffer);
+  
+  
+  return length;
+  }
+}
+
+
+
+static
+int length_of_comment(
+  const char           * buffer_position,
+  const baseline_parser_type * parser)
+{  
+  bool in_comment = false;
+  int length = 0;
+
+  if(parser->comment_start == NULL || parser->comment_end == NULL)
+    length = 0;
+  else
+  {
+    const char * comment_start     = parser->comment_start;
+    int          len_comment_start = strlen( comment_start );
+    if( strncmp( buffer_position, comment_start, len_comment_start) == 0)
+    {
+      in_comment = true;
+      length     = len_comment_start;
+    }
+    else
+      length = 0;
+  }
+
+  if( in_comment )
+  {
+    const char * comment_end       = parser->comment_end;
+    int          len_comment_end   = strlen( comment_end   );
+    while(buffer_position[length] != '\0' && in_comment)
+    {
+      if( strncmp( &buffer_position[length], comment_end, len_comment_end) == 0)
+      {
+        in_comment = false;
+        length += len_comment_end; 
+      }
+      else
+        length += 1;
+    }
+  }
+  return length;
+}
+
+
+
+static
+char * alloc_quoted_token(
+  const char * buffer,
+  int          length,
+  bool         strip_quote_marks)
+{
+  char * token;
+  if(!strip_quote_marks)
+  {
+    token = util_calloc( (length + 1) , sizeof * token );
+    memmove(token, &buffer[0], length * sizeof * token );
+    token[length] = '\0';
+  }
+  else
+  {
+    token = util_calloc( (length - 1) , sizeof * token);
+    memmove(token, &buffer[1], (length -1) * sizeof * token);
+    token[length-2] = '\0';
+    /**
+      Removed escape char before any escaped quotation starts.
+    */
+    {
+      char expr[3];
+      char subs[2];
+      expr[0] = PARSER_ESCAPE_CHAR;
+      expr[1] = buffer[0];
+      expr[2] = '\0';
+      subs[0] = buffer[0];
+      subs[1] = '\0';
+      util_string_replace_inplace(&token, expr, subs);
+    }
+  }
+  return token;
+}
+
+
+
+
+/** 
+    This does not care about the possible occurence of characters in
+    the delete_set. That is handled when the token is inserted in the
+    token list.
+*/
+    
+static
+int length_of_normal_non_splitters(
+  const char           * buffer,
+  const baseline_parser_type * parser)
+{
+  bool at_end  = false;
+  int length   = 0;
+  char current = buffer[0];
+
+  while(current != '\0' && !at_end)
+  {
+    length += 1;
+    current = buffer[length];
+
+    if( is_splitters( current, parser ) )
+    {
+      at_end = true;
+      continue;
+    }
+    if( is_special( current, parser ) )
+    {
+      at_end = true;
+      continue;
+    }
+    if( is_in_quoters( current, parser ) )
+    {
+      at_end = true;
+      continue;
+    }
+    if( length_of_comment(&buffer[length], parser) > 0)
+    {
+      at_end = true;
+      continue;
+    }
+  }
+
+  return length;
+}
+
+
+
+static int length_of_delete( const char * buffer , const baseline_parser_type * parser) {
+  int length   = 0;
+  char current = buffer[0];
+
+  while(is_in_delete_set( current , parser ) && current != '\0') {
+    length += 1;
+    current = buffer[length];
+  }
+  return length;
+}
+
+
+/**
+   Allocates a new stringlist. 
+*/
+stringlist_type * baseline_parser_tokenize_buffer(
+  const baseline_parser_type    * parser,
+  const char           * buffer,
+  bool                   strip_quote_marks)
+{
+  int position          = 0;
+  int buffer_size       = strlen(buffer);
+  int splitters_length  = 0;
+  int comment_length    = 0;
+  int delete_length     = 0;
+
+  stringlist_type * tokens = stringlist_alloc_new();
+  
+  while( position < buffer_size )
+  {
+    /** 
+      Skip initial splitters.
+    */
+    splitters_length = length_of_initial_splitters( &buffer[position], parser );
+    if(splitters_length > 0)
+    {
+      position += splitters_length;
+      continue;
+    }
+
+
+    /**
+      Skip comments.
+    */
+    comment_length = length_of_comment( &buffer[position], parser);
+    if(comment_length > 0)
+    {
+      position += comment_length;
+      continue;
+    }
+
+    
+    /**
+       Skip characters which are just deleted. 
+    */
+      
+    delete_length = length_of_delete( &buffer[position] , parser );
+    if (delete_length > 0) {
+      position += delete_length;
+      continue;
+    }
+
+
+
+    /** 
+       Copy the character if it is in the special set,
+    */
+    if( is_special( buffer[position], parser ) )
+    {
+      char key[2];
+      key[0] = buffer[position];
+      key[1] = '\0';
+      stringlist_append_copy( tokens, key );
+      position += 1;
+      continue;
+    }
+
+    /**
+       If the character is a quotation start, we copy the whole quotation.
+    */
+    if( is_in_quoters( buffer[position], parser ) )
+    {
+      int length   = length_of_quotation( &buffer[position] );
+      char * token = alloc_quoted_token( &buffer[position], length, strip_quote_marks );
+      stringlist_append_owned_ref( tokens, token );
+      position += length;
+      continue;
+    }
+
+    /**
+      If we are here, we are guaranteed that that
+      buffer[position] is not:
+
+      1. Whitespace.
+      2. The start of a comment.
+      3. A special character.
+      4. The start of a quotation.
+      5. Something to delete.
+
+      In other words, it is the start of plain
+      non-splitters. Now we need to find the
+      length of the non-splitters until:
+
+      1. Whitespace starts.
+      2. A comment starts.
+      3. A special character occur.
+      4. A quotation starts.
+    */
+
+    {
+      int length   = length_of_normal_non_splitters( &buffer[position], parser );
+      char * token = util_calloc( (length + 1) , sizeof * token);
+      int token_length;
+      if (parser->delete_set == NULL) {
+        token_length = length;
+        memcpy( token , &buffer[position] , length * sizeof * token );
+      } else {
+        int i;
+        token_length = 0;
+        for (i = 0; i < length; i++) {
+          char c = buffer[position + i];
+          if ( !is_in_delete_set( c , parser)) {
+            token[token_length] = c;
+            token_length++;
+          }
+        }
+      }
+
+
+      if (token_length > 0) { /* We do not insert empty tokens. */
+        token[token_length] = '\0';
+        stringlist_append_owned_ref( tokens, token );
+      } else 
+        free( token );    /* The whole thing is discarded. */
+
+      position += length;
+      continue;
+    }
+  }
+
+  return tokens;
+}
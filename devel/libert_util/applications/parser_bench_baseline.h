@@ -0,0 +1,33 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'parser_bench_baseline.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __PARSER_BENCH_BASELINE_H__
+#define __PARSER_BENCH_BASELINE_H__
+
+#include <stdbool.h>
+
+#include <ert/util/stringlist.h>
+
+typedef struct baseline_parser_struct baseline_parser_type;
+
+baseline_parser_type * baseline_parser_alloc( const char * splitters , const char * quoters , const char * specials ,
+                                              const char * delete_set , const char * comment_start , const char * comment_end );
+void                   baseline_parser_free( baseline_parser_type * parser );
+stringlist_type      * baseline_parser_tokenize_buffer( const baseline_parser_type * parser , const char * buffer , bool strip_quote_marks );
+
+#endif
@@ -0,0 +1,132 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'template_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <ert/util/util.h>
+#include <ert/util/buffer.h>
+#include <ert/util/timer.h>
+#include <ert/util/subst_list.h>
+#include <ert/util/subst_template.h>
+
+/*
+  Compares the sequential substitution of subst_list_update_buffer()
+  with the compiled subst_template, on a generated include file:
+
+     template_bench  [num_keys]  [size_mb]  [num_render]
+
+  The defaults are 500 keys and a 20 MB file, rendered 5 times with
+  different values - as for consecutive realisations.
+*/
+
+static char * alloc_content( int num_keys , size_t size ) {
+  buffer_type * buffer = buffer_alloc( size + 256 );
+  int line = 0;
+  while (buffer_get_offset( buffer ) < size) {
+    char * text;
+    if ((line % 10) == 0)
+      text = util_alloc_sprintf( "  'WELL-%d'  <KEY%d>  1* 'OPEN' /\n" , line , line % num_keys );
+    else
+      text = util_alloc_sprintf( "  %d  %d  %d  0.25  1000.0  1* 1* /\n" , line , line % 37 , line % 11 );
+    buffer_fwrite( buffer , text , 1 , strlen( text ));
+    free( text );
+    line++;
+  }
+  buffer_fwrite_char( buffer , '\0' );
+  {
+    char * content = buffer_get_data( buffer );
+    buffer_free_container( buffer );
+    return content;
+  }
+}
+
+
+static void update_values( subst_list_type * subst_list , int num_keys , int iter ) {
+  for (int i = 0; i < num_keys; i++) {
+    char * key   = util_alloc_sprintf( "<KEY%d>" , i );
+    char * value = util_alloc_sprintf( "%g" , 0.001 * (i + iter) );
+    subst_list_append_owned_ref( subst_list , key , value , NULL );
+    free( key );
+  }
+}
+
+
+int main( int argc , char ** argv ) {
+  int    num_keys   = 500;
+  int    size_mb    = 20;
+  int    num_render = 5;
+  if (argc > 1) util_sscanf_int( argv[1] , &num_keys );
+  if (argc > 2) util_sscanf_int( argv[2] , &size_mb );
+  if (argc > 3) util_sscanf_int( argv[3] , &num_render );
+
+  {
+    char * content = alloc_content( num_keys , (size_t) size_mb * 1024 * 1024 );
+    size_t length  = strlen( content );
+    subst_list_type * subst_list = subst_list_alloc( NULL );
+    timer_type * timer = timer_alloc( false );
+    double sequential_time , compile_time , render_time;
+    char * sequential_result = NULL;
+    char * compiled_result   = NULL;
+
+    update_values( subst_list , num_keys , 0 );
+    printf("Keys: %d   Size: %zd bytes   Renders: %d\n" , num_keys , length , num_render );
+
+    timer_start( timer );
+    for (int iter = 0; iter < num_render; iter++) {
+      buffer_type * buffer = buffer_alloc( length + 1 );
+      update_values( subst_list , num_keys , iter );
+      buffer_fwrite( buffer , content , 1 , length + 1 );
+      subst_list_update_buffer( subst_list , buffer );
+      util_safe_free( sequential_result );
+      sequential_result = buffer_get_data( buffer );
+      buffer_free_container( buffer );
+    }
+    sequential_time = timer_stop( timer );
+
+    timer_reset( timer );
+    timer_start( timer );
+    {
+      subst_template_type * subst_template = subst_template_alloc( content , subst_list , NULL );
+      compile_time = timer_stop( timer );
+
+      timer_reset( timer );
+      timer_start( timer );
+      for (int iter = 0; iter < num_render; iter++) {
+        update_values( subst_list , num_keys , iter );
+        util_safe_free( compiled_result );
+        compiled_result = subst_template_alloc_string( subst_template , subst_list , NULL );
+      }
+      render_time = timer_stop( timer );
+      subst_template_free( subst_template );
+    }
+
+    printf("Sequential subst_list     : %8.3f s  (%8.3f s / render)\n" , sequential_time , sequential_time / num_render );
+    printf("subst_template compile    : %8.3f s\n" , compile_time );
+    printf("subst_template render     : %8.3f s  (%8.3f s / render)\n" , render_time , render_time / num_render );
+    printf("Results are %s\n" , util_string_equal( sequential_result , compiled_result ) ? "identical" : "DIFFERENT");
+
+    free( sequential_result );
+    free( compiled_result );
+    timer_free( timer );
+    subst_list_free( subst_list );
+    free( content );
+  }
+  exit(0);
+}
@@ -0,0 +1,76 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'elementwise.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __ELEMENTWISE_H__
+#define __ELEMENTWISE_H__
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void elementwise_add_int( int * y , const int * x , int size );
+void elementwise_sub_int( int * y , const int * x , int size );
+void elementwise_mul_int( int * y , const int * x , int size );
+void elementwise_div_int( int * y , const int * x , int size );
+void elementwise_addsqr_int( int * y , const int * x , int size );
+void elementwise_axpy_int( int * y , int alpha , const int * x , int size );
+void elementwise_scale_int( int * y , int alpha , int size );
+void elementwise_shift_int( int * y , int shift , int size );
+void elementwise_clamp_int( int * y , int min_value , int max_value , int size );
+
+void elementwise_add_float( float * y , const float * x , int size );
+void elementwise_sub_float( float * y , const float * x , int size );
+void elementwise_mul_float( float * y , const float * x , int size );
+void elementwise_div_float( float * y , const float * x , int size );
+void elementwise_addsqr_float( float * y , const float * x , int size );
+void elementwise_axpy_float( float * y , float alpha , const float * x , int size );
+void elementwise_scale_float( float * y , float alpha , int size );
+void elementwise_shift_float( float * y , float shift , int size );
+void elementwise_clamp_float( float * y , float min_value , float max_value , int size );
+void elementwise_sqr_float( float * y , int size );
+void elementwise_sqrt_float( float * y , int size );
+void elementwise_log_float( float * y , int size );
+void elementwise_log10_float( float * y , int size );
+void elementwise_exp_float( float * y , int size );
+void elementwise_pow10_float( float * y , int size );
+void elementwise_pow_float( float * y , float exponent , int size );
+void elementwise_moments_float( float * sum , float * sum2 , const float * x , float weight , int size );
+void elementwise_std_float( float * std , const float * mean , int size );
+
+void elementwise_add_double( double * y , const double * x , int size );
+void elementwise_sub_double( double * y , const double * x , int size );
+void elementwise_mul_double( double * y , const double * x , int size );
+void elementwise_div_double( double * y , const double * x , int size );
+void elementwise_addsqr_double( double * y , const double * x , int size );
+void elementwise_axpy_double( double * y , double alpha , const double * x , int size );
+void elementwise_scale_double( double * y , double alpha , int size );
+void elementwise_shift_double( double * y , double shift , int size );
+void elementwise_clamp_double( double * y , double min_value , double max_value , int size );
+void elementwise_sqr_double( double * y , int size );
+void elementwise_sqrt_double( double * y , int size );
+void elementwise_log_double( double * y , int size );
+void elementwise_log10_double( double * y , int size );
+void elementwise_exp_double( double * y , int size );
+void elementwise_pow10_double( double * y , int size );
+void elementwise_pow_double( double * y , double exponent , int size );
+void elementwise_moments_double( double * sum , double * sum2 , const double * x , double weight , int size );
+void elementwise_std_double( double * std , const double * mean , int size );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,69 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'fmatrix.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __FMATRIX_H__
+#define __FMATRIX_H__
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <ert/util/type_macros.h>
+#include <ert/util/matrix.h>
+#include <ert/util/thread_pool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fmatrix_struct fmatrix_type;
+
+  fmatrix_type * fmatrix_alloc( int rows , int columns );
+  fmatrix_type * fmatrix_safe_alloc( int rows , int columns );
+  fmatrix_type * fmatrix_alloc_from_matrix( const matrix_type * src );
+  void           fmatrix_free( fmatrix_type * matrix );
+
+  int            fmatrix_get_rows( const fmatrix_type * matrix );
+  int            fmatrix_get_columns( const fmatrix_type * matrix );
+  int            fmatrix_get_row_stride( const fmatrix_type * matrix );
+  int            fmatrix_get_column_stride( const fmatrix_type * matrix );
+  float        * fmatrix_get_data( const fmatrix_type * matrix );
+  size_t         fmatrix_get_byte_size( const fmatrix_type * matrix );
+
+  void           fmatrix_iset( fmatrix_type * matrix , int i , int j , float value );
+  float          fmatrix_iget( const fmatrix_type * matrix , int i , int j );
+  void           fmatrix_set( fmatrix_type * matrix , float value );
+
+  void           fmatrix_assign_matrix( fmatrix_type * A , const matrix_type * B );
+  void           fmatrix_export( const fmatrix_type * A , matrix_type * B );
+
+  void           fmatrix_fwrite( const fmatrix_type * matrix , FILE * stream );
+  fmatrix_type * fmatrix_fread_alloc( FILE * stream );
+
+  void           fmatrix_inplace_matmul( fmatrix_type * A , const matrix_type * B );
+  void           fmatrix_inplace_matmul_mt1( fmatrix_type * A , const matrix_type * B , int num_threads );
+#ifdef WITH_THREAD_POOL
+  void           fmatrix_inplace_matmul_mt2( fmatrix_type * A , const matrix_type * B , thread_pool_type * thread_pool );
+#endif
+
+  UTIL_IS_INSTANCE_HEADER( fmatrix );
+  UTIL_SAFE_CAST_HEADER( fmatrix );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
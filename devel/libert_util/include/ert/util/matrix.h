@@ -80,6 +80,8 @@ typedef struct matrix_struct matrix_type;
   
   void          matrix_shift_column(matrix_type * matrix , int column, double shift);
   void          matrix_shift_row(matrix_type * matrix , int row , double shift);
+  void          matrix_shift_rows(matrix_type * matrix , const double * shift);
+  void          matrix_scale_rows(matrix_type * matrix , const double * scale_factor);
   double        matrix_get_column_sum(const matrix_type * matrix , int column);
   double        matrix_get_row_sum(const matrix_type * matrix , int column);
   double        matrix_get_column_sum2(const matrix_type * matrix , int column);
@@ -151,6 +151,39 @@ stringlist_type * parser_tokenize_file(
   bool                   strip_quote_marks);
 
 
+/**
+  TOKEN STREAM
+
+  The parser_tokenize_xxx() functions above allocate a new string for
+  every token. The token_stream is the underlying representation: the
+  tokens are stored as (offset , length) views into one buffer, which
+  is either the buffer passed in by the calling scope, or the content
+  of the file - read once and held by the stream. The characters are
+  classified with a 256 entry table compiled from the character sets
+  of the parser.
+
+  The token text returned from token_stream_iget_ptr() is *NOT* '\0'
+  terminated, and is the raw text from the buffer; stripped quote marks
+  are not included, but escape characters and characters from the
+  delete set are. Use token_stream_alloc_token() to get the final token
+  string.
+*/
+
+typedef struct token_stream_struct token_stream_type;
+
+token_stream_type * parser_alloc_token_stream( const parser_type * parser , const char * buffer , bool strip_quote_marks);
+token_stream_type * parser_alloc_token_stream_file( const parser_type * parser , const char * filename , bool strip_quote_marks);
+void                token_stream_free( token_stream_type * stream );
+int                 token_stream_get_size( const token_stream_type * stream );
+const char        * token_stream_iget_ptr( const token_stream_type * stream , int index );
+int                 token_stream_iget_length( const token_stream_type * stream , int index );
+int                 token_stream_iget_offset( const token_stream_type * stream , int index );
+bool                token_stream_iequal( const token_stream_type * stream , int index , const char * string );
+char              * token_stream_alloc_token( const token_stream_type * stream , int index );
+stringlist_type   * token_stream_alloc_stringlist( const token_stream_type * stream );
+stringlist_type   * token_stream_alloc_stringlist_ref( token_stream_type * stream );
+
+
 /* Pollution by Joakim: */
 
 void   parser_strip_buffer(const parser_type * parser , char ** __buffer);
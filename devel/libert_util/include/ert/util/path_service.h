@@ -0,0 +1,43 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'path_service.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __PATH_SERVICE_H__
+#define __PATH_SERVICE_H__
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/type_macros.h>
+
+  typedef struct path_service_struct path_service_type;
+
+  path_service_type * path_service_alloc( int num_threads );
+  void                path_service_free( path_service_type * service );
+  void                path_service_join( path_service_type * service );
+  int                 path_service_get_num_threads( const path_service_type * service );
+  int                 path_service_get_pending( path_service_type * service );
+  void                path_service_clear_directory( path_service_type * service , const char * path , bool strict_uid , bool unlink_root );
+
+  UTIL_IS_INSTANCE_HEADER( path_service );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
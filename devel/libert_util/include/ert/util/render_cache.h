@@ -0,0 +1,52 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'render_cache.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __RENDER_CACHE_H__
+#define __RENDER_CACHE_H__
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/subst_list.h>
+#include <ert/util/subst_template.h>
+#include <ert/util/type_macros.h>
+
+  typedef struct render_cache_struct render_cache_type;
+
+  render_cache_type * render_cache_alloc( );
+  void                render_cache_free( render_cache_type * cache );
+  void                render_cache_clear( render_cache_type * cache );
+  void                render_cache_set_hardlink( render_cache_type * cache , bool hardlink );
+  bool                render_cache_get_hardlink( const render_cache_type * cache );
+  int                 render_cache_get_hits( render_cache_type * cache );
+  int                 render_cache_get_misses( render_cache_type * cache );
+
+  const char        * render_cache_get_source( render_cache_type * cache , const char * src_file );
+  const subst_template_type * render_cache_get_template( render_cache_type * cache , const char * source_id , const char * content , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 );
+  bool                render_cache_reuse( render_cache_type * cache , const char * key , const char * target_file );
+  void                render_cache_add( render_cache_type * cache , const char * key , const char * target_file );
+  void                render_cache_filter_file( render_cache_type * cache , const subst_list_type * subst_list , const char * src_file , const char * target_file );
+
+  UTIL_IS_INSTANCE_HEADER( render_cache );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -29,6 +29,8 @@ extern "C" {
 
   typedef struct          subst_list_struct subst_list_type;
   bool                    subst_list_update_buffer( const subst_list_type * subst_list , buffer_type * buffer );
+  bool                    subst_list_eval_funcs(const subst_list_type * subst_list , buffer_type * buffer);
+  stringlist_type       * subst_list_alloc_func_names( const subst_list_type * subst_list );
   void                    subst_list_insert_func(subst_list_type * subst_list , const char * func_name , const char * local_func_name);
   void                    subst_list_fprintf(const subst_list_type * , FILE * stream);
   void                    subst_list_set_parent( subst_list_type * subst_list , const subst_list_type * parent);
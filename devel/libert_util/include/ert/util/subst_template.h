@@ -0,0 +1,48 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'subst_template.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __SUBST_TEMPLATE_H__
+#define __SUBST_TEMPLATE_H__
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/buffer.h>
+#include <ert/util/subst_list.h>
+#include <ert/util/type_macros.h>
+
+  typedef struct subst_template_struct subst_template_type;
+
+  subst_template_type * subst_template_alloc( const char * content , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 );
+  void                  subst_template_free( subst_template_type * subst_template );
+  void                  subst_template_free__( void * arg );
+  bool                  subst_template_has_keys( const subst_template_type * subst_template , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 );
+  char                * subst_template_alloc_key_signature( const subst_list_type * subst_list1 , const subst_list_type * subst_list2 );
+  int                   subst_template_get_num_placeholders( const subst_template_type * subst_template );
+  void                  subst_template_render( const subst_template_type * subst_template , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 , buffer_type * buffer );
+  char                * subst_template_alloc_string( const subst_template_type * subst_template , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 );
+  char                * subst_template_alloc_filter_key( const subst_template_type * subst_template , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 );
+
+  UTIL_IS_INSTANCE_HEADER( subst_template );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -26,6 +26,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include <ert/util/subst_list.h>
+#include <ert/util/render_cache.h>
 
 typedef struct template_struct template_type;
 
@@ -33,6 +34,7 @@ typedef struct template_struct template_type;
 template_type * template_alloc( const char * template_file , bool internalize_template, subst_list_type * parent_subst);
 void            template_free( template_type * template );
 void            template_instantiate( const template_type * template , const char * __target_file , const subst_list_type * arg_list , bool override_symlink);
+void            template_instantiate_cached( const template_type * template , const char * __target_file , const subst_list_type * arg_list , bool override_symlink , render_cache_type * cache);
 void            template_add_arg( template_type * template , const char * key , const char * value );
 
 void            template_clear_args( template_type * template );
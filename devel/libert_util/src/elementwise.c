@@ -0,0 +1,171 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'elementwise.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+/*
+  Typed elementwise kernels for the arithmetic on large arrays of
+  cell values - ecl_kw instances, rms tagkeys and enkf fields. All the
+  kernels operate in place on the first argument y, and the loops are
+  plain counted loops without type switches, function pointers or
+  branches, so that the compiler can vectorize them; this file is
+  compiled with -O3 -fno-math-errno, see the CMakeLists.txt file.
+
+  The kernels are instantiated with the ELEMENTWISE_ARITH() macro for
+  int, float and double and with the ELEMENTWISE_MATH() macro for
+  float and double. The clamp() kernel leaves NaN values unchanged.
+  The moments() and std() kernels are used together
+  to calculate mean and standard deviation of an ensemble in one pass
+  per member:
+
+     for (iens = 0; iens < ens_size; iens++)
+        elementwise_moments_float( mean , std , data[iens] , 1.0 / ens_size , size );
+     elementwise_std_float( std , mean , size );
+*/
+
+#include <math.h>
+
+#include <ert/util/elementwise.h>
+
+
+#define ELEMENTWISE_ARITH( ctype )                                                                          \
+void elementwise_add_ ## ctype( ctype * y , const ctype * x , int size ) {                                  \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] += x[i];                                                                                            \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_sub_ ## ctype( ctype * y , const ctype * x , int size ) {                                  \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] -= x[i];                                                                                            \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_mul_ ## ctype( ctype * y , const ctype * x , int size ) {                                  \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] *= x[i];                                                                                            \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_div_ ## ctype( ctype * y , const ctype * x , int size ) {                                  \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] /= x[i];                                                                                            \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_addsqr_ ## ctype( ctype * y , const ctype * x , int size ) {                               \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] += x[i] * x[i];                                                                                     \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_axpy_ ## ctype( ctype * y , ctype alpha , const ctype * x , int size ) {                   \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] += alpha * x[i];                                                                                    \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_scale_ ## ctype( ctype * y , ctype alpha , int size ) {                                    \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] *= alpha;                                                                                           \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_shift_ ## ctype( ctype * y , ctype shift , int size ) {                                    \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] += shift;                                                                                           \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_clamp_ ## ctype( ctype * y , ctype min_value , ctype max_value , int size ) {              \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++) {                                                                                 \
+    ctype value = (y[i] < min_value) ? min_value : y[i];                                                     \
+    y[i] = (value > max_value) ? max_value : value;                                                          \
+  }                                                                                                          \
+}
+
+
+#define ELEMENTWISE_MATH( ctype , SUFFIX )                                                                  \
+void elementwise_sqr_ ## ctype( ctype * y , int size ) {                                                    \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] *= y[i];                                                                                            \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_sqrt_ ## ctype( ctype * y , int size ) {                                                   \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] = sqrt ## SUFFIX( y[i] );                                                                           \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_log_ ## ctype( ctype * y , int size ) {                                                    \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] = log ## SUFFIX( y[i] );                                                                            \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_log10_ ## ctype( ctype * y , int size ) {                                                  \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] = log10 ## SUFFIX( y[i] );                                                                          \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_exp_ ## ctype( ctype * y , int size ) {                                                    \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] = exp ## SUFFIX( y[i] );                                                                            \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_pow10_ ## ctype( ctype * y , int size ) {                                                  \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] = pow ## SUFFIX( 10.0 , y[i] );                                                                     \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_pow_ ## ctype( ctype * y , ctype exponent , int size ) {                                   \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++)                                                                                   \
+    y[i] = pow ## SUFFIX( y[i] , exponent );                                                                 \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_moments_ ## ctype( ctype * sum , ctype * sum2 , const ctype * x , ctype weight , int size ) { \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++) {                                                                                 \
+    ctype wx = weight * x[i];                                                                                \
+    sum[i]  += wx;                                                                                           \
+    sum2[i] += wx * x[i];                                                                                    \
+  }                                                                                                          \
+}                                                                                                            \
+                                                                                                             \
+void elementwise_std_ ## ctype( ctype * std , const ctype * mean , int size ) {                             \
+  int i;                                                                                                     \
+  for (i=0; i < size; i++) {                                                                                 \
+    ctype var = std[i] - mean[i] * mean[i];                                                                  \
+    std[i] = sqrt ## SUFFIX( (var < 0) ? 0 : var );                                                          \
+  }                                                                                                          \
+}
+
+
+ELEMENTWISE_ARITH( int )
+ELEMENTWISE_ARITH( float )
+ELEMENTWISE_ARITH( double )
+
+ELEMENTWISE_MATH( float , f )
+ELEMENTWISE_MATH( double , )
+
+#undef ELEMENTWISE_ARITH
+#undef ELEMENTWISE_MATH
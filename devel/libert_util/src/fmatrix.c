@@ -0,0 +1,371 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'fmatrix.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <ert/util/thread_pool.h>
+#include <ert/util/util.h>
+#include <ert/util/matrix.h>
+#include <ert/util/fmatrix.h>
+#include <ert/util/arg_pack.h>
+
+/**
+   The fmatrix is a single precision companion to the matrix_type,
+   intended for the very large ensemble matrices (i.e. the A matrix in
+   the EnKF update) where the storage can be halved compared to
+   double. The fmatrix only implements the small set of operations
+   needed for such a matrix: conversion to/from the (double) matrix_type,
+   binary serialization and the A = A*X update.
+
+   The element storage is float, but all arithmetic is done in double:
+   the A*X product is evaluated for a block of rows at a time, the
+   block is expanded to double, multiplied with the double matrix X
+   using double accumulators and rounded to float only when the result
+   is stored back. The difference compared to the pure double
+   calculation is therefore bounded by the float rounding of the input
+   and the output, and does not grow with the ensemble size.
+
+   The storage layout is the same column major layout as used by the
+   matrix_type, i.e. row_stride == 1 and column_stride == rows.
+*/
+
+#define FMATRIX_TYPE_ID     712109
+#define FMATRIX_BLOCK_ROWS  256
+
+struct fmatrix_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  float                 * data;
+  int                     rows;
+  int                     columns;
+};
+
+
+static size_t GET_INDEX( const fmatrix_type * m , size_t i , size_t j) {
+  return i + m->rows * j;
+}
+
+
+UTIL_IS_INSTANCE_FUNCTION( fmatrix , FMATRIX_TYPE_ID )
+UTIL_SAFE_CAST_FUNCTION( fmatrix , FMATRIX_TYPE_ID )
+
+
+/*
+  The freshly allocated matrix is initialized to zero. If safe_mode
+  is true NULL is returned if the allocation fails, otherwise the
+  function will abort().
+*/
+
+static fmatrix_type * fmatrix_alloc__( int rows , int columns , bool safe_mode ) {
+  fmatrix_type * matrix = util_malloc( sizeof * matrix );
+  size_t data_size      = (size_t) rows * columns;
+
+  UTIL_TYPE_ID_INIT( matrix , FMATRIX_TYPE_ID );
+  matrix->rows    = rows;
+  matrix->columns = columns;
+  if (safe_mode)
+    matrix->data = calloc( data_size , sizeof * matrix->data );
+  else
+    matrix->data = util_calloc( data_size , sizeof * matrix->data );
+
+  if ((matrix->data == NULL) && (data_size > 0)) {
+    free( matrix );
+    matrix = NULL;
+  }
+  return matrix;
+}
+
+
+fmatrix_type * fmatrix_alloc( int rows , int columns ) {
+  return fmatrix_alloc__( rows , columns , false );
+}
+
+
+fmatrix_type * fmatrix_safe_alloc( int rows , int columns ) {
+  return fmatrix_alloc__( rows , columns , true );
+}
+
+
+fmatrix_type * fmatrix_alloc_from_matrix( const matrix_type * src ) {
+  fmatrix_type * matrix = fmatrix_alloc( matrix_get_rows( src ) , matrix_get_columns( src ));
+  fmatrix_assign_matrix( matrix , src );
+  return matrix;
+}
+
+
+void fmatrix_free( fmatrix_type * matrix ) {
+  util_safe_free( matrix->data );
+  free( matrix );
+}
+
+
+/*****************************************************************/
+
+int fmatrix_get_rows( const fmatrix_type * matrix ) {
+  return matrix->rows;
+}
+
+int fmatrix_get_columns( const fmatrix_type * matrix ) {
+  return matrix->columns;
+}
+
+int fmatrix_get_row_stride( const fmatrix_type * matrix ) {
+  return 1;
+}
+
+int fmatrix_get_column_stride( const fmatrix_type * matrix ) {
+  return matrix->rows;
+}
+
+float * fmatrix_get_data( const fmatrix_type * matrix ) {
+  return matrix->data;
+}
+
+size_t fmatrix_get_byte_size( const fmatrix_type * matrix ) {
+  return (size_t) matrix->rows * matrix->columns * sizeof * matrix->data;
+}
+
+
+void fmatrix_iset( fmatrix_type * matrix , int i , int j , float value ) {
+  matrix->data[ GET_INDEX( matrix , i , j ) ] = value;
+}
+
+
+float fmatrix_iget( const fmatrix_type * matrix , int i , int j ) {
+  return matrix->data[ GET_INDEX( matrix , i , j ) ];
+}
+
+
+void fmatrix_set( fmatrix_type * matrix , float value ) {
+  size_t size = (size_t) matrix->rows * matrix->columns;
+  for (size_t index = 0; index < size; index++)
+    matrix->data[index] = value;
+}
+
+
+/*****************************************************************/
+
+/**
+   Copies the content of the double matrix B into the fmatrix A; the
+   two matrices must have the same size.
+*/
+
+void fmatrix_assign_matrix( fmatrix_type * A , const matrix_type * B ) {
+  if ((A->rows == matrix_get_rows( B )) && (A->columns == matrix_get_columns( B ))) {
+    const double * B_data   = matrix_get_data( B );
+    const int row_stride    = matrix_get_row_stride( B );
+    const int column_stride = matrix_get_column_stride( B );
+
+    for (int j = 0; j < A->columns; j++) {
+      const double * B_column = &B_data[ (size_t) j * column_stride ];
+      float * A_column        = &A->data[ GET_INDEX( A , 0 , j ) ];
+      for (int i = 0; i < A->rows; i++)
+        A_column[i] = B_column[ (size_t) i * row_stride ];
+    }
+  } else
+    util_abort("%s: size mismatch A:[%d,%d]  B:[%d,%d] \n",__func__ , A->rows , A->columns , matrix_get_rows( B ) , matrix_get_columns( B ));
+}
+
+
+/**
+   Copies the content of the fmatrix A into the double matrix B; the
+   two matrices must have the same size.
+*/
+
+void fmatrix_export( const fmatrix_type * A , matrix_type * B ) {
+  if ((A->rows == matrix_get_rows( B )) && (A->columns == matrix_get_columns( B ))) {
+    double * B_data         = matrix_get_data( B );
+    const int row_stride    = matrix_get_row_stride( B );
+    const int column_stride = matrix_get_column_stride( B );
+
+    for (int j = 0; j < A->columns; j++) {
+      double * B_column       = &B_data[ (size_t) j * column_stride ];
+      const float * A_column  = &A->data[ GET_INDEX( A , 0 , j ) ];
+      for (int i = 0; i < A->rows; i++)
+        B_column[ (size_t) i * row_stride ] = A_column[i];
+    }
+  } else
+    util_abort("%s: size mismatch A:[%d,%d]  B:[%d,%d] \n",__func__ , A->rows , A->columns , matrix_get_rows( B ) , matrix_get_columns( B ));
+}
+
+
+/*****************************************************************/
+
+/**
+   The binary format is: rows, columns and then the elements in column
+   major order as float.
+*/
+
+void fmatrix_fwrite( const fmatrix_type * matrix , FILE * stream ) {
+  util_fwrite_int( matrix->rows , stream );
+  util_fwrite_int( matrix->columns , stream );
+  util_fwrite( matrix->data , sizeof * matrix->data , (size_t) matrix->rows * matrix->columns , stream , __func__ );
+}
+
+
+fmatrix_type * fmatrix_fread_alloc( FILE * stream ) {
+  int rows              = util_fread_int( stream );
+  int columns           = util_fread_int( stream );
+  fmatrix_type * matrix = fmatrix_alloc( rows , columns );
+
+  util_fread( matrix->data , sizeof * matrix->data , (size_t) rows * columns , stream , __func__ );
+  return matrix;
+}
+
+
+/*****************************************************************/
+
+/**
+   Calculates A[row1:row2 , :] = A[row1:row2 , :] * B in blocks of
+   FMATRIX_BLOCK_ROWS rows. B is first copied to a dense double
+   buffer; for each block the rows of A are expanded to double, and
+   the products are summed in double before they are stored back as
+   float.
+*/
+
+static void fmatrix_inplace_matmul_rows( fmatrix_type * A , const matrix_type * B , int row1 , int row2) {
+  const int N          = A->columns;
+  double * B_data      = util_calloc( (size_t) N * N , sizeof * B_data );
+  double * A_block     = util_calloc( (size_t) FMATRIX_BLOCK_ROWS * N , sizeof * A_block );
+  double * AB_block    = util_calloc( (size_t) FMATRIX_BLOCK_ROWS * N , sizeof * AB_block );
+
+  for (int j = 0; j < N; j++)
+    for (int k = 0; k < N; k++)
+      B_data[ k + (size_t) j * N ] = matrix_iget( B , k , j );
+
+  for (int block_row = row1; block_row < row2; block_row += FMATRIX_BLOCK_ROWS) {
+    const int block_size = util_int_min( FMATRIX_BLOCK_ROWS , row2 - block_row );
+
+    for (int k = 0; k < N; k++) {
+      const float * A_column = &A->data[ GET_INDEX( A , block_row , k ) ];
+      double * A_block_col   = &A_block[ (size_t) k * block_size ];
+      for (int i = 0; i < block_size; i++)
+        A_block_col[i] = A_column[i];
+    }
+
+    for (int j = 0; j < N; j++) {
+      double * AB_column     = &AB_block[ (size_t) j * block_size ];
+      const double * B_column = &B_data[ (size_t) j * N ];
+
+      for (int i = 0; i < block_size; i++)
+        AB_column[i] = 0;
+
+      for (int k = 0; k < N; k++) {
+        const double b             = B_column[k];
+        const double * A_block_col = &A_block[ (size_t) k * block_size ];
+        if (b != 0) {
+          for (int i = 0; i < block_size; i++)
+            AB_column[i] += A_block_col[i] * b;
+        }
+      }
+    }
+
+    for (int j = 0; j < N; j++) {
+      float * A_column        = &A->data[ GET_INDEX( A , block_row , j ) ];
+      const double * AB_column = &AB_block[ (size_t) j * block_size ];
+      for (int i = 0; i < block_size; i++)
+        A_column[i] = AB_column[i];
+    }
+  }
+
+  free( AB_block );
+  free( A_block );
+  free( B_data );
+}
+
+
+static void fmatrix_assert_matmul_size( const fmatrix_type * A , const matrix_type * B , const char * caller) {
+  if (!((A->columns == matrix_get_rows( B )) && (matrix_get_rows( B ) == matrix_get_columns( B ))))
+    util_abort("%s: size mismatch: A:[%d,%d]   B:[%d,%d]\n",caller , A->rows , A->columns , matrix_get_rows( B ) , matrix_get_columns( B ));
+}
+
+
+void fmatrix_inplace_matmul( fmatrix_type * A , const matrix_type * B ) {
+  fmatrix_assert_matmul_size( A , B , __func__ );
+  fmatrix_inplace_matmul_rows( A , B , 0 , A->rows );
+}
+
+
+#ifdef WITH_THREAD_POOL
+
+static void * fmatrix_inplace_matmul_mt__( void * arg ) {
+  arg_pack_type * arg_pack = arg_pack_safe_cast( arg );
+  int row1                 = arg_pack_iget_int( arg_pack , 0 );
+  int row2                 = arg_pack_iget_int( arg_pack , 1 );
+  fmatrix_type * A         = arg_pack_iget_ptr( arg_pack , 2 );
+  const matrix_type * B    = arg_pack_iget_const_ptr( arg_pack , 3 );
+
+  fmatrix_inplace_matmul_rows( A , B , row1 , row2 );
+  return NULL;
+}
+
+
+/**
+   The thread_pool must be in the same state as for
+   matrix_inplace_matmul_mt2().
+*/
+
+void fmatrix_inplace_matmul_mt2( fmatrix_type * A , const matrix_type * B , thread_pool_type * thread_pool ) {
+  int num_threads  = thread_pool_get_max_running( thread_pool );
+  arg_pack_type ** arglist = util_calloc( num_threads , sizeof * arglist );
+  int it;
+
+  fmatrix_assert_matmul_size( A , B , __func__ );
+  thread_pool_restart( thread_pool );
+  {
+    int rows       = A->rows / num_threads;
+    int rows_mod   = A->rows % num_threads;
+    int row_offset = 0;
+
+    for (it = 0; it < num_threads; it++) {
+      int row_size = rows;
+      if (it < rows_mod)
+        row_size += 1;
+
+      arglist[it] = arg_pack_alloc();
+      arg_pack_append_int( arglist[it] , row_offset );
+      arg_pack_append_int( arglist[it] , row_offset + row_size );
+      arg_pack_append_ptr( arglist[it] , A );
+      arg_pack_append_const_ptr( arglist[it] , B );
+
+      thread_pool_add_job( thread_pool , fmatrix_inplace_matmul_mt__ , arglist[it] );
+      row_offset += row_size;
+    }
+  }
+  thread_pool_join( thread_pool );
+
+  for (it = 0; it < num_threads; it++)
+    arg_pack_free( arglist[it] );
+  free( arglist );
+}
+
+
+void fmatrix_inplace_matmul_mt1( fmatrix_type * A , const matrix_type * B , int num_threads ) {
+  thread_pool_type * thread_pool = thread_pool_alloc( num_threads , false );
+  fmatrix_inplace_matmul_mt2( A , B , thread_pool );
+  thread_pool_free( thread_pool );
+}
+
+#else
+
+void fmatrix_inplace_matmul_mt1( fmatrix_type * A , const matrix_type * B , int num_threads ) {
+  fmatrix_inplace_matmul( A , B );
+}
+
+#endif
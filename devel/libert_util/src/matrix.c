@@ -1112,6 +1112,30 @@ void matrix_shift_row(matrix_type * matrix , int row , double shift) {
 }
 
 
+/**
+   The two functions below will apply a separate shift/scale factor
+   to each row in the matrix, i.e. row i is shifted/scaled with
+   shift[i]/scale_factor[i]. Observe that the vector arguments must
+   have (at least) matrix->rows elements. The loop runs down the
+   columns, i.e. over consecutive memory for a default matrix.
+*/
+
+void matrix_shift_rows(matrix_type * matrix , const double * shift) {
+  int i,j;
+  for (j=0; j < matrix->columns; j++) 
+    for (i=0; i < matrix->rows; i++)
+      matrix->data[ GET_INDEX( matrix , i , j ) ] += shift[i];
+}
+
+
+void matrix_scale_rows(matrix_type * matrix , const double * scale_factor) {
+  int i,j;
+  for (j=0; j < matrix->columns; j++) 
+    for (i=0; i < matrix->rows; i++)
+      matrix->data[ GET_INDEX( matrix , i , j ) ] *= scale_factor[i];
+}
+
+
 
 /**
    For each row in the matrix we will do the operation
@@ -26,6 +26,20 @@
 
 #define PARSER_ESCAPE_CHAR '\\'
 
+/* 
+   Character classes in the compiled class_table; a character can be
+   in several classes, the tokenizer checks them in the order
+   splitter, comment, delete, special, quoter.
+*/
+#define CLASS_SPLITTER   1
+#define CLASS_SPECIAL    2
+#define CLASS_QUOTER     4
+#define CLASS_DELETE     8
+#define CLASS_COMMENT   16     /* The first character of comment_start. */
+
+/* Flags for the tokens in the token_stream. */
+#define TOKEN_UNESCAPE   1     /* Stripped quotation which contains the escape character. */
+#define TOKEN_DELETE     2     /* Contains characters from the delete set. */
 
 
 struct parser_struct
@@ -36,6 +50,33 @@ struct parser_struct
   char * quoters;       
   char * comment_start; 
   char * comment_end;   
+  unsigned char class_table[256];   /* Compiled from the sets above by parser_compile(). */
+};
+
+
+typedef struct {
+  int            offset;
+  int            length;
+  unsigned char  flags;
+} token_type;
+
+
+/*
+  The token_stream is the result of tokenizing a buffer; the tokens
+  are (offset , length) views into the buffer, i.e. no copy is made
+  of the token content. When the stream has been created from a file
+  the stream holds the file content, otherwise the calling scope must
+  keep the buffer alive as long as the stream is in use.
+*/
+
+struct token_stream_struct {
+  const char    * buffer;
+  char          * owned_buffer;
+  char          * arena;            /* '\0' terminated copies of the tokens; see token_stream_alloc_stringlist_ref(). */
+  token_type    * tokens;
+  int             size;
+  int             alloc_size;
+  unsigned char   class_table[256];
 };
 
 
@@ -46,37 +87,67 @@ static void __verify_string_length( const char * s) {
 }
 
 
+static void parser_compile_set( parser_type * parser , const char * set , unsigned char char_class) {
+  if (set != NULL) {
+    for (int i = 0; set[i] != '\0'; i++)
+      parser->class_table[ (unsigned char) set[i] ] |= char_class;
+  }
+}
+
+
+/*
+  Builds the 256 entry class table from the character sets; the table
+  is rebuilt every time one of the sets is changed.
+*/
+
+static void parser_compile( parser_type * parser ) {
+  memset( parser->class_table , 0 , sizeof parser->class_table );
+  parser_compile_set( parser , parser->splitters  , CLASS_SPLITTER );
+  parser_compile_set( parser , parser->specials   , CLASS_SPECIAL );
+  parser_compile_set( parser , parser->quoters    , CLASS_QUOTER );
+  parser_compile_set( parser , parser->delete_set , CLASS_DELETE );
+  if ((parser->comment_start != NULL) && (parser->comment_end != NULL))
+    parser->class_table[ (unsigned char) parser->comment_start[0] ] |= CLASS_COMMENT;
+}
+
+
 void parser_set_splitters( parser_type * parser , const char * splitters ) {
   __verify_string_length( splitters );
   parser->splitters = util_realloc_string_copy( parser->splitters , splitters );
+  parser_compile( parser );
 }
 
 
 void parser_set_quoters( parser_type * parser , const char * quoters ) {
   __verify_string_length( quoters );
   parser->quoters = util_realloc_string_copy( parser->quoters , quoters );
+  parser_compile( parser );
 }
 
 void parser_set_specials( parser_type * parser , const char * specials ) {
   __verify_string_length( specials );
   parser->specials = util_realloc_string_copy( parser->specials , specials );
+  parser_compile( parser );
 }
 
 
 void parser_set_delete_set( parser_type * parser , const char * delete_set ) {
   __verify_string_length( delete_set );
   parser->delete_set = util_realloc_string_copy( parser->delete_set , delete_set );
+  parser_compile( parser );
 }
 
 void parser_set_comment_start( parser_type * parser , const char * comment_start ) {
   __verify_string_length( comment_start );
   parser->comment_start = util_realloc_string_copy( parser->comment_start , comment_start );
+  parser_compile( parser );
 }
 
 
 void parser_set_comment_end( parser_type * parser , const char * comment_end ) {
   __verify_string_length( comment_end );
   parser->comment_end = util_realloc_string_copy( parser->comment_end , comment_end );
+  parser_compile( parser );
 }
 
 
@@ -102,6 +173,7 @@ parser_type * parser_alloc(
   parser_set_delete_set( parser , delete_set );
   parser_set_comment_start( parser , comment_start );
   parser_set_comment_end( parser , comment_end );
+  parser_compile( parser );
     
   if(comment_start == NULL && comment_end != NULL)
     util_abort("%s: Need to have comment_start when comment_end is set.\n", __func__);
@@ -141,21 +213,6 @@ bool is_escape(
 
 
 
-
-static
-int length_of_initial_splitters(
-  const char           * buffer_position,
-  const parser_type * parser)
-{
-  assert( buffer_position != NULL );
-  assert( parser       != NULL );
-
-  if( parser->splitters == NULL)
-    return 0;
-  else
-    return strspn( buffer_position, parser->splitters );
-}
-
 static bool in_set(char c , const char * set) {
   if (set == NULL)
     return false;
@@ -168,23 +225,6 @@ static bool in_set(char c , const char * set) {
 }
 
 
-static
-bool is_splitters(
-  const char             c,
-  const parser_type * parser)
-{
-  return in_set(c , parser->splitters);
-}
-
-static 
-bool is_special(
-  const char             c,
-  const parser_type * parser)
-{
-  return in_set(c , parser->specials);
-}
-
-
 static
 bool is_in_quoters(
   const char       c,
@@ -332,194 +372,305 @@ char * alloc_quoted_token(
 
 
 
-
-/** 
-    This does not care about the possible occurence of characters in
-    the delete_set. That is handled when the token is inserted in the
-    token list.
-*/
-    
-static
-int length_of_normal_non_splitters(
-  const char           * buffer,
-  const parser_type * parser)
-{
-  bool at_end  = false;
+static int length_of_delete( const char * buffer , const parser_type * parser) {
   int length   = 0;
   char current = buffer[0];
 
-  while(current != '\0' && !at_end)
-  {
+  while(is_in_delete_set( current , parser ) && current != '\0') {
     length += 1;
     current = buffer[length];
+  }
+  return length;
+}
 
-    if( is_splitters( current, parser ) )
-    {
-      at_end = true;
-      continue;
-    }
-    if( is_special( current, parser ) )
-    {
-      at_end = true;
-      continue;
-    }
-    if( is_in_quoters( current, parser ) )
-    {
-      at_end = true;
-      continue;
+
+/*****************************************************************/
+/* The token_stream */
+
+static token_stream_type * token_stream_alloc( const parser_type * parser , const char * buffer , char * owned_buffer) {
+  token_stream_type * stream = util_malloc( sizeof * stream );
+  stream->buffer       = buffer;
+  stream->owned_buffer = owned_buffer;
+  stream->arena        = NULL;
+  stream->size         = 0;
+  stream->alloc_size   = 0;
+  stream->tokens       = NULL;
+  memcpy( stream->class_table , parser->class_table , sizeof stream->class_table );
+  return stream;
+}
+
+
+static void token_stream_append( token_stream_type * stream , int offset , int length , unsigned char flags) {
+  if (stream->size == stream->alloc_size) {
+    stream->alloc_size = util_int_max( 1024 , 2 * stream->alloc_size );
+    stream->tokens     = util_realloc( stream->tokens , stream->alloc_size * sizeof * stream->tokens );
+  }
+  {
+    token_type * token = &stream->tokens[ stream->size ];
+    token->offset = offset;
+    token->length = length;
+    token->flags  = flags;
+  }
+  stream->size++;
+}
+
+
+void token_stream_free( token_stream_type * stream ) {
+  util_safe_free( stream->tokens );
+  util_safe_free( stream->owned_buffer );
+  util_safe_free( stream->arena );
+  free( stream );
+}
+
+
+int token_stream_get_size( const token_stream_type * stream ) {
+  return stream->size;
+}
+
+
+static const token_type * token_stream_iget( const token_stream_type * stream , int index ) {
+  if ((index < 0) || (index >= stream->size))
+    util_abort("%s: invalid index:%d - valid range: [0,%d) \n",__func__ , index , stream->size);
+  return &stream->tokens[index];
+}
+
+
+/**
+   Observe that the token text is *NOT* '\0' terminated; use
+   token_stream_iget_length() to find the length of the token, or
+   token_stream_alloc_token() to get a proper string. For stripped
+   quotations and tokens with characters from the delete set the text
+   is the raw text from the buffer, before unescaping and deleting.
+*/
+
+const char * token_stream_iget_ptr( const token_stream_type * stream , int index ) {
+  return &stream->buffer[ token_stream_iget( stream , index )->offset ];
+}
+
+
+int token_stream_iget_length( const token_stream_type * stream , int index ) {
+  return token_stream_iget( stream , index )->length;
+}
+
+
+int token_stream_iget_offset( const token_stream_type * stream , int index ) {
+  return token_stream_iget( stream , index )->offset;
+}
+
+
+/*
+  Writes the final token content to @target, which must have room for
+  at least length + 1 characters; returns the length of the token.
+*/
+
+static int token_stream_copy_token( const token_stream_type * stream , const token_type * token , char * target) {
+  const char * src = &stream->buffer[ token->offset ];
+  int length = 0;
+
+  if (token->flags == 0) {
+    memcpy( target , src , token->length );
+    length = token->length;
+  } else if (token->flags & TOKEN_UNESCAPE) {
+    const char quoter = stream->buffer[ token->offset - 1 ];
+    for (int i = 0; i < token->length; i++) {
+      if ((src[i] == PARSER_ESCAPE_CHAR) && (i + 1 < token->length) && (src[i + 1] == quoter))
+        i++;
+      target[length] = src[i];
+      length++;
     }
-    if( length_of_comment(&buffer[length], parser) > 0)
-    {
-      at_end = true;
-      continue;
+  } else {
+    for (int i = 0; i < token->length; i++) {
+      if ((stream->class_table[ (unsigned char) src[i] ] & CLASS_DELETE) == 0) {
+        target[length] = src[i];
+        length++;
+      }
     }
   }
-
+  target[length] = '\0';
   return length;
 }
 
 
+char * token_stream_alloc_token( const token_stream_type * stream , int index ) {
+  const token_type * token = token_stream_iget( stream , index );
+  char * string = util_malloc( (token->length + 1) * sizeof * string );
+  token_stream_copy_token( stream , token , string );
+  return string;
+}
 
-static int length_of_delete( const char * buffer , const parser_type * parser) {
-  int length   = 0;
-  char current = buffer[0];
 
-  while(is_in_delete_set( current , parser ) && current != '\0') {
-    length += 1;
-    current = buffer[length];
+bool token_stream_iequal( const token_stream_type * stream , int index , const char * string ) {
+  const token_type * token = token_stream_iget( stream , index );
+  if (token->flags == 0)
+    return ((strncmp( &stream->buffer[ token->offset ] , string , token->length ) == 0) && (string[ token->length ] == '\0'));
+  else {
+    char * s = token_stream_alloc_token( stream , index );
+    bool equal = util_string_equal( s , string );
+    free( s );
+    return equal;
   }
-  return length;
 }
 
 
 /**
-   Allocates a new stringlist. 
+   Allocates a stringlist with copies of all the tokens; this gives
+   the same result as the old parser_tokenize_buffer().
 */
-stringlist_type * parser_tokenize_buffer(
-  const parser_type    * parser,
-  const char           * buffer,
-  bool                   strip_quote_marks)
-{
-  int position          = 0;
-  int buffer_size       = strlen(buffer);
-  int splitters_length  = 0;
-  int comment_length    = 0;
-  int delete_length     = 0;
 
+stringlist_type * token_stream_alloc_stringlist( const token_stream_type * stream ) {
   stringlist_type * tokens = stringlist_alloc_new();
-  
-  while( position < buffer_size )
+  for (int i = 0; i < stream->size; i++)
+    stringlist_append_owned_ref( tokens , token_stream_alloc_token( stream , i ));
+  return tokens;
+}
+
+
+/**
+   Allocates a stringlist with references to '\0' terminated copies of
+   the tokens which are held in one block of memory by the stream;
+   the stringlist can not be used after the stream has been freed.
+   This avoids one malloc() per token for large inputs.
+*/
+
+stringlist_type * token_stream_alloc_stringlist_ref( token_stream_type * stream ) {
+  stringlist_type * tokens = stringlist_alloc_new();
+  size_t arena_size = 0;
+  for (int i = 0; i < stream->size; i++)
+    arena_size += stream->tokens[i].length + 1;
+
+  util_safe_free( stream->arena );
+  stream->arena = util_malloc( util_size_t_max( arena_size , 1 ) * sizeof * stream->arena );
   {
-    /** 
-      Skip initial splitters.
-    */
-    splitters_length = length_of_initial_splitters( &buffer[position], parser );
-    if(splitters_length > 0)
-    {
-      position += splitters_length;
-      continue;
+    size_t offset = 0;
+    for (int i = 0; i < stream->size; i++) {
+      char * target = &stream->arena[offset];
+      offset += token_stream_copy_token( stream , &stream->tokens[i] , target ) + 1;
+      stringlist_append_ref( tokens , target );
     }
+  }
+  return tokens;
+}
 
 
-    /**
-      Skip comments.
-    */
-    comment_length = length_of_comment( &buffer[position], parser);
-    if(comment_length > 0)
-    {
-      position += comment_length;
+/**
+   The tokenizer; this is equivalent to the old character by
+   character tokenizer, but classifies the characters with the
+   compiled class_table, and only records the position of the
+   tokens. The skipping of splitters, comments and deleted characters
+   takes presedence over the special characters and quotations, in
+   that order.
+*/
+
+static void parser_tokenize_stream( const parser_type * parser , token_stream_type * stream , bool strip_quote_marks) {
+  const unsigned char * table = parser->class_table;
+  const char * buffer         = stream->buffer;
+  const int buffer_size       = strlen( buffer );
+  const int comment_length    = (parser->comment_start == NULL) ? 0 : strlen( parser->comment_start );
+  int position                = 0;
+
+  while (position < buffer_size) {
+    unsigned char char_class = table[ (unsigned char) buffer[position] ];
+
+    if (char_class & CLASS_SPLITTER) {
+      do {
+        position++;
+      } while ((position < buffer_size) && (table[ (unsigned char) buffer[position] ] & CLASS_SPLITTER));
       continue;
     }
 
-    
-    /**
-       Skip characters which are just deleted. 
-    */
-      
-    delete_length = length_of_delete( &buffer[position] , parser );
-    if (delete_length > 0) {
-      position += delete_length;
+    if ((char_class & CLASS_COMMENT) && (strncmp( &buffer[position] , parser->comment_start , comment_length ) == 0)) {
+      const char * comment_end = strstr( &buffer[position + comment_length] , parser->comment_end );
+      if (comment_end == NULL)
+        position = buffer_size;
+      else
+        position = (comment_end - buffer) + strlen( parser->comment_end );
       continue;
     }
 
+    if (char_class & CLASS_DELETE) {
+      position++;
+      continue;
+    }
 
-
-    /** 
-       Copy the character if it is in the special set,
-    */
-    if( is_special( buffer[position], parser ) )
-    {
-      char key[2];
-      key[0] = buffer[position];
-      key[1] = '\0';
-      stringlist_append_copy( tokens, key );
-      position += 1;
+    if (char_class & CLASS_SPECIAL) {
+      token_stream_append( stream , position , 1 , 0 );
+      position++;
       continue;
     }
 
-    /**
-       If the character is a quotation start, we copy the whole quotation.
-    */
-    if( is_in_quoters( buffer[position], parser ) )
-    {
-      int length   = length_of_quotation( &buffer[position] );
-      char * token = alloc_quoted_token( &buffer[position], length, strip_quote_marks );
-      stringlist_append_owned_ref( tokens, token );
+    if (char_class & CLASS_QUOTER) {
+      int length = length_of_quotation( &buffer[position] );
+      if (strip_quote_marks) {
+        unsigned char flags = 0;
+        if (memchr( &buffer[position + 1] , PARSER_ESCAPE_CHAR , length - 2 ) != NULL)
+          flags = TOKEN_UNESCAPE;
+        token_stream_append( stream , position + 1 , length - 2 , flags );
+      } else
+        token_stream_append( stream , position , length , 0 );
       position += length;
       continue;
     }
 
-    /**
-      If we are here, we are guaranteed that that
-      buffer[position] is not:
-
-      1. Whitespace.
-      2. The start of a comment.
-      3. A special character.
-      4. The start of a quotation.
-      5. Something to delete.
-
-      In other words, it is the start of plain
-      non-splitters. Now we need to find the
-      length of the non-splitters until:
-
-      1. Whitespace starts.
-      2. A comment starts.
-      3. A special character occur.
-      4. A quotation starts.
+    /* 
+       Plain token: runs until a splitter, a special character, a
+       quotation or a comment starts. Deleted characters do not end
+       the token.
     */
-
     {
-      int length   = length_of_normal_non_splitters( &buffer[position], parser );
-      char * token = util_calloc( (length + 1) , sizeof * token);
-      int token_length;
-      if (parser->delete_set == NULL) {
-        token_length = length;
-        memcpy( token , &buffer[position] , length * sizeof * token );
-      } else {
-        int i;
-        token_length = 0;
-        for (i = 0; i < length; i++) {
-          char c = buffer[position + i];
-          if ( !is_in_delete_set( c , parser)) {
-            token[token_length] = c;
-            token_length++;
-          }
-        }
+      int length          = 1;
+      unsigned char flags = 0;
+      while (position + length < buffer_size) {
+        unsigned char c_class = table[ (unsigned char) buffer[position + length] ];
+        if (c_class & (CLASS_SPLITTER | CLASS_SPECIAL | CLASS_QUOTER))
+          break;
+        if ((c_class & CLASS_COMMENT) && (strncmp( &buffer[position + length] , parser->comment_start , comment_length ) == 0))
+          break;
+        if (c_class & CLASS_DELETE)
+          flags = TOKEN_DELETE;
+        length++;
       }
-
-
-      if (token_length > 0) { /* We do not insert empty tokens. */
-        token[token_length] = '\0';
-        stringlist_append_owned_ref( tokens, token );
-      } else 
-        free( token );    /* The whole thing is discarded. */
-
+      token_stream_append( stream , position , length , flags );
       position += length;
-      continue;
     }
   }
+}
+
+
+/**
+   Tokenizes the buffer without copying it; the buffer must be kept
+   alive until the stream is freed.
+*/
+
+token_stream_type * parser_alloc_token_stream( const parser_type * parser , const char * buffer , bool strip_quote_marks) {
+  token_stream_type * stream = token_stream_alloc( parser , buffer , NULL );
+  parser_tokenize_stream( parser , stream , strip_quote_marks );
+  return stream;
+}
+
+
+/**
+   The file is read in one go, and the content is held by the stream.
+*/
 
+token_stream_type * parser_alloc_token_stream_file( const parser_type * parser , const char * filename , bool strip_quote_marks) {
+  char * buffer = util_fread_alloc_file_content( filename , NULL );
+  token_stream_type * stream = token_stream_alloc( parser , buffer , buffer );
+  parser_tokenize_stream( parser , stream , strip_quote_marks );
+  return stream;
+}
+
+
+/**
+   Allocates a new stringlist. 
+*/
+stringlist_type * parser_tokenize_buffer(
+  const parser_type    * parser,
+  const char           * buffer,
+  bool                   strip_quote_marks)
+{
+  token_stream_type * stream = parser_alloc_token_stream( parser , buffer , strip_quote_marks );
+  stringlist_type * tokens   = token_stream_alloc_stringlist( stream );
+  token_stream_free( stream );
   return tokens;
 }
 
@@ -530,10 +681,9 @@ stringlist_type * parser_tokenize_file(
   const char           * filename,
   bool                   strip_quote_marks)
 {
-  stringlist_type * tokens;
-  char * buffer = util_fread_alloc_file_content( filename, NULL );
-  tokens = parser_tokenize_buffer( parser, buffer, strip_quote_marks );
-  free(buffer);
+  token_stream_type * stream = parser_alloc_token_stream_file( parser , filename , strip_quote_marks );
+  stringlist_type * tokens   = token_stream_alloc_stringlist( stream );
+  token_stream_free( stream );
   return tokens;
 }
 
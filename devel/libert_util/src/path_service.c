@@ -0,0 +1,513 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'path_service.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#include <ert/util/util.h>
+#include <ert/util/vector.h>
+#include <ert/util/hash.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/path_service.h>
+
+/*
+  The path_service creates and clears the (many) directories of an
+  ensemble run. Clearing a directory with util_clear_directory() walks
+  and unlinks the whole tree before returning; on a networked
+  filesystem with GBs of old simulation output in each runpath that
+  can take longer than the simulation itself.
+
+  path_service_clear_directory() instead renames the directory to a
+  trash directory next to it - a rename within one directory is
+  atomic and does not touch the content - creates a new empty
+  directory in its place and returns immediately. The trash
+  directories are deleted in the background by a fixed number of
+  worker threads, i.e. the number of concurrent deletions is bounded
+  by the number of threads given to path_service_alloc().
+
+  Trash directories left behind by an ERT process which has died
+  before the deletion was complete are named with the pid of that
+  process; they are deleted by the first path_service which clears a
+  directory next to them.
+*/
+
+#define PATH_SERVICE_TYPE_ID 66139054
+#define TRASH_PREFIX         ".trash"
+
+
+typedef struct {
+  char * path;
+  char * restore_path;   /* Where files which are not deleted with strict_uid are moved back; can be NULL. */
+  bool   strict_uid;
+} trash_node_type;
+
+
+struct path_service_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  int               num_threads;
+  pthread_t       * threads;
+  pthread_mutex_t   mutex;
+  pthread_cond_t    work_cond;      /* Signalled when trash is added, or when the service is stopped. */
+  pthread_cond_t    idle_cond;      /* Signalled when a worker has completed the deletion of a trash directory. */
+  vector_type     * trash_list;     /* Trash directories which have not yet been picked up by a worker. */
+  int               active;         /* The number of trash directories currently being deleted. */
+  int               trash_counter;
+  hash_type       * reaped_dirs;    /* The parent directories which have been searched for leftover trash. */
+  bool              stop;
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( path_service , PATH_SERVICE_TYPE_ID )
+
+
+/*****************************************************************/
+
+static trash_node_type * trash_node_alloc( const char * path , const char * restore_path , bool strict_uid ) {
+  trash_node_type * node = util_malloc( sizeof * node );
+  node->path         = util_alloc_string_copy( path );
+  node->restore_path = util_alloc_string_copy( restore_path );
+  node->strict_uid   = strict_uid;
+  return node;
+}
+
+
+static void trash_node_free( trash_node_type * node ) {
+  free( node->path );
+  util_safe_free( node->restore_path );
+  free( node );
+}
+
+
+static void trash_node_free__( void * arg ) {
+  trash_node_free( (trash_node_type *) arg );
+}
+
+
+/*****************************************************************/
+
+#ifdef HAVE_OPENAT
+
+/*
+  Deletes the directory @name in the directory @parent_fd. All
+  operations are relative to the open directory descriptors, so the
+  full path is never resolved again by the filesystem. As in
+  util_clear_directory() only files owned by the current user are
+  removed when @strict_uid is true; symlinks and directories are
+  removed unconditionally, and failures are silently ignored. FIFOs,
+  sockets and device files are treated as regular files; they must be
+  unlinked, otherwise the directory can never be removed.
+*/
+
+static void path_service_unlink_tree( int parent_fd , const char * name , bool strict_uid , uid_t uid ) {
+  int fd = openat( parent_fd , name , O_RDONLY | O_DIRECTORY | O_NOFOLLOW );
+  if (fd >= 0) {
+    DIR * dirH = fdopendir( fd );
+    if (dirH != NULL) {
+      struct dirent * dentry;
+
+      while ((dentry = readdir( dirH )) != NULL) {
+        const char * entry_name = dentry->d_name;
+        if ((strcmp( entry_name , "." ) != 0) && (strcmp( entry_name , ".." ) != 0)) {
+          unsigned char d_type = dentry->d_type;
+          struct stat buffer;
+          bool have_stat = false;
+
+          if ((d_type == DT_UNKNOWN) || (strict_uid && (d_type != DT_DIR) && (d_type != DT_LNK))) {
+            if (fstatat( fd , entry_name , &buffer , AT_SYMLINK_NOFOLLOW ) != 0)
+              continue;
+            have_stat = true;
+            if (S_ISDIR( buffer.st_mode ))
+              d_type = DT_DIR;
+            else if (S_ISLNK( buffer.st_mode ))
+              d_type = DT_LNK;
+            else
+              d_type = DT_REG;
+          }
+
+          if (d_type == DT_DIR)
+            path_service_unlink_tree( fd , entry_name , strict_uid , uid );
+          else if (d_type == DT_LNK)
+            unlinkat( fd , entry_name , 0 );
+          else if ((!strict_uid) || (have_stat && (buffer.st_uid == uid)))
+            unlinkat( fd , entry_name , 0 );
+        }
+      }
+      closedir( dirH );   /* Closes fd as well. */
+    } else
+      close( fd );
+
+    unlinkat( parent_fd , name , AT_REMOVEDIR );
+  }
+}
+
+
+/*
+  Moves what is left of the trash tree @src_name back to @target_name
+  when the trash could not be deleted completely, i.e. when it
+  contains files owned by other users. Entries which do not exist in
+  the target are renamed into it, directories which exist in both
+  places are merged; an entry which has been recreated in the target
+  in the meantime is left in the trash.
+*/
+
+static void path_service_restore_tree( int src_parent_fd , const char * src_name , int target_parent_fd , const char * target_name ) {
+  struct stat src_stat;
+  struct stat target_stat;
+
+  if (fstatat( src_parent_fd , src_name , &src_stat , AT_SYMLINK_NOFOLLOW ) != 0)
+    return;
+
+  if (fstatat( target_parent_fd , target_name , &target_stat , AT_SYMLINK_NOFOLLOW ) != 0)
+    renameat( src_parent_fd , src_name , target_parent_fd , target_name );
+  else if (S_ISDIR( src_stat.st_mode ) && S_ISDIR( target_stat.st_mode )) {
+    int src_fd    = openat( src_parent_fd , src_name , O_RDONLY | O_DIRECTORY | O_NOFOLLOW );
+    int target_fd = openat( target_parent_fd , target_name , O_RDONLY | O_DIRECTORY | O_NOFOLLOW );
+
+    if ((src_fd >= 0) && (target_fd >= 0)) {
+      DIR * dirH = fdopendir( src_fd );
+      if (dirH != NULL) {
+        struct dirent * dentry;
+        src_fd = -1;   /* Owned by dirH. */
+
+        while ((dentry = readdir( dirH )) != NULL) {
+          const char * entry_name = dentry->d_name;
+          if ((strcmp( entry_name , "." ) != 0) && (strcmp( entry_name , ".." ) != 0))
+            path_service_restore_tree( dirfd( dirH ) , entry_name , target_fd , entry_name );
+        }
+        closedir( dirH );
+      }
+    }
+
+    if (src_fd >= 0)
+      close( src_fd );
+    if (target_fd >= 0)
+      close( target_fd );
+
+    unlinkat( src_parent_fd , src_name , AT_REMOVEDIR );
+  }
+}
+
+
+static void path_service_delete_trash( const trash_node_type * node ) {
+  path_service_unlink_tree( AT_FDCWD , node->path , node->strict_uid , getuid() );
+
+  if (node->strict_uid && (node->restore_path != NULL) && util_entry_exists( node->path ))
+    path_service_restore_tree( AT_FDCWD , node->path , AT_FDCWD , node->restore_path );
+}
+
+
+/* The ownership of the files is checked by the worker when the tree is deleted. */
+static bool path_service_can_trash( bool strict_uid ) {
+  return true;
+}
+
+#else
+
+static void path_service_delete_trash( const trash_node_type * node ) {
+  util_clear_directory( node->path , node->strict_uid , true );
+}
+
+
+/*
+  Without openat() the files which are not deleted can not be moved
+  back safely; with strict_uid the directory is cleared synchronously.
+*/
+
+static bool path_service_can_trash( bool strict_uid ) {
+  return !strict_uid;
+}
+
+#endif
+
+
+static void * path_service_worker( void * arg ) {
+  path_service_type * service = (path_service_type *) arg;
+
+  pthread_mutex_lock( &service->mutex );
+  while (true) {
+    if (vector_get_size( service->trash_list ) > 0) {
+      trash_node_type * node = vector_pop_front( service->trash_list );
+      service->active++;
+      pthread_mutex_unlock( &service->mutex );
+
+      path_service_delete_trash( node );
+      trash_node_free( node );
+
+      pthread_mutex_lock( &service->mutex );
+      service->active--;
+      pthread_cond_broadcast( &service->idle_cond );
+    } else if (service->stop)
+      break;
+    else
+      pthread_cond_wait( &service->work_cond , &service->mutex );
+  }
+  pthread_mutex_unlock( &service->mutex );
+  return NULL;
+}
+
+
+/*****************************************************************/
+
+
+path_service_type * path_service_alloc( int num_threads ) {
+  path_service_type * service = util_malloc( sizeof * service );
+  UTIL_TYPE_ID_INIT( service , PATH_SERVICE_TYPE_ID );
+
+  if (num_threads < 1)
+    util_abort("%s: invalid number of threads:%d \n",__func__ , num_threads);
+
+  service->num_threads   = num_threads;
+  service->threads       = util_calloc( num_threads , sizeof * service->threads );
+  service->trash_list    = vector_alloc_new();
+  service->active        = 0;
+  service->trash_counter = 0;
+  service->reaped_dirs   = hash_alloc();
+  service->stop          = false;
+  pthread_mutex_init( &service->mutex , NULL );
+  pthread_cond_init( &service->work_cond , NULL );
+  pthread_cond_init( &service->idle_cond , NULL );
+
+  for (int i = 0; i < num_threads; i++) {
+    if (pthread_create( &service->threads[i] , NULL , path_service_worker , service ) != 0)
+      util_abort("%s: failed to start worker thread: %s \n",__func__ , strerror( errno ));
+  }
+
+  return service;
+}
+
+
+/**
+   Blocks until all the trash directories have been deleted.
+*/
+
+void path_service_join( path_service_type * service ) {
+  pthread_mutex_lock( &service->mutex );
+  while ((vector_get_size( service->trash_list ) > 0) || (service->active > 0))
+    pthread_cond_wait( &service->idle_cond , &service->mutex );
+  pthread_mutex_unlock( &service->mutex );
+}
+
+
+/**
+   Will complete the pending deletions before returning.
+*/
+
+void path_service_free( path_service_type * service ) {
+  pthread_mutex_lock( &service->mutex );
+  service->stop = true;
+  pthread_cond_broadcast( &service->work_cond );
+  pthread_mutex_unlock( &service->mutex );
+
+  for (int i = 0; i < service->num_threads; i++)
+    pthread_join( service->threads[i] , NULL );
+
+  vector_free( service->trash_list );
+  hash_free( service->reaped_dirs );
+  pthread_cond_destroy( &service->idle_cond );
+  pthread_cond_destroy( &service->work_cond );
+  pthread_mutex_destroy( &service->mutex );
+  free( service->threads );
+  free( service );
+}
+
+
+int path_service_get_num_threads( const path_service_type * service ) {
+  return service->num_threads;
+}
+
+
+/**
+   The number of trash directories which have not yet been completely
+   deleted.
+*/
+
+int path_service_get_pending( path_service_type * service ) {
+  int pending;
+  pthread_mutex_lock( &service->mutex );
+  pending = vector_get_size( service->trash_list ) + service->active;
+  pthread_mutex_unlock( &service->mutex );
+  return pending;
+}
+
+
+static void path_service_add_trash( path_service_type * service , const char * trash_path , const char * restore_path , bool strict_uid ) {
+  pthread_mutex_lock( &service->mutex );
+  vector_append_owned_ref( service->trash_list , trash_node_alloc( trash_path , restore_path , strict_uid ) , trash_node_free__ );
+  pthread_cond_signal( &service->work_cond );
+  pthread_mutex_unlock( &service->mutex );
+}
+
+
+/*
+  The trash directories are named .trash.<name>.<pid>.<counter>;
+  returns true if @name is a trash directory of a process which is
+  no longer running on this host.
+*/
+
+static bool path_service_is_stale_trash( const char * name ) {
+  bool stale = false;
+  if (strncmp( name , TRASH_PREFIX "." , strlen( TRASH_PREFIX ) + 1 ) == 0) {
+    const char * counter_dot = strrchr( name , '.' );
+    const char * pid_dot     = counter_dot;
+
+    while ((pid_dot > name) && (*(pid_dot - 1) != '.'))
+      pid_dot--;
+
+    if ((pid_dot > name) && (pid_dot < counter_dot)) {
+      char * pid_string = util_alloc_substring_copy( pid_dot , 0 , counter_dot - pid_dot );
+      int pid;
+      if (util_sscanf_int( pid_string , &pid ) && (pid > 0) && (pid != getpid())) {
+        if ((kill( pid , 0 ) != 0) && (errno == ESRCH))
+          stale = true;
+      }
+      free( pid_string );
+    }
+  }
+  return stale;
+}
+
+
+/*
+  Queues the stale trash directories in @dirname for deletion; every
+  directory is only searched once by a service.
+*/
+
+static void path_service_reap_trash( path_service_type * service , const char * dirname , bool strict_uid ) {
+  const char * key = (dirname == NULL) ? "." : dirname;
+  bool search;
+
+  pthread_mutex_lock( &service->mutex );
+  search = !hash_has_key( service->reaped_dirs , key );
+  if (search)
+    hash_insert_ref( service->reaped_dirs , key , NULL );
+  pthread_mutex_unlock( &service->mutex );
+
+  if (search) {
+    DIR * dirH = opendir( key );
+    if (dirH != NULL) {
+      struct dirent * dentry;
+      while ((dentry = readdir( dirH )) != NULL) {
+        if (path_service_is_stale_trash( dentry->d_name )) {
+          char * trash_path = util_alloc_filename( dirname , dentry->d_name , NULL );
+          if (util_is_directory( trash_path ))
+            path_service_add_trash( service , trash_path , NULL , strict_uid );
+          free( trash_path );
+        }
+      }
+      closedir( dirH );
+    }
+  }
+}
+
+
+/*
+  The trash path is in the same directory as @path. The path is split
+  by hand; util_split_alloc_filename() returns NULL for an existing
+  directory.
+*/
+
+static char * path_service_alloc_trash_path( path_service_type * service , const char * path , bool strict_uid ) {
+  char * dirname  = NULL;
+  char * filename;
+  char * trash_name;
+  char * trash_path;
+  int counter;
+
+  {
+    int length = strlen( path );
+    int name_start;
+
+    while ((length > 1) && (path[length - 1] == UTIL_PATH_SEP_CHAR))
+      length--;
+
+    name_start = length;
+    while ((name_start > 0) && (path[name_start - 1] != UTIL_PATH_SEP_CHAR))
+      name_start--;
+
+    if (name_start == length)
+      return NULL;                            /* The root directory. */
+
+    filename = util_alloc_substring_copy( path , name_start , length - name_start );
+    if (name_start > 0)
+      dirname = util_alloc_substring_copy( path , 0 , (name_start > 1) ? name_start - 1 : 1 );
+  }
+
+  pthread_mutex_lock( &service->mutex );
+  counter = service->trash_counter++;
+  pthread_mutex_unlock( &service->mutex );
+
+  path_service_reap_trash( service , dirname , strict_uid );
+
+  trash_name = util_alloc_sprintf( "%s.%s.%d.%d" , TRASH_PREFIX , filename , getpid() , counter );
+  trash_path = util_alloc_filename( dirname , trash_name , NULL );
+
+  util_safe_free( dirname );
+  free( filename );
+  free( trash_name );
+  return trash_path;
+}
+
+
+/**
+   Clears the directory @path, with the same arguments as
+
+      util_clear_directory( path , strict_uid , unlink_root );
+
+   but the deletion happens in the background. When @unlink_root is
+   false a new empty directory is created at @path. If the directory can
+   not be renamed, e.g. because it is a symlink, or we do not have
+   write permission in the parent directory, it is cleared
+   synchronously with util_clear_directory().
+
+   With @strict_uid == true files owned by other users must be left
+   in @path, as util_clear_directory() does. The ownership is checked
+   by the worker while the trash is deleted; the files which are not
+   deleted are then moved back to @path.
+*/
+
+void path_service_clear_directory( path_service_type * service , const char * path , bool strict_uid , bool unlink_root ) {
+  struct stat buffer;
+
+  if (lstat( path , &buffer ) != 0)
+    return;                                   /* Nothing to clear. */
+
+  if (S_ISDIR( buffer.st_mode ) && path_service_can_trash( strict_uid )) {
+    char * trash_path = path_service_alloc_trash_path( service , path , strict_uid );
+
+    if ((trash_path != NULL) && (rename( path , trash_path ) == 0)) {
+      if (!unlink_root)
+        util_make_path( path );
+
+      path_service_add_trash( service , trash_path , path , strict_uid );
+    } else
+      util_clear_directory( path , strict_uid , unlink_root );
+
+    util_safe_free( trash_path );
+  } else
+    util_clear_directory( path , strict_uid , unlink_root );
+}
@@ -0,0 +1,474 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'render_cache.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+#ifdef WITH_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <ert/util/util.h>
+#include <ert/util/hash.h>
+#include <ert/util/buffer.h>
+#include <ert/util/subst_list.h>
+#include <ert/util/subst_template.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/render_cache.h>
+
+/*
+  The render_cache is used when many files are rendered from the same
+  source, e.g. when the runpath directories of an ensemble are
+  created from templates and the ECLIPSE datafile. It holds three
+  things:
+
+    sources : The content of the source files, which are loaded from
+              disk only once.
+
+    templates : The sources compiled to subst_template instances, for
+              each set of subst_list keys they are rendered with.
+
+    outputs : A map from a key identifying the rendered content to
+              the file where that content was first written. When a
+              later render has the same key, the existing file is
+              cloned instead of rendering the source again.
+
+  The caller is responsible for composing a key which identifies the
+  rendered content completely; for sources rendered through a
+  subst_template the key is composed from the source filename and
+  subst_template_alloc_filter_key(), which only includes the values
+  of the keys the compiled template actually uses.
+
+  An output file is only reused if it still has the size, modification
+  time and inode it had when it was added; the content of the source
+  files is NOT checked against the file system after it has been
+  loaded, i.e. the cache should be cleared when the sources might
+  have changed. The cache can be used from several threads
+  concurrently.
+
+  The clone is a reflink where the filesystem supports it, otherwise
+  the content is copied. If hardlink is set to true the files are
+  hardlinked instead of copied; that is fast and saves space, but all
+  the files sharing an inode will be affected if one of them is
+  updated in place.
+*/
+
+#define RENDER_CACHE_TYPE_ID 66120417
+#define RENDER_CACHE_BLOCK_SIZE 1048576
+
+typedef struct {
+  char   * filename;
+  dev_t    device;
+  ino_t    inode;
+  off_t    size;
+  time_t   mtime;
+} render_output_type;
+
+
+struct render_cache_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  hash_type       * sources;
+  hash_type       * templates;
+  hash_type       * outputs;
+  bool              hardlink;
+  int               hits;
+  int               misses;
+#ifdef WITH_PTHREAD
+  pthread_mutex_t   mutex;
+#endif
+};
+
+
+static void render_output_free( render_output_type * output ) {
+  free( output->filename );
+  free( output );
+}
+
+
+static void render_output_free__( void * arg ) {
+  render_output_free( (render_output_type *) arg );
+}
+
+
+static void render_cache_lock( render_cache_type * cache ) {
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &cache->mutex );
+#endif
+}
+
+
+static void render_cache_unlock( render_cache_type * cache ) {
+#ifdef WITH_PTHREAD
+  pthread_mutex_unlock( &cache->mutex );
+#endif
+}
+
+
+UTIL_IS_INSTANCE_FUNCTION( render_cache , RENDER_CACHE_TYPE_ID )
+
+
+render_cache_type * render_cache_alloc( ) {
+  render_cache_type * cache = util_malloc( sizeof * cache );
+  UTIL_TYPE_ID_INIT( cache , RENDER_CACHE_TYPE_ID );
+  cache->sources  = hash_alloc();
+  cache->templates = hash_alloc();
+  cache->outputs  = hash_alloc();
+  cache->hardlink = false;
+  cache->hits     = 0;
+  cache->misses   = 0;
+#ifdef WITH_PTHREAD
+  pthread_mutex_init( &cache->mutex , NULL );
+#endif
+  return cache;
+}
+
+
+void render_cache_free( render_cache_type * cache ) {
+  hash_free( cache->sources );
+  hash_free( cache->templates );
+  hash_free( cache->outputs );
+#ifdef WITH_PTHREAD
+  pthread_mutex_destroy( &cache->mutex );
+#endif
+  free( cache );
+}
+
+
+/**
+   Observe that this invalidates all the pointers returned from
+   render_cache_get_source(); it should not be called while the cache
+   is in use by other threads.
+*/
+
+void render_cache_clear( render_cache_type * cache ) {
+  render_cache_lock( cache );
+  hash_clear( cache->sources );
+  hash_clear( cache->templates );
+  hash_clear( cache->outputs );
+  cache->hits   = 0;
+  cache->misses = 0;
+  render_cache_unlock( cache );
+}
+
+
+void render_cache_set_hardlink( render_cache_type * cache , bool hardlink ) {
+  cache->hardlink = hardlink;
+}
+
+
+bool render_cache_get_hardlink( const render_cache_type * cache ) {
+  return cache->hardlink;
+}
+
+
+int render_cache_get_hits( render_cache_type * cache ) {
+  int hits;
+  render_cache_lock( cache );
+  hits = cache->hits;
+  render_cache_unlock( cache );
+  return hits;
+}
+
+
+int render_cache_get_misses( render_cache_type * cache ) {
+  int misses;
+  render_cache_lock( cache );
+  misses = cache->misses;
+  render_cache_unlock( cache );
+  return misses;
+}
+
+
+/**
+   Returns the content of @src_file as a \0 terminated string. The
+   file is only read the first time; the returned pointer is owned by
+   the cache and is valid until the cache is cleared.
+*/
+
+const char * render_cache_get_source( render_cache_type * cache , const char * src_file ) {
+  const char * content;
+
+  render_cache_lock( cache );
+  content = hash_safe_get( cache->sources , src_file );
+  render_cache_unlock( cache );
+
+  if (content == NULL) {
+    int    buffer_size;
+    char * buffer = util_fread_alloc_file_content( src_file , &buffer_size );
+
+    render_cache_lock( cache );
+    if (hash_has_key( cache->sources , src_file ))
+      free( buffer );   /* Another thread loaded it in the meantime. */
+    else
+      hash_insert_hash_owned_ref( cache->sources , src_file , buffer , free );
+    content = hash_get( cache->sources , src_file );
+    render_cache_unlock( cache );
+  }
+
+  return content;
+}
+
+
+/**
+   Returns the source @content - identified by @source_id - compiled
+   for rendering with @subst_list1 and @subst_list2. The template is
+   only compiled the first time it is requested for a given set of
+   keys; the returned template is owned by the cache and is valid
+   until the cache is cleared.
+*/
+
+const subst_template_type * render_cache_get_template( render_cache_type * cache , const char * source_id , const char * content , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  const subst_template_type * subst_template;
+  char * signature = subst_template_alloc_key_signature( subst_list1 , subst_list2 );
+  char * key = util_alloc_sprintf( "%s:%s" , source_id , signature );
+
+  render_cache_lock( cache );
+  subst_template = hash_safe_get( cache->templates , key );
+  render_cache_unlock( cache );
+
+  if (subst_template == NULL) {
+    subst_template_type * new_template = subst_template_alloc( content , subst_list1 , subst_list2 );
+
+    render_cache_lock( cache );
+    if (hash_has_key( cache->templates , key ))
+      subst_template_free( new_template );   /* Another thread compiled it in the meantime. */
+    else
+      hash_insert_hash_owned_ref( cache->templates , key , new_template , subst_template_free__ );
+    subst_template = hash_get( cache->templates , key );
+    render_cache_unlock( cache );
+  }
+
+  free( key );
+  free( signature );
+  return subst_template;
+}
+
+
+static bool render_output_match( const render_output_type * output , const struct stat * stat_buffer ) {
+  return ((output->device == stat_buffer->st_dev)   &&
+          (output->inode  == stat_buffer->st_ino)   &&
+          (output->size   == stat_buffer->st_size)  &&
+          (output->mtime  == stat_buffer->st_mtime));
+}
+
+
+static bool render_cache_copy_fd( int src_fd , int target_fd ) {
+#ifdef FICLONE
+  if (ioctl( target_fd , FICLONE , src_fd ) == 0)
+    return true;
+#endif
+  {
+    char * buffer = util_malloc( RENDER_CACHE_BLOCK_SIZE );
+    bool   OK     = true;
+    while (OK) {
+      ssize_t bytes_read = read( src_fd , buffer , RENDER_CACHE_BLOCK_SIZE );
+      if (bytes_read == 0)
+        break;
+
+      if (bytes_read < 0) {
+        if (errno != EINTR)
+          OK = false;
+      } else {
+        ssize_t offset = 0;
+        while (OK && (offset < bytes_read)) {
+          ssize_t bytes_written = write( target_fd , &buffer[offset] , bytes_read - offset );
+          if (bytes_written < 0) {
+            if (errno != EINTR)
+              OK = false;
+          } else
+            offset += bytes_written;
+        }
+      }
+    }
+    free( buffer );
+    return OK;
+  }
+}
+
+
+/*
+  Creates @target_file as a clone of the file described by
+  @output. Returns false - and leaves no target file behind - if
+  the source file has been removed or modified since it was added to
+  the cache, or if the clone fails for some other reason.
+*/
+
+static bool render_cache_clone( const render_cache_type * cache , const render_output_type * output , const char * target_file ) {
+  bool cloned = false;
+  int src_fd = open( output->filename , O_RDONLY );
+  if (src_fd >= 0) {
+    struct stat stat_buffer;
+    if ((fstat( src_fd , &stat_buffer ) == 0) && render_output_match( output , &stat_buffer )) {
+      {
+        char * path;
+        util_alloc_file_components( target_file , &path , NULL , NULL );
+        if (path != NULL) {
+          util_make_path( path );
+          free( path );
+        }
+      }
+      unlink( target_file );
+
+#ifdef HAVE_SYMLINK
+      if (cache->hardlink) {
+        if (link( output->filename , target_file ) == 0) {
+          struct stat target_stat;
+          if ((stat( target_file , &target_stat ) == 0) && render_output_match( output , &target_stat ))
+            cloned = true;
+          else
+            unlink( target_file );
+        }
+      }
+#endif
+
+      if (!cloned) {
+        int target_fd = open( target_file , O_WRONLY | O_CREAT | O_TRUNC , stat_buffer.st_mode & 0777 );
+        if (target_fd >= 0) {
+          cloned = render_cache_copy_fd( src_fd , target_fd );
+          if (close( target_fd ) != 0)
+            cloned = false;
+
+          if (!cloned)
+            unlink( target_file );
+        }
+      }
+    }
+    close( src_fd );
+  }
+  return cloned;
+}
+
+
+/**
+   If content with the key @key has already been rendered to a file,
+   and that file is still unmodified, @target_file is created as a
+   clone of it and the function returns true. Otherwise the function
+   returns false, and the caller must render the content and call
+   render_cache_add() when the file has been written. In hardlink mode
+   an existing @target_file is removed when the function returns
+   false, so that the new content is not written into an inode which
+   is shared with other files.
+*/
+
+bool render_cache_reuse( render_cache_type * cache , const char * key , const char * target_file ) {
+  bool reused = false;
+  render_output_type output;
+  bool has_output = false;
+
+  render_cache_lock( cache );
+  {
+    const render_output_type * cached_output = hash_safe_get( cache->outputs , key );
+    if (cached_output != NULL) {
+      output = *cached_output;
+      output.filename = util_alloc_string_copy( cached_output->filename );
+      has_output = true;
+    }
+  }
+  render_cache_unlock( cache );
+
+  if (has_output) {
+    if (util_file_exists( target_file ) && util_same_file( output.filename , target_file )) {
+      struct stat stat_buffer;
+      if (stat( target_file , &stat_buffer ) == 0)
+        reused = render_output_match( &output , &stat_buffer );
+    } else
+      reused = render_cache_clone( cache , &output , target_file );
+    free( output.filename );
+  }
+
+  if (!reused && cache->hardlink)
+    unlink( target_file );
+
+  render_cache_lock( cache );
+  if (reused)
+    cache->hits++;
+  else
+    cache->misses++;
+  render_cache_unlock( cache );
+
+  return reused;
+}
+
+
+/**
+   Registers that the content with key @key has been written to
+   @target_file; the file must be complete when this function is
+   called.
+*/
+
+void render_cache_add( render_cache_type * cache , const char * key , const char * target_file ) {
+  struct stat stat_buffer;
+  if (stat( target_file , &stat_buffer ) == 0) {
+    render_output_type * output = util_malloc( sizeof * output );
+    output->filename = util_alloc_abs_path( target_file );
+    output->device   = stat_buffer.st_dev;
+    output->inode    = stat_buffer.st_ino;
+    output->size     = stat_buffer.st_size;
+    output->mtime    = stat_buffer.st_mtime;
+
+    render_cache_lock( cache );
+    hash_insert_hash_owned_ref( cache->outputs , key , output , render_output_free__ );
+    render_cache_unlock( cache );
+  }
+}
+
+
+/**
+   Equivalent to subst_list_filter_file(), but the source is loaded
+   and compiled through the cache, and the filtered content is only
+   rendered once for every combination of values which is relevant
+   for the source. Observe that @src_file and @target_file can NOT be the
+   same file.
+*/
+
+void render_cache_filter_file( render_cache_type * cache , const subst_list_type * subst_list , const char * src_file , const char * target_file ) {
+  const char * content = render_cache_get_source( cache , src_file );
+  const subst_template_type * subst_template = render_cache_get_template( cache , src_file , content , subst_list , NULL );
+  char * filter_key    = subst_template_alloc_filter_key( subst_template , subst_list , NULL );
+  char * key           = NULL;
+
+  if (filter_key != NULL) {
+    key = util_alloc_sprintf( "FILTER:%s:%s" , src_file , filter_key );
+    free( filter_key );
+  }
+
+  if ((key == NULL) || !render_cache_reuse( cache , key , target_file )) {
+    buffer_type * buffer = buffer_alloc( strlen( content ) + 1 );
+    subst_template_render( subst_template , subst_list , NULL , buffer );
+    {
+      FILE * stream = util_mkdir_fopen( target_file , "w" );
+      buffer_stream_fwrite_n( buffer , 0 , -1 , stream );  /* -1: Do not write the trailing \0. */
+      fclose( stream );
+    }
+    buffer_free( buffer );
+
+    if (key != NULL)
+      render_cache_add( cache , key , target_file );
+  }
+  util_safe_free( key );
+}
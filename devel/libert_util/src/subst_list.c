@@ -534,6 +534,37 @@ static bool subst_list_eval_funcs__(const subst_list_type * subst_list , buffer_
 }
 
 
+/**
+   Evaluates the function calls in the buffer, without doing any of
+   the string substitutions; the buffer must contain a \0 terminated
+   string.
+*/
+
+bool subst_list_eval_funcs(const subst_list_type * subst_list , buffer_type * buffer) {
+  return subst_list_eval_funcs__( subst_list , buffer );
+}
+
+
+/**
+   Returns a list of the names of all the functions which can be
+   invoked through the subst_list, including the functions of the
+   parent(s).
+*/
+
+stringlist_type * subst_list_alloc_func_names( const subst_list_type * subst_list ) {
+  stringlist_type * func_names = stringlist_alloc_new();
+  const subst_list_type * current = subst_list;
+  while (current != NULL) {
+    for (int ifunc = 0; ifunc < vector_get_size( current->func_data ); ifunc++) {
+      const subst_list_func_type * subst_func = vector_iget_const( current->func_data , ifunc );
+      stringlist_append_copy( func_names , subst_func->name );
+    }
+    current = current->parent;
+  }
+  return func_names;
+}
+
+
 
 /**
    Should we evaluate the parent first (i.e. top down), or this
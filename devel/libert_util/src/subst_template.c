@@ -0,0 +1,670 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'subst_template.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <ert/util/util.h>
+#include <ert/util/buffer.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/subst_list.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/subst_template.h>
+
+/*
+  The subst_template is a compiled form of a text which should be
+  filtered through one or two subst_list instances - many times, with
+  different values. When the template is compiled the text is scanned
+  once for all the keys with an Aho-Corasick automaton, and split in
+  literal segments and references to the keys. When the template is
+  rendered the output is written in one linear pass, with the current
+  values of the subst_list(s), instead of doing one search-replace of
+  the whole text per key as subst_list_update_buffer() does.
+
+  The keys are identified by their position in the sequence of keys
+  found by first traversing the parent chain of @subst_list1 from the
+  top, and then the parent chain of @subst_list2; this is the order
+  the substitutions are performed by:
+
+     subst_list_update_buffer( subst_list1 , buffer );
+     subst_list_update_buffer( subst_list2 , buffer );
+
+  and the compiled template can only be rendered with subst_list
+  instances which have the same sequence of keys - the values can be
+  different. The result is the same as with the sequential
+  substitution:
+
+   1. When two key occurences overlap in the text the occurence of
+      the key which is substituted first is used.
+
+   2. The value of a key is filtered through the keys which are
+      substituted after it.
+
+  There is one difference; with the sequential substitution a key
+  can also be formed by a substituted value and the text which
+  surrounds it, that is not the case here.
+
+  If the text, or one of the substituted values, contains the name of
+  a subst function the function calls are evaluated with
+  subst_list_eval_funcs() after the string substitutions.
+*/
+
+#define SUBST_TEMPLATE_TYPE_ID 71006213
+#define ALPHABET_SIZE          256
+
+
+typedef struct {
+  int            size;
+  const char  ** keys;
+  const char  ** values;
+} key_sequence_type;
+
+
+typedef struct {
+  size_t   offset;
+  int      key_index;
+} placeholder_type;
+
+
+struct subst_template_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char              * content;
+  size_t              content_length;
+  stringlist_type   * keys;              /* All the keys, in substitution order. */
+  int               * key_length;
+  stringlist_type   * func_names;
+  bool                func_call;         /* Does the content contain the name of a function. */
+  int                 num_placeholders;
+  placeholder_type  * placeholders;      /* Sorted by offset; the text between them is literal. */
+};
+
+
+/*****************************************************************/
+
+static void key_sequence_append( key_sequence_type * sequence , const subst_list_type * subst_list ) {
+  const subst_list_type * parent = subst_list_get_parent( subst_list );
+  if (parent != NULL)
+    key_sequence_append( sequence , parent );
+  {
+    int size = subst_list_get_size( subst_list );
+    sequence->keys   = util_realloc( sequence->keys   , (sequence->size + size) * sizeof * sequence->keys );
+    sequence->values = util_realloc( sequence->values , (sequence->size + size) * sizeof * sequence->values );
+    for (int i = 0; i < size; i++) {
+      sequence->keys[ sequence->size + i ]   = subst_list_iget_key( subst_list , i );
+      sequence->values[ sequence->size + i ] = subst_list_iget_value( subst_list , i );
+    }
+    sequence->size += size;
+  }
+}
+
+
+static key_sequence_type * key_sequence_alloc( const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  key_sequence_type * sequence = util_malloc( sizeof * sequence );
+  sequence->size   = 0;
+  sequence->keys   = NULL;
+  sequence->values = NULL;
+  if (subst_list1 != NULL)
+    key_sequence_append( sequence , subst_list1 );
+  if (subst_list2 != NULL)
+    key_sequence_append( sequence , subst_list2 );
+  return sequence;
+}
+
+
+static void key_sequence_free( key_sequence_type * sequence ) {
+  util_safe_free( sequence->keys );
+  util_safe_free( sequence->values );
+  free( sequence );
+}
+
+
+static stringlist_type * subst_template_alloc_func_names( const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  stringlist_type * func_names = stringlist_alloc_new();
+  if (subst_list1 != NULL) {
+    stringlist_type * names = subst_list_alloc_func_names( subst_list1 );
+    stringlist_append_stringlist_copy( func_names , names );
+    stringlist_free( names );
+  }
+  if (subst_list2 != NULL) {
+    stringlist_type * names = subst_list_alloc_func_names( subst_list2 );
+    stringlist_append_stringlist_copy( func_names , names );
+    stringlist_free( names );
+  }
+  return func_names;
+}
+
+
+/*****************************************************************/
+/*
+  Aho-Corasick automaton; the goto function is completed to a full
+  transition table so the scan does one table lookup per input
+  character. Each state which terminates a pattern has the pattern
+  index in output[], and dict[] links to the next state along the
+  failure chain which also terminates a pattern.
+*/
+
+typedef struct {
+  int    num_states;
+  int    alloc_states;
+  int  * next;
+  int  * fail;
+  int  * output;
+  int  * dict;
+} automaton_type;
+
+
+static int automaton_add_state( automaton_type * automaton ) {
+  if (automaton->num_states == automaton->alloc_states) {
+    automaton->alloc_states = 2 * automaton->alloc_states;
+    automaton->next   = util_realloc( automaton->next   , automaton->alloc_states * ALPHABET_SIZE * sizeof * automaton->next );
+    automaton->fail   = util_realloc( automaton->fail   , automaton->alloc_states * sizeof * automaton->fail );
+    automaton->output = util_realloc( automaton->output , automaton->alloc_states * sizeof * automaton->output );
+    automaton->dict   = util_realloc( automaton->dict   , automaton->alloc_states * sizeof * automaton->dict );
+  }
+  {
+    int state = automaton->num_states;
+    for (int c = 0; c < ALPHABET_SIZE; c++)
+      automaton->next[ state * ALPHABET_SIZE + c ] = -1;
+    automaton->fail[ state ]   = 0;
+    automaton->output[ state ] = -1;
+    automaton->dict[ state ]   = -1;
+    automaton->num_states++;
+    return state;
+  }
+}
+
+
+/*
+  If the same pattern is added several times the first index is
+  kept; that is the key which is substituted first.
+*/
+
+static void automaton_add_pattern( automaton_type * automaton , const char * pattern , int pattern_index ) {
+  int state = 0;
+  for (const unsigned char * p = (const unsigned char *) pattern; *p; p++) {
+    int next = automaton->next[ state * ALPHABET_SIZE + *p ];
+    if (next < 0) {
+      next = automaton_add_state( automaton );
+      automaton->next[ state * ALPHABET_SIZE + *p ] = next;
+    }
+    state = next;
+  }
+  if ((state != 0) && (automaton->output[ state ] < 0))
+    automaton->output[ state ] = pattern_index;
+}
+
+
+static void automaton_complete( automaton_type * automaton ) {
+  int * queue = util_calloc( automaton->num_states , sizeof * queue );
+  int head = 0;
+  int tail = 0;
+
+  for (int c = 0; c < ALPHABET_SIZE; c++) {
+    int next = automaton->next[ c ];
+    if (next < 0)
+      automaton->next[ c ] = 0;
+    else {
+      automaton->fail[ next ] = 0;
+      queue[ tail++ ] = next;
+    }
+  }
+
+  /* Breadth first; the failure state is always completed before the state itself. */
+  while (head < tail) {
+    int state = queue[ head++ ];
+    int fail  = automaton->fail[ state ];
+
+    if (automaton->output[ fail ] >= 0)
+      automaton->dict[ state ] = fail;
+    else
+      automaton->dict[ state ] = automaton->dict[ fail ];
+
+    for (int c = 0; c < ALPHABET_SIZE; c++) {
+      int next = automaton->next[ state * ALPHABET_SIZE + c ];
+      if (next < 0)
+        automaton->next[ state * ALPHABET_SIZE + c ] = automaton->next[ fail * ALPHABET_SIZE + c ];
+      else {
+        automaton->fail[ next ] = automaton->next[ fail * ALPHABET_SIZE + c ];
+        queue[ tail++ ] = next;
+      }
+    }
+  }
+  free( queue );
+}
+
+
+static automaton_type * automaton_alloc( const stringlist_type * patterns ) {
+  automaton_type * automaton = util_malloc( sizeof * automaton );
+  automaton->num_states   = 0;
+  automaton->alloc_states = 64;
+  automaton->next   = util_calloc( automaton->alloc_states * ALPHABET_SIZE , sizeof * automaton->next );
+  automaton->fail   = util_calloc( automaton->alloc_states , sizeof * automaton->fail );
+  automaton->output = util_calloc( automaton->alloc_states , sizeof * automaton->output );
+  automaton->dict   = util_calloc( automaton->alloc_states , sizeof * automaton->dict );
+  automaton_add_state( automaton );
+
+  for (int i = 0; i < stringlist_get_size( patterns ); i++)
+    automaton_add_pattern( automaton , stringlist_iget( patterns , i ) , i );
+
+  automaton_complete( automaton );
+  return automaton;
+}
+
+
+static void automaton_free( automaton_type * automaton ) {
+  free( automaton->next );
+  free( automaton->fail );
+  free( automaton->output );
+  free( automaton->dict );
+  free( automaton );
+}
+
+
+/*****************************************************************/
+
+typedef struct {
+  size_t  offset;
+  int     length;
+  int     key_index;
+} match_type;
+
+
+static int match_cmp_offset( const void * arg1 , const void * arg2 ) {
+  const match_type * m1 = arg1;
+  const match_type * m2 = arg2;
+  if (m1->offset < m2->offset)
+    return -1;
+  else if (m1->offset > m2->offset)
+    return 1;
+  else
+    return m1->key_index - m2->key_index;
+}
+
+
+static int match_cmp_priority( const void * arg1 , const void * arg2 ) {
+  const match_type * m1 = arg1;
+  const match_type * m2 = arg2;
+  if (m1->key_index != m2->key_index)
+    return m1->key_index - m2->key_index;
+  else if (m1->offset < m2->offset)
+    return -1;
+  else if (m1->offset > m2->offset)
+    return 1;
+  else
+    return 0;
+}
+
+
+/*
+  Selects the matches which would be substituted by the sequential
+  substitution: the matches are accepted in substitution order, and a
+  match which overlaps an already accepted match is discarded. On
+  return the accepted matches are sorted by offset.
+*/
+
+static int subst_template_resolve_overlap( match_type * matches , int num_matches , size_t content_length ) {
+  bool overlap = false;
+
+  qsort( matches , num_matches , sizeof * matches , match_cmp_offset );
+  for (int i = 1; i < num_matches; i++) {
+    if (matches[i].offset < matches[i - 1].offset + matches[i - 1].length)
+      overlap = true;
+  }
+
+  if (overlap) {
+    bool * covered = util_calloc( content_length , sizeof * covered );
+    int    num_accepted = 0;
+    memset( covered , 0 , content_length * sizeof * covered );
+    qsort( matches , num_matches , sizeof * matches , match_cmp_priority );
+    for (int i = 0; i < num_matches; i++) {
+      bool free_range = true;
+      for (int j = 0; j < matches[i].length; j++)
+        if (covered[ matches[i].offset + j ])
+          free_range = false;
+
+      if (free_range) {
+        for (int j = 0; j < matches[i].length; j++)
+          covered[ matches[i].offset + j ] = true;
+        matches[ num_accepted++ ] = matches[i];
+      }
+    }
+    free( covered );
+    num_matches = num_accepted;
+    qsort( matches , num_matches , sizeof * matches , match_cmp_offset );
+  }
+  return num_matches;
+}
+
+
+UTIL_IS_INSTANCE_FUNCTION( subst_template , SUBST_TEMPLATE_TYPE_ID )
+static UTIL_SAFE_CAST_FUNCTION( subst_template , SUBST_TEMPLATE_TYPE_ID )
+
+
+/**
+   Compiles @content for substitution with @subst_list1 followed by
+   @subst_list2; either of the subst_list arguments can be NULL. The
+   content is copied.
+*/
+
+subst_template_type * subst_template_alloc( const char * content , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  subst_template_type * subst_template = util_malloc( sizeof * subst_template );
+  UTIL_TYPE_ID_INIT( subst_template , SUBST_TEMPLATE_TYPE_ID );
+  subst_template->content_length = strlen( content );
+  subst_template->content        = util_alloc_string_copy( content );
+  subst_template->keys           = stringlist_alloc_new();
+  subst_template->func_names     = subst_template_alloc_func_names( subst_list1 , subst_list2 );
+  subst_template->func_call      = false;
+  {
+    key_sequence_type * sequence = key_sequence_alloc( subst_list1 , subst_list2 );
+    subst_template->key_length = util_calloc( sequence->size , sizeof * subst_template->key_length );
+    for (int i = 0; i < sequence->size; i++) {
+      stringlist_append_copy( subst_template->keys , sequence->keys[i] );
+      subst_template->key_length[i] = strlen( sequence->keys[i] );
+    }
+    key_sequence_free( sequence );
+  }
+
+  {
+    int num_keys = stringlist_get_size( subst_template->keys );
+    stringlist_type * patterns = stringlist_alloc_new();
+    automaton_type  * automaton;
+    int               num_matches   = 0;
+    int               alloc_matches = 16;
+    match_type      * matches = util_calloc( alloc_matches , sizeof * matches );
+
+    /* The function names are added as patterns num_keys, num_keys + 1, ... */
+    stringlist_append_stringlist_ref( patterns , subst_template->keys );
+    stringlist_append_stringlist_ref( patterns , subst_template->func_names );
+    automaton = automaton_alloc( patterns );
+
+    {
+      const unsigned char * text = (const unsigned char *) subst_template->content;
+      int state = 0;
+      for (size_t offset = 0; offset < subst_template->content_length; offset++) {
+        state = automaton->next[ state * ALPHABET_SIZE + text[offset] ];
+        {
+          int match_state = (automaton->output[ state ] >= 0) ? state : automaton->dict[ state ];
+          while (match_state >= 0) {
+            int pattern_index = automaton->output[ match_state ];
+            if (pattern_index < num_keys) {
+              if (num_matches == alloc_matches) {
+                alloc_matches *= 2;
+                matches = util_realloc( matches , alloc_matches * sizeof * matches );
+              }
+              matches[ num_matches ].length    = subst_template->key_length[ pattern_index ];
+              matches[ num_matches ].offset    = offset + 1 - matches[ num_matches ].length;
+              matches[ num_matches ].key_index = pattern_index;
+              num_matches++;
+            } else
+              subst_template->func_call = true;
+            match_state = automaton->dict[ match_state ];
+          }
+        }
+      }
+    }
+    num_matches = subst_template_resolve_overlap( matches , num_matches , subst_template->content_length );
+
+    subst_template->num_placeholders = num_matches;
+    subst_template->placeholders = util_calloc( num_matches , sizeof * subst_template->placeholders );
+    for (int i = 0; i < num_matches; i++) {
+      subst_template->placeholders[i].offset    = matches[i].offset;
+      subst_template->placeholders[i].key_index = matches[i].key_index;
+    }
+
+    free( matches );
+    automaton_free( automaton );
+    stringlist_free( patterns );
+  }
+  return subst_template;
+}
+
+
+void subst_template_free( subst_template_type * subst_template ) {
+  free( subst_template->content );
+  free( subst_template->key_length );
+  free( subst_template->placeholders );
+  stringlist_free( subst_template->keys );
+  stringlist_free( subst_template->func_names );
+  free( subst_template );
+}
+
+
+void subst_template_free__( void * arg ) {
+  subst_template_free( subst_template_safe_cast( arg ));
+}
+
+
+int subst_template_get_num_placeholders( const subst_template_type * subst_template ) {
+  return subst_template->num_placeholders;
+}
+
+
+/**
+   Checks whether the template has been compiled for the same
+   sequence of keys as found in @subst_list1 and @subst_list2.
+*/
+
+bool subst_template_has_keys( const subst_template_type * subst_template , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  bool equal = true;
+  key_sequence_type * sequence = key_sequence_alloc( subst_list1 , subst_list2 );
+  if (sequence->size != stringlist_get_size( subst_template->keys ))
+    equal = false;
+  else {
+    for (int i = 0; i < sequence->size; i++) {
+      if (strcmp( sequence->keys[i] , stringlist_iget( subst_template->keys , i )) != 0) {
+        equal = false;
+        break;
+      }
+    }
+  }
+  key_sequence_free( sequence );
+
+  if (equal) {
+    stringlist_type * func_names = subst_template_alloc_func_names( subst_list1 , subst_list2 );
+    equal = stringlist_equal( func_names , subst_template->func_names );
+    stringlist_free( func_names );
+  }
+  return equal;
+}
+
+
+/**
+   Creates a string of all the keys in @subst_list1 and @subst_list2,
+   which can be used to look up a template compiled for these
+   subst_list instances.
+*/
+
+char * subst_template_alloc_key_signature( const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  key_sequence_type * sequence = key_sequence_alloc( subst_list1 , subst_list2 );
+  stringlist_type * func_names = subst_template_alloc_func_names( subst_list1 , subst_list2 );
+  buffer_type * buffer = buffer_alloc( 256 );
+  char * signature;
+
+  for (int i = 0; i < sequence->size; i++) {
+    char * item = util_alloc_sprintf( "%zd:%s" , strlen( sequence->keys[i] ) , sequence->keys[i] );
+    buffer_fwrite( buffer , item , 1 , strlen( item ));
+    free( item );
+  }
+  for (int i = 0; i < stringlist_get_size( func_names ); i++) {
+    char * item = util_alloc_sprintf( "()%zd:%s" , strlen( stringlist_iget( func_names , i )) , stringlist_iget( func_names , i ));
+    buffer_fwrite( buffer , item , 1 , strlen( item ));
+    free( item );
+  }
+  buffer_fwrite_char( buffer , '\0' );
+  signature = buffer_get_data( buffer );
+  buffer_free_container( buffer );
+  stringlist_free( func_names );
+  key_sequence_free( sequence );
+  return signature;
+}
+
+
+static key_sequence_type * subst_template_alloc_sequence( const subst_template_type * subst_template , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  key_sequence_type * sequence = key_sequence_alloc( subst_list1 , subst_list2 );
+  if (sequence->size != stringlist_get_size( subst_template->keys ))
+    util_abort("%s: the subst_list instances do not have the keys the template was compiled for \n",__func__);
+  return sequence;
+}
+
+
+/*
+  The value of key @key_index, filtered through all the keys which
+  are substituted after it.
+*/
+
+static char * subst_template_alloc_value( const key_sequence_type * sequence , int key_index ) {
+  char * value = util_alloc_string_copy( sequence->values[ key_index ] );
+  if (value == NULL)
+    value = util_alloc_string_copy( "" );
+
+  for (int i = key_index + 1; i < sequence->size; i++) {
+    if (strstr( value , sequence->keys[i] ) != NULL) {
+      const char * new_value = sequence->values[i] ? sequence->values[i] : "";
+      util_string_replace_inplace( &value , sequence->keys[i] , new_value );
+    }
+  }
+  return value;
+}
+
+
+static bool subst_template_contains_func( const subst_template_type * subst_template , const char * string ) {
+  for (int i = 0; i < stringlist_get_size( subst_template->func_names ); i++)
+    if (strstr( string , stringlist_iget( subst_template->func_names , i )) != NULL)
+      return true;
+  return false;
+}
+
+
+/**
+   Renders the template with the values currently in @subst_list1 and
+   @subst_list2 to the current position of @buffer; a terminating \0
+   is written. The subst_list instances must have the same keys as
+   the template was compiled with.
+*/
+
+void subst_template_render( const subst_template_type * subst_template , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 , buffer_type * buffer ) {
+  key_sequence_type * sequence = subst_template_alloc_sequence( subst_template , subst_list1 , subst_list2 );
+  char ** values = util_calloc( sequence->size , sizeof * values );
+  bool func_call = subst_template->func_call;
+  size_t start = buffer_get_offset( buffer );
+
+  for (int i = 0; i < sequence->size; i++)
+    values[i] = NULL;
+
+  {
+    size_t offset = 0;
+    for (int i = 0; i < subst_template->num_placeholders; i++) {
+      const placeholder_type * placeholder = &subst_template->placeholders[i];
+      int key_index = placeholder->key_index;
+
+      if (values[ key_index ] == NULL) {
+        values[ key_index ] = subst_template_alloc_value( sequence , key_index );
+        if (subst_template_contains_func( subst_template , values[ key_index ] ))
+          func_call = true;
+      }
+
+      buffer_fwrite( buffer , &subst_template->content[ offset ] , 1 , placeholder->offset - offset );
+      buffer_fwrite( buffer , values[ key_index ] , 1 , strlen( values[ key_index ] ));
+      offset = placeholder->offset + subst_template->key_length[ key_index ];
+    }
+    buffer_fwrite( buffer , &subst_template->content[ offset ] , 1 , subst_template->content_length - offset + 1);   /* Including the trailing \0 */
+  }
+
+  if (func_call) {
+    /* The function evaluation works on the complete buffer content. */
+    buffer_type * func_buffer = buffer_alloc( buffer_get_offset( buffer ) - start );
+    buffer_fwrite( func_buffer , &((char *) buffer_get_data( buffer ))[ start ] , 1 , buffer_get_offset( buffer ) - start );
+    if (subst_list1 != NULL) subst_list_eval_funcs( subst_list1 , func_buffer );
+    if (subst_list2 != NULL) subst_list_eval_funcs( subst_list2 , func_buffer );
+    {
+      char * data = buffer_get_data( func_buffer );
+      buffer_fseek( buffer , start , SEEK_SET );
+      buffer_fwrite( buffer , data , 1 , strlen( data ) + 1 );
+    }
+    buffer_free( func_buffer );
+  }
+
+  for (int i = 0; i < sequence->size; i++)
+    util_safe_free( values[i] );
+  free( values );
+  key_sequence_free( sequence );
+}
+
+
+char * subst_template_alloc_string( const subst_template_type * subst_template , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  buffer_type * buffer = buffer_alloc( subst_template->content_length + 1 );
+  char * string;
+  subst_template_render( subst_template , subst_list1 , subst_list2 , buffer );
+  string = buffer_get_data( buffer );
+  buffer_free_container( buffer );
+  return string;
+}
+
+
+/**
+   Creates a string which identifies the output of
+   subst_template_render() with the values in @subst_list1 and
+   @subst_list2; the key contains the values of the keys found in the
+   template, and of the keys found in those values. Returns NULL if
+   the output can contain function calls, i.e. it is not a pure
+   function of the values.
+*/
+
+char * subst_template_alloc_filter_key( const subst_template_type * subst_template , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  key_sequence_type * sequence = subst_template_alloc_sequence( subst_template , subst_list1 , subst_list2 );
+  bool * included = util_calloc( sequence->size , sizeof * included );
+  bool   pure     = !subst_template->func_call;
+  char * filter_key = NULL;
+
+  for (int i = 0; i < sequence->size; i++)
+    included[i] = false;
+  for (int i = 0; i < subst_template->num_placeholders; i++)
+    included[ subst_template->placeholders[i].key_index ] = true;
+
+  /* The values can contain keys which are substituted later. */
+  for (int i = 0; i < sequence->size; i++) {
+    if (included[i] && (sequence->values[i] != NULL)) {
+      for (int j = i + 1; j < sequence->size; j++)
+        if (strstr( sequence->values[i] , sequence->keys[j] ) != NULL)
+          included[j] = true;
+
+      if (subst_template_contains_func( subst_template , sequence->values[i] ))
+        pure = false;
+    }
+  }
+
+  if (pure) {
+    buffer_type * buffer = buffer_alloc( 256 );
+    for (int i = 0; i < sequence->size; i++) {
+      if (included[i]) {
+        const char * value = sequence->values[i] ? sequence->values[i] : "";
+        char * item = util_alloc_sprintf( "%d:%zd:%s" , i , strlen( value ) , value );
+        buffer_fwrite( buffer , item , 1 , strlen( item ));
+        free( item );
+      }
+    }
+    buffer_fwrite_char( buffer , '\0' );
+    filter_key = buffer_get_data( buffer );
+    buffer_free_container( buffer );
+  }
+
+  free( included );
+  key_sequence_free( sequence );
+  return filter_key;
+}
@@ -36,6 +36,8 @@
 #include <ert/util/subst_list.h>
 #include <ert/util/subst_func.h>
 #include <ert/util/template.h>
+#include <ert/util/render_cache.h>
+#include <ert/util/subst_template.h>
 #include <ert/util/stringlist.h>
 
 
@@ -179,54 +181,174 @@ void template_free( template_type * template ) {
    
 
 
-void template_instantiate( const template_type * template , const char * __target_file , const subst_list_type * arg_list , bool override_symlink) {
+static char * template_alloc_target_file( const template_type * template , const char * __target_file , const subst_list_type * arg_list) {
   char * target_file = util_alloc_string_copy( __target_file );
-
-  /* Finding the name of the target file. */
   subst_list_update_string( template->arg_list , &target_file);
   if (arg_list != NULL) subst_list_update_string( arg_list , &target_file );
+  return target_file;
+}
+
+
+/*
+  Performs the substitutions - and loop expansion - on the template
+  content and returns the rendered content. The substitutions are
+  done in one pass with the compiled template @subst_template; the
+  internal arg_list is substituted before @arg_list.
+*/
+
+static char * template_render( const template_type * template , const subst_template_type * subst_template , const subst_list_type * arg_list) {
+  char * char_buffer = subst_template_alloc_string( subst_template , template->arg_list , arg_list );
+    
+#ifdef HAVE_REGEXP
+  {
+    buffer_type * buffer = buffer_alloc_private_wrapper( char_buffer , strlen( char_buffer ) + 1);
+    template_eval_loops( template , buffer );
+    char_buffer = buffer_get_data( buffer );
+    buffer_free_container( buffer );
+  }
+#endif
+  return char_buffer;
+}
+
 
+static void template_fwrite( const char * target_file , const char * char_buffer , bool override_symlink) {
+  /* 
+     Check if target file already exists as a symlink, 
+     and remove it if override_symlink is true. 
+  */
+  if (override_symlink) {
+    if (util_is_link( target_file ))
+      remove( target_file );
+  }
+    
+  /* Write the content out. */
   {
-    char * char_buffer;
+    FILE * stream = util_mkdir_fopen( target_file , "w");
+    fprintf(stream , "%s" , char_buffer);
+    fclose( stream );
+  }
+}
+
+
+/**
+   This function will create the file @__target_file based on the
+   template instance. Before the target file is written all the
+   internal substitutions and then subsequently the subsititutions in
+   @arg_list will be performed. The input @arg_list can be NULL - in
+   which case this is more like copy operation.
+
+   Observe that:
+   
+    1. Substitutions will be performed on @__target_file
+
+    2. @__target_file can contain path components.
+
+    3. If internalize_template == false subsititions will be performed
+       on the filename of the file with template content.
+  
+    4. If the parameter @override_symlink is true the function will
+       have the following behaviour:
+
+         If the target_file already exists as a symbolic link, the
+         symbolic link will be removed prior to creating the instance,
+         ensuring that a remote file is not updated.
+
+*/
+   
+
+
+void template_instantiate( const template_type * template , const char * __target_file , const subst_list_type * arg_list , bool override_symlink) {
+  char * target_file = template_alloc_target_file( template , __target_file , arg_list );
+
+  {
+    char * content;
     /* Loading the template - possibly expanding keys in the filename */
     if (template->internalize_template)
-      char_buffer = util_alloc_string_copy( template->template_buffer);
+      content = util_alloc_string_copy( template->template_buffer);
     else
-      char_buffer = template_load( template , arg_list );
+      content = template_load( template , arg_list );
     
-    /* Substitutions on the content. */
-    subst_list_update_string( template->arg_list , &char_buffer );
-    if (arg_list != NULL) subst_list_update_string( arg_list , &char_buffer );
-
-    
-#ifdef HAVE_REGEXP
     {
-      buffer_type * buffer = buffer_alloc_private_wrapper( char_buffer , strlen( char_buffer ) + 1);
-      template_eval_loops( template , buffer );
-      char_buffer = buffer_get_data( buffer );
-      buffer_free_container( buffer );
+      subst_template_type * subst_template = subst_template_alloc( content , template->arg_list , arg_list );
+      char * char_buffer = template_render( template , subst_template , arg_list );
+      template_fwrite( target_file , char_buffer , override_symlink );
+      free( char_buffer );
+      subst_template_free( subst_template );
     }
-#endif
+    free( content );
+  }
+  
+  free( target_file );
+}
 
-    /* 
-       Check if target file already exists as a symlink, 
-       and remove it if override_symlink is true. 
-    */
-    if (override_symlink) {
-      if (util_is_link( target_file ))
-        remove( target_file );
-    }
+
+/*
+  Creates a key which identifies the instance created from the
+  template with the @arg_list substitutions; see
+  subst_template_alloc_filter_key(). Returns NULL if the instance can
+  not be cached.
+*/
+
+static char * template_alloc_instance_key( const template_type * template , const char * source_id , const subst_template_type * subst_template , const subst_list_type * arg_list) {
+  char * instance_key = NULL;
+  char * filter_key   = subst_template_alloc_filter_key( subst_template , template->arg_list , arg_list );
+
+  if (filter_key != NULL) {
+    instance_key = util_alloc_sprintf( "TEMPLATE:%s:%s" , source_id , filter_key );
+    free( filter_key );
+  }
+  return instance_key;
+}
+
+
+/**
+   Equivalent to template_instantiate(), but the template content is
+   loaded and compiled through the render cache @cache, and if the
+   same instance has already been created the existing file is cloned
+   instead of rendering it again; see render_cache.c. If @cache is NULL this is
+   the same as template_instantiate().
+*/
+
+void template_instantiate_cached( const template_type * template , const char * __target_file , const subst_list_type * arg_list , bool override_symlink , render_cache_type * cache) {
+  if (cache == NULL)
+    template_instantiate( template , __target_file , arg_list , override_symlink );
+  else {
+    char * target_file   = template_alloc_target_file( template , __target_file , arg_list );
+    char * source_id;
+    const char * content;
     
-    /* Write the content out. */
+    if (template->internalize_template) {
+      source_id = util_alloc_sprintf( "<%p>" , template );
+      content = template->template_buffer;
+    } else {
+      source_id = util_alloc_string_copy( template->template_file );
+      subst_list_update_string( template->arg_list , &source_id);
+      if (arg_list != NULL)
+        subst_list_update_string( arg_list , &source_id);
+      content = render_cache_get_source( cache , source_id );
+    }
+
     {
-      FILE * stream = util_mkdir_fopen( target_file , "w");
-      fprintf(stream , "%s" , char_buffer);
-      fclose( stream );
+      const subst_template_type * subst_template = render_cache_get_template( cache , source_id , content , template->arg_list , arg_list );
+      char * instance_key = NULL;
+      /* An existing symlink must be written through unless override_symlink is set. */
+      if (override_symlink || !util_is_link( target_file ))
+        instance_key = template_alloc_instance_key( template , source_id , subst_template , arg_list );
+      
+      if ((instance_key == NULL) || !render_cache_reuse( cache , instance_key , target_file )) {
+        char * char_buffer = template_render( template , subst_template , arg_list );
+        template_fwrite( target_file , char_buffer , override_symlink );
+        free( char_buffer );
+        
+        if (instance_key != NULL)
+          render_cache_add( cache , instance_key , target_file );
+      }
+      util_safe_free( instance_key );
     }
-    free( char_buffer );
+    
+    free( source_id );
+    free( target_file );
   }
-  
-  free( target_file );
 }
 
 
@@ -487,6 +487,7 @@ void * vector_pop_front(vector_type * vector ) {
       int bytes = (vector->size - 1) * sizeof * vector->data;  /* Move the storage one element to  the left (could als be implemented with an offset??). */
       memmove( vector->data , &vector->data[1] , bytes);
     }
+    vector->data[ vector->size - 1 ] = NULL;   /* Otherwise vector_iset__() frees the moved node on the next append. */
     vector->size--;                    /* Shrink the vector */
     return data;
   }
@@ -0,0 +1,179 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ert_util_elementwise.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/elementwise.h>
+
+#define SIZE 1037
+
+
+/*
+  Every kernel is compared with the plain loop it replaces. The size
+  is not a multiple of any vector length, so the loop tails are
+  covered as well.
+*/
+
+#define TEST_ELEMENTWISE( ctype )                                               \
+void test_ ## ctype( ) {                                                        \
+  ctype x[SIZE] , y[SIZE] , z[SIZE] , ref[SIZE];                                \
+  int i;                                                                        \
+                                                                                \
+  for (i=0; i < SIZE; i++) {                                                    \
+    x[i] = 0.5 + (i % 17);                                                      \
+    y[i] = 1.0 + 0.25 * (i % 11);                                               \
+  }                                                                             \
+                                                                                \
+  memcpy( z , y , sizeof z );                                                   \
+  elementwise_add_ ## ctype( z , x , SIZE );                                    \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( y[i] + x[i] , z[i] );      \
+                                                                                \
+  memcpy( z , y , sizeof z );                                                   \
+  elementwise_sub_ ## ctype( z , x , SIZE );                                    \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( y[i] - x[i] , z[i] );      \
+                                                                                \
+  memcpy( z , y , sizeof z );                                                   \
+  elementwise_mul_ ## ctype( z , x , SIZE );                                    \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( y[i] * x[i] , z[i] );      \
+                                                                                \
+  memcpy( z , y , sizeof z );                                                   \
+  elementwise_div_ ## ctype( z , x , SIZE );                                    \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( y[i] / x[i] , z[i] );      \
+                                                                                \
+  memcpy( z , y , sizeof z );                                                   \
+  elementwise_addsqr_ ## ctype( z , x , SIZE );                                 \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( y[i] + x[i]*x[i] , z[i] ); \
+                                                                                \
+  memcpy( z , y , sizeof z );                                                   \
+  elementwise_axpy_ ## ctype( z , 3 , x , SIZE );                               \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( y[i] + 3*x[i] , z[i] );    \
+                                                                                \
+  memcpy( z , y , sizeof z );                                                   \
+  elementwise_scale_ ## ctype( z , 3 , SIZE );                                  \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( 3*y[i] , z[i] );           \
+                                                                                \
+  memcpy( z , y , sizeof z );                                                   \
+  elementwise_shift_ ## ctype( z , 3 , SIZE );                                  \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( 3 + y[i] , z[i] );         \
+                                                                                \
+  memcpy( z , x , sizeof z );                                                   \
+  elementwise_clamp_ ## ctype( z , 2 , 10 , SIZE );                             \
+  for (i=0; i < SIZE; i++) {                                                    \
+    ref[i] = x[i];                                                              \
+    if (ref[i] < 2) ref[i] = 2;                                                 \
+    if (ref[i] > 10) ref[i] = 10;                                               \
+    test_assert_double_equal( ref[i] , z[i] );                                  \
+  }                                                                             \
+}
+
+TEST_ELEMENTWISE( float )
+TEST_ELEMENTWISE( double )
+#undef TEST_ELEMENTWISE
+
+
+#define TEST_ELEMENTWISE_MATH( ctype , SUFFIX )                                         \
+void test_math_ ## ctype( ) {                                                           \
+  ctype x[SIZE] , z[SIZE] , mean[SIZE] , std[SIZE];                                     \
+  int i;                                                                                \
+                                                                                        \
+  for (i=0; i < SIZE; i++)                                                              \
+    x[i] = 0.5 + 0.125 * (i % 23);                                                      \
+                                                                                        \
+  memcpy( z , x , sizeof z );                                                           \
+  elementwise_sqr_ ## ctype( z , SIZE );                                                \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( x[i] * x[i] , z[i] );              \
+                                                                                        \
+  memcpy( z , x , sizeof z );                                                           \
+  elementwise_sqrt_ ## ctype( z , SIZE );                                               \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( sqrt ## SUFFIX( x[i] ) , z[i] );   \
+                                                                                        \
+  memcpy( z , x , sizeof z );                                                           \
+  elementwise_log_ ## ctype( z , SIZE );                                                \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( log ## SUFFIX( x[i] ) , z[i] );    \
+                                                                                        \
+  memcpy( z , x , sizeof z );                                                           \
+  elementwise_log10_ ## ctype( z , SIZE );                                              \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( log10 ## SUFFIX( x[i] ) , z[i] );  \
+                                                                                        \
+  memcpy( z , x , sizeof z );                                                           \
+  elementwise_exp_ ## ctype( z , SIZE );                                                \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( exp ## SUFFIX( x[i] ) , z[i] );    \
+                                                                                        \
+  memcpy( z , x , sizeof z );                                                           \
+  elementwise_pow10_ ## ctype( z , SIZE );                                              \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( pow ## SUFFIX( 10 , x[i] ) , z[i] ); \
+                                                                                        \
+  memcpy( z , x , sizeof z );                                                           \
+  elementwise_pow_ ## ctype( z , 1.5 , SIZE );                                          \
+  for (i=0; i < SIZE; i++) test_assert_double_equal( pow ## SUFFIX( x[i] , 1.5 ) , z[i] ); \
+                                                                                        \
+  /* Ensemble of four members: x , 2x , 3x , 4x => mean 2.5x and std sqrt(1.25)x */     \
+  memset( mean , 0 , sizeof mean );                                                     \
+  memset( std , 0 , sizeof std );                                                       \
+  for (int iens = 1; iens <= 4; iens++) {                                               \
+    memcpy( z , x , sizeof z );                                                         \
+    elementwise_scale_ ## ctype( z , iens , SIZE );                                     \
+    elementwise_moments_ ## ctype( mean , std , z , 0.25 , SIZE );                      \
+  }                                                                                     \
+  elementwise_std_ ## ctype( std , mean , SIZE );                                       \
+  for (i=0; i < SIZE; i++) {                                                            \
+    test_assert_double_equal( 2.5 * x[i] , mean[i] );                                   \
+    test_assert_double_equal( sqrt( 1.25 ) * x[i] , std[i] );                           \
+  }                                                                                     \
+}
+
+TEST_ELEMENTWISE_MATH( float , f )
+TEST_ELEMENTWISE_MATH( double , )
+#undef TEST_ELEMENTWISE_MATH
+
+
+void test_int( ) {
+  int x[SIZE] , z[SIZE];
+  int i;
+  for (i=0; i < SIZE; i++) {
+    x[i] = i - 500;
+    z[i] = 2*i;
+  }
+  elementwise_axpy_int( z , -2 , x , SIZE );
+  elementwise_clamp_int( z , 0 , 1000 , SIZE );
+  for (i=0; i < SIZE; i++)
+    test_assert_int_equal( 1000 , z[i] );
+}
+
+
+void test_clamp_nan( ) {
+  double x[3] = { -1 , NAN , 5 };
+  elementwise_clamp_double( x , 0 , 1 , 3 );
+  test_assert_double_equal( 0 , x[0] );
+  test_assert_true( isnan( x[1] ));
+  test_assert_double_equal( 1 , x[2] );
+}
+
+
+int main( int argc , char ** argv) {
+  test_float();
+  test_double();
+  test_math_float();
+  test_math_double();
+  test_int();
+  test_clamp_nan();
+  exit(0);
+}
@@ -0,0 +1,156 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ert_util_fmatrix.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/util/matrix.h>
+#include <ert/util/fmatrix.h>
+
+#define ROWS      1000
+#define ENS_SIZE  50
+
+
+/*
+  An X matrix similar to the one from the EnKF analysis: the identity
+  plus a random perturbation.
+*/
+
+static matrix_type * alloc_X( rng_type * rng ) {
+  matrix_type * X = matrix_alloc( ENS_SIZE , ENS_SIZE );
+  matrix_random_init( X , rng );
+  matrix_shift( X , -0.5 );
+  matrix_scale( X , 0.2 );
+  for (int i = 0; i < ENS_SIZE; i++)
+    matrix_iadd( X , i , i , 1.0 );
+  return X;
+}
+
+
+static matrix_type * alloc_A( rng_type * rng ) {
+  matrix_type * A = matrix_alloc( ROWS , ENS_SIZE );
+  matrix_random_init( A , rng );
+  matrix_scale( A , 1000 );
+  return A;
+}
+
+
+static void test_convert( const matrix_type * A ) {
+  fmatrix_type * fA = fmatrix_alloc_from_matrix( A );
+  matrix_type * B   = matrix_alloc( ROWS , ENS_SIZE );
+
+  test_assert_true( fmatrix_is_instance( fA ));
+  test_assert_int_equal( ROWS , fmatrix_get_rows( fA ));
+  test_assert_int_equal( ENS_SIZE , fmatrix_get_columns( fA ));
+  test_assert_int_equal( ROWS * ENS_SIZE * sizeof(float) , fmatrix_get_byte_size( fA ));
+
+  fmatrix_export( fA , B );
+  for (int i = 0; i < ROWS; i++)
+    for (int j = 0; j < ENS_SIZE; j++) {
+      test_assert_true( fabs( matrix_iget( A , i , j ) - matrix_iget( B , i , j )) <= 1e-7 * fabs( matrix_iget( A , i , j )));
+      test_assert_true( fmatrix_iget( fA , i , j ) == (float) matrix_iget( B , i , j ));
+    }
+
+  matrix_free( B );
+  fmatrix_free( fA );
+}
+
+
+/*
+  The mixed precision product should differ from the double product
+  only by the float rounding of the input and output: for each
+  element |diff| <= C * eps_float * sum_k |A_ik| |X_kj|.
+*/
+
+static void test_matmul( const matrix_type * A , const matrix_type * X ) {
+  const double eps_float = 1.0 / (1 << 23);
+  matrix_type * dA  = matrix_alloc_copy( A );
+  fmatrix_type * fA = fmatrix_alloc_from_matrix( A );
+  fmatrix_type * fA_mt = fmatrix_alloc_from_matrix( A );
+  double max_rel_diff = 0;
+
+  matrix_inplace_matmul( dA , X );
+  fmatrix_inplace_matmul( fA , X );
+  fmatrix_inplace_matmul_mt1( fA_mt , X , 3 );
+
+  for (int i = 0; i < ROWS; i++) {
+    for (int j = 0; j < ENS_SIZE; j++) {
+      double bound = 0;
+      double diff  = fabs( fmatrix_iget( fA , i , j ) - matrix_iget( dA , i , j ));
+
+      for (int k = 0; k < ENS_SIZE; k++)
+        bound += fabs( matrix_iget( A , i , k ) * matrix_iget( X , k , j ));
+      bound *= 2 * eps_float;
+
+      test_assert_true( diff <= bound );
+      test_assert_true( fmatrix_iget( fA , i , j ) == fmatrix_iget( fA_mt , i , j ));
+      max_rel_diff = util_double_max( max_rel_diff , diff / bound );
+    }
+  }
+  test_assert_true( max_rel_diff > 0 );
+
+  fmatrix_free( fA_mt );
+  fmatrix_free( fA );
+  matrix_free( dA );
+}
+
+
+static void test_fwrite_fread( const matrix_type * A ) {
+  test_work_area_type * work_area = test_work_area_alloc( "fmatrix" , false );
+  fmatrix_type * fA = fmatrix_alloc_from_matrix( A );
+  {
+    FILE * stream = util_fopen( "fmatrix" , "w" );
+    fmatrix_fwrite( fA , stream );
+    fclose( stream );
+  }
+  test_assert_int_equal( 2 * sizeof(int) + fmatrix_get_byte_size( fA ) , util_file_size( "fmatrix" ));
+  {
+    FILE * stream = util_fopen( "fmatrix" , "r" );
+    fmatrix_type * copy = fmatrix_fread_alloc( stream );
+    fclose( stream );
+
+    test_assert_int_equal( ROWS , fmatrix_get_rows( copy ));
+    test_assert_int_equal( ENS_SIZE , fmatrix_get_columns( copy ));
+    for (int i = 0; i < ROWS; i++)
+      for (int j = 0; j < ENS_SIZE; j++)
+        test_assert_true( fmatrix_iget( fA , i , j ) == fmatrix_iget( copy , i , j ));
+    fmatrix_free( copy );
+  }
+  fmatrix_free( fA );
+  test_work_area_free( work_area );
+}
+
+
+int main(int argc , char ** argv) {
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+  matrix_type * A = alloc_A( rng );
+  matrix_type * X = alloc_X( rng );
+
+  test_convert( A );
+  test_matmul( A , X );
+  test_fwrite_fread( A );
+
+  matrix_free( X );
+  matrix_free( A );
+  rng_free( rng );
+  exit(0);
+}
@@ -0,0 +1,127 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ert_util_parser.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/parser.h>
+
+
+/*
+  Tokenizes @buffer both through the stringlist adapter and the
+  token_stream, and checks the tokens against the @num_tokens expected
+  tokens.
+*/
+
+void test_tokens( const parser_type * parser , const char * buffer , bool strip_quote_marks , int num_tokens , const char ** expected) {
+  stringlist_type * tokens   = parser_tokenize_buffer( parser , buffer , strip_quote_marks );
+  token_stream_type * stream = parser_alloc_token_stream( parser , buffer , strip_quote_marks );
+  stringlist_type * ref_list = token_stream_alloc_stringlist_ref( stream );
+
+  test_assert_int_equal( num_tokens , stringlist_get_size( tokens ));
+  test_assert_int_equal( num_tokens , token_stream_get_size( stream ));
+  test_assert_int_equal( num_tokens , stringlist_get_size( ref_list ));
+  for (int i = 0; i < num_tokens; i++) {
+    test_assert_string_equal( expected[i] , stringlist_iget( tokens , i ));
+    test_assert_string_equal( expected[i] , stringlist_iget( ref_list , i ));
+    test_assert_true( token_stream_iequal( stream , i , expected[i] ));
+    test_assert_true( token_stream_iget_ptr( stream , i ) == &buffer[ token_stream_iget_offset( stream , i ) ]);
+  }
+
+  stringlist_free( ref_list );
+  token_stream_free( stream );
+  stringlist_free( tokens );
+}
+
+
+void test_documented( ) {
+  parser_type * parser = parser_alloc( " " , "'" , "=" , NULL , "##" , "##" );
+
+  test_tokens( parser , "I like     beer  " , true , 3 , (const char *[3]) {"I" , "like" , "beer"});
+  test_tokens( parser , "I ## really  ## like beer" , true , 3 , (const char *[3]) {"I" , "like" , "beer"});
+  test_tokens( parser , "key=value" , true , 3 , (const char *[3]) {"key" , "=" , "value"});
+  test_tokens( parser , "my_file = 'my documents with space in.txt'" , false , 3 , (const char *[3]) {"my_file" , "=" , "'my documents with space in.txt'"});
+  test_tokens( parser , "my_file = 'my documents with space in.txt'" , true , 3 , (const char *[3]) {"my_file" , "=" , "my documents with space in.txt"});
+  test_tokens( parser , "my_file = 'my \\'doc.txt'" , true , 3 , (const char *[3]) {"my_file" , "=" , "my 'doc.txt"});
+  test_tokens( parser , "my_file = 'my \\'doc.txt'" , false , 3 , (const char *[3]) {"my_file" , "=" , "'my \\'doc.txt'"});
+  test_tokens( parser , "'' a ## unterminated comment" , true , 2 , (const char *[2]) {"" , "a"});
+  parser_free( parser );
+}
+
+
+void test_schedule( ) {
+  parser_type * parser = parser_alloc( " \t" , "\'\"" , "\n" , "\r" , "--" , "\n" );
+  const char * buffer = "WCONHIST\r\n  'OP 1'  OPEN  ORAT  1000.0 / -- Comment\n/\n\nDA\rTES\n 1 'JAN' 2010 /\n--";
+
+  test_tokens( parser , buffer , false , 17 , (const char *[17]) {"WCONHIST" , "\n" ,
+                                                                  "'OP 1'" , "OPEN" , "ORAT" , "1000.0" , "/" ,
+                                                                  "/" , "\n" , "\n" ,
+                                                                  "DATES" , "\n" ,
+                                                                  "1" , "'JAN'" , "2010" , "/" , "\n"});
+  {
+    token_stream_type * stream = parser_alloc_token_stream( parser , buffer , false );
+    /* The raw token text includes the deleted '\r' characters. */
+    test_assert_int_equal( 9 , token_stream_iget_length( stream , 0 ));
+    test_assert_int_equal( 6 , token_stream_iget_length( stream , 10 ));
+    test_assert_true( token_stream_iequal( stream , 10 , "DATES" ));
+    test_assert_false( token_stream_iequal( stream , 0 , "WCONHIS" ));
+    test_assert_false( token_stream_iequal( stream , 0 , "WCONHISTX" ));
+    token_stream_free( stream );
+  }
+  parser_free( parser );
+}
+
+
+void test_file( ) {
+  test_work_area_type * work_area = test_work_area_alloc( "parser" , false );
+  parser_type * parser = parser_alloc( " \t\r\n" , "\"\'" , NULL , NULL , "--" , "\n" );
+  {
+    FILE * stream = util_fopen( "input.txt" , "w" );
+    fprintf(stream , "KEY1  \"value with space\"\n-- Comment\nKEY2 value2\n");
+    fclose( stream );
+  }
+  {
+    token_stream_type * stream = parser_alloc_token_stream_file( parser , "input.txt" , true );
+    stringlist_type * tokens   = parser_tokenize_file( parser , "input.txt" , true );
+    test_assert_int_equal( 4 , token_stream_get_size( stream ));
+    test_assert_int_equal( 4 , stringlist_get_size( tokens ));
+    for (int i = 0; i < 4; i++) {
+      char * token = token_stream_alloc_token( stream , i );
+      test_assert_string_equal( stringlist_iget( tokens , i ) , token );
+      free( token );
+    }
+    test_assert_string_equal( "value with space" , stringlist_iget( tokens , 1 ));
+    stringlist_free( tokens );
+    token_stream_free( stream );
+  }
+  parser_free( parser );
+  test_work_area_free( work_area );
+}
+
+
+int main(int argc , char ** argv) {
+  test_documented( );
+  test_schedule( );
+  test_file( );
+  exit(0);
+}
@@ -0,0 +1,185 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ert_util_path_service.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/path_service.h>
+
+
+void write_file( const char * filename , const char * content ) {
+  FILE * stream = util_fopen( filename , "w");
+  fprintf(stream , "%s" , content );
+  fclose( stream );
+}
+
+
+int count_entries( const char * path ) {
+  int count = 0;
+  DIR * dirH = opendir( path );
+  struct dirent * dentry;
+  while ((dentry = readdir( dirH )) != NULL) {
+    if ((strcmp( dentry->d_name , "." ) != 0) && (strcmp( dentry->d_name , ".." ) != 0))
+      count++;
+  }
+  closedir( dirH );
+  return count;
+}
+
+
+void populate( const char * path ) {
+  char * sub_path = util_alloc_filename( path , "sub/subsub" , NULL );
+  char * file1    = util_alloc_filename( path , "ECLIPSE.DATA" , NULL );
+  char * file2    = util_alloc_filename( sub_path , "ECLIPSE.UNRST" , NULL );
+  char * link     = util_alloc_filename( path , "link" , NULL );
+  char * fifo     = util_alloc_filename( sub_path , "fifo" , NULL );
+
+  util_make_path( sub_path );
+  write_file( file1 , "DATA" );
+  write_file( file2 , "UNRST" );
+  symlink( file1 , link );
+  test_assert_int_equal( 0 , mkfifo( fifo , S_IRUSR | S_IWUSR ));
+
+  free( fifo );
+  free( link );
+  free( file2 );
+  free( file1 );
+  free( sub_path );
+}
+
+
+void test_clear( path_service_type * service ) {
+  const int ens_size = 20;
+
+  for (int iens = 0; iens < ens_size; iens++) {
+    char * path = util_alloc_sprintf( "simulations/case/realization-%d" , iens );
+    populate( path );
+    path_service_clear_directory( service , path , false , false );
+
+    test_assert_true( util_is_directory( path ));
+    test_assert_int_equal( 0 , count_entries( path ));
+    free( path );
+  }
+
+  path_service_join( service );
+  test_assert_int_equal( 0 , path_service_get_pending( service ));
+  test_assert_int_equal( ens_size , count_entries( "simulations/case" ));   /* The trash directories are gone. */
+}
+
+
+void test_clear_missing( path_service_type * service ) {
+  path_service_clear_directory( service , "does/not/exist" , true , false );
+  test_assert_false( util_entry_exists( "does/not/exist" ));
+  path_service_clear_directory( service , "simulations/case/realization-0/" , false , false );
+  test_assert_true( util_is_directory( "simulations/case/realization-0" ));
+}
+
+
+/*
+  With strict_uid a file owned by another user is moved back to the
+  cleared directory by the worker, and no trash directory is left
+  behind. Files can only be given away when running as root.
+*/
+
+void test_clear_foreign( path_service_type * service ) {
+  if (getuid() == 0) {
+    populate( "foreign/case/realization-0" );
+    write_file( "foreign/case/realization-0/sub/FOREIGN" , "Other user" );
+    test_assert_int_equal( 0 , chown( "foreign/case/realization-0/sub/FOREIGN" , 1 , 1 ));
+
+    path_service_clear_directory( service , "foreign/case/realization-0" , true , false );
+    path_service_join( service );
+    test_assert_int_equal( 1 , count_entries( "foreign/case" ));
+    test_assert_true( util_file_exists( "foreign/case/realization-0/sub/FOREIGN" ));
+    test_assert_false( util_entry_exists( "foreign/case/realization-0/ECLIPSE.DATA" ));
+
+    path_service_clear_directory( service , "foreign/case/realization-0" , false , false );
+    path_service_join( service );
+    test_assert_int_equal( 1 , count_entries( "foreign/case" ));
+    test_assert_int_equal( 0 , count_entries( "foreign/case/realization-0" ));
+  }
+}
+
+
+/*
+  Trash directories left by a process which is no longer running are
+  deleted when a directory next to them is cleared; the trash of this
+  process is left alone.
+*/
+
+void test_reap( path_service_type * service ) {
+  pid_t dead_pid = fork();
+  if (dead_pid == 0)
+    _exit(0);
+  waitpid( dead_pid , NULL , 0 );
+
+  {
+    char * stale_trash = util_alloc_sprintf( "reap/case/.trash.realization-7.%d.3" , dead_pid );
+    char * own_trash   = util_alloc_sprintf( "reap/case/.trash.realization-8.%d.0" , getpid() );
+
+    populate( stale_trash );
+    util_make_path( own_trash );
+    populate( "reap/case/realization-0" );
+    path_service_clear_directory( service , "reap/case/realization-0" , true , false );
+    path_service_join( service );
+
+    test_assert_false( util_entry_exists( stale_trash ));
+    test_assert_true( util_is_directory( own_trash ));
+    test_assert_int_equal( 2 , count_entries( "reap/case" ));
+
+    free( own_trash );
+    free( stale_trash );
+  }
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "path_service" , false );
+  path_service_type * service = path_service_alloc( 4 );
+
+  test_assert_true( path_service_is_instance( service ));
+  test_assert_int_equal( 4 , path_service_get_num_threads( service ));
+
+  test_clear( service );
+  test_clear_missing( service );
+  test_clear_foreign( service );
+  test_reap( service );
+  {
+    /* Free completes the pending deletions. */
+    populate( "simulations/case/realization-1" );
+    populate( "simulations/case/realization-2" );
+    path_service_clear_directory( service , "simulations/case/realization-1" , true , false );
+    path_service_clear_directory( service , "simulations/case/realization-2" , true , true );
+    test_assert_false( util_entry_exists( "simulations/case/realization-2" ));
+    path_service_free( service );
+    test_assert_int_equal( 19 , count_entries( "simulations/case" ));
+  }
+
+  test_work_area_free( work_area );
+  exit(0);
+}
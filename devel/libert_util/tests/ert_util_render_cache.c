@@ -0,0 +1,209 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ert_util_render_cache.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/subst_list.h>
+#include <ert/util/template.h>
+#include <ert/util/render_cache.h>
+#include <ert/util/thread_pool.h>
+
+#define NUM_THREADS 8
+#define NUM_RENDER  25
+
+
+void write_file( const char * filename , const char * content ) {
+  FILE * stream = util_fopen( filename , "w");
+  fprintf(stream , "%s" , content );
+  fclose( stream );
+}
+
+
+void test_content( const char * filename , const char * expected ) {
+  int size;
+  char * content = util_fread_alloc_file_content( filename , &size );
+  test_assert_string_equal( expected , content );
+  free( content );
+}
+
+
+void test_filter_file() {
+  test_work_area_type * work_area = test_work_area_alloc( "render_cache_filter" , false );
+  render_cache_type * cache = render_cache_alloc( );
+  subst_list_type * subst_list = subst_list_alloc( NULL );
+
+  test_assert_true( render_cache_is_instance( cache ));
+  write_file( "source.txt" , "CASE:<CASE>\n" );
+  subst_list_append_copy( subst_list , "<CASE>" , "BASE" , NULL );
+  subst_list_append_copy( subst_list , "<IENS>" , "0" , NULL );
+
+  render_cache_filter_file( cache , subst_list , "source.txt" , "run0/target.txt" );
+  test_assert_int_equal( 0 , render_cache_get_hits( cache ));
+
+  subst_list_append_copy( subst_list , "<IENS>" , "1" , NULL );
+  render_cache_filter_file( cache , subst_list , "source.txt" , "run1/target.txt" );
+  test_assert_int_equal( 1 , render_cache_get_hits( cache ));
+  test_content( "run1/target.txt" , "CASE:BASE\n" );
+  {
+    struct stat stat0 , stat1;
+    stat( "run0/target.txt" , &stat0 );
+    stat( "run1/target.txt" , &stat1 );
+    test_assert_true( stat0.st_ino != stat1.st_ino );
+  }
+
+  /* The source is internalized; changes are not seen before the cache is cleared. */
+  write_file( "source.txt" , "NEW:<CASE>\n" );
+  subst_list_append_copy( subst_list , "<CASE>" , "OTHER" , NULL );
+  render_cache_filter_file( cache , subst_list , "source.txt" , "run2/target.txt" );
+  test_content( "run2/target.txt" , "CASE:OTHER\n" );
+  render_cache_clear( cache );
+  render_cache_filter_file( cache , subst_list , "source.txt" , "run3/target.txt" );
+  test_content( "run3/target.txt" , "NEW:OTHER\n" );
+
+  /* A cached file which has been modified is not reused. */
+  write_file( "run3/target.txt" , "Modified by the forward model" );
+  render_cache_filter_file( cache , subst_list , "source.txt" , "run4/target.txt" );
+  test_content( "run4/target.txt" , "NEW:OTHER\n" );
+  test_content( "run3/target.txt" , "Modified by the forward model" );
+
+  render_cache_set_hardlink( cache , true );
+  render_cache_filter_file( cache , subst_list , "source.txt" , "run5/target.txt" );
+  test_content( "run5/target.txt" , "NEW:OTHER\n" );
+  {
+    struct stat stat4 , stat5;
+    stat( "run4/target.txt" , &stat4 );
+    stat( "run5/target.txt" , &stat5 );
+    test_assert_true( stat4.st_ino == stat5.st_ino );
+  }
+
+  subst_list_free( subst_list );
+  render_cache_free( cache );
+  test_work_area_free( work_area );
+}
+
+
+void test_template() {
+  test_work_area_type * work_area = test_work_area_alloc( "render_cache_template" , false );
+  render_cache_type * cache = render_cache_alloc( );
+  subst_list_type * arg_list = subst_list_alloc( NULL );
+  template_type * template;
+
+  write_file( "template.txt" , "<A>:<B>\n" );
+  template = template_alloc( "template.txt" , false , NULL );
+  template_add_arg( template , "<A>" , "<C>" );
+  subst_list_append_copy( arg_list , "<B>" , "b" , NULL );
+  subst_list_append_copy( arg_list , "<C>" , "c" , NULL );
+
+  template_instantiate_cached( template , "run0/target.txt" , arg_list , true , cache );
+  template_instantiate_cached( template , "run1/target.txt" , arg_list , true , cache );
+  test_content( "run0/target.txt" , "c:b\n" );
+  test_content( "run1/target.txt" , "c:b\n" );
+  test_assert_int_equal( 1 , render_cache_get_hits( cache ));
+
+  /* <C> is only reached through the value of the internal argument <A>. */
+  subst_list_append_copy( arg_list , "<C>" , "C" , NULL );
+  template_instantiate_cached( template , "run2/target.txt" , arg_list , true , cache );
+  test_content( "run2/target.txt" , "C:b\n" );
+  test_assert_int_equal( 1 , render_cache_get_hits( cache ));
+
+  template_free( template );
+  subst_list_free( arg_list );
+  render_cache_free( cache );
+  test_work_area_free( work_area );
+}
+
+
+#ifdef WITH_PTHREAD
+
+typedef struct {
+  render_cache_type * cache;
+  int                 thread_nr;
+} render_arg_type;
+
+
+/*
+  All the threads render the same three distinct contents, so they
+  continuously reuse, and add, the same keys concurrently.
+*/
+
+void * render_thread( void * arg ) {
+  render_arg_type * render_arg = (render_arg_type *) arg;
+  subst_list_type * subst_list = subst_list_alloc( NULL );
+
+  for (int i = 0; i < NUM_RENDER; i++) {
+    char * case_name = util_alloc_sprintf( "CASE_%d" , i % 3 );
+    char * iens      = util_alloc_sprintf( "%d" , render_arg->thread_nr * NUM_RENDER + i );
+    char * target    = util_alloc_sprintf( "run%d_%d/target.txt" , render_arg->thread_nr , i );
+    char * expected  = util_alloc_sprintf( "CASE:%s\n" , case_name );
+
+    subst_list_append_copy( subst_list , "<CASE>" , case_name , NULL );
+    subst_list_append_copy( subst_list , "<IENS>" , iens , NULL );
+    render_cache_filter_file( render_arg->cache , subst_list , "source.txt" , target );
+    test_content( target , expected );
+
+    free( expected );
+    free( target );
+    free( iens );
+    free( case_name );
+  }
+
+  subst_list_free( subst_list );
+  return NULL;
+}
+
+
+void test_threads() {
+  test_work_area_type * work_area = test_work_area_alloc( "render_cache_threads" , false );
+  render_cache_type * cache = render_cache_alloc( );
+  thread_pool_type * tp = thread_pool_alloc( NUM_THREADS , true );
+  render_arg_type arg_list[NUM_THREADS];
+
+  write_file( "source.txt" , "CASE:<CASE>\n" );
+  for (int i = 0; i < NUM_THREADS; i++) {
+    arg_list[i].cache     = cache;
+    arg_list[i].thread_nr = i;
+    thread_pool_add_job( tp , render_thread , &arg_list[i] );
+  }
+  thread_pool_join( tp );
+  thread_pool_free( tp );
+
+  test_assert_int_equal( NUM_THREADS * NUM_RENDER , render_cache_get_hits( cache ) + render_cache_get_misses( cache ));
+  test_assert_true( render_cache_get_misses( cache ) >= 3 );
+  test_assert_true( render_cache_get_hits( cache ) > 0 );
+
+  render_cache_free( cache );
+  test_work_area_free( work_area );
+}
+
+#endif
+
+
+int main(int argc , char ** argv) {
+  test_filter_file();
+  test_template();
+#ifdef WITH_PTHREAD
+  test_threads();
+#endif
+  exit(0);
+}
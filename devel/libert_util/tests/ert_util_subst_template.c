@@ -0,0 +1,182 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ert_util_subst_template.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/subst_list.h>
+#include <ert/util/subst_func.h>
+#include <ert/util/subst_template.h>
+
+
+/*
+  Compares the compiled template with the sequential substitution of
+  subst_list_update_string().
+*/
+
+void test_render( const char * content , const subst_list_type * subst_list1 , const subst_list_type * subst_list2 ) {
+  subst_template_type * subst_template = subst_template_alloc( content , subst_list1 , subst_list2 );
+  char * expected = util_alloc_string_copy( content );
+  char * rendered = subst_template_alloc_string( subst_template , subst_list1 , subst_list2 );
+
+  if (subst_list1 != NULL) subst_list_update_string( subst_list1 , &expected );
+  if (subst_list2 != NULL) subst_list_update_string( subst_list2 , &expected );
+
+  test_assert_true( subst_template_is_instance( subst_template ));
+  test_assert_true( subst_template_has_keys( subst_template , subst_list1 , subst_list2 ));
+  test_assert_string_equal( expected , rendered );
+
+  free( expected );
+  free( rendered );
+  subst_template_free( subst_template );
+}
+
+
+void test_keys() {
+  subst_list_type * parent = subst_list_alloc( NULL );
+  subst_list_type * subst_list = subst_list_alloc( parent );
+
+  subst_list_append_copy( parent , "<CASE>" , "BASE" , NULL );
+  subst_list_append_copy( subst_list , "<IENS>" , "7" , NULL );
+  subst_list_append_copy( subst_list , "<PATH>" , "/run/<CASE>/<IENS>" , NULL );
+  subst_list_append_copy( subst_list , "<RUNPATH>" , "<PATH>/<IENS>" , NULL );
+
+  test_render( "" , subst_list , NULL );
+  test_render( "No keys" , subst_list , NULL );
+  test_render( "<IENS>" , subst_list , NULL );
+  test_render( "<CASE><CASE>:<IENS> <PATH> <RUNPATH> <UNKNOWN>" , subst_list , NULL );
+  test_render( "<IENS>" , NULL , subst_list );
+  {
+    subst_template_type * subst_template = subst_template_alloc( "A:<IENS> B:<CASE>" , subst_list , NULL );
+    test_assert_int_equal( 2 , subst_template_get_num_placeholders( subst_template ));
+
+    /* Same keys - new values. */
+    subst_list_append_copy( subst_list , "<IENS>" , "8" , NULL );
+    {
+      char * rendered = subst_template_alloc_string( subst_template , subst_list , NULL );
+      test_assert_string_equal( "A:8 B:BASE" , rendered );
+      free( rendered );
+    }
+
+    subst_list_append_copy( subst_list , "<NEW>" , "new" , NULL );
+    test_assert_false( subst_template_has_keys( subst_template , subst_list , NULL ));
+    subst_template_free( subst_template );
+  }
+
+  subst_list_free( subst_list );
+  subst_list_free( parent );
+}
+
+
+void test_overlap() {
+  subst_list_type * subst_list = subst_list_alloc( NULL );
+
+  subst_list_append_copy( subst_list , "BC" , "x" , NULL );
+  subst_list_append_copy( subst_list , "ABCD" , "y" , NULL );
+  subst_list_append_copy( subst_list , "aa" , "b" , NULL );
+  subst_list_append_copy( subst_list , "D" , "z" , NULL );
+
+  test_render( "ABCD ABC BCD aaaaa D" , subst_list , NULL );
+  subst_list_free( subst_list );
+}
+
+
+void test_two_lists() {
+  subst_list_type * internal = subst_list_alloc( NULL );
+  subst_list_type * external = subst_list_alloc( NULL );
+
+  subst_list_append_copy( internal , "<A>" , "<C>" , NULL );
+  subst_list_append_copy( internal , "<B>" , "internal" , NULL );
+  subst_list_append_copy( external , "<B>" , "external" , NULL );
+  subst_list_append_copy( external , "<C>" , "c" , NULL );
+
+  test_render( "<A>:<B>:<C>" , internal , external );
+  test_render( "<A>:<B>:<C>" , external , internal );
+
+  subst_list_free( internal );
+  subst_list_free( external );
+}
+
+
+void test_funcs() {
+  subst_func_pool_type * func_pool = subst_func_pool_alloc( );
+  subst_list_type * subst_list = subst_list_alloc( func_pool );
+
+  subst_func_pool_add_func( func_pool , "ADD" , "Adds arguments" , subst_func_add , true , 1 , 0 , NULL);
+  subst_list_insert_func( subst_list , "ADD" , "__ADD__" );
+  subst_list_append_copy( subst_list , "<X>" , "2" , NULL );
+  subst_list_append_copy( subst_list , "<SUM>" , "__ADD__(1,<X>)" , NULL );
+
+  test_render( "X:<X>" , subst_list , NULL );
+  test_render( "__ADD__(<X>,<X>)" , subst_list , NULL );
+  test_render( "SUM:<SUM>" , subst_list , NULL );
+  {
+    subst_template_type * subst_template = subst_template_alloc( "X:<X>" , subst_list , NULL );
+    char * key = subst_template_alloc_filter_key( subst_template , subst_list , NULL );
+    test_assert_not_NULL( key );
+    free( key );
+    subst_template_free( subst_template );
+
+    subst_template = subst_template_alloc( "SUM:<SUM>" , subst_list , NULL );
+    test_assert_NULL( subst_template_alloc_filter_key( subst_template , subst_list , NULL ));
+    subst_template_free( subst_template );
+  }
+
+  subst_list_free( subst_list );
+  subst_func_pool_free( func_pool );
+}
+
+
+void test_filter_key() {
+  subst_list_type * subst_list = subst_list_alloc( NULL );
+  subst_template_type * subst_template;
+  char * key1;
+  char * key2;
+
+  subst_list_append_copy( subst_list , "<IENS>" , "1" , NULL );
+  subst_list_append_copy( subst_list , "<PATH>" , "/run/<CASE>" , NULL );
+  subst_list_append_copy( subst_list , "<CASE>" , "BASE" , NULL );
+  subst_template = subst_template_alloc( "<PATH>" , subst_list , NULL );
+
+  key1 = subst_template_alloc_filter_key( subst_template , subst_list , NULL );
+  subst_list_append_copy( subst_list , "<IENS>" , "2" , NULL );
+  key2 = subst_template_alloc_filter_key( subst_template , subst_list , NULL );
+  test_assert_string_equal( key1 , key2 );
+  free( key2 );
+
+  subst_list_append_copy( subst_list , "<CASE>" , "OTHER" , NULL );
+  key2 = subst_template_alloc_filter_key( subst_template , subst_list , NULL );
+  test_assert_false( util_string_equal( key1 , key2 ));
+
+  free( key1 );
+  free( key2 );
+  subst_template_free( subst_template );
+  subst_list_free( subst_list );
+}
+
+
+int main(int argc , char ** argv) {
+  test_keys();
+  test_overlap();
+  test_two_lists();
+  test_funcs();
+  test_filter_key();
+  exit(0);
+}
@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+#include <ert/util/util.h>
 #include <ert/util/int_vector.h>
 #include <ert/util/vector.h>
 #include <ert/util/test_util.h>
@@ -113,9 +114,31 @@ void test_sort() {
 
 
 
+/*
+  The owned elements which remain after vector_pop_front() must not
+  be freed by the next append.
+*/
+
+void test_pop_front() {
+  vector_type * vector = vector_alloc_new();
+
+  vector_append_owned_ref( vector , util_alloc_string_copy( "0" ) , free );
+  vector_append_owned_ref( vector , util_alloc_string_copy( "1" ) , free );
+  free( vector_pop_front( vector ));
+  vector_append_owned_ref( vector , util_alloc_string_copy( "2" ) , free );
+
+  test_assert_int_equal( 2 , vector_get_size( vector ));
+  test_assert_string_equal( "1" , vector_iget( vector , 0 ));
+  test_assert_string_equal( "2" , vector_iget( vector , 1 ));
+  vector_free( vector );
+}
+
+
+
 int main(int argc , char ** argv) {
   test_iset( );
   test_reverse( );
   test_sort( );
+  test_pop_front( );
   exit(0);
 }
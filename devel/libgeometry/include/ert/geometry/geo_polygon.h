@@ -33,6 +33,7 @@ extern "C" {
   void               geo_polygon_add_point( geo_polygon_type * polygon , double x , double y );
   geo_polygon_type * geo_polygon_fload_alloc_irap( const char * filename );
   bool               geo_polygon_contains_point( const geo_polygon_type * polygon , double x , double y);
+  void               geo_polygon_contains_points( const geo_polygon_type * polygon , int num_points , const double * xlist , const double * ylist , bool * inside);
 
 #ifdef __cplusplus
 }
@@ -104,6 +104,16 @@ int geo_pointset_get_size( const geo_pointset_type * pointset ) {
 }
 
 
+const double * geo_pointset_get_xcoord( const geo_pointset_type * pointset ) {
+  return pointset->xcoord;
+}
+
+
+const double * geo_pointset_get_ycoord( const geo_pointset_type * pointset ) {
+  return pointset->ycoord;
+}
+
+
 const double * geo_pointset_get_zcoord( const geo_pointset_type * pointset ) {
   return pointset->zcoord;
 }
@@ -19,6 +19,7 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <math.h>
 
 #include <ert/util/util.h>
 #include <ert/util/double_vector.h>
@@ -34,9 +35,37 @@ struct geo_polygon_struct {
   UTIL_TYPE_ID_DECLARATION;
   double_vector_type * xcoord;
   double_vector_type * ycoord;
+  double               xmin;          // Bounding box; only valid when the polygon has points.
+  double               xmax;
+  double               ymin;
+  double               ymax;
 };
 
 
+/*
+  Bucketing of the polygon edges in bands along the x axis, used for
+  testing many points against the same polygon. The point in polygon
+  test in geo_util_inside_polygon() casts a vertical ray from the
+  point, and only the edges which span the x coordinate of the point
+  can be crossed; all those edges are found in the band containing
+  the point. The edges of band b are
+
+     edges[ band_offset[b] ] ... edges[ band_offset[b + 1] - 1]
+
+  where an edge is identified by the index of its first point.
+*/
+
+#define MIN_INDEX_SIZE   16     // Polygons with fewer points than this are tested edge by edge.
+#define MAX_BAND_LOAD     4     // Max average number of bands an edge is stored in.
+
+typedef struct {
+  int      num_bands;
+  double   band_width;
+  int    * band_offset;
+  int    * edges;
+} geo_polygon_index_type;
+
+
 static UTIL_SAFE_CAST_FUNCTION( geo_polygon , GEO_POLYGON_TYPE_ID );
 
 geo_polygon_type * geo_polygon_alloc() {
@@ -45,6 +74,8 @@ geo_polygon_type * geo_polygon_alloc() {
   UTIL_TYPE_ID_INIT( polygon , GEO_POLYGON_TYPE_ID );
   polygon->xcoord = double_vector_alloc( 0 , 0 );
   polygon->ycoord = double_vector_alloc( 0 , 0 );
+  polygon->xmin = polygon->xmax = 0;
+  polygon->ymin = polygon->ymax = 0;
 
   return polygon;
 }
@@ -63,13 +94,56 @@ void geo_polygon_free__( void * arg ) {
 }
 
 
+static void geo_polygon_update_bbox( geo_polygon_type * polygon , double x , double y) {
+  if (double_vector_size( polygon->xcoord ) == 1) {
+    polygon->xmin = polygon->xmax = x;
+    polygon->ymin = polygon->ymax = y;
+  } else {
+    polygon->xmin = util_double_min( polygon->xmin , x );
+    polygon->xmax = util_double_max( polygon->xmax , x );
+    polygon->ymin = util_double_min( polygon->ymin , y );
+    polygon->ymax = util_double_max( polygon->ymax , y );
+  }
+}
+
+
+static void geo_polygon_reset_bbox( geo_polygon_type * polygon ) {
+  if (double_vector_size( polygon->xcoord ) == 0)
+    return;
+
+  polygon->xmin = double_vector_get_min( polygon->xcoord );
+  polygon->xmax = double_vector_get_max( polygon->xcoord );
+  polygon->ymin = double_vector_get_min( polygon->ycoord );
+  polygon->ymax = double_vector_get_max( polygon->ycoord );
+}
+
+
 void geo_polygon_add_point( geo_polygon_type * polygon , double x , double y) {
   double_vector_append( polygon->xcoord , x );
   double_vector_append( polygon->ycoord , y );
+  geo_polygon_update_bbox( polygon , x , y );
+}
+
+
+/*
+  All the points outside the bounding box, except the ones below it,
+  are outside the polygon: no edge spans an x value which is smaller
+  than xmin, or larger than or equal to xmax, and a vertical ray
+  starting above ymax will not cross any edges.
+*/
+
+static bool geo_polygon_outside_bbox( const geo_polygon_type * polygon , double x , double y) {
+  if (double_vector_size( polygon->xcoord ) == 0)
+    return true;
+
+  return ((x < polygon->xmin) || (x >= polygon->xmax) || (y > polygon->ymax));
 }
 
 
 bool geo_polygon_contains_point( const geo_polygon_type * polygon , double x , double y) {
+  if (geo_polygon_outside_bbox( polygon , x , y ))
+    return false;
+
   return geo_util_inside_polygon( double_vector_get_const_ptr( polygon->xcoord ) , 
                                   double_vector_get_const_ptr( polygon->ycoord ) ,
                                   double_vector_size( polygon->xcoord ) , 
@@ -77,6 +151,164 @@ bool geo_polygon_contains_point( const geo_polygon_type * polygon , double x , d
 }
 
 
+/*****************************************************************/
+
+static int geo_polygon_index_get_band( const geo_polygon_index_type * index , const geo_polygon_type * polygon , double x) {
+  int band = (int) floor( (x - polygon->xmin) / index->band_width );
+  return util_int_min( util_int_max( band , 0 ) , index->num_bands - 1);
+}
+
+
+/*
+  Counts the total number of (band, edge) entries with the current
+  number of bands; vertical edges are never crossed by the vertical
+  ray and are not stored.
+*/
+
+static int geo_polygon_index_count( geo_polygon_index_type * index , const geo_polygon_type * polygon , bool fill) {
+  const double * xcoord = double_vector_get_const_ptr( polygon->xcoord );
+  int num_points = double_vector_size( polygon->xcoord );
+  int total = 0;
+  int edge;
+
+  for (edge = 0; edge < num_points; edge++) {
+    double x1 = xcoord[ edge ];
+    double x2 = xcoord[ (edge + 1) % num_points ];
+
+    if (x1 != x2) {
+      int band1 = geo_polygon_index_get_band( index , polygon , util_double_min( x1 , x2 ));
+      int band2 = geo_polygon_index_get_band( index , polygon , util_double_max( x1 , x2 ));
+      int band;
+
+      for (band = band1; band <= band2; band++) {
+        if (fill)
+          index->edges[ index->band_offset[ band + 1 ] ] = edge;
+        index->band_offset[ band + 1 ]++;
+      }
+      total += band2 - band1 + 1;
+    }
+  }
+  return total;
+}
+
+
+static void geo_polygon_index_set_num_bands( geo_polygon_index_type * index , const geo_polygon_type * polygon , int num_bands) {
+  index->num_bands = num_bands;
+  if (polygon->xmax > polygon->xmin)
+    index->band_width = (polygon->xmax - polygon->xmin) / num_bands;
+  else
+    index->band_width = 1;
+  index->band_offset = util_realloc( index->band_offset , (num_bands + 1) * sizeof * index->band_offset );
+  {
+    int band;
+    for (band = 0; band <= num_bands; band++)
+      index->band_offset[band] = 0;
+  }
+}
+
+
+/*
+  The number of bands starts out equal to the number of edges, and is
+  halved as long as the long edges make the index too large.
+*/
+
+static geo_polygon_index_type * geo_polygon_index_alloc( const geo_polygon_type * polygon ) {
+  geo_polygon_index_type * index = util_malloc( sizeof * index );
+  int num_points = double_vector_size( polygon->xcoord );
+  int num_bands = num_points;
+  int total;
+
+  index->band_offset = NULL;
+  while (true) {
+    geo_polygon_index_set_num_bands( index , polygon , num_bands );
+    total = geo_polygon_index_count( index , polygon , false );
+    if ((total <= MAX_BAND_LOAD * num_points) || (num_bands == 1))
+      break;
+    num_bands /= 2;
+  }
+
+  /*
+    Turn the counts into offsets; the offsets are shifted one band
+    up, and are moved back in place by the filling pass below.
+  */
+  {
+    int band;
+    for (band = 1; band <= num_bands; band++)
+      index->band_offset[band] += index->band_offset[band - 1];
+
+    for (band = num_bands; band > 0; band--)
+      index->band_offset[band] = index->band_offset[band - 1];
+    index->band_offset[0] = 0;
+  }
+
+  index->edges = util_calloc( util_int_max( total , 1 ) , sizeof * index->edges );
+  geo_polygon_index_count( index , polygon , true );
+  return index;
+}
+
+
+static void geo_polygon_index_free( geo_polygon_index_type * index ) {
+  free( index->band_offset );
+  free( index->edges );
+  free( index );
+}
+
+
+/*
+  Must give exactly the same result as geo_util_inside_polygon(),
+  only the edges which can not be crossed are skipped.
+*/
+
+static bool geo_polygon_index_contains( const geo_polygon_index_type * index , const geo_polygon_type * polygon , double x0 , double y0) {
+  const double * xcoord = double_vector_get_const_ptr( polygon->xcoord );
+  const double * ycoord = double_vector_get_const_ptr( polygon->ycoord );
+  int num_points = double_vector_size( polygon->xcoord );
+  int band = geo_polygon_index_get_band( index , polygon , x0 );
+  bool inside = false;
+  int i;
+
+  for (i = index->band_offset[band]; i < index->band_offset[band + 1]; i++) {
+    int point_num = index->edges[i];
+    int next_point = ((point_num + 1) % num_points);
+    double x1 = xcoord[point_num];  double y1 = ycoord[point_num];
+    double x2 = xcoord[next_point]; double y2 = ycoord[next_point];
+
+    if ((x1 <= x0) != (x2 <= x0)) {
+      double yc = (y2 - y1)/(x2 - x1) * (x0 - x1) + y1;
+      if (y0 < yc)
+        inside = !inside;
+    }
+  }
+  return inside;
+}
+
+
+/*
+  Tests all the points (xlist[i] , ylist[i]) against the polygon, and
+  stores the result in inside[i]. The result is the same as calling
+  geo_polygon_contains_point() for each point, but the polygon edges
+  are bucketed first, so each point is only tested against the edges
+  close to it.
+*/
+
+void geo_polygon_contains_points( const geo_polygon_type * polygon , int num_points , const double * xlist , const double * ylist , bool * inside) {
+  int i;
+  if (double_vector_size( polygon->xcoord ) < MIN_INDEX_SIZE) {
+    for (i=0; i < num_points; i++)
+      inside[i] = geo_polygon_contains_point( polygon , xlist[i] , ylist[i] );
+  } else {
+    geo_polygon_index_type * index = geo_polygon_index_alloc( polygon );
+    for (i=0; i < num_points; i++) {
+      if (geo_polygon_outside_bbox( polygon , xlist[i] , ylist[i] ))
+        inside[i] = false;
+      else
+        inside[i] = geo_polygon_index_contains( index , polygon , xlist[i] , ylist[i] );
+    }
+    geo_polygon_index_free( index );
+  }
+}
+
+
 
 geo_polygon_type * geo_polygon_fload_alloc_irap( const char * filename ) {
   geo_polygon_type * polygon = geo_polygon_alloc();
@@ -100,6 +332,7 @@ geo_polygon_type * geo_polygon_fload_alloc_irap( const char * filename ) {
     double_vector_pop( polygon->xcoord );
     double_vector_pop( polygon->ycoord );
     double_vector_pop( polygon->ycoord );
+    geo_polygon_reset_bbox( polygon );
   }
   return polygon;
 }
@@ -104,18 +104,19 @@ static void geo_region_polygon_select__( geo_region_type * region ,
                                          const geo_polygon_type * polygon , 
                                          bool select_inside , bool select) {
   
+  bool * inside = util_calloc( region->pointset_size , sizeof * inside );
   int index;
-  for (index = 0; index < region->pointset_size; index++) {
 
-    double x , y;
-    bool is_inside;
-    geo_pointset_iget_xy( region->pointset , index , &x , &y);
-    
-    is_inside = geo_polygon_contains_point( polygon  , x , y );
-    if (is_inside == select_inside) 
+  geo_polygon_contains_points( polygon , 
+                               region->pointset_size , 
+                               geo_pointset_get_xcoord( region->pointset ) , 
+                               geo_pointset_get_ycoord( region->pointset ) , 
+                               inside );
+  for (index = 0; index < region->pointset_size; index++) {
+    if (inside[index] == select_inside) 
       region->active_mask[index] = select;
-
   }
+  free( inside );
   geo_region_invalidate_index_list( region );
 }
 
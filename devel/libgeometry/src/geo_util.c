@@ -27,27 +27,28 @@
 
 
 
-static bool between(double v1, double v2 , double v) {
-  return ((( v > v1) && (v < v2)) || (( v < v1) && (v > v2)));
-}
-
+/*
+  Point in polygon test by counting the crossings between the polygon
+  edges and the vertical ray going upwards from (x0,y0). An edge is
+  crossed if its end points are on different sides of x0, where a
+  vertex exactly at x0 counts as being on the left side; that way a
+  ray going through a vertex where the boundary passes from one side
+  to the other is counted exactly once.
+*/
 
 bool geo_util_inside_polygon(const double * xlist , const double * ylist , int num_points , double x0 , double y0) {
   bool inside = false;
   int point_num;
-  double y = y0;
   
   for (point_num = 0; point_num < num_points; point_num++) {
     int next_point = ((point_num + 1) % num_points);
     double x1 = xlist[point_num];  double y1 = ylist[point_num];
     double x2 = xlist[next_point]; double y2 = ylist[next_point];
     
-    if (between(x1,x2,x0)) {
+    if ((x1 <= x0) != (x2 <= x0)) {
       double yc = (y2 - y1)/(x2 - x1) * (x0 - x1) + y1;  
-      if (y < yc) {
-        y = yc;
+      if (y0 < yc) 
         inside = !inside;
-      }
     }
   }
   return inside;
@@ -0,0 +1,238 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'geo_polygon.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/geometry/geo_util.h>
+#include <ert/geometry/geo_pointset.h>
+#include <ert/geometry/geo_polygon.h>
+#include <ert/geometry/geo_region.h>
+
+
+/*
+  A comb with four teeth pointing downwards; the points below the
+  comb between the teeth are outside, and the vertical ray from them
+  crosses the back of the comb twice. The edge along the top of the
+  comb comes first, so the crossing furthest away from those points is
+  found first.
+*/
+
+geo_polygon_type * alloc_comb( ) {
+  geo_polygon_type * polygon = geo_polygon_alloc( );
+  int tooth;
+
+  geo_polygon_add_point( polygon , 8 , 10 );
+  geo_polygon_add_point( polygon , 0 , 10 );
+  for (tooth = 0; tooth < 4; tooth++) {
+    double x0 = 2 * tooth;
+    geo_polygon_add_point( polygon , x0 , 0 );
+    geo_polygon_add_point( polygon , x0 + 1 , 0 );
+    geo_polygon_add_point( polygon , x0 + 1 , 5 );
+    geo_polygon_add_point( polygon , x0 + 2 , 5 );
+  }
+  return polygon;
+}
+
+
+/*
+  Star shaped polygon with num_points points, and a random radius
+  in [0.5,1.5) for each point.
+*/
+
+geo_polygon_type * alloc_star( int num_points ) {
+  geo_polygon_type * polygon = geo_polygon_alloc( );
+  int i;
+  for (i=0; i < num_points; i++) {
+    double phi = 2 * M_PI * i / num_points;
+    double r = 0.5 + 1.0 * rand() / RAND_MAX;
+    geo_polygon_add_point( polygon , r * cos( phi ) , r * sin( phi ));
+  }
+  return polygon;
+}
+
+
+void test_comb( ) {
+  geo_polygon_type * polygon = alloc_comb( );
+  double xlist[4] = { 0.5 , 1.5 , 6.5 , 7.5 };
+  double ylist[4] = { 1   , 1   , 1   , 11  };
+  bool inside[4];
+
+  test_assert_true( geo_polygon_contains_point( polygon , 0.5 , 1 ));
+  test_assert_false( geo_polygon_contains_point( polygon , 1.5 , 1 ));
+  test_assert_false( geo_polygon_contains_point( polygon , 3.5 , 4.99 ));
+  test_assert_true( geo_polygon_contains_point( polygon , 3.5 , 5.01 ));
+  test_assert_false( geo_polygon_contains_point( polygon , -1 , 1 ));
+  test_assert_false( geo_polygon_contains_point( polygon , 9 , 1 ));
+
+  geo_polygon_contains_points( polygon , 4 , xlist , ylist , inside );
+  test_assert_true( inside[0] );
+  test_assert_false( inside[1] );
+  test_assert_true( inside[2] );
+  test_assert_false( inside[3] );
+
+  geo_polygon_free( polygon );
+}
+
+
+/*
+  The batch test must give exactly the same result as testing the
+  points one by one; also for points with x coordinate equal to a
+  polygon vertex.
+*/
+
+void test_batch( geo_polygon_type * polygon , const double * px , const double * py , int num_polygon_points ) {
+  const int num_points = 20000;
+  double * xlist = util_calloc( num_points , sizeof * xlist );
+  double * ylist = util_calloc( num_points , sizeof * ylist );
+  bool * inside  = util_calloc( num_points , sizeof * inside );
+  int num_inside = 0;
+  int i;
+
+  for (i=0; i < num_points; i++) {
+    if ((i % 10) == 0)
+      xlist[i] = px[ rand() % num_polygon_points ];
+    else
+      xlist[i] = -2 + 4.0 * rand() / RAND_MAX;
+    ylist[i] = -2 + 4.0 * rand() / RAND_MAX;
+  }
+
+  geo_polygon_contains_points( polygon , num_points , xlist , ylist , inside );
+  for (i=0; i < num_points; i++) {
+    test_assert_bool_equal( geo_util_inside_polygon( px , py , num_polygon_points , xlist[i] , ylist[i] ) , inside[i] );
+    test_assert_bool_equal( geo_polygon_contains_point( polygon , xlist[i] , ylist[i] ) , inside[i] );
+    if (inside[i])
+      num_inside++;
+  }
+  test_assert_true( num_inside > 0 );
+  test_assert_true( num_inside < num_points );
+
+  free( xlist );
+  free( ylist );
+  free( inside );
+}
+
+
+void test_star( int num_points ) {
+  double * px = util_calloc( num_points , sizeof * px );
+  double * py = util_calloc( num_points , sizeof * py );
+  geo_polygon_type * polygon = geo_polygon_alloc( );
+  int i;
+
+  for (i=0; i < num_points; i++) {
+    double phi = 2 * M_PI * i / num_points;
+    double r = 0.5 + 1.0 * rand() / RAND_MAX;
+    px[i] = r * cos( phi );
+    py[i] = r * sin( phi );
+    geo_polygon_add_point( polygon , px[i] , py[i] );
+  }
+  test_batch( polygon , px , py , num_points );
+
+  geo_polygon_free( polygon );
+  free( px );
+  free( py );
+}
+
+
+/*
+  Zigzag polygon where every second edge spans the full width of the
+  polygon.
+*/
+
+void test_zigzag( int num_teeth ) {
+  int num_points = 2 * num_teeth;
+  double * px = util_calloc( num_points , sizeof * px );
+  double * py = util_calloc( num_points , sizeof * py );
+  geo_polygon_type * polygon = geo_polygon_alloc( );
+  int i;
+
+  for (i=0; i < num_teeth; i++) {
+    px[2*i]     = -1.5;
+    py[2*i]     = -1.5 + 3.0 * i / num_teeth;
+    px[2*i + 1] = 1.5;
+    py[2*i + 1] = -1.5 + 3.0 * (i + 0.5) / num_teeth;
+  }
+  for (i=0; i < num_points; i++)
+    geo_polygon_add_point( polygon , px[i] , py[i] );
+  test_batch( polygon , px , py , num_points );
+
+  geo_polygon_free( polygon );
+  free( px );
+  free( py );
+}
+
+
+void test_region( ) {
+  geo_polygon_type * polygon = alloc_star( 500 );
+  geo_pointset_type * pointset = geo_pointset_alloc( false );
+  int i,j;
+
+  for (i=0; i < 100; i++)
+    for (j=0; j < 100; j++)
+      geo_pointset_add_xy( pointset , -2 + 0.04 * i , -2 + 0.04 * j );
+
+  {
+    geo_region_type * region = geo_region_alloc( pointset , false );
+    int_vector_type * expected = int_vector_alloc( 0 , 0 );
+    int index;
+
+    for (index = 0; index < geo_pointset_get_size( pointset ); index++) {
+      double x,y;
+      geo_pointset_iget_xy( pointset , index , &x , &y );
+      if (geo_polygon_contains_point( polygon , x , y ))
+        int_vector_append( expected , index );
+    }
+
+    geo_region_select_inside_polygon( region , polygon );
+    test_assert_true( int_vector_size( expected ) > 0 );
+    test_assert_true( int_vector_equal( expected , geo_region_get_index_list( region )));
+
+    geo_region_deselect_inside_polygon( region , polygon );
+    test_assert_int_equal( 0 , int_vector_size( geo_region_get_index_list( region )));
+
+    int_vector_free( expected );
+    geo_region_free( region );
+  }
+
+  geo_pointset_free( pointset );
+  geo_polygon_free( polygon );
+}
+
+
+int main(int argc , char ** argv) {
+  srand( 11 );
+  test_comb( );
+  test_star( 10 );
+  test_star( 1000 );
+  test_zigzag( 200 );
+  test_region( );
+  {
+    geo_polygon_type * polygon = geo_polygon_alloc( );
+    bool inside;
+    double x = 0;
+    test_assert_false( geo_polygon_contains_point( polygon , 0 , 0 ));
+    geo_polygon_contains_points( polygon , 1 , &x , &x , &inside );
+    test_assert_false( inside );
+    geo_polygon_free( polygon );
+  }
+  exit(0);
+}
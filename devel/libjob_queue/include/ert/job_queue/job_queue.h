@@ -27,6 +27,7 @@ extern "C" {
 #include <ert/util/path_fmt.h>
 
 #include <ert/job_queue/queue_driver.h>
+#include <ert/job_queue/job_resource.h>
 
   typedef bool (job_callback_ftype)   (void *);
 
@@ -76,6 +77,8 @@ extern "C" {
   int                 job_queue_iget_status_summary( const job_queue_type * queue , job_status_type status);
   time_t              job_queue_iget_sim_start( job_queue_type * queue, int job_index);
   time_t              job_queue_iget_submit_time( job_queue_type * queue, int job_index);
+  const job_resource_type * job_queue_iget_job_resource( const job_queue_type * queue , int job_index);
+  job_resource_type * job_queue_alloc_resource_summary( const job_queue_type * queue );
   job_driver_type     job_queue_lookup_driver_name( const char * driver_name );
   
   void                job_queue_set_max_job_duration(job_queue_type * queue, int max_duration_seconds); 
@@ -83,6 +86,8 @@ extern "C" {
   bool                job_queue_is_running( const job_queue_type * queue );
   void                job_queue_set_max_submit( job_queue_type * job_queue , int max_submit );
   int                 job_queue_get_max_submit(const job_queue_type * job_queue );
+  void                job_queue_set_collect_resources( job_queue_type * job_queue , bool collect_resources );
+  bool                job_queue_get_collect_resources( const job_queue_type * job_queue );
   bool                job_queue_get_open(const job_queue_type * job_queue);
   bool                job_queue_get_pause( const job_queue_type * job_queue );
   void                job_queue_set_pause_on( job_queue_type * job_queue);
@@ -93,6 +98,7 @@ extern "C" {
   int                 job_queue_get_num_running( const job_queue_type * queue);
   int                 job_queue_get_num_pending( const job_queue_type * queue);
   int                 job_queue_get_num_waiting( const job_queue_type * queue);
+  void                job_queue_reserve( job_queue_type * queue , int num_jobs );
   int                 job_queue_get_num_complete( const job_queue_type * queue);
   int                 job_queue_get_num_failed( const job_queue_type * queue);
   int                 job_queue_get_num_killed( const job_queue_type * queue);
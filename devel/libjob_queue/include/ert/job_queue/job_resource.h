@@ -0,0 +1,66 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'job_resource.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __JOB_RESOURCE_H__
+#define __JOB_RESOURCE_H__
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <ert/util/type_macros.h>
+
+  /*
+    All the quantities are -1 when they are not known; the drivers
+    only fill in the values the underlying queue system reports.
+  */
+#define JOB_RESOURCE_UNKNOWN -1
+
+  typedef struct job_resource_struct job_resource_type;
+
+  job_resource_type * job_resource_alloc( );
+  void                job_resource_free( job_resource_type * resource );
+  void                job_resource_reset( job_resource_type * resource );
+  void                job_resource_assign( job_resource_type * target , const job_resource_type * src );
+  bool                job_resource_is_empty( const job_resource_type * resource );
+
+  void                job_resource_set_cpu_seconds( job_resource_type * resource , double cpu_seconds );
+  void                job_resource_set_wall_seconds( job_resource_type * resource , double wall_seconds );
+  void                job_resource_set_max_rss( job_resource_type * resource , long max_rss );
+  void                job_resource_set_read_bytes( job_resource_type * resource , long read_bytes );
+  void                job_resource_set_write_bytes( job_resource_type * resource , long write_bytes );
+
+  double              job_resource_get_cpu_seconds( const job_resource_type * resource );
+  double              job_resource_get_wall_seconds( const job_resource_type * resource );
+  long                job_resource_get_max_rss( const job_resource_type * resource );
+  long                job_resource_get_read_bytes( const job_resource_type * resource );
+  long                job_resource_get_write_bytes( const job_resource_type * resource );
+  int                 job_resource_get_num_jobs( const job_resource_type * resource );
+
+  void                job_resource_add( job_resource_type * total , const job_resource_type * resource );
+  void                job_resource_fprintf( const job_resource_type * resource , FILE * stream );
+  bool                job_resource_fscanf( job_resource_type * resource , FILE * stream );
+
+  UTIL_SAFE_CAST_HEADER( job_resource );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -22,7 +22,17 @@
 extern "C" {
 #endif
 
+#include <ert/util/stringlist.h>
+#include <ert/util/type_macros.h>
+
 #include <ert/job_queue/queue_driver.h>
+
+  /*
+    The options supported by the local driver.
+  */
+#define LOCAL_MAX_PROCESSES  "MAX_PROCESSES"
+#define LOCAL_MAX_MEMORY     "MAX_MEMORY"
+#define LOCAL_CPU_AFFINITY   "CPU_AFFINITY"
   
   typedef struct local_driver_struct local_driver_type;
   typedef struct local_job_struct    local_job_type;
@@ -39,10 +49,21 @@ extern "C" {
                                  int           argc,     
                                  const char ** argv );
   void            local_driver_kill_job(void * __driver , void * __job);
+  void            local_driver_free(local_driver_type * driver);
   void            local_driver_free__(void * __driver );
   job_status_type local_driver_get_job_status(void * __driver , void * __job);
+  bool            local_driver_get_job_resource(void * __driver , void * __job , job_resource_type * resource);
   void            local_driver_free_job(void * __job);
   void            local_driver_init_option_list(stringlist_type * option_list);
+  bool            local_driver_set_option( void * __driver , const char * option_key , const void * value);
+  const void    * local_driver_get_option( const void * __driver , const char * option_key );
+
+  int             local_job_get_exit_code( const local_job_type * job );
+  double          local_job_get_cpu_seconds( const local_job_type * job );
+  long            local_job_get_max_rss( const local_job_type * job );
+
+  UTIL_SAFE_CAST_HEADER( local_job );
+  UTIL_SAFE_CAST_HEADER_CONST( local_job );
 
 
 
@@ -73,11 +73,21 @@ typedef struct lsf_job_struct    lsf_job_type;
                                const char  * job_name ,
                                int           argc,     
                                const char ** argv );
+  bool   lsf_driver_submit_array(void * __driver ,
+                                 int num_jobs ,
+                                 const char ** submit_cmd ,
+                                 int num_cpu ,
+                                 const char ** run_path ,
+                                 const char ** job_name ,
+                                 const int * argc ,
+                                 const char *** argv ,
+                                 void ** job_data);
   job_status_type lsf_driver_convert_status( int lsf_status );
   void            lsf_driver_kill_job(void * __driver , void * __job);
   void            lsf_driver_free__(void * __driver );
   void            lsf_driver_free( lsf_driver_type * driver );
   job_status_type lsf_driver_get_job_status(void * __driver , void * __job);
+  bool            lsf_driver_get_job_resource(void * __driver , void * __job , job_resource_type * resource);
   int             lsf_driver_get_job_status_lsf(void * __driver , void * __job);
   void            lsf_driver_free_job(void * __job);
   void            lsf_driver_display_info( void * __driver , void * __job);
@@ -24,6 +24,8 @@ extern "C" {
 
 #include <ert/util/hash.h>
 
+#include <ert/job_queue/job_resource.h>
+
   typedef enum {
     NULL_DRIVER = 0,
     LSF_DRIVER = 1,
@@ -45,6 +47,7 @@ extern "C" {
     The options supported by the base queue_driver.
    */
 #define MAX_RUNNING          "MAX_RUNNING"
+#define SUBMIT_ARRAY_SIZE    "SUBMIT_ARRAY_SIZE"
   
   typedef enum {
     JOB_QUEUE_NOT_ACTIVE = 1, /* This value is used in external query routines - for jobs which are (currently) not active. */
@@ -112,10 +115,13 @@ extern "C" {
 
 
   typedef struct queue_driver_struct queue_driver_type;
+  typedef struct queue_array_struct  queue_array_type;
 
   typedef void * (submit_job_ftype) (void * data, const char * cmd, int num_cpu, const char * run_path, const char * job_name, int argc, const char ** argv);
   typedef void (kill_job_ftype) (void *, void *);
   typedef job_status_type(get_status_ftype) (void *, void *);
+  typedef bool (get_resource_ftype) (void *, void *, job_resource_type *);
+  typedef bool (submit_array_ftype) (void * data, int num_jobs, const char ** cmd, int num_cpu, const char ** run_path, const char ** job_name, const int * argc, const char *** argv, void ** job_data);
   typedef void (free_job_ftype) (void *);
   typedef void (free_queue_driver_ftype) (void *);
   typedef bool (set_option_ftype) (void *, const char*, const void *);
@@ -134,6 +140,19 @@ extern "C" {
   void queue_driver_free_job(queue_driver_type * driver, void * job_data);
   void queue_driver_kill_job(queue_driver_type * driver, void * job_data);
   job_status_type queue_driver_get_status(queue_driver_type * driver, void * job_data);
+  bool queue_driver_get_resource(queue_driver_type * driver, void * job_data, job_resource_type * resource);
+  bool queue_driver_submit_array(queue_driver_type * driver, int num_jobs, const char ** run_cmd, int num_cpu, const char ** run_path, const char ** job_name, const int * argc, const char *** argv, void ** job_data);
+  int  queue_driver_get_submit_array_size(const queue_driver_type * driver);
+  void queue_driver_set_submit_array_size(queue_driver_type * driver, int submit_array_size);
+
+  queue_array_type * queue_array_alloc(const char * run_path, int batch_nr);
+  char * queue_array_alloc_filename(queue_array_type * array, const char * ext);
+  void queue_array_add_file(queue_array_type * array, const char * filename);
+  void queue_array_add_job(queue_array_type * array);
+  void queue_array_release_job(queue_array_type * array);
+  void queue_array_release(queue_array_type * array);
+  void queue_array_release__(void * arg);
+  void queue_driver_fprintf_array_script(FILE * stream, const char * index_var, const char * stdout_ext, int num_jobs, const char ** run_cmd, const char ** run_path, const char ** job_name, const int * argc, const char *** argv);
   
   const char * queue_driver_get_name(const queue_driver_type * driver);
 
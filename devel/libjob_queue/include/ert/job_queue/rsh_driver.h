@@ -44,6 +44,7 @@ extern "C" {
   void            rsh_driver_kill_job(void * __driver , void * __job);
   void            rsh_driver_free__(void * __driver );
   job_status_type rsh_driver_get_job_status(void * __driver , void * __job);
+  bool            rsh_driver_get_job_resource(void * __driver , void * __job , job_resource_type * resource);
   void            rsh_driver_free_job(void * __job);
   
   
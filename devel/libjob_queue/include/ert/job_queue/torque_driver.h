@@ -39,6 +39,8 @@ extern "C" {
 #define TORQUE_DEFAULT_QSUB_CMD   "qsub"
 #define TORQUE_DEFAULT_QSTAT_CMD  "qstat"
 #define TORQUE_DEFAULT_QDEL_CMD  "qdel"
+#define TORQUE_DEFAULT_QSTAT_REFRESH_INTERVAL 5
+#define TORQUE_DEFAULT_MISSING_JOB_GRACE_TIME 60
 
 
   typedef struct torque_driver_struct torque_driver_type;
@@ -56,12 +58,26 @@ extern "C" {
           int argc,
           const char ** argv);
 
+  bool torque_driver_submit_array(void * __driver,
+          int num_jobs,
+          const char ** submit_cmd,
+          int num_cpu,
+          const char ** run_path,
+          const char ** job_name,
+          const int * argc,
+          const char *** argv,
+          void ** job_data);
+
   void torque_driver_kill_job(void * __driver, void * __job);
   void torque_driver_free__(void * __driver);
   void torque_driver_free(torque_driver_type * driver);
   job_status_type torque_driver_get_job_status(void * __driver, void * __job);
+  bool torque_driver_get_job_resource(void * __driver, void * __job, job_resource_type * resource);
   void torque_driver_free_job(void * __job);
   void torque_driver_set_qstat_refresh_interval(torque_driver_type * driver, int refresh_interval);
+  int torque_driver_get_qstat_refresh_interval(const torque_driver_type * driver);
+  void torque_driver_set_missing_job_grace_time(torque_driver_type * driver, int grace_time);
+  int torque_driver_get_missing_job_grace_time(const torque_driver_type * driver);
 
   const void * torque_driver_get_option(const void * __driver, const char * option_key);
   bool torque_driver_set_option(void * __driver, const char * option_key, const void * value);
@@ -37,6 +37,9 @@ extern "C" {
   bool                      workflow_run(  workflow_type * workflow , void * self , bool verbose , const subst_list_type * context);
   void                      workflow_free( workflow_type * workflow );
   void                      workflow_free__( void * arg );
+  void                      workflow_set_num_threads( workflow_type * workflow , int num_threads );
+  int                       workflow_get_num_threads( const workflow_type * workflow );
+  void                      workflow_clear_cache( workflow_type * workflow );
 
   int                       workflow_get_stack_size( const workflow_type * workflow );
   void                    * workflow_iget_stack_ptr( const workflow_type * workflow , int index);
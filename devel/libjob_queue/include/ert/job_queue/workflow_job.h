@@ -31,6 +31,11 @@ extern "C" {
   
   const char   * workflow_job_get_name( const workflow_job_type * workflow_job );
   bool           workflow_job_internal( const workflow_job_type * workflow_job );
+  const char   * workflow_job_get_executable( const workflow_job_type * workflow_job );
+  bool           workflow_job_get_cache( const workflow_job_type * workflow_job );
+  void           workflow_job_set_cache( workflow_job_type * workflow_job , bool cache);
+  bool           workflow_job_get_thread_safe( const workflow_job_type * workflow_job );
+  void           workflow_job_set_thread_safe( workflow_job_type * workflow_job , bool thread_safe);
   config_type  * workflow_job_alloc_config();
   workflow_job_type * workflow_job_alloc(const char * name , bool internal);
   void           workflow_job_free( workflow_job_type * workflow_job );
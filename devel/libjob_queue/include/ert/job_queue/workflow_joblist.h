@@ -28,6 +28,13 @@ extern "C" {
 
 #include <ert/job_queue/workflow_job.h>
 
+/*
+  Reserved keyword in the workflow files: '__STEP__ name [dep1 dep2 ...]'
+  gives the following command a name, and lists the named steps it
+  depends on. A job can not be installed with this name.
+*/
+#define WORKFLOW_STEP_KEY "__STEP__"
+
 typedef struct workflow_joblist_struct workflow_joblist_type;
 
   workflow_joblist_type   * workflow_joblist_alloc();
@@ -28,6 +28,7 @@
 #include <ert/util/util.h>
 #include <ert/util/thread_pool.h>
 #include <ert/util/arg_pack.h>
+#include <ert/util/int_vector.h>
 
 #include <ert/job_queue/job_queue.h>
 #include <ert/job_queue/queue_driver.h>
@@ -270,6 +271,7 @@ struct job_queue_node_struct {
   char                 **argv;            /* The commandline arguments. */
   time_t                 submit_time;     /* When was the job added to job_queue - the FIRST TIME. */
   time_t                 sim_start;       /* When did the job change status -> RUNNING - the LAST TIME. */
+  job_resource_type     *resource;        /* The resources used by the last run of the job, as reported by the driver. */
   pthread_rwlock_t       job_lock;        /* This lock provides read/write locking of the job_data field. */ 
   job_callback_ftype    *done_callback;
   job_callback_ftype    *retry_callback;  /* To determine if job can be retried */
@@ -325,6 +327,7 @@ struct job_queue_struct {
   int                        active_size;                       /* The current number of job slots in the queue. */
   int                        alloc_size;                        /* The current allocated size of jobs array. */
   int                        max_submit;                        /* The maximum number of submit attempts for one job. */
+  bool                       collect_resources;                 /* Should the driver be asked for the resources used by completed jobs? */
   char                     * exit_file;                         /* The queue will look for the occurence of this file to detect a failure. */
   char                     * ok_file;                           /* The queue will look for this file to verify that the job was OK - can be NULL - in which case it is ignored. */
   job_queue_node_type     ** jobs;                              /* A vector of job nodes .*/
@@ -500,6 +503,7 @@ static job_queue_node_type * job_queue_node_alloc( ) {
   
   job_queue_node_clear(node);
   job_queue_node_clear_error_info(node);
+  node->resource = job_resource_alloc( );
   pthread_rwlock_init( &node->job_lock , NULL);
 
   return node;
@@ -531,6 +535,7 @@ static void job_queue_node_free_data(job_queue_node_type * node) {
 static void job_queue_node_free(job_queue_node_type * node) {
   job_queue_node_free_data(node);
   job_queue_node_free_error_info(node);
+  job_resource_free(node->resource);
   util_safe_free(node->run_path);  
   free(node);
 }
@@ -597,6 +602,7 @@ static void job_queue_initialize_node(job_queue_type * queue ,
   node->callback_arg   = callback_arg;
   node->sim_start      = -1;
   node->submit_time    = time( NULL );
+  job_resource_reset( node->resource );
 
   /* Now the job is ready to be picked by the queue manager. */
   job_queue_change_node_status(queue , node , JOB_QUEUE_WAITING);   
@@ -660,11 +666,33 @@ static bool job_queue_change_node_status(job_queue_type * queue , job_queue_node
    protect against a double free.
 */
 
+/*
+  The driver is asked for the resources used by the job before the
+  driver data is freed; if the driver does not report the wall time
+  it is estimated from the time the job was seen running.
+
+  For the LSF (shell modes) and Torque drivers this is one bjobs -l
+  or qstat -f command for every job, the resources are therefor only
+  collected when this has been enabled with
+  job_queue_set_collect_resources().
+*/
+
+static void job_queue_node_update_resource(job_queue_type * queue , job_queue_node_type * node) {
+  job_resource_reset( node->resource );
+  queue_driver_get_resource( queue->driver , node->job_data , node->resource );
+  if ((job_resource_get_wall_seconds( node->resource ) < 0) && (node->sim_start >= node->submit_time))
+    job_resource_set_wall_seconds( node->resource , difftime( time( NULL ) , node->sim_start ));
+}
+
+
 static void job_queue_free_job_driver_data(job_queue_type * queue , job_queue_node_type * node) {
   pthread_rwlock_wrlock( &node->job_lock );
   {
-    if (node->job_data != NULL) 
+    if (node->job_data != NULL) {
+      if (queue->collect_resources)
+        job_queue_node_update_resource( queue , node );
       queue_driver_free_job( queue->driver , node->job_data );
+    }
     node->job_data = NULL;
   }
   pthread_rwlock_unlock( &node->job_lock );
@@ -764,6 +792,82 @@ static submit_status_type job_queue_submit_job(job_queue_type * queue , int queu
 
 
 
+/*
+  Submits the nodes in queue_index_list as one array job. The driver
+  returns one job_data instance for each element of the array, which
+  is attached to the corresponding node; i.e. after submission the
+  elements are handled exactly like jobs submitted one by one.
+
+  If the driver can not submit array jobs in its current
+  configuration the jobs are submitted one by one instead.
+*/
+
+static int job_queue_submit_array(job_queue_type * queue , const int_vector_type * queue_index_list) {
+  const int num_jobs = int_vector_size( queue_index_list );
+  int submit_count   = 0;
+
+  if (queue->user_exit || queue->pause_on)
+    return 0;
+
+  {
+    const char ** run_cmd   = util_calloc( num_jobs , sizeof * run_cmd );
+    const char ** run_path  = util_calloc( num_jobs , sizeof * run_path );
+    const char ** job_name  = util_calloc( num_jobs , sizeof * job_name );
+    const char *** argv     = util_calloc( num_jobs , sizeof * argv );
+    int * argc              = util_calloc( num_jobs , sizeof * argc );
+    void ** job_data        = util_calloc( num_jobs , sizeof * job_data );
+    int num_cpu             = 1;
+
+    for (int i = 0; i < num_jobs; i++) {
+      int queue_index = int_vector_iget( queue_index_list , i );
+      job_queue_node_type * node;
+
+      job_queue_assert_queue_index(queue , queue_index);
+      node = queue->jobs[queue_index];
+      run_cmd[i]  = node->run_cmd;
+      run_path[i] = node->run_path;
+      job_name[i] = node->job_name;
+      argc[i]     = node->argc;
+      argv[i]     = (const char **) node->argv;
+      num_cpu     = util_int_max( num_cpu , node->num_cpu );
+      job_data[i] = NULL;
+    }
+
+    if (queue_driver_submit_array( queue->driver , num_jobs , run_cmd , num_cpu , run_path , job_name , argc , argv , job_data )) {
+      for (int i = 0; i < num_jobs; i++) {
+        job_queue_node_type * node = queue->jobs[ int_vector_iget( queue_index_list , i ) ];
+        if (job_data[i] != NULL) {
+          pthread_rwlock_wrlock( &node->job_lock );
+          {
+            node->job_data = job_data[i];
+            node->submit_attempt++;
+            job_queue_change_node_status(queue , node , JOB_QUEUE_SUBMITTED );
+          }
+          pthread_rwlock_unlock( &node->job_lock );
+          submit_count++;
+        }
+      }
+    } else {
+      for (int i = 0; i < num_jobs; i++) {
+        if (job_queue_submit_job( queue , int_vector_iget( queue_index_list , i )) == SUBMIT_OK)
+          submit_count++;
+        else
+          break;
+      }
+    }
+
+    free( run_cmd );
+    free( run_path );
+    free( job_name );
+    free( argv );
+    free( argc );
+    free( job_data );
+  }
+  return submit_count;
+}
+
+
+
 const char * job_queue_iget_run_path( const job_queue_type * queue , int job_index) {
   job_queue_node_type * node = queue->jobs[job_index];
   return node->run_path;
@@ -952,6 +1056,34 @@ time_t job_queue_iget_submit_time( job_queue_type * queue, int job_index) {
 }
 
 
+/*
+  The resources used by the last completed run of the job; all the
+  fields are JOB_RESOURCE_UNKNOWN until the job has completed.
+*/
+
+const job_resource_type * job_queue_iget_job_resource( const job_queue_type * queue , int job_index) {
+  job_queue_node_type * node = queue->jobs[job_index];
+  return node->resource;
+}
+
+
+/*
+  Sums up the resources used by all the jobs in the queue which have
+  completed and reported resource usage; see job_resource_add() for
+  how the quantities are combined.
+*/
+
+job_resource_type * job_queue_alloc_resource_summary( const job_queue_type * queue ) {
+  job_resource_type * total = job_resource_alloc( );
+  for (int job_index = 0; job_index < queue->active_size; job_index++) {
+    const job_queue_node_type * node = queue->jobs[job_index];
+    if (!job_resource_is_empty( node->resource ))
+      job_resource_add( total , node->resource );
+  }
+  return total;
+}
+
+
 
 static void job_queue_update_spinner( int * phase ) {
   const char * spinner = "-\\|/";
@@ -1028,6 +1160,23 @@ void job_queue_reset(job_queue_type * queue) {
 }
 
 
+/**
+   Makes room for at least @num_jobs jobs without growing the jobs
+   array while the queue is running; when the array must be grown
+   while jobs are being added with job_queue_add_job_mt() the adding
+   thread must wait for the thread running the queue to pick up the
+   grow request. Can only be called when the queue is not running.
+*/
+
+void job_queue_reserve( job_queue_type * queue , int num_jobs ) {
+  if (queue->running)
+    util_abort("%s: can not reserve job slots while the queue is running\n",__func__);
+
+  while (queue->alloc_size < num_jobs)
+    job_queue_grow( queue );
+}
+
+
 bool job_queue_is_running( const job_queue_type * queue ) {
   return queue->running;
 }
@@ -1338,21 +1487,26 @@ void job_queue_run_jobs(job_queue_type * queue , int num_total_run, bool verbose
           
           if (cont) {
             /* Submitting new jobs */
-            int max_submit     = 5; /* This is the maximum number of jobs submitted in one while() { ... } below. 
+            int array_size     = queue_driver_get_submit_array_size( queue->driver );
+            int max_submit     = 5; /* This is the maximum number of submit calls to the driver in one while() { ... } below. 
                                        Only to ensure that the waiting time before a status update is not too long. */
             int total_active   = queue->status_list[ STATUS_INDEX(JOB_QUEUE_PENDING) ] + queue->status_list[ STATUS_INDEX(JOB_QUEUE_RUNNING) ];
+            int max_submit_jobs = max_submit;
             int num_submit_new;
             
+            if (array_size > 1)
+              max_submit_jobs = max_submit * array_size;   /* One array job is submitted with one call to the queue system. */
+
             {
               int max_running = job_queue_get_max_running( queue );
               if (max_running > 0)
-                num_submit_new = util_int_min( max_submit ,  max_running - total_active );
+                num_submit_new = util_int_min( max_submit_jobs ,  max_running - total_active );
               else
                 /* 
                    If max_running == 0 that should be interpreted as no limit; i.e. the queue layer will
                    attempt to send an unlimited number of jobs to the driver - the driver can reject the jobs.
                 */
-                num_submit_new = util_int_min( max_submit , queue->status_list[ STATUS_INDEX( JOB_QUEUE_WAITING )]);
+                num_submit_new = util_int_min( max_submit_jobs , queue->status_list[ STATUS_INDEX( JOB_QUEUE_WAITING )]);
             }
             
             new_jobs = false;
@@ -1360,7 +1514,36 @@ void job_queue_run_jobs(job_queue_type * queue , int num_total_run, bool verbose
               if (num_submit_new > 0)                                        /* The queue can allow more running jobs */
                 new_jobs = true;
 
-            if (new_jobs) {
+            if (new_jobs && (array_size > 1)) {
+              int_vector_type * queue_index_list = int_vector_alloc( 0 , 0 );
+              int queue_index = 0;
+              int num_calls   = 0;
+
+              while ((num_calls < max_submit) && (num_submit_new > 0) && (queue_index < queue->active_size)) {
+                int batch_size = util_int_min( array_size , num_submit_new );
+                int submit_count = 0;
+
+                int_vector_reset( queue_index_list );
+                for (; (queue_index < queue->active_size) && (int_vector_size( queue_index_list ) < batch_size); queue_index++) {
+                  if (job_queue_node_get_status( queue->jobs[queue_index] ) == JOB_QUEUE_WAITING)
+                    int_vector_append( queue_index_list , queue_index );
+                }
+              
+                if (int_vector_size( queue_index_list ) > 1)
+                  submit_count = job_queue_submit_array( queue , queue_index_list );
+                else if (int_vector_size( queue_index_list ) == 1) {
+                  if (job_queue_submit_job( queue , int_vector_iget( queue_index_list , 0 )) == SUBMIT_OK)
+                    submit_count = 1;
+                }
+
+                if (submit_count == 0)
+                  break;
+                num_submit_new -= submit_count;
+                num_calls++;
+              }
+              
+              int_vector_free( queue_index_list );
+            } else if (new_jobs) {
               int submit_count = 0;
               int queue_index  = 0;
             
@@ -1695,6 +1878,16 @@ int job_queue_get_max_submit(const job_queue_type * job_queue ) {
 }
 
 
+void job_queue_set_collect_resources( job_queue_type * job_queue , bool collect_resources ) {
+  job_queue->collect_resources = collect_resources;
+}
+
+
+bool job_queue_get_collect_resources( const job_queue_type * job_queue ) {
+  return job_queue->collect_resources;
+}
+
+
 
 static void job_queue_grow( job_queue_type * queue ) {
   int alloc_size                  = util_int_max( 2 * queue->alloc_size , JOB_QUEUE_START_SIZE );
@@ -1742,6 +1935,7 @@ job_queue_type * job_queue_alloc(int  max_submit               ,
   queue->max_ok_wait_time = 60;   
   queue->max_duration     = 0;  
   queue->max_submit       = max_submit;
+  queue->collect_resources = false;
   queue->driver           = NULL;
   queue->ok_file          = util_alloc_string_copy( ok_file );
   queue->exit_file        = util_alloc_string_copy( exit_file );
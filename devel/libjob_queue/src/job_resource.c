@@ -0,0 +1,209 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'job_resource.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+
+#include <ert/job_queue/job_resource.h>
+
+/*
+  The job_resource structure holds the resources consumed by one
+  job, as reported by the queue driver when the job has completed:
+
+    cpu_seconds  : user + system cpu time.
+    wall_seconds : elapsed time from start to completion.
+    max_rss      : peak resident set size in kilobytes.
+    read_bytes / write_bytes : volume of block I/O.
+
+  The same structure is used to aggregate the resources of many
+  jobs with job_resource_add(); in an aggregated record the cpu, wall
+  and I/O fields are totals, whereas max_rss is the largest peak of
+  any job.
+*/
+
+#define JOB_RESOURCE_TYPE_ID 61703391
+
+struct job_resource_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  int      num_jobs;
+  double   cpu_seconds;
+  double   wall_seconds;
+  long     max_rss;
+  long     read_bytes;
+  long     write_bytes;
+};
+
+
+UTIL_SAFE_CAST_FUNCTION( job_resource , JOB_RESOURCE_TYPE_ID )
+
+
+job_resource_type * job_resource_alloc( ) {
+  job_resource_type * resource = util_malloc( sizeof * resource );
+  UTIL_TYPE_ID_INIT( resource , JOB_RESOURCE_TYPE_ID );
+  job_resource_reset( resource );
+  return resource;
+}
+
+
+void job_resource_free( job_resource_type * resource ) {
+  free( resource );
+}
+
+
+void job_resource_reset( job_resource_type * resource ) {
+  resource->num_jobs     = 0;
+  resource->cpu_seconds  = JOB_RESOURCE_UNKNOWN;
+  resource->wall_seconds = JOB_RESOURCE_UNKNOWN;
+  resource->max_rss      = JOB_RESOURCE_UNKNOWN;
+  resource->read_bytes   = JOB_RESOURCE_UNKNOWN;
+  resource->write_bytes  = JOB_RESOURCE_UNKNOWN;
+}
+
+
+void job_resource_assign( job_resource_type * target , const job_resource_type * src ) {
+  target->num_jobs     = src->num_jobs;
+  target->cpu_seconds  = src->cpu_seconds;
+  target->wall_seconds = src->wall_seconds;
+  target->max_rss      = src->max_rss;
+  target->read_bytes   = src->read_bytes;
+  target->write_bytes  = src->write_bytes;
+}
+
+
+bool job_resource_is_empty( const job_resource_type * resource ) {
+  return ((resource->cpu_seconds  < 0) &&
+          (resource->wall_seconds < 0) &&
+          (resource->max_rss      < 0) &&
+          (resource->read_bytes   < 0) &&
+          (resource->write_bytes  < 0));
+}
+
+/*****************************************************************/
+
+void job_resource_set_cpu_seconds( job_resource_type * resource , double cpu_seconds ) {
+  resource->cpu_seconds = cpu_seconds;
+}
+
+void job_resource_set_wall_seconds( job_resource_type * resource , double wall_seconds ) {
+  resource->wall_seconds = wall_seconds;
+}
+
+void job_resource_set_max_rss( job_resource_type * resource , long max_rss ) {
+  resource->max_rss = max_rss;
+}
+
+void job_resource_set_read_bytes( job_resource_type * resource , long read_bytes ) {
+  resource->read_bytes = read_bytes;
+}
+
+void job_resource_set_write_bytes( job_resource_type * resource , long write_bytes ) {
+  resource->write_bytes = write_bytes;
+}
+
+
+double job_resource_get_cpu_seconds( const job_resource_type * resource ) {
+  return resource->cpu_seconds;
+}
+
+double job_resource_get_wall_seconds( const job_resource_type * resource ) {
+  return resource->wall_seconds;
+}
+
+long job_resource_get_max_rss( const job_resource_type * resource ) {
+  return resource->max_rss;
+}
+
+long job_resource_get_read_bytes( const job_resource_type * resource ) {
+  return resource->read_bytes;
+}
+
+long job_resource_get_write_bytes( const job_resource_type * resource ) {
+  return resource->write_bytes;
+}
+
+int job_resource_get_num_jobs( const job_resource_type * resource ) {
+  return resource->num_jobs;
+}
+
+/*****************************************************************/
+
+static double job_resource_add_double( double total , double value ) {
+  if (value < 0)
+    return total;
+  else if (total < 0)
+    return value;
+  else
+    return total + value;
+}
+
+
+static long job_resource_add_long( long total , long value ) {
+  if (value < 0)
+    return total;
+  else if (total < 0)
+    return value;
+  else
+    return total + value;
+}
+
+
+/*
+  Adds the resources of one job to the total; quantities which are
+  unknown for the job do not contribute.
+*/
+
+void job_resource_add( job_resource_type * total , const job_resource_type * resource ) {
+  total->num_jobs     += util_int_max( 1 , resource->num_jobs );
+  total->cpu_seconds   = job_resource_add_double( total->cpu_seconds  , resource->cpu_seconds );
+  total->wall_seconds  = job_resource_add_double( total->wall_seconds , resource->wall_seconds );
+  total->read_bytes    = job_resource_add_long( total->read_bytes  , resource->read_bytes );
+  total->write_bytes   = job_resource_add_long( total->write_bytes , resource->write_bytes );
+  if (resource->max_rss > total->max_rss)
+    total->max_rss = resource->max_rss;
+}
+
+
+void job_resource_fprintf( const job_resource_type * resource , FILE * stream ) {
+  fprintf(stream , "%d %.3f %.3f %ld %ld %ld\n" ,
+          resource->num_jobs ,
+          resource->cpu_seconds ,
+          resource->wall_seconds ,
+          resource->max_rss ,
+          resource->read_bytes ,
+          resource->write_bytes );
+}
+
+
+bool job_resource_fscanf( job_resource_type * resource , FILE * stream ) {
+  job_resource_type tmp;
+  if (fscanf(stream , "%d %lg %lg %ld %ld %ld" ,
+             &tmp.num_jobs ,
+             &tmp.cpu_seconds ,
+             &tmp.wall_seconds ,
+             &tmp.max_rss ,
+             &tmp.read_bytes ,
+             &tmp.write_bytes) == 6) {
+    job_resource_assign( resource , &tmp );
+    return true;
+  } else
+    return false;
+}
@@ -16,129 +16,435 @@
    for more details. 
 */
 
+#define _GNU_SOURCE
+#include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
 #include <pthread.h>
+#include <unistd.h>
 #include <errno.h>
 
 #include <ert/util/util.h>
-#include <ert/util/arg_pack.h>
+#include <ert/util/vector.h>
 
 #include <ert/job_queue/queue_driver.h>
 #include <ert/job_queue/local_driver.h>
 
 
+/**
+   The local driver runs the jobs as child processes of the current
+   process. All the jobs of one driver are supervised by one reaper
+   thread, which waits for the child processes to exit, records the
+   exit status and resource usage and starts pending jobs when there
+   is a free slot.
 
+   The driver only reaps its own children: the current process also
+   runs other child processes (e.g. through util_fork_exec()) which
+   are waited for by their owners, or not at all. The reaper therefor
+   polls each of the running pids with wait4( pid , WNOHANG ), and
+   sleeps on the work condition for LOCAL_DRIVER_POLL_USEC between the
+   rounds when nothing has exited.
+
+   The driver supports the options:
+
+     MAX_PROCESSES: The maximum number of jobs running concurrently,
+        additional jobs are held in the driver with status
+        JOB_QUEUE_PENDING. The default value 0 means no limit, in
+        addition to the MAX_RUNNING limit of the job_queue.
+
+     MAX_MEMORY: Limit on the address space of each job, in MB. The
+        default value 0 means no limit.
+
+     CPU_AFFINITY: If true each job is pinned to one cpu, the cpus are
+        assigned round robin.
+*/
 
 
 struct local_job_struct {
   UTIL_TYPE_ID_DECLARATION;
-  bool            active;
-  job_status_type status;
-  pthread_t       run_thread;
-  pid_t           child_process;
+  bool               active;
+  job_status_type    status;
+  pid_t              child_process;
+  bool               orphan;         /* The job has been freed by the queue while the process was running. */
+  bool               kill_requested; /* local_driver_kill_job() has been called while the process was running. */
+  int                exit_code;      /* The exit code, or 128 + signal number if the process was killed. */
+  struct rusage      rusage;
+  struct timeval     start_time;
+  struct timeval     end_time;
+  char             * executable;
+  int                argc;
+  char            ** argv;
+  local_driver_type * driver;        /* Set while the job is pending or running. */
 };
 
 
 #define LOCAL_DRIVER_TYPE_ID 66196305
 #define LOCAL_JOB_TYPE_ID    63056619
+#define LOCAL_DRIVER_POLL_USEC 10000
 
 struct local_driver_struct {
   UTIL_TYPE_ID_DECLARATION;
-  pthread_attr_t     thread_attr;
-  pthread_mutex_t    submit_lock;
+  pthread_mutex_t    lock;
+  pthread_cond_t     work_cond;      /* Signalled when a job has been started, or the driver is shut down. */
+  pthread_t          reaper_thread;
+  bool               reaper_started;
+  bool               shutdown;
+  vector_type      * pending;        /* Jobs waiting for a free slot - not owned. */
+  vector_type      * running;        /* Jobs with a running process - not owned; orphans are freed by the reaper. */
+  int                max_processes;
+  long               max_memory;     /* MB */
+  bool               cpu_affinity;
+  int                next_cpu;
+  char             * max_processes_string;
+  char             * max_memory_string;
 };
 
 /*****************************************************************/
 
 
 static UTIL_SAFE_CAST_FUNCTION( local_driver , LOCAL_DRIVER_TYPE_ID )
+static UTIL_SAFE_CAST_FUNCTION_CONST( local_driver , LOCAL_DRIVER_TYPE_ID )
 UTIL_SAFE_CAST_FUNCTION( local_job    , LOCAL_JOB_TYPE_ID    )
+UTIL_SAFE_CAST_FUNCTION_CONST( local_job    , LOCAL_JOB_TYPE_ID    )
 
 
 local_job_type * local_job_alloc() {
   local_job_type * job;
   job = util_malloc(sizeof * job );
   UTIL_TYPE_ID_INIT( job , LOCAL_JOB_TYPE_ID );
-  job->active = false;
-  job->status = JOB_QUEUE_WAITING;
+  job->active        = false;
+  job->orphan        = false;
+  job->kill_requested = false;
+  job->status        = JOB_QUEUE_WAITING;
+  job->child_process = 0;
+  job->exit_code     = -1;
+  job->executable    = NULL;
+  job->argc          = 0;
+  job->argv          = NULL;
+  job->driver        = NULL;
+  memset( &job->rusage , 0 , sizeof job->rusage );
+  memset( &job->start_time , 0 , sizeof job->start_time );
+  memset( &job->end_time , 0 , sizeof job->end_time );
   return job;
 }
 
 void local_job_free(local_job_type * job) {
-  if (job->active) {
-    /* Thread clean up */
-  }
+  util_safe_free( job->executable );
+  if (job->argv != NULL)
+    util_free_stringlist( job->argv , job->argc );
   free(job);
 }
 
 
+/**
+   The exit code of the job; -1 if the job has not completed, and
+   128 + signal number if the job was terminated by a signal.
+*/
 
-job_status_type local_driver_get_job_status(void * __driver, void * __job) {
-  if (__job == NULL) 
-    /* The job has not been registered at all ... */
-    return JOB_QUEUE_NOT_ACTIVE;
-  else {
-    local_job_type * job = local_job_safe_cast( __job );
-    {
-      if (job->active == false) {
-        util_abort("%s: internal error - should not query status on inactive jobs \n" , __func__);
-        return JOB_QUEUE_NOT_ACTIVE; /* Dummy */
-      } else 
-        return job->status;
+int local_job_get_exit_code( const local_job_type * job ) {
+  return job->exit_code;
+}
+
+
+double local_job_get_cpu_seconds( const local_job_type * job ) {
+  return job->rusage.ru_utime.tv_sec + job->rusage.ru_stime.tv_sec + 1e-6 * (job->rusage.ru_utime.tv_usec + job->rusage.ru_stime.tv_usec);
+}
+
+
+/* Peak resident set size of the job in kB. */
+long local_job_get_max_rss( const local_job_type * job ) {
+  return job->rusage.ru_maxrss;
+}
+
+
+/*****************************************************************/
+
+
+static int local_driver_num_cpu( ) {
+  long num_cpu = sysconf( _SC_NPROCESSORS_ONLN );
+  return (num_cpu > 0) ? num_cpu : 1;
+}
+
+
+/**
+   Must be called with the driver lock held. The process setup which
+   must be done in the child (nice, limits, affinity) is done between
+   fork() and exec(); only async-signal-safe functions are used there.
+*/
+
+static void local_driver_start_job( local_driver_type * driver , local_job_type * job ) {
+  const char ** argv = util_calloc( job->argc + 2 , sizeof * argv );
+  int cpu = -1;
+  pid_t pid;
+
+  argv[0] = job->executable;
+  for (int iarg = 0; iarg < job->argc; iarg++)
+    argv[iarg + 1] = job->argv[iarg];
+  argv[job->argc + 1] = NULL;
+
+  if (driver->cpu_affinity) {
+    cpu = driver->next_cpu;
+    driver->next_cpu = (driver->next_cpu + 1) % local_driver_num_cpu( );
+  }
+
+  pid = fork();
+  if (pid == -1)
+    util_abort("%s: fork() failed when trying to run:%s  %s \n",__func__ , job->executable , strerror( errno ));
+
+  if (pid == 0) {
+    /* This is the child */
+    if (nice(19) == -1) {
+      /* Not critical. */
+    }
+
+    if (driver->max_memory > 0) {
+      struct rlimit limit;
+      limit.rlim_cur = (rlim_t) driver->max_memory * 1024 * 1024;
+      limit.rlim_max = limit.rlim_cur;
+      setrlimit( RLIMIT_AS , &limit );
+    }
+
+#ifdef CPU_SET
+    if (cpu >= 0) {
+      cpu_set_t cpu_set;
+      CPU_ZERO( &cpu_set );
+      CPU_SET( cpu , &cpu_set );
+      sched_setaffinity( 0 , sizeof cpu_set , &cpu_set );
     }
+#endif
+
+    execvp( job->executable , (char **) argv );
+    _exit( 127 );  /* Exec failed - reported as a failed job. */
   }
+
+  free( argv );
+  gettimeofday( &job->start_time , NULL );
+  job->child_process = pid;
+  job->status        = JOB_QUEUE_RUNNING;
+  vector_append_ref( driver->running , job );
+  pthread_cond_signal( &driver->work_cond );
 }
 
 
+/* Must be called with the driver lock held. */
+static void local_driver_start_pending( local_driver_type * driver ) {
+  while ((vector_get_size( driver->pending ) > 0) &&
+         ((driver->max_processes <= 0) || (vector_get_size( driver->running ) < driver->max_processes))) {
+    local_job_type * job = vector_iget( driver->pending , 0 );
+    vector_idel( driver->pending , 0 );
+    local_driver_start_job( driver , job );
+  }
+}
 
-void local_driver_free_job( void * __job ) {
-  local_job_type    * job    = local_job_safe_cast( __job );
-  local_job_free(job);
+
+/* Must be called with the driver lock held. */
+static int local_driver_find_running( const local_driver_type * driver , pid_t pid ) {
+  for (int index = 0; index < vector_get_size( driver->running ); index++) {
+    const local_job_type * job = vector_iget_const( driver->running , index );
+    if (job->child_process == pid)
+      return index;
+  }
+  return -1;
 }
 
 
-void local_driver_kill_job( void * __driver , void * __job) {
-  local_job_type    * job  = local_job_safe_cast( __job );
-  
-  kill( job->child_process , SIGSTOP );
-  if (job->active) 
-    pthread_cancel( job->run_thread );
-  
+static void local_job_set_exit_status( local_job_type * job , int status ) {
+  if (WIFEXITED( status ))
+    job->exit_code = WEXITSTATUS( status );
+  else if (WIFSIGNALED( status ))
+    job->exit_code = 128 + WTERMSIG( status );
+  else
+    job->exit_code = 255;
+
+  if (job->kill_requested)
+    job->status = JOB_QUEUE_USER_KILLED;
+  else
+    job->status = (job->exit_code == 0) ? JOB_QUEUE_DONE : JOB_QUEUE_EXIT;
 }
 
 
+/* Must be called with the driver lock held. */
+static void local_driver_timed_wait( local_driver_type * driver ) {
+  struct timeval  now;
+  struct timespec timeout;
+  long nsec;
 
+  gettimeofday( &now , NULL );
+  nsec = 1000L * (now.tv_usec + LOCAL_DRIVER_POLL_USEC);
+  timeout.tv_sec  = now.tv_sec + nsec / 1000000000L;
+  timeout.tv_nsec = nsec % 1000000000L;
+  pthread_cond_timedwait( &driver->work_cond , &driver->lock , &timeout );
+}
 
 
+/*
+  Checks all the running processes once with wait4( WNOHANG ); returns
+  the number of jobs which have completed. Must be called with the
+  driver lock held.
+*/
 
+static int local_driver_reap_running( local_driver_type * driver ) {
+  int num_reaped = 0;
+  int index = 0;
+
+  while (index < vector_get_size( driver->running )) {
+    local_job_type * job = vector_iget( driver->running , index );
+    struct rusage rusage;
+    int status;
+    pid_t pid = wait4( job->child_process , &status , WNOHANG , &rusage );
+
+    if (pid == job->child_process) {
+      gettimeofday( &job->end_time , NULL );
+      job->rusage = rusage;
+      local_job_set_exit_status( job , status );
+    } else if ((pid == -1) && (errno == ECHILD)) {
+      /* The process has been reaped by someone else; the exit status is lost. */
+      job->exit_code = 255;
+      job->status    = job->kill_requested ? JOB_QUEUE_USER_KILLED : JOB_QUEUE_EXIT;
+    } else {
+      index++;
+      continue;
+    }
 
+    vector_idel( driver->running , index );
+    job->driver = NULL;
+    if (job->orphan)
+      local_job_free( job );
+    num_reaped++;
+  }
+  return num_reaped;
+}
 
-void * submit_job_thread__(void * __arg) {
-  arg_pack_type * arg_pack = arg_pack_safe_cast(__arg);
-  const char * executable  = arg_pack_iget_const_ptr(arg_pack , 0);
-  /*
-    The arg_pack contains a run_path field as the second argument,
-    it has therefor been left here as a comment:
-    
-    const char * run_path    = arg_pack_iget_const_ptr(arg_pack , 1);   
-  */
-  int          argc        = arg_pack_iget_int(arg_pack , 2);
-  char ** argv             = arg_pack_iget_ptr(arg_pack , 3);
-  local_job_type * job     = arg_pack_iget_ptr(arg_pack , 4);
-  
-  job->child_process = util_fork_exec(executable , argc , (const char **) argv , false , NULL , NULL /* run_path */ , NULL , NULL , NULL); 
-  waitpid(job->child_process , NULL , 0);
-  job->status = JOB_QUEUE_DONE;
-  pthread_exit(NULL);
-  util_free_stringlist( argv , argc );
+
+static void * local_driver_reaper__( void * arg ) {
+  local_driver_type * driver = local_driver_safe_cast( arg );
+
+  pthread_mutex_lock( &driver->lock );
+  while (true) {
+    if (vector_get_size( driver->running ) == 0) {
+      if (driver->shutdown)
+        break;
+      pthread_cond_wait( &driver->work_cond , &driver->lock );
+      continue;
+    }
+
+    if (local_driver_reap_running( driver ) > 0)
+      local_driver_start_pending( driver );
+    else
+      local_driver_timed_wait( driver );
+  }
+  pthread_mutex_unlock( &driver->lock );
   return NULL;
 }
 
 
+/*****************************************************************/
+
+
+job_status_type local_driver_get_job_status(void * __driver, void * __job) {
+  if (__job == NULL) 
+    /* The job has not been registered at all ... */
+    return JOB_QUEUE_NOT_ACTIVE;
+  else {
+    local_driver_type * driver = local_driver_safe_cast( __driver );
+    local_job_type * job = local_job_safe_cast( __job );
+    job_status_type status;
+
+    if (job->active == false) 
+      util_abort("%s: internal error - should not query status on inactive jobs \n" , __func__);
+
+    pthread_mutex_lock( &driver->lock );
+    status = job->status;
+    pthread_mutex_unlock( &driver->lock );
+    return status;
+  }
+}
+
+
+/**
+   The resource usage is only available when the process has been
+   reaped, i.e. when the job has status DONE or EXIT. The block I/O
+   counters from getrusage() are in units of 512 bytes.
+*/
+
+bool local_driver_get_job_resource(void * __driver , void * __job , job_resource_type * resource) {
+  local_driver_type * driver = local_driver_safe_cast( __driver );
+  local_job_type * job = local_job_safe_cast( __job );
+  bool complete;
+
+  pthread_mutex_lock( &driver->lock );
+  complete = (job->status & (JOB_QUEUE_DONE + JOB_QUEUE_EXIT)) && (job->end_time.tv_sec > 0);
+  if (complete) {
+    job_resource_set_cpu_seconds( resource , local_job_get_cpu_seconds( job ));
+    job_resource_set_max_rss( resource , local_job_get_max_rss( job ));
+    job_resource_set_read_bytes( resource , 512L * job->rusage.ru_inblock );
+    job_resource_set_write_bytes( resource , 512L * job->rusage.ru_oublock );
+    job_resource_set_wall_seconds( resource , (job->end_time.tv_sec - job->start_time.tv_sec) + 1e-6 * (job->end_time.tv_usec - job->start_time.tv_usec));
+  }
+  pthread_mutex_unlock( &driver->lock );
+  return complete;
+}
+
+
+/**
+   The job_queue will normally free the job after it has completed;
+   if the process is still running the job is left to the reaper
+   thread which will free it when the process exits.
+*/
+
+void local_driver_free_job( void * __job ) {
+  local_job_type    * job    = local_job_safe_cast( __job );
+  local_driver_type * driver = job->driver;
+  bool orphan = false;
+
+  if (driver != NULL) {
+    pthread_mutex_lock( &driver->lock );
+    if (local_driver_find_running( driver , job->child_process ) >= 0) {
+      job->orphan = true;
+      orphan = true;
+    } else {
+      for (int index = 0; index < vector_get_size( driver->pending ); index++) {
+        if (vector_iget( driver->pending , index ) == job) {
+          vector_idel( driver->pending , index );
+          break;
+        }
+      }
+    }
+    pthread_mutex_unlock( &driver->lock );
+  }
+
+  if (!orphan)
+    local_job_free(job);
+}
+
+
+void local_driver_kill_job( void * __driver , void * __job) {
+  local_driver_type * driver = local_driver_safe_cast( __driver );
+  local_job_type    * job    = local_job_safe_cast( __job );
+
+  pthread_mutex_lock( &driver->lock );
+  if (job->status == JOB_QUEUE_PENDING) {
+    for (int index = 0; index < vector_get_size( driver->pending ); index++) {
+      if (vector_iget( driver->pending , index ) == job) {
+        vector_idel( driver->pending , index );
+        break;
+      }
+    }
+    job->status = JOB_QUEUE_USER_KILLED;
+    job->driver = NULL;
+  } else if (job->status == JOB_QUEUE_RUNNING) {
+    job->kill_requested = true;
+    kill( job->child_process , SIGKILL );
+  }
+  pthread_mutex_unlock( &driver->lock );
+}
+
 
 void * local_driver_submit_job(void * __driver           , 
                                const char *  submit_cmd  , 
@@ -150,29 +456,57 @@ void * local_driver_submit_job(void * __driver           ,
   local_driver_type * driver = local_driver_safe_cast( __driver );
   {
     local_job_type * job    = local_job_alloc();
-    arg_pack_type  * arg_pack = arg_pack_alloc();
-    arg_pack_append_const_ptr( arg_pack , submit_cmd);
-    arg_pack_append_const_ptr( arg_pack , run_path );
-    arg_pack_append_int( arg_pack , argc );
-    arg_pack_append_ptr( arg_pack , util_alloc_stringlist_copy( argv , argc ));   /* Due to conflict with threads and python GC we take a local copy. */
-    arg_pack_append_ptr( arg_pack , job );
+    job->executable = util_alloc_string_copy( submit_cmd );
+    job->argc       = argc;
+    job->argv       = util_alloc_stringlist_copy( argv , argc );   /* Due to conflict with threads and python GC we take a local copy. */
+    job->driver     = driver;
     
-    pthread_mutex_lock( &driver->submit_lock );
+    pthread_mutex_lock( &driver->lock );
     job->active = true;
-    job->status = JOB_QUEUE_RUNNING;
-    
-    if (pthread_create( &job->run_thread , &driver->thread_attr , submit_job_thread__ , arg_pack) != 0) 
-      util_abort("%s: failed to create run thread - aborting \n",__func__);
-    
-    pthread_mutex_unlock( &driver->submit_lock );
+    job->status = JOB_QUEUE_PENDING;
+
+    if (!driver->reaper_started) {
+      if (pthread_create( &driver->reaper_thread , NULL , local_driver_reaper__ , driver ) != 0) 
+        util_abort("%s: failed to create reaper thread - aborting \n",__func__);
+      driver->reaper_started = true;
+    }
+
+    vector_append_ref( driver->pending , job );
+    local_driver_start_pending( driver );
+    pthread_mutex_unlock( &driver->lock );
     return job;
   }
 }
 
 
+/**
+   Shutting down the driver will kill all the running processes.
+*/
 
 void local_driver_free(local_driver_type * driver) {
-  pthread_attr_destroy ( &driver->thread_attr );
+  pthread_mutex_lock( &driver->lock );
+  driver->shutdown = true;
+  for (int index = 0; index < vector_get_size( driver->pending ); index++) {
+    local_job_type * job = vector_iget( driver->pending , index );
+    job->driver = NULL;
+  }
+  vector_clear( driver->pending );
+  for (int index = 0; index < vector_get_size( driver->running ); index++) {
+    local_job_type * job = vector_iget( driver->running , index );
+    kill( job->child_process , SIGKILL );
+  }
+  pthread_cond_signal( &driver->work_cond );
+  pthread_mutex_unlock( &driver->lock );
+
+  if (driver->reaper_started)
+    pthread_join( driver->reaper_thread , NULL );
+
+  vector_free( driver->pending );
+  vector_free( driver->running );
+  pthread_cond_destroy( &driver->work_cond );
+  pthread_mutex_destroy( &driver->lock );
+  util_safe_free( driver->max_processes_string );
+  util_safe_free( driver->max_memory_string );
   free(driver);
   driver = NULL;
 }
@@ -187,24 +521,78 @@ void local_driver_free__(void * __driver) {
 void * local_driver_alloc() {
   local_driver_type * local_driver = util_malloc(sizeof * local_driver );
   UTIL_TYPE_ID_INIT( local_driver , LOCAL_DRIVER_TYPE_ID);
-  pthread_mutex_init( &local_driver->submit_lock , NULL );
-  pthread_attr_init( &local_driver->thread_attr );
-  pthread_attr_setdetachstate( &local_driver->thread_attr , PTHREAD_CREATE_DETACHED );
-  
+  pthread_mutex_init( &local_driver->lock , NULL );
+  pthread_cond_init( &local_driver->work_cond , NULL );
+  local_driver->reaper_started       = false;
+  local_driver->shutdown             = false;
+  local_driver->pending              = vector_alloc_new();
+  local_driver->running              = vector_alloc_new();
+  local_driver->cpu_affinity         = false;
+  local_driver->next_cpu             = 0;
+  local_driver->max_processes_string = NULL;
+  local_driver->max_memory_string    = NULL;
+
+  local_driver_set_option( local_driver , LOCAL_MAX_PROCESSES , "0" );
+  local_driver_set_option( local_driver , LOCAL_MAX_MEMORY , "0" );
   return local_driver;
 }
 
 
 bool local_driver_set_option( void * __driver , const char * option_key , const void * value){ 
-  return false;
+  local_driver_type * driver = local_driver_safe_cast( __driver );
+  bool option_set = true;
+  
+  pthread_mutex_lock( &driver->lock );
+  {
+    if (strcmp( LOCAL_MAX_PROCESSES , option_key ) == 0) {
+      int max_processes;
+      if (util_sscanf_int( value , &max_processes )) {
+        driver->max_processes = max_processes;
+        driver->max_processes_string = util_realloc_string_copy( driver->max_processes_string , value );
+        local_driver_start_pending( driver );
+      } else
+        option_set = false;
+    } else if (strcmp( LOCAL_MAX_MEMORY , option_key ) == 0) {
+      int max_memory;
+      if (util_sscanf_int( value , &max_memory )) {
+        driver->max_memory = max_memory;
+        driver->max_memory_string = util_realloc_string_copy( driver->max_memory_string , value );
+      } else
+        option_set = false;
+    } else if (strcmp( LOCAL_CPU_AFFINITY , option_key ) == 0) 
+      option_set = util_sscanf_bool( value , &driver->cpu_affinity );
+    else
+      option_set = false;
+  }
+  pthread_mutex_unlock( &driver->lock );
+  return option_set;
 }
 
+
+const void * local_driver_get_option( const void * __driver , const char * option_key ) {
+  const local_driver_type * driver = local_driver_safe_cast_const( __driver );
+  {
+    if (strcmp( LOCAL_MAX_PROCESSES , option_key ) == 0)
+      return driver->max_processes_string;
+    else if (strcmp( LOCAL_MAX_MEMORY , option_key ) == 0)
+      return driver->max_memory_string;
+    else if (strcmp( LOCAL_CPU_AFFINITY , option_key ) == 0)
+      return driver->cpu_affinity ? "1" : "0";
+    else {
+      util_abort("%s: option_id:%s not recognized for LOCAL driver \n",__func__ , option_key);
+      return NULL;
+    }
+  }
+}
+
+
 void local_driver_init_option_list(stringlist_type * option_list) {
-  //No options specific for local driver; do nothing
+  stringlist_append_ref(option_list, LOCAL_MAX_PROCESSES);
+  stringlist_append_ref(option_list, LOCAL_MAX_MEMORY);
+  stringlist_append_ref(option_list, LOCAL_CPU_AFFINITY);
 }
 
 #undef LOCAL_DRIVER_ID  
 #undef LOCAL_JOB_ID    
 
 /*****************************************************************/
-
@@ -21,10 +21,12 @@
 #include <string.h>
 #include <pthread.h>
 #include <dlfcn.h>
+#include <sys/stat.h>
 
 #include <ert/util/util.h>
 #include <ert/util/hash.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/vector.h>
 
 #include <ert/job_queue/queue_driver.h>
 #include <ert/job_queue/lsf_driver.h>
@@ -114,6 +116,9 @@ struct lsf_job_struct {
   int         num_exec_host;
   char      **exec_host;
   char       * lsf_jobnr_char;  /* Used to look up the job status in the bjobs_cache hash table */
+  int          array_index;     /* The index of the job in an array job; 0 for ordinary jobs. For array jobs
+                                   lsf_jobnr is the id of the array, and lsf_jobnr_char is "jobnr[index]". */
+  queue_array_type * array;     /* The files of the array job; NULL for ordinary jobs. */
 };
 
 
@@ -124,6 +129,8 @@ struct lsf_driver_struct {
   char              * resource_request;
   char              * login_shell;
   pthread_mutex_t     submit_lock;
+  int                 array_count;        /* The number of array jobs submitted; used to name the array scripts. */
+  vector_type       * arrays;             /* The queue_array instances of the submitted arrays; released when the driver is freed. */
 
   lsf_submit_method_enum submit_method;
   
@@ -168,6 +175,8 @@ lsf_job_type * lsf_job_alloc() {
   job->exec_host     = NULL;
 
   job->lsf_jobnr_char = NULL;
+  job->array_index    = 0;
+  job->array          = NULL;
   UTIL_TYPE_ID_INIT( job , LSF_JOB_TYPE_ID);
   return job;
 }
@@ -175,6 +184,8 @@ lsf_job_type * lsf_job_alloc() {
 
 
 void lsf_job_free(lsf_job_type * job) {
+  if (job->array != NULL)
+    queue_array_release_job( job->array );
   util_safe_free(job->lsf_jobnr_char);
   util_free_stringlist(job->exec_host , job->num_exec_host);
   free(job);
@@ -437,6 +448,45 @@ static int lsf_driver_get_status__(lsf_driver_type * driver , const char * statu
 
 
 
+/*
+  The elements of an array job all have the same job id; the index of
+  the element is found at the end of the JOB_NAME column as
+  name[index]. The column is located from the header line of the
+  bjobs output, and extends to the SUBMIT_TIME column; the other
+  columns, e.g. the host names, are not searched. Returns 0 if the
+  line is not an element of an array job.
+*/
+
+static int lsf_driver_parse_array_index(const char * line, int name_offset, int time_offset) {
+  int array_index = 0;
+  int line_length = strlen( line );
+
+  if ((name_offset >= 0) && (name_offset < line_length)) {
+    int start = name_offset;
+    int end   = ((time_offset > name_offset) && (time_offset < line_length)) ? time_offset : line_length;
+
+    /* The name can be wider than the header; back up to the start of it. */
+    while ((start > 0) && (line[start - 1] != ' '))
+      start--;
+
+    while ((end > start) && (line[end - 1] == ' '))
+      end--;
+
+    if ((end > start) && (line[end - 1] == ']')) {
+      char * job_name      = util_alloc_substring_copy( line , start , end - start );
+      const char * bracket = strrchr( job_name , '[' );
+      int index;
+      char tail;
+      if ((bracket != NULL) && (sscanf( bracket , "[%d%c" , &index , &tail) == 2) && (tail == ']') && (index > 0))
+        array_index = index;
+      free( job_name );
+    }
+  }
+  return array_index;
+}
+
+
+
 static void lsf_driver_update_bjobs_table(lsf_driver_type * driver) {
   char * tmp_file   = util_alloc_tmp_file("/tmp" , "enkf-bjobs" , true);
 
@@ -459,8 +509,21 @@ static void lsf_driver_update_bjobs_table(lsf_driver_type * driver) {
     char status[16];
     FILE *stream = util_fopen(tmp_file , "r");;
     bool at_eof = false;
+    int name_offset = -1;
+    int time_offset = -1;
     hash_clear(driver->bjobs_cache);
-    util_fskip_lines(stream , 1);
+    {
+      char * header = util_fscanf_alloc_line(stream , &at_eof);
+      if (header != NULL) {
+        const char * name_column = strstr( header , "JOB_NAME" );
+        const char * time_column = strstr( header , "SUBMIT_TIME" );
+        if (name_column != NULL)
+          name_offset = name_column - header;
+        if (time_column != NULL)
+          time_offset = time_column - header;
+        free( header );
+      }
+    }
     while (!at_eof) {
       char * line = util_fscanf_alloc_line(stream , &at_eof);
       if (line != NULL) {
@@ -469,6 +532,12 @@ static void lsf_driver_update_bjobs_table(lsf_driver_type * driver) {
         if (sscanf(line , "%d %s %s", &job_id_int , user , status) == 3) {
           char * job_id = util_alloc_sprintf("%d" , job_id_int);
 
+          {
+            int array_index = lsf_driver_parse_array_index( line , name_offset , time_offset );
+            if (array_index > 0)
+              job_id = util_realloc_sprintf( job_id , "%d[%d]" , job_id_int , array_index );
+          }
+
           if (hash_has_key( driver->my_jobs , job_id ))   /* Consider only jobs submitted by this ERT instance - not old jobs lying around from the same user. */
             hash_insert_int(driver->bjobs_cache , job_id , lsf_driver_get_status__( driver , status , job_id));
           
@@ -629,6 +698,109 @@ job_status_type lsf_driver_get_job_status(void * __driver , void * __job) {
 
 
 
+#ifdef HAVE_LSF_LIBRARY
+static bool lsf_driver_get_job_resource_library(lsf_driver_type * driver , lsf_job_type * job , job_resource_type * resource) {
+  bool found = false;
+  if (lsb_openjob( driver->lsb , job->lsf_jobnr) == 1) {
+    struct jobInfoEnt *job_info = lsb_readjob( driver->lsb );
+    job_resource_set_cpu_seconds( resource , job_info->cpuTime );
+    job_resource_set_max_rss( resource , job_info->runRusage.mem );
+    if ((job_info->startTime > 0) && (job_info->endTime >= job_info->startTime))
+      job_resource_set_wall_seconds( resource , difftime( job_info->endTime , job_info->startTime ));
+    lsb_closejob(driver->lsb);
+    found = true;
+  }
+  return found;
+}
+#endif
+
+
+/*
+  Parses the output from 'bjobs -l <jobnr>'; the relevant lines
+  look like:
+
+     The CPU time used is 1234.5 seconds.
+     MAX MEM: 812 Mbytes;  AVG MEM: 755 Mbytes
+
+  The memory is reported in kB.
+*/
+
+static bool lsf_driver_parse_bjobs_long( const char * content , job_resource_type * resource) {
+  bool found = false;
+  {
+    const char * cpu_line = strstr( content , "The CPU time used is" );
+    double cpu_seconds;
+    if (cpu_line != NULL && sscanf( cpu_line , "The CPU time used is %lf" , &cpu_seconds ) == 1) {
+      job_resource_set_cpu_seconds( resource , cpu_seconds );
+      found = true;
+    }
+  }
+
+  {
+    const char * mem_line = strstr( content , "MAX MEM:" );
+    double mem;
+    char unit[16];
+    if (mem_line != NULL && sscanf( mem_line , "MAX MEM: %lf %15[A-Za-z]" , &mem , unit ) == 2) {
+      if (strncmp( unit , "Gbytes" , 1) == 0)
+        mem *= 1024 * 1024;
+      else if (strncmp( unit , "Mbytes" , 1) == 0)
+        mem *= 1024;
+      job_resource_set_max_rss( resource , (long) mem );
+      found = true;
+    }
+  }
+  return found;
+}
+
+
+static bool lsf_driver_get_job_resource_shell(lsf_driver_type * driver , lsf_job_type * job , job_resource_type * resource) {
+  char * tmp_file = util_alloc_tmp_file("/tmp" , "enkf-bjobs-l" , true);
+  bool found = false;
+
+  if (driver->submit_method == LSF_SUBMIT_REMOTE_SHELL) {
+    char ** argv = util_calloc( 2 , sizeof * argv);
+    argv[0] = driver->remote_lsf_server;
+    argv[1] = util_alloc_sprintf("%s -l '%s'" , driver->bjobs_cmd , job->lsf_jobnr_char);
+    util_fork_exec(driver->rsh_cmd , 2 , (const char **) argv , true , NULL , NULL , NULL , tmp_file , NULL);
+    free( argv[1] );
+    free( argv );
+  } else if (driver->submit_method == LSF_SUBMIT_LOCAL_SHELL) {
+    const char * argv[2] = {"-l" , job->lsf_jobnr_char};
+    util_fork_exec(driver->bjobs_cmd , 2 , argv , true , NULL , NULL , NULL , tmp_file , NULL);
+  }
+
+  if (util_file_exists( tmp_file )) {
+    char * content = util_fread_alloc_file_content( tmp_file , NULL );
+    found = lsf_driver_parse_bjobs_long( content , resource );
+    free( content );
+    util_unlink_existing( tmp_file );
+  }
+  free( tmp_file );
+  return found;
+}
+
+
+/*
+  Called once for each job when it has completed. Observe that this
+  involves one call to bjobs for every job in the shell based modes.
+*/
+
+bool lsf_driver_get_job_resource(void * __driver , void * __job , job_resource_type * resource) {
+  lsf_driver_type * driver = lsf_driver_safe_cast( __driver );
+  lsf_job_type    * job    = lsf_job_safe_cast( __job );
+
+  if (driver->submit_method == LSF_SUBMIT_INTERNAL) {
+#ifdef HAVE_LSF_LIBRARY
+    return lsf_driver_get_job_resource_library( driver , job , resource );
+#else
+    return false;
+#endif
+  } else
+    return lsf_driver_get_job_resource_shell( driver , job , resource );
+}
+
+
+
 void lsf_driver_free_job(void * __job) {
   lsf_job_type    * job    = lsf_job_safe_cast( __job );
   lsf_job_free(job);
@@ -650,7 +822,7 @@ void lsf_driver_kill_job(void * __driver , void * __job) {
       if (driver->submit_method == LSF_SUBMIT_REMOTE_SHELL) {
         char ** argv = util_calloc( 2, sizeof * argv );
         argv[0] = driver->remote_lsf_server;
-        argv[1] = util_alloc_sprintf("%s %s" , driver->bkill_cmd , job->lsf_jobnr_char);
+        argv[1] = util_alloc_sprintf("%s '%s'" , driver->bkill_cmd , job->lsf_jobnr_char);
 
         util_fork_exec(driver->rsh_cmd , 2 , (const char **)  argv , true , NULL , NULL , NULL , NULL , NULL);
 
@@ -709,6 +881,99 @@ void * lsf_driver_submit_job(void * __driver ,
 
 
 
+/*
+  Submits num_jobs jobs as one LSF job array, i.e. with one call to
+  bsub -J "name[1-num_jobs]", where name is the name of the queue.
+  The array runs a script which uses $LSB_JOBINDEX to pick the
+  run_path and command of each element; the script and the LSF output
+  of the array are written to a separate directory for each ERT
+  process, and removed when all the elements have been freed or the
+  driver is freed, see queue_array_alloc(). The jobs are tracked
+  individually as jobnr[index].
+
+  Array jobs are only supported with the shell based submit methods;
+  with the library based submit false is returned and the jobs must
+  be submitted one by one.
+*/
+
+bool lsf_driver_submit_array(void * __driver ,
+                             int num_jobs ,
+                             const char ** submit_cmd ,
+                             int num_cpu ,
+                             const char ** run_path ,
+                             const char ** job_name ,
+                             const int * argc ,
+                             const char *** argv ,
+                             void ** job_data) {
+  lsf_driver_type * driver = lsf_driver_safe_cast( __driver );
+  lsf_driver_assert_submit_method( driver );
+  if (driver->submit_method == LSF_SUBMIT_INTERNAL)
+    return false;
+  else {
+    const char * name = (driver->queue_name != NULL) ? driver->queue_name : "ERT";
+    queue_array_type * array;
+    char * script_file;
+    char * lsf_stdout;
+    char * array_name;
+    long int array_id;
+
+    pthread_mutex_lock( &driver->submit_lock );
+    array = queue_array_alloc( run_path[0] , driver->array_count++ );
+    pthread_mutex_unlock( &driver->submit_lock );
+
+    script_file = queue_array_alloc_filename( array , ".sh" );
+    lsf_stdout  = queue_array_alloc_filename( array , ".%I.LSF-stdout" );
+    for (int i = 0; i < num_jobs; i++) {
+      char * element_ext    = util_alloc_sprintf( ".%d.LSF-stdout" , i + 1 );
+      char * element_stdout = queue_array_alloc_filename( array , element_ext );
+      free( element_stdout );
+      free( element_ext );
+    }
+
+    if (driver->submit_method == LSF_SUBMIT_REMOTE_SHELL)
+      array_name = util_alloc_sprintf("\"%s[1-%d]\"" , name , num_jobs );
+    else
+      array_name = util_alloc_sprintf("%s[1-%d]" , name , num_jobs );
+
+    {
+      FILE * stream = util_fopen( script_file , "w" );
+      queue_driver_fprintf_array_script( stream , "LSB_JOBINDEX" , "LSF-stdout" , num_jobs , submit_cmd , run_path , job_name , argc , argv );
+      fclose( stream );
+      chmod( script_file , S_IRWXU + S_IRGRP + S_IXGRP + S_IROTH + S_IXOTH );
+    }
+
+    pthread_mutex_lock( &driver->submit_lock );
+    array_id = lsf_driver_submit_shell_job( driver , lsf_stdout , array_name , script_file , num_cpu , 0 , NULL );
+    for (int i = 0; i < num_jobs; i++) {
+      if (array_id > 0) {
+        lsf_job_type * job  = lsf_job_alloc();
+        job->lsf_jobnr      = array_id;
+        job->array_index    = i + 1;
+        job->lsf_jobnr_char = util_alloc_sprintf("%ld[%d]" , array_id , i + 1);
+        job->array          = array;
+        queue_array_add_job( array );
+        hash_insert_ref( driver->my_jobs , job->lsf_jobnr_char , NULL );
+        job_data[i] = job;
+      } else
+        job_data[i] = NULL;
+    }
+    if (array_id > 0)
+      vector_append_owned_ref( driver->arrays , array , queue_array_release__ );
+    pthread_mutex_unlock( &driver->submit_lock );
+
+    /* The submit failed; the script is removed immediately. */
+    if (array_id <= 0)
+      queue_array_release( array );
+
+    free( array_name );
+    free( lsf_stdout );
+    free( script_file );
+    return (array_id > 0);
+  }
+}
+
+
+
 void lsf_driver_free(lsf_driver_type * driver ) {
   util_safe_free(driver->login_shell);
   util_safe_free(driver->queue_name);
@@ -722,6 +987,7 @@ void lsf_driver_free(lsf_driver_type * driver ) {
   hash_free(driver->status_map);
   hash_free(driver->bjobs_cache);
   hash_free(driver->my_jobs);
+  vector_free(driver->arrays);
   
 #ifdef HAVE_LSF_LIBRARY
   if (driver->lsb != NULL)
@@ -961,6 +1227,8 @@ void * lsf_driver_alloc( ) {
   lsf_driver->resource_request     = NULL;
   lsf_driver_set_bjobs_refresh_interval( lsf_driver , BJOBS_REFRESH_TIME );
   pthread_mutex_init( &lsf_driver->submit_lock , NULL );
+  lsf_driver->array_count          = 0;
+  lsf_driver->arrays               = vector_alloc_new();
 
   lsf_driver_lib_init( lsf_driver );
   lsf_driver_shell_init( lsf_driver );
@@ -18,8 +18,14 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include <ert/util/util.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/type_macros.h>
 
 #include <ert/job_queue/queue_driver.h>
 #include <ert/job_queue/lsf_driver.h>
@@ -65,6 +71,8 @@ struct queue_driver_struct {
   free_job_ftype * free_job;
   kill_job_ftype * kill_job;
   get_status_ftype * get_status;
+  get_resource_ftype * get_resource;
+  submit_array_ftype * submit_array;
   free_queue_driver_ftype * free_driver;
   set_option_ftype * set_option;
   get_option_ftype * get_option;
@@ -82,6 +90,9 @@ struct queue_driver_struct {
   int max_running; /* Possible to maintain different max_running values for different
                                         drivers; the value 0 is interpreted as no limit - i.e. the queue layer
                                         will (try) to send an unlimited number of jobs to the driver. */
+  char * submit_array_size_string;
+  int submit_array_size; /* The maximum number of jobs submitted as one array job; values < 2 mean
+                                        that the jobs are submitted one by one. */
 
 };
 
@@ -101,6 +112,24 @@ int queue_driver_get_max_running(const queue_driver_type * driver) {
   return driver->max_running;
 }
 
+void queue_driver_set_submit_array_size(queue_driver_type * driver, int submit_array_size) {
+  driver->submit_array_size_string = util_realloc_sprintf(driver->submit_array_size_string,"%d", submit_array_size);
+  driver->submit_array_size = submit_array_size;
+}
+
+/*
+  Returns the maximum number of jobs the queue layer should submit as
+  one array job; zero if the driver does not support array jobs, or
+  they have not been enabled with the SUBMIT_ARRAY_SIZE option.
+*/
+
+int queue_driver_get_submit_array_size(const queue_driver_type * driver) {
+  if ((driver->submit_array != NULL) && (driver->submit_array_size > 1))
+    return driver->submit_array_size;
+  else
+    return 0;
+}
+
 const char * queue_driver_get_name(const queue_driver_type * driver) {
   return driver->name;
 }
@@ -117,6 +146,14 @@ static bool queue_driver_set_generic_option__(queue_driver_type * driver, const
       }
       else
         option_set = false;
+    } else if (strcmp(SUBMIT_ARRAY_SIZE, option_key) == 0) {
+      int array_size_int = 0;
+      if (util_sscanf_int(value, &array_size_int)) {
+        queue_driver_set_submit_array_size(driver, array_size_int);
+        option_set = true;
+      }
+      else
+        option_set = false;
     } else
       option_set = false;
   }
@@ -126,6 +163,8 @@ static bool queue_driver_set_generic_option__(queue_driver_type * driver, const
 static void * queue_driver_get_generic_option__(queue_driver_type * driver, const char * option_key) {
   if (strcmp(MAX_RUNNING, option_key) == 0) {
     return driver->max_running_string;
+  } else if (strcmp(SUBMIT_ARRAY_SIZE, option_key) == 0) {
+    return driver->submit_array_size_string;
   } else {
     util_abort("%s: driver:%s does not support generic option %s\n", __func__, driver->name, option_key);
     return NULL;
@@ -135,6 +174,8 @@ static void * queue_driver_get_generic_option__(queue_driver_type * driver, cons
 static bool queue_driver_has_generic_option__(queue_driver_type * driver, const char * option_key) {
   if (strcmp(MAX_RUNNING, option_key) == 0)
     return true;
+  else if (strcmp(SUBMIT_ARRAY_SIZE, option_key) == 0)
+    return true;
   else
     return false;
 }
@@ -173,6 +214,8 @@ static queue_driver_type * queue_driver_alloc_empty() {
   driver->driver_type = NULL_DRIVER;
   driver->submit = NULL;
   driver->get_status = NULL;
+  driver->get_resource = NULL;
+  driver->submit_array = NULL;
   driver->kill_job = NULL;
   driver->free_job = NULL;
   driver->free_driver = NULL;
@@ -182,9 +225,11 @@ static queue_driver_type * queue_driver_alloc_empty() {
   driver->name = NULL;
   driver->data = NULL;
   driver->max_running_string = NULL;
+  driver->submit_array_size_string = NULL;
   driver->init_options = NULL;
 
   queue_driver_set_generic_option__(driver, MAX_RUNNING, "0");
+  queue_driver_set_generic_option__(driver, SUBMIT_ARRAY_SIZE, "0");
 
   return driver;
 }
@@ -207,6 +252,8 @@ queue_driver_type * queue_driver_alloc(job_driver_type type) {
     case LSF_DRIVER:
       driver->submit = lsf_driver_submit_job;
       driver->get_status = lsf_driver_get_job_status;
+      driver->get_resource = lsf_driver_get_job_resource;
+      driver->submit_array = lsf_driver_submit_array;
       driver->kill_job = lsf_driver_kill_job;
       driver->free_job = lsf_driver_free_job;
       driver->free_driver = lsf_driver_free__;
@@ -220,9 +267,12 @@ queue_driver_type * queue_driver_alloc(job_driver_type type) {
     case LOCAL_DRIVER:
       driver->submit = local_driver_submit_job;
       driver->get_status = local_driver_get_job_status;
+      driver->get_resource = local_driver_get_job_resource;
       driver->kill_job = local_driver_kill_job;
       driver->free_job = local_driver_free_job;
       driver->free_driver = local_driver_free__;
+      driver->set_option = local_driver_set_option;
+      driver->get_option = local_driver_get_option;
       driver->name = util_alloc_string_copy("local");
       driver->init_options = local_driver_init_option_list;
       driver->data = local_driver_alloc();
@@ -230,6 +280,7 @@ queue_driver_type * queue_driver_alloc(job_driver_type type) {
     case RSH_DRIVER:
       driver->submit = rsh_driver_submit_job;
       driver->get_status = rsh_driver_get_job_status;
+      driver->get_resource = rsh_driver_get_job_resource;
       driver->kill_job = rsh_driver_kill_job;
       driver->free_job = rsh_driver_free_job;
       driver->free_driver = rsh_driver_free__;
@@ -242,6 +293,8 @@ queue_driver_type * queue_driver_alloc(job_driver_type type) {
     case TORQUE_DRIVER:
       driver->submit = torque_driver_submit_job;
       driver->get_status = torque_driver_get_job_status;
+      driver->get_resource = torque_driver_get_job_resource;
+      driver->submit_array = torque_driver_submit_array;
       driver->kill_job = torque_driver_kill_job;
       driver->free_job = torque_driver_free_job;
       driver->free_driver = torque_driver_free__;
@@ -289,6 +342,7 @@ const void * queue_driver_get_option(queue_driver_type * driver, const char * op
 void queue_driver_init_option_list(queue_driver_type * driver, stringlist_type * option_list) {
   //Add options common for all driver types
   stringlist_append_ref(option_list, MAX_RUNNING);
+  stringlist_append_ref(option_list, SUBMIT_ARRAY_SIZE);
   
   //Add options for the specific driver type
   if (driver->init_options) 
@@ -349,6 +403,236 @@ job_status_type queue_driver_get_status(queue_driver_type * driver, void * job_d
   return status;
 }
 
+/*
+  Submits num_jobs jobs as one array job; the job_data of the
+  individual jobs are returned in the job_data array. Returns false,
+  without submitting anything, if the driver can not submit the jobs
+  as an array job in the current configuration; the calling scope
+  should then submit the jobs one by one.
+*/
+
+bool queue_driver_submit_array(queue_driver_type * driver, int num_jobs, const char ** run_cmd, int num_cpu, const char ** run_path, const char ** job_name, const int * argc, const char *** argv, void ** job_data) {
+  if (queue_driver_get_submit_array_size(driver) > 0)
+    return driver->submit_array(driver->data, num_jobs, run_cmd, num_cpu, run_path, job_name, argc, argv, job_data);
+  else
+    return false;
+}
+
+
+static void queue_driver_fprintf_quoted(FILE * stream, const char * string) {
+  fputc('\'', stream);
+  for (const char * c = string; *c != '\0'; c++) {
+    if (*c == '\'')
+      fprintf(stream, "'\\''");
+    else
+      fputc(*c, stream);
+  }
+  fputc('\'', stream);
+}
+
+
+/*
+  The files of the array jobs (the script, and the output of the
+  queue system) are not written to the run_path of any of the jobs,
+  but to the directory .ert_array.<pid> in the parent directory of
+  the first run_path; i.e. next to the run paths of the realisations.
+
+  The queue_array instance keeps track of the files of one array; it
+  is shared by the job_data of all the elements and by the driver
+  which submitted the array:
+
+    queue_array_add_job()     : Called by the driver for every element.
+    queue_array_release_job() : Called when the job_data of an element
+                                is freed; when the last element is
+                                released the files are removed.
+    queue_array_release()     : Called by the driver when the array is
+                                no longer needed, i.e. when the submit
+                                failed or the driver is freed; the files
+                                are removed unconditionally.
+
+  The instance is freed when both the driver and all the elements have
+  released it. The .ert_array.<pid> directory is removed when the
+  last array in it has removed its files.
+*/
+
+#define QUEUE_ARRAY_TYPE_ID 66120443
+
+struct queue_array_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char            * array_path;
+  int               batch_nr;
+  stringlist_type * files;        /* The files to remove when the array is complete. */
+  int               num_jobs;     /* The number of elements still holding a reference. */
+  bool              driver_ref;   /* The driver still holds a reference. */
+  pthread_mutex_t   lock;
+};
+
+
+static UTIL_SAFE_CAST_FUNCTION( queue_array , QUEUE_ARRAY_TYPE_ID )
+
+
+queue_array_type * queue_array_alloc(const char * run_path, int batch_nr) {
+  queue_array_type * array = util_malloc( sizeof * array );
+  UTIL_TYPE_ID_INIT( array , QUEUE_ARRAY_TYPE_ID );
+  {
+    char * parent_path = util_alloc_abs_path(run_path);
+    /* util_split_alloc_dirname() returns the path itself for an existing directory. */
+    int length = strlen(parent_path);
+    while ((length > 1) && (parent_path[length - 1] == UTIL_PATH_SEP_CHAR))
+      length--;
+    while ((length > 0) && (parent_path[length - 1] != UTIL_PATH_SEP_CHAR))
+      length--;
+    if (length > 1)
+      length--;
+    parent_path[length] = '\0';
+
+    array->array_path = util_alloc_sprintf("%s%c.ert_array.%d", parent_path, UTIL_PATH_SEP_CHAR, getpid());
+    free(parent_path);
+  }
+  util_make_path( array->array_path );
+  array->batch_nr   = batch_nr;
+  array->files      = stringlist_alloc_new();
+  array->num_jobs   = 0;
+  array->driver_ref = true;
+  pthread_mutex_init( &array->lock , NULL );
+  return array;
+}
+
+
+/*
+  Returns the filename <array_path>/<batch_nr><ext>; the file is
+  removed with the array. The ext may contain the placeholder %I of
+  the queue system, the files of the individual elements must then be
+  registered with queue_array_add_file().
+*/
+
+char * queue_array_alloc_filename(queue_array_type * array, const char * ext) {
+  char * filename = util_alloc_sprintf("%s%c%d%s", array->array_path, UTIL_PATH_SEP_CHAR, array->batch_nr, ext);
+  queue_array_add_file( array , filename );
+  return filename;
+}
+
+
+void queue_array_add_file(queue_array_type * array, const char * filename) {
+  pthread_mutex_lock( &array->lock );
+  stringlist_append_copy( array->files , filename );
+  pthread_mutex_unlock( &array->lock );
+}
+
+
+void queue_array_add_job(queue_array_type * array) {
+  pthread_mutex_lock( &array->lock );
+  array->num_jobs++;
+  pthread_mutex_unlock( &array->lock );
+}
+
+
+/* Must be called with the lock held. */
+static void queue_array_remove_files(queue_array_type * array) {
+  for (int i = 0; i < stringlist_get_size( array->files ); i++)
+    util_unlink_existing( stringlist_iget( array->files , i ));
+  stringlist_clear( array->files );
+
+  /* Fails as long as other arrays have files in the directory. */
+  rmdir( array->array_path );
+}
+
+
+static void queue_array_free(queue_array_type * array) {
+  pthread_mutex_destroy( &array->lock );
+  stringlist_free( array->files );
+  free( array->array_path );
+  free( array );
+}
+
+
+static void queue_array_release_ref(queue_array_type * array, bool release_driver) {
+  bool free_array;
+
+  pthread_mutex_lock( &array->lock );
+  {
+    if (release_driver)
+      array->driver_ref = false;
+    else
+      array->num_jobs--;
+
+    if (release_driver || (array->num_jobs == 0))
+      queue_array_remove_files( array );
+
+    free_array = (!array->driver_ref && (array->num_jobs == 0));
+  }
+  pthread_mutex_unlock( &array->lock );
+
+  if (free_array)
+    queue_array_free( array );
+}
+
+
+void queue_array_release_job(queue_array_type * array) {
+  queue_array_release_ref( array , false );
+}
+
+
+void queue_array_release(queue_array_type * array) {
+  queue_array_release_ref( array , true );
+}
+
+
+void queue_array_release__(void * arg) {
+  queue_array_release( queue_array_safe_cast( arg ));
+}
+
+
+/*
+  Writes the shell script used by the drivers to run an array job.
+  The queue system starts the script once for every element, with
+  the element index 1,2,...,num_jobs in the environment variable
+  index_var; the script then changes to the run_path of that job and
+  execs the command with its arguments. If stdout_ext != NULL the
+  output of each job is redirected to the file job_name.stdout_ext
+  in its run_path.
+*/
+
+void queue_driver_fprintf_array_script(FILE * stream, const char * index_var, const char * stdout_ext, int num_jobs, const char ** run_cmd, const char ** run_path, const char ** job_name, const int * argc, const char *** argv) {
+  fprintf(stream, "#!/bin/sh\n");
+  fprintf(stream, "case $%s in\n", index_var);
+  for (int i = 0; i < num_jobs; i++) {
+    fprintf(stream, "%d)\n  cd ", i + 1);
+    queue_driver_fprintf_quoted(stream, run_path[i]);
+    fprintf(stream, " || exit 1\n  exec ");
+    queue_driver_fprintf_quoted(stream, run_cmd[i]);
+    for (int iarg = 0; iarg < argc[i]; iarg++) {
+      fputc(' ', stream);
+      queue_driver_fprintf_quoted(stream, argv[i][iarg]);
+    }
+    if (stdout_ext != NULL) {
+      char * stdout_file = util_alloc_filename(NULL, job_name[i], stdout_ext);
+      fprintf(stream, " > ");
+      queue_driver_fprintf_quoted(stream, stdout_file);
+      fprintf(stream, " 2>&1");
+      free(stdout_file);
+    }
+    fprintf(stream, "\n  ;;\n");
+  }
+  fprintf(stream, "esac\n");
+  fprintf(stream, "exit 1\n");
+}
+
+
+/*
+  Fills in the resources consumed by a completed job; returns false
+  if the driver does not support resource accounting. The resource
+  record must be reset by the calling scope, the driver only sets the
+  quantities it knows about.
+*/
+
+bool queue_driver_get_resource(queue_driver_type * driver, void * job_data, job_resource_type * resource) {
+  if (driver->get_resource)
+    return driver->get_resource(driver->data, job_data, resource);
+  else
+    return false;
+}
+
 void queue_driver_free_driver(queue_driver_type * driver) {
   driver->free_driver(driver->data);
 }
@@ -359,6 +643,7 @@ void queue_driver_free(queue_driver_type * driver) {
   queue_driver_free_driver(driver);
   util_safe_free(driver->name);
   util_safe_free(driver->max_running_string);
+  util_safe_free(driver->submit_array_size_string);
   free(driver);
 }
 
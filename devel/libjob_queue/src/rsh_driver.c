@@ -24,6 +24,7 @@
 #include <netdb.h>
 #include <pthread.h>
 #include <errno.h>
+#include <sys/time.h>
 
 #include <ert/util/util.h>
 #include <ert/util/arg_pack.h>
@@ -43,6 +44,8 @@ struct rsh_job_struct {
   pthread_t    run_thread;
   const char * host_name;    /* Currently not set */
   char       * run_path;
+  struct timeval start_time;
+  struct timeval end_time;
 };
 
 
@@ -153,7 +156,9 @@ static void rsh_host_submit_job(rsh_host_type * rsh_host , rsh_job_type * job, c
       argv[iarg + 2] = job_argv[iarg];
   }
   
+  gettimeofday( &job->start_time , NULL );
   util_fork_exec(rsh_cmd , argc , argv , true , NULL , NULL , NULL , NULL , NULL);   /* This call is blocking. */
+  gettimeofday( &job->end_time , NULL );
   job->status = JOB_QUEUE_DONE;
 
   pthread_mutex_lock( &rsh_host->host_mutex );
@@ -202,6 +207,8 @@ rsh_job_type * rsh_job_alloc(const char * run_path) {
   job->active     = false;
   job->status     = JOB_QUEUE_WAITING;
   job->run_path   = util_alloc_string_copy(run_path);
+  memset( &job->start_time , 0 , sizeof job->start_time );
+  memset( &job->end_time , 0 , sizeof job->end_time );
   UTIL_TYPE_ID_INIT( job , RSH_JOB_TYPE_ID );
   return job;
 }
@@ -234,6 +241,23 @@ job_status_type rsh_driver_get_job_status(void * __driver , void * __job) {
 
 
 
+/*
+  The rusage of the local rsh process says nothing about the remote
+  job, so the only resource the rsh driver can report is the wall
+  time.
+*/
+
+bool rsh_driver_get_job_resource(void * __driver , void * __job , job_resource_type * resource) {
+  rsh_job_type * job = rsh_job_safe_cast( __job );
+  if (job->status == JOB_QUEUE_DONE) {
+    job_resource_set_wall_seconds( resource , (job->end_time.tv_sec - job->start_time.tv_sec) + 1e-6 * (job->end_time.tv_usec - job->start_time.tv_usec));
+    return true;
+  } else
+    return false;
+}
+
+
+
 void rsh_driver_free_job( void * __job ) {
   rsh_job_type    * job    = rsh_job_safe_cast( __job );
   rsh_job_free(job);
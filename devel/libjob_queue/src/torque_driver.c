@@ -16,7 +16,13 @@
    for more details. 
  */
 #include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
 #include <ert/util/util.h>
+#include <ert/util/hash.h>
+#include <ert/util/vector.h>
 #include <ert/util/type_macros.h>
 #include <ert/job_queue/torque_driver.h>
 
@@ -36,12 +42,23 @@ struct torque_driver_struct {
   int num_cpus_per_node;
   int num_nodes;
 
+  int qstat_refresh_interval;
+  int missing_job_grace_time;
+  time_t last_qstat_update;
+  hash_type * my_jobs;          /* The jobs submitted by this driver instance; indexed by job number. */
+  hash_type * qstat_cache;      /* The status of the jobs from the last qstat call; indexed by job number. */
+  bool array_jobs;              /* Array jobs have been submitted; qstat must be called with -t to list the elements. */
+  int array_count;              /* The number of array jobs submitted; used to name the array scripts. */
+  vector_type * arrays;         /* The queue_array instances of the submitted arrays; released when the driver is freed. */
+  pthread_mutex_t qstat_mutex;  /* Protects my_jobs, qstat_cache, array_jobs, array_count, arrays and last_qstat_update. */
 };
 
 struct torque_job_struct {
   UTIL_TYPE_ID_DECLARATION;
   long int torque_jobnr;
   char * torque_jobnr_char;
+  time_t submit_time;
+  queue_array_type * array;     /* The script of the array job; NULL for ordinary jobs. */
 };
 
 UTIL_SAFE_CAST_FUNCTION(torque_driver, TORQUE_DRIVER_TYPE_ID);
@@ -63,6 +80,16 @@ void * torque_driver_alloc() {
   torque_driver->num_cpus_per_node = 1;
   torque_driver->num_nodes = 1;
 
+  torque_driver->last_qstat_update = 0;
+  torque_driver->missing_job_grace_time = TORQUE_DEFAULT_MISSING_JOB_GRACE_TIME;
+  torque_driver->array_jobs = false;
+  torque_driver->array_count = 0;
+  torque_driver->arrays = vector_alloc_new();
+  torque_driver->my_jobs = hash_alloc();
+  torque_driver->qstat_cache = hash_alloc();
+  pthread_mutex_init(&torque_driver->qstat_mutex, NULL);
+  torque_driver_set_qstat_refresh_interval(torque_driver, TORQUE_DEFAULT_QSTAT_REFRESH_INTERVAL);
+
   torque_driver_set_option(torque_driver, TORQUE_QSUB_CMD, TORQUE_DEFAULT_QSUB_CMD);
   torque_driver_set_option(torque_driver, TORQUE_QSTAT_CMD, TORQUE_DEFAULT_QSTAT_CMD);
   torque_driver_set_option(torque_driver, TORQUE_QDEL_CMD, TORQUE_DEFAULT_QDEL_CMD);
@@ -184,6 +211,8 @@ torque_job_type * torque_job_alloc() {
   job = util_malloc(sizeof * job);
   job->torque_jobnr_char = NULL;
   job->torque_jobnr = 0;
+  job->submit_time = time(NULL);
+  job->array = NULL;
   UTIL_TYPE_ID_INIT(job, TORQUE_JOB_TYPE_ID);
 
   return job;
@@ -191,6 +220,7 @@ torque_job_type * torque_job_alloc() {
 
 stringlist_type * torque_driver_alloc_cmd(torque_driver_type * driver,
         const char * job_name,
+        const char * array_range,
         const char * submit_script) {
 
 
@@ -218,6 +248,11 @@ stringlist_type * torque_driver_alloc_cmd(torque_driver_type * driver,
     stringlist_append_ref(argv, job_name);
   }
 
+  if (array_range != NULL) {
+    stringlist_append_ref(argv, "-t");
+    stringlist_append_ref(argv, array_range);
+  }
+
   stringlist_append_ref(argv, submit_script);
 
   return argv;
@@ -229,6 +264,10 @@ static int torque_job_parse_qsub_stdout(const torque_driver_type * driver, const
     FILE * stream = util_fopen(stdout_file, "r");
     char * jobid_string = util_fscanf_alloc_upto(stream, ".", false);
 
+    /* An array job is reported as 1234[].server */
+    if (jobid_string != NULL)
+      jobid_string[strcspn(jobid_string, "[")] = '\0';
+
     if (jobid_string == NULL || !util_sscanf_int(jobid_string, &jobid)) {
 
       char * file_content = util_fread_alloc_file_content(stdout_file, NULL);
@@ -261,24 +300,20 @@ void torque_job_create_submit_script(const char * script_filename, const char *
   util_fclose(script_file);
 }
 
-static int torque_driver_submit_shell_job(torque_driver_type * driver,
-        const char * run_path,
+static int torque_driver_qsub(torque_driver_type * driver,
         const char * job_name,
-        const char * submit_cmd,
-        int num_cpu,
-        int job_argc,
-        const char ** job_argv) {
+        const char * array_range,
+        const char * script_filename,
+        int num_cpu) {
   int job_id;
   char * tmp_file = util_alloc_tmp_file("/tmp", "enkf-submit", true);
-  char * script_filename = util_alloc_filename(run_path, "qsub_script", "sh");
-  torque_job_create_submit_script(script_filename, submit_cmd, job_argc, job_argv);
   {
     int p_units_from_driver = driver->num_cpus_per_node * driver->num_nodes;
     if (num_cpu != p_units_from_driver) {
       util_abort("%s: Error in config, job's config requires %d processing units, but config says %s: %d, and %s: %d, which multiplied becomes: %d \n",
               __func__, num_cpu, TORQUE_NUM_CPUS_PER_NODE, driver->num_cpus_per_node, TORQUE_NUM_NODES, driver->num_nodes, p_units_from_driver);
     }
-    stringlist_type * remote_argv = torque_driver_alloc_cmd(driver, job_name, script_filename);
+    stringlist_type * remote_argv = torque_driver_alloc_cmd(driver, job_name, array_range, script_filename);
     char ** argv = stringlist_alloc_char_ref(remote_argv);
     util_fork_exec(driver->qsub_cmd, stringlist_get_size(remote_argv), (const char **) argv, true, NULL, NULL, NULL, tmp_file, NULL);
 
@@ -294,8 +329,26 @@ static int torque_driver_submit_shell_job(torque_driver_type * driver,
   return job_id;
 }
 
+static int torque_driver_submit_shell_job(torque_driver_type * driver,
+        const char * run_path,
+        const char * job_name,
+        const char * submit_cmd,
+        int num_cpu,
+        int job_argc,
+        const char ** job_argv) {
+  char * script_filename = util_alloc_filename(run_path, "qsub_script", "sh");
+  int job_id;
+
+  torque_job_create_submit_script(script_filename, submit_cmd, job_argc, job_argv);
+  job_id = torque_driver_qsub(driver, job_name, NULL, script_filename, num_cpu);
+  free(script_filename);
+  return job_id;
+}
+
 void torque_job_free(torque_job_type * job) {
 
+  if (job->array != NULL)
+    queue_array_release_job(job->array);
   util_safe_free(job->torque_jobnr_char);
   free(job);
 }
@@ -320,9 +373,12 @@ void * torque_driver_submit_job(void * __driver,
     job->torque_jobnr_char = util_alloc_sprintf("%ld", job->torque_jobnr);
   }
 
-  if (job->torque_jobnr > 0)
+  if (job->torque_jobnr > 0) {
+    pthread_mutex_lock(&driver->qstat_mutex);
+    hash_insert_ref(driver->my_jobs, job->torque_jobnr_char, NULL);
+    pthread_mutex_unlock(&driver->qstat_mutex);
     return job;
-  else {
+  } else {
     /*
       The submit failed - the queue system shall handle
       NULL return values.
@@ -333,65 +389,305 @@ void * torque_driver_submit_job(void * __driver,
   }
 }
 
-static char* torque_driver_get_qstat_status(torque_driver_type * driver, char * jobnr_char) {
-  char * status = util_malloc(sizeof (char)*2);
-  char * tmp_file = util_alloc_tmp_file("/tmp", "enkf-qstat", true);
+/*
+  Submits num_jobs jobs as one array job with qsub -t 1-num_jobs,
+  named after the queue. The array runs a script which uses
+  $PBS_ARRAYID to pick the run_path and command of each element; the
+  script is written to a separate directory for each ERT process, and
+  removed when all the elements have been freed or the driver is
+  freed, see queue_array_alloc(). The elements are tracked
+  individually as jobnr[index], which is how they are listed by
+  qstat -t.
+*/
+
+bool torque_driver_submit_array(void * __driver,
+        int num_jobs,
+        const char ** submit_cmd,
+        int num_cpu,
+        const char ** run_path,
+        const char ** job_name,
+        const int * argc,
+        const char *** argv,
+        void ** job_data) {
+  torque_driver_type * driver = torque_driver_safe_cast(__driver);
+  const char * array_name = (driver->queue_name != NULL) ? driver->queue_name : "ERT";
+  char * array_range = util_alloc_sprintf("1-%d", num_jobs);
+  queue_array_type * array;
+  char * script_filename;
+  long int array_id;
+
+  pthread_mutex_lock(&driver->qstat_mutex);
+  array = queue_array_alloc(run_path[0], driver->array_count++);
+  pthread_mutex_unlock(&driver->qstat_mutex);
+  script_filename = queue_array_alloc_filename(array, ".sh");
 
   {
-    char ** argv = util_calloc(1, sizeof * argv);
-    argv[0] = jobnr_char;
+    FILE * stream = util_fopen(script_filename, "w");
+    queue_driver_fprintf_array_script(stream, "PBS_ARRAYID", NULL, num_jobs, submit_cmd, run_path, job_name, argc, argv);
+    fclose(stream);
+  }
 
-    util_fork_exec(driver->qstat_cmd, 1, (const char **) argv, true, NULL, NULL, NULL, tmp_file, NULL);
-    free(argv);
+  array_id = torque_driver_qsub(driver, array_name, array_range, script_filename, num_cpu);
+
+  pthread_mutex_lock(&driver->qstat_mutex);
+  for (int i = 0; i < num_jobs; i++) {
+    if (array_id > 0) {
+      torque_job_type * job = torque_job_alloc();
+      job->torque_jobnr = array_id;
+      job->torque_jobnr_char = util_alloc_sprintf("%ld[%d]", array_id, i + 1);
+      job->array = array;
+      queue_array_add_job(array);
+      hash_insert_ref(driver->my_jobs, job->torque_jobnr_char, NULL);
+      job_data[i] = job;
+    } else
+      job_data[i] = NULL;
+  }
+  if (array_id > 0) {
+    driver->array_jobs = true;
+    vector_append_owned_ref(driver->arrays, array, queue_array_release__);
   }
+  pthread_mutex_unlock(&driver->qstat_mutex);
 
-  FILE *stream = util_fopen(tmp_file, "r");
-  bool at_eof = false;
-  util_fskip_lines(stream, 2);
-  char * line = util_fscanf_alloc_line(stream, &at_eof);
-  fclose(stream);
-
-  if (line != NULL) {
-    char job_id_full_string[32];
-    if (sscanf(line, "%s %*s %*s %*s %s %*s", job_id_full_string, status) == 2) {
-      char *dotPtr = strchr(job_id_full_string, '.');
-      int dotPosition = dotPtr - job_id_full_string;
-      char* job_id_as_char_ptr = util_alloc_substring_copy(job_id_full_string, 0, dotPosition);
-      if (strcmp(job_id_as_char_ptr, jobnr_char) != 0) {
-        util_abort("%s: Job id input (%d) does not match the one found by qstat (%d)\n", __func__, jobnr_char, job_id_as_char_ptr);
+  /* The submit failed; the script is removed immediately. */
+  if (array_id <= 0)
+    queue_array_release(array);
+
+  free(array_range);
+  free(script_filename);
+  return (array_id > 0);
+}
+
+/*
+  The Torque job states are mapped as:
+
+    Q (queued), H (held), W (waiting for start time), T (in transit) -> PENDING
+    R (running), S (suspended), B (array job begun)                   -> RUNNING
+    E (exiting), C (completed), X (array element finished)            -> DONE
+
+  A suspended job is treated as running, as the LSF driver does.
+*/
+static job_status_type torque_driver_parse_status(const char * status) {
+  job_status_type result = JOB_QUEUE_FAILED;
+  if (strlen(status) != 1)
+    util_abort("%s: Unknown status found (%s).\n", __func__, status);
+
+  switch (status[0]) {
+  case 'Q':
+  case 'H':
+  case 'W':
+  case 'T':
+    result = JOB_QUEUE_PENDING;
+    break;
+  case 'R':
+  case 'S':
+  case 'B':
+    result = JOB_QUEUE_RUNNING;
+    break;
+  case 'E':
+  case 'C':
+  case 'X':
+    result = JOB_QUEUE_DONE;
+    break;
+  default:
+    util_abort("%s: Unknown status found (%s), expecting one of Q, H, W, T, R, S, B, E, C and X.\n", __func__, status);
+  }
+  return result;
+}
+
+/*
+  Runs one qstat command listing all the jobs, and updates the
+  qstat_cache table with the status of the jobs submitted by this
+  driver. The output is read directly from a pipe; it is expected to
+  be on the standard qstat format:
+
+    Job id                    Name             User            Time Use S Queue
+    ------------------------- ---------------- --------------- -------- - -----
+    1612427.st-lcmm           ...130getupdates fama            00:00:01 R normal
+*/
+
+static void torque_driver_update_qstat_table(torque_driver_type * driver) {
+  char * cmd = driver->array_jobs ? util_alloc_sprintf("%s -t", driver->qstat_cmd) : util_alloc_string_copy(driver->qstat_cmd);
+  FILE * stream = popen(cmd, "r");
+  if (stream == NULL)
+    util_abort("%s: failed to run: %s \n", __func__, cmd);
+
+  {
+    char line[512];
+    int line_nr = 0;
+    hash_clear(driver->qstat_cache);
+    /* The util_fscanf_xxx() functions need a seekable stream; a pipe is not. */
+    while (fgets(line, sizeof line, stream) != NULL) {
+      char job_id_full_string[64];
+      char status[16];
+
+      line_nr++;
+      if (line_nr <= 2)  /* The two header lines. */
+        continue;
+
+      if (sscanf(line, "%63s %*s %*s %*s %15s", job_id_full_string, status) == 2) {
+        char * job_id = util_alloc_substring_copy(job_id_full_string, 0, strcspn(job_id_full_string, "."));
+        if (hash_has_key(driver->my_jobs, job_id)) /* Consider only jobs submitted by this ERT instance. */
+          hash_insert_int(driver->qstat_cache, job_id, torque_driver_parse_status(status));
+        free(job_id);
       }
-      free(job_id_as_char_ptr);
     }
-    free(line);
-  } else {
-    util_abort("%s: Unable to read qstat's output line number 3 from file: %s", __func__, tmp_file);
   }
+  pclose(stream);
+  free(cmd);
+}
 
-  util_unlink_existing(tmp_file);
-  free(tmp_file);
-
+/*
+  Looks up one job with 'qstat -f <job>'. If the server does not know
+  the job any longer it has completed and been purged; it is reported
+  as DONE and the queue layer checks whether it actually succeeded.
+*/
+static job_status_type torque_driver_lookup_job_status(torque_driver_type * driver, const torque_job_type * job) {
+  char * cmd = util_alloc_sprintf("%s -f '%s' 2>/dev/null", driver->qstat_cmd, job->torque_jobnr_char);
+  FILE * stream = popen(cmd, "r");
+  job_status_type status = JOB_QUEUE_DONE;
+
+  if (stream != NULL) {
+    char line[512];
+    while (fgets(line, sizeof line, stream) != NULL) {
+      char key[64];
+      char value[64];
+
+      if (sscanf(line, " %63s = %63s", key, value) == 2 && util_string_equal(key, "job_state"))
+        status = torque_driver_parse_status(value);
+    }
+    pclose(stream);
+  }
+  free(cmd);
   return status;
 }
 
 job_status_type torque_driver_get_job_status(void * __driver, void * __job) {
   torque_driver_type * driver = torque_driver_safe_cast(__driver);
   torque_job_type * job = torque_job_safe_cast(__job);
-  char * status = torque_driver_get_qstat_status(driver, job->torque_jobnr_char);
-  int result = JOB_QUEUE_FAILED;
-  if (strcmp(status, "R") == 0) {
-    result = JOB_QUEUE_RUNNING;
-  } else if (strcmp(status, "E") == 0) {
-    result = JOB_QUEUE_DONE;
-  } else if (strcmp(status, "C") == 0) {
-    result = JOB_QUEUE_DONE;
-  } else if (strcmp(status, "Q") == 0) {
-    result = JOB_QUEUE_PENDING;
-  } else {
-    util_abort("%s: Unknown status found (%s), expecting one of R, E, C and Q.\n", __func__, status);
+  job_status_type status;
+
+  /*
+    The qstat_cache is refreshed with one qstat call at most every
+    qstat_refresh_interval seconds, the individual jobs are looked up
+    in the cache. The mutex protects the cache against concurrent
+    updates.
+  */
+  pthread_mutex_lock(&driver->qstat_mutex);
+  {
+    if (difftime(time(NULL), driver->last_qstat_update) >= driver->qstat_refresh_interval) {
+      torque_driver_update_qstat_table(driver);
+      driver->last_qstat_update = time(NULL);
+    }
+
+    if (hash_has_key(driver->qstat_cache, job->torque_jobnr_char))
+      status = hash_get_int(driver->qstat_cache, job->torque_jobnr_char);
+    else if (difftime(time(NULL), job->submit_time) < driver->missing_job_grace_time)
+      /* The job has just been submitted, and is not yet listed by qstat. */
+      status = JOB_QUEUE_PENDING;
+    else {
+      /*
+        The job should have been listed by now; it is looked up
+        individually and the result is cached until the next qstat
+        refresh.
+      */
+      status = torque_driver_lookup_job_status(driver, job);
+      hash_insert_int(driver->qstat_cache, job->torque_jobnr_char, status);
+    }
   }
-  free(status);
+  pthread_mutex_unlock(&driver->qstat_mutex);
 
-  return result;
+  return status;
+}
+
+/* Parses a duration on the form [[HH:]MM:]SS as reported by qstat -f. */
+static double torque_driver_parse_duration(const char * value) {
+  double seconds = 0;
+  const char * p = value;
+  while (true) {
+    char * end;
+    long field = strtol(p, &end, 10);
+    if (end == p)
+      break;
+    seconds = 60 * seconds + field;
+    if (*end != ':')
+      break;
+    p = end + 1;
+  }
+  return seconds;
+}
+
+/* Parses a memory size like 3288kb, and returns the size in kB. */
+static long torque_driver_parse_memory(const char * value) {
+  char * unit;
+  long size = strtol(value, &unit, 10);
+  if (util_string_equal(unit, "b"))
+    return size / 1024;
+  else if (util_string_equal(unit, "mb"))
+    return size * 1024;
+  else if (util_string_equal(unit, "gb"))
+    return size * 1024 * 1024;
+  else
+    return size;
+}
+
+/*
+  Runs 'qstat -f <job>' for one job and picks up the resources_used
+  fields:
+
+     resources_used.cput = 00:00:05
+     resources_used.mem = 3288kb
+     resources_used.walltime = 00:00:10
+
+  This is only called once for each job, when it has completed. If
+  the server has already purged the job nothing is set.
+*/
+
+bool torque_driver_get_job_resource(void * __driver, void * __job, job_resource_type * resource) {
+  torque_driver_type * driver = torque_driver_safe_cast(__driver);
+  torque_job_type * job = torque_job_safe_cast(__job);
+  char * cmd = util_alloc_sprintf("%s -f '%s'", driver->qstat_cmd, job->torque_jobnr_char);
+  FILE * stream = popen(cmd, "r");
+  bool found = false;
+
+  if (stream != NULL) {
+    char line[512];
+    while (fgets(line, sizeof line, stream) != NULL) {
+      char key[64];
+      char value[64];
+
+      if (sscanf(line, " %63s = %63s", key, value) == 2) {
+        if (util_string_equal(key, "resources_used.cput")) {
+          job_resource_set_cpu_seconds(resource, torque_driver_parse_duration(value));
+          found = true;
+        } else if (util_string_equal(key, "resources_used.walltime")) {
+          job_resource_set_wall_seconds(resource, torque_driver_parse_duration(value));
+          found = true;
+        } else if (util_string_equal(key, "resources_used.mem")) {
+          job_resource_set_max_rss(resource, torque_driver_parse_memory(value));
+          found = true;
+        }
+      }
+    }
+    pclose(stream);
+  }
+  free(cmd);
+  return found;
+}
+
+void torque_driver_set_qstat_refresh_interval(torque_driver_type * driver, int refresh_interval) {
+  driver->qstat_refresh_interval = refresh_interval;
+}
+
+int torque_driver_get_qstat_refresh_interval(const torque_driver_type * driver) {
+  return driver->qstat_refresh_interval;
+}
+
+void torque_driver_set_missing_job_grace_time(torque_driver_type * driver, int grace_time) {
+  driver->missing_job_grace_time = grace_time;
+}
+
+int torque_driver_get_missing_job_grace_time(const torque_driver_type * driver) {
+  return driver->missing_job_grace_time;
 }
 
 void torque_driver_kill_job(void * __driver, void * __job) {
@@ -399,6 +695,11 @@ void torque_driver_kill_job(void * __driver, void * __job) {
   torque_driver_type * driver = torque_driver_safe_cast(__driver);
   torque_job_type * job = torque_job_safe_cast(__job);
   util_fork_exec(driver->qdel_cmd, 1, (const char **) &job->torque_jobnr_char, true, NULL, NULL, NULL, NULL, NULL);
+
+  /* Force a qstat refresh on the next status query. */
+  pthread_mutex_lock(&driver->qstat_mutex);
+  driver->last_qstat_update = 0;
+  pthread_mutex_unlock(&driver->qstat_mutex);
 }
 
 void torque_driver_free(torque_driver_type * driver) {
@@ -409,6 +710,9 @@ void torque_driver_free(torque_driver_type * driver) {
   free(driver->qsub_cmd);
   free(driver->num_cpus_per_node_char);
   free(driver->num_nodes_char);
+  hash_free(driver->my_jobs);
+  hash_free(driver->qstat_cache);
+  vector_free(driver->arrays);
 
   free(driver);
   driver = NULL;
@@ -18,7 +18,10 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <dlfcn.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include <ert/util/int_vector.h>
 #include <ert/util/util.h>
@@ -27,6 +30,9 @@
 #include <ert/util/arg_pack.h>
 #include <ert/util/vector.h>
 #include <ert/util/subst_list.h>
+#include <ert/util/hash.h>
+#include <ert/util/buffer.h>
+#include <ert/util/thread_pool.h>
 
 #include <ert/config/config.h>
 
@@ -39,12 +45,43 @@
 #define WORKFLOW_COMMENT_STRING     "--"
 #define WORKFLOW_INCLUDE       "INCLUDE"
 
+#define CMD_PENDING  0
+#define CMD_RUNNING  1
+#define CMD_DONE     2
+
 typedef struct cmd_struct cmd_type;
 
+/*
+  The commands of a workflow are run in the order they appear in the
+  workflow file, unless they are given a name with the reserved
+  __STEP__ keyword:
+
+     __STEP__  quantiles
+     QUANTILES  ....
+     __STEP__  misfit
+     MISFIT     ....
+     __STEP__  export  quantiles misfit
+     EXPORT     ....
+
+  A named step only waits for the steps listed on the __STEP__ line;
+  i.e. in the example above QUANTILES and MISFIT are run concurrently,
+  and EXPORT when both have completed. A command without a __STEP__
+  line waits for all the commands before it, and all the commands
+  after it wait for it.
+
+  A workflow without __STEP__ lines is run serially on the calling
+  thread, exactly as before. In a workflow with steps the external
+  jobs, and the internal jobs marked THREAD_SAFE, are run on a thread
+  pool; the other internal jobs are run on the calling thread when no
+  other command is running.
+*/
+
 struct cmd_struct {
   UTIL_TYPE_ID_DECLARATION;
   const workflow_job_type * workflow_job;
   stringlist_type         * arglist;
+  char                    * name;        /* The STEP name - NULL for unnamed commands. */
+  int_vector_type         * depends;     /* The index of the commands this command must wait for. */
 };
 
 
@@ -56,9 +93,17 @@ struct workflow_struct {
   bool                   compiled;
   char                  * src_file; 
   vector_type           * cmd_list;
+  bool                    has_steps;      /* At least one command has been named with __STEP__. */
   workflow_joblist_type * joblist;
   config_error_type     * last_error;
   vector_type           * stack; 
+  int                     num_threads;
+  hash_type             * cache;          /* The return values of the cached commands, indexed by cmd_alloc_cache_key(). */
+  pthread_mutex_t         run_mutex;
+  pthread_cond_t          run_cond;
+  int_vector_type       * cmd_status;
+  void                 ** return_values;
+  int                     num_done;
 };
 
 /*****************************************************************/
@@ -69,6 +114,8 @@ static cmd_type * cmd_alloc( const workflow_job_type * workflow_job , const stri
   UTIL_TYPE_ID_INIT(cmd , CMD_TYPE_ID );
   cmd->workflow_job = workflow_job;
   cmd->arglist = stringlist_alloc_deep_copy( arglist );
+  cmd->name = NULL;
+  cmd->depends = int_vector_alloc( 0 , 0 );
   return cmd;
 }
 
@@ -76,6 +123,8 @@ static UTIL_SAFE_CAST_FUNCTION( cmd , CMD_TYPE_ID );
 
 static void cmd_free( cmd_type * cmd ){ 
   stringlist_free( cmd->arglist );
+  int_vector_free( cmd->depends );
+  util_safe_free( cmd->name );
   free( cmd );
 }
 
@@ -84,6 +133,45 @@ static void cmd_free__( void * arg ) {
   cmd_free( cmd );
 }
 
+
+/*
+  The cache key of a command is the job name and the arguments, along
+  with the modification time and size of all the arguments which are
+  existing files, and the modification time of the executable for
+  external jobs. The key is created after the command has completed,
+  so that a command which updates one of its arguments is not rerun
+  because of its own output.
+*/
+
+static void cmd_add_file_key( buffer_type * buffer , const char * filename ) {
+  if (util_file_exists( filename )) {
+    char * stamp = util_alloc_sprintf("@%ld:%ld" , (long) util_file_mtime( filename ) , (long) util_file_size( filename ));
+    buffer_fwrite( buffer , stamp , 1 , strlen( stamp ));
+    free( stamp );
+  }
+}
+
+
+static char * cmd_alloc_cache_key( const cmd_type * cmd ) {
+  buffer_type * buffer = buffer_alloc( 256 );
+  char * key;
+  
+  buffer_fwrite( buffer , workflow_job_get_name( cmd->workflow_job ) , 1 , strlen( workflow_job_get_name( cmd->workflow_job )));
+  if (workflow_job_get_executable( cmd->workflow_job ) != NULL)
+    cmd_add_file_key( buffer , workflow_job_get_executable( cmd->workflow_job ));
+  
+  for (int iarg = 0; iarg < stringlist_get_size( cmd->arglist ); iarg++) {
+    const char * arg = stringlist_iget( cmd->arglist , iarg );
+    buffer_fwrite_char( buffer , '\n' );
+    buffer_fwrite( buffer , arg , 1 , strlen( arg ));
+    cmd_add_file_key( buffer , arg );
+  }
+  buffer_fwrite_char( buffer , '\0' );
+  key = util_alloc_string_copy( buffer_get_data( buffer ));
+  buffer_free( buffer );
+  return key;
+}
+
 /*****************************************************************/
 
 static void workflow_add_cmd( workflow_type * workflow , cmd_type * cmd ) {
@@ -93,6 +181,7 @@ static void workflow_add_cmd( workflow_type * workflow , cmd_type * cmd ) {
 
 static void workflow_clear( workflow_type * workflow ) {
   vector_clear( workflow->cmd_list );
+  workflow->has_steps = false;
 }
 
 static void workflow_store_error( workflow_type * workflow , const config_error_type * error) {
@@ -145,17 +234,68 @@ static bool workflow_try_compile( workflow_type * script , const subst_list_type
       workflow_clear( script );
       config_clear( config_compiler );
       {
+        if (!config_has_schema_item( config_compiler , WORKFLOW_STEP_KEY )) {
+          config_schema_item_type * item = config_add_schema_item( config_compiler , WORKFLOW_STEP_KEY , false );
+          config_schema_item_set_argc_minmax( item , 1 , CONFIG_DEFAULT_ARG_MAX );
+        }
+        
         if (config_parse( config_compiler , src_file , WORKFLOW_COMMENT_STRING , WORKFLOW_INCLUDE , NULL , CONFIG_UNRECOGNIZED_ERROR , true )) {
+          config_error_type * error = config_error_alloc();
+          hash_type * step_index = hash_alloc();
+          const stringlist_type * step = NULL;
           int cmd_line;
           for (cmd_line = 0; cmd_line < config_get_content_size(config_compiler); cmd_line++) {
             const config_content_node_type * node = config_iget_content_node( config_compiler , cmd_line );
             const char * jobname = config_content_node_get_kw( node );
-            const workflow_job_type * job = workflow_joblist_get_job( script->joblist , jobname );
-            cmd_type * cmd = cmd_alloc( job , config_content_node_get_stringlist( node ));
             
-            workflow_add_cmd( script , cmd );
+            if (strcmp( jobname , WORKFLOW_STEP_KEY ) == 0) 
+              step = config_content_node_get_stringlist( node );
+            else {
+              const workflow_job_type * job = workflow_joblist_get_job( script->joblist , jobname );
+              cmd_type * cmd = cmd_alloc( job , config_content_node_get_stringlist( node ));
+              int icmd = vector_get_size( script->cmd_list );
+              
+              if (step != NULL) {
+                cmd->name = util_alloc_string_copy( stringlist_iget( step , 0 ));
+                for (int idep = 1; idep < stringlist_get_size( step ); idep++) {
+                  const char * dep = stringlist_iget( step , idep );
+                  if (hash_has_key( step_index , dep ))
+                    int_vector_append( cmd->depends , hash_get_int( step_index , dep ));
+                  else
+                    config_error_add( error , util_alloc_sprintf("Step:%s depends on unknown step:%s" , cmd->name , dep ));
+                }
+                
+                /* Named steps must also wait for the unnamed commands before them. */
+                for (int jcmd = 0; jcmd < icmd; jcmd++) {
+                  const cmd_type * prev = vector_iget_const( script->cmd_list , jcmd );
+                  if (prev->name == NULL)
+                    int_vector_append( cmd->depends , jcmd );
+                }
+                
+                if (hash_has_key( step_index , cmd->name ))
+                  config_error_add( error , util_alloc_sprintf("Step:%s defined twice" , cmd->name ));
+                hash_insert_int( step_index , cmd->name , icmd );
+                script->has_steps = true;
+                step = NULL;
+              } else {
+                for (int jcmd = 0; jcmd < icmd; jcmd++)
+                  int_vector_append( cmd->depends , jcmd );
+              }
+              
+              workflow_add_cmd( script , cmd );
+            }
           }
-          script->compiled = true;
+          
+          if (step != NULL)
+            config_error_add( error , util_alloc_sprintf("Step:%s is not followed by a command" , stringlist_iget( step , 0 )));
+          
+          if (config_error_count( error ) == 0)
+            script->compiled = true;
+          else
+            workflow_store_error( script , error );
+          
+          hash_free( step_index );
+          config_error_free( error );
         } else
           workflow_store_error( script , config_get_errors( config_compiler ));
       }
@@ -174,22 +314,223 @@ static bool workflow_try_compile( workflow_type * script , const subst_list_type
 }
 
 
+/*
+  Runs the command and, for jobs with the cache flag set, stores the
+  return value in the cache. The return value of a cached command is
+  returned again every time the command is skipped, i.e. it is shared
+  between the runs and must not be freed by the caller before the
+  cache is cleared.
+*/
+
+static void * workflow_run_cmd( workflow_type * workflow , int icmd , void * self , bool verbose ) {
+  const cmd_type * cmd = vector_iget_const( workflow->cmd_list , icmd );
+  void * return_value  = workflow_job_run( cmd->workflow_job , self , verbose , cmd->arglist );
+
+  if (workflow_job_get_cache( cmd->workflow_job )) {
+    char * cache_key = cmd_alloc_cache_key( cmd );
+    pthread_mutex_lock( &workflow->run_mutex );
+    hash_insert_ref( workflow->cache , cache_key , return_value );
+    pthread_mutex_unlock( &workflow->run_mutex );
+    free( cache_key );
+  }
+  return return_value;
+}
+
+
+static void workflow_complete_cmd( workflow_type * workflow , int icmd , void * return_value ) {
+  workflow->return_values[icmd] = return_value;
+  int_vector_iset( workflow->cmd_status , icmd , CMD_DONE );
+  workflow->num_done++;
+}
+
+
+static void * workflow_run_cmd__( void * arg ) {
+  arg_pack_type * arg_pack = arg_pack_safe_cast( arg );
+  workflow_type * workflow = arg_pack_iget_ptr( arg_pack , 0 );
+  int icmd                 = arg_pack_iget_int( arg_pack , 1 );
+  void * self              = arg_pack_iget_ptr( arg_pack , 2 );
+  bool verbose             = arg_pack_iget_bool( arg_pack , 3 );
+  void * return_value      = workflow_run_cmd( workflow , icmd , self , verbose );
+  
+  pthread_mutex_lock( &workflow->run_mutex );
+  workflow_complete_cmd( workflow , icmd , return_value );
+  pthread_cond_signal( &workflow->run_cond );
+  pthread_mutex_unlock( &workflow->run_mutex );
+  
+  arg_pack_free( arg_pack );
+  return NULL;
+}
+
+
+/*
+  Must be called with the run_mutex held. A command is ready when all
+  the commands it depends on are done.
+*/
+
+static bool workflow_cmd_ready( const workflow_type * workflow , const cmd_type * cmd ) {
+  for (int idep = 0; idep < int_vector_size( cmd->depends ); idep++) {
+    if (int_vector_iget( workflow->cmd_status , int_vector_iget( cmd->depends , idep )) != CMD_DONE)
+      return false;
+  }
+  return true;
+}
+
+
+/*
+  Internal jobs operate on the self pointer, and are not run
+  concurrently with other commands unless they are marked THREAD_SAFE.
+*/
+
+static bool workflow_cmd_exclusive( const cmd_type * cmd ) {
+  return workflow_job_internal( cmd->workflow_job ) && !workflow_job_get_thread_safe( cmd->workflow_job );
+}
+
+
+/*
+  A command with the cache flag set is skipped if the job has already
+  been run with the same arguments and input files; the return value
+  from that run is then returned in @return_value. Must be called with
+  the run_mutex held when commands are running on other threads.
+*/
+
+static bool workflow_cmd_cached( const workflow_type * workflow , const cmd_type * cmd , void ** return_value ) {
+  bool cached = false;
+  if (workflow_job_get_cache( cmd->workflow_job )) {
+    char * cache_key = cmd_alloc_cache_key( cmd );
+    if (hash_has_key( workflow->cache , cache_key )) {
+      *return_value = hash_get( workflow->cache , cache_key );
+      cached = true;
+    }
+    free( cache_key );
+  }
+  return cached;
+}
+
+
+static void workflow_run_serial( workflow_type * workflow , void * self , bool verbose ) {
+  for (int icmd = 0; icmd < vector_get_size( workflow->cmd_list ); icmd++) {
+    const cmd_type * cmd = vector_iget_const( workflow->cmd_list , icmd );
+    void * return_value;
+    
+    if (!workflow_cmd_cached( workflow , cmd , &return_value ))
+      return_value = workflow_run_cmd( workflow , icmd , self , verbose );
+    
+    vector_push_front_ref( workflow->stack , return_value );
+  }
+}
+
+
+static void workflow_run_steps( workflow_type * workflow , void * self , bool verbose ) {
+  const int num_cmd = vector_get_size( workflow->cmd_list );
+  thread_pool_type * pool = thread_pool_alloc( workflow->num_threads , true );
+  int_vector_type * ready = int_vector_alloc( 0 , 0 );
+  
+  int_vector_reset( workflow->cmd_status );
+  int_vector_iset( workflow->cmd_status , num_cmd - 1 , CMD_PENDING );
+  workflow->return_values = util_calloc( num_cmd , sizeof * workflow->return_values );
+  for (int icmd = 0; icmd < num_cmd; icmd++)
+    workflow->return_values[icmd] = NULL;
+  workflow->num_done = 0;
+  
+  pthread_mutex_lock( &workflow->run_mutex );
+  while (workflow->num_done < num_cmd) {
+    int num_running = 0;
+    int exclusive   = -1;   /* The first ready command which must run alone. */
+
+    int_vector_reset( ready );
+    for (int icmd = 0; icmd < num_cmd; icmd++) {
+      const cmd_type * cmd = vector_iget_const( workflow->cmd_list , icmd );
+      int status = int_vector_iget( workflow->cmd_status , icmd );
+
+      if (status == CMD_RUNNING)
+        num_running++;
+      else if ((status == CMD_PENDING) && workflow_cmd_ready( workflow , cmd )) {
+        void * return_value;
+        if (workflow_cmd_cached( workflow , cmd , &return_value ))
+          workflow_complete_cmd( workflow , icmd , return_value );
+        else if (workflow_cmd_exclusive( cmd )) {
+          if (exclusive < 0)
+            exclusive = icmd;
+        } else {
+          int_vector_iset( workflow->cmd_status , icmd , CMD_RUNNING );
+          int_vector_append( ready , icmd );
+        }
+      }
+    }
+    
+    if (int_vector_size( ready ) > 0) {
+      /* The lock is released while the commands are handed to the thread pool. */
+      pthread_mutex_unlock( &workflow->run_mutex );
+      for (int i = 0; i < int_vector_size( ready ); i++) {
+        arg_pack_type * arg_pack = arg_pack_alloc();
+        arg_pack_append_ptr( arg_pack , workflow );
+        arg_pack_append_int( arg_pack , int_vector_iget( ready , i ));
+        arg_pack_append_ptr( arg_pack , self );
+        arg_pack_append_bool( arg_pack , verbose );
+        thread_pool_add_job( pool , workflow_run_cmd__ , arg_pack );
+      }
+      pthread_mutex_lock( &workflow->run_mutex );
+    } else if ((exclusive >= 0) && (num_running == 0)) {
+      void * return_value;
+      int_vector_iset( workflow->cmd_status , exclusive , CMD_RUNNING );
+      pthread_mutex_unlock( &workflow->run_mutex );
+      return_value = workflow_run_cmd( workflow , exclusive , self , verbose );
+      pthread_mutex_lock( &workflow->run_mutex );
+      workflow_complete_cmd( workflow , exclusive , return_value );
+    } else if (workflow->num_done < num_cmd)
+      pthread_cond_wait( &workflow->run_cond , &workflow->run_mutex );
+  }
+  pthread_mutex_unlock( &workflow->run_mutex );
+  
+  thread_pool_join( pool );
+  thread_pool_free( pool );
+  int_vector_free( ready );
+
+  /* The return values are pushed on the stack in the order of the commands. */
+  for (int icmd = 0; icmd < num_cmd; icmd++)
+    vector_push_front_ref( workflow->stack , workflow->return_values[icmd] );
+  free( workflow->return_values );
+  workflow->return_values = NULL;
+}
+
+
 bool workflow_run(workflow_type * workflow , void * self , bool verbose , const subst_list_type * context) {
   vector_clear( workflow->stack );
   workflow_try_compile( workflow , context);
   
   if (workflow->compiled) {
-    int icmd;
-    for (icmd = 0; icmd < vector_get_size( workflow->cmd_list ); icmd++) {
-      const cmd_type * cmd = vector_iget_const( workflow->cmd_list , icmd );
-      void * return_value = workflow_job_run( cmd->workflow_job , self , verbose , cmd->arglist );
-      vector_push_front_ref( workflow->stack , return_value );
-    }
+    if (workflow->has_steps)
+      workflow_run_steps( workflow , self , verbose );
+    else
+      workflow_run_serial( workflow , self , verbose );
     return true;
   } else 
     return false;
 }
 
+
+void workflow_set_num_threads( workflow_type * workflow , int num_threads ) {
+  if (num_threads > 0)
+    workflow->num_threads = num_threads;
+  else
+    util_abort("%s: invalid number of threads:%d \n",__func__ , num_threads);
+}
+
+
+int workflow_get_num_threads( const workflow_type * workflow ) {
+  return workflow->num_threads;
+}
+
+
+/*
+  Forgets the cached results; all the commands will be run on the
+  next invocation of workflow_run().
+*/
+
+void workflow_clear_cache( workflow_type * workflow ) {
+  hash_clear( workflow->cache );
+}
+
 int workflow_get_stack_size( const workflow_type * workflow ) {
   return vector_get_size( workflow->stack );
 }
@@ -213,9 +554,20 @@ workflow_type * workflow_alloc( const char * src_file , workflow_joblist_type *
   script->src_file        = util_alloc_string_copy( src_file );
   script->joblist         = joblist;
   script->cmd_list        = vector_alloc_new();
+  script->has_steps       = false;
   script->compiled        = false;
   script->last_error      = NULL;
   script->stack           = vector_alloc_new();
+  script->cache           = hash_alloc();
+  script->cmd_status      = int_vector_alloc( 0 , CMD_PENDING );
+  script->return_values   = NULL;
+  script->num_done        = 0;
+  {
+    long num_cpu = sysconf( _SC_NPROCESSORS_ONLN );
+    script->num_threads = (num_cpu > 0) ? num_cpu : 1;
+  }
+  pthread_mutex_init( &script->run_mutex , NULL );
+  pthread_cond_init( &script->run_cond , NULL );
   
   workflow_try_compile( script , NULL );
   return script;
@@ -229,6 +581,10 @@ void workflow_free( workflow_type * workflow ) {
   free( workflow->src_file );
   vector_free( workflow->cmd_list );
   vector_free( workflow->stack );
+  hash_free( workflow->cache );
+  int_vector_free( workflow->cmd_status );
+  pthread_mutex_destroy( &workflow->run_mutex );
+  pthread_cond_destroy( &workflow->run_cond );
 
   if (workflow->last_error)
     config_error_free( workflow->last_error );
@@ -31,6 +31,8 @@
 
 /* The default values are interepreted as no limit. */
 #define DEFAULT_INTERNAL false
+#define DEFAULT_CACHE    false
+#define DEFAULT_THREAD_SAFE false
 
 
 #define MIN_ARG_KEY    "MIN_ARG"
@@ -40,6 +42,8 @@
 #define MODULE_KEY     "MODULE" 
 #define FUNCTION_KEY   "FUNCTION"
 #define EXECUTABLE_KEY "EXECUTABLE"
+#define CACHE_KEY      "CACHE"
+#define THREAD_SAFE_KEY "THREAD_SAFE"
 
 #define NULL_STRING         "NULL"
 #define WORKFLOW_JOB_STRING_TYPE "STRING"
@@ -62,6 +66,8 @@ struct workflow_job_struct {
   void               * lib_handle;
   workflow_job_ftype * dl_func;
   bool                 valid;
+  bool                 cache;         // The job is skipped if the arguments and the input files are unchanged since the previous run.
+  bool                 thread_safe;   // An internal job can run concurrently with other steps of the workflow.
 };
 
 
@@ -73,6 +79,26 @@ const char * workflow_job_get_name( const workflow_job_type * workflow_job ) {
   return workflow_job->name;
 }
 
+const char * workflow_job_get_executable( const workflow_job_type * workflow_job ) {
+  return workflow_job->executable;
+}
+
+bool workflow_job_get_cache( const workflow_job_type * workflow_job ) {
+  return workflow_job->cache;
+}
+
+void workflow_job_set_cache( workflow_job_type * workflow_job , bool cache) {
+  workflow_job->cache = cache;
+}
+
+bool workflow_job_get_thread_safe( const workflow_job_type * workflow_job ) {
+  return workflow_job->thread_safe;
+}
+
+void workflow_job_set_thread_safe( workflow_job_type * workflow_job , bool thread_safe) {
+  workflow_job->thread_safe = thread_safe;
+}
+
 
 config_type * workflow_job_alloc_config() {
   config_type * config = config_alloc();
@@ -109,6 +135,14 @@ config_type * workflow_job_alloc_config() {
     item = config_add_schema_item( config , INTERNAL_KEY , false );
     config_schema_item_set_argc_minmax( item , 1 , 1);
     config_schema_item_iset_type( item , 0 , CONFIG_BOOL);
+
+    item = config_add_schema_item( config , CACHE_KEY , false );
+    config_schema_item_set_argc_minmax( item , 1 , 1);
+    config_schema_item_iset_type( item , 0 , CONFIG_BOOL);
+
+    item = config_add_schema_item( config , THREAD_SAFE_KEY , false );
+    config_schema_item_set_argc_minmax( item , 1 , 1);
+    config_schema_item_iset_type( item , 0 , CONFIG_BOOL);
   }
   return config;
 }
@@ -151,6 +185,8 @@ workflow_job_type * workflow_job_alloc( const char * name , bool internal ) {
     workflow_job->name       = util_alloc_string_copy( name );
 
   workflow_job->valid      = false;
+  workflow_job->cache      = DEFAULT_CACHE;
+  workflow_job->thread_safe = DEFAULT_THREAD_SAFE;
 
   return workflow_job;
 }
@@ -286,6 +322,12 @@ workflow_job_type * workflow_job_config_alloc( const char * name , config_type *
       
       if (config_item_set( config , EXECUTABLE_KEY)) 
         workflow_job_set_executable( workflow_job , config_get_value_as_abspath( config , EXECUTABLE_KEY));
+
+      if (config_item_set( config , CACHE_KEY))
+        workflow_job_set_cache( workflow_job , config_iget_as_bool( config , CACHE_KEY , 0 , 0 ));
+
+      if (config_item_set( config , THREAD_SAFE_KEY))
+        workflow_job_set_thread_safe( workflow_job , config_iget_as_bool( config , THREAD_SAFE_KEY , 0 , 0 ));
       
       workflow_job_validate( workflow_job );
       
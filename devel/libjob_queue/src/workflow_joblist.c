@@ -19,6 +19,7 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <dlfcn.h>
 
 #include <ert/util/hash.h>
@@ -65,13 +66,23 @@ const workflow_job_type * workflow_joblist_get_job( const workflow_joblist_type
 
 
 void workflow_joblist_add_job( workflow_joblist_type * joblist , const workflow_job_type * job) {
+  if (util_string_equal( workflow_job_get_name( job ) , WORKFLOW_STEP_KEY ))
+    util_abort("%s: the name %s is reserved for the workflow step keyword\n",__func__ , WORKFLOW_STEP_KEY);
+
   hash_insert_hash_owned_ref( joblist->joblist , workflow_job_get_name( job ) , job , workflow_job_free__ );
   workflow_job_update_config_compiler( job , joblist->workflow_compiler );
 }
 
 
 bool workflow_joblist_add_job_from_file( workflow_joblist_type * joblist , const char * job_name , const char * config_file ) {
-  workflow_job_type * job = workflow_job_config_alloc( job_name , joblist->job_config , config_file );
+  workflow_job_type * job;
+
+  if (util_string_equal( job_name , WORKFLOW_STEP_KEY )) {
+    fprintf(stderr,"** Warning: the name %s is reserved - workflow job in %s not installed.\n", WORKFLOW_STEP_KEY , config_file );
+    return false;
+  }
+
+  job = workflow_job_config_alloc( job_name , joblist->job_config , config_file );
   if (job) {
     workflow_joblist_add_job( joblist , job );
     return true;
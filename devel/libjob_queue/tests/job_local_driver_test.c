@@ -0,0 +1,235 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'job_local_driver_test.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+
+#include <ert/util/util.h>
+#include <ert/util/test_util.h>
+
+#include <ert/job_queue/local_driver.h>
+#include <ert/job_queue/job_resource.h>
+
+#define NUM_JOBS 5
+
+
+static local_job_type * submit_shell( local_driver_type * driver , const char * script ) {
+  const char * argv[2] = {"-c" , script};
+  return local_driver_submit_job( driver , "/bin/sh" , 1 , NULL , "TEST" , 2 , argv );
+}
+
+
+static void wait_for_job( local_driver_type * driver , local_job_type * job ) {
+  int wait_count = 0;
+  while (local_driver_get_job_status( driver , job ) & (JOB_QUEUE_RUNNING + JOB_QUEUE_PENDING)) {
+    usleep( 10000 );
+    wait_count++;
+    if (wait_count > 2000)
+      test_error_exit("Job did not complete\n");
+  }
+}
+
+
+void test_options() {
+  local_driver_type * driver = local_driver_alloc();
+  test_assert_string_equal( "0" , local_driver_get_option( driver , LOCAL_MAX_PROCESSES ));
+  test_assert_true( local_driver_set_option( driver , LOCAL_MAX_PROCESSES , "4" ));
+  test_assert_string_equal( "4" , local_driver_get_option( driver , LOCAL_MAX_PROCESSES ));
+  test_assert_false( local_driver_set_option( driver , LOCAL_MAX_PROCESSES , "four" ));
+  test_assert_true( local_driver_set_option( driver , LOCAL_CPU_AFFINITY , "True" ));
+  test_assert_string_equal( "1" , local_driver_get_option( driver , LOCAL_CPU_AFFINITY ));
+  test_assert_false( local_driver_set_option( driver , "NO_SUCH_OPTION" , "1" ));
+  local_driver_free__( driver );
+}
+
+
+void test_max_processes_and_exit_code() {
+  local_driver_type * driver = local_driver_alloc();
+  local_job_type * jobs[NUM_JOBS];
+
+  local_driver_set_option( driver , LOCAL_MAX_PROCESSES , "2" );
+  for (int i = 0; i < NUM_JOBS; i++) {
+    char * script = util_alloc_sprintf("sleep 0.2; exit %d" , i);
+    jobs[i] = submit_shell( driver , script );
+    free( script );
+  }
+
+  {
+    int num_running = 0;
+    int num_pending = 0;
+    for (int i = 0; i < NUM_JOBS; i++) {
+      job_status_type status = local_driver_get_job_status( driver , jobs[i] );
+      if (status == JOB_QUEUE_RUNNING)
+        num_running++;
+      else if (status == JOB_QUEUE_PENDING)
+        num_pending++;
+    }
+    test_assert_int_equal( 2 , num_running );
+    test_assert_int_equal( NUM_JOBS - 2 , num_pending );
+  }
+
+  for (int i = 0; i < NUM_JOBS; i++) {
+    wait_for_job( driver , jobs[i] );
+    test_assert_int_equal( i , local_job_get_exit_code( jobs[i] ));
+    test_assert_int_equal( (i == 0) ? JOB_QUEUE_DONE : JOB_QUEUE_EXIT , local_driver_get_job_status( driver , jobs[i] ));
+    local_driver_free_job( jobs[i] );
+  }
+  local_driver_free__( driver );
+}
+
+
+void test_rusage() {
+  local_driver_type * driver = local_driver_alloc();
+  local_job_type * job = submit_shell( driver , "i=0; while [ $i -lt 200000 ]; do i=$((i+1)); done");
+
+  wait_for_job( driver , job );
+  test_assert_int_equal( JOB_QUEUE_DONE , local_driver_get_job_status( driver , job ));
+  test_assert_true( local_job_get_cpu_seconds( job ) > 0 );
+  test_assert_true( local_job_get_max_rss( job ) > 0 );
+  {
+    job_resource_type * resource = job_resource_alloc( );
+    test_assert_true( local_driver_get_job_resource( driver , job , resource ));
+    test_assert_double_equal( local_job_get_cpu_seconds( job ) , job_resource_get_cpu_seconds( resource ));
+    test_assert_int_equal( local_job_get_max_rss( job ) , job_resource_get_max_rss( resource ));
+    test_assert_true( job_resource_get_wall_seconds( resource ) > 0 );
+    test_assert_true( job_resource_get_read_bytes( resource ) >= 0 );
+
+    {
+      job_resource_type * total = job_resource_alloc( );
+      job_resource_add( total , resource );
+      job_resource_add( total , resource );
+      test_assert_int_equal( 2 , job_resource_get_num_jobs( total ));
+      test_assert_double_equal( 2 * job_resource_get_cpu_seconds( resource ) , job_resource_get_cpu_seconds( total ));
+      test_assert_int_equal( job_resource_get_max_rss( resource ) , job_resource_get_max_rss( total ));
+      job_resource_free( total );
+    }
+    job_resource_free( resource );
+  }
+
+  local_driver_free_job( job );
+  local_driver_free__( driver );
+}
+
+
+void test_memory_limit() {
+  local_driver_type * driver = local_driver_alloc();
+  local_job_type * job;
+
+  local_driver_set_option( driver , LOCAL_MAX_MEMORY , "1" );
+  job = submit_shell( driver , "exit 0" );
+  wait_for_job( driver , job );
+  test_assert_int_equal( JOB_QUEUE_EXIT , local_driver_get_job_status( driver , job ));
+
+  local_driver_free_job( job );
+  local_driver_free__( driver );
+}
+
+
+/*
+  The job_queue frees the job immediately after killing it; the
+  running process is then reaped by the driver.
+*/
+
+void test_kill() {
+  local_driver_type * driver = local_driver_alloc();
+  local_job_type * job1;
+  local_job_type * job2;
+
+  local_driver_set_option( driver , LOCAL_MAX_PROCESSES , "1" );
+  job1 = submit_shell( driver , "sleep 100" );
+  job2 = submit_shell( driver , "sleep 100" );
+  test_assert_int_equal( JOB_QUEUE_PENDING , local_driver_get_job_status( driver , job2 ));
+
+  local_driver_kill_job( driver , job2 );
+  local_driver_free_job( job2 );
+
+  local_driver_kill_job( driver , job1 );
+  local_driver_free_job( job1 );
+
+  {
+    local_job_type * job3 = submit_shell( driver , "exit 0" );
+    wait_for_job( driver , job3 );
+    test_assert_int_equal( JOB_QUEUE_DONE , local_driver_get_job_status( driver , job3 ));
+    local_driver_free_job( job3 );
+  }
+  local_driver_free__( driver );
+}
+
+
+/*
+  A running job which is killed is reported as USER_KILLED, also
+  after the process has been reaped.
+*/
+
+void test_kill_status() {
+  local_driver_type * driver = local_driver_alloc();
+  local_job_type * job = submit_shell( driver , "sleep 100" );
+
+  test_assert_int_equal( JOB_QUEUE_RUNNING , local_driver_get_job_status( driver , job ));
+  local_driver_kill_job( driver , job );
+  wait_for_job( driver , job );
+  test_assert_int_equal( JOB_QUEUE_USER_KILLED , local_driver_get_job_status( driver , job ));
+  test_assert_int_equal( 128 + SIGKILL , local_job_get_exit_code( job ));
+
+  local_driver_free_job( job );
+  local_driver_free__( driver );
+}
+
+
+/*
+  A child process which has exited, but is not reaped by its owner,
+  must not prevent the driver from reaping its own jobs.
+*/
+
+void test_foreign_zombie() {
+  local_driver_type * driver = local_driver_alloc();
+  local_job_type * job;
+  pid_t foreign_pid = fork();
+
+  if (foreign_pid == 0)
+    _exit( 0 );
+
+  usleep( 100000 );
+  job = submit_shell( driver , "exit 3" );
+  wait_for_job( driver , job );
+  test_assert_int_equal( JOB_QUEUE_EXIT , local_driver_get_job_status( driver , job ));
+  test_assert_int_equal( 3 , local_job_get_exit_code( job ));
+
+  {
+    int status;
+    test_assert_int_equal( foreign_pid , waitpid( foreign_pid , &status , 0 ));
+  }
+
+  local_driver_free_job( job );
+  local_driver_free__( driver );
+}
+
+
+int main(int argc , char ** argv) {
+  test_options();
+  test_max_processes_and_exit_code();
+  test_rusage();
+  test_memory_limit();
+  test_kill();
+  test_kill_status();
+  test_foreign_zombie();
+  exit(0);
+}
@@ -0,0 +1,280 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'job_lsf_array_test.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ert/util/util.h>
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/job_queue/lsf_driver.h>
+#include <ert/job_queue/job_queue.h>
+
+#define NUM_JOBS 3
+
+/*
+  The fake bsub stores its arguments in the file 'bsub_args' and
+  reports job 555; the fake bjobs lists the elements of array 555 in
+  different states, and an element of an array which does not belong
+  to this driver. The execution host of element 2 looks like an array
+  index, only the JOB_NAME column should be used for the index.
+
+  The fake bsub_run and bjobs_run used with the job_queue run the
+  jobs immediately; every submit is recorded in 'bsub_calls', and the
+  jobs are listed as DONE by bjobs_run.
+*/
+
+static void write_script(const char * filename, const char * content) {
+  FILE * stream = util_fopen(filename, "w");
+  fprintf(stream, "%s", content);
+  fclose(stream);
+  chmod(filename, S_IRWXU);
+}
+
+static void create_fake_commands() {
+  write_script("bsub",
+               "#!/bin/sh\n"
+               "for arg in \"$@\"; do echo \"$arg\" >> bsub_args; done\n"
+               "echo \"Job <555> is submitted to queue <normal>.\"\n");
+
+  write_script("bjobs",
+               "#!/bin/sh\n"
+               "echo \"JOBID   USER    STAT  QUEUE      FROM_HOST   EXEC_HOST   JOB_NAME   SUBMIT_TIME\"\n"
+               "echo \"555     user    RUN   normal     host1       host2       ERT[1]     Oct  1 10:00\"\n"
+               "echo \"555     user    DONE  normal     host1       rack[3]     ERT[2]     Oct  1 10:00\"\n"
+               "echo \"555     user    PEND  normal     host1                   ERT[3]     Oct  1 10:00\"\n"
+               "echo \"555     user    EXIT  normal     host1       host2       ERT[7]     Oct  1 10:00\"\n");
+
+  write_script("bsub_run",
+               "#!/bin/sh\n"
+               "name=''\n"
+               "while [ $# -gt 0 ]; do\n"
+               "  case \"$1\" in\n"
+               "    -J) name=\"$2\"; shift 2 ;;\n"
+               "    -o|-q|-n|-R) shift 2 ;;\n"
+               "    *) break ;;\n"
+               "  esac\n"
+               "done\n"
+               "echo \"$name\" >> bsub_calls\n"
+               "id=$((600 + $(wc -l < bsub_calls)))\n"
+               "case \"$name\" in\n"
+               "  *\\[1-*\\])\n"
+               "    num=${name##*-}; num=${num%]}\n"
+               "    i=1\n"
+               "    while [ $i -le $num ]; do\n"
+               "      LSB_JOBINDEX=$i \"$1\"\n"
+               "      printf '%-8s%-8s%-6s%-11s%-12s%-12s%-11s%s\\n' $id user DONE normal host1 host2 \"ERT[$i]\" 'Oct  1 10:00' >> bjobs_out\n"
+               "      i=$((i + 1))\n"
+               "    done ;;\n"
+               "  *)\n"
+               "    \"$@\"\n"
+               "    printf '%-8s%-8s%-6s%-11s%-12s%-12s%-11s%s\\n' $id user DONE normal host1 host2 \"$name\" 'Oct  1 10:00' >> bjobs_out ;;\n"
+               "esac\n"
+               "echo \"Job <$id> is submitted to queue <normal>.\"\n");
+
+  write_script("bjobs_run",
+               "#!/bin/sh\n"
+               "echo \"JOBID   USER    STAT  QUEUE      FROM_HOST   EXEC_HOST   JOB_NAME   SUBMIT_TIME\"\n"
+               "[ -f bjobs_out ] && cat bjobs_out\n"
+               "exit 0\n");
+}
+
+
+static bool file_has_line(const char * filename, const char * line) {
+  bool found = false;
+  FILE * stream = util_fopen(filename, "r");
+  char buffer[256];
+  while (fgets(buffer, sizeof buffer, stream) != NULL) {
+    buffer[strcspn(buffer, "\n")] = '\0';
+    if (util_string_equal(buffer, line))
+      found = true;
+  }
+  fclose(stream);
+  return found;
+}
+
+
+void test_submit_array(const char * cwd) {
+  lsf_driver_type * driver = lsf_driver_alloc();
+  const char * run_cmd[NUM_JOBS];
+  const char * run_path[NUM_JOBS];
+  const char * job_name[NUM_JOBS];
+  const char ** argv[NUM_JOBS];
+  int argc[NUM_JOBS];
+  void * job_data[NUM_JOBS];
+  const char * job_argv[2] = {"-c" , "echo 'it works' > output"};
+
+  {
+    char * bsub  = util_alloc_filename(cwd, "bsub", NULL);
+    char * bjobs = util_alloc_filename(cwd, "bjobs", NULL);
+    lsf_driver_set_option(driver, LSF_SERVER, "LOCAL");
+    lsf_driver_set_option(driver, LSF_BSUB_CMD, bsub);
+    lsf_driver_set_option(driver, LSF_BJOBS_CMD, bjobs);
+    lsf_driver_set_bjobs_refresh_interval(driver, -1);
+    free(bsub);
+    free(bjobs);
+  }
+
+  for (int i = 0; i < NUM_JOBS; i++) {
+    char * path = util_alloc_sprintf("%s/run%d", cwd, i);
+    util_make_path(path);
+    run_cmd[i]  = "/bin/sh";
+    run_path[i] = path;
+    job_name[i] = util_alloc_sprintf("RUN_%d", i);
+    argc[i]     = 2;
+    argv[i]     = job_argv;
+  }
+
+  test_assert_true(lsf_driver_submit_array(driver, NUM_JOBS, run_cmd, 1, run_path, job_name, argc, argv, job_data));
+  test_assert_true(file_has_line("bsub_args", "ERT[1-3]"));
+
+  for (int i = 0; i < NUM_JOBS; i++) {
+    test_assert_not_NULL(job_data[i]);
+    test_assert_int_equal(555, lsf_job_get_jobnr(job_data[i]));
+  }
+  test_assert_int_equal(JOB_QUEUE_RUNNING, lsf_driver_get_job_status(driver, job_data[0]));
+  test_assert_int_equal(JOB_QUEUE_DONE, lsf_driver_get_job_status(driver, job_data[1]));
+  test_assert_int_equal(JOB_QUEUE_PENDING, lsf_driver_get_job_status(driver, job_data[2]));
+
+  /* Run the array script as LSF would for element 2. */
+  {
+    char * cmd = util_alloc_sprintf("LSB_JOBINDEX=2 %s/.ert_array.%d/0.sh", cwd, getpid());
+    test_assert_int_equal(0, system(cmd));
+    test_assert_true(util_file_exists("run1/output"));
+    test_assert_false(util_file_exists("run0/output"));
+    test_assert_true(file_has_line("run1/output", "it works"));
+    test_assert_true(util_file_exists("run1/RUN_1.LSF-stdout"));
+    free(cmd);
+  }
+
+  /* The script is removed when the last element has been freed. */
+  {
+    char * script = util_alloc_sprintf("%s/.ert_array.%d/0.sh", cwd, getpid());
+    for (int i = 0; i < NUM_JOBS; i++) {
+      test_assert_true(util_file_exists(script));
+      lsf_driver_free_job(job_data[i]);
+    }
+    test_assert_false(util_file_exists(script));
+    free(script);
+  }
+
+  /* The next array gets a new script, and is named after the queue. */
+  lsf_driver_set_option(driver, LSF_QUEUE, "normal");
+  test_assert_true(lsf_driver_submit_array(driver, NUM_JOBS, run_cmd, 1, run_path, job_name, argc, argv, job_data));
+  test_assert_true(file_has_line("bsub_args", "normal[1-3]"));
+  {
+    char * array_path = util_alloc_sprintf("%s/.ert_array.%d", cwd, getpid());
+    char * script = util_alloc_sprintf("%s/1.sh", array_path);
+    test_assert_true(util_file_exists(script));
+
+    /* Freeing the driver removes the files of the arrays which are still around. */
+    lsf_driver_free(driver);
+    test_assert_false(util_file_exists(script));
+    test_assert_false(util_file_exists(array_path));
+    free(script);
+    free(array_path);
+  }
+
+  for (int i = 0; i < NUM_JOBS; i++) {
+    lsf_driver_free_job(job_data[i]);
+    free((char *) run_path[i]);
+    free((char *) job_name[i]);
+  }
+}
+
+
+/*
+  Runs seven jobs through the job_queue with an array size of three;
+  the jobs should be submitted as two arrays and one ordinary job.
+*/
+
+void test_queue_batches(const char * cwd) {
+  const int num_jobs = 7;
+  job_queue_type * queue = job_queue_alloc(num_jobs, NULL, NULL);
+  queue_driver_type * driver = queue_driver_alloc_LSF(NULL, NULL, "LOCAL");
+  {
+    char * bsub  = util_alloc_filename(cwd, "bsub_run", NULL);
+    char * bjobs = util_alloc_filename(cwd, "bjobs_run", NULL);
+    queue_driver_set_option(driver, LSF_BSUB_CMD, bsub);
+    queue_driver_set_option(driver, LSF_BJOBS_CMD, bjobs);
+    free(bsub);
+    free(bjobs);
+  }
+  queue_driver_set_submit_array_size(driver, 3);
+  job_queue_set_driver(queue, driver);
+
+  for (int i = 0; i < num_jobs; i++) {
+    char * run_path = util_alloc_sprintf("%s/queue%d", cwd, i);
+    char * name     = util_alloc_sprintf("QUEUE_%d", i);
+    util_make_path(run_path);
+    job_queue_add_job_st(queue, "/bin/sh", NULL, NULL, NULL, NULL, 1, run_path, name, 3,
+                         (const char *[3]) { "-c", "cd \"$0\" && echo ok > OK", run_path });
+    free(name);
+    free(run_path);
+  }
+
+  job_queue_run_jobs(queue, num_jobs, false);
+  test_assert_int_equal(num_jobs, job_queue_get_num_complete(queue));
+
+  {
+    FILE * stream = util_fopen("bsub_calls", "r");
+    char line[3][64];
+    for (int i = 0; i < 3; i++)
+      test_assert_int_equal(1, fscanf(stream, "%63s", line[i]));
+    test_assert_int_equal(EOF, fscanf(stream, "%63s", line[0]));
+    fclose(stream);
+
+    test_assert_string_equal("ERT[1-3]", line[0]);
+    test_assert_string_equal("ERT[1-3]", line[1]);
+    test_assert_string_equal("QUEUE_6", line[2]);
+  }
+
+  for (int i = 0; i < num_jobs; i++) {
+    char * ok_file = util_alloc_sprintf("queue%d/OK", i);
+    test_assert_true(util_file_exists(ok_file));
+    free(ok_file);
+  }
+
+  /* All the elements are complete; the array files have been removed. */
+  {
+    char * array_path = util_alloc_sprintf("%s/.ert_array.%d", cwd, getpid());
+    test_assert_false(util_file_exists(array_path));
+    free(array_path);
+  }
+
+  job_queue_free(queue);
+  queue_driver_free(driver);
+}
+
+
+int main(int argc, char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("job_lsf_array_test", false);
+  char * cwd = util_alloc_cwd();
+
+  create_fake_commands();
+  test_submit_array(cwd);
+  test_queue_batches(cwd);
+
+  free(cwd);
+  test_work_area_free(work_area);
+  exit(0);
+}
@@ -0,0 +1,305 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'job_torque_qstat_test.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ert/util/util.h>
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/job_queue/torque_driver.h>
+
+#define NUM_JOBS 20
+
+/*
+  The fake qsub assigns job numbers 101, 102, ... and registers the
+  job in the file 'jobs', or all the elements jobnr[index] for an
+  array job; the fake qstat lists all the registered jobs, and counts
+  the number of times it has been invoked in the file 'qstat_calls'.
+  The jobs are listed as running, unless another state is given for
+  the job in the file 'states'; the jobs in the file 'purged' are
+  neither listed nor known by qstat -f.
+*/
+
+static void write_script(const char * filename, const char * content) {
+  FILE * stream = util_fopen(filename, "w");
+  fprintf(stream, "%s", content);
+  fclose(stream);
+  chmod(filename, S_IRWXU);
+}
+
+static void create_fake_commands(const char * cwd) {
+  write_script("qsub",
+               "#!/bin/sh\n"
+               "n=$(cat jobs 2>/dev/null | wc -l)\n"
+               "id=$((101 + n))\n"
+               "range=\"\"\n"
+               "prev=\"\"\n"
+               "for arg in \"$@\"; do\n"
+               "  if [ \"$prev\" = \"-t\" ]; then range=$arg; fi\n"
+               "  prev=$arg\n"
+               "done\n"
+               "if [ -n \"$range\" ]; then\n"
+               "  for k in $(seq 1 ${range#1-}); do echo \"$id[$k]\" >> jobs; done\n"
+               "  echo \"$id[].fake-server\"\n"
+               "else\n"
+               "  echo $id >> jobs\n"
+               "  echo $id.fake-server\n"
+               "fi\n");
+
+  write_script("qstat",
+               "#!/bin/sh\n"
+               "state_of() {\n"
+               "  s=$(awk -v id=\"$1\" '$1 == id {print $2}' states 2>/dev/null)\n"
+               "  echo ${s:-R}\n"
+               "}\n"
+               "if [ \"$1\" = \"-f\" ]; then\n"
+               "  if ! grep -qxF \"$2\" jobs || grep -qxF \"$2\" purged 2>/dev/null; then\n"
+               "    echo \"qstat: Unknown Job Id $2\" >&2\n"
+               "    exit 153\n"
+               "  fi\n"
+               "  echo \"Job Id: $2.fake-server\"\n"
+               "  echo \"    Job_Name = TEST\"\n"
+               "  echo \"    job_state = $(state_of $2)\"\n"
+               "  echo \"    resources_used.cput = 01:02:03\"\n"
+               "  echo \"    resources_used.mem = 2mb\"\n"
+               "  echo \"    resources_used.vmem = 400mb\"\n"
+               "  echo \"    resources_used.walltime = 00:10:00\"\n"
+               "  exit 0\n"
+               "fi\n"
+               "echo x >> qstat_calls\n"
+               "echo \"Job id                    Name             User            Time Use S Queue\"\n"
+               "echo \"------------------------- ---------------- --------------- -------- - -----\"\n"
+               "for id in $(cat jobs); do\n"
+               "  if grep -qxF \"$id\" purged 2>/dev/null; then continue; fi\n"
+               "  echo \"$id.fake-server           TEST             user            00:00:01 $(state_of $id) normal\"\n"
+               "done\n"
+               "echo \"999.fake-server           OTHER            user            00:00:01 Q normal\"\n");
+
+  write_script("qdel", "#!/bin/sh\n");
+}
+
+static int qstat_calls() {
+  if (util_file_exists("qstat_calls")) {
+    FILE * stream = util_fopen("qstat_calls", "r");
+    int lines = util_count_file_lines(stream);
+    fclose(stream);
+    return lines;
+  } else
+    return 0;
+}
+
+/* The job number of the last job submitted, as registered by the fake qsub. */
+static char * alloc_last_job_id() {
+  FILE * stream = util_fopen("jobs", "r");
+  char * job_id = NULL;
+  bool at_eof = false;
+  while (!at_eof) {
+    char * line = util_fscanf_alloc_line(stream, &at_eof);
+    if (line != NULL && strlen(line) > 0) {
+      util_safe_free(job_id);
+      job_id = line;
+    } else
+      util_safe_free(line);
+  }
+  fclose(stream);
+  return job_id;
+}
+
+static void append_line(const char * filename, const char * line) {
+  FILE * stream = util_fopen(filename, "a");
+  fprintf(stream, "%s\n", line);
+  fclose(stream);
+}
+
+static torque_driver_type * alloc_driver(const char * cwd) {
+  torque_driver_type * driver = torque_driver_alloc();
+  char * qsub = util_alloc_filename(cwd, "qsub", NULL);
+  char * qstat = util_alloc_filename(cwd, "qstat", NULL);
+  char * qdel = util_alloc_filename(cwd, "qdel", NULL);
+
+  torque_driver_set_option(driver, TORQUE_QSUB_CMD, qsub);
+  torque_driver_set_option(driver, TORQUE_QSTAT_CMD, qstat);
+  torque_driver_set_option(driver, TORQUE_QDEL_CMD, qdel);
+
+  free(qsub);
+  free(qstat);
+  free(qdel);
+  return driver;
+}
+
+void test_qstat_cache(const char * cwd) {
+  torque_driver_type * driver = alloc_driver(cwd);
+  torque_job_type * jobs[NUM_JOBS];
+
+  test_assert_int_equal(TORQUE_DEFAULT_QSTAT_REFRESH_INTERVAL, torque_driver_get_qstat_refresh_interval(driver));
+  for (int i = 0; i < NUM_JOBS; i++)
+    jobs[i] = torque_driver_submit_job(driver, "job_program", 1, cwd, "TEST", 0, NULL);
+
+  /* Many status queries - one qstat call. */
+  torque_driver_set_qstat_refresh_interval(driver, 1000);
+  for (int iter = 0; iter < 10; iter++)
+    for (int i = 0; i < NUM_JOBS; i++)
+      test_assert_int_equal(JOB_QUEUE_RUNNING, torque_driver_get_job_status(driver, jobs[i]));
+  test_assert_int_equal(1, qstat_calls());
+
+  /* A kill forces a refresh on the next query. */
+  torque_driver_kill_job(driver, jobs[0]);
+  torque_driver_get_job_status(driver, jobs[0]);
+  torque_driver_get_job_status(driver, jobs[1]);
+  test_assert_int_equal(2, qstat_calls());
+
+  /* With refresh interval zero every query calls qstat. */
+  torque_driver_set_qstat_refresh_interval(driver, 0);
+  for (int i = 0; i < 5; i++)
+    torque_driver_get_job_status(driver, jobs[i]);
+  test_assert_int_equal(7, qstat_calls());
+
+  for (int i = 0; i < NUM_JOBS; i++)
+    torque_driver_free_job(jobs[i]);
+  torque_driver_free(driver);
+}
+
+void test_job_resource(const char * cwd) {
+  torque_driver_type * driver = alloc_driver(cwd);
+  torque_job_type * job = torque_driver_submit_job(driver, "job_program", 1, cwd, "TEST", 0, NULL);
+  job_resource_type * resource = job_resource_alloc();
+
+  test_assert_true(torque_driver_get_job_resource(driver, job, resource));
+  test_assert_double_equal(3723, job_resource_get_cpu_seconds(resource));
+  test_assert_double_equal(600, job_resource_get_wall_seconds(resource));
+  test_assert_int_equal(2048, job_resource_get_max_rss(resource));
+  test_assert_int_equal(JOB_RESOURCE_UNKNOWN, job_resource_get_read_bytes(resource));
+
+  job_resource_free(resource);
+  torque_driver_free_job(job);
+  torque_driver_free(driver);
+}
+
+void test_submit_array(const char * cwd) {
+  torque_driver_type * driver = alloc_driver(cwd);
+  const char * run_cmd[3] = {"job_program", "job_program", "job_program"};
+  const char * run_path[3];
+  const char * job_name[3] = {"TEST0", "TEST1", "TEST2"};
+  const int argc[3] = {0, 0, 0};
+  const char ** argv[3] = {NULL, NULL, NULL};
+  void * job_data[3];
+
+  for (int i = 0; i < 3; i++) {
+    char * path = util_alloc_sprintf("%s/run%d", cwd, i);
+    util_make_path(path);
+    run_path[i] = path;
+  }
+
+  test_assert_true(torque_driver_submit_array(driver, 3, run_cmd, 1, run_path, job_name, argc, argv, job_data));
+  {
+    char * script = util_alloc_sprintf(".ert_array.%d/0.sh", getpid());
+    test_assert_true(util_file_exists(script));
+    test_assert_false(util_file_exists("run0/qsub_array_script.sh"));
+    free(script);
+  }
+  torque_driver_set_qstat_refresh_interval(driver, 0);
+  for (int i = 0; i < 3; i++) {
+    test_assert_not_NULL(job_data[i]);
+    test_assert_int_equal(JOB_QUEUE_RUNNING, torque_driver_get_job_status(driver, job_data[i]));
+    torque_driver_free_job(job_data[i]);
+    free((char *) run_path[i]);
+  }
+  torque_driver_free(driver);
+}
+
+void test_job_states(const char * cwd) {
+  torque_driver_type * driver = alloc_driver(cwd);
+  const char * states = "QHWTRSBECX";
+  const job_status_type expected[10] = {JOB_QUEUE_PENDING, JOB_QUEUE_PENDING, JOB_QUEUE_PENDING, JOB_QUEUE_PENDING,
+                                        JOB_QUEUE_RUNNING, JOB_QUEUE_RUNNING, JOB_QUEUE_RUNNING,
+                                        JOB_QUEUE_DONE, JOB_QUEUE_DONE, JOB_QUEUE_DONE};
+  torque_job_type * jobs[10];
+
+  for (int i = 0; i < 10; i++) {
+    jobs[i] = torque_driver_submit_job(driver, "job_program", 1, cwd, "TEST", 0, NULL);
+    {
+      char * job_id = alloc_last_job_id();
+      char * line = util_alloc_sprintf("%s %c", job_id, states[i]);
+      append_line("states", line);
+      free(line);
+      free(job_id);
+    }
+  }
+
+  torque_driver_set_qstat_refresh_interval(driver, 0);
+  for (int i = 0; i < 10; i++) {
+    test_assert_int_equal(expected[i], torque_driver_get_job_status(driver, jobs[i]));
+    torque_driver_free_job(jobs[i]);
+  }
+  torque_driver_free(driver);
+}
+
+/*
+  A job which is not listed by qstat is pending while it has just
+  been submitted; after the grace time it is looked up with qstat -f,
+  and reported as DONE when the server does not know it.
+*/
+void test_missing_job(const char * cwd) {
+  torque_driver_type * driver = alloc_driver(cwd);
+  torque_job_type * job = torque_driver_submit_job(driver, "job_program", 1, cwd, "TEST", 0, NULL);
+  torque_job_type * held_job = torque_driver_submit_job(driver, "job_program", 1, cwd, "TEST", 0, NULL);
+
+  {
+    char * job_id = alloc_last_job_id();
+    long int jobnr = strtol(job_id, NULL, 10);
+    char * purged_id = util_alloc_sprintf("%ld", jobnr - 1);
+
+    append_line("purged", purged_id);
+    free(purged_id);
+    free(job_id);
+  }
+
+  torque_driver_set_qstat_refresh_interval(driver, 0);
+  test_assert_int_equal(TORQUE_DEFAULT_MISSING_JOB_GRACE_TIME, torque_driver_get_missing_job_grace_time(driver));
+  test_assert_int_equal(JOB_QUEUE_PENDING, torque_driver_get_job_status(driver, job));
+  test_assert_int_equal(JOB_QUEUE_RUNNING, torque_driver_get_job_status(driver, held_job));
+
+  torque_driver_set_missing_job_grace_time(driver, 0);
+  test_assert_int_equal(JOB_QUEUE_DONE, torque_driver_get_job_status(driver, job));
+  test_assert_int_equal(JOB_QUEUE_RUNNING, torque_driver_get_job_status(driver, held_job));
+
+  torque_driver_free_job(job);
+  torque_driver_free_job(held_job);
+  torque_driver_free(driver);
+}
+
+int main(int argc, char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("job_torque_qstat_test", false);
+  char * cwd = util_alloc_cwd();
+
+  create_fake_commands(cwd);
+  test_qstat_cache(cwd);
+  test_job_resource(cwd);
+  test_submit_array(cwd);
+  test_job_states(cwd);
+  test_missing_job(cwd);
+
+  free(cwd);
+  test_work_area_free(work_area);
+  exit(0);
+}
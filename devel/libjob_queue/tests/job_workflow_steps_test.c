@@ -0,0 +1,230 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'job_workflow_steps_test.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <utime.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/stringlist.h>
+
+#include <ert/job_queue/workflow.h>
+#include <ert/job_queue/workflow_job.h>
+#include <ert/job_queue/workflow_joblist.h>
+
+
+typedef struct {
+  pthread_mutex_t   mutex;
+  int               running;
+  int               max_running;
+  int               calls;
+  bool              other_thread;
+  pthread_t         main_thread;
+  stringlist_type * completed;
+} context_type;
+
+
+/*
+  Internal workflow job: waits a short while and records how many
+  jobs were running concurrently, the order the jobs completed in, and
+  whether any job was run on another thread than the main thread. The
+  context is returned as the return value.
+*/
+
+void * sleep_job( void * self , const stringlist_type * args) {
+  context_type * context = (context_type *) self;
+
+  pthread_mutex_lock( &context->mutex );
+  context->running++;
+  context->calls++;
+  context->max_running = util_int_max( context->max_running , context->running );
+  if (!pthread_equal( pthread_self() , context->main_thread ))
+    context->other_thread = true;
+  pthread_mutex_unlock( &context->mutex );
+
+  usleep( 200000 );
+
+  pthread_mutex_lock( &context->mutex );
+  context->running--;
+  stringlist_append_copy( context->completed , stringlist_iget( args , 0 ));
+  pthread_mutex_unlock( &context->mutex );
+  return context;
+}
+
+
+void write_file( const char * filename , const char * content ) {
+  FILE * stream = util_fopen( filename , "w");
+  fprintf(stream , "%s" , content );
+  fclose( stream );
+}
+
+
+void context_reset( context_type * context ) {
+  context->running = 0;
+  context->max_running = 0;
+  context->calls = 0;
+  context->other_thread = false;
+  stringlist_clear( context->completed );
+}
+
+
+bool run_workflow( workflow_joblist_type * joblist , const char * content , context_type * context ) {
+  workflow_type * workflow;
+  bool runOK;
+
+  write_file( "workflow" , content );
+  workflow = workflow_alloc( "workflow" , joblist );
+  workflow_set_num_threads( workflow , 4 );
+  context_reset( context );
+  runOK = workflow_run( workflow , context , false , NULL );
+  if (runOK)
+    test_assert_int_equal( stringlist_get_size( context->completed ) , workflow_get_stack_size( workflow ));
+  workflow_free( workflow );
+  return runOK;
+}
+
+
+void test_sequential( workflow_joblist_type * joblist , context_type * context ) {
+  test_assert_true( run_workflow( joblist , "SLEEP A\nSLEEP B\nSLEEP C\n" , context ));
+  test_assert_int_equal( 1 , context->max_running );
+  test_assert_false( context->other_thread );
+  test_assert_string_equal( "A" , stringlist_iget( context->completed , 0 ));
+  test_assert_string_equal( "C" , stringlist_iget( context->completed , 2 ));
+}
+
+
+void test_parallel( workflow_joblist_type * joblist , context_type * context ) {
+  test_assert_true( run_workflow( joblist ,
+                                  "__STEP__ a\nSLEEP A\n"
+                                  "__STEP__ b\nSLEEP B\n"
+                                  "__STEP__ c a b\nSLEEP C\n"
+                                  "SLEEP D\n"
+                                  "__STEP__ e\nSLEEP E\n" , context ));
+  test_assert_int_equal( 2 , context->max_running );
+  test_assert_int_equal( 5 , context->calls );
+  test_assert_string_equal( "C" , stringlist_iget( context->completed , 2 ));
+  test_assert_string_equal( "D" , stringlist_iget( context->completed , 3 ));
+  test_assert_string_equal( "E" , stringlist_iget( context->completed , 4 ));
+  test_assert_true( context->other_thread );
+}
+
+
+/* Internal jobs which are not thread safe run alone, on the calling thread. */
+
+void test_exclusive( workflow_joblist_type * joblist , context_type * context ) {
+  test_assert_true( run_workflow( joblist ,
+                                  "__STEP__ a\nSERIAL A\n"
+                                  "__STEP__ b\nSERIAL B\n"
+                                  "__STEP__ c\nSLEEP C\n"
+                                  "__STEP__ d\nSLEEP D\n" , context ));
+  test_assert_int_equal( 4 , context->calls );
+  test_assert_int_equal( 2 , context->max_running );
+  test_assert_string_equal( "A" , stringlist_iget( context->completed , 2 ));
+  test_assert_string_equal( "B" , stringlist_iget( context->completed , 3 ));
+
+  test_assert_true( run_workflow( joblist , "__STEP__ a\nSERIAL A\n__STEP__ b\nSERIAL B\n" , context ));
+  test_assert_int_equal( 1 , context->max_running );
+  test_assert_false( context->other_thread );
+}
+
+
+/* STEP is an ordinary job name; only __STEP__ is reserved. */
+
+void test_reserved( workflow_joblist_type * joblist , context_type * context ) {
+  test_assert_false( workflow_joblist_add_job_from_file( joblist , WORKFLOW_STEP_KEY , "sleep_job" ));
+  test_assert_true( workflow_joblist_add_job_from_file( joblist , "STEP" , "sleep_job" ));
+  test_assert_true( run_workflow( joblist , "STEP A\nSTEP B\n" , context ));
+  test_assert_int_equal( 2 , context->calls );
+}
+
+
+void test_invalid( workflow_joblist_type * joblist , context_type * context ) {
+  test_assert_false( run_workflow( joblist , "__STEP__ a missing\nSLEEP A\n" , context ));
+  test_assert_false( run_workflow( joblist , "__STEP__ a\nSLEEP A\n__STEP__ a\nSLEEP B\n" , context ));
+  test_assert_false( run_workflow( joblist , "SLEEP A\n__STEP__ a\n" , context ));
+  test_assert_int_equal( 0 , context->calls );
+}
+
+
+void test_cache( workflow_joblist_type * joblist , context_type * context ) {
+  workflow_type * workflow;
+
+  write_file( "input" , "input" );
+  write_file( "workflow" , "CACHED input\nCACHED other\n" );
+  workflow = workflow_alloc( "workflow" , joblist );
+
+  context_reset( context );
+  test_assert_true( workflow_run( workflow , context , false , NULL ));
+  test_assert_int_equal( 2 , context->calls );
+
+  context_reset( context );
+  test_assert_true( workflow_run( workflow , context , false , NULL ));
+  test_assert_int_equal( 0 , context->calls );
+  test_assert_int_equal( 2 , workflow_get_stack_size( workflow ));
+  test_assert_ptr_equal( context , workflow_iget_stack_ptr( workflow , 0 ));
+  test_assert_ptr_equal( context , workflow_iget_stack_ptr( workflow , 1 ));
+
+  {
+    struct utimbuf times = { .actime = time( NULL ) + 10 , .modtime = time( NULL ) + 10 };
+    utime( "input" , &times );
+  }
+  context_reset( context );
+  test_assert_true( workflow_run( workflow , context , false , NULL ));
+  test_assert_int_equal( 1 , context->calls );
+  test_assert_string_equal( "input" , stringlist_iget( context->completed , 0 ));
+
+  workflow_clear_cache( workflow );
+  context_reset( context );
+  test_assert_true( workflow_run( workflow , context , false , NULL ));
+  test_assert_int_equal( 2 , context->calls );
+  workflow_free( workflow );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "job_workflow_steps_test" , false );
+  workflow_joblist_type * joblist = workflow_joblist_alloc();
+  context_type context;
+
+  pthread_mutex_init( &context.mutex , NULL );
+  context.completed = stringlist_alloc_new();
+  context.main_thread = pthread_self();
+
+  write_file( "sleep_job" , "INTERNAL TRUE\nFUNCTION sleep_job\nMIN_ARG 1\nMAX_ARG 1\nTHREAD_SAFE TRUE\n");
+  write_file( "serial_job" , "INTERNAL TRUE\nFUNCTION sleep_job\nMIN_ARG 1\nMAX_ARG 1\n");
+  write_file( "cached_job" , "INTERNAL TRUE\nFUNCTION sleep_job\nMIN_ARG 1\nMAX_ARG 1\nCACHE TRUE\n");
+  test_assert_true( workflow_joblist_add_job_from_file( joblist , "SLEEP" , "sleep_job" ));
+  test_assert_true( workflow_joblist_add_job_from_file( joblist , "SERIAL" , "serial_job" ));
+  test_assert_true( workflow_joblist_add_job_from_file( joblist , "CACHED" , "cached_job" ));
+
+  test_sequential( joblist , &context );
+  test_parallel( joblist , &context );
+  test_exclusive( joblist , &context );
+  test_invalid( joblist , &context );
+  test_cache( joblist , &context );
+  test_reserved( joblist , &context );
+
+  stringlist_free( context.completed );
+  workflow_joblist_free( joblist );
+  test_work_area_free( work_area );
+  exit(0);
+}
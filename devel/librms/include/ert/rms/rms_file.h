@@ -46,6 +46,8 @@ rms_tag_type       * rms_file_get_tag_ref (const rms_file_type *, const char *,
 void                 rms_file_assert_dimensions(const rms_file_type *, int , int , int );
 rms_tag_type       * rms_file_fread_alloc_tag(rms_file_type * , const char *, const char *, const char *);
 rms_tagkey_type    * rms_file_fread_alloc_data_tagkey(rms_file_type * , const char *, const char *, const char *);
+const rms_tag_type * rms_file_get_index_tag(rms_file_type * , const char *, const char *, const char *);
+void                 rms_file_fread_tagkey_data(rms_file_type * , const rms_tagkey_type * , void * );
 void                 rms_file_complete_fwrite(const rms_file_type *);
 void                 rms_file_init_fwrite(const rms_file_type * , const char *);
 void                 rms_file_get_dims(const rms_file_type * , int * );
@@ -48,6 +48,9 @@ bool              rms_tagkey_char_eq(const rms_tagkey_type *, const char *);
 void              rms_tagkey_free_(void *);
 void            * rms_tagkey_copyc_(const void *);
 void              rms_tagkey_load(rms_tagkey_type *, bool , FILE *, hash_type *);
+rms_tagkey_type * rms_tagkey_fread_alloc_index(bool , FILE * , hash_type * );
+void              rms_tagkey_fread_data_buffer(const rms_tagkey_type * , FILE * , void * );
+void              rms_tagkey_fload_data(rms_tagkey_type * , FILE * );
 void            * rms_tagkey_get_data_ref(const rms_tagkey_type *);
 void              rms_tagkey_fwrite(const rms_tagkey_type * , FILE *);
 void              rms_tagkey_fprintf(const rms_tagkey_type * , FILE *);
@@ -69,6 +72,8 @@ void rms_tagkey_inplace_sqrt(rms_tagkey_type *);
 void rms_tagkey_inplace_mul(rms_tagkey_type * , const rms_tagkey_type *);
 void rms_tagkey_inplace_add(rms_tagkey_type * , const rms_tagkey_type *);
 void rms_tagkey_inplace_add_scaled(rms_tagkey_type * , const rms_tagkey_type * , double);
+void rms_tagkey_inplace_add_moments(rms_tagkey_type * , rms_tagkey_type * , const rms_tagkey_type * , double);
+void rms_tagkey_inplace_std(rms_tagkey_type * , const rms_tagkey_type * );
 void rms_tagkey_scale(rms_tagkey_type * , double );
 void rms_tagkey_clear(rms_tagkey_type *  );
 int  rms_tagkey_get_sizeof_ctype(const rms_tagkey_type * );
@@ -47,6 +47,21 @@ static const char * rms_comment2          = "Creator: RMS - Reservoir Modelling
 
 
 
+/*
+  The tag directory is built with one pass through the file the first
+  time a tag is looked up. The tags in the directory have the scalar
+  tagkeys loaded, but the data of the numeric arrays is left on disk
+  and only the file offset is recorded; the index_hash gives the first
+  tag with a given name as 'tagname' and, for tags with a 'name'
+  tagkey, as 'tagname:name'.
+*/
+
+typedef struct {
+  offset_type    offset;           /* Offset of the tag in the file. */
+  rms_tag_type * tag;
+} rms_file_index_node_type;
+
+
 struct rms_file_struct {
   char         * filename;
   bool           endian_convert;
@@ -54,6 +69,9 @@ struct rms_file_struct {
   hash_type    * type_map;
   vector_type  * tag_list;
   FILE         * stream;
+  bool           index_loaded;
+  vector_type  * index;            /* rms_file_index_node_type instances in file order. */
+  hash_type    * index_hash;
 };
 
 
@@ -107,7 +125,7 @@ rms_tag_type * rms_file_get_tag_ref(const rms_file_type *rms_file ,
                                     const char *keyvalue, bool abort_on_error) {
 
   rms_tag_type *return_tag = NULL;
-  bool cont;
+  bool cont = true;
   {
     int index = 0;
     while (cont) {
@@ -137,6 +155,29 @@ rms_tag_type * rms_file_get_tag_ref(const rms_file_type *rms_file ,
 
 
 
+static rms_file_index_node_type * rms_file_index_node_alloc(offset_type offset , rms_tag_type * tag) {
+  rms_file_index_node_type * node = util_malloc( sizeof * node );
+  node->offset = offset;
+  node->tag    = tag;
+  return node;
+}
+
+
+static void rms_file_index_node_free__(void * arg) {
+  rms_file_index_node_type * node = (rms_file_index_node_type *) arg;
+  rms_tag_free( node->tag );
+  free( node );
+}
+
+
+static void rms_file_clear_index(rms_file_type * rms_file) {
+  vector_clear( rms_file->index );
+  hash_clear( rms_file->index_hash );
+  rms_file->index_loaded = false;
+}
+
+
+
 /** 
     This function allocates and rms_file_type * handle, but it does
     not load the file content. 
@@ -148,6 +189,9 @@ rms_file_type * rms_file_alloc(const char *filename, bool fmt_file) {
   rms_file->endian_convert  = false;
   rms_file->type_map        = hash_alloc();
   rms_file->tag_list        = vector_alloc_new();
+  rms_file->index           = vector_alloc_new();
+  rms_file->index_hash      = hash_alloc();
+  rms_file->index_loaded    = false;
   
   hash_insert_hash_owned_ref(rms_file->type_map , "byte"   , rms_type_alloc(rms_byte_type ,    1) ,  rms_type_free);
   hash_insert_hash_owned_ref(rms_file->type_map , "bool"   , rms_type_alloc(rms_bool_type,     1) ,  rms_type_free);
@@ -171,6 +215,7 @@ rms_file_type * rms_file_alloc(const char *filename, bool fmt_file) {
 void rms_file_set_filename(rms_file_type * rms_file , const char *filename , bool fmt_file) {
   rms_file->filename = util_realloc_string_copy(rms_file->filename , filename);
   rms_file->fmt_file   = fmt_file;
+  rms_file_clear_index( rms_file );
 }
 
 
@@ -184,6 +229,8 @@ void rms_file_free_data(rms_file_type * rms_file) {
 void rms_file_free(rms_file_type * rms_file) {
   rms_file_free_data(rms_file);
   vector_free( rms_file->tag_list );
+  vector_free( rms_file->index );
+  hash_free( rms_file->index_hash );
   hash_free(rms_file->type_map);
   free(rms_file->filename);
   free(rms_file);
@@ -261,33 +308,113 @@ static void rms_file_init_fread(rms_file_type * rms_file) {
 
 
 
-rms_tag_type * rms_file_fread_alloc_tag(rms_file_type * rms_file , const char *tagname , const char * keyname , const char *keyvalue ) {
-  rms_tag_type * tag = NULL;
-  rms_file_fopen_r(rms_file);
-  {
-  
-    bool cont          = true;
-    bool tag_found     = false;
-    long int start_pos = util_ftell(rms_file->stream);
-    util_fseek(rms_file->stream , 0 , SEEK_SET);
+static void rms_file_fread_index(rms_file_type * rms_file) {
+  if (!rms_file->index_loaded) {
+    bool eof_tag = false;
+    rms_file_clear_index( rms_file );
+    rms_file_fopen_r(rms_file);
     rms_file_init_fread(rms_file);
-    while (cont) {
-      bool eof_tag;
-      rms_tag_type * tmp_tag = rms_tag_fread_alloc(rms_file->stream , rms_file->type_map , rms_file->endian_convert , &eof_tag);
-      if (rms_tag_name_eq(tmp_tag , tagname , keyname , keyvalue)) {
-        tag_found = true;
-        tag = tmp_tag;
-      } else 
-        rms_tag_free(tmp_tag);
-      if (tag_found || eof_tag)
-        cont = false;
+    while (!eof_tag) {
+      offset_type offset = util_ftell(rms_file->stream);
+      rms_tag_type * tag = rms_tag_fread_alloc_index(rms_file->stream , rms_file->type_map , rms_file->endian_convert , &eof_tag);
+      if (!eof_tag) {
+        rms_file_index_node_type * node = rms_file_index_node_alloc( offset , tag );
+        const rms_tagkey_type * name_key = rms_tag_get_key( tag , "name" );
+        const char * tagname = rms_tag_get_name( tag );
+
+        vector_append_owned_ref( rms_file->index , node , rms_file_index_node_free__ );
+        if (!hash_has_key( rms_file->index_hash , tagname ))
+          hash_insert_ref( rms_file->index_hash , tagname , node );
+
+        if ((name_key != NULL) && (rms_tagkey_get_rms_type( name_key ) == rms_char_type)) {
+          char * key = util_alloc_sprintf("%s:%s" , tagname , (const char *) rms_tagkey_get_data_ref( name_key ));
+          if (!hash_has_key( rms_file->index_hash , key ))
+            hash_insert_ref( rms_file->index_hash , key , node );
+          free( key );
+        }
+      } else
+        rms_tag_free(tag);
     }
-    if (tag == NULL) {
-      util_fseek(rms_file->stream , start_pos , SEEK_SET);
-      fprintf(stderr,"%s: could not find tag: \"%s\" (with %s=%s) in file:%s - aborting.\n",__func__ , tagname , keyname , keyvalue , rms_file->filename);
-      abort();
+    rms_file_fclose(rms_file);
+    rms_file->index_loaded = true;
+  }
+}
+
+
+static const rms_file_index_node_type * rms_file_get_index_node(rms_file_type * rms_file , const char *tagname , const char * keyname , const char *keyvalue) {
+  const rms_file_index_node_type * node = NULL;
+  rms_file_fread_index( rms_file );
+
+  if ((keyname == NULL) || (keyvalue == NULL)) {
+    if (hash_has_key( rms_file->index_hash , tagname ))
+      node = hash_get( rms_file->index_hash , tagname );
+  } else if (strcmp( keyname , "name" ) == 0) {
+    char * key = util_alloc_sprintf("%s:%s" , tagname , keyvalue);
+    if (hash_has_key( rms_file->index_hash , key ))
+      node = hash_get( rms_file->index_hash , key );
+    free( key );
+  } else {
+    int index;
+    for (index = 0; index < vector_get_size( rms_file->index ); index++) {
+      const rms_file_index_node_type * index_node = vector_iget_const( rms_file->index , index );
+      if (rms_tag_name_eq( index_node->tag , tagname , keyname , keyvalue )) {
+        node = index_node;
+        break;
+      }
     }
   }
+
+  return node;
+}
+
+
+static const rms_file_index_node_type * rms_file_assert_index_node(rms_file_type * rms_file , const char *tagname , const char * keyname , const char *keyvalue) {
+  const rms_file_index_node_type * node = rms_file_get_index_node( rms_file , tagname , keyname , keyvalue );
+  if (node == NULL) {
+    fprintf(stderr,"%s: could not find tag: \"%s\" (with %s=%s) in file:%s - aborting.\n",__func__ , tagname , keyname , keyvalue , rms_file->filename);
+    abort();
+  }
+  return node;
+}
+
+
+/**
+   Returns the tag from the tag directory, or NULL if the file does
+   not contain such a tag. The data of numeric arrays in the returned
+   tag is not loaded; it can be read into a buffer with
+   rms_file_fread_tagkey_data(). The tag is owned by the rms_file.
+*/
+
+const rms_tag_type * rms_file_get_index_tag(rms_file_type * rms_file , const char *tagname , const char * keyname , const char *keyvalue) {
+  const rms_file_index_node_type * node = rms_file_get_index_node( rms_file , tagname , keyname , keyvalue );
+  if (node != NULL)
+    return node->tag;
+  else
+    return NULL;
+}
+
+
+/**
+   Reads the data of a tagkey from the tag directory straight into
+   the buffer, which must have room for size * sizeof_ctype bytes.
+*/
+
+void rms_file_fread_tagkey_data(rms_file_type * rms_file , const rms_tagkey_type * tagkey , void * buffer) {
+  rms_file_fopen_r(rms_file);
+  rms_tagkey_fread_data_buffer(tagkey , rms_file->stream , buffer);
+  rms_file_fclose(rms_file);
+}
+
+
+
+rms_tag_type * rms_file_fread_alloc_tag(rms_file_type * rms_file , const char *tagname , const char * keyname , const char *keyvalue ) {
+  const rms_file_index_node_type * node = rms_file_assert_index_node( rms_file , tagname , keyname , keyvalue );
+  rms_tag_type * tag;
+  bool eof_tag;
+
+  rms_file_fopen_r(rms_file);
+  util_fseek(rms_file->stream , node->offset , SEEK_SET);
+  tag = rms_tag_fread_alloc(rms_file->stream , rms_file->type_map , rms_file->endian_convert , &eof_tag);
   rms_file_fclose(rms_file);
   return tag;
 }
@@ -312,13 +439,13 @@ void rms_file_fclose(rms_file_type * rms_file) {
 
 
 rms_tagkey_type * rms_file_fread_alloc_data_tagkey(rms_file_type * rms_file , const char *tagname , const char * keyname , const char *keyvalue) {
-  rms_tag_type * tag = rms_file_fread_alloc_tag(rms_file , tagname , keyname , keyvalue);
-  if (tag != NULL) {
-    rms_tagkey_type *tagkey = rms_tagkey_copyc( rms_tag_get_key(tag , "data") );
-    rms_tag_free(tag);
-    return tagkey;
-  } else
-    return NULL;
+  const rms_file_index_node_type * node = rms_file_assert_index_node( rms_file , tagname , keyname , keyvalue );
+  rms_tagkey_type * tagkey = rms_tagkey_copyc( rms_tag_get_datakey( node->tag ) );
+
+  rms_file_fopen_r(rms_file);
+  rms_tagkey_fload_data( tagkey , rms_file->stream );
+  rms_file_fclose(rms_file);
+  return tagkey;
 }
 
 
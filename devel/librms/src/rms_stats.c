@@ -48,9 +48,7 @@ void rms_stats_mean_std(rms_tagkey_type * mean , rms_tagkey_type * std , const c
       if (log_transform)
         rms_tagkey_inplace_log10(file_tag);
       
-      rms_tagkey_inplace_add_scaled(mean , file_tag , norm);
-      rms_tagkey_inplace_sqr(file_tag);
-      rms_tagkey_inplace_add_scaled(std , file_tag , norm);
+      rms_tagkey_inplace_add_moments(mean , std , file_tag , norm);
       rms_tagkey_free(file_tag);
     
       rms_file_free(rms_file);
@@ -62,15 +60,7 @@ void rms_stats_mean_std(rms_tagkey_type * mean , rms_tagkey_type * std , const c
   }
   printf("\n");
   
-  {
-    rms_tagkey_type * mean2;
-    mean2 = rms_tagkey_copyc(mean);
-    rms_tagkey_inplace_sqr(mean2);
-    
-    rms_tagkey_inplace_add_scaled(std , mean2 , -1.0);
-    rms_tagkey_inplace_sqrt(std);
-    rms_tagkey_free(mean2);
-  }
+  rms_tagkey_inplace_std(std , mean);
 }
 
 
@@ -171,7 +171,8 @@ static void rms_tag_add_tagkey(const rms_tag_type *tag , const rms_tagkey_type *
 
   switch (mem_mode) {
   case(COPY):
-    vector_append_owned_ref( tag->key_list , rms_tagkey_copyc( tagkey ) , rms_tagkey_free_ );
+    tagkey = rms_tagkey_copyc( tagkey );   /* The hash below must refer to the copy. */
+    vector_append_owned_ref( tag->key_list , tagkey , rms_tagkey_free_ );
     break;
   case(OWNED_REF):
     vector_append_owned_ref( tag->key_list , tagkey , rms_tagkey_free_ );
@@ -187,7 +188,7 @@ static void rms_tag_add_tagkey(const rms_tag_type *tag , const rms_tagkey_type *
 
 
 static bool rms_tag_at_endtag(FILE *stream) {
-  const int init_pos = util_ftell(stream);
+  const offset_type init_pos = util_ftell(stream);
   bool at_endtag;
   char tag[7];
   if (rms_util_fread_string(tag , 7 , stream)) {
@@ -226,6 +227,23 @@ rms_tag_type * rms_tag_fread_alloc(FILE *stream , hash_type *type_map , bool end
 
 
 
+/**
+   Reads the tag like rms_tag_fread_alloc(), but the data of numeric
+   arrays is left on disk; see rms_tagkey_fread_alloc_index().
+*/
+
+rms_tag_type * rms_tag_fread_alloc_index(FILE *stream , hash_type *type_map , bool endian_convert , bool *at_eof) {
+  rms_tag_type *tag = rms_tag_alloc(NULL);
+  rms_tag_fread_header(tag , stream , at_eof);
+  if (!*at_eof) {
+    while (! rms_tag_at_endtag(stream))
+      rms_tag_add_tagkey(tag , rms_tagkey_fread_alloc_index(endian_convert , stream , type_map) , OWNED_REF);
+  }
+  return tag;
+}
+
+
+
 void rms_tag_fwrite(const rms_tag_type * tag , FILE * stream) {
   rms_util_fwrite_string("tag"     , stream);
   rms_util_fwrite_string(tag->name , stream);
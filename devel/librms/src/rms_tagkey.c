@@ -24,6 +24,7 @@
 
 #include <ert/util/util.h>
 #include <ert/util/hash.h>
+#include <ert/util/elementwise.h>
 
 #include <ert/rms/rms_type.h>
 #include <ert/rms/rms_tagkey.h>
@@ -51,6 +52,7 @@ struct rms_tagkey_struct {
   void                *data;
   bool                 endian_convert;
   bool                 shared_data;
+  offset_type          data_offset;    /* File offset of the data when it has been left on disk; -1 when the data is in memory. */
 };
 
 
@@ -131,25 +133,14 @@ int i;
 
 
 void rms_tagkey_inplace_sqr(rms_tagkey_type * tagkey) {
-  int i;
   rms_tagkey_assert_fnum(tagkey);
   switch (tagkey->rms_type) {
   case(rms_double_type):
-    {
-      double *tmp = (double *) tagkey->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp[i] *= tmp[i];
-    }
+    elementwise_sqr_double( tagkey->data , tagkey->size );
     break;
-
   case(rms_float_type):
-    {
-      float *tmp = (float *) tagkey->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp[i] *= tmp[i];
-    }
+    elementwise_sqr_float( tagkey->data , tagkey->size );
     break;
-
   default:
     fprintf(stderr,"%s: only implemented for rms_double_type and rms_float_type - aborting \n",__func__);
     abort();
@@ -163,25 +154,14 @@ void rms_tagkey_assign(rms_tagkey_type * new, const rms_tagkey_type *src) {
 
 
 void rms_tagkey_inplace_log10(rms_tagkey_type * tagkey) {
-  int i;
   rms_tagkey_assert_fnum(tagkey);
   switch (tagkey->rms_type) {
   case(rms_double_type):
-    {
-      double *tmp = (double *) tagkey->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp[i] = log10(tmp[i]);
-    }
+    elementwise_log10_double( tagkey->data , tagkey->size );
     break;
-
   case(rms_float_type):
-    {
-      float *tmp = (float *) tagkey->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp[i] = log10(tmp[i]);
-    }
+    elementwise_log10_float( tagkey->data , tagkey->size );
     break;
-    
   default:
     fprintf(stderr,"%s: only implemented for rms_double_type and rms_float_type - aborting \n",__func__);
     abort();
@@ -190,25 +170,16 @@ void rms_tagkey_inplace_log10(rms_tagkey_type * tagkey) {
 
 
 void rms_tagkey_inplace_sqrt(rms_tagkey_type * tagkey) {
-  int i;
   rms_tagkey_assert_fnum(tagkey);
   switch (tagkey->rms_type) {
   case(rms_double_type):
-    {
-      double *tmp = (double *) tagkey->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp[i] = sqrt(util_double_max(0.0 , tmp[i]));
-    }
+    elementwise_clamp_double( tagkey->data , 0 , INFINITY , tagkey->size );
+    elementwise_sqrt_double( tagkey->data , tagkey->size );
     break;
-    
   case(rms_float_type):
-    {
-      float *tmp = (float *) tagkey->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp[i] = sqrtf(util_float_max(0.0 , tmp[i]));
-    }
+    elementwise_clamp_float( tagkey->data , 0 , INFINITY , tagkey->size );
+    elementwise_sqrt_float( tagkey->data , tagkey->size );
     break;
-
   default:
     fprintf(stderr,"%s: only implemented for rms_double_type and rms_float_type - aborting \n",__func__);
     abort();
@@ -217,25 +188,14 @@ void rms_tagkey_inplace_sqrt(rms_tagkey_type * tagkey) {
 
 
 void rms_tagkey_scale(rms_tagkey_type * tagkey , double scale_factor) {
-  int i;
   rms_tagkey_assert_fnum(tagkey);
   switch (tagkey->rms_type) {
   case(rms_double_type):
-    {
-      double *tmp = (double *) tagkey->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp[i] *= scale_factor;
-    }
+    elementwise_scale_double( tagkey->data , scale_factor , tagkey->size );
     break;
-
   case(rms_float_type):
-    {
-      float *tmp = (float *) tagkey->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp[i] *= scale_factor;
-    }
+    elementwise_scale_float( tagkey->data , scale_factor , tagkey->size );
     break;
-
   default:
     fprintf(stderr,"%s: only implemented for rms_double_type and rms_float_type - aborting \n",__func__);
     abort();
@@ -244,27 +204,14 @@ void rms_tagkey_scale(rms_tagkey_type * tagkey , double scale_factor) {
 
 
 void rms_tagkey_inplace_add(rms_tagkey_type * tagkey , const rms_tagkey_type *delta) {
-  int i;
   rms_tagkey_assert_fnum2(tagkey , delta);
   switch (tagkey->rms_type) {
   case(rms_double_type):
-    {
-      double *tmp1       = (double *) tagkey->data;
-      const double *tmp2 = (const double *) delta->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp1[i] += tmp2[i];
-    }
+    elementwise_add_double( tagkey->data , delta->data , tagkey->size );
     break;
-    
   case(rms_float_type):
-    {
-      float *tmp1       = (float *) tagkey->data;
-      const float *tmp2 = (const float *) delta->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp1[i] += tmp2[i];
-    }
+    elementwise_add_float( tagkey->data , delta->data , tagkey->size );
     break;
-
   default:
     fprintf(stderr,"%s: only implemented for rms_double_type and rms_float_type - aborting \n",__func__);
     abort();
@@ -273,27 +220,14 @@ void rms_tagkey_inplace_add(rms_tagkey_type * tagkey , const rms_tagkey_type *de
 
 
 void rms_tagkey_inplace_add_scaled(rms_tagkey_type * tagkey , const rms_tagkey_type *delta, double factor) {
-  int i;
   rms_tagkey_assert_fnum2(tagkey , delta);
   switch (tagkey->rms_type) {
   case(rms_double_type):
-    {
-      double *tmp1       = (double *) tagkey->data;
-      const double *tmp2 = (const double *) delta->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp1[i] += tmp2[i] * factor;
-    }
+    elementwise_axpy_double( tagkey->data , factor , delta->data , tagkey->size );
     break;
-    
   case(rms_float_type):
-    {
-      float *tmp1       = (float *) tagkey->data;
-      const float *tmp2 = (const float *) delta->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp1[i] += tmp2[i] * factor;
-    }
+    elementwise_axpy_float( tagkey->data , factor , delta->data , tagkey->size );
     break;
-
   default:
     fprintf(stderr,"%s: only implemented for rms_double_type and rms_float_type - aborting \n",__func__);
     abort();
@@ -302,27 +236,54 @@ void rms_tagkey_inplace_add_scaled(rms_tagkey_type * tagkey , const rms_tagkey_t
 
 
 void rms_tagkey_inplace_mul(rms_tagkey_type * tagkey , const rms_tagkey_type *delta) {
-  int i;
   rms_tagkey_assert_fnum2(tagkey , delta);
   switch (tagkey->rms_type) {
   case(rms_double_type):
-    {
-      double *tmp1       = (double *) tagkey->data;
-      const double *tmp2 = (const double *) delta->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp1[i] *= tmp2[i];
-    }
+    elementwise_mul_double( tagkey->data , delta->data , tagkey->size );
+    break;
+  case(rms_float_type):
+    elementwise_mul_float( tagkey->data , delta->data , tagkey->size );
+    break;
+  default:
+    fprintf(stderr,"%s: only implemented for rms_double_type and rms_float_type - aborting \n",__func__);
+    abort();
+  }
+}
+
+
+/**
+   Adds weight * x to mean and weight * x^2 to sqr_mean in one pass
+   over the data; after all the ensemble members have been added with
+   weight 1/N rms_tagkey_inplace_std() will turn sqr_mean into the
+   standard deviation.
+*/
+
+void rms_tagkey_inplace_add_moments(rms_tagkey_type * mean , rms_tagkey_type * sqr_mean , const rms_tagkey_type * x , double weight) {
+  rms_tagkey_assert_fnum2(mean , x);
+  rms_tagkey_assert_fnum2(sqr_mean , x);
+  switch (x->rms_type) {
+  case(rms_double_type):
+    elementwise_moments_double( mean->data , sqr_mean->data , x->data , weight , x->size );
+    break;
+  case(rms_float_type):
+    elementwise_moments_float( mean->data , sqr_mean->data , x->data , weight , x->size );
     break;
+  default:
+    fprintf(stderr,"%s: only implemented for rms_double_type and rms_float_type - aborting \n",__func__);
+    abort();
+  }
+}
 
+
+void rms_tagkey_inplace_std(rms_tagkey_type * sqr_mean , const rms_tagkey_type * mean) {
+  rms_tagkey_assert_fnum2(sqr_mean , mean);
+  switch (mean->rms_type) {
+  case(rms_double_type):
+    elementwise_std_double( sqr_mean->data , mean->data , mean->size );
+    break;
   case(rms_float_type):
-    {
-      float *tmp1       = (float *) tagkey->data;
-      const float *tmp2 = (const float *) delta->data;
-      for (i=0; i < tagkey->size; i++)
-        tmp1[i] *= tmp2[i];
-    }
+    elementwise_std_float( sqr_mean->data , mean->data , mean->size );
     break;
-    
   default:
     fprintf(stderr,"%s: only implemented for rms_double_type and rms_float_type - aborting \n",__func__);
     abort();
@@ -402,9 +363,12 @@ rms_tagkey_type * rms_tagkey_copyc(const rms_tagkey_type *tagkey) {
   new_tagkey->rms_type       = tagkey->rms_type;
   new_tagkey->data           = NULL;
   new_tagkey->shared_data    = tagkey->shared_data;
+  new_tagkey->data_offset    = tagkey->data_offset;
 
-  rms_tagkey_alloc_data(new_tagkey);    
-  memcpy(new_tagkey->data , tagkey->data , tagkey->data_size);
+  if (tagkey->data_offset < 0) {
+    rms_tagkey_alloc_data(new_tagkey);
+    memcpy(new_tagkey->data , tagkey->data , tagkey->data_size);
+  }
   new_tagkey->name = util_alloc_string_copy(tagkey->name);
   return new_tagkey;
 }
@@ -500,7 +464,83 @@ static void rms_fread_realloc_tagkey(rms_tagkey_type *tagkey , bool endian_conve
   rms_fread_tagkey_header(tagkey , stream , type_map);
   rms_tagkey_alloc_data(tagkey);
   rms_tagkey_fread_data(tagkey , endian_convert , stream);
+  tagkey->data_offset = -1;
+}
+
+
+
+/**
+   Reads the tagkey header; for numeric arrays the data is not read,
+   instead the file offset of the data is recorded and the stream is
+   positioned after the data. Scalars and char arrays are small and
+   loaded as usual, so the name keys can still be compared with
+   rms_tagkey_char_eq(). Use rms_tagkey_fread_data_buffer() to get the
+   data of a tagkey which has been left on disk.
+*/
+
+rms_tagkey_type * rms_tagkey_fread_alloc_index(bool endian_convert , FILE * stream , hash_type * type_map) {
+  rms_tagkey_type * tagkey = rms_tagkey_alloc_empty(endian_convert);
+  rms_fread_tagkey_header(tagkey , stream , type_map);
+  if (tagkey->size > 1 && tagkey->rms_type != rms_char_type) {
+    tagkey->data_offset = util_ftell(stream);
+    util_fseek(stream , (offset_type) tagkey->size * tagkey->sizeof_ctype , SEEK_CUR);
+  } else {
+    rms_tagkey_alloc_data(tagkey);
+    rms_tagkey_fread_data(tagkey , endian_convert , stream);
+  }
+  return tagkey;
+}
+
+
+
+/**
+   Copies the data of the tagkey into the caller supplied buffer,
+   which must have room for size * sizeof_ctype bytes. If the data is
+   still on disk it is read straight from the stream into the buffer
+   in blocks, and each block is byteswapped while it is still in
+   cache; the tagkey itself does not allocate any storage.
+*/
 
+#define RMS_TAGKEY_READ_BLOCK (1 << 20)
+
+void rms_tagkey_fread_data_buffer(const rms_tagkey_type * tagkey , FILE * stream , void * _buffer) {
+  if (tagkey->data_offset < 0)
+    memcpy(_buffer , tagkey->data , tagkey->data_size);
+  else {
+    char * buffer        = (char *) _buffer;
+    int block_elements   = RMS_TAGKEY_READ_BLOCK / tagkey->sizeof_ctype;
+    int elements_read    = 0;
+
+    util_fseek(stream , tagkey->data_offset , SEEK_SET);
+    while (elements_read < tagkey->size) {
+      int elements = util_int_min(block_elements , tagkey->size - elements_read);
+      char * block = &buffer[ (size_t) elements_read * tagkey->sizeof_ctype ];
+
+      if (fread(block , tagkey->sizeof_ctype , elements , stream) != elements)
+        util_abort("%s: failed to read %d elements of tagkey:%s - premature EOF? \n",__func__ , tagkey->size , tagkey->name);
+
+      if (tagkey->endian_convert && tagkey->sizeof_ctype > 1)
+        util_endian_flip_vector(block , tagkey->sizeof_ctype , elements);
+      elements_read += elements;
+    }
+  }
+}
+
+#undef RMS_TAGKEY_READ_BLOCK
+
+
+
+/**
+   Loads the data of a tagkey which has been left on disk, after this
+   the tagkey behaves as a normally loaded tagkey.
+*/
+
+void rms_tagkey_fload_data(rms_tagkey_type * tagkey , FILE * stream) {
+  if (tagkey->data_offset >= 0) {
+    rms_tagkey_alloc_data(tagkey);
+    rms_tagkey_fread_data_buffer(tagkey , stream , tagkey->data);
+    tagkey->data_offset = -1;
+  }
 }
 
 
@@ -572,6 +612,7 @@ rms_tagkey_type * rms_tagkey_alloc_empty(bool endian_convert) {
   tagkey->data            = NULL;
   tagkey->endian_convert  = endian_convert;
   tagkey->shared_data     = false;
+  tagkey->data_offset     = -1;
   
   return tagkey;
   
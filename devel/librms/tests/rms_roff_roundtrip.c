@@ -0,0 +1,202 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'rms_roff_roundtrip.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/rms/rms_file.h>
+#include <ert/rms/rms_tag.h>
+#include <ert/rms/rms_tagkey.h>
+#include <ert/rms/rms_type.h>
+
+#define NX 4
+#define NY 3
+#define NZ 2
+#define BIG_SIZE 300007        /* More than the 1 MB read block of rms_tagkey_fread_data_buffer(). */
+
+
+static void write_parameter( FILE * stream , const char * name , int size , rms_type_enum rms_type , const void * data ) {
+  rms_tagkey_type * data_key = rms_tagkey_alloc_complete( "data" , size , rms_type , data , true );
+  rms_tag_fwrite_parameter( name , data_key , stream );
+  rms_tagkey_free( data_key );
+}
+
+
+static void write_roff( const char * filename , const float * poro , const int * facies ) {
+  rms_file_type * rms_file = rms_file_alloc( filename , false );
+  FILE * stream = rms_file_fopen_w( rms_file );
+
+  rms_file_init_fwrite( rms_file , "parameter" );
+  rms_tag_fwrite_dimensions( NX , NY , NZ , stream );
+  write_parameter( stream , "PORO" , NX*NY*NZ , rms_float_type , poro );
+  write_parameter( stream , "FACIES" , NX*NY*NZ , rms_int_type , facies );
+  rms_file_complete_fwrite( rms_file );
+  rms_file_fclose( rms_file );
+  rms_file_free( rms_file );
+}
+
+
+void test_roundtrip( ) {
+  const int size = NX*NY*NZ;
+  float poro[NX*NY*NZ];
+  int facies[NX*NY*NZ];
+
+  for (int i = 0; i < size; i++) {
+    poro[i] = 0.01 * i;
+    facies[i] = i % 3;
+  }
+  write_roff( "grid.roff" , poro , facies );
+
+  /* Selective loading through the tag directory. */
+  {
+    rms_file_type * rms_file = rms_file_alloc( "grid.roff" , false );
+    const rms_tag_type * tag = rms_file_get_index_tag( rms_file , "parameter" , "name" , "PORO" );
+    float poro_buffer[NX*NY*NZ];
+    int facies_buffer[NX*NY*NZ];
+
+    test_assert_not_NULL( tag );
+    test_assert_int_equal( size , rms_tagkey_get_size( rms_tag_get_datakey( tag )));
+    rms_file_fread_tagkey_data( rms_file , rms_tag_get_datakey( tag ) , poro_buffer );
+    test_assert_true( memcmp( poro , poro_buffer , sizeof poro ) == 0 );
+
+    tag = rms_file_get_index_tag( rms_file , "parameter" , "name" , "FACIES" );
+    test_assert_not_NULL( tag );
+    rms_file_fread_tagkey_data( rms_file , rms_tag_get_datakey( tag ) , facies_buffer );
+    test_assert_true( memcmp( facies , facies_buffer , sizeof facies ) == 0 );
+
+    test_assert_NULL( rms_file_get_index_tag( rms_file , "parameter" , "name" , "PERMX" ));
+    {
+      rms_tagkey_type * data_key = rms_file_fread_alloc_data_tagkey( rms_file , "parameter" , "name" , "PORO" );
+      test_assert_true( memcmp( poro , rms_tagkey_get_data_ref( data_key ) , sizeof poro ) == 0 );
+      rms_tagkey_free( data_key );
+    }
+    rms_file_free( rms_file );
+  }
+
+  /* Loading everything. */
+  {
+    rms_file_type * rms_file = rms_file_alloc( "grid.roff" , false );
+    int dims[3];
+    rms_tag_type * tag;
+
+    rms_file_fread( rms_file );
+    rms_file_get_dims( rms_file , dims );
+    test_assert_int_equal( NX , dims[0] );
+    test_assert_int_equal( NY , dims[1] );
+    test_assert_int_equal( NZ , dims[2] );
+
+    tag = rms_file_get_tag_ref( rms_file , "parameter" , "name" , "FACIES" , true );
+    test_assert_true( memcmp( facies , rms_tagkey_get_data_ref( rms_tag_get_datakey( tag )) , sizeof facies ) == 0 );
+    tag = rms_file_get_tag_ref( rms_file , "parameter" , "name" , "PORO" , true );
+    test_assert_true( memcmp( poro , rms_tagkey_get_data_ref( rms_tag_get_datakey( tag )) , sizeof poro ) == 0 );
+    test_assert_NULL( rms_file_get_tag_ref( rms_file , "parameter" , "name" , "PERMX" , false ));
+    rms_file_free( rms_file );
+  }
+}
+
+
+/*
+  Sets the byteswaptest value in the file to 1 in the opposite byte
+  order, so that the file is read as a file from a machine with the
+  other endianness.
+*/
+
+static void flip_byteswaptest( const char * filename ) {
+  int size;
+  char * content = util_fread_alloc_file_content( filename , &size );
+  const char * key = "byteswaptest";
+  int offset = 0;
+
+  while ((offset + strlen( key ) + 1 + sizeof(int) <= size) && (memcmp( &content[offset] , key , strlen( key ) + 1) != 0))
+    offset++;
+  test_assert_true( offset + strlen( key ) + 1 + sizeof(int) <= size );
+  {
+    int * value = (int *) &content[offset + strlen( key ) + 1];
+    test_assert_int_equal( 1 , *value );
+    util_endian_flip_vector( value , sizeof * value , 1 );
+  }
+
+  {
+    FILE * stream = util_fopen( filename , "w" );
+    util_fwrite( content , 1 , size , stream , __func__ );
+    fclose( stream );
+  }
+  free( content );
+}
+
+
+void test_endian_flip( ) {
+  float * values  = util_calloc( BIG_SIZE , sizeof * values );
+  float * flipped = util_calloc( BIG_SIZE , sizeof * flipped );
+  float * buffer  = util_calloc( BIG_SIZE , sizeof * buffer );
+
+  for (int i = 0; i < BIG_SIZE; i++)
+    values[i] = 0.5 * i;
+  memcpy( flipped , values , BIG_SIZE * sizeof * values );
+  util_endian_flip_vector( flipped , sizeof * flipped , BIG_SIZE );
+
+  {
+    rms_file_type * rms_file = rms_file_alloc( "flipped.roff" , false );
+    FILE * stream = rms_file_fopen_w( rms_file );
+    rms_file_init_fwrite( rms_file , "parameter" );
+    write_parameter( stream , "BIG" , BIG_SIZE , rms_float_type , flipped );
+    rms_file_complete_fwrite( rms_file );
+    rms_file_fclose( rms_file );
+    rms_file_free( rms_file );
+  }
+  flip_byteswaptest( "flipped.roff" );
+
+  {
+    rms_file_type * rms_file = rms_file_alloc( "flipped.roff" , false );
+    const rms_tag_type * tag = rms_file_get_index_tag( rms_file , "parameter" , "name" , "BIG" );
+
+    test_assert_not_NULL( tag );
+    test_assert_int_equal( BIG_SIZE , rms_tagkey_get_size( rms_tag_get_datakey( tag )));
+    rms_file_fread_tagkey_data( rms_file , rms_tag_get_datakey( tag ) , buffer );
+    test_assert_true( memcmp( values , buffer , BIG_SIZE * sizeof * values ) == 0 );
+    rms_file_free( rms_file );
+  }
+
+  {
+    rms_file_type * rms_file = rms_file_alloc( "flipped.roff" , false );
+    rms_tag_type * tag;
+
+    rms_file_fread( rms_file );
+    tag = rms_file_get_tag_ref( rms_file , "parameter" , "name" , "BIG" , true );
+    test_assert_true( memcmp( values , rms_tagkey_get_data_ref( rms_tag_get_datakey( tag )) , BIG_SIZE * sizeof * values ) == 0 );
+    rms_file_free( rms_file );
+  }
+
+  free( buffer );
+  free( flipped );
+  free( values );
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "rms_roff_roundtrip" , false );
+  test_roundtrip( );
+  test_endian_flip( );
+  test_work_area_free( work_area );
+  exit(0);
+}
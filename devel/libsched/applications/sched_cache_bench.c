@@ -0,0 +1,109 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'sched_cache_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <ert/util/util.h>
+#include <ert/util/timer.h>
+
+#include <ert/sched/sched_file.h>
+
+/*
+  Compares parsing a generated schedule file with loading it from the
+  binary schedule cache:
+
+     sched_cache_bench  [num_wells]  [num_steps]
+
+  The defaults are 500 wells and 2000 report steps, with WELSPECS and
+  COMPDAT for all wells and every fourth well in WCONHIST at each step.
+*/
+
+static void write_schedule( const char * filename , int num_wells , int num_steps ) {
+  FILE * stream = util_fopen( filename , "w" );
+  fprintf(stream , "WELSPECS\n");
+  for (int iw = 0; iw < num_wells; iw++)
+    fprintf(stream , "  'OP_%d'  'G1'  %d  %d  1*  'OIL' /\n" , iw , 1 + iw % 50 , 1 + iw / 50);
+  fprintf(stream , "/\n\nCOMPDAT\n");
+  for (int iw = 0; iw < num_wells; iw++)
+    fprintf(stream , "  'OP_%d'  %d  %d  1  5  'OPEN'  1*  1*  0.2 /\n" , iw , 1 + iw % 50 , 1 + iw / 50);
+  fprintf(stream , "/\n\n");
+
+  for (int step = 0; step < num_steps; step++) {
+    fprintf(stream , "WCONHIST\n");
+    for (int iw = 0; iw < num_wells; iw++) {
+      if (((iw + step) % 4) == 0)
+        fprintf(stream , "  'OP_%d'  'OPEN'  'RESV'  %d.5  10  1000 /\n" , iw , step + iw);
+    }
+    fprintf(stream , "/\n\nDATES\n  %d 'JAN' %d /\n/\n\n" , 1 + step % 28 , 1950 + step / 12);
+  }
+  fclose( stream );
+}
+
+
+int main( int argc , char ** argv ) {
+  int num_wells = 500;
+  int num_steps = 2000;
+  if (argc > 1) util_sscanf_int( argv[1] , &num_wells );
+  if (argc > 2) util_sscanf_int( argv[2] , &num_steps );
+
+  {
+    char * filename   = util_alloc_tmp_file( "/tmp" , "sched_cache_bench" , false );
+    char * cache_file = util_alloc_sprintf( "%s.cache" , filename );
+    time_t start_time = util_make_date( 1 , 1 , 1950 );
+    timer_type * timer = timer_alloc( false );
+    sched_file_type * parsed;
+    sched_file_type * cached;
+    double parse_time , write_time , load_time;
+    bool   cache_valid;
+
+    write_schedule( filename , num_wells , num_steps );
+    timer_start( timer );
+    parsed = sched_file_parse_alloc( filename , start_time );
+    parse_time = timer_stop( timer );
+
+    timer_reset( timer );
+    timer_start( timer );
+    sched_file_fwrite_cache( parsed , cache_file );
+    write_time = timer_stop( timer );
+
+    timer_reset( timer );
+    timer_start( timer );
+    cached = sched_file_alloc( start_time );
+    cache_valid = sched_file_fread_cache( cached , filename , cache_file );
+    load_time = timer_stop( timer );
+
+    printf("Wells: %d   Report steps: %d   Schedule: %zd bytes   Cache: %zd bytes\n" , num_wells , num_steps , util_file_size( filename ) , util_file_size( cache_file ));
+    printf("Parse schedule file         : %8.3f s\n" , parse_time );
+    printf("Write cache                 : %8.3f s\n" , write_time );
+    printf("Load cache                  : %8.3f s\n" , load_time );
+    printf("Cache is %s - restart files: %d / %d\n" , cache_valid ? "valid" : "INVALID" ,
+           sched_file_get_num_restart_files( parsed ) ,
+           sched_file_get_num_restart_files( cached ));
+
+    sched_file_free( cached );
+    sched_file_free( parsed );
+    timer_free( timer );
+    util_unlink_existing( cache_file );
+    util_unlink_existing( filename );
+    free( cache_file );
+    free( filename );
+  }
+  exit(0);
+}
@@ -0,0 +1,131 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'sched_well_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <ert/util/util.h>
+#include <ert/util/timer.h>
+
+#include <ert/sched/sched_file.h>
+#include <ert/sched/sched_kw.h>
+#include <ert/sched/sched_kw_wconhist.h>
+
+/*
+  Times the per well schedule queries on a generated schedule file:
+
+     sched_well_bench  [num_wells]  [num_steps]
+
+  For every well and report step sched_file_well_open() and
+  sched_file_well_wconhist_rate() are called, as when building
+  observation vectors; this is compared with walking backwards through
+  the blocks, as the queries did before the well index. The defaults
+  are 500 wells and 1000 report steps, with every well in WCONHIST
+  every 10th step.
+*/
+
+static void write_schedule( const char * filename , int num_wells , int num_steps ) {
+  FILE * stream = util_fopen( filename , "w" );
+  for (int step = 0; step < num_steps; step++) {
+    fprintf(stream , "WCONHIST\n");
+    for (int iw = 0; iw < num_wells; iw++) {
+      if (((iw + step) % 10) == 0)
+        fprintf(stream , "  'OP_%d'  'OPEN'  'RESV'  %d  10  1000 /\n" , iw , step + iw);
+    }
+    fprintf(stream , "/\n\nTSTEP\n  1 /\n\n");
+  }
+  fclose( stream );
+}
+
+
+static double block_walk_rate( const sched_file_type * sched_file , int restart_nr , const char * well_name ) {
+  double rate = -1;
+  bool well_found = false;
+  int block_nr = restart_nr;
+  while (!well_found && (block_nr >= 0)) {
+    sched_block_type * block = sched_file_iget_block( sched_file , block_nr );
+    for (int ikw = 0; ikw < sched_block_get_size( block ); ikw++) {
+      sched_kw_type * kw = sched_block_iget_kw( block , ikw );
+      if ((sched_kw_get_type( kw ) == WCONHIST) && sched_kw_has_well( kw , well_name )) {
+        well_found = true;
+        rate = sched_kw_wconhist_get_orat( sched_kw_get_data( kw ) , well_name );
+      }
+    }
+    block_nr--;
+  }
+  return rate;
+}
+
+
+int main( int argc , char ** argv ) {
+  int num_wells = 500;
+  int num_steps = 1000;
+  if (argc > 1) util_sscanf_int( argv[1] , &num_wells );
+  if (argc > 2) util_sscanf_int( argv[2] , &num_steps );
+
+  {
+    char * filename = util_alloc_tmp_file( "/tmp" , "sched_well_bench" , false );
+    timer_type * timer = timer_alloc( false );
+    sched_file_type * sched_file;
+    double parse_time , walk_time , index_time;
+    double walk_sum  = 0;
+    double index_sum = 0;
+    int    num_open  = 0;
+
+    write_schedule( filename , num_wells , num_steps );
+    timer_start( timer );
+    sched_file = sched_file_parse_alloc( filename , util_make_date( 1 , 1 , 2000 ));
+    parse_time = timer_stop( timer );
+
+    timer_reset( timer );
+    timer_start( timer );
+    for (int iw = 0; iw < num_wells; iw++) {
+      char * well_name = util_alloc_sprintf( "OP_%d" , iw );
+      for (int step = 0; step <= num_steps; step++)
+        walk_sum += block_walk_rate( sched_file , step , well_name );
+      free( well_name );
+    }
+    walk_time = timer_stop( timer );
+
+    timer_reset( timer );
+    timer_start( timer );
+    for (int iw = 0; iw < num_wells; iw++) {
+      char * well_name = util_alloc_sprintf( "OP_%d" , iw );
+      for (int step = 0; step <= num_steps; step++) {
+        index_sum += sched_file_well_wconhist_rate( sched_file , step , well_name );
+        if (sched_file_well_open( sched_file , step , well_name ))
+          num_open++;
+      }
+      free( well_name );
+    }
+    index_time = timer_stop( timer );
+
+    printf("Wells: %d   Report steps: %d   Open well-steps: %d\n" , num_wells , num_steps , num_open);
+    printf("Parse + index               : %8.3f s\n" , parse_time );
+    printf("Block walk (rate)           : %8.3f s\n" , walk_time );
+    printf("Well index (rate + open)    : %8.3f s\n" , index_time );
+    printf("Results are %s\n" , (walk_sum == index_sum) ? "identical" : "DIFFERENT");
+
+    sched_file_free( sched_file );
+    timer_free( timer );
+    util_unlink_existing( filename );
+    free( filename );
+  }
+  exit(0);
+}
@@ -43,6 +43,9 @@ void                 sched_file_free(sched_file_type *);
 void                 sched_file_parse(sched_file_type *, const char *);
 void                 sched_file_parse_append(sched_file_type *  , const char * );
 sched_file_type *    sched_file_parse_alloc(const char * , time_t);
+void                 sched_file_parse_cached( sched_file_type * sched_file , const char * filename , const char * cache_file );
+void                 sched_file_fwrite_cache( const sched_file_type * sched_file , const char * cache_file );
+bool                 sched_file_fread_cache( sched_file_type * sched_file , const char * filename , const char * cache_file );
 void                 sched_file_fprintf_i(const sched_file_type *, int, const char *);
 void                 sched_file_fprintf(const sched_file_type * sched_file, const char * file);
 
@@ -26,6 +26,7 @@ extern "C" {
 #include <time.h>
 
 #include <ert/util/hash.h>
+#include <ert/util/buffer.h>
 
 #include <ert/sched/sched_types.h>
               
@@ -42,6 +43,9 @@ typedef struct sched_kw_struct sched_kw_type;
   sched_kw_type_enum      sched_kw_get_type(const sched_kw_type *);
   sched_kw_type         * sched_kw_token_alloc(const stringlist_type * tokens, int * token_index, hash_type * fixed_length_table, bool * foundEND);
   void                    sched_kw_fprintf(const sched_kw_type *, FILE *);
+  bool                    sched_kw_has_buffer_io( const sched_kw_type * sched_kw );
+  void                    sched_kw_buffer_fwrite( const sched_kw_type * sched_kw , buffer_type * buffer );
+  sched_kw_type         * sched_kw_buffer_fread_alloc( buffer_type * buffer );
   void                    sched_kw_free(sched_kw_type *);
   
   sched_kw_type         * sched_kw_alloc_copy(const sched_kw_type * );
@@ -56,6 +60,7 @@ typedef struct sched_kw_struct sched_kw_type;
   const char            * sched_kw_get_name( const sched_kw_type * kw);
   bool                    sched_kw_has_well( const sched_kw_type * sched_kw , const char * well );
   bool                    sched_kw_well_open( const sched_kw_type * sched_kw , const char * well );
+  bool                    sched_kw_iwell_open( const sched_kw_type * sched_kw , int well_index );
   
 #ifdef __cplusplus
 }
@@ -26,6 +26,7 @@ extern "C" {
 #include <time.h>
 
 #include <ert/util/stringlist.h>
+#include <ert/util/buffer.h>
 
 #include <ert/sched/sched_macros.h>
 
@@ -37,6 +38,8 @@ void                    sched_kw_dates_fprintf(const sched_kw_dates_type * , FIL
 void                    sched_kw_dates_free(sched_kw_dates_type * );
 void                    sched_kw_dates_fwrite(const sched_kw_dates_type * , FILE * );
 sched_kw_dates_type   * sched_kw_dates_fread_alloc(FILE * );
+void                    sched_kw_dates_buffer_fwrite(const sched_kw_dates_type * kw , buffer_type * buffer);
+sched_kw_dates_type   * sched_kw_dates_buffer_fread_alloc(buffer_type * buffer);
 
 int                     sched_kw_dates_get_size(const sched_kw_dates_type *);
 sched_kw_dates_type   * sched_kw_dates_alloc_from_time_t(time_t );
@@ -46,6 +49,7 @@ time_t                  sched_kw_dates_iget_date(const sched_kw_dates_type *, in
 
 
 KW_HEADER(dates)
+KW_BUFFER_IO_HEADER(dates)
 
 #ifdef __cplusplus
 }
@@ -24,6 +24,7 @@ extern "C" {
 #include <time.h>
 
 #include <ert/util/hash.h>
+#include <ert/util/buffer.h>
 
 #include <ert/sched/sched_macros.h>
 
@@ -34,6 +35,8 @@ void                  sched_kw_tstep_free(sched_kw_tstep_type * );
 void                  sched_kw_tstep_fprintf(const sched_kw_tstep_type *, FILE *);
 void                  sched_kw_tstep_fwrite(const sched_kw_tstep_type * , FILE *);
 sched_kw_tstep_type * sched_kw_tstep_fread_alloc(FILE *);
+void                  sched_kw_tstep_buffer_fwrite(const sched_kw_tstep_type * kw , buffer_type * buffer);
+sched_kw_tstep_type * sched_kw_tstep_buffer_fread_alloc(buffer_type * buffer);
 
 int                   sched_kw_tstep_get_size(const sched_kw_tstep_type *);
 sched_kw_tstep_type * sched_kw_tstep_alloc_from_double(double);
@@ -47,6 +50,7 @@ int                   sched_kw_tstep_get_length( const sched_kw_tstep_type * kw)
 
 
 KW_HEADER(tstep)
+KW_BUFFER_IO_HEADER(tstep)
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +29,7 @@ extern "C" {
 #include <ert/util/hash.h>
 #include <ert/util/stringlist.h>
 #include <ert/util/time_t_vector.h>
+#include <ert/util/buffer.h>
 
 #include <ert/sched/sched_types.h>
 #include <ert/sched/sched_macros.h> 
@@ -43,12 +44,16 @@ void                     sched_kw_wconhist_free(sched_kw_wconhist_type * );
 void                     sched_kw_wconhist_fprintf(const sched_kw_wconhist_type * , FILE *);
 void                     sched_kw_wconhist_fwrite(const sched_kw_wconhist_type *, FILE *);
 sched_kw_wconhist_type * sched_kw_wconhist_fread_alloc( FILE *);
+void                     sched_kw_wconhist_buffer_fwrite(const sched_kw_wconhist_type * kw , buffer_type * buffer);
+sched_kw_wconhist_type * sched_kw_wconhist_buffer_fread_alloc( buffer_type * buffer );
 hash_type              * sched_kw_wconhist_alloc_well_obs_hash(const sched_kw_wconhist_type *);
 double                   sched_kw_wconhist_get_orat( sched_kw_wconhist_type * kw , const char * well_name);
 void                     sched_kw_wconhist_scale_orat(  sched_kw_wconhist_type * kw , const char * well_name, double factor);
 void                     sched_kw_wconhist_set_surface_flow(  sched_kw_wconhist_type * kw , const char * well_name , double orat);
 bool                     sched_kw_wconhist_has_well( const sched_kw_wconhist_type * kw , const char * well_name);
 bool                     sched_kw_wconhist_well_open( const sched_kw_wconhist_type * kw, const char * well_name);
+bool                     sched_kw_wconhist_iwell_open( const sched_kw_wconhist_type * kw, int well_index);
+double                   sched_kw_wconhist_iget_orat( const sched_kw_wconhist_type * kw , int well_index);
 void                     sched_kw_wconhist_shift_orat( sched_kw_wconhist_type * kw , const char * well_name, double shift_value);
 void                     sched_kw_wconhist_shift_grat( sched_kw_wconhist_type * kw , const char * well_name, double shift_value);
 void                     sched_kw_wconhist_shift_wrat( sched_kw_wconhist_type * kw , const char * well_name, double shift_value);
@@ -84,6 +89,7 @@ UTIL_SAFE_CAST_HEADER( sched_kw_wconhist );
 
 
 KW_HEADER(wconhist)
+KW_BUFFER_IO_HEADER(wconhist)
 
 #ifdef __cplusplus
 }
@@ -39,6 +39,8 @@ typedef struct wconinje_state_struct    wconinje_state_type;
 
 sched_phase_enum         sched_kw_wconinje_get_phase( const sched_kw_wconinje_type * kw , const char * well_name);
 bool                     sched_kw_wconinje_well_open( const sched_kw_wconinje_type * kw, const char * well_name);
+bool                     sched_kw_wconinje_iwell_open( const sched_kw_wconinje_type * kw, int well_index);
+double                   sched_kw_wconinje_iget_surface_flow( const sched_kw_wconinje_type * kw , int well_index);
 char **                  sched_kw_wconinje_alloc_wells_copy( const sched_kw_wconinje_type * , int * );
 
 void                     sched_kw_wconinje_set_surface_flow( const sched_kw_wconinje_type * kw , const char * well, double surface_flow);
@@ -47,7 +49,8 @@ double                   sched_kw_wconinje_get_surface_flow( const sched_kw_wcon
 bool                     sched_kw_wconinje_has_well( const sched_kw_wconinje_type * , const char * );
 sched_kw_wconinje_type * sched_kw_wconinje_safe_cast( void * arg );
 void                     sched_kw_wconinje_shift_surface_flow( const sched_kw_wconinje_type * kw , const char * well_name , double delta_surface_flow);
-bool                     sched_kw_wconinje_buffer_fwrite( const sched_kw_wconinje_type * kw , const char * well_name , buffer_type * buffer);
+void                     sched_kw_wconinje_buffer_fwrite( const sched_kw_wconinje_type * kw , buffer_type * buffer);
+sched_kw_wconinje_type * sched_kw_wconinje_buffer_fread_alloc( buffer_type * buffer );
 bool                     sched_kw_wconinje_historical( const sched_kw_wconinje_type * kw );
 
 void                     sched_kw_wconinje_close_state(wconinje_state_type * state , int report_step );
@@ -64,6 +67,7 @@ void                     sched_kw_wconinje_init_well_list( const sched_kw_wconin
 
 
 KW_HEADER(wconinje)
+KW_BUFFER_IO_HEADER(wconinje)
 
 
 
@@ -28,6 +28,7 @@ extern "C" {
 #include <ert/util/time_t_vector.h>
 #include <ert/util/hash.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/buffer.h>
 
 #include <ert/sched/sched_macros.h>
 #include <ert/sched/sched_types.h>
@@ -42,6 +43,8 @@ void                     sched_kw_wconinjh_free(sched_kw_wconinjh_type * );
 void                     sched_kw_wconinjh_fprintf(const sched_kw_wconinjh_type * , FILE *);
 void                     sched_kw_wconinjh_fwrite(const sched_kw_wconinjh_type *, FILE *);
 sched_kw_wconinjh_type * sched_kw_wconinjh_fread_alloc( FILE *);
+void                     sched_kw_wconinjh_buffer_fwrite(const sched_kw_wconinjh_type * kw , buffer_type * buffer);
+sched_kw_wconinjh_type * sched_kw_wconinjh_buffer_fread_alloc( buffer_type * buffer );
 
 hash_type              * sched_kw_wconinjh_alloc_well_obs_hash(const sched_kw_wconinjh_type *);
 
@@ -66,6 +69,7 @@ int                      wconinjh_state_iget_vfp_table_nr( const wconinjh_state_
 
 /*******************************************************************/
 KW_HEADER(wconinjh)
+KW_BUFFER_IO_HEADER(wconinjh)
 
 #ifdef __cplusplus
 }
@@ -75,6 +75,23 @@ KW_ALLOC_IMPL(KW)        \
 KW_COPYC_IMPL(KW)
 
 
+/*
+  The buffer_fwrite / buffer_fread_alloc pair is optional; it is only
+  implemented by the keywords which are stored in binary form in the
+  schedule cache, see sched_file_fwrite_cache().
+*/
+
+#define KW_BUFFER_IO_IMPL(KW)                                                      \
+void   sched_kw_## KW ##_buffer_fwrite__(const void * kw , buffer_type * buffer)    \
+{                                                                                 \
+  sched_kw_## KW ##_buffer_fwrite((const sched_kw_## KW ##_type *) kw , buffer);  \
+}                                                                                 \
+void * sched_kw_## KW ##_buffer_fread_alloc__(buffer_type * buffer)               \
+{                                                                                 \
+  return (void *) sched_kw_## KW ##_buffer_fread_alloc( buffer );                 \
+}
+
+
 
 /*******************************************************************/
 
@@ -98,3 +115,8 @@ KW_FREE_HEADER(KW)         \
 KW_FPRINTF_HEADER(KW)      \
 KW_ALLOC_HEADER(KW)        \
 KW_COPYC_HEADER(KW)
+
+
+#define KW_BUFFER_IO_HEADER(KW)                                                  \
+void   sched_kw_## KW ##_buffer_fwrite__(const void * , buffer_type * );         \
+void * sched_kw_## KW ##_buffer_fread_alloc__(buffer_type * );
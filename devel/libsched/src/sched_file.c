@@ -16,8 +16,12 @@
    for more details. 
 */
 
+#include <stdio.h>
+#include <stdint.h>
+
 #include <ert/util/hash.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/buffer.h>
 #include <ert/util/util.h>
 #include <ert/util/vector.h>
 #include <ert/util/parser.h>
@@ -64,6 +68,9 @@
 
 #define SCHED_FILE_TYPE_ID 677198
 
+#define SCHED_CACHE_ID       8811263     /* Written at the start and the end of the schedule cache. */
+#define SCHED_CACHE_VERSION  1           /* Must be bumped when the binary representation of a keyword changes. */
+
 struct sched_block_struct {
   vector_type     * kw_list;           /* A list of sched_kw's in the block.   */
   time_t            block_start_time;  
@@ -82,6 +89,8 @@ struct sched_file_struct {
   stringlist_type   * files;                 /* The name of the files which have been parsed to generate this sched_file instance. */
   time_t              start_time;            /* The start of the simulation. */
   bool                hasEND;
+  vector_type       * well_list;             /* Owning list of sched_well_type instances - see sched_file_update_well_index(). */
+  hash_type         * well_index;            /* The same sched_well_type instances indexed by well name. */
 };
 
 
@@ -237,6 +246,163 @@ static void sched_file_add_kw( sched_file_type * sched_file , const sched_kw_typ
 }
 
 
+/*****************************************************************/
+
+/**
+   The well index makes the per well queries sched_file_well_open(),
+   sched_file_well_wconhist_rate() and sched_file_well_wconinje_rate()
+   O(1). For every well found in a WCONHIST or WCONINJE keyword it
+   holds a list of records, one for each keyword the well appears in,
+   and two tables with one element per block (i.e. report step) giving
+   the record which is in effect at that step - or -1 if the well has
+   not been mentioned in a keyword of that type yet.
+
+   The records point to the keyword and the position of the well in
+   the keyword; the actual values are looked up when queried, so the
+   index stays valid when the keywords are modified with
+   sched_file_update().
+*/
+
+typedef struct {
+  int                     num_records;
+  int                     alloc_size;
+  const sched_kw_type  ** record_kw;
+  int                   * record_well_index;
+  int                   * record_block;
+  int                     current_wconhist;
+  int                     current_wconinje;
+  int                   * wconhist;           /* Record in effect for WCONHIST at each block. */
+  int                   * wconinje;           /* Record in effect for WCONINJE at each block. */
+} sched_well_type;
+
+
+static sched_well_type * sched_well_alloc( int num_blocks ) {
+  sched_well_type * well = util_malloc( sizeof * well );
+  well->num_records       = 0;
+  well->alloc_size        = 0;
+  well->record_kw         = NULL;
+  well->record_well_index = NULL;
+  well->record_block      = NULL;
+  well->current_wconhist  = -1;
+  well->current_wconinje  = -1;
+  well->wconhist          = util_calloc( num_blocks , sizeof * well->wconhist );
+  well->wconinje          = util_calloc( num_blocks , sizeof * well->wconinje );
+  for (int block_nr = 0; block_nr < num_blocks; block_nr++) {
+    well->wconhist[block_nr] = -1;
+    well->wconinje[block_nr] = -1;
+  }
+  return well;
+}
+
+
+static void sched_well_free( sched_well_type * well ) {
+  util_safe_free( well->record_kw );
+  util_safe_free( well->record_well_index );
+  util_safe_free( well->record_block );
+  free( well->wconhist );
+  free( well->wconinje );
+  free( well );
+}
+
+
+static void sched_well_free__( void * arg ) {
+  sched_well_free( (sched_well_type *) arg );
+}
+
+
+/*
+  Only the first occurence of a well in a keyword is used, as in the
+  sched_kw_xxx_get_well() functions.
+*/
+
+static void sched_well_add_record( sched_well_type * well , const sched_kw_type * kw , int well_index , int block_nr ) {
+  int * current = (sched_kw_get_type( kw ) == WCONHIST) ? &well->current_wconhist : &well->current_wconinje;
+
+  if ((*current >= 0) && (well->record_kw[ *current ] == kw))
+    return;
+
+  if (well->num_records == well->alloc_size) {
+    well->alloc_size        = 2 * well->alloc_size + 8;
+    well->record_kw         = util_realloc( well->record_kw         , well->alloc_size * sizeof * well->record_kw );
+    well->record_well_index = util_realloc( well->record_well_index , well->alloc_size * sizeof * well->record_well_index );
+    well->record_block      = util_realloc( well->record_block      , well->alloc_size * sizeof * well->record_block );
+  }
+  well->record_kw[ well->num_records ]         = kw;
+  well->record_well_index[ well->num_records ] = well_index;
+  well->record_block[ well->num_records ]      = block_nr;
+  *current = well->num_records;
+  well->num_records++;
+}
+
+
+static void sched_file_index_well_kw( sched_file_type * sched_file , const sched_kw_type * kw , int block_nr , stringlist_type * well_names) {
+  int num_blocks = vector_get_size( sched_file->blocks );
+
+  if (sched_kw_get_type( kw ) == WCONHIST)
+    sched_kw_wconhist_init_well_list( sched_kw_get_const_data( kw ) , well_names );
+  else
+    sched_kw_wconinje_init_well_list( sched_kw_get_const_data( kw ) , well_names );
+
+  for (int well_index = 0; well_index < stringlist_get_size( well_names ); well_index++) {
+    const char * well_name = stringlist_iget( well_names , well_index );
+    sched_well_type * well;
+
+    if (hash_has_key( sched_file->well_index , well_name ))
+      well = hash_get( sched_file->well_index , well_name );
+    else {
+      well = sched_well_alloc( num_blocks );
+      vector_append_owned_ref( sched_file->well_list , well , sched_well_free__ );
+      hash_insert_ref( sched_file->well_index , well_name , well );
+    }
+    sched_well_add_record( well , kw , well_index , block_nr );
+  }
+}
+
+
+static void sched_file_update_well_index( sched_file_type * sched_file ) {
+  stringlist_type * well_names = stringlist_alloc_new();
+
+  vector_clear( sched_file->well_list );
+  hash_clear( sched_file->well_index );
+  for (int block_nr = 0; block_nr < vector_get_size( sched_file->blocks ); block_nr++) {
+    const sched_block_type * block = vector_iget_const( sched_file->blocks , block_nr );
+
+    for (int ikw = 0; ikw < vector_get_size( block->kw_list ); ikw++) {
+      const sched_kw_type * kw = vector_iget_const( block->kw_list , ikw );
+      sched_kw_type_enum type  = sched_kw_get_type( kw );
+      if ((type == WCONHIST) || (type == WCONINJE))
+        sched_file_index_well_kw( sched_file , kw , block_nr , well_names );
+    }
+
+    for (int iwell = 0; iwell < vector_get_size( sched_file->well_list ); iwell++) {
+      sched_well_type * well = vector_iget( sched_file->well_list , iwell );
+      well->wconhist[block_nr] = well->current_wconhist;
+      well->wconinje[block_nr] = well->current_wconinje;
+    }
+  }
+  stringlist_free( well_names );
+}
+
+
+/*
+  Returns NULL if the well is not present in any WCONHIST or WCONINJE
+  keyword; will abort if restart_nr is out of range.
+*/
+
+static const sched_well_type * sched_file_get_well( const sched_file_type * sched_file , int restart_nr , const char * well_name) {
+  if ((restart_nr < 0) || (restart_nr >= vector_get_size( sched_file->blocks )))
+    util_abort("%s: restart_nr:%d invalid - valid range: [0,%d) \n",__func__ , restart_nr , vector_get_size( sched_file->blocks ));
+
+  if (hash_has_key( sched_file->well_index , well_name ))
+    return hash_get( sched_file->well_index , well_name );
+  else
+    return NULL;
+}
+
+
+/*****************************************************************/
+
+
 static void sched_file_update_index( sched_file_type * sched_file ) {
   int ikw;
   
@@ -324,6 +490,8 @@ static void sched_file_update_index( sched_file_type * sched_file ) {
     */
     sched_block_free( current_block );
   }
+
+  sched_file_update_well_index( sched_file );
 }
 
 
@@ -366,6 +534,8 @@ sched_file_type * sched_file_alloc(time_t start_time)
   sched_file->start_time         = start_time;
   sched_file->fixed_length_table = hash_alloc();
   sched_file->hasEND             = false;
+  sched_file->well_list          = vector_alloc_new();
+  sched_file->well_index         = hash_alloc();
   sched_file_init_fixed_length( sched_file );
   {
     char * fixed_length_file = getenv("SCHEDULE_FIXED_LENGTH");
@@ -400,6 +570,8 @@ void sched_file_free(sched_file_type * sched_file)
 
   stringlist_free( sched_file->files );
   hash_free( sched_file->fixed_length_table );
+  hash_free( sched_file->well_index );
+  vector_free( sched_file->well_list );
   free(sched_file);
 }
 
@@ -422,19 +594,30 @@ time_t_vector_type * sched_file_alloc_time_t_vector( const sched_file_type * sch
 }
 
 
-static stringlist_type * sched_file_tokenize( const char * filename ) {
-  stringlist_type  * token_list;
-  parser_type     * parser    = parser_alloc(" \t"  ,      /* Splitters */
-                                             "\'\"" ,      /* Quoters   */
-                                             "\n"   ,      /* Specials - splitters which will be kept. */  
-                                             "\r"   ,      /* Delete set - these are just deleted. */
-                                             "--"   ,      /* Comment start */
-                                             "\n");        /* Comment end */  
+/*
+  The schedule file is tokenized in one pass into a token_stream; the
+  token strings are held in one block of memory by the stream, so the
+  token stringlist can not be used after the stream has been freed.
+*/
+
+static parser_type * sched_file_alloc_parser( ) {
+  return parser_alloc(" \t"  ,      /* Splitters */
+                      "\'\"" ,      /* Quoters   */
+                      "\n"   ,      /* Specials - splitters which will be kept. */  
+                      "\r"   ,      /* Delete set - these are just deleted. */
+                      "--"   ,      /* Comment start */
+                      "\n");        /* Comment end */  
+}
+
+
+static token_stream_type * sched_file_tokenize( const char * filename ) {
+  token_stream_type * token_stream;
+  parser_type     * parser    = sched_file_alloc_parser( );
   bool strip_quote_marks = false;
-  token_list             = parser_tokenize_file( parser , filename , strip_quote_marks  );
+  token_stream           = parser_alloc_token_stream_file( parser , filename , strip_quote_marks  );
   parser_free( parser );
   
-  return token_list;
+  return token_stream;
 }
 
 
@@ -445,7 +628,8 @@ static stringlist_type * sched_file_tokenize( const char * filename ) {
 
 void sched_file_parse_append(sched_file_type * sched_file , const char * filename) {
   bool foundEND = false;
-  stringlist_type * token_list = sched_file_tokenize( filename );
+  token_stream_type * token_stream = sched_file_tokenize( filename );
+  stringlist_type * token_list     = token_stream_alloc_stringlist_ref( token_stream );
   sched_kw_type    * current_kw;
   int token_index = 0;
   do {
@@ -474,12 +658,14 @@ void sched_file_parse_append(sched_file_type * sched_file , const char * filenam
   sched_file_build_block_dates(sched_file);
   sched_file_update_index( sched_file );
   stringlist_free( token_list );
+  token_stream_free( token_stream );
 }
 
 
 void sched_file_simple_parse( const char * filename , time_t start_time) {
-  stringlist_type * token_list = sched_file_tokenize( filename );
-  const int num_tokens         = stringlist_get_size( token_list );
+  token_stream_type * token_stream = sched_file_tokenize( filename );
+  stringlist_type * token_list     = token_stream_alloc_stringlist_ref( token_stream );
+  const int num_tokens             = stringlist_get_size( token_list );
   int token_index = 0;
   do {
     sched_kw_type_enum kw_type = sched_kw_type_from_string( stringlist_iget( token_list , token_index ));
@@ -489,6 +675,7 @@ void sched_file_simple_parse( const char * filename , time_t start_time) {
   } while( token_index < num_tokens );
   
   stringlist_free( token_list );
+  token_stream_free( token_stream );
 }
 
 
@@ -512,6 +699,307 @@ sched_file_type * sched_file_parse_alloc(const char * filename , time_t start_da
 
 
 
+/*****************************************************************/
+
+/**
+   The schedule cache is a binary image of the keyword list of a
+   sched_file instance; when it is valid sched_file_fread_cache() can
+   be used instead of parsing the schedule file. The cache is read in
+   one operation, and the keywords which carry the bulk of the data,
+   i.e. WCONHIST, WCONINJE, WCONINJH, DATES and TSTEP, are stored in
+   binary form - see sched_kw_buffer_fwrite(). The remaining keywords
+   are stored as the text written by sched_kw_fprintf() and parsed
+   again when loading.
+
+   The cache is only used if it was created from the same files, with
+   the same start time and the same fixed length keywords; for every
+   file which has been parsed the size, modification time and a hash
+   of the content are stored. Observe that INCLUDE keywords are not
+   followed by the sched_file parser, so the included files are not
+   part of the cache key.
+
+   The layout of the cache file is:
+
+     SCHED_CACHE_ID
+     SCHED_CACHE_VERSION
+     start_time
+     num_fixed_length    ( kw , length )*
+     num_files           ( filename , size , mtime , content_hash )*
+     hasEND
+     num_kw              ( is_binary , keyword )*
+     SCHED_CACHE_ID
+*/
+
+static unsigned int sched_file_content_hash( const char * filename ) {
+  int    size;
+  char * content    = util_fread_alloc_file_content( filename , &size );
+  uint32_t hash_value = 2166136261U;     /* FNV-1a */
+  for (int i=0; i < size; i++) {
+    hash_value ^= (unsigned char) content[i];
+    hash_value *= 16777619U;
+  }
+  free( content );
+  return hash_value;
+}
+
+
+static void sched_file_buffer_fwrite_cache_key( const sched_file_type * sched_file , buffer_type * buffer ) {
+  buffer_fwrite_int( buffer , SCHED_CACHE_ID );
+  buffer_fwrite_int( buffer , SCHED_CACHE_VERSION );
+  buffer_fwrite_time_t( buffer , sched_file->start_time );
+  {
+    stringlist_type * fixed_length_kw = hash_alloc_stringlist( sched_file->fixed_length_table );
+    stringlist_sort( fixed_length_kw , NULL );
+    buffer_fwrite_int( buffer , stringlist_get_size( fixed_length_kw ));
+    for (int i=0; i < stringlist_get_size( fixed_length_kw ); i++) {
+      const char * kw = stringlist_iget( fixed_length_kw , i );
+      buffer_fwrite_string( buffer , kw );
+      buffer_fwrite_int( buffer , hash_get_int( sched_file->fixed_length_table , kw ));
+    }
+    stringlist_free( fixed_length_kw );
+  }
+  buffer_fwrite_int( buffer , stringlist_get_size( sched_file->files ));
+  for (int i=0; i < stringlist_get_size( sched_file->files ); i++) {
+    const char * filename = stringlist_iget( sched_file->files , i );
+    buffer_fwrite_string( buffer , filename );
+    {
+      size_t size = util_file_size( filename );
+      buffer_fwrite( buffer , &size , sizeof size , 1 );
+    }
+    buffer_fwrite_time_t( buffer , util_file_mtime( filename ));
+    buffer_fwrite_int( buffer , sched_file_content_hash( filename ));
+  }
+}
+
+
+/*
+  The fread and fwrite functions for the cache key must be kept in
+  sync; the reader returns false as soon as an element does not match,
+  the files are only hashed if size and modification time agree.
+*/
+
+static bool sched_file_buffer_fread_cache_key( sched_file_type * sched_file , const char * filename , buffer_type * buffer ) {
+  if (buffer_get_size( buffer ) < 2 * sizeof(int))
+    return false;
+
+  {
+    int end_id;
+    buffer_fseek( buffer , -((ssize_t) sizeof end_id) , SEEK_END );
+    end_id = buffer_fread_int( buffer );
+    buffer_rewind( buffer );
+
+    if ((end_id != SCHED_CACHE_ID) || (buffer_fread_int( buffer ) != SCHED_CACHE_ID))
+      return false;
+  }
+
+  if (buffer_fread_int( buffer ) != SCHED_CACHE_VERSION)
+    return false;
+
+  if (buffer_fread_time_t( buffer ) != sched_file->start_time)
+    return false;
+
+  {
+    int num_fixed_length = buffer_fread_int( buffer );
+    if (num_fixed_length != hash_get_size( sched_file->fixed_length_table ))
+      return false;
+
+    for (int i=0; i < num_fixed_length; i++) {
+      const char * kw = buffer_fread_string( buffer );
+      int length      = buffer_fread_int( buffer );
+      if (!hash_has_key( sched_file->fixed_length_table , kw ))
+        return false;
+      if (hash_get_int( sched_file->fixed_length_table , kw ) != length)
+        return false;
+    }
+  }
+
+  {
+    int num_files = buffer_fread_int( buffer );
+    if (num_files < 1)
+      return false;
+
+    for (int i=0; i < num_files; i++) {
+      const char * cache_filename = buffer_fread_string( buffer );
+      size_t size;
+      time_t mtime;
+      unsigned int content_hash;
+
+      buffer_fread( buffer , &size , sizeof size , 1 );
+      mtime        = buffer_fread_time_t( buffer );
+      content_hash = buffer_fread_int( buffer );
+
+      if ((i == 0) && !util_string_equal( cache_filename , filename ))
+        return false;
+
+      if (!util_file_exists( cache_filename ))
+        return false;
+
+      if ((util_file_size( cache_filename ) != size) || (util_file_mtime( cache_filename ) != mtime))
+        return false;
+
+      if (sched_file_content_hash( cache_filename ) != content_hash)
+        return false;
+
+      stringlist_append_copy( sched_file->files , cache_filename );
+    }
+  }
+  return true;
+}
+
+
+/**
+   Writes the schedule cache for @sched_file to @cache_file. The cache
+   is first written to a temporary file which is then renamed, so
+   concurrent readers will never see a partly written cache.
+*/
+
+void sched_file_fwrite_cache( const sched_file_type * sched_file , const char * cache_file ) {
+  buffer_type * buffer = buffer_alloc( 1024 * 1024 );
+  FILE * text_stream   = NULL;
+
+  sched_file_buffer_fwrite_cache_key( sched_file , buffer );
+  buffer_fwrite_bool( buffer , sched_file->hasEND );
+  buffer_fwrite_int( buffer , vector_get_size( sched_file->kw_list ));
+  for (int ikw = 0; ikw < vector_get_size( sched_file->kw_list ); ikw++) {
+    const sched_kw_type * kw = vector_iget_const( sched_file->kw_list , ikw );
+    if (sched_kw_has_buffer_io( kw )) {
+      buffer_fwrite_bool( buffer , true );
+      sched_kw_buffer_fwrite( kw , buffer );
+    } else {
+      long text_size;
+
+      if (text_stream == NULL)
+        text_stream = tmpfile( );
+      else
+        rewind( text_stream );
+
+      sched_kw_fprintf( kw , text_stream );
+      text_size = ftell( text_stream );
+      rewind( text_stream );
+
+      /* Same layout as buffer_fwrite_string(). */
+      buffer_fwrite_bool( buffer , false );
+      buffer_fwrite_int( buffer , text_size );
+      buffer_stream_fread( buffer , text_size , text_stream );
+      buffer_fwrite_char( buffer , '\0' );
+    }
+  }
+  buffer_fwrite_int( buffer , SCHED_CACHE_ID );
+
+  {
+    char * tmp_file = util_alloc_sprintf( "%s.tmp" , cache_file );
+    buffer_store( buffer , tmp_file );
+    if (rename( tmp_file , cache_file ) != 0)
+      util_unlink_existing( tmp_file );
+    free( tmp_file );
+  }
+
+  if (text_stream != NULL)
+    fclose( text_stream );
+  buffer_free( buffer );
+}
+
+
+/**
+   Will load the keywords of @sched_file from @cache_file, if the cache
+   exists and is valid for the schedule file @filename; in that case
+   the sched_file instance will be equivalent to one created with
+   sched_file_parse() and true is returned. If the cache can not be
+   used false is returned and the sched_file is not modified. The
+   sched_file instance must be newly allocated.
+*/
+
+bool sched_file_fread_cache( sched_file_type * sched_file , const char * filename , const char * cache_file ) {
+  bool cache_valid = false;
+
+  if (util_file_exists( cache_file )) {
+    buffer_type * buffer = buffer_fread_alloc( cache_file );
+
+    cache_valid = sched_file_buffer_fread_cache_key( sched_file , filename , buffer );
+    if (cache_valid) {
+      parser_type * parser = sched_file_alloc_parser( );
+      int num_kw;
+
+      sched_file->hasEND = buffer_fread_bool( buffer );
+      num_kw             = buffer_fread_int( buffer );
+      for (int ikw = 0; ikw < num_kw; ikw++) {
+        if (buffer_fread_bool( buffer ))
+          sched_file_add_kw( sched_file , sched_kw_buffer_fread_alloc( buffer ));
+        else {
+          const char * text                = buffer_fread_string( buffer );
+          token_stream_type * token_stream = parser_alloc_token_stream( parser , text , false );
+          stringlist_type * token_list     = token_stream_alloc_stringlist_ref( token_stream );
+          int token_index                  = 0;
+
+          sched_util_skip_newline( token_list , &token_index );
+          sched_file_add_kw( sched_file , sched_kw_token_alloc( token_list , &token_index , sched_file->fixed_length_table , NULL ));
+
+          stringlist_free( token_list );
+          token_stream_free( token_stream );
+        }
+      }
+      parser_free( parser );
+
+      sched_file_add_block( sched_file , sched_block_alloc_empty() );
+      sched_file_build_block_dates( sched_file );
+      sched_file_update_index( sched_file );
+    } else
+      stringlist_clear( sched_file->files );
+
+    buffer_free( buffer );
+  }
+
+  return cache_valid;
+}
+
+
+/*
+  The directory of the cache file is created if it does not exist, but
+  only one level deep; if the directory can not be written the cache
+  is just not created.
+*/
+
+static bool sched_file_cache_writable( const char * cache_file ) {
+  bool writable = false;
+  char * cache_path = util_split_alloc_dirname( cache_file );
+  if (cache_path == NULL)
+    writable = util_entry_writable( "." );
+  else {
+    if (util_is_directory( cache_path ))
+      writable = util_entry_writable( cache_path );
+    else {
+      char * parent_path = util_split_alloc_dirname( cache_path );
+      const char * parent = (parent_path == NULL) ? "." : parent_path;
+      if (util_is_directory( parent ) && util_entry_writable( parent )) {
+        util_make_path( cache_path );
+        writable = true;
+      }
+      util_safe_free( parent_path );
+    }
+    free( cache_path );
+  }
+  return writable;
+}
+
+
+/**
+   Will load the schedule file from @cache_file if that is valid;
+   otherwise the schedule file is parsed and the cache is (re)created.
+   If @cache_file is NULL this is equivalent to sched_file_parse().
+*/
+
+void sched_file_parse_cached( sched_file_type * sched_file , const char * filename , const char * cache_file ) {
+  if (cache_file == NULL)
+    sched_file_parse( sched_file , filename );
+  else if (!sched_file_fread_cache( sched_file , filename , cache_file )) {
+    sched_file_parse( sched_file , filename );
+    if (sched_file_cache_writable( cache_file ))
+      sched_file_fwrite_cache( sched_file , cache_file );
+  }
+}
+
+
+
 int sched_file_get_num_restart_files(const sched_file_type * sched_file)
 {
   return vector_get_size(sched_file->blocks);
@@ -825,7 +1313,8 @@ void sched_file_update(sched_file_type * sched_file,
 */
 
 int sched_file_step_count( const char * filename ) {
-  stringlist_type * token_list = sched_file_tokenize( filename );
+  token_stream_type * token_stream = sched_file_tokenize( filename );
+  stringlist_type * token_list     = token_stream_alloc_stringlist_ref( token_stream );
   int token_index = 0;
   int step_count  = 0;
   do {
@@ -847,6 +1336,7 @@ int sched_file_step_count( const char * filename ) {
     
   } while ( token_index < stringlist_get_size( token_list ));
   stringlist_free( token_list );
+  token_stream_free( token_stream );
   return step_count;
 }
 
@@ -905,80 +1395,45 @@ int sched_file_step_count( const char * filename ) {
 
 
 /**
-   Currently ONLY applicable to WCONHIST producers.
-
-   
+   Will return the open status of the well from the last WCONHIST or
+   WCONINJE keyword mentioning it at or before @restart_nr; if both
+   keywords mention the well in the same block WCONINJE takes
+   precedence.
 */
 
 bool sched_file_well_open( const sched_file_type * sched_file , 
                            int restart_nr , 
                            const char * well_name) {
 
-  bool well_found = false;
-  bool well_open  = false;
-  int block_nr    = restart_nr;
-  while (!well_found && (block_nr >= 0)) {
-    sched_block_type * block = sched_file_iget_block( sched_file , block_nr );
-    
-    if (hash_has_key( block->kw_hash , "WCONHIST")) {
-      const vector_type * wconhist_vector = hash_get( block->kw_hash , "WCONHIST");
-      int i;
-      for (i=0; i < vector_get_size( wconhist_vector ); i++) {
-        const sched_kw_type * kw = vector_iget_const( wconhist_vector , i );
-        if (sched_kw_has_well( kw , well_name )) {
-          well_found = true;
-          well_open = sched_kw_well_open( kw , well_name );
-        }
-      }
-    }
-
-    
-    if (hash_has_key( block->kw_hash , "WCONINJE")) {
-      const vector_type * wconinje_vector = hash_get( block->kw_hash , "WCONINJE");
-      int i;
-      for (i=0; i < vector_get_size( wconinje_vector ); i++) {
-        const sched_kw_type * kw = vector_iget_const( wconinje_vector , i );
-        if (sched_kw_has_well( kw , well_name )) {
-          well_found = true;
-          well_open  = sched_kw_well_open( kw , well_name );
-        }
-      }
-    }
-    
+  const sched_well_type * well = sched_file_get_well( sched_file , restart_nr , well_name );
+  bool well_open = false;
+  if (well != NULL) {
+    int wconhist = well->wconhist[restart_nr];
+    int wconinje = well->wconinje[restart_nr];
+    int record;
 
+    if ((wconinje >= 0) && ((wconhist < 0) || (well->record_block[wconinje] >= well->record_block[wconhist])))
+      record = wconinje;
+    else
+      record = wconhist;
 
-    block_nr--;
-  } 
+    if (record >= 0)
+      well_open = sched_kw_iwell_open( well->record_kw[record] , well->record_well_index[record] );
+  }
   return well_open;
 }
 
 
 
-
-
 double sched_file_well_wconhist_rate( const sched_file_type * sched_file , 
                                       int restart_nr , 
                                       const char * well_name) {
+  const sched_well_type * well = sched_file_get_well( sched_file , restart_nr , well_name );
   double rate = -1;
-  bool well_found = false;
-  int block_nr    = restart_nr;
-
-  while (!well_found && (block_nr >= 0)) {
-    sched_block_type * block = sched_file_iget_block( sched_file , block_nr );
-    
-    if (hash_has_key( block->kw_hash , "WCONHIST")) {
-      const vector_type * wconhist_vector = hash_get( block->kw_hash , "WCONHIST");
-      int i;
-      for (i=0; i < vector_get_size( wconhist_vector ); i++) {
-        sched_kw_type * kw = vector_iget( wconhist_vector , i );
-        if (sched_kw_has_well( kw , well_name )) {
-          well_found = true;
-          rate = sched_kw_wconhist_get_orat( sched_kw_get_data( kw ) , well_name );
-        }
-      }
-    }
-    block_nr--;
-  } 
+  if ((well != NULL) && (well->wconhist[restart_nr] >= 0)) {
+    int record = well->wconhist[restart_nr];
+    rate = sched_kw_wconhist_iget_orat( sched_kw_get_const_data( well->record_kw[record] ) , well->record_well_index[record] );
+  }
   return rate;
 }
 
@@ -987,27 +1442,11 @@ double sched_file_well_wconhist_rate( const sched_file_type * sched_file ,
 double sched_file_well_wconinje_rate( const sched_file_type * sched_file , 
                                       int restart_nr , 
                                       const char * well_name) {
+  const sched_well_type * well = sched_file_get_well( sched_file , restart_nr , well_name );
   double rate = -1;
-  bool well_found = false;
-  int block_nr    = restart_nr;
-
-  while (!well_found && (block_nr >= 0)) {
-    sched_block_type * block = sched_file_iget_block( sched_file , block_nr );
-    
-    if (hash_has_key( block->kw_hash , "WCONINJE")) {
-      const vector_type * wconhist_vector = hash_get( block->kw_hash , "WCONINJE");
-      int i;
-      for (i=0; i < vector_get_size( wconhist_vector ); i++) {
-        sched_kw_type * kw = vector_iget( wconhist_vector , i );
-        if (sched_kw_has_well( kw , well_name )) {
-          well_found = true;
-          rate = sched_kw_wconinje_get_surface_flow( sched_kw_get_data( kw ) , well_name );
-        }
-      }
-    }
-    
-    block_nr--;
-  } 
+  if ((well != NULL) && (well->wconinje[restart_nr] >= 0)) {
+    int record = well->wconinje[restart_nr];
+    rate = sched_kw_wconinje_iget_surface_flow( sched_kw_get_const_data( well->record_kw[record] ) , well->record_well_index[record] );
+  }
   return rate;
 }
-
@@ -26,6 +26,7 @@
 #include <ert/util/hash.h>
 #include <ert/util/util.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/buffer.h>
 
 #include <ert/sched/sched_kw.h>
 #include <ert/sched/sched_util.h>
@@ -81,6 +82,8 @@ typedef void * (data_token_alloc_proto)  ( const stringlist_type * , int * );
 typedef void   (data_free_proto)         ( void *);
 typedef void   (data_fprintf_proto)      ( const void *, FILE *);
 typedef void * (alloc_copy_proto)        ( const void *);
+typedef void   (buffer_fwrite_proto)     ( const void * , buffer_type * );
+typedef void * (buffer_fread_alloc_proto)( buffer_type * );
 
 
 struct data_handlers_struct {
@@ -102,6 +105,8 @@ struct sched_kw_struct {
   data_free_proto         * free;
   data_fprintf_proto      * fprintf;
   alloc_copy_proto        * copyc;
+  buffer_fwrite_proto     * buffer_fwrite;       /* Optional - only for the keywords stored in binary form in the schedule cache. */
+  buffer_fread_alloc_proto* buffer_fread_alloc;
   
   void                    * data;        /* A void point pointer to a detailed implementation - i.e. sched_kw_wconhist. */
 };
@@ -124,6 +129,8 @@ static sched_kw_type * sched_kw_alloc_empty( const char * kw_name ) {
   sched_kw_type * kw = util_malloc(sizeof * kw);
   kw->kw_name = util_alloc_string_copy( kw_name );
   kw->type    = sched_kw_type_from_string( kw_name );
+  kw->buffer_fwrite      = NULL;
+  kw->buffer_fread_alloc = NULL;
   
   switch( kw->type ) {
   case(WCONHIST):
@@ -131,18 +138,24 @@ static sched_kw_type * sched_kw_alloc_empty( const char * kw_name ) {
     kw->free    = sched_kw_wconhist_free__;
     kw->fprintf = sched_kw_wconhist_fprintf__;
     kw->copyc   = sched_kw_wconhist_copyc__;
+    kw->buffer_fwrite      = sched_kw_wconhist_buffer_fwrite__;
+    kw->buffer_fread_alloc = sched_kw_wconhist_buffer_fread_alloc__;
     break;
   case(DATES):
     kw->alloc   = sched_kw_dates_alloc__;
     kw->free    = sched_kw_dates_free__;
     kw->fprintf = sched_kw_dates_fprintf__;
     kw->copyc   = sched_kw_dates_copyc__;
+    kw->buffer_fwrite      = sched_kw_dates_buffer_fwrite__;
+    kw->buffer_fread_alloc = sched_kw_dates_buffer_fread_alloc__;
     break;
   case(TSTEP):
     kw->alloc   = sched_kw_tstep_alloc__;
     kw->free    = sched_kw_tstep_free__;
     kw->fprintf = sched_kw_tstep_fprintf__;
     kw->copyc   = sched_kw_tstep_copyc__;
+    kw->buffer_fwrite      = sched_kw_tstep_buffer_fwrite__;
+    kw->buffer_fread_alloc = sched_kw_tstep_buffer_fread_alloc__;
     break;
   case(COMPDAT):
     kw->alloc   = sched_kw_compdat_alloc__;
@@ -190,12 +203,16 @@ static sched_kw_type * sched_kw_alloc_empty( const char * kw_name ) {
     kw->free    = sched_kw_wconinje_free__;
     kw->fprintf = sched_kw_wconinje_fprintf__;
     kw->copyc   = sched_kw_wconinje_copyc__;
+    kw->buffer_fwrite      = sched_kw_wconinje_buffer_fwrite__;
+    kw->buffer_fread_alloc = sched_kw_wconinje_buffer_fread_alloc__;
     break;
   case(WCONINJH):
     kw->alloc   = sched_kw_wconinjh_alloc__;
     kw->free    = sched_kw_wconinjh_free__;
     kw->fprintf = sched_kw_wconinjh_fprintf__;
     kw->copyc   = sched_kw_wconinjh_copyc__;
+    kw->buffer_fwrite      = sched_kw_wconinjh_buffer_fwrite__;
+    kw->buffer_fread_alloc = sched_kw_wconinjh_buffer_fread_alloc__;
     break;
   case(WCONPROD):
     kw->alloc   = sched_kw_wconprod_alloc__;
@@ -370,6 +387,39 @@ void sched_kw_fprintf(const sched_kw_type * sched_kw, FILE * stream)
 }
 
 
+/*
+  The binary representation is only implemented for the keywords
+  which carry the bulk of the numerical data, i.e. WCONHIST, WCONINJE,
+  WCONINJH, DATES and TSTEP; the schedule cache stores the other
+  keywords as text.
+*/
+
+bool sched_kw_has_buffer_io( const sched_kw_type * sched_kw ) {
+  return (sched_kw->buffer_fwrite != NULL);
+}
+
+
+void sched_kw_buffer_fwrite( const sched_kw_type * sched_kw , buffer_type * buffer ) {
+  if (sched_kw->buffer_fwrite == NULL)
+    util_abort("%s: keyword:%s does not have a binary representation \n",__func__ , sched_kw->kw_name);
+
+  buffer_fwrite_string( buffer , sched_kw->kw_name );
+  sched_kw->buffer_fwrite( sched_kw->data , buffer );
+}
+
+
+sched_kw_type * sched_kw_buffer_fread_alloc( buffer_type * buffer ) {
+  const char * kw_name     = buffer_fread_string( buffer );
+  sched_kw_type * sched_kw = sched_kw_alloc_empty( kw_name );
+  if (sched_kw->buffer_fread_alloc == NULL)
+    util_abort("%s: keyword:%s does not have a binary representation \n",__func__ , kw_name);
+
+  sched_kw->restart_nr = -1;
+  sched_kw->data       = sched_kw->buffer_fread_alloc( buffer );
+  return sched_kw;
+}
+
+
 
 
 
@@ -541,6 +591,23 @@ bool sched_kw_well_open( const sched_kw_type * sched_kw , const char * well ) {
 
 
 
+/**
+   As sched_kw_well_open(), but the well is given by its position in
+   the keyword.
+*/
+
+bool sched_kw_iwell_open( const sched_kw_type * sched_kw , int well_index ) {
+  sched_kw_type_enum type = sched_kw_get_type( sched_kw );
+  if (type == WCONHIST)
+    return sched_kw_wconhist_iwell_open( sched_kw->data , well_index);
+  else if (type == WCONINJE)
+    return sched_kw_wconinje_iwell_open( sched_kw->data , well_index);
+  else
+    return false;
+}
+
+
+
 sched_kw_type * sched_kw_alloc_copy(const sched_kw_type * src) {
   sched_kw_type * target = NULL;
   
@@ -23,6 +23,7 @@
 #include <ert/util/vector.h>
 #include <ert/util/util.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/buffer.h>
 
 #include <ert/ecl/ecl_util.h>
 
@@ -187,6 +188,31 @@ time_t sched_kw_dates_iget_date(const sched_kw_dates_type * kw, int i)
 
 
 
+/**
+   Binary representation used by the schedule cache.
+*/
+
+void sched_kw_dates_buffer_fwrite(const sched_kw_dates_type * kw , buffer_type * buffer) {
+  int size = vector_get_size( kw->time_list );
+  buffer_fwrite_int( buffer , size );
+  for (int i=0; i < size; i++)
+    buffer_fwrite_time_t( buffer , sched_kw_dates_iget_date( kw , i ));
+}
+
+
+sched_kw_dates_type * sched_kw_dates_buffer_fread_alloc(buffer_type * buffer) {
+  sched_kw_dates_type * kw = sched_kw_dates_alloc_empty();
+  int size = buffer_fread_int( buffer );
+  for (int i=0; i < size; i++) {
+    sched_time_type * time_node = sched_time_alloc( buffer_fread_time_t( buffer ) , 0 , DATES_TIME );
+    vector_append_owned_ref( kw->time_list , time_node , sched_time_free__ );
+  }
+  return kw;
+}
+
+
+
+
 sched_kw_dates_type * sched_kw_dates_copyc(const sched_kw_dates_type * kw) {
   util_abort("%s: not implemented ... \n",__func__);
   return NULL;
@@ -200,4 +226,5 @@ sched_kw_dates_type * sched_kw_dates_copyc(const sched_kw_dates_type * kw) {
 
 
 KW_IMPL(dates)
+KW_BUFFER_IO_IMPL(dates)
      
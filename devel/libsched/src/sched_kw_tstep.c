@@ -21,6 +21,7 @@
 #include <time.h>
 
 #include <ert/util/double_vector.h>
+#include <ert/util/buffer.h>
 #include <ert/util/util.h>
 
 #include <ert/sched/sched_util.h>
@@ -118,6 +119,23 @@ sched_kw_tstep_type * sched_kw_tstep_alloc_from_double(double step)
   return kw;
 }
 
+/**
+   Binary representation used by the schedule cache; the fprintf()
+   format only has three decimals.
+*/
+
+void sched_kw_tstep_buffer_fwrite(const sched_kw_tstep_type * kw , buffer_type * buffer) {
+  double_vector_buffer_fwrite( kw->tstep_list , buffer );
+}
+
+
+sched_kw_tstep_type * sched_kw_tstep_buffer_fread_alloc(buffer_type * buffer) {
+  sched_kw_tstep_type * kw = sched_kw_tstep_alloc_empty();
+  double_vector_buffer_fread( kw->tstep_list , buffer );
+  return kw;
+}
+
+
 sched_kw_tstep_type * sched_kw_tstep_copyc(const sched_kw_tstep_type * kw) {
   util_abort("%s: not implemented ... \n",__func__);
   return NULL;
@@ -147,5 +165,6 @@ time_t sched_kw_tstep_get_new_time(const sched_kw_tstep_type *kw, time_t curr_ti
 /*****************************************************************/
 
 KW_IMPL(tstep)
+KW_BUFFER_IO_IMPL(tstep)
 
 
@@ -183,6 +183,41 @@ static wconhist_well_type * wconhist_well_alloc_from_tokens(const stringlist_typ
 
 
 
+static void wconhist_well_buffer_fwrite(const wconhist_well_type * well , buffer_type * buffer) {
+  buffer_fwrite( buffer , well->def , sizeof * well->def , WCONHIST_NUM_KW );
+  buffer_fwrite_string( buffer , well->name );
+  buffer_fwrite_int( buffer , well->status );
+  buffer_fwrite_int( buffer , well->cmode );
+  buffer_fwrite_double( buffer , well->orat );
+  buffer_fwrite_double( buffer , well->wrat );
+  buffer_fwrite_double( buffer , well->grat );
+  buffer_fwrite_int( buffer , well->vfptable );
+  buffer_fwrite_double( buffer , well->alift );
+  buffer_fwrite_double( buffer , well->thp );
+  buffer_fwrite_double( buffer , well->bhp );
+  buffer_fwrite_double( buffer , well->wgrat );
+}
+
+
+static wconhist_well_type * wconhist_well_buffer_fread_alloc(buffer_type * buffer) {
+  wconhist_well_type * well = wconhist_well_alloc_empty( );
+  buffer_fread( buffer , well->def , sizeof * well->def , WCONHIST_NUM_KW );
+  well->name     = buffer_fread_alloc_string( buffer );
+  well->status   = buffer_fread_int( buffer );
+  well->cmode    = buffer_fread_int( buffer );
+  well->orat     = buffer_fread_double( buffer );
+  well->wrat     = buffer_fread_double( buffer );
+  well->grat     = buffer_fread_double( buffer );
+  well->vfptable = buffer_fread_int( buffer );
+  well->alift    = buffer_fread_double( buffer );
+  well->thp      = buffer_fread_double( buffer );
+  well->bhp      = buffer_fread_double( buffer );
+  well->wgrat    = buffer_fread_double( buffer );
+  return well;
+}
+
+
+
 static hash_type * wconhist_well_export_obs_hash(const wconhist_well_type * well)
 {
   hash_type * obs_hash = hash_alloc();
@@ -305,6 +340,28 @@ void sched_kw_wconhist_fprintf(const sched_kw_wconhist_type * kw, FILE * stream)
 }
 
 
+/**
+   Binary representation used by the schedule cache; the values are
+   stored exactly, i.e. without the rounding of the fprintf() format.
+*/
+
+void sched_kw_wconhist_buffer_fwrite(const sched_kw_wconhist_type * kw , buffer_type * buffer) {
+  int size = vector_get_size(kw->wells);
+  buffer_fwrite_int( buffer , size );
+  for (int i=0; i < size; i++)
+    wconhist_well_buffer_fwrite( vector_iget_const( kw->wells , i ) , buffer );
+}
+
+
+sched_kw_wconhist_type * sched_kw_wconhist_buffer_fread_alloc(buffer_type * buffer) {
+  sched_kw_wconhist_type * kw = sched_kw_wconhist_alloc_empty();
+  int size = buffer_fread_int( buffer );
+  for (int i=0; i < size; i++)
+    sched_kw_wconhist_add_well( kw , wconhist_well_buffer_fread_alloc( buffer ));
+  return kw;
+}
+
+
 /***********************************************************************/
 
 
@@ -473,21 +530,44 @@ bool sched_kw_wconhist_has_well( const sched_kw_wconhist_type * kw , const char
 */
    
 
+static bool wconhist_well_open( const wconhist_well_type * well ) {
+  if (well->status == OPEN) {
+    /* The well seems to be open - any rates around? */
+    if ((well->orat + well->grat + well->wrat) > 0.0)
+      return true;
+    else
+      return false;
+  } else
+    return false;
+}
+
+
 bool sched_kw_wconhist_well_open( const sched_kw_wconhist_type * kw, const char * well_name) {
   wconhist_well_type * well = sched_kw_wconhist_get_well( kw , well_name );
   if (well == NULL)
     return false;
-  else {
+  else
     /* OK - we have the well. */
-    if (well->status == OPEN) {
-      /* The well seems to be open - any rates around? */
-      if ((well->orat + well->grat + well->wrat) > 0.0)
-        return true;
-      else
-        return false;
-    } else
-      return false;
-  }
+    return wconhist_well_open( well );
+}
+
+
+/**
+   The iget functions access the well records by their position in the
+   keyword, i.e. the same order as sched_kw_wconhist_init_well_list()
+   returns the well names in. They are used by the sched_file well
+   index, which has already resolved the well names.
+*/
+
+bool sched_kw_wconhist_iwell_open( const sched_kw_wconhist_type * kw, int well_index) {
+  const wconhist_well_type * well = vector_iget_const( kw->wells , well_index );
+  return wconhist_well_open( well );
+}
+
+
+double sched_kw_wconhist_iget_orat( const sched_kw_wconhist_type * kw , int well_index) {
+  const wconhist_well_type * well = vector_iget_const( kw->wells , well_index );
+  return well->orat;
 }
 
 /*****************************************************************/
@@ -717,3 +797,4 @@ void sched_kw_wconhist_close_state( wconhist_state_type * state , int report_ste
 
 
 KW_IMPL(wconhist)
+KW_BUFFER_IO_IMPL(wconhist)
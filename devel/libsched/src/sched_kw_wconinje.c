@@ -161,6 +161,38 @@ static void wconinje_well_fprintf(const wconinje_well_type * well, FILE * stream
 }
 
 
+static void wconinje_well_buffer_fwrite(const wconinje_well_type * well , buffer_type * buffer) {
+  buffer_fwrite( buffer , well->def , sizeof * well->def , WCONINJE_NUM_KW );
+  buffer_fwrite_string( buffer , well->name );
+  buffer_fwrite_int( buffer , well->injector_type );
+  buffer_fwrite_int( buffer , well->status );
+  buffer_fwrite_int( buffer , well->cmode );
+  buffer_fwrite_double( buffer , well->surface_flow );
+  buffer_fwrite_double( buffer , well->reservoir_flow );
+  buffer_fwrite_double( buffer , well->BHP_target );
+  buffer_fwrite_double( buffer , well->THP_target );
+  buffer_fwrite_int( buffer , well->vfp_table_nr );
+  buffer_fwrite_double( buffer , well->vapoil_conc );
+}
+
+
+static wconinje_well_type * wconinje_well_buffer_fread_alloc(buffer_type * buffer) {
+  wconinje_well_type * well = wconinje_well_alloc_empty();
+  buffer_fread( buffer , well->def , sizeof * well->def , WCONINJE_NUM_KW );
+  well->name           = buffer_fread_alloc_string( buffer );
+  well->injector_type  = buffer_fread_int( buffer );
+  well->status         = buffer_fread_int( buffer );
+  well->cmode          = buffer_fread_int( buffer );
+  well->surface_flow   = buffer_fread_double( buffer );
+  well->reservoir_flow = buffer_fread_double( buffer );
+  well->BHP_target     = buffer_fread_double( buffer );
+  well->THP_target     = buffer_fread_double( buffer );
+  well->vfp_table_nr   = buffer_fread_int( buffer );
+  well->vapoil_conc    = buffer_fread_double( buffer );
+  return well;
+}
+
+
 /*****************************************************************/
 
 
@@ -233,6 +265,28 @@ void sched_kw_wconinje_fprintf(const sched_kw_wconinje_type * kw , FILE * stream
 
 
 
+/**
+   Binary representation used by the schedule cache.
+*/
+
+void sched_kw_wconinje_buffer_fwrite(const sched_kw_wconinje_type * kw , buffer_type * buffer) {
+  int size = vector_get_size(kw->wells);
+  buffer_fwrite_int( buffer , size );
+  for (int i=0; i < size; i++)
+    wconinje_well_buffer_fwrite( vector_iget_const( kw->wells , i ) , buffer );
+}
+
+
+sched_kw_wconinje_type * sched_kw_wconinje_buffer_fread_alloc(buffer_type * buffer) {
+  sched_kw_wconinje_type * kw = sched_kw_wconinje_alloc_empty();
+  int size = buffer_fread_int( buffer );
+  for (int i=0; i < size; i++)
+    sched_kw_wconinje_add_well( kw , wconinje_well_buffer_fread_alloc( buffer ));
+  return kw;
+}
+
+
+
 char ** sched_kw_wconinje_alloc_wells_copy( const sched_kw_wconinje_type * kw , int * num_wells) {
   int size = vector_get_size(kw->wells);
   
@@ -324,21 +378,42 @@ sched_kw_wconinje_type * sched_kw_wconinje_copyc(const sched_kw_wconinje_type *
 }
 
 
+static bool wconinje_well_open( const wconinje_well_type * well ) {
+  if (well->status == OPEN) {
+    /* The well seems to be open - any rates around? */
+    if (well->surface_flow > 0)
+      return true;
+    else
+      return false;
+  } else
+    return false;
+}
+
+
 bool sched_kw_wconinje_well_open( const sched_kw_wconinje_type * kw, const char * well_name) {
   wconinje_well_type * well = sched_kw_wconinje_get_well( kw , well_name );
   if (well == NULL)
     return false;
-  else {
+  else
     /* OK - we have the well. */
+    return wconinje_well_open( well );
+}
+
+
+/**
+   Access to the well records by their position in the keyword, see
+   the corresponding functions in sched_kw_wconhist.c.
+*/
+
+bool sched_kw_wconinje_iwell_open( const sched_kw_wconinje_type * kw, int well_index) {
+  const wconinje_well_type * well = vector_iget_const( kw->wells , well_index );
+  return wconinje_well_open( well );
+}
+
 
-    if (well->status == OPEN) {
-      /* The well seems to be open - any rates around? */
-      if (well->surface_flow > 0)
-        return true;
-      else
-        return false;
-    } else
-      return false;  }
+double sched_kw_wconinje_iget_surface_flow( const sched_kw_wconinje_type * kw , int well_index) {
+  const wconinje_well_type * well = vector_iget_const( kw->wells , well_index );
+  return well->surface_flow;
 }
 
 /*****************************************************************/
@@ -524,3 +599,4 @@ void sched_kw_wconinje_close_state(wconinje_state_type * state , int report_step
 
 
 KW_IMPL(wconinje)
+KW_BUFFER_IO_IMPL(wconinje)
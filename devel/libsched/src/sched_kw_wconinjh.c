@@ -23,6 +23,7 @@
 #include <ert/util/util.h>
 #include <ert/util/hash.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/buffer.h>
 #include <ert/util/int_vector.h>
 #include <ert/util/time_t_vector.h>
 #include <ert/util/double_vector.h>
@@ -156,6 +157,35 @@ static wconinjh_well_type * wconinjh_well_alloc_from_tokens(const stringlist_typ
 
 
 
+static void wconinjh_well_buffer_fwrite(const wconinjh_well_type * well , buffer_type * buffer) {
+  buffer_fwrite( buffer , well->def , sizeof * well->def , WCONINJH_NUM_KW );
+  buffer_fwrite_string( buffer , well->name );
+  buffer_fwrite_int( buffer , well->inj_phase );
+  buffer_fwrite_int( buffer , well->status );
+  buffer_fwrite_double( buffer , well->inj_rate );
+  buffer_fwrite_double( buffer , well->bhp );
+  buffer_fwrite_double( buffer , well->thp );
+  buffer_fwrite_int( buffer , well->vfptable );
+  buffer_fwrite_double( buffer , well->vapdiscon );
+}
+
+
+static wconinjh_well_type * wconinjh_well_buffer_fread_alloc(buffer_type * buffer) {
+  wconinjh_well_type * well = wconinjh_well_alloc_empty();
+  buffer_fread( buffer , well->def , sizeof * well->def , WCONINJH_NUM_KW );
+  well->name      = buffer_fread_alloc_string( buffer );
+  well->inj_phase = buffer_fread_int( buffer );
+  well->status    = buffer_fread_int( buffer );
+  well->inj_rate  = buffer_fread_double( buffer );
+  well->bhp       = buffer_fread_double( buffer );
+  well->thp       = buffer_fread_double( buffer );
+  well->vfptable  = buffer_fread_int( buffer );
+  well->vapdiscon = buffer_fread_double( buffer );
+  return well;
+}
+
+
+
 static hash_type * wconinjh_well_export_obs_hash(const wconinjh_well_type * well) {
   hash_type * obs_hash = hash_alloc();
 
@@ -242,6 +272,28 @@ void sched_kw_wconinjh_fprintf(const sched_kw_wconinjh_type * kw, FILE * stream)
 }
 
 
+/**
+   Binary representation used by the schedule cache.
+*/
+
+void sched_kw_wconinjh_buffer_fwrite(const sched_kw_wconinjh_type * kw , buffer_type * buffer) {
+  int size = vector_get_size(kw->wells);
+  buffer_fwrite_int( buffer , size );
+  for (int i=0; i < size; i++)
+    wconinjh_well_buffer_fwrite( vector_iget_const( kw->wells , i ) , buffer );
+}
+
+
+sched_kw_wconinjh_type * sched_kw_wconinjh_buffer_fread_alloc(buffer_type * buffer) {
+  sched_kw_wconinjh_type * kw = sched_kw_wconinjh_alloc_empty();
+  int size = buffer_fread_int( buffer );
+  for (int i=0; i < size; i++)
+    sched_kw_wconinjh_add_well( kw , wconinjh_well_buffer_fread_alloc( buffer ));
+  return kw;
+}
+
+
+
 
 
 /***********************************************************************/
@@ -434,3 +486,4 @@ void sched_kw_wconinjh_update_state( const sched_kw_wconinjh_type * kw , wconinj
 
 /***********************************************************************/
 KW_IMPL(wconinjh)
+KW_BUFFER_IO_IMPL(wconinjh)
@@ -0,0 +1,173 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'sched_file_cache.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/sched/sched_file.h>
+#include <ert/sched/sched_history.h>
+
+#define NUM_STEPS  20
+
+
+/*
+  The rates have more decimals than the fprintf() format of the
+  keywords, and the TSTEP lengths are not whole days; the cache must
+  reproduce them exactly.
+*/
+
+void write_schedule( const char * filename ) {
+  FILE * stream = util_fopen( filename , "w" );
+  fprintf(stream , "-- Version: A\n");
+  fprintf(stream , "RPTSCHED\n  'FIP=2' 'WELLS=2' /\n\n");
+  fprintf(stream , "GRUPTREE\n  'G1' 'FIELD' /\n/\n\n");
+  fprintf(stream , "WELSPECS\n  'OP_1' 'G1' 10 10 1* 'OIL' /\n  'WI_1' 'G1' 1 1 1* 'WATER' /\n/\n\n");
+  fprintf(stream , "COMPDAT\n  'OP_1' 10 10 1 5 'OPEN' 1* 1* 0.2 /\n  'WI_1' 1 1 1 5 'OPEN' 1* 1* 0.2 /\n/\n\n");
+  for (int step = 0; step < NUM_STEPS; step++) {
+    fprintf(stream , "WCONHIST\n  'OP_1'  '%s'  'RESV'  %.8f  %.8f  1000.123456 /\n/\n\n" , (step % 7 == 3) ? "SHUT" : "OPEN" , 1000.0 / (step + 3) , step * 0.123456789);
+    if (step % 2)
+      fprintf(stream , "WCONINJE\n  'WI_1'  'WATER'  'OPEN'  'RATE'  %.8f /\n/\n\n" , 500.0 / (step + 7));
+    else
+      fprintf(stream , "WCONINJH\n  'WI_1'  'WATER'  'OPEN'  %.8f /\n/\n\n" , 700.0 / (step + 11));
+
+    if (step % 3)
+      fprintf(stream , "DATES\n  %d 'MAR' %d /\n/\n\n" , 1 + step , 2001 + step);
+    else
+      fprintf(stream , "TSTEP\n  %.6f  1.000001 /\n\n" , 10.0 / 3);
+  }
+  fprintf(stream , "END\n");
+  fclose( stream );
+}
+
+
+void test_equal( const sched_file_type * sched_file1 , const sched_file_type * sched_file2 ) {
+  test_assert_int_equal( sched_file_get_num_restart_files( sched_file1 ) , sched_file_get_num_restart_files( sched_file2 ));
+  for (int restart_nr = 0; restart_nr < sched_file_get_num_restart_files( sched_file1 ); restart_nr++) {
+    test_assert_time_t_equal( sched_file_iget_block_end_time( sched_file1 , restart_nr ) , sched_file_iget_block_end_time( sched_file2 , restart_nr ));
+    test_assert_int_equal( sched_file_iget_block_size( sched_file1 , restart_nr ) , sched_file_iget_block_size( sched_file2 , restart_nr ));
+    test_assert_bool_equal( sched_file_well_open( sched_file1 , restart_nr , "OP_1" ) , sched_file_well_open( sched_file2 , restart_nr , "OP_1" ));
+    test_assert_double_equal( sched_file_well_wconhist_rate( sched_file1 , restart_nr , "OP_1" ) , sched_file_well_wconhist_rate( sched_file2 , restart_nr , "OP_1" ));
+    test_assert_double_equal( sched_file_well_wconinje_rate( sched_file1 , restart_nr , "WI_1" ) , sched_file_well_wconinje_rate( sched_file2 , restart_nr , "WI_1" ));
+  }
+
+  sched_file_fprintf( sched_file1 , "SCHEDULE1" );
+  sched_file_fprintf( sched_file2 , "SCHEDULE2" );
+  test_assert_true( util_files_equal( "SCHEDULE1" , "SCHEDULE2" ));
+
+  {
+    sched_history_type * history1 = sched_history_alloc( ":" );
+    sched_history_type * history2 = sched_history_alloc( ":" );
+    sched_history_update( history1 , sched_file1 );
+    sched_history_update( history2 , sched_file2 );
+    for (int restart_nr = 1; restart_nr < sched_file_get_num_restart_files( sched_file1 ); restart_nr++) {
+      test_assert_true( sched_history_iget( history1 , "WOPRH:OP_1" , restart_nr ) == sched_history_iget( history2 , "WOPRH:OP_1" , restart_nr ));
+      test_assert_true( sched_history_iget( history1 , "WWIRH:WI_1" , restart_nr ) == sched_history_iget( history2 , "WWIRH:WI_1" , restart_nr ));
+    }
+    sched_history_free( history1 );
+    sched_history_free( history2 );
+  }
+}
+
+
+bool load_cache( const char * filename , time_t start_time , const char * cache_file , const sched_file_type * parsed ) {
+  sched_file_type * sched_file = sched_file_alloc( start_time );
+  bool cache_valid = sched_file_fread_cache( sched_file , filename , cache_file );
+  if (cache_valid)
+    test_equal( parsed , sched_file );
+  sched_file_free( sched_file );
+  return cache_valid;
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "sched_file_cache" , false );
+  time_t start_time = util_make_date( 1 , 1 , 2000 );
+  const char * cache_file = "storage/SCHEDULE.INC.cache";
+
+  write_schedule( "SCHEDULE.INC" );
+  {
+    sched_file_type * parsed = sched_file_parse_alloc( "SCHEDULE.INC" , start_time );
+    sched_file_type * cached = sched_file_alloc( start_time );
+
+    /* First time: the file is parsed and the cache written. */
+    test_assert_false( util_file_exists( cache_file ));
+    sched_file_parse_cached( cached , "SCHEDULE.INC" , cache_file );
+    test_assert_true( util_file_exists( cache_file ));
+    test_equal( parsed , cached );
+    sched_file_free( cached );
+
+    test_assert_true( load_cache( "SCHEDULE.INC" , start_time , cache_file , parsed ));
+    test_assert_false( load_cache( "SCHEDULE.INC" , start_time + 1 , cache_file , parsed ));
+    test_assert_false( load_cache( "OTHER.INC" , start_time , cache_file , parsed ));
+    test_assert_false( load_cache( "SCHEDULE.INC" , start_time , "storage/DOES_NOT_EXIST" , parsed ));
+
+    /* A different set of fixed length keywords invalidates the cache. */
+    {
+      sched_file_type * sched_file = sched_file_alloc( start_time );
+      sched_file_add_fixed_length_kw( sched_file , "MYKW" , 2 );
+      test_assert_false( sched_file_fread_cache( sched_file , "SCHEDULE.INC" , cache_file ));
+      sched_file_free( sched_file );
+    }
+
+    /* A truncated cache is not used. */
+    {
+      int    size;
+      char * content = util_fread_alloc_file_content( cache_file , &size );
+      FILE * stream  = util_fopen( "storage/TRUNCATED" , "w" );
+      util_fwrite( content , 1 , size / 2 , stream , __func__ );
+      fclose( stream );
+      free( content );
+      test_assert_false( load_cache( "SCHEDULE.INC" , start_time , "storage/TRUNCATED" , parsed ));
+    }
+    sched_file_free( parsed );
+  }
+
+  /*
+     Changing the schedule file invalidates the cache; here only a
+     comment is changed, so the size and most likely also the
+     modification time are unchanged.
+  */
+  {
+    int    size;
+    char * content = util_fread_alloc_file_content( "SCHEDULE.INC" , &size );
+    FILE * stream  = util_fopen( "SCHEDULE.INC" , "w" );
+    strstr( content , "Version: A" )[9] = 'B';
+    util_fwrite( content , 1 , size , stream , __func__ );
+    fclose( stream );
+    free( content );
+
+    test_assert_false( load_cache( "SCHEDULE.INC" , start_time , cache_file , NULL ));
+    {
+      sched_file_type * parsed = sched_file_parse_alloc( "SCHEDULE.INC" , start_time );
+      sched_file_type * cached = sched_file_alloc( start_time );
+      sched_file_parse_cached( cached , "SCHEDULE.INC" , cache_file );
+      test_equal( parsed , cached );
+      test_assert_true( load_cache( "SCHEDULE.INC" , start_time , cache_file , parsed ));
+      sched_file_free( cached );
+      sched_file_free( parsed );
+    }
+  }
+
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,152 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'sched_file_well_index.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+
+#include <ert/sched/sched_file.h>
+#include <ert/sched/sched_kw.h>
+#include <ert/sched/sched_kw_wconhist.h>
+#include <ert/sched/sched_kw_wconinje.h>
+
+#define NUM_WELLS  12
+#define NUM_STEPS  40
+
+
+/*
+  Writes a schedule file where every step has a random selection of
+  the wells in a WCONHIST and/or WCONINJE keyword; some steps have two
+  keywords of the same type and some wells are repeated within a
+  keyword. The keywords are never empty, the sched_kw_xxx_get_well()
+  functions used by the reference do not handle that.
+*/
+
+void write_schedule( const char * filename ) {
+  FILE * stream = util_fopen( filename , "w" );
+  srand( 1 );
+  for (int step = 0; step < NUM_STEPS; step++) {
+    int num_kw = rand() % 4;
+    for (int ikw = 0; ikw < num_kw; ikw++) {
+      bool wconhist = ((rand() % 3) != 0);
+      fprintf(stream , "%s\n" , wconhist ? "WCONHIST" : "WCONINJE");
+      for (int iw = 0; iw < NUM_WELLS; iw++) {
+        if (((rand() % 3) == 0) || (iw == step % NUM_WELLS)) {
+          const char * status = ((rand() % 4) == 0) ? "SHUT" : "OPEN";
+          double rate = ((rand() % 5) == 0) ? 0 : step * 100 + iw + ikw * 0.25;
+          int repeat = ((rand() % 8) == 0) ? 2 : 1;
+          for (int r = 0; r < repeat; r++) {
+            if (wconhist)
+              fprintf(stream , "  'W%d'  '%s'  'RESV'  %g  0  0 /\n" , iw , status , rate + r);
+            else
+              fprintf(stream , "  'W%d'  'WATER'  '%s'  'RATE'  %g /\n" , iw , status , rate + r);
+          }
+        }
+      }
+      fprintf(stream , "/\n\n");
+    }
+    fprintf(stream , "DATES\n  %d 'JAN' %d /\n/\n\n" , 1 + step % 28 , 2000 + step);
+  }
+  fclose( stream );
+}
+
+
+/*
+  Reference implementation walking backwards through the blocks, as
+  the sched_file queries did before the well index.
+*/
+
+void reference_query( const sched_file_type * sched_file , int restart_nr , const char * well_name , bool * open , double * wconhist_rate , double * wconinje_rate) {
+  bool open_found     = false;
+  bool wconhist_found = false;
+  bool wconinje_found = false;
+
+  *open = false;
+  *wconhist_rate = -1;
+  *wconinje_rate = -1;
+  for (int block_nr = restart_nr; block_nr >= 0; block_nr--) {
+    sched_block_type * block = sched_file_iget_block( sched_file , block_nr );
+    bool block_found = false;
+
+    for (int itype = 0; itype < 2; itype++) {
+      sched_kw_type_enum type = (itype == 0) ? WCONHIST : WCONINJE;
+      for (int ikw = 0; ikw < sched_block_get_size( block ); ikw++) {
+        sched_kw_type * kw = sched_block_iget_kw( block , ikw );
+        if ((sched_kw_get_type( kw ) == type) && sched_kw_has_well( kw , well_name )) {
+          if (!open_found) {
+            *open = sched_kw_well_open( kw , well_name );
+            block_found = true;
+          }
+          if ((type == WCONHIST) && !wconhist_found)
+            *wconhist_rate = sched_kw_wconhist_get_orat( sched_kw_get_data( kw ) , well_name );
+          if ((type == WCONINJE) && !wconinje_found)
+            *wconinje_rate = sched_kw_wconinje_get_surface_flow( sched_kw_get_data( kw ) , well_name );
+        }
+      }
+      if (*wconhist_rate >= 0) wconhist_found = true;
+      if (*wconinje_rate >= 0) wconinje_found = true;
+    }
+    if (block_found)
+      open_found = true;
+  }
+}
+
+
+void test_against_reference( const sched_file_type * sched_file ) {
+  for (int restart_nr = 0; restart_nr < sched_file_get_num_restart_files( sched_file ); restart_nr++) {
+    for (int iw = 0; iw <= NUM_WELLS; iw++) {
+      char * well_name = util_alloc_sprintf( "W%d" , iw );
+      bool open;
+      double wconhist_rate , wconinje_rate;
+
+      reference_query( sched_file , restart_nr , well_name , &open , &wconhist_rate , &wconinje_rate );
+      test_assert_bool_equal( open , sched_file_well_open( sched_file , restart_nr , well_name ));
+      test_assert_double_equal( wconhist_rate , sched_file_well_wconhist_rate( sched_file , restart_nr , well_name ));
+      test_assert_double_equal( wconinje_rate , sched_file_well_wconinje_rate( sched_file , restart_nr , well_name ));
+      free( well_name );
+    }
+  }
+}
+
+
+void scale_callback( void * void_kw , int restart_nr , void * arg) {
+  sched_kw_wconhist_type * kw = sched_kw_wconhist_safe_cast( void_kw );
+  sched_kw_wconhist_scale_orat( kw , "W1" , 0.5 );
+}
+
+
+int main(int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc( "sched_file_well_index" , false );
+  sched_file_type * sched_file;
+
+  write_schedule( "SCHEDULE.INC" );
+  sched_file = sched_file_parse_alloc( "SCHEDULE.INC" , util_make_date( 1 , 1 , 1999 ));
+  test_assert_int_equal( NUM_STEPS + 1 , sched_file_get_num_restart_files( sched_file ));
+  test_against_reference( sched_file );
+
+  /* The index refers to the keywords; updates are seen immediately. */
+  sched_file_update( sched_file , WCONHIST , scale_callback , NULL );
+  test_against_reference( sched_file );
+
+  sched_file_free( sched_file );
+  test_work_area_free( work_area );
+  exit(0);
+}